@@ -50,8 +50,6 @@ void Part3Application::Initialize()
 	m_ColorModBuffer = &Graphics::AllocateDynamicBuffer();
 	m_VertexBufferView = &Graphics::AllocateVertexBufferView();
 	m_IndexBufferView = &Graphics::AllocateIndexBufferView();
-	m_ColorModBufferView = &Graphics::GraphicsAllocator::Get()->AllocateConstantBufferView();
-	m_PipelineState = &Graphics::AllocatePipelineState();
 
 	// Load Content
 	Graphics::CommandList& loadContentCmdList = m_CmdQueue->GetAvailableCommandList();
@@ -60,6 +58,8 @@ void Part3Application::Initialize()
 	Graphics::Resource& intermediateVertexBuffer = Graphics::GraphicsAllocator::Get()->AllocateEmptyResource(); // Note: we are allocating intermediate buffer that will not be used anymore later on but will stay in memory (leak)
 	Graphics::GraphicsAllocator::GraphicsAllocator::Get()->AllocateBufferCommittedResource(loadContentCmdList, *m_VertexBuffer, intermediateVertexBuffer, _countof(m_VertexData), sizeof(VertexPosColor), m_VertexData);
 
+	loadContentCmdList.TransitionResource(*m_VertexBuffer, Graphics::RESOURCE_STATE::VERTEX_AND_CONSTANT_BUFFER);
+
 	// Create the Vertex Buffer View associated to m_VertexBuffer
 	m_VertexBufferView->ReferenceResource(*m_VertexBuffer, sizeof(m_VertexData), sizeof(VertexPosColor));
 
@@ -68,6 +68,8 @@ void Part3Application::Initialize()
 
 	Graphics::GraphicsAllocator::GraphicsAllocator::Get()->AllocateBufferCommittedResource(loadContentCmdList, *m_IndexBuffer, intermediateIndexBuffer, _countof(m_IndexData), sizeof(unsigned short), m_IndexData);
 
+	loadContentCmdList.TransitionResource(*m_IndexBuffer, Graphics::RESOURCE_STATE::INDEX_BUFFER);
+
 	// Create the Index Buffer View associated to m_IndexBuffer
 	m_IndexBufferView->ReferenceResource(*m_IndexBuffer, sizeof(m_IndexData), Graphics::BUFFER_FORMAT::R16_UINT); // Single channel 16 bits, because WORD = unsigned short = 2 bytes = 16 bits
 
@@ -101,13 +103,14 @@ void Part3Application::Initialize()
 
 	// Using a single 32-bit constant root parameter (MVP matrix) that is used by the vertex shader	
 	Graphics::PipelineState::RESOURCE_BINDER_PARAM mvpMatrix;
-	mvpMatrix.InitAsConstants(sizeof(Eigen::Matrix4f) / 4, 0, 0, Graphics::SHADER_VISIBILITY::SV_VERTEX);
+	mvpMatrix.InitAsConstants(MvpLayout::Num32BitValues, 0, 0, Graphics::SHADER_VISIBILITY::SV_VERTEX);
 
 	resourceBinderDesc.Params.emplace(resourceBinderDesc.Params.end(),std::move(mvpMatrix));
 
 	// Constant buffer ColorModifierCB
 	Graphics::PipelineState::RESOURCE_BINDER_PARAM colorModifierParam;
-	colorModifierParam.InitAsTableCBVRange(1, 0, 1, Graphics::SHADER_VISIBILITY::SV_PIXEL);
+	// Bound by GPU address, so no descriptor needs to be created and copied every frame
+	colorModifierParam.InitAsRootCBV(0, 1, Graphics::SHADER_VISIBILITY::SV_PIXEL);
 
 	resourceBinderDesc.Params.emplace(resourceBinderDesc.Params.end(), std::move(colorModifierParam));
 
@@ -125,8 +128,8 @@ void Part3Application::Initialize()
 		Graphics::BUFFER_FORMAT::R8G8B8A8_UNORM
 	};
 
-	//Init the Pipeline State Object
-	m_PipelineState->Init(pipelineStateDesc);
+	// Allocate and init the Pipeline State Object, an identical description would return the cached one
+	m_PipelineState = &Graphics::GraphicsAllocator::Get()->AllocatePipelineState(pipelineStateDesc);
 
 	// Executing command list and waiting for full execution
 	m_CmdQueue->ExecuteCmdList(loadContentCmdList);
@@ -218,7 +221,7 @@ void Part3Application::UpdateContent(float InDeltaTime)
 	counter = 0.5f + std::sin(progress)/2.f;
 	progress += 0.002f * InDeltaTime;
 
-	m_ColorModBuffer->SetData(&counter, sizeof(counter), sizeof(float));
+	m_ColorModBuffer->SetData(&counter, ColorModCBLayout::Size, sizeof(float));
 }
 
 void Part3Application::RenderContent(Graphics::CommandList& InCmdList)
@@ -236,9 +239,9 @@ void Part3Application::RenderContent(Graphics::CommandList& InCmdList)
 
 	// Fill Command List Buffer Data and Draw Command
 	{
-		InCmdList.SetGraphicsRootConstants(0, sizeof(Eigen::Matrix4f) / 4, m_MvpMatrix.data(), 0);
+		InCmdList.SetGraphicsRootConstants(0, MvpLayout::Num32BitValues, m_MvpMatrix.data(), 0);
 
-		InCmdList.StoreAndReferenceDynamicBuffer(1, *m_ColorModBuffer, *m_ColorModBufferView);
+		InCmdList.StoreAndSetDynamicRootConstantBuffer(1, *m_ColorModBuffer);
 
 		InCmdList.DrawIndexed(_countof(m_IndexData));
 	}
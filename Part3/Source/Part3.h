@@ -11,6 +11,7 @@
 
 #include "Application.h"
 #include "GraphicsTypes.h"
+#include "ConstantBufferLayout.h"
 
 namespace GEPUtils { namespace Graphics { class PipelineState; } }
 
@@ -42,7 +43,10 @@ private:
 	GEPUtils::Graphics::IndexBufferView* m_IndexBufferView;
 	// Standalone Constant Buffer for the color modifier
 	GEPUtils::Graphics::DynamicBuffer* m_ColorModBuffer;
-	GEPUtils::Graphics::ConstantBufferView* m_ColorModBufferView;
+	// Mirrors struct ColorMod in PixelShader.hlsl
+	using ColorModCBLayout = GEPUtils::Graphics::CBufferLayout<float>;
+
+	using MvpLayout = GEPUtils::Graphics::CBufferLayout<Eigen::Matrix4f>;
 
 	GEPUtils::Graphics::PipelineState* m_PipelineState;
 
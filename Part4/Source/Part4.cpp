@@ -12,12 +12,15 @@
 #include "GraphicsUtils.h"
 #include "PipelineState.h"
 #include "GEPUtilsGeometry.h"
+#include "GEPUtilsCulling.h"
 #include "GraphicsAllocator.h"
 #include "GEPUtilsMath.h"
 #include "CommandQueue.h"
 #include "Window.h"
 #include "Device.h"
 #include "CommandList.h"
+#include "RenderGraph.h"
+#include "ResourceBinderLayout.h"
 
 
 #define Part4_SHADERS_PATH(NAME) LQUOTE(PART4_PROJ_ROOT_PATH/shaders/NAME)
@@ -26,6 +29,8 @@
 
 using namespace GEPUtils;
 
+// The bundle recording benchmark builds this file with its own entry point
+#ifndef PART4_BUNDLE_BENCH
 int main()
 {
 	std::cout << "Hello from Part 4: Texture Usage!" << std::endl;
@@ -41,6 +46,7 @@ int main()
 	// The following will trigger a breakpoint if we have some interfaces to graphics objects that were not cleaned up(leaking)!
 	GEPUtils::Graphics::GetDevice().ReportLiveObjects();
 }
+#endif
 
 
 void Part4Application::Initialize()
@@ -50,37 +56,26 @@ void Part4Application::Initialize()
 	// Load Content
 	Graphics::CommandList& loadContentCmdList = m_CmdQueue->GetAvailableCommandList();
 
-	// --- Vertex Buffer ---
-	size_t vertexDataSize = sizeof(VertexPosColor) * _countof(m_VertexData);
+	// --- Geometry Pool ---
+	// Note: indices are relative to the base vertex of each mesh, so 16 bits indices only limit the size of a single mesh
+	m_GeometryPool = std::make_unique<Graphics::GeometryPool>(static_cast<uint32_t>(sizeof(VertexPosColor)), g_GeometryPoolMaxVertices, g_GeometryPoolMaxIndices, Graphics::BUFFER_FORMAT::R16_UINT, g_GeometryPoolStagingSize);
 
-	m_VertexBuffer = &Graphics::GraphicsAllocator::Get()->AllocateBufferResource(vertexDataSize, Graphics::RESOURCE_HEAP_TYPE::DEFAULT, Graphics::RESOURCE_STATE::COPY_DEST); // Note: this is this supposed to be created as COPY_DEST and later changing state to read
-	// Note: we are allocating intermediate buffer that will not be used anymore later on but will stay in memory (leak)
-	Graphics::Buffer& intermediateVertexBuffer = Graphics::GraphicsAllocator::Get()->AllocateBufferResource(vertexDataSize, Graphics::RESOURCE_HEAP_TYPE::UPLOAD, Graphics::RESOURCE_STATE::GEN_READ); 
-	
-	loadContentCmdList.UploadBufferData(*m_VertexBuffer, intermediateVertexBuffer, m_VertexData, vertexDataSize);
-
-	// Create the Vertex Buffer View associated to m_VertexBuffer
-	m_VertexBufferView = &Graphics::GraphicsAllocator::Get()->AllocateVertexBufferView();
-	m_VertexBufferView->ReferenceResource(*m_VertexBuffer, sizeof(m_VertexData), sizeof(VertexPosColor));
-
-	// --- Index Buffer ---
-	size_t indexDataSize = sizeof(unsigned short) * _countof(m_IndexData);
-
-	m_IndexBuffer = &Graphics::GraphicsAllocator::Get()->AllocateBufferResource(indexDataSize, Graphics::RESOURCE_HEAP_TYPE::DEFAULT, Graphics::RESOURCE_STATE::COPY_DEST);
-	// Note: we are allocating intermediate buffer that will not be used anymore later on but will stay in memory (leak)
-	Graphics::Buffer& intermediateIndexBuffer = Graphics::GraphicsAllocator::Get()->AllocateBufferResource(indexDataSize, Graphics::RESOURCE_HEAP_TYPE::UPLOAD, Graphics::RESOURCE_STATE::GEN_READ);
-
-	loadContentCmdList.UploadBufferData(*m_IndexBuffer, intermediateIndexBuffer, m_IndexData, indexDataSize);
+	if (m_GeometryPool->AddMesh(loadContentCmdList, m_VertexData, _countof(m_VertexData), m_IndexData, _countof(m_IndexData), m_CubeMesh) != Graphics::GEOMETRY_POOL_ADD_RESULT::SUCCESS)
+	{
+		StopForFail("Cube mesh does not fit in the geometry pool.");
+		throw std::exception();
+	}
 
-	// Create the Index Buffer View associated to m_IndexBuffer
-	m_IndexBufferView = &Graphics::GraphicsAllocator::Get()->AllocateIndexBufferView();
-	m_IndexBufferView->ReferenceResource(*m_IndexBuffer, sizeof(m_IndexData), Graphics::BUFFER_FORMAT::R16_UINT); // Single channel 16 bits, because WORD = unsigned short = 2 bytes = 16 bits
+	m_GeometryPool->TransitionForDraw(loadContentCmdList);
 
 	// --- Shader Loading ---
 	// Note: to generate the .cso file I will be using the offline method, using fxc.exe integrated in visual studio (but downloadable separately).
 	// fxc command can be used by opening a developer command console in the hlsl shader folder.
 	// To generate VertexShader.cso I will be using: fxc /Zi /T vs_5_1 /Fo VertexShader.cso VertexShader.hlsl
 	// To generate PixelShader.cso I will be using: fxc /Zi /T ps_5_1 /Fo PixelShader.cso PixelShader.hlsl
+	// The .cso files are then packed in a single archive at build time (part4_shaders target), mapped once here.
+	// If the archive is missing, shaders are loaded from their own files.
+	Graphics::GraphicsAllocator::Get()->MountShaderArchive(LQUOTE(PART4_SHADER_ARCHIVE_PATH), Part4_SHADERS_PATH());
 
 	// Load the Vertex Shader
 	Graphics::Shader& vertexShader = GEPUtils::Graphics::AllocateShader(Part4_SHADERS_PATH(VertexShader.cso));
@@ -107,7 +102,8 @@ void Part4Application::Initialize()
 
 	// Using a single 32-bit constant root parameter (MVP matrix) that is used by the vertex shader	
 	Graphics::PipelineState::RESOURCE_BINDER_PARAM mvpMatrix;
-	mvpMatrix.InitAsConstants(sizeof(Eigen::Matrix4f) / 4, 0, 0, Graphics::SHADER_VISIBILITY::SV_VERTEX);
+	mvpMatrix.InitAsConstants(MvpLayout::Num32BitValues, 0, 0, Graphics::SHADER_VISIBILITY::SV_VERTEX);
+	mvpMatrix.UpdateFrequency = Graphics::PipelineState::RESOURCE_BINDER_PARAM::UPDATE_FREQUENCY::PER_DRAW;
 
 	resourceBinderDesc.Params.emplace(resourceBinderDesc.Params.end(),std::move(mvpMatrix));
 
@@ -130,12 +126,26 @@ void Part4Application::Initialize()
 	// Root parameter for the cubemap
 	Graphics::PipelineState::RESOURCE_BINDER_PARAM cubemapParam;
 	cubemapParam.InitAsTableSRVRange(1, 0, 1, Graphics::SHADER_VISIBILITY::SV_PIXEL);
+	cubemapParam.UpdateFrequency = Graphics::PipelineState::RESOURCE_BINDER_PARAM::UPDATE_FREQUENCY::PER_MATERIAL;
+	// The cubemap content never changes after load, letting the driver fetch it ahead of time
+	cubemapParam.DataVolatility = Graphics::PipelineState::RESOURCE_BINDER_PARAM::DATA_VOLATILITY::STATIC;
 
 	resourceBinderDesc.Params.emplace_back(std::move(cubemapParam));
 
 	// Sampler for the cubemap
 	resourceBinderDesc.StaticSamplers.emplace_back(0, Graphics::SAMPLE_FILTER_TYPE::LINEAR);
 
+	// Parameters get sorted by update frequency, from now on they need to be referenced by their remapped root index
+	Graphics::RESOURCE_BINDER_LAYOUT resourceBinderLayout;
+	if (!Graphics::OptimizeResourceBinderLayout(resourceBinderDesc, Graphics::RBL_SORT_BY_UPDATE_FREQUENCY, resourceBinderLayout))
+	{
+		// The root signature cannot be created from this layout, so there is no valid root index to bind the cube resources to
+		StopForFail("Cube resource binder is over budget.");
+		throw std::exception();
+	}
+	m_MvpRootIdx = resourceBinderLayout.RootIndexRemap[0];
+	m_CubemapRootIdx = resourceBinderLayout.RootIndexRemap[1];
+
 	// Init Root Signature Desc
 	// Create Root Signature serialized blob and then the object from it
 	// RTV Formats
@@ -150,10 +160,8 @@ void Part4Application::Initialize()
 		Graphics::BUFFER_FORMAT::R8G8B8A8_UNORM
 	};
 
-	m_PipelineState = &Graphics::AllocatePipelineState();
-
-	//Init the Pipeline State Object
-	m_PipelineState->Init(pipelineStateDesc);
+	// The Pipeline State Object compiles on a worker thread, meanwhile we can generate the cubemap mips
+	m_PipelineState = Graphics::GraphicsAllocator::Get()->AllocatePipelineStateAsync(pipelineStateDesc);
 
 	// --- MIPS GENERATION ---
 
@@ -179,7 +187,7 @@ void Part4Application::Initialize()
 	// Root Signature
 	// We are gonna use a root constant to pass the GenerateMipsCB to the shader
 	Graphics::PipelineState::RESOURCE_BINDER_PARAM generateMipsCbParam;
-	generateMipsCbParam.InitAsConstants(sizeof(GenerateMipsCB) / 4, 0, 0);
+	generateMipsCbParam.InitAsConstants(GenerateMipsCBLayout::Num32BitValues, 0, 0);
 	resourceBinderDesc2.Params.emplace_back(std::move(generateMipsCbParam));
 	// Root parameter for the cubemap
 	// We first need to have one SRV range that will be used by the input cube faces
@@ -202,37 +210,62 @@ void Part4Application::Initialize()
 	};
 
 	// Used to generate mips
-	GEPUtils::Graphics::PipelineState& m_PipelineState2 = Graphics::AllocatePipelineState();
-
-	//Init the Pipeline State Object
-	m_PipelineState2.Init(pipelineStateDesc2);
-	// Set the PSO+RS
-	loadContentCmdList.SetPipelineStateAndResourceBinder(m_PipelineState2);
-	// Set resource binding
-	loadContentCmdList.ReferenceComputeTable(1, inputCubeFacesView);
-	// Note: This descriptor table is expecting a range of 4 descriptors, 
-	// but we know that cubeMipView1 in GPU memory will be followed by 2,3 and 4 because we instantiated them one after the other
-	loadContentCmdList.ReferenceComputeTable(2, cubeMipView1); 
-
-	// Since our compute shader handles portions of 8 by 8 texels for each thread group, 
-	// the number of thread groups, in X and Y dimensions, in our dispatch will be the size of the mip 1 (so half the size of mip0), aligned by 8 and then divided by 8.
-	uint32_t mip1SizeAligned = GEPUtils::Math::Align(m_Cubemap->GetWidth() / 2, 8);
-
-	GenerateMipsCB genMipsCB; genMipsCB.Mip1Size = Eigen::Vector2f(mip1SizeAligned, mip1SizeAligned);
-
-	loadContentCmdList.SetComputeRootConstants(0, sizeof(GenerateMipsCB) / 4, &genMipsCB, 0);
-
-	// In the Z dimension the number of thread groups will be 6, because we are going to repeat the work on X and Y for each of the 6 cube faces.
-	loadContentCmdList.Dispatch(mip1SizeAligned / 8, mip1SizeAligned / 8, 6);
+	GEPUtils::Graphics::PipelineState& m_PipelineState2 = Graphics::GraphicsAllocator::Get()->AllocatePipelineState(pipelineStateDesc2);
+
+	// The mips generation is described as a render graph with a single pass, so that the transitions of each subresource are derived from what the pass declares to use.
+	// After the graph executes, the cubemap will be left ready to be read by pixel shaders.
+	Graphics::RenderGraph mipsGenerationGraph;
+	Graphics::RenderGraphResourceHandle cubemapHandle = mipsGenerationGraph.ImportOutputResource("Cubemap", *m_Cubemap, Graphics::RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+
+	mipsGenerationGraph.AddPass("GenerateCubeMips",
+		[this, cubemapHandle](Graphics::RenderGraphPassBuilder& InBuilder)
+		{
+			// Mip 0 of each face is read by the compute shader, while mips from 1 to 4 are written
+			const uint32_t mipLevelsNum = static_cast<uint32_t>(m_Cubemap->GetMipLevelsNum());
+			for (uint32_t faceIdx = 0; faceIdx < 6; faceIdx++)
+			{
+				InBuilder.Read(cubemapHandle, Graphics::RESOURCE_STATE::NON_PIXEL_SHADER_RESOURCE, Graphics::ComputeSubresourceIndex(0, faceIdx, mipLevelsNum));
+				for (uint32_t mipIdx = 1; mipIdx < mipLevelsNum; mipIdx++)
+					InBuilder.Write(cubemapHandle, Graphics::RESOURCE_STATE::UNORDERED_ACCESS, Graphics::ComputeSubresourceIndex(mipIdx, faceIdx, mipLevelsNum));
+			}
+		},
+		[&](Graphics::CommandList& InCmdList, Graphics::RenderGraph&)
+		{
+			// Set the PSO+RS
+			InCmdList.SetPipelineStateAndResourceBinder(m_PipelineState2);
+			// Set resource binding
+			InCmdList.ReferenceComputeTable(1, inputCubeFacesView);
+			// Note: This descriptor table is expecting a range of 4 descriptors, 
+			// but we know that cubeMipView1 in GPU memory will be followed by 2,3 and 4 because we instantiated them one after the other
+			InCmdList.ReferenceComputeTable(2, cubeMipView1);
+
+			// Since our compute shader handles portions of 8 by 8 texels for each thread group, 
+			// the number of thread groups, in X and Y dimensions, in our dispatch will be the size of the mip 1 (so half the size of mip0), aligned by 8 and then divided by 8.
+			uint32_t mip1SizeAligned = GEPUtils::Math::Align(m_Cubemap->GetWidth() / 2, 8);
+
+			GenerateMipsCB genMipsCB; genMipsCB.Mip1Size = Eigen::Vector2f(mip1SizeAligned, mip1SizeAligned);
+
+			InCmdList.SetComputeRootConstants(0, GenerateMipsCBLayout::Num32BitValues, &genMipsCB, 0);
+
+			// In the Z dimension the number of thread groups will be 6, because we are going to repeat the work on X and Y for each of the 6 cube faces.
+			InCmdList.Dispatch(mip1SizeAligned / 8, mip1SizeAligned / 8, 6);
+		});
+
+	mipsGenerationGraph.Compile();
+
+	mipsGenerationGraph.Execute(loadContentCmdList);
 
 	// Executing command list and waiting for full execution
 	m_CmdQueue->ExecuteCmdList(loadContentCmdList);
 
 	m_CmdQueue->Flush(); // Note: Flushing operations on the command queue here will ensure that all the operations made on resources by the loadContentCmdList finished executing!
 
+	m_GeometryPool->OnUploadsCompleted();
+
 	// --- MIPS GENERATION ENDS ---
 
 	// Initialize the Model Matrix
+	m_CubeNode = m_SceneGraph.AddNode(GEPUtils::Geometry::g_SceneGraphNoParent, Eigen::Vector3f::Zero(), Eigen::Quaternionf::Identity(), Eigen::Vector3f::Ones());
 	m_ModelMatrix = Eigen::Matrix4f::Identity();
 
 	// Initialize the View Matrix
@@ -270,21 +303,19 @@ void Part4Application::OnMouseMove(int32_t InX, int32_t InY)
 
 void Part4Application::OnLeftMouseDrag(int32_t InDeltaX, int32_t InDeltaY)
 {
-	Eigen::Transform<float, 3, Eigen::Affine> tr;
-	tr.setIdentity();
-	tr.rotate(Eigen::AngleAxisf(-InDeltaX / static_cast<float>(m_MainWindow->GetFrameWidth()), Eigen::Vector3f::UnitY()))
-		.rotate(Eigen::AngleAxisf(-InDeltaY / static_cast<float>(m_MainWindow->GetFrameHeight()), Eigen::Vector3f::UnitX()));
+	const Eigen::Quaternionf rotation = Eigen::AngleAxisf(-InDeltaX / static_cast<float>(m_MainWindow->GetFrameWidth()), Eigen::Vector3f::UnitY())
+		* Eigen::AngleAxisf(-InDeltaY / static_cast<float>(m_MainWindow->GetFrameHeight()), Eigen::Vector3f::UnitX());
 
-	m_ModelMatrix = tr.matrix() * m_ModelMatrix;
+	// Rotating around the world origin, as applying the rotation after the current model transform
+	m_SceneGraph.SetLocalPosition(m_CubeNode, rotation * m_SceneGraph.GetLocalPosition(m_CubeNode));
+	m_SceneGraph.SetLocalRotation(m_CubeNode, (rotation * m_SceneGraph.GetLocalRotation(m_CubeNode)).normalized());
 }
 
 void Part4Application::OnRightMouseDrag(int32_t InDeltaX, int32_t InDeltaY)
 {
-	Eigen::Transform<float, 3, Eigen::Affine> tr;
-	tr.setIdentity();
-	tr.translate(Eigen::Vector3f(InDeltaX / static_cast<float>(m_MainWindow->GetFrameWidth()), -InDeltaY / static_cast<float>(m_MainWindow->GetFrameHeight()), 0));
+	const Eigen::Vector3f translation(InDeltaX / static_cast<float>(m_MainWindow->GetFrameWidth()), -InDeltaY / static_cast<float>(m_MainWindow->GetFrameHeight()), 0);
 
-	m_ModelMatrix = tr.matrix() * m_ModelMatrix;
+	m_SceneGraph.SetLocalPosition(m_CubeNode, m_SceneGraph.GetLocalPosition(m_CubeNode) + translation);
 }
 
 void Part4Application::OnTypingKeyPressed(GEPUtils::KEYBOARD_KEY InKeyPressed)
@@ -302,31 +333,90 @@ void Part4Application::OnControlKeyPressed(GEPUtils::KEYBOARD_KEY InPressedSysKe
 void Part4Application::UpdateContent(float InDeltaTime)
 {
 
+	// Only nodes edited since the last frame (and their children) get recomputed
+	m_SceneGraph.UpdateWorldMatrices();
+	m_ModelMatrix = m_SceneGraph.GetWorldMatrix(m_CubeNode);
+
 	// Updating MVP matrix
 	m_MvpMatrix = m_ProjMatrix * m_ViewMatrix * m_ModelMatrix;
 
+	// Planes extracted from the MVP are in object space, so the cube is tested with its local bounding sphere (centered at the origin, enclosing the unit corners)
+	m_IsCubeVisible = GEPUtils::Geometry::IsSphereInFrustum(GEPUtils::Geometry::ExtractFrustumPlanes(m_MvpMatrix), Eigen::Vector3f::Zero(), std::sqrt(3.f));
+}
+
+void Part4Application::SetupRenderPasses(Graphics::RenderGraph& InRenderGraph, Graphics::RenderGraphResourceHandle InBackBuffer)
+{
+	Graphics::RenderGraphResourceHandle cubemapHandle = InRenderGraph.ImportResource("Cubemap", *m_Cubemap);
+
+	InRenderGraph.AddPass("RenderCube",
+		[InBackBuffer, cubemapHandle](Graphics::RenderGraphPassBuilder& InBuilder)
+		{
+			InBuilder.Read(cubemapHandle, Graphics::RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+			InBuilder.Write(InBackBuffer, Graphics::RESOURCE_STATE::RENDER_TARGET);
+		},
+		[this](Graphics::CommandList& InCmdList, Graphics::RenderGraph&) { RenderContent(InCmdList); });
+}
+
+void Part4Application::RecordCubeBundle(Graphics::PipelineState& InPipelineState)
+{
+	m_CubeBundle = &Graphics::GraphicsAllocator::Get()->AllocateBundle();
+
+	// Note: the bundle sets the same root signature as the command list executing it, so it keeps the MVP root constants set there
+	m_CubeBundle->SetPipelineStateAndResourceBinder(InPipelineState);
+
+	m_GeometryPool->SetInputAssemblerData(*m_CubeBundle, Graphics::PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST);
+
+	m_CubeBundle->ReferenceSRV(m_CubemapRootIdx, *m_CubemapView);
+
+	m_GeometryPool->DrawMesh(*m_CubeBundle, m_CubeMesh);
+
+	m_CubeBundle->Close();
 }
 
 void Part4Application::RenderContent(Graphics::CommandList& InCmdList)
 {
-	// Fill Command List Pipeline-related Data
-	{
-		InCmdList.SetPipelineStateAndResourceBinder(*m_PipelineState);
+	// The cube is not drawn until its pipeline state finished compiling
+	GEPUtils::Graphics::PipelineState* readyPipelineState = m_PipelineState.GetIfReady();
+	if (!readyPipelineState)
+		return;
+
+	if (!m_CubeBundle)
+		RecordCubeBundle(*readyPipelineState);
 
-		InCmdList.SetInputAssemblerData(Graphics::PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST, *m_VertexBufferView, *m_IndexBufferView);
+	if (!m_IsCubeVisible)
+		return;
 
-		InCmdList.SetViewportAndScissorRect(*m_Viewport, *m_ScissorRect);
+	// Commands of the previous frame were already replayed, their blocks are reused
+	m_CubePassCommands.Reset();
 
-		InCmdList.SetRenderTargetFromWindow(*m_MainWindow);
+	// Record Pipeline-related Data
+	{
+		// Note: also needed when executing the bundle, the root constants set here are only kept by the bundle if it sets the same root signature
+		m_CubePassCommands.SetPipelineStateAndResourceBinder(*readyPipelineState);
+
+		m_CubePassCommands.SetViewportAndScissorRect(*m_Viewport, *m_ScissorRect);
+
+		m_CubePassCommands.SetRenderTargetFromWindow(*m_MainWindow);
 	}
 
-	// Fill Command List Buffer Data and Draw Command
+	// Record Buffer Data and Draw Command
 	{
-		InCmdList.SetGraphicsRootConstants(0, sizeof(Eigen::Matrix4f) / 4, m_MvpMatrix.data(), 0);
+		// Note: root constants are copied in the command buffer, the MVP matrix can change before the replay
+		m_CubePassCommands.SetGraphicsRootConstants(m_MvpRootIdx, MvpLayout::Num32BitValues, m_MvpMatrix.data(), 0);
+
+		if (m_IsCubeBundleEnabled)
+		{
+			m_CubePassCommands.ExecuteBundle(*m_CubeBundle);
+		}
+		else
+		{
+			m_CubePassCommands.SetInputAssemblerData(Graphics::PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST, m_GeometryPool->GetVertexBufferView(), m_GeometryPool->GetIndexBufferView());
 
-		InCmdList.ReferenceSRV(1, *m_CubemapView); // Note: the SRV is already uploaded to GPU and at render time it just need to be referenced in the pipeline at the given root index
+			m_CubePassCommands.ReferenceSRV(m_CubemapRootIdx, *m_CubemapView); // Note: the SRV is already uploaded to GPU and at render time it just need to be referenced in the pipeline at the given root index
 
-		InCmdList.DrawIndexed(_countof(m_IndexData));
+			m_CubePassCommands.DrawIndexedInstanced(m_CubeMesh.IndicesNum, 1, m_CubeMesh.StartIndexLocation, static_cast<int32_t>(m_CubeMesh.BaseVertexLocation), 0);
+		}
 	}
 
+	m_CubePassCommands.Replay(InCmdList);
 }
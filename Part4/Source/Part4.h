@@ -9,10 +9,14 @@
 #ifndef Part4_h__
 #define Part4_h__
 
+#include <memory>
 #include "Application.h"
 #include "GraphicsTypes.h"
-
-namespace GEPUtils { namespace Graphics { class PipelineState; } }
+#include "PipelineStateCache.h"
+#include "ConstantBufferLayout.h"
+#include "GeometryPool.h"
+#include "CommandBuffer.h"
+#include "GEPUtilsSceneGraph.h"
 
 class Part4Application : public GEPUtils::Application
 {
@@ -33,12 +37,12 @@ private:
 	// Note: most of the following member variables should not belong to the application
 	// but instead to a draw command object for the current entity being drawn.
 	// In that case we would create the draw command object with references instead of raw pointers.
-	// Vertex buffer for the cube
-	GEPUtils::Graphics::Buffer* m_VertexBuffer;
-	GEPUtils::Graphics::VertexBufferView* m_VertexBufferView;
-	// Index buffer for the cube
-	GEPUtils::Graphics::Buffer* m_IndexBuffer;
-	GEPUtils::Graphics::IndexBufferView* m_IndexBufferView;
+	// Shared vertex and index buffers, the cube is one of the meshes sub-allocated in them
+	std::unique_ptr<GEPUtils::Graphics::GeometryPool> m_GeometryPool;
+	GEPUtils::Graphics::GEOMETRY_POOL_MESH m_CubeMesh;
+	static constexpr uint32_t g_GeometryPoolMaxVertices = 64 * 1024;
+	static constexpr uint32_t g_GeometryPoolMaxIndices = 192 * 1024;
+	static constexpr size_t g_GeometryPoolStagingSize = 256 * 1024;
 
 	// Texture for the cubemap
 	GEPUtils::Graphics::Texture* m_Cubemap;
@@ -49,10 +53,33 @@ private:
 	{
 		Eigen::Vector2f Mip1Size;
 	};
+	// Mirrors cbuffer GenerateMipsCB in GenerateCubeMips_CS.hlsl
+	using GenerateMipsCBLayout = GEPUtils::Graphics::CBufferLayout<Eigen::Vector2f>;
+	static_assert(GenerateMipsCBLayout::Matches<GenerateMipsCB>(), "GenerateMipsCB does not follow HLSL constant buffer packing");
+
+	using MvpLayout = GEPUtils::Graphics::CBufferLayout<Eigen::Matrix4f>;
+
+	// Root indices of the cube parameters after the resource binder layout pass
+	uint32_t m_MvpRootIdx = 0;
+	uint32_t m_CubemapRootIdx = 1;
 
-	GEPUtils::Graphics::PipelineState* m_PipelineState;
+	// Mouse drags edit the local transform of the cube node, its world matrix becomes the model matrix
+	GEPUtils::Geometry::SceneGraph m_SceneGraph;
+	uint32_t m_CubeNode = GEPUtils::Geometry::g_SceneGraphNoParent;
 
 	Eigen::Matrix4f m_MvpMatrix;
+	// Result of testing the cube bounding sphere against the frustum
+	bool m_IsCubeVisible = true;
+
+	// Records the part of the cube draw that does not change between frames, executed every frame with a single call
+	void RecordCubeBundle(GEPUtils::Graphics::PipelineState& InPipelineState);
+
+	GEPUtils::Graphics::CommandList* m_CubeBundle = nullptr;
+
+	// The cube pass is recorded in a command buffer and then replayed on the pass command list.
+	// The pass owns its arena, so the recording does not depend on which thread the render graph runs the pass on.
+	GEPUtils::Graphics::CommandArena m_CubePassArena;
+	GEPUtils::Graphics::CommandBuffer m_CubePassCommands{ m_CubePassArena };
 
 	// Vertex data for colored cube
 	struct VertexPosColor
@@ -83,10 +110,18 @@ private:
 
 protected:
 
+	// Compiled on a worker thread while the rest of the content loads
+	GEPUtils::Graphics::AsyncPipelineState m_PipelineState;
+
+	// When disabled the whole cube draw is recorded every frame, the bundle recording benchmark (Part4BundleBench.cpp) switches it to compare the two
+	bool m_IsCubeBundleEnabled = true;
+
 	virtual void UpdateContent(float InDeltaTime) override;
 
 	virtual void RenderContent(GEPUtils::Graphics::CommandList& InCmdList) override;
 
+	virtual void SetupRenderPasses(GEPUtils::Graphics::RenderGraph& InRenderGraph, GEPUtils::Graphics::RenderGraphResourceHandle InBackBuffer) override;
+
 
 
 };
@@ -0,0 +1,75 @@
+/*
+ Part4BundleBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "Part4.h"
+#include <iostream>
+#include <chrono>
+#include "PipelineState.h"
+#include "Device.h"
+#include "Window.h"
+
+using namespace GEPUtils;
+
+namespace {
+
+	constexpr uint32_t g_WarmupFramesNum = 100;
+	constexpr uint32_t g_SamplesPerRoundNum = 1000;
+	constexpr uint32_t g_RoundsNum = 6;
+
+}
+
+// Times the CPU recording of the cube draw, alternating every round between executing the bundle and recording the whole draw,
+// then closes the window. The cube must stay in view, so the mouse should not be used while it runs.
+class Part4BundleBenchApplication : public Part4Application
+{
+protected:
+	virtual void RenderContent(Graphics::CommandList& InCmdList) override
+	{
+		// Frames before the pipeline state is ready do not draw, the first ones after it record the bundle
+		if (!m_PipelineState.IsReady() || m_WarmupFramesNum++ < g_WarmupFramesNum)
+		{
+			Part4Application::RenderContent(InCmdList);
+			return;
+		}
+
+		const auto startTime = std::chrono::steady_clock::now();
+		Part4Application::RenderContent(InCmdList);
+		m_RoundMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+		if (++m_RoundSamplesNum < g_SamplesPerRoundNum)
+			return;
+
+		std::cout << "Cube draw recording (" << (m_IsCubeBundleEnabled ? "bundle" : "re-recorded") << "): " << m_RoundMicroseconds / m_RoundSamplesNum << " us average" << std::endl;
+
+		m_IsCubeBundleEnabled = !m_IsCubeBundleEnabled;
+		m_RoundMicroseconds = 0.;
+		m_RoundSamplesNum = 0;
+
+		if (++m_RoundsNum == g_RoundsNum)
+			m_MainWindow->Close();
+	}
+
+private:
+	uint32_t m_WarmupFramesNum = 0;
+	uint32_t m_RoundSamplesNum = 0;
+	uint32_t m_RoundsNum = 0;
+	double m_RoundMicroseconds = 0.;
+};
+
+int main()
+{
+	Application::Create<Part4BundleBenchApplication>();
+
+	Application::Get()->Initialize();
+
+	Application::Get()->Run();
+
+	Graphics::GetDevice().ShutDown();
+
+	GEPUtils::Graphics::GetDevice().ReportLiveObjects();
+}
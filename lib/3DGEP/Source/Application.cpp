@@ -15,6 +15,7 @@
 #include "Window.h"
 #include "Device.h"
 #include "CommandQueue.h"
+#include "RenderGraph.h"
 
 using namespace GEPUtils::Graphics;
 
@@ -24,6 +25,9 @@ namespace GEPUtils
 
 	uint64_t Application::m_CpuFrameNumber = 1;
 
+	// Relative to the working directory
+	static const char* g_PipelineCacheFilePath = "PipelineCache.bin";
+
 	bool Application::CanComputeFrame()
 	{
 		return m_PaintStarted;
@@ -95,6 +99,13 @@ namespace GEPUtils
 
 	Application::~Application() = default;
 
+	void Application::SetupRenderPasses(Graphics::RenderGraph& InRenderGraph, Graphics::RenderGraphResourceHandle InBackBuffer)
+	{
+		InRenderGraph.AddPass("RenderContent",
+			[InBackBuffer](RenderGraphPassBuilder& InBuilder) { InBuilder.Write(InBackBuffer, RESOURCE_STATE::RENDER_TARGET); },
+			[this](CommandList& InCmdList, RenderGraph&) { RenderContent(InCmdList); });
+	}
+
 	void Application::Initialize()
 	{
 		m_GraphicsAllocator = GraphicsAllocator::CreateInstance();
@@ -104,9 +115,14 @@ namespace GEPUtils
 
 		GEPUtils::Graphics::GraphicsAllocator::Get()->Initialize();
 
+		// Pipeline states created from now on can reuse the blobs compiled by the previous runs
+		GEPUtils::Graphics::GraphicsAllocator::Get()->GetPipelineDiskCache().Load(g_PipelineCacheFilePath, m_GraphicsDevice.GetIdentityHash());
+
 		// Create Command Queue
 		m_CmdQueue = &GEPUtils::Graphics::GraphicsAllocator::Get()->AllocateCommandQueue(m_GraphicsDevice, Graphics::COMMAND_LIST_TYPE::COMMAND_LIST_TYPE_DIRECT);
 
+		m_RenderGraph = std::make_unique<Graphics::RenderGraph>();
+
 		uint32_t mainWindowWidth = 1024, mainWindowHeight = 768;
 
 		m_ScissorRect = Graphics::AllocateRect(0l, 0l, LONG_MAX, LONG_MAX);
@@ -170,6 +186,10 @@ namespace GEPUtils
 		// Finish all the render commands currently in flight
 		m_CmdQueue->Flush();
 
+		// Pipeline states still compiling would add their blobs to the disk cache while saving it
+		GEPUtils::Graphics::GraphicsAllocator::Get()->WaitForPipelineStateCompilations();
+		GEPUtils::Graphics::GraphicsAllocator::Get()->GetPipelineDiskCache().Save(g_PipelineCacheFilePath);
+
 		// Release all the allocated graphics resources
 		m_GraphicsAllocator.reset();
 	}
@@ -218,27 +238,32 @@ namespace GEPUtils
 
 		Graphics::CommandList& cmdList = m_CmdQueue->GetAvailableCommandList();
 
+		// The frame is described again every time, since the current back buffer changes.
+		// The graph will transition the back buffer to render target state before the first pass and back to present state after the last one.
+		m_RenderGraph->Reset();
+		RenderGraphResourceHandle backBufferHandle = m_RenderGraph->ImportOutputResource("BackBuffer", backBuffer, RESOURCE_STATE::PRESENT);
+
 		// Clear render target and depth stencil
-		{
-			// Transitioning current backbuffer resource to render target state
-			// We can be sure that the previous state was present because in this application all the render targets
-			// are first filled and then presented to the main window repetitevely.
-			cmdList.ResourceBarrier(backBuffer,RESOURCE_STATE::PRESENT, RESOURCE_STATE::RENDER_TARGET);
+		m_RenderGraph->AddPass("ClearBackBuffer",
+			[backBufferHandle](RenderGraphPassBuilder& InBuilder) { InBuilder.Write(backBufferHandle, RESOURCE_STATE::RENDER_TARGET); },
+			[this](CommandList& InCmdList, RenderGraph&)
+			{
+				FLOAT clearColor[] = { .4f, .6f, .9f, 1.f };
+				InCmdList.ClearRTV(m_MainWindow->GetCurrentRTVDescriptorHandle(), clearColor);
 
-			FLOAT clearColor[] = { .4f, .6f, .9f, 1.f };
-			cmdList.ClearRTV(m_MainWindow->GetCurrentRTVDescriptorHandle(), clearColor);
+				// Note: Clearing Render Target and Depth Stencil is a good practice, but in this case is also essential.
+				// Without clearing the DepthStencilView, the rasterizer would not be able to use it!!
+				InCmdList.ClearDepth(m_MainWindow->GetCurrentDSVDescriptorHandle());
+			});
 
-			// Note: Clearing Render Target and Depth Stencil is a good practice, but in this case is also essential.
-			// Without clearing the DepthStencilView, the rasterizer would not be able to use it!!
-			cmdList.ClearDepth(m_MainWindow->GetCurrentDSVDescriptorHandle());
-		}
+		SetupRenderPasses(*m_RenderGraph, backBufferHandle); // Derived classes will add here the passes rendering their application content
+
+		m_RenderGraph->Compile();
 
-		RenderContent(cmdList); // Derived classes will call this to render their application content
+		m_RenderGraph->Execute(cmdList);
 
 		// Execute command list and present current render target from the main window
 		{
-			cmdList.ResourceBarrier(backBuffer, RESOURCE_STATE::RENDER_TARGET, RESOURCE_STATE::PRESENT);
-
 			// Mandatory for the command list to close before getting executed by the command queue
 			m_CmdQueue->ExecuteCmdList(cmdList);
 
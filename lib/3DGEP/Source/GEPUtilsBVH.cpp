@@ -0,0 +1,519 @@
+/*
+ GEPUtilsBVH.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsBVH.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <emmintrin.h>
+
+namespace GEPUtils {
+	namespace Geometry {
+
+		static constexpr uint32_t g_BVHMaxBinsNum = 16;
+
+		// Each visited node pushes at most 3 more entries than it pops
+		static constexpr uint32_t g_BVHStackSize = 3 * g_BVHMaxDepth + 1;
+
+		static const float g_FloatInf = std::numeric_limits<float>::infinity();
+
+		float BoundingVolumeHierarchy::BuildRange::HalfArea() const
+		{
+			const Eigen::Array3f size = (Max - Min).max(0.f);
+			return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+		}
+
+		BoundingVolumeHierarchy::BoundingVolumeHierarchy(uint32_t InMaxLeafSize /*= 4*/)
+			: m_MaxLeafSize(std::max(InMaxLeafSize, 1u))
+		{ }
+
+		void BoundingVolumeHierarchy::Build(const AABBS_SOA& InAABBs, uint32_t InObjectsNum)
+		{
+			m_Nodes.clear();
+			m_Depth = 0;
+
+			m_PrimIndices.resize(InObjectsNum);
+
+			if (InObjectsNum == 0)
+				return;
+
+			// Splits partition a compact copy of the primitives, so that the passes over a range read contiguous memory
+			m_BuildPrims.resize(InObjectsNum);
+			for (uint32_t objectIdx = 0; objectIdx < InObjectsNum; objectIdx++)
+			{
+				BuildPrimitive& currentPrim = m_BuildPrims[objectIdx];
+				const Eigen::Array3f extent(InAABBs.ExtentX[objectIdx], InAABBs.ExtentY[objectIdx], InAABBs.ExtentZ[objectIdx]);
+				currentPrim.Center = Eigen::Array3f(InAABBs.CenterX[objectIdx], InAABBs.CenterY[objectIdx], InAABBs.CenterZ[objectIdx]);
+				currentPrim.Min = currentPrim.Center - extent;
+				currentPrim.Max = currentPrim.Center + extent;
+				currentPrim.ObjectIdx = objectIdx;
+			}
+
+			// Roughly one node every 3 primitives with full leaves
+			m_Nodes.reserve(InObjectsNum / 3 + 1);
+
+			BuildRange rootRange;
+			rootRange.First = 0;
+			rootRange.Count = InObjectsNum;
+			ComputeRangeBounds(rootRange);
+
+			BuildNode(rootRange, 1);
+
+			for (uint32_t primIdx = 0; primIdx < InObjectsNum; primIdx++)
+				m_PrimIndices[primIdx] = m_BuildPrims[primIdx].ObjectIdx;
+
+			// Building only decides the topology, node bounds are computed by refitting
+			Refit(InAABBs);
+		}
+
+		void BoundingVolumeHierarchy::ComputeRangeBounds(BuildRange& InOutRange) const
+		{
+			InOutRange.Min = Eigen::Array3f::Constant(g_FloatInf);
+			InOutRange.Max = Eigen::Array3f::Constant(-g_FloatInf);
+
+			for (uint32_t primIdx = InOutRange.First; primIdx < InOutRange.First + InOutRange.Count; primIdx++)
+			{
+				InOutRange.Min = InOutRange.Min.min(m_BuildPrims[primIdx].Min);
+				InOutRange.Max = InOutRange.Max.max(m_BuildPrims[primIdx].Max);
+			}
+		}
+
+		uint32_t BoundingVolumeHierarchy::BuildNode(const BuildRange& InRange, uint32_t InDepth)
+		{
+			m_Depth = std::max(m_Depth, InDepth);
+
+			const uint32_t nodeIdx = static_cast<uint32_t>(m_Nodes.size());
+			m_Nodes.emplace_back();
+
+			// Splitting the child with the largest area first, it is the one most likely to be visited by queries
+			BuildRange children[4] = { InRange };
+			uint32_t childrenNum = 1;
+			while (childrenNum < 4)
+			{
+				int32_t splitChildIdx = -1;
+				float splitChildArea = -1.f;
+				for (uint32_t childIdx = 0; childIdx < childrenNum; childIdx++)
+				{
+					if (children[childIdx].Count > m_MaxLeafSize && children[childIdx].HalfArea() > splitChildArea)
+					{
+						splitChildIdx = static_cast<int32_t>(childIdx);
+						splitChildArea = children[childIdx].HalfArea();
+					}
+				}
+
+				if (splitChildIdx < 0)
+					break;
+
+				BuildRange leftRange, rightRange;
+				SplitRange(children[splitChildIdx], leftRange, rightRange);
+
+				// Keeping children in primitive order, so that the ranges of a subtree stay contiguous
+				for (uint32_t childIdx = childrenNum; childIdx > static_cast<uint32_t>(splitChildIdx) + 1; childIdx--)
+					children[childIdx] = children[childIdx - 1];
+				children[splitChildIdx] = leftRange;
+				children[splitChildIdx + 1] = rightRange;
+				childrenNum++;
+			}
+
+			for (uint32_t childIdx = 0; childIdx < 4; childIdx++)
+			{
+				uint32_t childNodeIdx = g_BVHLeafChild;
+				if (childIdx < childrenNum && children[childIdx].Count > m_MaxLeafSize && InDepth < g_BVHMaxDepth)
+					childNodeIdx = BuildNode(children[childIdx], InDepth + 1);
+
+				// Note: the node is accessed by index since building children can reallocate the array
+				BVH4_NODE& currentNode = m_Nodes[nodeIdx];
+				currentNode.Children[childIdx] = childNodeIdx;
+				currentNode.PrimFirst[childIdx] = childIdx < childrenNum ? children[childIdx].First : 0;
+				currentNode.PrimCount[childIdx] = childIdx < childrenNum ? children[childIdx].Count : 0;
+			}
+
+			return nodeIdx;
+		}
+
+		void BoundingVolumeHierarchy::SplitRange(const BuildRange& InRange, BuildRange& OutLeft, BuildRange& OutRight)
+		{
+			Eigen::Array3f centroidMin = Eigen::Array3f::Constant(g_FloatInf);
+			Eigen::Array3f centroidMax = Eigen::Array3f::Constant(-g_FloatInf);
+			for (uint32_t primIdx = InRange.First; primIdx < InRange.First + InRange.Count; primIdx++)
+			{
+				centroidMin = centroidMin.min(m_BuildPrims[primIdx].Center);
+				centroidMax = centroidMax.max(m_BuildPrims[primIdx].Center);
+			}
+
+			// Binning centroids along all the 3 axes in a single pass over the primitives.
+			// Small ranges, the most common ones, use fewer bins since the fixed cost of a split dominates there.
+			const uint32_t binsNum = std::min(std::max(InRange.Count, 4u), g_BVHMaxBinsNum);
+			uint32_t binCounts[3][g_BVHMaxBinsNum] = {};
+			Eigen::Array3f binMins[3][g_BVHMaxBinsNum];
+			Eigen::Array3f binMaxs[3][g_BVHMaxBinsNum];
+			for (uint32_t axisIdx = 0; axisIdx < 3; axisIdx++)
+			{
+				for (uint32_t binIdx = 0; binIdx < binsNum; binIdx++)
+				{
+					binMins[axisIdx][binIdx] = Eigen::Array3f::Constant(g_FloatInf);
+					binMaxs[axisIdx][binIdx] = Eigen::Array3f::Constant(-g_FloatInf);
+				}
+			}
+
+			const Eigen::Array3f centroidExtent = centroidMax - centroidMin;
+			Eigen::Array3f binScales;
+			for (uint32_t axisIdx = 0; axisIdx < 3; axisIdx++)
+				binScales[axisIdx] = centroidExtent[axisIdx] > 0.f ? binsNum / centroidExtent[axisIdx] : 0.f;
+
+			auto computeBin = [&](float InCentroid, uint32_t InAxisIdx) {
+				return std::min(static_cast<uint32_t>((InCentroid - centroidMin[InAxisIdx]) * binScales[InAxisIdx]), binsNum - 1);
+			};
+
+			for (uint32_t primIdx = InRange.First; primIdx < InRange.First + InRange.Count; primIdx++)
+			{
+				const BuildPrimitive& currentPrim = m_BuildPrims[primIdx];
+				for (uint32_t axisIdx = 0; axisIdx < 3; axisIdx++)
+				{
+					const uint32_t binIdx = computeBin(currentPrim.Center[axisIdx], axisIdx);
+					binCounts[axisIdx][binIdx]++;
+					binMins[axisIdx][binIdx] = binMins[axisIdx][binIdx].min(currentPrim.Min);
+					binMaxs[axisIdx][binIdx] = binMaxs[axisIdx][binIdx].max(currentPrim.Max);
+				}
+			}
+
+			// SAH cost of splitting after each bin: count * area on both sides, the traversal cost is the same for all the candidates
+			float bestCost = g_FloatInf;
+			uint32_t bestAxisIdx = 0, bestBinIdx = 0;
+			// Only read when a split was found, initialized anyway since the compiler cannot tell it apart
+			BuildRange bestLeft = { 0, 0, Eigen::Array3f::Zero(), Eigen::Array3f::Zero() };
+			BuildRange bestRight = bestLeft;
+			for (uint32_t axisIdx = 0; axisIdx < 3; axisIdx++)
+			{
+				if (centroidExtent[axisIdx] <= 0.f)
+					continue;
+
+				BuildRange accumulated = { 0, 0, Eigen::Array3f::Constant(g_FloatInf), Eigen::Array3f::Constant(-g_FloatInf) };
+
+				// Bounds of the right side are kept, so that the chosen split does not need another pass over its primitives
+				BuildRange rightRanges[g_BVHMaxBinsNum];
+				uint32_t rightCount = 0;
+				for (uint32_t binIdx = binsNum - 1; binIdx > 0; binIdx--)
+				{
+					accumulated.Min = accumulated.Min.min(binMins[axisIdx][binIdx]);
+					accumulated.Max = accumulated.Max.max(binMaxs[axisIdx][binIdx]);
+					rightCount += binCounts[axisIdx][binIdx];
+					rightRanges[binIdx - 1] = accumulated;
+					rightRanges[binIdx - 1].Count = rightCount;
+				}
+
+				accumulated.Min = Eigen::Array3f::Constant(g_FloatInf);
+				accumulated.Max = Eigen::Array3f::Constant(-g_FloatInf);
+				uint32_t leftCount = 0;
+				for (uint32_t binIdx = 0; binIdx < binsNum - 1; binIdx++)
+				{
+					accumulated.Min = accumulated.Min.min(binMins[axisIdx][binIdx]);
+					accumulated.Max = accumulated.Max.max(binMaxs[axisIdx][binIdx]);
+					leftCount += binCounts[axisIdx][binIdx];
+
+					if (leftCount == 0 || leftCount == InRange.Count)
+						continue;
+
+					const float currentCost = leftCount * accumulated.HalfArea() + rightRanges[binIdx].Count * rightRanges[binIdx].HalfArea();
+					if (currentCost < bestCost)
+					{
+						bestCost = currentCost;
+						bestAxisIdx = axisIdx;
+						bestBinIdx = binIdx;
+						bestLeft = accumulated;
+						bestRight = rightRanges[binIdx];
+					}
+				}
+			}
+
+			if (bestCost < g_FloatInf)
+			{
+				std::partition(m_BuildPrims.begin() + InRange.First, m_BuildPrims.begin() + InRange.First + InRange.Count,
+					[&](const BuildPrimitive& InPrim) { return computeBin(InPrim.Center[bestAxisIdx], bestAxisIdx) <= bestBinIdx; });
+
+				OutLeft = bestLeft;
+				OutLeft.First = InRange.First;
+				OutLeft.Count = InRange.Count - bestRight.Count;
+
+				OutRight = bestRight;
+				OutRight.First = InRange.First + OutLeft.Count;
+				return;
+			}
+
+			// All the centroids are in the same point, splitting in the middle
+			OutLeft.First = InRange.First;
+			OutLeft.Count = InRange.Count / 2;
+			ComputeRangeBounds(OutLeft);
+
+			OutRight.First = InRange.First + OutLeft.Count;
+			OutRight.Count = InRange.Count - OutLeft.Count;
+			ComputeRangeBounds(OutRight);
+		}
+
+		void BoundingVolumeHierarchy::Refit(const AABBS_SOA& InAABBs)
+		{
+			const uint32_t primsNum = GetObjectsNum();
+
+			m_PrimMinX.resize(primsNum); m_PrimMinY.resize(primsNum); m_PrimMinZ.resize(primsNum);
+			m_PrimMaxX.resize(primsNum); m_PrimMaxY.resize(primsNum); m_PrimMaxZ.resize(primsNum);
+
+			for (uint32_t primIdx = 0; primIdx < primsNum; primIdx++)
+			{
+				const uint32_t objectIdx = m_PrimIndices[primIdx];
+				m_PrimMinX[primIdx] = InAABBs.CenterX[objectIdx] - InAABBs.ExtentX[objectIdx];
+				m_PrimMinY[primIdx] = InAABBs.CenterY[objectIdx] - InAABBs.ExtentY[objectIdx];
+				m_PrimMinZ[primIdx] = InAABBs.CenterZ[objectIdx] - InAABBs.ExtentZ[objectIdx];
+				m_PrimMaxX[primIdx] = InAABBs.CenterX[objectIdx] + InAABBs.ExtentX[objectIdx];
+				m_PrimMaxY[primIdx] = InAABBs.CenterY[objectIdx] + InAABBs.ExtentY[objectIdx];
+				m_PrimMaxZ[primIdx] = InAABBs.CenterZ[objectIdx] + InAABBs.ExtentZ[objectIdx];
+			}
+
+			// Children always have a greater index than their parent, so visiting nodes backwards refits them bottom-up
+			for (size_t nodeIdx = m_Nodes.size(); nodeIdx-- > 0;)
+			{
+				BVH4_NODE& currentNode = m_Nodes[nodeIdx];
+				for (uint32_t childIdx = 0; childIdx < 4; childIdx++)
+				{
+					float minX = g_FloatInf, minY = g_FloatInf, minZ = g_FloatInf;
+					float maxX = -g_FloatInf, maxY = -g_FloatInf, maxZ = -g_FloatInf;
+
+					if (currentNode.Children[childIdx] == g_BVHLeafChild)
+					{
+						const uint32_t primEnd = currentNode.PrimFirst[childIdx] + currentNode.PrimCount[childIdx];
+						for (uint32_t primIdx = currentNode.PrimFirst[childIdx]; primIdx < primEnd; primIdx++)
+						{
+							minX = std::min(minX, m_PrimMinX[primIdx]); minY = std::min(minY, m_PrimMinY[primIdx]); minZ = std::min(minZ, m_PrimMinZ[primIdx]);
+							maxX = std::max(maxX, m_PrimMaxX[primIdx]); maxY = std::max(maxY, m_PrimMaxY[primIdx]); maxZ = std::max(maxZ, m_PrimMaxZ[primIdx]);
+						}
+					}
+					else
+					{
+						const BVH4_NODE& childNode = m_Nodes[currentNode.Children[childIdx]];
+						for (uint32_t grandChildIdx = 0; grandChildIdx < 4; grandChildIdx++)
+						{
+							if (childNode.PrimCount[grandChildIdx] == 0)
+								continue;
+							minX = std::min(minX, childNode.MinX[grandChildIdx]); minY = std::min(minY, childNode.MinY[grandChildIdx]); minZ = std::min(minZ, childNode.MinZ[grandChildIdx]);
+							maxX = std::max(maxX, childNode.MaxX[grandChildIdx]); maxY = std::max(maxY, childNode.MaxY[grandChildIdx]); maxZ = std::max(maxZ, childNode.MaxZ[grandChildIdx]);
+						}
+					}
+
+					// Empty slots keep inverted infinite bounds, their center is NaN and fails every frustum test
+					currentNode.MinX[childIdx] = minX; currentNode.MinY[childIdx] = minY; currentNode.MinZ[childIdx] = minZ;
+					currentNode.MaxX[childIdx] = maxX; currentNode.MaxY[childIdx] = maxY; currentNode.MaxZ[childIdx] = maxZ;
+				}
+			}
+		}
+
+		uint32_t BoundingVolumeHierarchy::QueryFrustum(const FRUSTUM_PLANES& InPlanes, uint32_t* OutVisibleIndices) const
+		{
+			if (m_Nodes.empty())
+				return 0;
+
+			__m128 planeNormalX[FRUSTUM_PLANES_NUM], planeNormalY[FRUSTUM_PLANES_NUM], planeNormalZ[FRUSTUM_PLANES_NUM], planeD[FRUSTUM_PLANES_NUM];
+			__m128 planeAbsNormalX[FRUSTUM_PLANES_NUM], planeAbsNormalY[FRUSTUM_PLANES_NUM], planeAbsNormalZ[FRUSTUM_PLANES_NUM];
+			for (uint32_t planeIdx = 0; planeIdx < FRUSTUM_PLANES_NUM; planeIdx++)
+			{
+				const Eigen::Vector4f& currentPlane = InPlanes.Planes[planeIdx];
+				planeNormalX[planeIdx] = _mm_set1_ps(currentPlane.x());
+				planeNormalY[planeIdx] = _mm_set1_ps(currentPlane.y());
+				planeNormalZ[planeIdx] = _mm_set1_ps(currentPlane.z());
+				planeD[planeIdx] = _mm_set1_ps(currentPlane.w());
+				planeAbsNormalX[planeIdx] = _mm_set1_ps(std::abs(currentPlane.x()));
+				planeAbsNormalY[planeIdx] = _mm_set1_ps(std::abs(currentPlane.y()));
+				planeAbsNormalZ[planeIdx] = _mm_set1_ps(std::abs(currentPlane.z()));
+			}
+
+			const __m128 half = _mm_set1_ps(0.5f);
+
+			uint32_t nodeStack[g_BVHStackSize];
+			uint32_t stackSize = 0;
+			nodeStack[stackSize++] = 0;
+
+			uint32_t visibleNum = 0;
+			while (stackSize > 0)
+			{
+				const BVH4_NODE& currentNode = m_Nodes[nodeStack[--stackSize]];
+
+				const __m128 minX = _mm_load_ps(currentNode.MinX), maxX = _mm_load_ps(currentNode.MaxX);
+				const __m128 minY = _mm_load_ps(currentNode.MinY), maxY = _mm_load_ps(currentNode.MaxY);
+				const __m128 minZ = _mm_load_ps(currentNode.MinZ), maxZ = _mm_load_ps(currentNode.MaxZ);
+				const __m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half), extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+				const __m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half), extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+				const __m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half), extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+				// A child intersects when it is not entirely behind any plane, and it is entirely inside when it is in front of all of them
+				__m128 intersecting = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				__m128 inside = intersecting;
+				for (uint32_t planeIdx = 0; planeIdx < FRUSTUM_PLANES_NUM; planeIdx++)
+				{
+					__m128 centerDistance = _mm_add_ps(_mm_mul_ps(planeNormalX[planeIdx], centerX), planeD[planeIdx]);
+					centerDistance = _mm_add_ps(centerDistance, _mm_mul_ps(planeNormalY[planeIdx], centerY));
+					centerDistance = _mm_add_ps(centerDistance, _mm_mul_ps(planeNormalZ[planeIdx], centerZ));
+
+					__m128 projectedRadius = _mm_mul_ps(planeAbsNormalX[planeIdx], extentX);
+					projectedRadius = _mm_add_ps(projectedRadius, _mm_mul_ps(planeAbsNormalY[planeIdx], extentY));
+					projectedRadius = _mm_add_ps(projectedRadius, _mm_mul_ps(planeAbsNormalZ[planeIdx], extentZ));
+
+					intersecting = _mm_and_ps(intersecting, _mm_cmpge_ps(_mm_add_ps(centerDistance, projectedRadius), _mm_setzero_ps()));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_sub_ps(centerDistance, projectedRadius), _mm_setzero_ps()));
+				}
+
+				const int intersectingMask = _mm_movemask_ps(intersecting);
+				const int insideMask = _mm_movemask_ps(inside);
+
+				for (uint32_t childIdx = 0; childIdx < 4; childIdx++)
+				{
+					if (!(intersectingMask & (1 << childIdx)) || currentNode.PrimCount[childIdx] == 0)
+						continue;
+
+					const uint32_t primFirst = currentNode.PrimFirst[childIdx];
+					const uint32_t primCount = currentNode.PrimCount[childIdx];
+
+					if (insideMask & (1 << childIdx))
+					{
+						// The whole subtree is visible and its primitives are contiguous
+						std::memcpy(OutVisibleIndices + visibleNum, m_PrimIndices.data() + primFirst, primCount * sizeof(uint32_t));
+						visibleNum += primCount;
+					}
+					else if (currentNode.Children[childIdx] == g_BVHLeafChild)
+					{
+						for (uint32_t primIdx = primFirst; primIdx < primFirst + primCount; primIdx++)
+						{
+							const Eigen::Vector3f primMin(m_PrimMinX[primIdx], m_PrimMinY[primIdx], m_PrimMinZ[primIdx]);
+							const Eigen::Vector3f primMax(m_PrimMaxX[primIdx], m_PrimMaxY[primIdx], m_PrimMaxZ[primIdx]);
+							const Eigen::Vector3f primCenter = (primMin + primMax) * 0.5f;
+							const Eigen::Vector3f primExtent = (primMax - primMin) * 0.5f;
+
+							bool isVisible = true;
+							for (const Eigen::Vector4f& currentPlane : InPlanes.Planes)
+								isVisible &= currentPlane.head<3>().dot(primCenter) + currentPlane.head<3>().cwiseAbs().dot(primExtent) + currentPlane.w() >= 0.f;
+
+							if (isVisible)
+								OutVisibleIndices[visibleNum++] = m_PrimIndices[primIdx];
+						}
+					}
+					else
+					{
+						nodeStack[stackSize++] = currentNode.Children[childIdx];
+					}
+				}
+			}
+
+			return visibleNum;
+		}
+
+		// Slab test, returns the entry distance or infinity when the box is missed
+		static inline float RayBoxDistance(const Eigen::Array3f& InOrigin, const Eigen::Array3f& InInvDirection, const Eigen::Array3f& InMin, const Eigen::Array3f& InMax, float InMaxDistance)
+		{
+			const Eigen::Array3f t0 = (InMin - InOrigin) * InInvDirection;
+			const Eigen::Array3f t1 = (InMax - InOrigin) * InInvDirection;
+			const float tNear = std::max(t0.min(t1).maxCoeff(), 0.f);
+			const float tFar = std::min(t0.max(t1).minCoeff(), InMaxDistance);
+			return tNear <= tFar ? tNear : g_FloatInf;
+		}
+
+		bool BoundingVolumeHierarchy::RayCast(const Eigen::Vector3f& InOrigin, const Eigen::Vector3f& InDirection, float InMaxDistance, uint32_t& OutObjectIdx, float& OutDistance) const
+		{
+			if (m_Nodes.empty())
+				return false;
+
+			// Zero direction components are replaced by tiny ones, so that slabs give infinities of the right sign instead of NaNs
+			Eigen::Array3f invDirection;
+			for (uint32_t axisIdx = 0; axisIdx < 3; axisIdx++)
+			{
+				const float axisDirection = InDirection[axisIdx];
+				invDirection[axisIdx] = 1.f / (std::abs(axisDirection) > 1e-30f ? axisDirection : std::copysign(1e-30f, axisDirection));
+			}
+			const Eigen::Array3f origin = InOrigin.array();
+
+			const __m128 originX = _mm_set1_ps(origin.x()), originY = _mm_set1_ps(origin.y()), originZ = _mm_set1_ps(origin.z());
+			const __m128 invDirX = _mm_set1_ps(invDirection.x()), invDirY = _mm_set1_ps(invDirection.y()), invDirZ = _mm_set1_ps(invDirection.z());
+
+			struct StackEntry { uint32_t NodeIdx; float Distance; };
+			StackEntry nodeStack[g_BVHStackSize];
+			uint32_t stackSize = 0;
+			nodeStack[stackSize++] = { 0, 0.f };
+
+			float closestDistance = InMaxDistance;
+			bool hasHit = false;
+
+			while (stackSize > 0)
+			{
+				const StackEntry currentEntry = nodeStack[--stackSize];
+				if (currentEntry.Distance > closestDistance)
+					continue;
+
+				const BVH4_NODE& currentNode = m_Nodes[currentEntry.NodeIdx];
+
+				const __m128 t0X = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(currentNode.MinX), originX), invDirX);
+				const __m128 t1X = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(currentNode.MaxX), originX), invDirX);
+				const __m128 t0Y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(currentNode.MinY), originY), invDirY);
+				const __m128 t1Y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(currentNode.MaxY), originY), invDirY);
+				const __m128 t0Z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(currentNode.MinZ), originZ), invDirZ);
+				const __m128 t1Z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(currentNode.MaxZ), originZ), invDirZ);
+
+				__m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0X, t1X), _mm_min_ps(t0Y, t1Y)), _mm_max_ps(_mm_min_ps(t0Z, t1Z), _mm_setzero_ps()));
+				__m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0X, t1X), _mm_max_ps(t0Y, t1Y)), _mm_min_ps(_mm_max_ps(t0Z, t1Z), _mm_set1_ps(closestDistance)));
+				const int hitMask = _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+
+				alignas(16) float childDistances[4];
+				_mm_store_ps(childDistances, tNear);
+
+				StackEntry hitChildren[4];
+				uint32_t hitChildrenNum = 0;
+
+				for (uint32_t childIdx = 0; childIdx < 4; childIdx++)
+				{
+					// Note: empty slots have inverted infinite bounds that the slab test can report as hit, so they are skipped by count
+					if (!(hitMask & (1 << childIdx)) || currentNode.PrimCount[childIdx] == 0)
+						continue;
+
+					if (currentNode.Children[childIdx] == g_BVHLeafChild)
+					{
+						const uint32_t primEnd = currentNode.PrimFirst[childIdx] + currentNode.PrimCount[childIdx];
+						for (uint32_t primIdx = currentNode.PrimFirst[childIdx]; primIdx < primEnd; primIdx++)
+						{
+							const float primDistance = RayBoxDistance(origin, invDirection,
+								Eigen::Array3f(m_PrimMinX[primIdx], m_PrimMinY[primIdx], m_PrimMinZ[primIdx]), Eigen::Array3f(m_PrimMaxX[primIdx], m_PrimMaxY[primIdx], m_PrimMaxZ[primIdx]), closestDistance);
+							if (primDistance != g_FloatInf)
+							{
+								closestDistance = primDistance;
+								OutObjectIdx = m_PrimIndices[primIdx];
+								hasHit = true;
+							}
+						}
+					}
+					else
+					{
+						hitChildren[hitChildrenNum++] = { currentNode.Children[childIdx], childDistances[childIdx] };
+					}
+				}
+
+				// Pushing the farthest first, so that the nearest child is visited next and can shrink the search distance for the others.
+				// Note: insertion sort of at most 4 entries, std::sort triggers false array bounds warnings in GCC here.
+				for (uint32_t hitChildIdx = 1; hitChildIdx < hitChildrenNum; hitChildIdx++)
+				{
+					const StackEntry insertedEntry = hitChildren[hitChildIdx];
+					uint32_t insertIdx = hitChildIdx;
+					for (; insertIdx > 0 && hitChildren[insertIdx - 1].Distance < insertedEntry.Distance; insertIdx--)
+						hitChildren[insertIdx] = hitChildren[insertIdx - 1];
+					hitChildren[insertIdx] = insertedEntry;
+				}
+				for (uint32_t hitChildIdx = 0; hitChildIdx < hitChildrenNum; hitChildIdx++)
+					nodeStack[stackSize++] = hitChildren[hitChildIdx];
+			}
+
+			if (hasHit)
+				OutDistance = closestDistance;
+
+			return hasHit;
+		}
+
+	}
+}
@@ -0,0 +1,227 @@
+/*
+ GEPUtilsCulling.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsCulling.h"
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include "GEPUtilsThreadPool.h"
+
+namespace GEPUtils {
+	namespace Geometry {
+
+		FRUSTUM_PLANES ExtractFrustumPlanes(const Eigen::Matrix4f& InViewProjMatrix)
+		{
+			// Gribb-Hartmann extraction: with Eigen column vectors, clip = M * P, so each clip space condition (e.g. -w <= x) is a combination of rows of M.
+			// D3D clip space has 0 <= z <= w, so the near plane is the third row alone.
+			const Eigen::Vector4f row0 = InViewProjMatrix.row(0).transpose();
+			const Eigen::Vector4f row1 = InViewProjMatrix.row(1).transpose();
+			const Eigen::Vector4f row2 = InViewProjMatrix.row(2).transpose();
+			const Eigen::Vector4f row3 = InViewProjMatrix.row(3).transpose();
+
+			FRUSTUM_PLANES outPlanes;
+			outPlanes.Planes[FRUSTUM_PLANE_LEFT] = row3 + row0;
+			outPlanes.Planes[FRUSTUM_PLANE_RIGHT] = row3 - row0;
+			outPlanes.Planes[FRUSTUM_PLANE_BOTTOM] = row3 + row1;
+			outPlanes.Planes[FRUSTUM_PLANE_TOP] = row3 - row1;
+			outPlanes.Planes[FRUSTUM_PLANE_NEAR] = row2;
+			outPlanes.Planes[FRUSTUM_PLANE_FAR] = row3 - row2;
+
+			// Normalizing makes plane equations return distances, so they can be compared with radii and extents
+			for (Eigen::Vector4f& currentPlane : outPlanes.Planes)
+				currentPlane /= currentPlane.head<3>().norm();
+
+			return outPlanes;
+		}
+
+		// Plane components broadcast to all the 4 lanes
+		struct FrustumPlanesSSE {
+			__m128 NormalX[FRUSTUM_PLANES_NUM];
+			__m128 NormalY[FRUSTUM_PLANES_NUM];
+			__m128 NormalZ[FRUSTUM_PLANES_NUM];
+			__m128 D[FRUSTUM_PLANES_NUM];
+		};
+
+		static FrustumPlanesSSE SplatPlanes(const FRUSTUM_PLANES& InPlanes, bool InAbsNormals)
+		{
+			FrustumPlanesSSE outPlanes;
+			for (uint32_t planeIdx = 0; planeIdx < FRUSTUM_PLANES_NUM; planeIdx++)
+			{
+				const Eigen::Vector4f& currentPlane = InPlanes.Planes[planeIdx];
+				outPlanes.NormalX[planeIdx] = _mm_set1_ps(InAbsNormals ? std::abs(currentPlane.x()) : currentPlane.x());
+				outPlanes.NormalY[planeIdx] = _mm_set1_ps(InAbsNormals ? std::abs(currentPlane.y()) : currentPlane.y());
+				outPlanes.NormalZ[planeIdx] = _mm_set1_ps(InAbsNormals ? std::abs(currentPlane.z()) : currentPlane.z());
+				outPlanes.D[planeIdx] = _mm_set1_ps(currentPlane.w());
+			}
+			return outPlanes;
+		}
+
+		// Branchless compaction: every lane writes its index, but the output position only advances for visible ones.
+		// Writes never go past the number of objects processed so far, so the output only needs space for all the objects.
+		static inline uint32_t AppendVisibleIndices(int InVisibleMask, uint32_t InFirstIdx, uint32_t* OutVisibleIndices, uint32_t InVisibleNum)
+		{
+			OutVisibleIndices[InVisibleNum] = InFirstIdx;
+			InVisibleNum += InVisibleMask & 1;
+			OutVisibleIndices[InVisibleNum] = InFirstIdx + 1;
+			InVisibleNum += (InVisibleMask >> 1) & 1;
+			OutVisibleIndices[InVisibleNum] = InFirstIdx + 2;
+			InVisibleNum += (InVisibleMask >> 2) & 1;
+			OutVisibleIndices[InVisibleNum] = InFirstIdx + 3;
+			InVisibleNum += (InVisibleMask >> 3) & 1;
+			return InVisibleNum;
+		}
+
+		uint32_t CullSpheres(const FRUSTUM_PLANES& InPlanes, const BOUNDING_SPHERES_SOA& InSpheres, uint32_t InBegin, uint32_t InEnd, uint32_t* OutVisibleIndices)
+		{
+			const FrustumPlanesSSE planes = SplatPlanes(InPlanes, false);
+
+			uint32_t visibleNum = 0;
+			uint32_t objectIdx = InBegin;
+
+			for (; objectIdx + 4 <= InEnd; objectIdx += 4)
+			{
+				const __m128 centerX = _mm_loadu_ps(InSpheres.CenterX + objectIdx);
+				const __m128 centerY = _mm_loadu_ps(InSpheres.CenterY + objectIdx);
+				const __m128 centerZ = _mm_loadu_ps(InSpheres.CenterZ + objectIdx);
+				const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(InSpheres.Radius + objectIdx));
+
+				// A sphere is visible when it is not entirely behind any plane: distance >= -radius for all of them
+				__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (uint32_t planeIdx = 0; planeIdx < FRUSTUM_PLANES_NUM; planeIdx++)
+				{
+					__m128 distance = _mm_add_ps(_mm_mul_ps(planes.NormalX[planeIdx], centerX), planes.D[planeIdx]);
+					distance = _mm_add_ps(distance, _mm_mul_ps(planes.NormalY[planeIdx], centerY));
+					distance = _mm_add_ps(distance, _mm_mul_ps(planes.NormalZ[planeIdx], centerZ));
+					visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negRadius));
+				}
+
+				visibleNum = AppendVisibleIndices(_mm_movemask_ps(visible), objectIdx, OutVisibleIndices, visibleNum);
+			}
+
+			for (; objectIdx < InEnd; objectIdx++)
+			{
+				const Eigen::Vector3f center(InSpheres.CenterX[objectIdx], InSpheres.CenterY[objectIdx], InSpheres.CenterZ[objectIdx]);
+				if (IsSphereInFrustum(InPlanes, center, InSpheres.Radius[objectIdx]))
+					OutVisibleIndices[visibleNum++] = objectIdx;
+			}
+
+			return visibleNum;
+		}
+
+		uint32_t CullAABBs(const FRUSTUM_PLANES& InPlanes, const AABBS_SOA& InAABBs, uint32_t InBegin, uint32_t InEnd, uint32_t* OutVisibleIndices)
+		{
+			const FrustumPlanesSSE planes = SplatPlanes(InPlanes, false);
+			const FrustumPlanesSSE absPlanes = SplatPlanes(InPlanes, true);
+
+			uint32_t visibleNum = 0;
+			uint32_t objectIdx = InBegin;
+
+			for (; objectIdx + 4 <= InEnd; objectIdx += 4)
+			{
+				const __m128 centerX = _mm_loadu_ps(InAABBs.CenterX + objectIdx);
+				const __m128 centerY = _mm_loadu_ps(InAABBs.CenterY + objectIdx);
+				const __m128 centerZ = _mm_loadu_ps(InAABBs.CenterZ + objectIdx);
+				const __m128 extentX = _mm_loadu_ps(InAABBs.ExtentX + objectIdx);
+				const __m128 extentY = _mm_loadu_ps(InAABBs.ExtentY + objectIdx);
+				const __m128 extentZ = _mm_loadu_ps(InAABBs.ExtentZ + objectIdx);
+
+				// The box projected on the plane normal has radius |Nx| Ex + |Ny| Ey + |Nz| Ez, 
+				// the box is visible when center distance + projected radius >= 0 for all the planes
+				__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (uint32_t planeIdx = 0; planeIdx < FRUSTUM_PLANES_NUM; planeIdx++)
+				{
+					__m128 distance = _mm_add_ps(_mm_mul_ps(planes.NormalX[planeIdx], centerX), planes.D[planeIdx]);
+					distance = _mm_add_ps(distance, _mm_mul_ps(planes.NormalY[planeIdx], centerY));
+					distance = _mm_add_ps(distance, _mm_mul_ps(planes.NormalZ[planeIdx], centerZ));
+					distance = _mm_add_ps(distance, _mm_mul_ps(absPlanes.NormalX[planeIdx], extentX));
+					distance = _mm_add_ps(distance, _mm_mul_ps(absPlanes.NormalY[planeIdx], extentY));
+					distance = _mm_add_ps(distance, _mm_mul_ps(absPlanes.NormalZ[planeIdx], extentZ));
+					visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+				}
+
+				visibleNum = AppendVisibleIndices(_mm_movemask_ps(visible), objectIdx, OutVisibleIndices, visibleNum);
+			}
+
+			for (; objectIdx < InEnd; objectIdx++)
+			{
+				const Eigen::Vector3f center(InAABBs.CenterX[objectIdx], InAABBs.CenterY[objectIdx], InAABBs.CenterZ[objectIdx]);
+				const Eigen::Vector3f extent(InAABBs.ExtentX[objectIdx], InAABBs.ExtentY[objectIdx], InAABBs.ExtentZ[objectIdx]);
+
+				bool isVisible = true;
+				for (const Eigen::Vector4f& currentPlane : InPlanes.Planes)
+					isVisible &= currentPlane.head<3>().dot(center) + currentPlane.head<3>().cwiseAbs().dot(extent) + currentPlane.w() >= 0.f;
+
+				if (isVisible)
+					OutVisibleIndices[visibleNum++] = objectIdx;
+			}
+
+			return visibleNum;
+		}
+
+		FrustumCuller::FrustumCuller(GEPUtils::ThreadPool* InThreadPool /*= nullptr*/, uint32_t InMinObjectsPerPartition /*= 16 * 1024*/)
+			: m_ThreadPool(InThreadPool), m_MinObjectsPerPartition(InMinObjectsPerPartition)
+		{ }
+
+		uint32_t FrustumCuller::CullSpheres(const FRUSTUM_PLANES& InPlanes, const BOUNDING_SPHERES_SOA& InSpheres, uint32_t InObjectsNum, uint32_t* OutVisibleIndices)
+		{
+			return CullPartitioned(InObjectsNum, OutVisibleIndices, [&InPlanes, &InSpheres](uint32_t InBegin, uint32_t InEnd, uint32_t* OutPartitionIndices) {
+				return GEPUtils::Geometry::CullSpheres(InPlanes, InSpheres, InBegin, InEnd, OutPartitionIndices);
+			});
+		}
+
+		uint32_t FrustumCuller::CullAABBs(const FRUSTUM_PLANES& InPlanes, const AABBS_SOA& InAABBs, uint32_t InObjectsNum, uint32_t* OutVisibleIndices)
+		{
+			return CullPartitioned(InObjectsNum, OutVisibleIndices, [&InPlanes, &InAABBs](uint32_t InBegin, uint32_t InEnd, uint32_t* OutPartitionIndices) {
+				return GEPUtils::Geometry::CullAABBs(InPlanes, InAABBs, InBegin, InEnd, OutPartitionIndices);
+			});
+		}
+
+		template<typename KernelFnType>
+		uint32_t FrustumCuller::CullPartitioned(uint32_t InObjectsNum, uint32_t* OutVisibleIndices, const KernelFnType& InKernel)
+		{
+			const uint32_t threadsNum = m_ThreadPool ? m_ThreadPool->GetThreadsNum() + 1 : 1;
+
+			// Partitions are multiple of 4 objects, so that only the last one has a scalar tail
+			uint32_t partitionSize = std::max((InObjectsNum + threadsNum - 1) / threadsNum, m_MinObjectsPerPartition);
+			partitionSize = (partitionSize + 3) & ~3u;
+
+			const uint32_t partitionsNum = partitionSize > 0 ? (InObjectsNum + partitionSize - 1) / partitionSize : 0;
+
+			if (partitionsNum <= 1)
+				return InKernel(0, InObjectsNum, OutVisibleIndices);
+
+			m_PartitionVisibleNums.resize(partitionsNum);
+			uint32_t* partitionVisibleNums = m_PartitionVisibleNums.data();
+
+			GEPUtils::TaskGroup partitionsGroup;
+			for (uint32_t partitionIdx = 1; partitionIdx < partitionsNum; partitionIdx++)
+			{
+				m_ThreadPool->Enqueue([&InKernel, partitionIdx, partitionSize, InObjectsNum, OutVisibleIndices, partitionVisibleNums]() {
+					const uint32_t partitionBegin = partitionIdx * partitionSize;
+					const uint32_t partitionEnd = std::min(partitionBegin + partitionSize, InObjectsNum);
+					partitionVisibleNums[partitionIdx] = InKernel(partitionBegin, partitionEnd, OutVisibleIndices + partitionBegin);
+				}, partitionsGroup);
+			}
+
+			partitionVisibleNums[0] = InKernel(0, partitionSize, OutVisibleIndices);
+
+			m_ThreadPool->Wait(partitionsGroup);
+
+			// Moving each partition result right after the previous one, the first one is already in place
+			uint32_t visibleNum = partitionVisibleNums[0];
+			for (uint32_t partitionIdx = 1; partitionIdx < partitionsNum; partitionIdx++)
+			{
+				std::memmove(OutVisibleIndices + visibleNum, OutVisibleIndices + partitionIdx * partitionSize, partitionVisibleNums[partitionIdx] * sizeof(uint32_t));
+				visibleNum += partitionVisibleNums[partitionIdx];
+			}
+
+			return visibleNum;
+		}
+
+	}
+}
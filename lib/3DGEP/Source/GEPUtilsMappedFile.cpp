@@ -0,0 +1,189 @@
+/*
+ GEPUtilsMappedFile.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsMappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GEPUtils {
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+	std::string WideToUtf8(const std::wstring& InWideString)
+	{
+		if (InWideString.empty())
+			return std::string();
+
+		const int wideSize = static_cast<int>(InWideString.size());
+		const int outSize = ::WideCharToMultiByte(CP_UTF8, 0, InWideString.data(), wideSize, nullptr, 0, nullptr, nullptr);
+		std::string outString(static_cast<size_t>(outSize), '\0');
+		::WideCharToMultiByte(CP_UTF8, 0, InWideString.data(), wideSize, &outString[0], outSize, nullptr, nullptr);
+		return outString;
+	}
+
+	bool MappedFile::Open(const std::string& InFilePath)
+	{
+		Close();
+
+		HANDLE fileHandle = ::CreateFileA(InFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return false;
+
+		return MapFileHandle(fileHandle);
+	}
+
+	bool MappedFile::Open(const std::wstring& InFilePath)
+	{
+		Close();
+
+		HANDLE fileHandle = ::CreateFileW(InFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return false;
+
+		return MapFileHandle(fileHandle);
+	}
+
+	bool MappedFile::MapFileHandle(void* InFileHandle)
+	{
+		HANDLE fileHandle = static_cast<HANDLE>(InFileHandle);
+
+		LARGE_INTEGER fileSize = {};
+		FILETIME lastWriteTime = {};
+		if (!::GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0 || !::GetFileTime(fileHandle, nullptr, nullptr, &lastWriteTime))
+		{
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		HANDLE mappingHandle = ::CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr)
+		{
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		const void* mappedData = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (mappedData == nullptr)
+		{
+			::CloseHandle(mappingHandle);
+			::CloseHandle(fileHandle);
+			return false;
+		}
+
+		m_FileHandle = fileHandle;
+		m_MappingHandle = mappingHandle;
+		m_Data = static_cast<const uint8_t*>(mappedData);
+		m_Size = static_cast<size_t>(fileSize.QuadPart);
+		m_LastWriteTime = (static_cast<uint64_t>(lastWriteTime.dwHighDateTime) << 32) | lastWriteTime.dwLowDateTime;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+			::UnmapViewOfFile(m_Data);
+		if (m_MappingHandle)
+			::CloseHandle(m_MappingHandle);
+		if (m_FileHandle)
+			::CloseHandle(m_FileHandle);
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_LastWriteTime = 0;
+		m_MappingHandle = nullptr;
+		m_FileHandle = nullptr;
+	}
+#else
+	std::string WideToUtf8(const std::wstring& InWideString)
+	{
+		// wchar_t holds UTF-32 code points on POSIX platforms
+		std::string outString;
+		outString.reserve(InWideString.size());
+		for (wchar_t currentChar : InWideString)
+		{
+			const uint32_t codePoint = static_cast<uint32_t>(currentChar);
+			if (codePoint < 0x80)
+				outString += static_cast<char>(codePoint);
+			else if (codePoint < 0x800)
+			{
+				outString += static_cast<char>(0xC0 | (codePoint >> 6));
+				outString += static_cast<char>(0x80 | (codePoint & 0x3F));
+			}
+			else if (codePoint < 0x10000)
+			{
+				outString += static_cast<char>(0xE0 | (codePoint >> 12));
+				outString += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+				outString += static_cast<char>(0x80 | (codePoint & 0x3F));
+			}
+			else
+			{
+				outString += static_cast<char>(0xF0 | (codePoint >> 18));
+				outString += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+				outString += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+				outString += static_cast<char>(0x80 | (codePoint & 0x3F));
+			}
+		}
+		return outString;
+	}
+
+	bool MappedFile::Open(const std::string& InFilePath)
+	{
+		Close();
+
+		const int fileDescriptor = ::open(InFilePath.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+			return false;
+
+		struct stat fileStats = {};
+		if (::fstat(fileDescriptor, &fileStats) != 0 || fileStats.st_size == 0)
+		{
+			::close(fileDescriptor);
+			return false;
+		}
+
+		void* mappedData = ::mmap(nullptr, static_cast<size_t>(fileStats.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		// Note: the mapping stays valid after closing the file descriptor
+		::close(fileDescriptor);
+		if (mappedData == MAP_FAILED)
+			return false;
+
+		m_Data = static_cast<const uint8_t*>(mappedData);
+		m_Size = static_cast<size_t>(fileStats.st_size);
+		m_LastWriteTime = static_cast<uint64_t>(fileStats.st_mtim.tv_sec) * 1000000000ull + static_cast<uint64_t>(fileStats.st_mtim.tv_nsec);
+		return true;
+	}
+
+	bool MappedFile::Open(const std::wstring& InFilePath)
+	{
+		// POSIX paths are byte strings, wide paths are converted to UTF-8
+		return Open(WideToUtf8(InFilePath));
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+			::munmap(const_cast<uint8_t*>(m_Data), m_Size);
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_LastWriteTime = 0;
+	}
+#endif
+
+}
@@ -0,0 +1,361 @@
+/*
+ GEPUtilsOcclusion.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsOcclusion.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <emmintrin.h>
+#include "GEPUtilsThreadPool.h"
+
+namespace GEPUtils {
+	namespace Geometry {
+
+		OcclusionRasterizer::OcclusionRasterizer(uint32_t InWidth /*= 320*/, uint32_t InHeight /*= 192*/)
+		{
+			m_TilesX = std::max((InWidth + g_OcclusionTileSize - 1) / g_OcclusionTileSize, 1u);
+			m_TilesY = std::max((InHeight + g_OcclusionTileSize - 1) / g_OcclusionTileSize, 1u);
+			m_Width = m_TilesX * g_OcclusionTileSize;
+			m_Height = m_TilesY * g_OcclusionTileSize;
+
+			m_TileTriangles.resize(m_TilesX * m_TilesY);
+
+			// Levels go down to a single texel, odd sizes are rounded up
+			uint32_t levelWidth = m_Width, levelHeight = m_Height;
+			while (true)
+			{
+				m_HiZLevels.push_back({ levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, 1.f) });
+				if (levelWidth == 1 && levelHeight == 1)
+					break;
+				levelWidth = (levelWidth + 1) / 2;
+				levelHeight = (levelHeight + 1) / 2;
+			}
+
+			m_ViewProjMatrix.setIdentity();
+		}
+
+		void OcclusionRasterizer::BeginFrame(const Eigen::Matrix4f& InViewProjMatrix)
+		{
+			m_ViewProjMatrix = InViewProjMatrix;
+
+			m_Triangles.clear();
+			for (std::vector<uint32_t>& currentTileTriangles : m_TileTriangles)
+				currentTileTriangles.clear();
+		}
+
+		void OcclusionRasterizer::AddOccluder(const void* InPositions, uint32_t InVertexStride, uint32_t InVerticesNum, const uint16_t* InIndices, uint32_t InIndicesNum, const Eigen::Matrix4f& InModelMatrix)
+		{
+			AddOccluderTriangles(InPositions, InVertexStride, InVerticesNum, InIndices, InIndicesNum, InModelMatrix);
+		}
+
+		void OcclusionRasterizer::AddOccluder(const void* InPositions, uint32_t InVertexStride, uint32_t InVerticesNum, const uint32_t* InIndices, uint32_t InIndicesNum, const Eigen::Matrix4f& InModelMatrix)
+		{
+			AddOccluderTriangles(InPositions, InVertexStride, InVerticesNum, InIndices, InIndicesNum, InModelMatrix);
+		}
+
+		template<typename IndexType>
+		void OcclusionRasterizer::AddOccluderTriangles(const void* InPositions, uint32_t InVertexStride, uint32_t InVerticesNum, const IndexType* InIndices, uint32_t InIndicesNum, const Eigen::Matrix4f& InModelMatrix)
+		{
+			const Eigen::Matrix4f modelViewProj = m_ViewProjMatrix * InModelMatrix;
+
+			m_ClipVertices.resize(InVerticesNum);
+			const uint8_t* positionBytes = static_cast<const uint8_t*>(InPositions);
+			for (uint32_t vertexIdx = 0; vertexIdx < InVerticesNum; vertexIdx++)
+			{
+				const float* currentPosition = reinterpret_cast<const float*>(positionBytes + static_cast<size_t>(vertexIdx) * InVertexStride);
+				m_ClipVertices[vertexIdx] = modelViewProj * Eigen::Vector4f(currentPosition[0], currentPosition[1], currentPosition[2], 1.f);
+			}
+
+			for (uint32_t firstIndex = 0; firstIndex + 2 < InIndicesNum; firstIndex += 3)
+				SetupTriangle(m_ClipVertices[InIndices[firstIndex]], m_ClipVertices[InIndices[firstIndex + 1]], m_ClipVertices[InIndices[firstIndex + 2]]);
+		}
+
+		void OcclusionRasterizer::SetupTriangle(const Eigen::Vector4f& InClip0, const Eigen::Vector4f& InClip1, const Eigen::Vector4f& InClip2)
+		{
+			// D3D clip space has 0 <= z. Triangles crossing the near plane are dropped rather than clipped, as documented in AddOccluder(..):
+			// losing an occluder can only make more objects visible, never hide a visible one
+			if (InClip0.z() < 0.f || InClip1.z() < 0.f || InClip2.z() < 0.f)
+				return;
+
+			// Trivial rejection when all the vertices are outside the same side of the screen
+			const Eigen::Vector4f* clipVertices[3] = { &InClip0, &InClip1, &InClip2 };
+			for (uint32_t axisIdx = 0; axisIdx < 2; axisIdx++)
+			{
+				if (InClip0[axisIdx] > InClip0.w() && InClip1[axisIdx] > InClip1.w() && InClip2[axisIdx] > InClip2.w())
+					return;
+				if (InClip0[axisIdx] < -InClip0.w() && InClip1[axisIdx] < -InClip1.w() && InClip2[axisIdx] < -InClip2.w())
+					return;
+			}
+
+			// To pixels, with y going down as D3D viewports
+			float x[3], y[3], z[3];
+			for (uint32_t vertexIdx = 0; vertexIdx < 3; vertexIdx++)
+			{
+				const Eigen::Vector4f& currentClip = *clipVertices[vertexIdx];
+				const float invW = 1.f / currentClip.w();
+				x[vertexIdx] = (currentClip.x() * invW * 0.5f + 0.5f) * m_Width;
+				y[vertexIdx] = (0.5f - currentClip.y() * invW * 0.5f) * m_Height;
+				z[vertexIdx] = currentClip.z() * invW;
+			}
+
+			float doubleArea = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+			if (doubleArea == 0.f)
+				return;
+
+			// Making the winding consistent, so that inside points have all the edge functions positive
+			if (doubleArea < 0.f)
+			{
+				std::swap(x[1], x[2]);
+				std::swap(y[1], y[2]);
+				std::swap(z[1], z[2]);
+				doubleArea = -doubleArea;
+			}
+
+			TRIANGLE_SETUP newTriangle;
+
+			// Bounds of the pixel centers that can be covered
+			newTriangle.MinX = std::max(static_cast<int32_t>(std::floor(std::min({ x[0], x[1], x[2] }))), 0);
+			newTriangle.MinY = std::max(static_cast<int32_t>(std::floor(std::min({ y[0], y[1], y[2] }))), 0);
+			newTriangle.MaxX = std::min(static_cast<int32_t>(std::ceil(std::max({ x[0], x[1], x[2] }))), static_cast<int32_t>(m_Width) - 1);
+			newTriangle.MaxY = std::min(static_cast<int32_t>(std::ceil(std::max({ y[0], y[1], y[2] }))), static_cast<int32_t>(m_Height) - 1);
+			if (newTriangle.MinX > newTriangle.MaxX || newTriangle.MinY > newTriangle.MaxY)
+				return;
+
+			for (uint32_t edgeIdx = 0; edgeIdx < 3; edgeIdx++)
+			{
+				const uint32_t startIdx = edgeIdx, endIdx = (edgeIdx + 1) % 3;
+				newTriangle.EdgeA[edgeIdx] = y[startIdx] - y[endIdx];
+				newTriangle.EdgeB[edgeIdx] = x[endIdx] - x[startIdx];
+				newTriangle.EdgeC[edgeIdx] = x[startIdx] * y[endIdx] - x[endIdx] * y[startIdx];
+			}
+
+			// z/w is linear in screen space, so depth is a plane
+			newTriangle.DepthDx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / doubleArea;
+			newTriangle.DepthDy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / doubleArea;
+			newTriangle.Depth0 = z[0] - newTriangle.DepthDx * x[0] - newTriangle.DepthDy * y[0];
+
+			const uint32_t triangleIdx = static_cast<uint32_t>(m_Triangles.size());
+			m_Triangles.push_back(newTriangle);
+
+			for (int32_t tileY = newTriangle.MinY / g_OcclusionTileSize; tileY <= newTriangle.MaxY / static_cast<int32_t>(g_OcclusionTileSize); tileY++)
+			{
+				for (int32_t tileX = newTriangle.MinX / g_OcclusionTileSize; tileX <= newTriangle.MaxX / static_cast<int32_t>(g_OcclusionTileSize); tileX++)
+					m_TileTriangles[tileY * m_TilesX + tileX].push_back(triangleIdx);
+			}
+		}
+
+		void OcclusionRasterizer::Rasterize(GEPUtils::ThreadPool* InThreadPool /*= nullptr*/)
+		{
+			const uint32_t tilesNum = m_TilesX * m_TilesY;
+
+			// Tiles are picked dynamically, since their cost depends on how many triangles they contain
+			std::atomic<uint32_t> nextTileIdx(0);
+			auto rasterizeTilesFn = [this, &nextTileIdx, tilesNum]() {
+				for (uint32_t tileIdx = nextTileIdx++; tileIdx < tilesNum; tileIdx = nextTileIdx++)
+					RasterizeTile(tileIdx);
+			};
+
+			GEPUtils::TaskGroup tilesGroup;
+			if (InThreadPool)
+			{
+				for (uint32_t threadIdx = 0; threadIdx < InThreadPool->GetThreadsNum(); threadIdx++)
+					InThreadPool->Enqueue(rasterizeTilesFn, tilesGroup);
+			}
+
+			rasterizeTilesFn();
+
+			// Tasks that did not start yet find no tiles left and return right away
+			if (InThreadPool)
+				InThreadPool->Wait(tilesGroup);
+
+			BuildHiZ();
+		}
+
+		void OcclusionRasterizer::RasterizeTile(uint32_t InTileIdx)
+		{
+			const int32_t tileMinX = static_cast<int32_t>((InTileIdx % m_TilesX) * g_OcclusionTileSize);
+			const int32_t tileMinY = static_cast<int32_t>((InTileIdx / m_TilesX) * g_OcclusionTileSize);
+			const int32_t tileMaxX = tileMinX + g_OcclusionTileSize - 1;
+			const int32_t tileMaxY = tileMinY + g_OcclusionTileSize - 1;
+
+			float* depthBuffer = m_HiZLevels[0].MaxDepths.data();
+
+			for (int32_t pixelY = tileMinY; pixelY <= tileMaxY; pixelY++)
+				std::fill_n(depthBuffer + pixelY * m_Width + tileMinX, g_OcclusionTileSize, 1.f);
+
+			const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+			for (uint32_t triangleIdx : m_TileTriangles[InTileIdx])
+			{
+				const TRIANGLE_SETUP& currentTriangle = m_Triangles[triangleIdx];
+
+				// Rows are processed in groups of 4 pixels, tiles are multiple of 4 pixels wide so groups never cross the tile
+				const int32_t minX = std::max(currentTriangle.MinX, tileMinX) & ~3;
+				const int32_t maxX = std::min(currentTriangle.MaxX, tileMaxX);
+				const int32_t minY = std::max(currentTriangle.MinY, tileMinY);
+				const int32_t maxY = std::min(currentTriangle.MaxY, tileMaxY);
+
+				const __m128 edgeA0 = _mm_set1_ps(currentTriangle.EdgeA[0]), edgeB0 = _mm_set1_ps(currentTriangle.EdgeB[0]), edgeC0 = _mm_set1_ps(currentTriangle.EdgeC[0]);
+				const __m128 edgeA1 = _mm_set1_ps(currentTriangle.EdgeA[1]), edgeB1 = _mm_set1_ps(currentTriangle.EdgeB[1]), edgeC1 = _mm_set1_ps(currentTriangle.EdgeC[1]);
+				const __m128 edgeA2 = _mm_set1_ps(currentTriangle.EdgeA[2]), edgeB2 = _mm_set1_ps(currentTriangle.EdgeB[2]), edgeC2 = _mm_set1_ps(currentTriangle.EdgeC[2]);
+				const __m128 depthDx = _mm_set1_ps(currentTriangle.DepthDx), depthDy = _mm_set1_ps(currentTriangle.DepthDy), depth0 = _mm_set1_ps(currentTriangle.Depth0);
+				const __m128 zero = _mm_setzero_ps();
+
+				for (int32_t pixelY = minY; pixelY <= maxY; pixelY++)
+				{
+					const __m128 centerY = _mm_set1_ps(pixelY + 0.5f);
+
+					// Row constant terms of the edge functions and depth
+					const __m128 rowEdge0 = _mm_add_ps(_mm_mul_ps(edgeB0, centerY), edgeC0);
+					const __m128 rowEdge1 = _mm_add_ps(_mm_mul_ps(edgeB1, centerY), edgeC1);
+					const __m128 rowEdge2 = _mm_add_ps(_mm_mul_ps(edgeB2, centerY), edgeC2);
+					const __m128 rowDepth = _mm_add_ps(_mm_mul_ps(depthDy, centerY), depth0);
+
+					float* depthRow = depthBuffer + pixelY * m_Width;
+
+					for (int32_t pixelX = minX; pixelX <= maxX; pixelX += 4)
+					{
+						const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(pixelX)), laneOffsets);
+
+						__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, centerX), rowEdge0), zero);
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, centerX), rowEdge1), zero));
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, centerX), rowEdge2), zero));
+
+						if (_mm_movemask_ps(inside) == 0)
+							continue;
+
+						const __m128 triangleDepth = _mm_add_ps(_mm_mul_ps(depthDx, centerX), rowDepth);
+						const __m128 currentDepth = _mm_loadu_ps(depthRow + pixelX);
+
+						// SSE2 has no blend, selecting with masks
+						const __m128 isCloser = _mm_and_ps(inside, _mm_cmplt_ps(triangleDepth, currentDepth));
+						_mm_storeu_ps(depthRow + pixelX, _mm_or_ps(_mm_and_ps(isCloser, triangleDepth), _mm_andnot_ps(isCloser, currentDepth)));
+					}
+				}
+			}
+		}
+
+		void OcclusionRasterizer::BuildHiZ()
+		{
+			for (size_t levelIdx = 1; levelIdx < m_HiZLevels.size(); levelIdx++)
+			{
+				const HiZLevel& sourceLevel = m_HiZLevels[levelIdx - 1];
+				HiZLevel& destLevel = m_HiZLevels[levelIdx];
+
+				for (uint32_t texelY = 0; texelY < destLevel.Height; texelY++)
+				{
+					// Odd sizes repeat the last row and column of the source level
+					const uint32_t sourceY0 = texelY * 2, sourceY1 = std::min(texelY * 2 + 1, sourceLevel.Height - 1);
+					for (uint32_t texelX = 0; texelX < destLevel.Width; texelX++)
+					{
+						const uint32_t sourceX0 = texelX * 2, sourceX1 = std::min(texelX * 2 + 1, sourceLevel.Width - 1);
+						const float maxDepth0 = std::max(sourceLevel.MaxDepths[sourceY0 * sourceLevel.Width + sourceX0], sourceLevel.MaxDepths[sourceY0 * sourceLevel.Width + sourceX1]);
+						const float maxDepth1 = std::max(sourceLevel.MaxDepths[sourceY1 * sourceLevel.Width + sourceX0], sourceLevel.MaxDepths[sourceY1 * sourceLevel.Width + sourceX1]);
+						destLevel.MaxDepths[texelY * destLevel.Width + texelX] = std::max(maxDepth0, maxDepth1);
+					}
+				}
+			}
+		}
+
+		static inline float HorizontalMin(__m128 InValues)
+		{
+			InValues = _mm_min_ps(InValues, _mm_shuffle_ps(InValues, InValues, _MM_SHUFFLE(1, 0, 3, 2)));
+			InValues = _mm_min_ps(InValues, _mm_shuffle_ps(InValues, InValues, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(InValues);
+		}
+
+		static inline float HorizontalMax(__m128 InValues)
+		{
+			InValues = _mm_max_ps(InValues, _mm_shuffle_ps(InValues, InValues, _MM_SHUFFLE(1, 0, 3, 2)));
+			InValues = _mm_max_ps(InValues, _mm_shuffle_ps(InValues, InValues, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(InValues);
+		}
+
+		bool OcclusionRasterizer::IsAABBVisible(const Eigen::Vector3f& InMin, const Eigen::Vector3f& InMax) const
+		{
+			// Corners in clip space are the transformed min corner plus any combination of the transformed box axes
+			const Eigen::Vector3f boxSize = InMax - InMin;
+			const Eigen::Vector4f clipMin = m_ViewProjMatrix * Eigen::Vector4f(InMin.x(), InMin.y(), InMin.z(), 1.f);
+			const Eigen::Vector4f clipAxisX = m_ViewProjMatrix.col(0) * boxSize.x();
+			const Eigen::Vector4f clipAxisY = m_ViewProjMatrix.col(1) * boxSize.y();
+			const Eigen::Vector4f clipAxisZ = m_ViewProjMatrix.col(2) * boxSize.z();
+
+			// The 8 corners are processed as two groups of 4 (near and far Z side of the box), one component per register
+			const __m128 cornerHasAxisX = _mm_setr_ps(0.f, 1.f, 0.f, 1.f);
+			const __m128 cornerHasAxisY = _mm_setr_ps(0.f, 0.f, 1.f, 1.f);
+			__m128 cornerComponents[4][2];
+			for (uint32_t componentIdx = 0; componentIdx < 4; componentIdx++)
+			{
+				__m128 nearCorners = _mm_add_ps(_mm_set1_ps(clipMin[componentIdx]), _mm_mul_ps(_mm_set1_ps(clipAxisX[componentIdx]), cornerHasAxisX));
+				nearCorners = _mm_add_ps(nearCorners, _mm_mul_ps(_mm_set1_ps(clipAxisY[componentIdx]), cornerHasAxisY));
+				cornerComponents[componentIdx][0] = nearCorners;
+				cornerComponents[componentIdx][1] = _mm_add_ps(nearCorners, _mm_set1_ps(clipAxisZ[componentIdx]));
+			}
+
+			// Boxes crossing the near plane are too close to be tested
+			const __m128 zero = _mm_setzero_ps();
+			if (_mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(cornerComponents[2][0], zero), _mm_cmplt_ps(cornerComponents[2][1], zero))) != 0)
+				return true;
+
+			const __m128 halfWidth = _mm_set1_ps(0.5f * m_Width), halfHeight = _mm_set1_ps(0.5f * m_Height);
+			__m128 screenX[2], screenY[2], depth[2];
+			for (uint32_t groupIdx = 0; groupIdx < 2; groupIdx++)
+			{
+				const __m128 invW = _mm_div_ps(_mm_set1_ps(1.f), cornerComponents[3][groupIdx]);
+				screenX[groupIdx] = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cornerComponents[0][groupIdx], invW), halfWidth), halfWidth);
+				screenY[groupIdx] = _mm_sub_ps(halfHeight, _mm_mul_ps(_mm_mul_ps(cornerComponents[1][groupIdx], invW), halfHeight));
+				depth[groupIdx] = _mm_mul_ps(cornerComponents[2][groupIdx], invW);
+			}
+
+			const float minX = HorizontalMin(_mm_min_ps(screenX[0], screenX[1])), maxX = HorizontalMax(_mm_max_ps(screenX[0], screenX[1]));
+			const float minY = HorizontalMin(_mm_min_ps(screenY[0], screenY[1])), maxY = HorizontalMax(_mm_max_ps(screenY[0], screenY[1]));
+			const float minDepth = HorizontalMin(_mm_min_ps(depth[0], depth[1]));
+
+			// Pixels whose area touches the box rectangle
+			const int32_t rectMinX = std::max(static_cast<int32_t>(std::floor(std::max(minX, -1.f))), 0);
+			const int32_t rectMinY = std::max(static_cast<int32_t>(std::floor(std::max(minY, -1.f))), 0);
+			const int32_t rectMaxX = std::min(static_cast<int32_t>(std::floor(std::min(maxX, static_cast<float>(m_Width)))), static_cast<int32_t>(m_Width) - 1);
+			const int32_t rectMaxY = std::min(static_cast<int32_t>(std::floor(std::min(maxY, static_cast<float>(m_Height)))), static_cast<int32_t>(m_Height) - 1);
+			if (rectMinX > rectMaxX || rectMinY > rectMaxY)
+				return false;
+
+			// Going up the hierarchy until the rectangle covers at most 4x4 texels
+			uint32_t levelIdx = 0;
+			while (levelIdx + 1 < m_HiZLevels.size() && (((rectMaxX >> levelIdx) - (rectMinX >> levelIdx)) > 3 || ((rectMaxY >> levelIdx) - (rectMinY >> levelIdx)) > 3))
+				levelIdx++;
+
+			const HiZLevel& testLevel = m_HiZLevels[levelIdx];
+			for (int32_t texelY = rectMinY >> levelIdx; texelY <= (rectMaxY >> levelIdx); texelY++)
+			{
+				for (int32_t texelX = rectMinX >> levelIdx; texelX <= (rectMaxX >> levelIdx); texelX++)
+				{
+					if (minDepth <= testLevel.MaxDepths[texelY * testLevel.Width + texelX])
+						return true;
+				}
+			}
+
+			return false;
+		}
+
+		uint32_t OcclusionRasterizer::FilterVisibleAABBs(const AABBS_SOA& InAABBs, uint32_t* InOutIndices, uint32_t InIndicesNum) const
+		{
+			uint32_t visibleNum = 0;
+			for (uint32_t inputIdx = 0; inputIdx < InIndicesNum; inputIdx++)
+			{
+				const uint32_t objectIdx = InOutIndices[inputIdx];
+				const Eigen::Vector3f center(InAABBs.CenterX[objectIdx], InAABBs.CenterY[objectIdx], InAABBs.CenterZ[objectIdx]);
+				const Eigen::Vector3f extent(InAABBs.ExtentX[objectIdx], InAABBs.ExtentY[objectIdx], InAABBs.ExtentZ[objectIdx]);
+
+				if (IsAABBVisible(center - extent, center + extent))
+					InOutIndices[visibleNum++] = objectIdx;
+			}
+			return visibleNum;
+		}
+
+	}
+}
@@ -0,0 +1,104 @@
+/*
+ GEPUtilsSceneGraph.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsSceneGraph.h"
+#include <algorithm>
+#include "GEPUtils.h"
+
+namespace GEPUtils {
+	namespace Geometry {
+
+		SceneGraph::SceneGraph(uint32_t InExpectedNodesNum /*= 0*/)
+		{
+			m_ParentIndices.reserve(InExpectedNodesNum);
+			m_LocalPositions.reserve(InExpectedNodesNum);
+			m_LocalRotations.reserve(InExpectedNodesNum);
+			m_LocalScales.reserve(InExpectedNodesNum);
+			m_WorldTransforms.reserve(InExpectedNodesNum);
+			m_IsDirty.reserve(InExpectedNodesNum);
+		}
+
+		uint32_t SceneGraph::AddNode(uint32_t InParentIdx, const Eigen::Vector3f& InLocalPosition, const Eigen::Quaternionf& InLocalRotation, const Eigen::Vector3f& InLocalScale)
+		{
+			const uint32_t newNodeIdx = GetNodesNum();
+
+			Check(InParentIdx == g_SceneGraphNoParent || InParentIdx < newNodeIdx);
+
+			m_ParentIndices.push_back(InParentIdx);
+			m_LocalPositions.push_back(InLocalPosition);
+			m_LocalRotations.push_back(InLocalRotation);
+			m_LocalScales.push_back(InLocalScale);
+			m_WorldTransforms.push_back(Eigen::Affine3f::Identity());
+			m_IsDirty.push_back(0);
+
+			MarkDirty(newNodeIdx);
+
+			return newNodeIdx;
+		}
+
+		void SceneGraph::SetLocalPosition(uint32_t InNodeIdx, const Eigen::Vector3f& InPosition)
+		{
+			m_LocalPositions[InNodeIdx] = InPosition;
+			MarkDirty(InNodeIdx);
+		}
+
+		void SceneGraph::SetLocalRotation(uint32_t InNodeIdx, const Eigen::Quaternionf& InRotation)
+		{
+			m_LocalRotations[InNodeIdx] = InRotation;
+			MarkDirty(InNodeIdx);
+		}
+
+		void SceneGraph::SetLocalScale(uint32_t InNodeIdx, const Eigen::Vector3f& InScale)
+		{
+			m_LocalScales[InNodeIdx] = InScale;
+			MarkDirty(InNodeIdx);
+		}
+
+		void SceneGraph::MarkDirty(uint32_t InNodeIdx)
+		{
+			// Note: descendants are not flagged here, the sweep propagates the flag from parents to children
+			m_IsDirty[InNodeIdx] = 1;
+			m_FirstDirtyNode = std::min(m_FirstDirtyNode, InNodeIdx);
+		}
+
+		void SceneGraph::UpdateWorldMatrices()
+		{
+			m_UpdatedNodes.clear();
+
+			const uint32_t nodesNum = GetNodesNum();
+
+			for (uint32_t nodeIdx = m_FirstDirtyNode; nodeIdx < nodesNum; nodeIdx++)
+			{
+				const uint32_t parentIdx = m_ParentIndices[nodeIdx];
+				const bool isParentDirty = parentIdx != g_SceneGraphNoParent && m_IsDirty[parentIdx];
+
+				if (!m_IsDirty[nodeIdx] && !isParentDirty)
+					continue;
+
+				m_IsDirty[nodeIdx] = 1;
+
+				// World = ParentWorld * T * R * S, as affine transforms, so the product skips the last row
+				Eigen::Affine3f localTransform;
+				localTransform.linear() = m_LocalRotations[nodeIdx].toRotationMatrix() * m_LocalScales[nodeIdx].asDiagonal();
+				localTransform.translation() = m_LocalPositions[nodeIdx];
+				localTransform.makeAffine();
+
+				m_WorldTransforms[nodeIdx] = parentIdx != g_SceneGraphNoParent ? m_WorldTransforms[parentIdx] * localTransform : localTransform;
+
+				m_UpdatedNodes.push_back(nodeIdx);
+			}
+
+			// Flags are cleared only after the sweep, since children read the ones of their parents
+			if (m_FirstDirtyNode < nodesNum)
+				std::fill(m_IsDirty.begin() + m_FirstDirtyNode, m_IsDirty.end(), static_cast<uint8_t>(0));
+
+			m_FirstDirtyNode = nodesNum;
+		}
+
+	}
+}
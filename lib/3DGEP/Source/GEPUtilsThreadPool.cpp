@@ -0,0 +1,142 @@
+/*
+ GEPUtilsThreadPool.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsThreadPool.h"
+#include <algorithm>
+
+namespace GEPUtils {
+
+	ThreadPool::ThreadPool(uint32_t InThreadsNum /*= 0*/)
+	{
+		if (InThreadsNum == 0)
+		{
+			// Note: hardware_concurrency() can return 0 when the value is not computable
+			const uint32_t hardwareThreadsNum = std::thread::hardware_concurrency();
+			InThreadsNum = hardwareThreadsNum > 1 ? hardwareThreadsNum - 1 : 1;
+		}
+
+		m_Threads.reserve(InThreadsNum);
+		for (uint32_t threadIdx = 0; threadIdx < InThreadsNum; threadIdx++)
+			m_Threads.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsStopping = true;
+		}
+		m_TaskAvailableCV.notify_all();
+
+		for (std::thread& currentThread : m_Threads)
+			currentThread.join();
+	}
+
+	void ThreadPool::Enqueue(std::function<void()> InTask)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Tasks.push_back({ std::move(InTask), nullptr });
+		}
+		m_TaskAvailableCV.notify_one();
+	}
+
+	void ThreadPool::Enqueue(std::function<void()> InTask, TaskGroup& InGroup)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Tasks.push_back({ std::move(InTask), &InGroup });
+			InGroup.m_PendingTasksNum++;
+		}
+		m_TaskAvailableCV.notify_one();
+	}
+
+	void ThreadPool::Wait(TaskGroup& InGroup)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (InGroup.m_PendingTasksNum > 0)
+		{
+			// Helping with the tasks of the group that no worker picked yet, otherwise waiting for the ones executing
+			const auto groupTaskIt = std::find_if(m_Tasks.begin(), m_Tasks.end(), [&InGroup](const QueuedTask& InTask) { return InTask.Group == &InGroup; });
+			if (groupTaskIt == m_Tasks.end())
+			{
+				m_GroupDoneCV.wait(lock);
+				continue;
+			}
+
+			QueuedTask currentTask = std::move(*groupTaskIt);
+			m_Tasks.erase(groupTaskIt);
+			ExecuteTask(currentTask, lock);
+		}
+	}
+
+	void ThreadPool::WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_IdleCV.wait(lock, [this]() { return m_Tasks.empty() && m_ExecutingTasksNum == 0; });
+	}
+
+	void ThreadPool::ParallelFor(uint32_t InItemsNum, uint32_t InMinItemsPerRange, const std::function<void(uint32_t, uint32_t)>& InRangeFn)
+	{
+		if (InItemsNum == 0)
+			return;
+
+		InMinItemsPerRange = InMinItemsPerRange > 0 ? InMinItemsPerRange : 1;
+
+		// Ranges sizes are rounded up to multiples of the minimum size
+		const uint32_t threadsNum = GetThreadsNum() + 1;
+		uint32_t rangeSize = (InItemsNum + threadsNum - 1) / threadsNum;
+		rangeSize = (rangeSize + InMinItemsPerRange - 1) / InMinItemsPerRange * InMinItemsPerRange;
+
+		TaskGroup rangesGroup;
+		for (uint32_t rangeBegin = rangeSize; rangeBegin < InItemsNum; rangeBegin += rangeSize)
+		{
+			const uint32_t rangeEnd = rangeBegin + rangeSize < InItemsNum ? rangeBegin + rangeSize : InItemsNum;
+			Enqueue([&InRangeFn, rangeBegin, rangeEnd]() { InRangeFn(rangeBegin, rangeEnd); }, rangesGroup);
+		}
+
+		InRangeFn(0, rangeSize < InItemsNum ? rangeSize : InItemsNum);
+
+		Wait(rangesGroup);
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while (true)
+		{
+			m_TaskAvailableCV.wait(lock, [this]() { return m_IsStopping || !m_Tasks.empty(); });
+
+			// Stopping only once the queue is drained
+			if (m_Tasks.empty())
+				return;
+
+			QueuedTask currentTask = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+			ExecuteTask(currentTask, lock);
+		}
+	}
+
+	void ThreadPool::ExecuteTask(QueuedTask& InTask, std::unique_lock<std::mutex>& InLock)
+	{
+		m_ExecutingTasksNum++;
+
+		InLock.unlock();
+		InTask.Function();
+		InLock.lock();
+
+		m_ExecutingTasksNum--;
+		if (m_Tasks.empty() && m_ExecutingTasksNum == 0)
+			m_IdleCV.notify_all();
+
+		// Waiters of different groups share the condition variable, each one checks its own counter
+		if (InTask.Group && --InTask.Group->m_PendingTasksNum == 0)
+			m_GroupDoneCV.notify_all();
+	}
+
+}
@@ -0,0 +1,176 @@
+/*
+ GEPUtilsTransforms.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsTransforms.h"
+#include <cstring>
+#include <emmintrin.h>
+#include "GEPUtilsThreadPool.h"
+
+namespace GEPUtils {
+	namespace Geometry {
+
+		// Objects given to each worker, enough to amortize the task overhead
+		static constexpr uint32_t g_TransformMinObjectsPerTask = 1024;
+
+		TransformSystem::TransformSystem(uint32_t InExpectedObjectsNum /*= 0*/)
+		{
+			const size_t paddedNum = (InExpectedObjectsNum + 3) & ~3u;
+			for (std::vector<float>* currentArray : { &m_PositionsX, &m_PositionsY, &m_PositionsZ, &m_RotationsX, &m_RotationsY, &m_RotationsZ, &m_RotationsW, &m_ScalesX, &m_ScalesY, &m_ScalesZ })
+				currentArray->reserve(paddedNum);
+		}
+
+		uint32_t TransformSystem::AddObject(const Eigen::Vector3f& InPosition, const Eigen::Quaternionf& InRotation, const Eigen::Vector3f& InScale)
+		{
+			const uint32_t newObjectIdx = m_ObjectsNum++;
+
+			// Growing by a whole SIMD group, padding objects have zero scale
+			if (newObjectIdx % 4 == 0)
+			{
+				for (std::vector<float>* currentArray : { &m_PositionsX, &m_PositionsY, &m_PositionsZ, &m_RotationsX, &m_RotationsY, &m_RotationsZ, &m_ScalesX, &m_ScalesY, &m_ScalesZ })
+					currentArray->resize(currentArray->size() + 4, 0.f);
+				m_RotationsW.resize(m_RotationsW.size() + 4, 1.f);
+			}
+
+			SetPosition(newObjectIdx, InPosition);
+			SetRotation(newObjectIdx, InRotation);
+			SetScale(newObjectIdx, InScale);
+
+			return newObjectIdx;
+		}
+
+		void TransformSystem::SetPosition(uint32_t InObjectIdx, const Eigen::Vector3f& InPosition)
+		{
+			m_PositionsX[InObjectIdx] = InPosition.x();
+			m_PositionsY[InObjectIdx] = InPosition.y();
+			m_PositionsZ[InObjectIdx] = InPosition.z();
+		}
+
+		void TransformSystem::SetRotation(uint32_t InObjectIdx, const Eigen::Quaternionf& InRotation)
+		{
+			m_RotationsX[InObjectIdx] = InRotation.x();
+			m_RotationsY[InObjectIdx] = InRotation.y();
+			m_RotationsZ[InObjectIdx] = InRotation.z();
+			m_RotationsW[InObjectIdx] = InRotation.w();
+		}
+
+		void TransformSystem::SetScale(uint32_t InObjectIdx, const Eigen::Vector3f& InScale)
+		{
+			m_ScalesX[InObjectIdx] = InScale.x();
+			m_ScalesY[InObjectIdx] = InScale.y();
+			m_ScalesZ[InObjectIdx] = InScale.z();
+		}
+
+		void TransformSystem::ComputeMatrices(const Eigen::Matrix4f& InViewProjMatrix, const TRANSFORM_OUTPUT_DESC& InOutputDesc, GEPUtils::ThreadPool* InThreadPool /*= nullptr*/) const
+		{
+			if (!InThreadPool)
+			{
+				ComputeMatricesRange(InViewProjMatrix, InOutputDesc, 0, m_ObjectsNum);
+				return;
+			}
+
+			InThreadPool->ParallelFor(m_ObjectsNum, g_TransformMinObjectsPerTask, [this, &InViewProjMatrix, &InOutputDesc](uint32_t InBegin, uint32_t InEnd) {
+				ComputeMatricesRange(InViewProjMatrix, InOutputDesc, InBegin, InEnd);
+			});
+		}
+
+		// Writes a matrix column of 4 objects, given its 4 elements with one object per lane
+		static inline void StoreColumn(__m128 InElement0, __m128 InElement1, __m128 InElement2, __m128 InElement3, uint8_t* InDestination, uint32_t InStride, uint32_t InObjectsNum)
+		{
+			// After the transpose, each register holds the column of a single object
+			_MM_TRANSPOSE4_PS(InElement0, InElement1, InElement2, InElement3);
+
+			if (InObjectsNum == 4)
+			{
+				_mm_storeu_ps(reinterpret_cast<float*>(InDestination), InElement0);
+				_mm_storeu_ps(reinterpret_cast<float*>(InDestination + InStride), InElement1);
+				_mm_storeu_ps(reinterpret_cast<float*>(InDestination + 2 * InStride), InElement2);
+				_mm_storeu_ps(reinterpret_cast<float*>(InDestination + 3 * InStride), InElement3);
+				return;
+			}
+
+			// Last group of the array, only the valid objects are written
+			const __m128 objectColumns[4] = { InElement0, InElement1, InElement2, InElement3 };
+			for (uint32_t objectIdx = 0; objectIdx < InObjectsNum; objectIdx++)
+				_mm_storeu_ps(reinterpret_cast<float*>(InDestination + objectIdx * InStride), objectColumns[objectIdx]);
+		}
+
+		// Column of ViewProj * World, given the column of World with 0 (direction) or 1 (position) as last element
+		static inline void StoreMvpColumn(const __m128 (&InViewProj)[4][4], __m128 InWorld0, __m128 InWorld1, __m128 InWorld2, bool InIsPosition, uint8_t* InDestination, uint32_t InStride, uint32_t InObjectsNum)
+		{
+			__m128 mvpElements[4];
+			for (uint32_t rowIdx = 0; rowIdx < 4; rowIdx++)
+			{
+				__m128 currentElement = _mm_add_ps(_mm_mul_ps(InViewProj[rowIdx][0], InWorld0), _mm_mul_ps(InViewProj[rowIdx][1], InWorld1));
+				currentElement = _mm_add_ps(currentElement, _mm_mul_ps(InViewProj[rowIdx][2], InWorld2));
+				mvpElements[rowIdx] = InIsPosition ? _mm_add_ps(currentElement, InViewProj[rowIdx][3]) : currentElement;
+			}
+			StoreColumn(mvpElements[0], mvpElements[1], mvpElements[2], mvpElements[3], InDestination, InStride, InObjectsNum);
+		}
+
+		void TransformSystem::ComputeMatricesRange(const Eigen::Matrix4f& InViewProjMatrix, const TRANSFORM_OUTPUT_DESC& InOutputDesc, uint32_t InBegin, uint32_t InEnd) const
+		{
+			__m128 viewProj[4][4];
+			for (uint32_t rowIdx = 0; rowIdx < 4; rowIdx++)
+			{
+				for (uint32_t columnIdx = 0; columnIdx < 4; columnIdx++)
+					viewProj[rowIdx][columnIdx] = _mm_set1_ps(InViewProjMatrix(rowIdx, columnIdx));
+			}
+
+			const __m128 one = _mm_set1_ps(1.f), two = _mm_set1_ps(2.f), zero = _mm_setzero_ps();
+			uint8_t* destination = static_cast<uint8_t*>(InOutputDesc.Destination);
+
+			for (uint32_t groupBegin = InBegin; groupBegin < InEnd; groupBegin += 4)
+			{
+				const __m128 quatX = _mm_loadu_ps(&m_RotationsX[groupBegin]), quatY = _mm_loadu_ps(&m_RotationsY[groupBegin]);
+				const __m128 quatZ = _mm_loadu_ps(&m_RotationsZ[groupBegin]), quatW = _mm_loadu_ps(&m_RotationsW[groupBegin]);
+				const __m128 scaleX = _mm_loadu_ps(&m_ScalesX[groupBegin]), scaleY = _mm_loadu_ps(&m_ScalesY[groupBegin]), scaleZ = _mm_loadu_ps(&m_ScalesZ[groupBegin]);
+
+				// Rotation matrix of a unit quaternion, same as Eigen::Quaternionf::toRotationMatrix()
+				const __m128 twoX = _mm_mul_ps(quatX, two), twoY = _mm_mul_ps(quatY, two), twoZ = _mm_mul_ps(quatZ, two);
+				const __m128 xx = _mm_mul_ps(twoX, quatX), yy = _mm_mul_ps(twoY, quatY), zz = _mm_mul_ps(twoZ, quatZ);
+				const __m128 xy = _mm_mul_ps(twoY, quatX), xz = _mm_mul_ps(twoZ, quatX), yz = _mm_mul_ps(twoZ, quatY);
+				const __m128 wx = _mm_mul_ps(twoX, quatW), wy = _mm_mul_ps(twoY, quatW), wz = _mm_mul_ps(twoZ, quatW);
+
+				// Upper 3x4 part of World = T * R * S, named by [row][column], the last row is always (0, 0, 0, 1)
+				const __m128 world00 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scaleX);
+				const __m128 world10 = _mm_mul_ps(_mm_add_ps(xy, wz), scaleX);
+				const __m128 world20 = _mm_mul_ps(_mm_sub_ps(xz, wy), scaleX);
+				const __m128 world01 = _mm_mul_ps(_mm_sub_ps(xy, wz), scaleY);
+				const __m128 world11 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scaleY);
+				const __m128 world21 = _mm_mul_ps(_mm_add_ps(yz, wx), scaleY);
+				const __m128 world02 = _mm_mul_ps(_mm_add_ps(xz, wy), scaleZ);
+				const __m128 world12 = _mm_mul_ps(_mm_sub_ps(yz, wx), scaleZ);
+				const __m128 world22 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scaleZ);
+				const __m128 world03 = _mm_loadu_ps(&m_PositionsX[groupBegin]);
+				const __m128 world13 = _mm_loadu_ps(&m_PositionsY[groupBegin]);
+				const __m128 world23 = _mm_loadu_ps(&m_PositionsZ[groupBegin]);
+
+				const uint32_t groupObjectsNum = InEnd - groupBegin < 4 ? InEnd - groupBegin : 4;
+				const uint32_t stride = InOutputDesc.Stride;
+				uint8_t* groupDestination = destination + static_cast<size_t>(groupBegin) * stride;
+
+				// MVP = ViewProj * World, exploiting the known last row of World
+				uint8_t* mvpDestination = groupDestination + InOutputDesc.MvpOffset;
+				StoreMvpColumn(viewProj, world00, world10, world20, false, mvpDestination, stride, groupObjectsNum);
+				StoreMvpColumn(viewProj, world01, world11, world21, false, mvpDestination + 16, stride, groupObjectsNum);
+				StoreMvpColumn(viewProj, world02, world12, world22, false, mvpDestination + 32, stride, groupObjectsNum);
+				StoreMvpColumn(viewProj, world03, world13, world23, true, mvpDestination + 48, stride, groupObjectsNum);
+
+				if (InOutputDesc.WorldOffset != g_TransformNoOutput)
+				{
+					uint8_t* worldDestination = groupDestination + InOutputDesc.WorldOffset;
+					StoreColumn(world00, world10, world20, zero, worldDestination, stride, groupObjectsNum);
+					StoreColumn(world01, world11, world21, zero, worldDestination + 16, stride, groupObjectsNum);
+					StoreColumn(world02, world12, world22, zero, worldDestination + 32, stride, groupObjectsNum);
+					StoreColumn(world03, world13, world23, one, worldDestination + 48, stride, groupObjectsNum);
+				}
+			}
+		}
+
+	}
+}
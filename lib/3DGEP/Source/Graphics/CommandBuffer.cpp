@@ -0,0 +1,564 @@
+/*
+ CommandBuffer.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "CommandBuffer.h"
+#include <algorithm>
+#include "CommandList.h"
+#include "GEPUtils.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	CommandArena& CommandArena::GetForCurrentThread()
+	{
+		thread_local CommandArena threadArena;
+		return threadArena;
+	}
+
+	CommandArena::Block* CommandArena::AcquireBlock()
+	{
+		if (m_FreeBlocks.empty())
+		{
+			m_Blocks.push_back(std::make_unique<Block>());
+			m_Blocks.back()->m_Capacity = BlockSize;
+			m_Blocks.back()->m_Data.reset(new uint8_t[BlockSize]);
+			m_FreeBlocks.push_back(m_Blocks.back().get());
+		}
+
+		Block* outBlock = m_FreeBlocks.back();
+		m_FreeBlocks.pop_back();
+		outBlock->m_UsedSize = 0;
+		return outBlock;
+	}
+
+	CommandArena::Block* CommandArena::AcquireDedicatedBlock(size_t InSize)
+	{
+		m_DedicatedBlocks.push_back(std::make_unique<Block>());
+		Block* outBlock = m_DedicatedBlocks.back().get();
+		outBlock->m_Capacity = InSize;
+		outBlock->m_Data.reset(new uint8_t[InSize]);
+		return outBlock;
+	}
+
+	void CommandArena::ReleaseBlock(Block* InBlock)
+	{
+		if (InBlock->m_Capacity == BlockSize)
+		{
+			m_FreeBlocks.push_back(InBlock);
+			return;
+		}
+
+		// Dedicated blocks are rare and sized for a single packet, they are not worth keeping
+		auto dedicatedBlockIt = std::find_if(m_DedicatedBlocks.begin(), m_DedicatedBlocks.end(), [InBlock](const std::unique_ptr<Block>& InDedicatedBlock) { return InDedicatedBlock.get() == InBlock; });
+		if (dedicatedBlockIt != m_DedicatedBlocks.end())
+			m_DedicatedBlocks.erase(dedicatedBlockIt);
+	}
+
+	CommandBuffer::CommandBuffer()
+		: m_Arena(CommandArena::GetForCurrentThread())
+	{ }
+
+	CommandBuffer::CommandBuffer(CommandArena& InArena)
+		: m_Arena(InArena)
+	{ }
+
+	CommandBuffer::~CommandBuffer()
+	{
+		Reset();
+	}
+
+	void CommandBuffer::Reset()
+	{
+		for (CommandArena::Block* currentBlock : m_Blocks)
+			m_Arena.ReleaseBlock(currentBlock);
+
+		m_Blocks.clear();
+		m_CommandsNum = 0;
+		m_RecordedSize = 0;
+	}
+
+	void* CommandBuffer::AllocatePacketMemory(size_t InSize)
+	{
+		const size_t alignedSize = AlignPacketSize(InSize);
+
+		// Packets never span across blocks, when the current block is full we just continue on a new one.
+		// A dedicated block is always full, so the packets after it continue on a new block as well.
+		if (alignedSize > CommandArena::BlockSize)
+			m_Blocks.push_back(m_Arena.AcquireDedicatedBlock(alignedSize));
+		else if (m_Blocks.empty() || m_Blocks.back()->m_UsedSize + alignedSize > m_Blocks.back()->m_Capacity)
+			m_Blocks.push_back(m_Arena.AcquireBlock());
+
+		CommandArena::Block* currentBlock = m_Blocks.back();
+		void* outMemory = currentBlock->m_Data.get() + currentBlock->m_UsedSize;
+		currentBlock->m_UsedSize += alignedSize;
+
+		m_CommandsNum++;
+		m_RecordedSize += alignedSize;
+
+		return outMemory;
+	}
+
+	void CommandBuffer::ResourceBarrier(Resource& InResource, RESOURCE_STATE InPrevState, RESOURCE_STATE InAfterState)
+	{
+		RecordedCommands::ResourceBarrier* newCommand = AllocateCommand<RecordedCommands::ResourceBarrier>(RECORDED_COMMAND_TYPE::RESOURCE_BARRIER);
+		newCommand->m_Resource = &InResource;
+		newCommand->m_PrevState = InPrevState;
+		newCommand->m_AfterState = InAfterState;
+	}
+
+	void CommandBuffer::TransitionResource(Resource& InResource, RESOURCE_STATE InStateAfter, uint32_t InSubresource)
+	{
+		RecordedCommands::TransitionResource* newCommand = AllocateCommand<RecordedCommands::TransitionResource>(RECORDED_COMMAND_TYPE::TRANSITION_RESOURCE);
+		newCommand->m_Resource = &InResource;
+		newCommand->m_StateAfter = InStateAfter;
+		newCommand->m_Subresource = InSubresource;
+	}
+
+	void CommandBuffer::AliasingBarrier(Resource& InResourceAfter)
+	{
+		RecordedCommands::AliasingBarrier* newCommand = AllocateCommand<RecordedCommands::AliasingBarrier>(RECORDED_COMMAND_TYPE::ALIASING_BARRIER);
+		newCommand->m_ResourceAfter = &InResourceAfter;
+	}
+
+	void CommandBuffer::DiscardResource(Resource& InResource)
+	{
+		RecordedCommands::DiscardResource* newCommand = AllocateCommand<RecordedCommands::DiscardResource>(RECORDED_COMMAND_TYPE::DISCARD_RESOURCE);
+		newCommand->m_Resource = &InResource;
+	}
+
+	void CommandBuffer::ClearRTV(CpuDescHandle& InDescHandle, const float* InColor)
+	{
+		RecordedCommands::ClearRTV* newCommand = AllocateCommand<RecordedCommands::ClearRTV>(RECORDED_COMMAND_TYPE::CLEAR_RTV);
+		newCommand->m_DescHandle = &InDescHandle;
+		std::memcpy(newCommand->m_Color, InColor, sizeof(newCommand->m_Color));
+	}
+
+	void CommandBuffer::ClearDepth(CpuDescHandle& InDescHandle)
+	{
+		RecordedCommands::ClearDepth* newCommand = AllocateCommand<RecordedCommands::ClearDepth>(RECORDED_COMMAND_TYPE::CLEAR_DEPTH);
+		newCommand->m_DescHandle = &InDescHandle;
+	}
+
+	void CommandBuffer::SetPipelineStateAndResourceBinder(PipelineState& InPipelineState)
+	{
+		RecordedCommands::SetPipelineStateAndResourceBinder* newCommand = AllocateCommand<RecordedCommands::SetPipelineStateAndResourceBinder>(RECORDED_COMMAND_TYPE::SET_PIPELINE_STATE_AND_RESOURCE_BINDER);
+		newCommand->m_PipelineState = &InPipelineState;
+	}
+
+	void CommandBuffer::SetInputAssemblerData(PRIMITIVE_TOPOLOGY InPrimTopology, VertexBufferView& InVertexBufView, IndexBufferView& InIndexBufView)
+	{
+		RecordedCommands::SetInputAssemblerData* newCommand = AllocateCommand<RecordedCommands::SetInputAssemblerData>(RECORDED_COMMAND_TYPE::SET_INPUT_ASSEMBLER_DATA);
+		newCommand->m_PrimTopology = InPrimTopology;
+		newCommand->m_VertexBufView = &InVertexBufView;
+		newCommand->m_IndexBufView = &InIndexBufView;
+	}
+
+	void CommandBuffer::SetVertexBuffer(uint32_t InSlot, VertexBufferView& InVertexBufView)
+	{
+		RecordedCommands::SetVertexBuffer* newCommand = AllocateCommand<RecordedCommands::SetVertexBuffer>(RECORDED_COMMAND_TYPE::SET_VERTEX_BUFFER);
+		newCommand->m_Slot = InSlot;
+		newCommand->m_VertexBufView = &InVertexBufView;
+	}
+
+	void CommandBuffer::SetViewportAndScissorRect(ViewPort& InViewport, Rect& InScissorRect)
+	{
+		RecordedCommands::SetViewportAndScissorRect* newCommand = AllocateCommand<RecordedCommands::SetViewportAndScissorRect>(RECORDED_COMMAND_TYPE::SET_VIEWPORT_AND_SCISSOR_RECT);
+		newCommand->m_Viewport = &InViewport;
+		newCommand->m_ScissorRect = &InScissorRect;
+	}
+
+	void CommandBuffer::SetRenderTargetFromWindow(Window& InWindow)
+	{
+		RecordedCommands::SetRenderTargetFromWindow* newCommand = AllocateCommand<RecordedCommands::SetRenderTargetFromWindow>(RECORDED_COMMAND_TYPE::SET_RENDER_TARGET_FROM_WINDOW);
+		newCommand->m_Window = &InWindow;
+	}
+
+	void CommandBuffer::RecordRootConstants(RECORDED_COMMAND_TYPE InType, uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues)
+	{
+		const size_t constantsSize = InNum32BitValuesToSet * sizeof(uint32_t);
+		RecordedCommands::SetRootConstants* newCommand = AllocateCommand<RecordedCommands::SetRootConstants>(InType, constantsSize);
+		newCommand->m_RootParameterIndex = static_cast<uint32_t>(InRootParameterIndex);
+		newCommand->m_Num32BitValuesToSet = static_cast<uint32_t>(InNum32BitValuesToSet);
+		newCommand->m_DestOffsetIn32BitValues = static_cast<uint32_t>(InDestOffsetIn32BitValues);
+		// Constants are stored right after the packet
+		std::memcpy(newCommand + 1, InSrcData, constantsSize);
+	}
+
+	void CommandBuffer::SetGraphicsRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues)
+	{
+		RecordRootConstants(RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_CONSTANTS, InRootParameterIndex, InNum32BitValuesToSet, InSrcData, InDestOffsetIn32BitValues);
+	}
+
+	void CommandBuffer::SetComputeRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues)
+	{
+		RecordRootConstants(RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_CONSTANTS, InRootParameterIndex, InNum32BitValuesToSet, InSrcData, InDestOffsetIn32BitValues);
+	}
+
+	void CommandBuffer::SetGraphicsRootTable(uint32_t InRootIndex, ConstantBufferView& InView)
+	{
+		RecordedCommands::SetGraphicsRootTable* newCommand = AllocateCommand<RecordedCommands::SetGraphicsRootTable>(RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_TABLE);
+		newCommand->m_RootIndex = InRootIndex;
+		newCommand->m_View = &InView;
+	}
+
+	void CommandBuffer::RecordRootDescriptor(RECORDED_COMMAND_TYPE InType, uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		RecordedCommands::SetRootDescriptor* newCommand = AllocateCommand<RecordedCommands::SetRootDescriptor>(InType);
+		newCommand->m_RootIdx = InRootIdx;
+		newCommand->m_GpuAddress = InGpuAddress;
+	}
+
+	void CommandBuffer::SetGraphicsRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		RecordRootDescriptor(RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_CONSTANT_BUFFER, InRootIdx, InGpuAddress);
+	}
+
+	void CommandBuffer::SetComputeRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		RecordRootDescriptor(RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_CONSTANT_BUFFER, InRootIdx, InGpuAddress);
+	}
+
+	void CommandBuffer::SetGraphicsRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		RecordRootDescriptor(RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_SHADER_RESOURCE, InRootIdx, InGpuAddress);
+	}
+
+	void CommandBuffer::SetComputeRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		RecordRootDescriptor(RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_SHADER_RESOURCE, InRootIdx, InGpuAddress);
+	}
+
+	void CommandBuffer::SetGraphicsRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		RecordRootDescriptor(RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_UNORDERED_ACCESS, InRootIdx, InGpuAddress);
+	}
+
+	void CommandBuffer::SetComputeRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		RecordRootDescriptor(RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_UNORDERED_ACCESS, InRootIdx, InGpuAddress);
+	}
+
+	void CommandBuffer::DrawIndexed(uint64_t InIndexCountPerInstance)
+	{
+		RecordedCommands::DrawIndexed* newCommand = AllocateCommand<RecordedCommands::DrawIndexed>(RECORDED_COMMAND_TYPE::DRAW_INDEXED);
+		newCommand->m_IndexCountPerInstance = InIndexCountPerInstance;
+	}
+
+	void CommandBuffer::DrawIndexedInstanced(uint32_t InIndexCountPerInstance, uint32_t InInstanceCount, uint32_t InStartIndexLocation, int32_t InBaseVertexLocation, uint32_t InStartInstanceLocation)
+	{
+		RecordedCommands::DrawIndexedInstanced* newCommand = AllocateCommand<RecordedCommands::DrawIndexedInstanced>(RECORDED_COMMAND_TYPE::DRAW_INDEXED_INSTANCED);
+		newCommand->m_IndexCountPerInstance = InIndexCountPerInstance;
+		newCommand->m_InstanceCount = InInstanceCount;
+		newCommand->m_StartIndexLocation = InStartIndexLocation;
+		newCommand->m_BaseVertexLocation = InBaseVertexLocation;
+		newCommand->m_StartInstanceLocation = InStartInstanceLocation;
+	}
+
+	void CommandBuffer::Dispatch(uint32_t InGroupsNumX, uint32_t InGroupsNumY, uint32_t InGroupsNumZ)
+	{
+		RecordedCommands::Dispatch* newCommand = AllocateCommand<RecordedCommands::Dispatch>(RECORDED_COMMAND_TYPE::DISPATCH);
+		newCommand->m_GroupsNumX = InGroupsNumX;
+		newCommand->m_GroupsNumY = InGroupsNumY;
+		newCommand->m_GroupsNumZ = InGroupsNumZ;
+	}
+
+	void CommandBuffer::ExecuteIndirect(CommandSignature& InSignature, uint32_t InMaxCommandsNum, Buffer& InArgumentBuffer, uint64_t InArgumentOffset, Buffer* InCountBuffer, uint64_t InCountOffset)
+	{
+		RecordedCommands::ExecuteIndirect* newCommand = AllocateCommand<RecordedCommands::ExecuteIndirect>(RECORDED_COMMAND_TYPE::EXECUTE_INDIRECT);
+		newCommand->m_Signature = &InSignature;
+		newCommand->m_MaxCommandsNum = InMaxCommandsNum;
+		newCommand->m_ArgumentBuffer = &InArgumentBuffer;
+		newCommand->m_ArgumentOffset = InArgumentOffset;
+		newCommand->m_CountBuffer = InCountBuffer;
+		newCommand->m_CountOffset = InCountOffset;
+	}
+
+	void CommandBuffer::StoreAndExecuteIndirect(CommandSignature& InSignature, const IndirectArgumentBuilder& InArgumentBuilder)
+	{
+		RecordedCommands::StoreAndExecuteIndirect* newCommand = AllocateCommand<RecordedCommands::StoreAndExecuteIndirect>(RECORDED_COMMAND_TYPE::STORE_AND_EXECUTE_INDIRECT);
+		newCommand->m_Signature = &InSignature;
+		newCommand->m_ArgumentBuilder = &InArgumentBuilder;
+	}
+
+	void CommandBuffer::ExecuteBundle(CommandList& InBundle)
+	{
+		RecordedCommands::ExecuteBundle* newCommand = AllocateCommand<RecordedCommands::ExecuteBundle>(RECORDED_COMMAND_TYPE::EXECUTE_BUNDLE);
+		newCommand->m_Bundle = &InBundle;
+	}
+
+	void CommandBuffer::UploadViewToGPU(ShaderResourceView& InSRV)
+	{
+		RecordedCommands::UploadViewToGPU* newCommand = AllocateCommand<RecordedCommands::UploadViewToGPU>(RECORDED_COMMAND_TYPE::UPLOAD_VIEW_TO_GPU);
+		newCommand->m_SRV = &InSRV;
+	}
+
+	void CommandBuffer::UploadUavToGpu(UnorderedAccessView& InUav)
+	{
+		RecordedCommands::UploadUavToGpu* newCommand = AllocateCommand<RecordedCommands::UploadUavToGpu>(RECORDED_COMMAND_TYPE::UPLOAD_UAV_TO_GPU);
+		newCommand->m_UAV = &InUav;
+	}
+
+	void CommandBuffer::StoreAndReferenceDynamicBuffer(uint32_t InRootIdx, DynamicBuffer& InDynBuffer, ConstantBufferView& InResourceView)
+	{
+		RecordedCommands::StoreAndReferenceDynamicBuffer* newCommand = AllocateCommand<RecordedCommands::StoreAndReferenceDynamicBuffer>(RECORDED_COMMAND_TYPE::STORE_AND_REFERENCE_DYNAMIC_BUFFER);
+		newCommand->m_RootIdx = InRootIdx;
+		newCommand->m_DynBuffer = &InDynBuffer;
+		newCommand->m_ResourceView = &InResourceView;
+	}
+
+	void CommandBuffer::StoreAndSetDynamicRootConstantBuffer(uint32_t InRootIdx, DynamicBuffer& InDynBuffer)
+	{
+		RecordedCommands::StoreAndSetDynamicRootConstantBuffer* newCommand = AllocateCommand<RecordedCommands::StoreAndSetDynamicRootConstantBuffer>(RECORDED_COMMAND_TYPE::STORE_AND_SET_DYNAMIC_ROOT_CONSTANT_BUFFER);
+		newCommand->m_RootIdx = InRootIdx;
+		newCommand->m_DynBuffer = &InDynBuffer;
+	}
+
+	void CommandBuffer::ReferenceSRV(uint32_t InRootIdx, ShaderResourceView& InSRV)
+	{
+		RecordedCommands::ReferenceSRV* newCommand = AllocateCommand<RecordedCommands::ReferenceSRV>(RECORDED_COMMAND_TYPE::REFERENCE_SRV);
+		newCommand->m_RootIdx = InRootIdx;
+		newCommand->m_SRV = &InSRV;
+	}
+
+	void CommandBuffer::ReferenceComputeTable(uint32_t InRootIdx, ShaderResourceView& InSrv)
+	{
+		RecordedCommands::ReferenceComputeTableSRV* newCommand = AllocateCommand<RecordedCommands::ReferenceComputeTableSRV>(RECORDED_COMMAND_TYPE::REFERENCE_COMPUTE_TABLE_SRV);
+		newCommand->m_RootIdx = InRootIdx;
+		newCommand->m_SRV = &InSrv;
+	}
+
+	void CommandBuffer::ReferenceComputeTable(uint32_t InRootIdx, UnorderedAccessView& InUav)
+	{
+		RecordedCommands::ReferenceComputeTableUAV* newCommand = AllocateCommand<RecordedCommands::ReferenceComputeTableUAV>(RECORDED_COMMAND_TYPE::REFERENCE_COMPUTE_TABLE_UAV);
+		newCommand->m_RootIdx = InRootIdx;
+		newCommand->m_UAV = &InUav;
+	}
+
+	void CommandBuffer::UploadBufferData(Buffer& DestinationBuffer, Buffer& IntermediateBuffer, const void* InBufferData, size_t InDataSize)
+	{
+		RecordedCommands::UploadBufferData* newCommand = AllocateCommand<RecordedCommands::UploadBufferData>(RECORDED_COMMAND_TYPE::UPLOAD_BUFFER_DATA);
+		newCommand->m_DestinationBuffer = &DestinationBuffer;
+		newCommand->m_IntermediateBuffer = &IntermediateBuffer;
+		newCommand->m_BufferData = InBufferData;
+		newCommand->m_DataSize = InDataSize;
+	}
+
+	void CommandBuffer::UploadBufferRegion(Buffer& InDestBuffer, uint64_t InDestOffset, Buffer& InStagingBuffer, uint64_t InStagingOffset, const void* InData, size_t InDataSize)
+	{
+		RecordedCommands::UploadBufferRegion* newCommand = AllocateCommand<RecordedCommands::UploadBufferRegion>(RECORDED_COMMAND_TYPE::UPLOAD_BUFFER_REGION);
+		newCommand->m_DestBuffer = &InDestBuffer;
+		newCommand->m_DestOffset = InDestOffset;
+		newCommand->m_StagingBuffer = &InStagingBuffer;
+		newCommand->m_StagingOffset = InStagingOffset;
+		newCommand->m_Data = InData;
+		newCommand->m_DataSize = InDataSize;
+	}
+
+	void CommandBuffer::Replay(CommandList& InTargetCmdList) const
+	{
+		ForEachCommand([&InTargetCmdList](const RecordedCommandHeader& InHeader)
+		{
+			switch (InHeader.m_Type)
+			{
+			case RECORDED_COMMAND_TYPE::RESOURCE_BARRIER:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::ResourceBarrier&>(InHeader);
+				InTargetCmdList.ResourceBarrier(*cmd.m_Resource, cmd.m_PrevState, cmd.m_AfterState);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::TRANSITION_RESOURCE:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::TransitionResource&>(InHeader);
+				InTargetCmdList.TransitionResource(*cmd.m_Resource, cmd.m_StateAfter, cmd.m_Subresource);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::ALIASING_BARRIER:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::AliasingBarrier&>(InHeader);
+				InTargetCmdList.AliasingBarrier(*cmd.m_ResourceAfter);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::DISCARD_RESOURCE:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::DiscardResource&>(InHeader);
+				InTargetCmdList.DiscardResource(*cmd.m_Resource);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::CLEAR_RTV:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::ClearRTV&>(InHeader);
+				float clearColor[4] = { cmd.m_Color[0], cmd.m_Color[1], cmd.m_Color[2], cmd.m_Color[3] };
+				InTargetCmdList.ClearRTV(*cmd.m_DescHandle, clearColor);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::CLEAR_DEPTH:
+				InTargetCmdList.ClearDepth(*reinterpret_cast<const RecordedCommands::ClearDepth&>(InHeader).m_DescHandle);
+				break;
+			case RECORDED_COMMAND_TYPE::SET_PIPELINE_STATE_AND_RESOURCE_BINDER:
+				InTargetCmdList.SetPipelineStateAndResourceBinder(*reinterpret_cast<const RecordedCommands::SetPipelineStateAndResourceBinder&>(InHeader).m_PipelineState);
+				break;
+			case RECORDED_COMMAND_TYPE::SET_INPUT_ASSEMBLER_DATA:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetInputAssemblerData&>(InHeader);
+				InTargetCmdList.SetInputAssemblerData(cmd.m_PrimTopology, *cmd.m_VertexBufView, *cmd.m_IndexBufView);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_VERTEX_BUFFER:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetVertexBuffer&>(InHeader);
+				InTargetCmdList.SetVertexBuffer(cmd.m_Slot, *cmd.m_VertexBufView);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_VIEWPORT_AND_SCISSOR_RECT:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetViewportAndScissorRect&>(InHeader);
+				InTargetCmdList.SetViewportAndScissorRect(*cmd.m_Viewport, *cmd.m_ScissorRect);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_RENDER_TARGET_FROM_WINDOW:
+				InTargetCmdList.SetRenderTargetFromWindow(*reinterpret_cast<const RecordedCommands::SetRenderTargetFromWindow&>(InHeader).m_Window);
+				break;
+			case RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_CONSTANTS:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootConstants&>(InHeader);
+				InTargetCmdList.SetGraphicsRootConstants(cmd.m_RootParameterIndex, cmd.m_Num32BitValuesToSet, &cmd + 1, cmd.m_DestOffsetIn32BitValues);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_CONSTANTS:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootConstants&>(InHeader);
+				InTargetCmdList.SetComputeRootConstants(cmd.m_RootParameterIndex, cmd.m_Num32BitValuesToSet, &cmd + 1, cmd.m_DestOffsetIn32BitValues);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_TABLE:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetGraphicsRootTable&>(InHeader);
+				InTargetCmdList.SetGraphicsRootTable(cmd.m_RootIndex, *cmd.m_View);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_CONSTANT_BUFFER:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootDescriptor&>(InHeader);
+				InTargetCmdList.SetGraphicsRootConstantBuffer(cmd.m_RootIdx, cmd.m_GpuAddress);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_CONSTANT_BUFFER:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootDescriptor&>(InHeader);
+				InTargetCmdList.SetComputeRootConstantBuffer(cmd.m_RootIdx, cmd.m_GpuAddress);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_SHADER_RESOURCE:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootDescriptor&>(InHeader);
+				InTargetCmdList.SetGraphicsRootShaderResource(cmd.m_RootIdx, cmd.m_GpuAddress);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_SHADER_RESOURCE:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootDescriptor&>(InHeader);
+				InTargetCmdList.SetComputeRootShaderResource(cmd.m_RootIdx, cmd.m_GpuAddress);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_GRAPHICS_ROOT_UNORDERED_ACCESS:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootDescriptor&>(InHeader);
+				InTargetCmdList.SetGraphicsRootUnorderedAccess(cmd.m_RootIdx, cmd.m_GpuAddress);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::SET_COMPUTE_ROOT_UNORDERED_ACCESS:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::SetRootDescriptor&>(InHeader);
+				InTargetCmdList.SetComputeRootUnorderedAccess(cmd.m_RootIdx, cmd.m_GpuAddress);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::DRAW_INDEXED:
+				InTargetCmdList.DrawIndexed(reinterpret_cast<const RecordedCommands::DrawIndexed&>(InHeader).m_IndexCountPerInstance);
+				break;
+			case RECORDED_COMMAND_TYPE::DRAW_INDEXED_INSTANCED:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::DrawIndexedInstanced&>(InHeader);
+				InTargetCmdList.DrawIndexedInstanced(cmd.m_IndexCountPerInstance, cmd.m_InstanceCount, cmd.m_StartIndexLocation, cmd.m_BaseVertexLocation, cmd.m_StartInstanceLocation);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::DISPATCH:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::Dispatch&>(InHeader);
+				InTargetCmdList.Dispatch(cmd.m_GroupsNumX, cmd.m_GroupsNumY, cmd.m_GroupsNumZ);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::EXECUTE_INDIRECT:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::ExecuteIndirect&>(InHeader);
+				InTargetCmdList.ExecuteIndirect(*cmd.m_Signature, cmd.m_MaxCommandsNum, *cmd.m_ArgumentBuffer, cmd.m_ArgumentOffset, cmd.m_CountBuffer, cmd.m_CountOffset);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::STORE_AND_EXECUTE_INDIRECT:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::StoreAndExecuteIndirect&>(InHeader);
+				InTargetCmdList.StoreAndExecuteIndirect(*cmd.m_Signature, *cmd.m_ArgumentBuilder);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::EXECUTE_BUNDLE:
+				InTargetCmdList.ExecuteBundle(*reinterpret_cast<const RecordedCommands::ExecuteBundle&>(InHeader).m_Bundle);
+				break;
+			case RECORDED_COMMAND_TYPE::UPLOAD_VIEW_TO_GPU:
+				InTargetCmdList.UploadViewToGPU(*reinterpret_cast<const RecordedCommands::UploadViewToGPU&>(InHeader).m_SRV);
+				break;
+			case RECORDED_COMMAND_TYPE::UPLOAD_UAV_TO_GPU:
+				InTargetCmdList.UploadUavToGpu(*reinterpret_cast<const RecordedCommands::UploadUavToGpu&>(InHeader).m_UAV);
+				break;
+			case RECORDED_COMMAND_TYPE::STORE_AND_REFERENCE_DYNAMIC_BUFFER:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::StoreAndReferenceDynamicBuffer&>(InHeader);
+				InTargetCmdList.StoreAndReferenceDynamicBuffer(cmd.m_RootIdx, *cmd.m_DynBuffer, *cmd.m_ResourceView);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::STORE_AND_SET_DYNAMIC_ROOT_CONSTANT_BUFFER:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::StoreAndSetDynamicRootConstantBuffer&>(InHeader);
+				InTargetCmdList.StoreAndSetDynamicRootConstantBuffer(cmd.m_RootIdx, *cmd.m_DynBuffer);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::REFERENCE_SRV:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::ReferenceSRV&>(InHeader);
+				InTargetCmdList.ReferenceSRV(cmd.m_RootIdx, *cmd.m_SRV);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::REFERENCE_COMPUTE_TABLE_SRV:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::ReferenceComputeTableSRV&>(InHeader);
+				InTargetCmdList.ReferenceComputeTable(cmd.m_RootIdx, *cmd.m_SRV);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::REFERENCE_COMPUTE_TABLE_UAV:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::ReferenceComputeTableUAV&>(InHeader);
+				InTargetCmdList.ReferenceComputeTable(cmd.m_RootIdx, *cmd.m_UAV);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::UPLOAD_BUFFER_DATA:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::UploadBufferData&>(InHeader);
+				InTargetCmdList.UploadBufferData(*cmd.m_DestinationBuffer, *cmd.m_IntermediateBuffer, cmd.m_BufferData, cmd.m_DataSize);
+				break;
+			}
+			case RECORDED_COMMAND_TYPE::UPLOAD_BUFFER_REGION:
+			{
+				const auto& cmd = reinterpret_cast<const RecordedCommands::UploadBufferRegion&>(InHeader);
+				InTargetCmdList.UploadBufferRegion(*cmd.m_DestBuffer, cmd.m_DestOffset, *cmd.m_StagingBuffer, cmd.m_StagingOffset, cmd.m_Data, cmd.m_DataSize);
+				break;
+			}
+			default:
+				StopForFail("[CommandBuffer] Unknown recorded command type.");
+				break;
+			}
+		});
+	}
+
+} }
@@ -8,15 +8,232 @@
  
 #include "CommandList.h"
 #include "Public/GraphicsTypes.h"
+#include "Window.h"
+#include "PipelineState.h"
 
 namespace GEPUtils { namespace Graphics {
 
 
-	CommandList::CommandList(GEPUtils::Graphics::Device& InDevice)
-		: m_Device(InDevice)
+	CommandList::CommandList(GEPUtils::Graphics::Device& InDevice, bool InIsBundle /*= false*/)
+		: m_Device(InDevice), m_IsBundle(InIsBundle)
 	{
 
 	}
 
+	void CommandList::ResourceBarrier(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InPrevState, GEPUtils::Graphics::RESOURCE_STATE InAfterState)
+	{
+		GEPUtils::Graphics::RESOURCE_STATE trackedState;
+		if (m_ResourceStateTracker.GetTrackedState(InResource, GEPUtils::Graphics::ALL_SUBRESOURCES, trackedState) && trackedState != InPrevState)
+		{
+			StopForFail("[CommandList] Explicit barrier previous state does not match the tracked one, the tracked state will be used.");
+		}
+
+		TransitionResource(InResource, InAfterState);
+	}
+
+	void CommandList::TransitionResource(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InStateAfter, uint32_t InSubresource /*= GEPUtils::Graphics::ALL_SUBRESOURCES*/)
+	{
+		if (m_IsBundle)
+		{
+			StopForFail("[CommandList] Resource transitions cannot be recorded in a bundle, they need to happen in the command list executing it.");
+			return;
+		}
+
+		m_ResourceStateTracker.TransitionResource(InResource, InStateAfter, InSubresource);
+	}
+
+	void CommandList::FlushResourceBarriers()
+	{
+		if (!m_ResourceStateTracker.HasBarriersToFlush())
+			return;
+
+		const std::vector<GEPUtils::Graphics::RESOURCE_TRANSITION>& barriersToFlush = m_ResourceStateTracker.GetBarriersToFlush();
+		ExecuteResourceBarriers_Internal(barriersToFlush.data(), static_cast<uint32_t>(barriersToFlush.size()));
+
+		m_ResourceStateTracker.OnBarriersFlushed();
+	}
+
+	void CommandList::AliasingBarrier(GEPUtils::Graphics::Resource& InResourceAfter)
+	{
+		if (m_IsBundle)
+		{
+			StopForFail("[CommandList] Aliasing barriers cannot be recorded in a bundle.");
+			return;
+		}
+
+		// Transitions requested so far need to happen before the memory changes owner
+		FlushResourceBarriers();
+
+		// The state of the resource is acquired now, so that its next transitions are recorded after the aliasing barrier
+		// instead of being resolved at submission time, before the whole command list.
+		m_ResourceStateTracker.AcquireResourceState(InResourceAfter);
+
+		ExecuteAliasingBarrier_Internal(InResourceAfter);
+	}
+
+	void CommandList::DiscardResource(GEPUtils::Graphics::Resource& InResource)
+	{
+		if (m_IsBundle)
+		{
+			StopForFail("[CommandList] Discarding a resource cannot be recorded in a bundle.");
+			return;
+		}
+
+		// The resource needs to reach the render target or depth write state first
+		FlushResourceBarriers();
+
+		DiscardResource_Internal(InResource);
+	}
+
+	void CommandList::SetPipelineStateAndResourceBinder(GEPUtils::Graphics::PipelineState& InPipelineState)
+	{
+		if (m_ShadowState.m_PipelineState == &InPipelineState)
+		{
+			OnStateCallFiltered();
+			return;
+		}
+		m_ShadowState.m_PipelineState = &InPipelineState;
+
+		SetPipelineState_Internal(InPipelineState);
+
+		// Different PSOs can share the same root signature and they all share the same descriptor heap,
+		// so they are filtered separately to avoid binding them again (which would also reset all the root arguments).
+		// Note: bundles setting root arguments (e.g. descriptor tables) need to set the root signature as well. Setting the same one bound by the command list
+		// executing the bundle keeps the root arguments the bundle inherits from it (e.g. per-frame constants), while a different one would reset them.
+		const void* rootSignature = GetRootSignatureIdentity_Internal(InPipelineState);
+		const void*& boundRootSignature = InPipelineState.IsGraphics() ? m_ShadowState.m_GraphicsRootSignature : m_ShadowState.m_ComputeRootSignature;
+		if (boundRootSignature != rootSignature)
+		{
+			boundRootSignature = rootSignature;
+			SetRootSignature_Internal(InPipelineState);
+		}
+		else
+			OnStateCallFiltered();
+
+		const void* descriptorHeap = GetDescriptorHeapIdentity_Internal();
+		if (m_ShadowState.m_DescriptorHeap != descriptorHeap)
+		{
+			m_ShadowState.m_DescriptorHeap = descriptorHeap;
+			SetDescriptorHeap_Internal();
+		}
+		else
+			OnStateCallFiltered();
+	}
+
+	void CommandList::SetInputAssemblerData(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology, GEPUtils::Graphics::VertexBufferView& InVertexBufView, GEPUtils::Graphics::IndexBufferView& InIndexBufView)
+	{
+		if (m_ShadowState.m_PrimTopology != InPrimTopology)
+		{
+			m_ShadowState.m_PrimTopology = InPrimTopology;
+			SetPrimitiveTopology_Internal(InPrimTopology);
+		}
+		else
+			OnStateCallFiltered();
+
+		SetVertexBuffer(0, InVertexBufView);
+
+		if (m_ShadowState.m_IndexBufView != &InIndexBufView)
+		{
+			m_ShadowState.m_IndexBufView = &InIndexBufView;
+			SetIndexBuffer_Internal(InIndexBufView);
+		}
+		else
+			OnStateCallFiltered();
+	}
+
+	void CommandList::SetVertexBuffer(uint32_t InSlot, GEPUtils::Graphics::VertexBufferView& InVertexBufView)
+	{
+		if (InSlot >= VERTEX_BUFFER_SLOTS_NUM)
+		{
+			StopForFail("[CommandList] Vertex buffer slot out of range.");
+			return;
+		}
+
+		if (m_ShadowState.m_VertexBufViews[InSlot] != &InVertexBufView)
+		{
+			m_ShadowState.m_VertexBufViews[InSlot] = &InVertexBufView;
+			SetVertexBuffer_Internal(InSlot, InVertexBufView);
+		}
+		else
+			OnStateCallFiltered();
+	}
+
+	void CommandList::SetViewportAndScissorRect(GEPUtils::Graphics::ViewPort& InViewport, GEPUtils::Graphics::Rect& InScissorRect)
+	{
+		if (m_IsBundle)
+		{
+			StopForFail("[CommandList] Viewport and scissor rect cannot be set in a bundle, it inherits them from the command list executing it.");
+			return;
+		}
+
+		if (m_ShadowState.m_Viewport != &InViewport)
+		{
+			m_ShadowState.m_Viewport = &InViewport;
+			SetViewport_Internal(InViewport);
+		}
+		else
+			OnStateCallFiltered();
+
+		if (m_ShadowState.m_ScissorRect != &InScissorRect)
+		{
+			m_ShadowState.m_ScissorRect = &InScissorRect;
+			SetScissorRect_Internal(InScissorRect);
+		}
+		else
+			OnStateCallFiltered();
+	}
+
+	void CommandList::SetRenderTargetFromWindow(GEPUtils::Graphics::Window& InWindow)
+	{
+		if (m_IsBundle)
+		{
+			StopForFail("[CommandList] Render targets cannot be set in a bundle, it inherits them from the command list executing it.");
+			return;
+		}
+
+		GEPUtils::Graphics::Resource* currentBackBuffer = &InWindow.GetCurrentBackBuffer();
+
+		if (m_ShadowState.m_RenderTargetWindow == &InWindow && m_ShadowState.m_RenderTargetBackBuffer == currentBackBuffer)
+		{
+			OnStateCallFiltered();
+			return;
+		}
+		m_ShadowState.m_RenderTargetWindow = &InWindow;
+		m_ShadowState.m_RenderTargetBackBuffer = currentBackBuffer;
+
+		SetRenderTargetFromWindow_Internal(InWindow);
+	}
+
+	void CommandList::ExecuteBundle(GEPUtils::Graphics::CommandList& InBundle)
+	{
+		if (m_IsBundle || !InBundle.IsBundle())
+		{
+			StopForFail("[CommandList] Only bundles can be executed, and only by command lists that are not bundles.");
+			return;
+		}
+
+		ExecuteBundle_Internal(InBundle);
+
+		// Pipeline state and input assembler data set by the bundle are now set in this command list, so the ones we were filtering on are not valid anymore
+		m_ShadowState.m_PipelineState = nullptr;
+		m_ShadowState.m_PrimTopology = GEPUtils::Graphics::PRIMITIVE_TOPOLOGY::PT_UNDEFINED;
+		for (GEPUtils::Graphics::VertexBufferView*& currentVertexBufView : m_ShadowState.m_VertexBufViews)
+			currentVertexBufView = nullptr;
+		m_ShadowState.m_IndexBufView = nullptr;
+	}
+
+	void CommandList::InvalidateShadowState()
+	{
+		m_ShadowState = ShadowState();
+		m_FilteredStateCallsNum = 0;
+	}
+
+	void CommandList::ResetTrackedStates()
+	{
+		InvalidateShadowState();
+
+		m_ResourceStateTracker.Reset();
+	}
+
 }
 }
@@ -36,6 +36,8 @@ namespace GEPUtils{ namespace Graphics {
 
 		void Reset();
 
+		D3D12GEPUtils::D3D12Resource& GetResource() { return m_Resource; }
+
 		// Do not allow copy construct
 		D3D12LinearBufferAllocator(const D3D12LinearBufferAllocator& ) = delete;
 		// Do not allow copy assignment
@@ -16,74 +16,138 @@
 #include "D3D12Window.h"
 #include "GEPUtils.h"
 #include "D3D12GraphicsAllocator.h"
+#include "D3D12CommandSignature.h"
+#include "D3D12CommandQueue.h"
 
 namespace GEPUtils { namespace Graphics {
 
-	D3D12CommandList::D3D12CommandList(Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> InCmdList, GEPUtils::Graphics::Device& InOwningDevice) 
-		: CommandList(InOwningDevice), m_D3D12CmdList(InCmdList)
+	D3D12CommandList::D3D12CommandList(Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> InCmdList, GEPUtils::Graphics::Device& InOwningDevice, bool InIsBundle /*= false*/) 
+		: CommandList(InOwningDevice, InIsBundle), m_D3D12CmdList(InCmdList)
 	{
 	}
 
-	void D3D12CommandList::ResourceBarrier(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InPrevState, GEPUtils::Graphics::RESOURCE_STATE InAfterState)
+	void D3D12CommandList::ExecuteResourceBarriers_Internal(const GEPUtils::Graphics::RESOURCE_TRANSITION* InBarriers, uint32_t InBarriersNum)
 	{
-		CD3DX12_RESOURCE_BARRIER transitionBarrier = CD3DX12_RESOURCE_BARRIER::Transition(
-			static_cast<D3D12GEPUtils::D3D12Resource&>(InResource).GetInner().Get(),
-			// We can be sure that the previous state was present because in this application all the render targets
-			// are first filled and then presented to the main window repetitevely.
-			D3D12GEPUtils::ResourceStateTypeToD3D12(InPrevState), D3D12GEPUtils::ResourceStateTypeToD3D12(InAfterState));
+		ExecuteResourceBarriers(InBarriers, InBarriersNum);
+	}
+
+	void D3D12CommandList::ExecuteResourceBarriers(const GEPUtils::Graphics::RESOURCE_TRANSITION* InBarriers, uint32_t InBarriersNum)
+	{
+		if (InBarriersNum == 0)
+			return;
+
+		m_BarriersScratch.clear();
+		for (uint32_t barrierIdx = 0; barrierIdx < InBarriersNum; barrierIdx++)
+		{
+			const GEPUtils::Graphics::RESOURCE_TRANSITION& currentTransition = InBarriers[barrierIdx];
+			m_BarriersScratch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+				D3D12GEPUtils::GetD3D12Resource(*currentTransition.m_Resource),
+				D3D12GEPUtils::ResourceStateTypeToD3D12(currentTransition.m_StateBefore), D3D12GEPUtils::ResourceStateTypeToD3D12(currentTransition.m_StateAfter),
+				// Note: the engine and D3D12 use the same value to indicate all the subresources
+				currentTransition.m_Subresource == GEPUtils::Graphics::ALL_SUBRESOURCES ? D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES : currentTransition.m_Subresource));
+		}
+
+		// All the transitions are submitted with a single call
+		m_D3D12CmdList->ResourceBarrier(static_cast<UINT>(m_BarriersScratch.size()), m_BarriersScratch.data());
+	}
 
-		m_D3D12CmdList->ResourceBarrier(1, &transitionBarrier);
+	void D3D12CommandList::ExecuteAliasingBarrier_Internal(GEPUtils::Graphics::Resource& InResourceAfter)
+	{
+		// Note: a null resource before means any of the placed resources previously using the same memory
+		D3D12_RESOURCE_BARRIER aliasingBarrier = CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, D3D12GEPUtils::GetD3D12Resource(InResourceAfter));
+		m_D3D12CmdList->ResourceBarrier(1, &aliasingBarrier);
+	}
+
+	void D3D12CommandList::DiscardResource_Internal(GEPUtils::Graphics::Resource& InResource)
+	{
+		// Note: a null region discards all the subresources
+		m_D3D12CmdList->DiscardResource(D3D12GEPUtils::GetD3D12Resource(InResource), nullptr);
 	}
 
 	void D3D12CommandList::ClearRTV(GEPUtils::Graphics::CpuDescHandle& InDescHandle, float* InColor)
 	{
+		Check(!IsBundle());
+
+		FlushResourceBarriers();
+
 		m_D3D12CmdList->ClearRenderTargetView(static_cast<D3D12GEPUtils::D3D12CpuDescriptorHandle&>(InDescHandle).GetInner(), InColor, 0, nullptr);
 	}
 
 	void D3D12CommandList::ClearDepth(GEPUtils::Graphics::CpuDescHandle& InDescHandle)
 	{
+		Check(!IsBundle());
+
+		FlushResourceBarriers();
+
 		m_D3D12CmdList->ClearDepthStencilView(static_cast<D3D12GEPUtils::D3D12CpuDescriptorHandle&>(InDescHandle).GetInner(), D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
 	}
 
 	void D3D12CommandList::Close()
 	{
+		// Transitions requested after the last command still need to reach the command list, so that the tracked final states are correct
+		FlushResourceBarriers();
+
 		m_D3D12CmdList->Close();
 	}
 
-	void D3D12CommandList::SetPipelineStateAndResourceBinder(Graphics::PipelineState& InPipelineState)
+	void D3D12CommandList::SetPipelineState_Internal(Graphics::PipelineState& InPipelineState)
 	{
-		Graphics::D3D12PipelineState& d3d12PSO = static_cast<Graphics::D3D12PipelineState&>(InPipelineState);
+		m_D3D12CmdList->SetPipelineState(static_cast<Graphics::D3D12PipelineState&>(InPipelineState).GetInnerPSO().Get());
+	}
 
-		// Set PSO
-		m_D3D12CmdList->SetPipelineState(d3d12PSO.GetInnerPSO().Get());
+	const void* D3D12CommandList::GetRootSignatureIdentity_Internal(Graphics::PipelineState& InPipelineState)
+	{
+		return static_cast<Graphics::D3D12PipelineState&>(InPipelineState).GetInnerRootSignature().Get();
+	}
 
-		// Set root signature
-		if(InPipelineState.IsGraphics())
-			m_D3D12CmdList->SetGraphicsRootSignature(d3d12PSO.GetInnerRootSignature().Get());
+	void D3D12CommandList::SetRootSignature_Internal(Graphics::PipelineState& InPipelineState)
+	{
+		ID3D12RootSignature* rootSignature = static_cast<Graphics::D3D12PipelineState&>(InPipelineState).GetInnerRootSignature().Get();
+		if (InPipelineState.IsGraphics())
+			m_D3D12CmdList->SetGraphicsRootSignature(rootSignature);
 		else
-			m_D3D12CmdList->SetComputeRootSignature(d3d12PSO.GetInnerRootSignature().Get());
+			m_D3D12CmdList->SetComputeRootSignature(rootSignature);
+	}
 
-		// Bind descriptor heap(s)
-		m_D3D12CmdList->SetDescriptorHeaps(1, static_cast<GEPUtils::Graphics::D3D12GraphicsAllocator*>(GEPUtils::Graphics::GraphicsAllocator::Get())->GetGpuHeap().GetInner().GetAddressOf());
+	const void* D3D12CommandList::GetDescriptorHeapIdentity_Internal()
+	{
+		return static_cast<GEPUtils::Graphics::D3D12GraphicsAllocator*>(GEPUtils::Graphics::GraphicsAllocator::Get())->GetGpuHeap().GetInner().Get();
+	}
 
+	void D3D12CommandList::SetDescriptorHeap_Internal()
+	{
+		// Note: bundles need to bind the same heap the executing command list has bound, which is always the case since there is a single GPU heap
+		ID3D12DescriptorHeap* gpuDescHeap = static_cast<GEPUtils::Graphics::D3D12GraphicsAllocator*>(GEPUtils::Graphics::GraphicsAllocator::Get())->GetGpuHeap().GetInner().Get();
+		m_D3D12CmdList->SetDescriptorHeaps(1, &gpuDescHeap);
 	}
 
-	void D3D12CommandList::SetInputAssemblerData(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology, GEPUtils::Graphics::VertexBufferView& InVertexBufView, GEPUtils::Graphics::IndexBufferView& InIndexBufView)
+	void D3D12CommandList::SetPrimitiveTopology_Internal(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology)
 	{
 		m_D3D12CmdList->IASetPrimitiveTopology(D3D12GEPUtils::PrimitiveTopoToD3D12(InPrimTopology));
-		m_D3D12CmdList->IASetVertexBuffers(0, 1, &static_cast<D3D12GEPUtils::D3D12VertexBufferView&>(InVertexBufView).m_VertexBufferView);
+	}
+
+	void D3D12CommandList::SetVertexBuffer_Internal(uint32_t InSlot, GEPUtils::Graphics::VertexBufferView& InVertexBufView)
+	{
+		m_D3D12CmdList->IASetVertexBuffers(InSlot, 1, &static_cast<D3D12GEPUtils::D3D12VertexBufferView&>(InVertexBufView).m_VertexBufferView);
+	}
+
+	void D3D12CommandList::SetIndexBuffer_Internal(GEPUtils::Graphics::IndexBufferView& InIndexBufView)
+	{
 		m_D3D12CmdList->IASetIndexBuffer(&static_cast<D3D12GEPUtils::D3D12IndexBufferView&>(InIndexBufView).m_IndexBufferView);
 	}
 
-	void D3D12CommandList::SetViewportAndScissorRect(GEPUtils::Graphics::ViewPort& InViewport, GEPUtils::Graphics::Rect& InScissorRect)
+	void D3D12CommandList::SetViewport_Internal(GEPUtils::Graphics::ViewPort& InViewport)
 	{
-		// Creating a viewport and scissor rect on the fly
 		m_D3D12CmdList->RSSetViewports(1, &static_cast<D3D12GEPUtils::D3D12ViewPort&>(InViewport).D3d12Viewport);
+	}
+
+	void D3D12CommandList::SetScissorRect_Internal(GEPUtils::Graphics::Rect& InScissorRect)
+	{
 		m_D3D12CmdList->RSSetScissorRects(1, &static_cast<D3D12GEPUtils::D3D12Rect&>(InScissorRect).D3d12Rect);
 	}
 
-	void D3D12CommandList::SetRenderTargetFromWindow(GEPUtils::Graphics::Window& InWindow)
+	void D3D12CommandList::SetRenderTargetFromWindow_Internal(GEPUtils::Graphics::Window& InWindow)
 	{
 		D3D12GEPUtils::D3D12Window& d3d12Window = static_cast<D3D12GEPUtils::D3D12Window&>(InWindow);
 		m_D3D12CmdList->OMSetRenderTargets(1, &d3d12Window.GetCurrentRTVDescHandle(), FALSE, &d3d12Window.GetCuttentDSVDescHandle());
@@ -99,30 +163,155 @@ namespace GEPUtils { namespace Graphics {
 		m_D3D12CmdList->SetComputeRoot32BitConstants(InRootParameterIndex, InNum32BitValuesToSet, InSrcData, InDestOffsetIn32BitValues);
 	}
 
-	void D3D12CommandList::DrawIndexed(uint64_t InIndexCountPerInstance)
+	void D3D12CommandList::DrawIndexedInstanced(uint32_t InIndexCountPerInstance, uint32_t InInstanceCount, uint32_t InStartIndexLocation, int32_t InBaseVertexLocation, uint32_t InStartInstanceLocation)
 	{
 		// Note: this will upload descriptors relative to descriptor tables on GPU and then reference them in the pipeline!
 		m_StagedDescriptorManager.CommitStagedDescriptorsForDraw(*this);
 
+		FlushResourceBarriers();
+
 		// Now that the descriptors are in GPU we can reference the relative views in the pipeline
-		m_D3D12CmdList->DrawIndexedInstanced(InIndexCountPerInstance, 1, 0, 0, 0);
+		m_D3D12CmdList->DrawIndexedInstanced(InIndexCountPerInstance, InInstanceCount, InStartIndexLocation, InBaseVertexLocation, InStartInstanceLocation);
 	}
 
 	void D3D12CommandList::Dispatch(uint32_t InGroupsNumX, uint32_t InGroupsNumY, uint32_t InGroupsNumZ)
 	{
 		// TODO commit staged descriptors for compute (but in this series of examples we are not using them)
 
+		FlushResourceBarriers();
+
 		m_D3D12CmdList->Dispatch(InGroupsNumX, InGroupsNumY, InGroupsNumZ);
 	}
 
+	void D3D12CommandList::ExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, uint32_t InMaxCommandsNum, GEPUtils::Graphics::Buffer& InArgumentBuffer, uint64_t InArgumentOffset, 
+		GEPUtils::Graphics::Buffer* InCountBuffer, uint64_t InCountOffset)
+	{
+		ID3D12Resource* countBuffer = InCountBuffer ? static_cast<D3D12GEPUtils::D3D12Resource*>(InCountBuffer)->GetInner().Get() : nullptr;
+
+		ExecuteIndirect_Internal(InSignature, InMaxCommandsNum, static_cast<D3D12GEPUtils::D3D12Resource&>(InArgumentBuffer).GetInner().Get(), InArgumentOffset, countBuffer, InCountOffset);
+	}
+
+	void D3D12CommandList::StoreAndExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, const GEPUtils::Graphics::IndirectArgumentBuilder& InArgumentBuilder)
+	{
+		Check(!IsBundle()); // Frame memory gets reused while the bundle could still be executed
+
+		Check(InSignature.GetArgumentType() == InArgumentBuilder.GetArgumentType());
+
+		const uint32_t argumentsNum = InArgumentBuilder.GetArgumentsNum();
+		if (argumentsNum == 0)
+			return;
+
+		// Arguments followed by their count, in a single allocation (strides are multiples of 4 bytes, so the count stays aligned)
+		const size_t argumentsSize = InArgumentBuilder.GetDataSize();
+		void* cpuPtr; ID3D12Resource* uploadResource; uint64_t uploadOffset;
+		static_cast<GEPUtils::Graphics::D3D12GraphicsAllocator*>(GEPUtils::Graphics::GraphicsAllocator::Get())->ReserveDynamicBufferMemory(argumentsSize + sizeof(uint32_t), cpuPtr, uploadResource, uploadOffset);
+
+		memcpy(cpuPtr, InArgumentBuilder.GetData(), argumentsSize);
+		memcpy(static_cast<uint8_t*>(cpuPtr) + argumentsSize, &argumentsNum, sizeof(uint32_t));
+
+		ExecuteIndirect_Internal(InSignature, argumentsNum, uploadResource, uploadOffset, uploadResource, uploadOffset + argumentsSize);
+	}
+
+	void D3D12CommandList::ExecuteIndirect_Internal(GEPUtils::Graphics::CommandSignature& InSignature, uint32_t InMaxCommandsNum, ID3D12Resource* InArgumentBuffer, uint64_t InArgumentOffset, 
+		ID3D12Resource* InCountBuffer, uint64_t InCountOffset)
+	{
+		// Note: as for Dispatch(..), staged descriptors are only committed for draws
+		if (InSignature.GetArgumentType() == GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED)
+			m_StagedDescriptorManager.CommitStagedDescriptorsForDraw(*this);
+
+		FlushResourceBarriers();
+
+		m_D3D12CmdList->ExecuteIndirect(static_cast<GEPUtils::Graphics::D3D12CommandSignature&>(InSignature).GetInner().Get(), InMaxCommandsNum, 
+			InArgumentBuffer, InArgumentOffset, InCountBuffer, InCountOffset);
+	}
+
+	void D3D12CommandList::ExecuteBundle_Internal(GEPUtils::Graphics::CommandList& InBundle)
+	{
+		D3D12CommandList& d3d12Bundle = static_cast<D3D12CommandList&>(InBundle);
+
+		// Tables staged so far are bound now, so that the bundle inherits them as root arguments
+		m_StagedDescriptorManager.CommitStagedDescriptorsForDraw(*this);
+
+		FlushResourceBarriers();
+
+		m_D3D12CmdList->ExecuteBundle(d3d12Bundle.GetInner().Get());
+
+		// Note: the same bundle is usually executed many times in a row, we only need to remember it once
+		if (m_ExecutedBundles.empty() || m_ExecutedBundles.back() != &d3d12Bundle)
+			m_ExecutedBundles.push_back(&d3d12Bundle);
+	}
+
+	void D3D12CommandList::ResetBundle()
+	{
+		if (!IsBundle())
+		{
+			StopForFail("[D3D12CommandList] Only bundles can be reset this way, command lists are reset by their command queue.");
+			return;
+		}
+
+		// The commands recorded so far are overwritten in the allocator memory, so the GPU needs to be done executing them
+		if (m_LastExecutingQueue && !m_LastExecutingQueue->IsFenceComplete(m_LastExecutionFenceValue))
+			m_LastExecutingQueue->WaitForFenceValue(m_LastExecutionFenceValue);
+
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> bundleAllocator;
+		UINT dataSize = sizeof(ID3D12CommandAllocator*);
+		D3D12GEPUtils::ThrowIfFailed(m_D3D12CmdList->GetPrivateData(__uuidof(ID3D12CommandAllocator), &dataSize, bundleAllocator.GetAddressOf()));
+
+		D3D12GEPUtils::ThrowIfFailed(bundleAllocator->Reset());
+		D3D12GEPUtils::ThrowIfFailed(m_D3D12CmdList->Reset(bundleAllocator.Get(), nullptr));
+
+		ResetTrackedStates();
+	}
+
+	void D3D12CommandList::OnSubmitted(D3D12GEPUtils::D3D12CommandQueue& InCmdQueue, uint64_t InFenceValue)
+	{
+		for (D3D12CommandList* currentBundle : m_ExecutedBundles)
+		{
+			currentBundle->m_LastExecutingQueue = &InCmdQueue;
+			currentBundle->m_LastExecutionFenceValue = InFenceValue;
+		}
+		m_ExecutedBundles.clear();
+	}
+
 	void D3D12CommandList::SetGraphicsRootTable(uint32_t InRootIndex, GEPUtils::Graphics::ConstantBufferView& InView)
 	{
 		m_D3D12CmdList->SetGraphicsRootDescriptorTable(InRootIndex, static_cast<D3D12GEPUtils::D3D12ConstantBufferView&>(InView).m_GpuAllocatedRange->m_FirstGpuHandle);
 	}
 
+	void D3D12CommandList::SetGraphicsRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		m_D3D12CmdList->SetGraphicsRootConstantBufferView(InRootIdx, InGpuAddress);
+	}
+
+	void D3D12CommandList::SetComputeRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		m_D3D12CmdList->SetComputeRootConstantBufferView(InRootIdx, InGpuAddress);
+	}
+
+	void D3D12CommandList::SetGraphicsRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		m_D3D12CmdList->SetGraphicsRootShaderResourceView(InRootIdx, InGpuAddress);
+	}
+
+	void D3D12CommandList::SetComputeRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		m_D3D12CmdList->SetComputeRootShaderResourceView(InRootIdx, InGpuAddress);
+	}
+
+	void D3D12CommandList::SetGraphicsRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		m_D3D12CmdList->SetGraphicsRootUnorderedAccessView(InRootIdx, InGpuAddress);
+	}
+
+	void D3D12CommandList::SetComputeRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress)
+	{
+		m_D3D12CmdList->SetComputeRootUnorderedAccessView(InRootIdx, InGpuAddress);
+	}
 
 	void D3D12CommandList::StoreAndReferenceDynamicBuffer(uint32_t InRootIndex, GEPUtils::Graphics::DynamicBuffer& InDynBuffer, GEPUtils::Graphics::ConstantBufferView& InResourceView)
 	{
+		Check(!IsBundle()); // Frame memory gets reused while the bundle could still be executed
+
 		// Create space for current Dynamic Buffer value
 		void* cpuPtr; D3D12_GPU_VIRTUAL_ADDRESS gpuPtr;
 		static_cast<GEPUtils::Graphics::D3D12GraphicsAllocator*>(GEPUtils::Graphics::GraphicsAllocator::Get())->ReserveDynamicBufferMemory(InDynBuffer.GetBufferSize(), cpuPtr, gpuPtr);
@@ -139,8 +328,24 @@ namespace GEPUtils { namespace Graphics {
 		m_StagedDescriptorManager.StageDynamicDescriptors(InRootIndex, bufferView.GetCPUDescHandle(), bufferView.GetRangeSize());
 	}
 
+	void D3D12CommandList::StoreAndSetDynamicRootConstantBuffer(uint32_t InRootIdx, GEPUtils::Graphics::DynamicBuffer& InDynBuffer)
+	{
+		Check(!IsBundle()); // Frame memory gets reused while the bundle could still be executed
+
+		// Note: dynamic buffer allocations are already aligned to D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, as root CBVs require
+		void* cpuPtr; D3D12_GPU_VIRTUAL_ADDRESS gpuPtr;
+		static_cast<GEPUtils::Graphics::D3D12GraphicsAllocator*>(GEPUtils::Graphics::GraphicsAllocator::Get())->ReserveDynamicBufferMemory(InDynBuffer.GetBufferSize(), cpuPtr, gpuPtr);
+
+		memcpy(cpuPtr, InDynBuffer.GetData(), InDynBuffer.GetDataSize());
+
+		m_D3D12CmdList->SetGraphicsRootConstantBufferView(InRootIdx, gpuPtr);
+	}
+
 	void D3D12CommandList::UploadBufferData(GEPUtils::Graphics::Buffer& DestinationBuffer, GEPUtils::Graphics::Buffer& IntermediateBuffer, const void* InBufferData, size_t InDataSize)
 	{
+		TransitionResource(DestinationBuffer, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
+		FlushResourceBarriers();
+
 		// Now that both copy and dest resource are created on CPU, we can use them to update the corresponding GPU SubResource
 		D3D12_SUBRESOURCE_DATA subresourceData = {};
 		subresourceData.pData = InBufferData; // Pointer to the memory block that contains the subresource data on CPU
@@ -153,6 +358,24 @@ namespace GEPUtils { namespace Graphics {
 
 	}
 
+	void D3D12CommandList::UploadBufferRegion(GEPUtils::Graphics::Buffer& InDestBuffer, uint64_t InDestOffset, GEPUtils::Graphics::Buffer& InStagingBuffer, uint64_t InStagingOffset, const void* InData, size_t InDataSize)
+	{
+		Check(!IsBundle()); // Bundles cannot record copies
+
+		D3D12GEPUtils::D3D12Resource& d3d12StagingBuffer = static_cast<D3D12GEPUtils::D3D12Resource&>(InStagingBuffer);
+
+		// Note: upload heap memory is write-combined, so we only write to it and never read back
+		void* stagingCpuPtr;
+		d3d12StagingBuffer.Map(&stagingCpuPtr);
+		memcpy(static_cast<uint8_t*>(stagingCpuPtr) + InStagingOffset, InData, InDataSize);
+		d3d12StagingBuffer.UnMap();
+
+		TransitionResource(InDestBuffer, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
+		FlushResourceBarriers();
+
+		m_D3D12CmdList->CopyBufferRegion(static_cast<D3D12GEPUtils::D3D12Resource&>(InDestBuffer).GetInner().Get(), InDestOffset, d3d12StagingBuffer.GetInner().Get(), InStagingOffset, InDataSize);
+	}
+
 	void D3D12CommandList::UploadViewToGPU(GEPUtils::Graphics::ShaderResourceView& InSRV)
 	{
 		D3D12GEPUtils::D3D12ShaderResourceView& d3d12SRV = static_cast<D3D12GEPUtils::D3D12ShaderResourceView&>(InSRV);
@@ -14,6 +14,10 @@
 #include <functional>
 #include "d3dx12.h"
 
+namespace D3D12GEPUtils {
+	class D3D12CommandQueue;
+}
+
 namespace GEPUtils { namespace Graphics {
 
 	class D3D12Device;
@@ -21,13 +25,11 @@ namespace GEPUtils { namespace Graphics {
 	class D3D12CommandList : public GEPUtils::Graphics::CommandList
 	{
 	public:
-		D3D12CommandList(Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> InCmdList, GEPUtils::Graphics::Device& InOwningDevice);
+		// Note: bundles need to be created with a command allocator of bundle type, set as private data of the command list
+		D3D12CommandList(Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> InCmdList, GEPUtils::Graphics::Device& InOwningDevice, bool InIsBundle = false);
 		
 		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2>& GetInner() { return m_D3D12CmdList; }
 
-		virtual void ResourceBarrier(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InPrevState, GEPUtils::Graphics::RESOURCE_STATE InAfterState) override;
-
-
 		virtual void ClearRTV(GEPUtils::Graphics::CpuDescHandle& InDescHandle, float* InColor) override;
 
 
@@ -36,34 +38,49 @@ namespace GEPUtils { namespace Graphics {
 
 		virtual void Close() override;
 
-		virtual void SetPipelineStateAndResourceBinder(Graphics::PipelineState& InPipelineState) override;
+		virtual void SetGraphicsRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues) override;
 
+		virtual void SetComputeRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues) override;
 
-		virtual void SetInputAssemblerData(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology, GEPUtils::Graphics::VertexBufferView& InVertexBufView, GEPUtils::Graphics::IndexBufferView& InIndexBufView) override;
 
+		virtual void DrawIndexedInstanced(uint32_t InIndexCountPerInstance, uint32_t InInstanceCount, uint32_t InStartIndexLocation, int32_t InBaseVertexLocation, uint32_t InStartInstanceLocation) override;
 
-		virtual void SetViewportAndScissorRect(GEPUtils::Graphics::ViewPort& InViewport, GEPUtils::Graphics::Rect& InScissorRect) override;
+		virtual void Dispatch(uint32_t InGroupsNumX, uint32_t InGroupsNumY, uint32_t InGroupsNumZ) override;
 
+		virtual void ExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, uint32_t InMaxCommandsNum, GEPUtils::Graphics::Buffer& InArgumentBuffer, uint64_t InArgumentOffset, 
+			GEPUtils::Graphics::Buffer* InCountBuffer, uint64_t InCountOffset) override;
 
-		virtual void SetRenderTargetFromWindow(GEPUtils::Graphics::Window& InWindow) override;
+		virtual void StoreAndExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, const GEPUtils::Graphics::IndirectArgumentBuilder& InArgumentBuilder) override;
 
+		virtual void ResetBundle() override;
 
-		virtual void SetGraphicsRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues) override;
+		// To be called by the command queue right after submitting the command list:
+		// the bundles executed by it are considered in use on GPU until InFenceValue is reached.
+		void OnSubmitted(D3D12GEPUtils::D3D12CommandQueue& InCmdQueue, uint64_t InFenceValue);
 
-		virtual void SetComputeRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues) override;
+		virtual void SetGraphicsRootTable(uint32_t InRootIndex, GEPUtils::Graphics::ConstantBufferView& InView) override;
 
+		virtual void SetGraphicsRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress) override;
 
-		virtual void DrawIndexed(uint64_t InIndexCountPerInstance) override;
+		virtual void SetComputeRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress) override;
 
-		virtual void Dispatch(uint32_t InGroupsNumX, uint32_t InGroupsNumY, uint32_t InGroupsNumZ) override;
+		virtual void SetGraphicsRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress) override;
 
-		virtual void SetGraphicsRootTable(uint32_t InRootIndex, GEPUtils::Graphics::ConstantBufferView& InView) override;
+		virtual void SetComputeRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress) override;
+
+		virtual void SetGraphicsRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress) override;
+
+		virtual void SetComputeRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress) override;
 
 		virtual void StoreAndReferenceDynamicBuffer(uint32_t InRootIdx, GEPUtils::Graphics::DynamicBuffer& InDynBuffer, GEPUtils::Graphics::ConstantBufferView& InResourceView) override;
 
+		virtual void StoreAndSetDynamicRootConstantBuffer(uint32_t InRootIdx, GEPUtils::Graphics::DynamicBuffer& InDynBuffer) override;
+
 
 		virtual void UploadBufferData(GEPUtils::Graphics::Buffer& DestinationBuffer, GEPUtils::Graphics::Buffer& IntermediateBuffer, const void* InBufferData, size_t InDataSize) override;
 
+		virtual void UploadBufferRegion(GEPUtils::Graphics::Buffer& InDestBuffer, uint64_t InDestOffset, GEPUtils::Graphics::Buffer& InStagingBuffer, uint64_t InStagingOffset, const void* InData, size_t InDataSize) override;
+
 
 		virtual void UploadViewToGPU(GEPUtils::Graphics::ShaderResourceView& InSRV) override;
 
@@ -78,11 +95,60 @@ namespace GEPUtils { namespace Graphics {
 
 		void SetGraphicsRootDescriptorTable(uint32_t InRootIdx, D3D12_GPU_DESCRIPTOR_HANDLE InGpuDescHandle);
 
+		// Records the given transitions right away, without going through the resource state tracker.
+		// Used by the command queue to prepend the transitions resolved at submission time.
+		void ExecuteResourceBarriers(const GEPUtils::Graphics::RESOURCE_TRANSITION* InBarriers, uint32_t InBarriersNum);
+
 		CD3DX12_GPU_DESCRIPTOR_HANDLE CopyDynamicDescriptorsToBoundHeap(uint32_t InTablesNum, D3D12_CPU_DESCRIPTOR_HANDLE* InDescHandleArray, uint32_t* InRageSizeArray);
 
+	protected:
+		virtual void SetPipelineState_Internal(Graphics::PipelineState& InPipelineState) override;
+
+		virtual const void* GetRootSignatureIdentity_Internal(Graphics::PipelineState& InPipelineState) override;
+
+		virtual void SetRootSignature_Internal(Graphics::PipelineState& InPipelineState) override;
+
+		virtual const void* GetDescriptorHeapIdentity_Internal() override;
+
+		virtual void SetDescriptorHeap_Internal() override;
+
+		virtual void SetPrimitiveTopology_Internal(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology) override;
+
+		virtual void SetVertexBuffer_Internal(uint32_t InSlot, GEPUtils::Graphics::VertexBufferView& InVertexBufView) override;
+
+		virtual void SetIndexBuffer_Internal(GEPUtils::Graphics::IndexBufferView& InIndexBufView) override;
+
+		virtual void SetViewport_Internal(GEPUtils::Graphics::ViewPort& InViewport) override;
+
+		virtual void SetScissorRect_Internal(GEPUtils::Graphics::Rect& InScissorRect) override;
+
+		virtual void SetRenderTargetFromWindow_Internal(GEPUtils::Graphics::Window& InWindow) override;
+
+		virtual void ExecuteResourceBarriers_Internal(const GEPUtils::Graphics::RESOURCE_TRANSITION* InBarriers, uint32_t InBarriersNum) override;
+
+		virtual void ExecuteAliasingBarrier_Internal(GEPUtils::Graphics::Resource& InResourceAfter) override;
+
+		virtual void DiscardResource_Internal(GEPUtils::Graphics::Resource& InResource) override;
+
+		virtual void ExecuteBundle_Internal(GEPUtils::Graphics::CommandList& InBundle) override;
+
 	private:
+		// Common part of the indirect executions, once the argument and count buffers are known
+		void ExecuteIndirect_Internal(GEPUtils::Graphics::CommandSignature& InSignature, uint32_t InMaxCommandsNum, ID3D12Resource* InArgumentBuffer, uint64_t InArgumentOffset, 
+			ID3D12Resource* InCountBuffer, uint64_t InCountOffset);
+
 		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList2> m_D3D12CmdList;
 
+		// Kept to avoid allocating every time barriers are flushed
+		std::vector<D3D12_RESOURCE_BARRIER> m_BarriersScratch;
+
+		// Bundles executed since the last submission
+		std::vector<D3D12CommandList*> m_ExecutedBundles;
+
+		// For bundles, the last submission executing them. Only the last queue is tracked, bundles are expected to be executed on a single queue.
+		D3D12GEPUtils::D3D12CommandQueue* m_LastExecutingQueue = nullptr;
+		uint64_t m_LastExecutionFenceValue = 0;
+
 		class D3D12StagedDescriptorManager {
 		public:
 			// Dynamic entries will be first uploaded to the desc heap bound to the root signature, and then bound to the command list as root table when the next draw/dispatch command is executed
@@ -117,6 +117,8 @@ namespace D3D12GEPUtils {
 			// Reference the chosen command allocator in the command list's private data, so we can retrieve it on the fly when we need it
 			D3D12GEPUtils::ThrowIfFailed(outObj->GetInner()->SetPrivateDataInterface(__uuidof(cmdAllocator), cmdAllocator.Get()));
 			// Note: setting a ComPtr as private data Does increment the reference count of that ComPtr !!
+			// A reset command list starts with no state set, so the state it was filtering on and the resource states it was tracking are not valid anymore
+			outObj->ResetTrackedStates();
 			return *outObj;
 		}
 		
@@ -153,20 +155,47 @@ namespace D3D12GEPUtils {
 	{
 		InCmdList.Close();
 
-		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> cmdAllocator;
-		UINT dataSize = sizeof(cmdAllocator);
+		// The states of the resources used for the first time in the command list are known only now:
+		// the transitions needed to bring them to the expected state are recorded in a separate command list, executed right before.
+		m_ResolvedBarriers.clear();
+		InCmdList.GetResourceStateTracker().ResolvePendingTransitions(m_ResolvedBarriers);
 
-		auto d3d12CmdList = static_cast<GEPUtils::Graphics::D3D12CommandList&>(InCmdList).GetInner();
+		GEPUtils::Graphics::CommandList* barriersCmdList = nullptr;
+		if (!m_ResolvedBarriers.empty())
+		{
+			barriersCmdList = &GetAvailableCommandList();
+			static_cast<GEPUtils::Graphics::D3D12CommandList*>(barriersCmdList)->ExecuteResourceBarriers(m_ResolvedBarriers.data(), static_cast<uint32_t>(m_ResolvedBarriers.size()));
+			static_cast<GEPUtils::Graphics::D3D12CommandList*>(barriersCmdList)->GetInner()->Close();
+		}
 
-		D3D12GEPUtils::ThrowIfFailed(d3d12CmdList->GetPrivateData(__uuidof(ID3D12CommandAllocator), &dataSize, cmdAllocator.GetAddressOf()));
+		GEPUtils::Graphics::CommandList* cmdListsToExecute[] = { barriersCmdList, &InCmdList };
+		ID3D12CommandList* ppCmdLists[2];
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> cmdAllocators[2];
+		UINT cmdListsNum = 0;
 
-		ID3D12CommandList* const ppCmdLists[] = { d3d12CmdList.Get() };
+		for (GEPUtils::Graphics::CommandList* currentCmdList : cmdListsToExecute)
+		{
+			if (!currentCmdList)
+				continue;
 
-		m_CmdQueue->ExecuteCommandLists(1, ppCmdLists);
+			auto d3d12CmdList = static_cast<GEPUtils::Graphics::D3D12CommandList*>(currentCmdList)->GetInner();
+
+			UINT dataSize = sizeof(ID3D12CommandAllocator*);
+			D3D12GEPUtils::ThrowIfFailed(d3d12CmdList->GetPrivateData(__uuidof(ID3D12CommandAllocator), &dataSize, cmdAllocators[cmdListsNum].GetAddressOf()));
+
+			ppCmdLists[cmdListsNum++] = d3d12CmdList.Get();
+		}
+
+		m_CmdQueue->ExecuteCommandLists(cmdListsNum, ppCmdLists);
 		uint64_t fenceValue = Signal();
 
-		m_CmdAllocators.emplace(CmdAllocatorEntry{ fenceValue, cmdAllocator }); // Note: implicit creation of a ComPtr from a raw pointer to create CmdAllocatorEntry
+		for (UINT cmdListIdx = 0; cmdListIdx < cmdListsNum; cmdListIdx++)
+			m_CmdAllocators.emplace(CmdAllocatorEntry{ fenceValue, cmdAllocators[cmdListIdx] }); // Note: implicit creation of a ComPtr from a raw pointer to create CmdAllocatorEntry
 		
+		static_cast<GEPUtils::Graphics::D3D12CommandList&>(InCmdList).OnSubmitted(*this, fenceValue);
+
+		if (barriersCmdList)
+			m_CmdListsAvailable.push(barriersCmdList);
 		m_CmdListsAvailable.push(&InCmdList);
 
 		return fenceValue;
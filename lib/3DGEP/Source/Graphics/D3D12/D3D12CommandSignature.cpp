@@ -0,0 +1,33 @@
+/*
+ D3D12CommandSignature.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "D3D12CommandSignature.h"
+#include "D3D12Device.h"
+#include "D3D12GEPUtils.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	void D3D12CommandSignature::Init(GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE InArgumentType)
+	{
+		m_ArgumentType = InArgumentType;
+
+		D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+		argumentDesc.Type = InArgumentType == INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED ? D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED : D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH;
+
+		D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+		signatureDesc.ByteStride = GetByteStride();
+		signatureDesc.NumArgumentDescs = 1;
+		signatureDesc.pArgumentDescs = &argumentDesc;
+		signatureDesc.NodeMask = 0;
+
+		// Note: a root signature is only needed when arguments change root parameters
+		Microsoft::WRL::ComPtr<ID3D12Device2> d3d12GraphicsDevice = static_cast<Graphics::D3D12Device&>(Graphics::GetDevice()).GetInner();
+		D3D12GEPUtils::ThrowIfFailed(d3d12GraphicsDevice->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&m_CommandSignature)));
+	}
+
+} }
@@ -0,0 +1,31 @@
+/*
+ D3D12CommandSignature.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef D3D12CommandSignature_h__
+#define D3D12CommandSignature_h__
+
+#include "CommandSignature.h"
+#include <d3dx12.h>
+
+namespace GEPUtils { namespace Graphics {
+
+	class D3D12CommandSignature : public CommandSignature {
+	public:
+		D3D12CommandSignature() = default;
+
+		virtual void Init(GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE InArgumentType) override;
+
+		Microsoft::WRL::ComPtr<ID3D12CommandSignature> GetInner() { return m_CommandSignature; }
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_CommandSignature;
+	};
+
+} }
+
+#endif // D3D12CommandSignature_h__
@@ -8,6 +8,7 @@
  
 #include "D3D12Device.h"
 #include "D3D12GEPUtils.h"
+#include "GEPUtilsHash.h"
 
 using namespace Microsoft::WRL;
 
@@ -19,6 +20,18 @@ D3D12Device::D3D12Device()
 
 	m_D3d12Device = D3D12GEPUtils::CreateDevice(adapter);
 
+	// Identity from the adapter model and the user mode driver version, so that data cached by a different GPU or driver is not reused
+	DXGI_ADAPTER_DESC1 adapterDesc = {};
+	D3D12GEPUtils::ThrowIfFailed(adapter->GetDesc1(&adapterDesc));
+	LARGE_INTEGER driverVersion = {};
+	adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+
+	m_IdentityHash = GEPUtils::Hash::HashValue(adapterDesc.VendorId, GEPUtils::Hash::g_FnvOffsetBasis);
+	m_IdentityHash = GEPUtils::Hash::HashValue(adapterDesc.DeviceId, m_IdentityHash);
+	m_IdentityHash = GEPUtils::Hash::HashValue(adapterDesc.SubSysId, m_IdentityHash);
+	m_IdentityHash = GEPUtils::Hash::HashValue(adapterDesc.Revision, m_IdentityHash);
+	m_IdentityHash = GEPUtils::Hash::HashValue(driverVersion.QuadPart, m_IdentityHash);
+
 #if _DEBUG
 	D3D12GEPUtils::ThrowIfFailed(DXGIGetDebugInterface1(0, IID_PPV_ARGS(&m_DxgiDebug)));
 
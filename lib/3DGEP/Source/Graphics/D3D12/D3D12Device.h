@@ -38,11 +38,15 @@ public:
 
 	virtual void ShutDown() override;
 
+	virtual uint64_t GetIdentityHash() const override { return m_IdentityHash; }
+
 private:
 
 	void SetMessageBreaksOnSeverity();
 
 	Microsoft::WRL::ComPtr<ID3D12Device2> m_D3d12Device;
+
+	uint64_t m_IdentityHash = 0;
 #if _DEBUG
 	Microsoft::WRL::ComPtr<IDXGIDebug1> m_DxgiDebug;
 #endif
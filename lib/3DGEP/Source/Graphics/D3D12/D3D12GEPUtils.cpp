@@ -283,14 +283,21 @@ namespace D3D12GEPUtils
 		return ThrowIfFailed(::D3DReadFileToBlob(InFilePath, OutFileBlob));
 	}
 
-	ComPtr<ID3D12RootSignature> SerializeAndCreateRootSignature(ComPtr<ID3D12Device2> InDevice, CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC* InRootSigDesc, D3D_ROOT_SIGNATURE_VERSION InVersion)
+	ComPtr<ID3DBlob> SerializeRootSignature(CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC* InRootSigDesc, D3D_ROOT_SIGNATURE_VERSION InVersion)
 	{
-		// Create Root Signature Blob
 		ComPtr<ID3DBlob> rootSignatureBlob;
 		ComPtr<ID3DBlob> errorBlob;
 		ThrowIfFailed(::D3DX12SerializeVersionedRootSignature(InRootSigDesc, InVersion, 
 			rootSignatureBlob.GetAddressOf(), errorBlob.GetAddressOf()));
 
+		return rootSignatureBlob;
+	}
+
+	ComPtr<ID3D12RootSignature> SerializeAndCreateRootSignature(ComPtr<ID3D12Device2> InDevice, CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC* InRootSigDesc, D3D_ROOT_SIGNATURE_VERSION InVersion)
+	{
+		// Create Root Signature Blob
+		ComPtr<ID3DBlob> rootSignatureBlob = SerializeRootSignature(InRootSigDesc, InVersion);
+
 		// Create the Root Signature object from the blob
 		ComPtr<ID3D12RootSignature> rootSignature;
 		ThrowIfFailed(InDevice->CreateRootSignature(0, rootSignatureBlob->GetBufferPointer(), rootSignatureBlob->GetBufferSize(), IID_PPV_ARGS(&rootSignature)));
@@ -469,9 +476,9 @@ namespace D3D12GEPUtils
 		}
 	}
 
-	D3D12Texture::D3D12Texture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels)
+	D3D12Texture::D3D12Texture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags /*= GEPUtils::Graphics::RESOURCE_FLAGS::NONE*/)
 	{
-		SetGeneralTextureParams(InWidth, InHeight, InType, InFormat, InArraySize, InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS::NONE);
+		SetGeneralTextureParams(InWidth, InHeight, InType, InFormat, InArraySize, InMipLevels, InCreationFlags);
 	}
 
 	D3D12Texture::D3D12Texture(const wchar_t* InTexturePath, GEPUtils::Graphics::TEXTURE_FILE_FORMAT InFileFormat, int32_t InMipsNum, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags)
@@ -555,14 +562,15 @@ namespace D3D12GEPUtils
 	{
 		InstantiateOnGPU();
 
+		InCommandList.TransitionResource(*this, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
+		InCommandList.FlushResourceBarriers();
+
 		ID3D12GraphicsCommandList2* d3d12CmdList = static_cast<GEPUtils::Graphics::D3D12CommandList&>(InCommandList).GetInner().Get();
 
 		::UpdateSubresources(d3d12CmdList, m_D3D12Resource.Get(), static_cast<D3D12GEPUtils::D3D12Resource&>(InIntermediateBuffer).GetInner().Get(), 0, 0, m_SubresourceDesc.size(), m_SubresourceDesc.data());
 
-		// Transition texture state to GENERIC_READ to be read by shaders
-		// Note: this is not optimal, usually we should transition the resource depending on the situation in which we want to use it, e.g. D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE in the case of pixel shader usage
-		CD3DX12_RESOURCE_BARRIER transitionBarrier = CD3DX12_RESOURCE_BARRIER::Transition(m_D3D12Resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
-		d3d12CmdList->ResourceBarrier(1, &transitionBarrier);
+		// Note: the texture is left in copy destination state, users need to transition it depending on the situation in which they want to use it
+		// (e.g. PIXEL_SHADER_RESOURCE in the case of pixel shader usage), the transition will be batched with the others of the same command list.
 	}
 
 	void D3D12Texture::InstantiateOnGPU()
@@ -579,6 +587,30 @@ namespace D3D12GEPUtils
 				D3D12_RESOURCE_STATE_COPY_DEST, // We can create the resource directly in copy destination state since we want to fill it with content
 				nullptr,
 				IID_PPV_ARGS(&m_D3D12Resource));
+
+			GEPUtils::Graphics::ResourceStateRegistry::Get().RegisterResource(*this, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
+		}
+		else
+		{
+			StopForFail("Texture GPU resource already allocated")
+		}
+	}
+
+	void D3D12Texture::InstantiatePlacedOnGPU(ID3D12Heap* InHeap, uint64_t InHeapOffset, GEPUtils::Graphics::RESOURCE_STATE InInitialState)
+	{
+		ID3D12Device2* d3d12Device = static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner().Get();
+
+		if (!m_D3D12Resource)
+		{
+			// Note: no memory is allocated here, the resource will use the one of the heap, starting from the given offset
+			ThrowIfFailed(d3d12Device->CreatePlacedResource(
+				InHeap, InHeapOffset,
+				&m_TextureDesc,
+				D3D12GEPUtils::ResourceStateTypeToD3D12(InInitialState),
+				nullptr,
+				IID_PPV_ARGS(&m_D3D12Resource)));
+
+			GEPUtils::Graphics::ResourceStateRegistry::Get().RegisterResource(*this, InInitialState);
 		}
 		else
 		{
@@ -9,6 +9,7 @@
 #include "D3D12GraphicsAllocator.h"
 #include "D3D12GEPUtils.h"
 #include "D3D12PipelineState.h"
+#include "D3D12CommandSignature.h"
 #include "D3D12CommandList.h"
 #include "D3D12Device.h"
 #include "D3D12UtilsInternal.h"
@@ -27,10 +28,15 @@ namespace GEPUtils { namespace Graphics {
 
 	D3D12GraphicsAllocator::~D3D12GraphicsAllocator()
 	{
+		// Compilations in flight reference pipeline states owned by this class, that are going to be destroyed before the base class
+		WaitForPipelineStateCompilations();
+
 		m_DynamicBufferAllocator.reset();
 
 		m_DescHeapFactory.reset();
 
+		// All the tracked resources are owned by this allocator
+		GEPUtils::Graphics::ResourceStateRegistry::Get().Clear();
 	}
 
 	GEPUtils::Graphics::Resource& D3D12GraphicsAllocator::AllocateEmptyResource()
@@ -53,6 +59,8 @@ namespace GEPUtils { namespace Graphics {
 
 		m_ResourceArray.push_back(std::make_unique<D3D12GEPUtils::D3D12Resource>(d3d12Resource));
 
+		GEPUtils::Graphics::ResourceStateRegistry::Get().RegisterResource(*m_ResourceArray.back(), InState);
+
 		d3d12Resource.Reset();
 
 		return static_cast<GEPUtils::Graphics::Buffer&>(*m_ResourceArray.back());
@@ -72,9 +80,9 @@ namespace GEPUtils { namespace Graphics {
 		return static_cast<GEPUtils::Graphics::Texture&>(*m_ResourceArray.back());
 	}
 
-	GEPUtils::Graphics::Texture& D3D12GraphicsAllocator::AllocateEmptyTexture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels)
+	GEPUtils::Graphics::Texture& D3D12GraphicsAllocator::AllocateEmptyTexture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags /*= RESOURCE_FLAGS::NONE*/)
 	{
-		std::unique_ptr<D3D12GEPUtils::D3D12Texture> outputTexture = std::make_unique<D3D12GEPUtils::D3D12Texture>(InWidth, InHeight, InType, InFormat, InArraySize, InMipLevels);
+		std::unique_ptr<D3D12GEPUtils::D3D12Texture> outputTexture = std::make_unique<D3D12GEPUtils::D3D12Texture>(InWidth, InHeight, InType, InFormat, InArraySize, InMipLevels, InCreationFlags);
 		outputTexture->InstantiateOnGPU(); // Allocate empty space on GPU
 
 		m_ResourceArray.push_back(std::move(outputTexture));
@@ -82,6 +90,103 @@ namespace GEPUtils { namespace Graphics {
 		return static_cast<GEPUtils::Graphics::Texture&>(*m_ResourceArray.back());
 	}
 
+	GEPUtils::Graphics::ResourceHeap& D3D12GraphicsAllocator::AllocateResourceHeap(uint64_t InSize, GEPUtils::Graphics::RESOURCE_HEAP_USAGE InUsage)
+	{
+		ID3D12Device2* d3d12Device = static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner().Get();
+
+		// Note: heap sizes need to be a multiple of the placement alignment
+		InSize = std::max<uint64_t>((InSize + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) & ~(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1), D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+
+		CD3DX12_HEAP_DESC heapDesc(InSize, D3D12_HEAP_TYPE_DEFAULT, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, D3D12GEPUtils::HeapUsageToD3D12(InUsage));
+
+		Microsoft::WRL::ComPtr<ID3D12Heap> d3d12Heap;
+		D3D12GEPUtils::ThrowIfFailed(d3d12Device->CreateHeap(&heapDesc, IID_PPV_ARGS(&d3d12Heap)));
+
+		m_ResourceHeapArray.push_back(std::make_unique<D3D12GEPUtils::D3D12ResourceHeap>(d3d12Heap, InSize, InUsage));
+
+		return *m_ResourceHeapArray.back();
+	}
+
+	void D3D12GraphicsAllocator::ReleaseResource(GEPUtils::Graphics::Resource& InResource)
+	{
+		auto foundResourceIt = std::find_if(m_ResourceArray.begin(), m_ResourceArray.end(),
+			[&InResource](const std::unique_ptr<GEPUtils::Graphics::Resource>& InElement) { return InElement.get() == &InResource; });
+		if (foundResourceIt == m_ResourceArray.end())
+		{
+			StopForFail("[D3D12GraphicsAllocator] Trying to release a resource that was not allocated by this allocator.");
+			return;
+		}
+
+		// Note: erasing from the deque only moves the owning pointers, the other resources keep their address
+		m_ReleasedResources.emplace_back(Application::GetCurrentFrameNumber(), std::move(*foundResourceIt));
+		m_ResourceArray.erase(foundResourceIt);
+	}
+
+	void D3D12GraphicsAllocator::ReleaseResourceHeap(GEPUtils::Graphics::ResourceHeap& InHeap)
+	{
+		auto foundHeapIt = std::find_if(m_ResourceHeapArray.begin(), m_ResourceHeapArray.end(),
+			[&InHeap](const std::unique_ptr<GEPUtils::Graphics::ResourceHeap>& InElement) { return InElement.get() == &InHeap; });
+		if (foundHeapIt == m_ResourceHeapArray.end())
+		{
+			StopForFail("[D3D12GraphicsAllocator] Trying to release a resource heap that was not allocated by this allocator.");
+			return;
+		}
+
+		m_ReleasedResourceHeaps.emplace_back(Application::GetCurrentFrameNumber(), std::move(*foundHeapIt));
+		m_ResourceHeapArray.erase(foundHeapIt);
+	}
+
+	GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO D3D12GraphicsAllocator::GetTextureAllocationInfo(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags /*= RESOURCE_FLAGS::NONE*/)
+	{
+		// Constructing the texture object only fills its description, nothing is created on GPU
+		D3D12GEPUtils::D3D12Texture textureDescOnly(InWidth, InHeight, InType, InFormat, InArraySize, InMipLevels, InCreationFlags);
+
+		D3D12_RESOURCE_ALLOCATION_INFO d3d12AllocInfo = static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner()->GetResourceAllocationInfo(0, 1, &textureDescOnly.GetDesc());
+
+		GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO outAllocInfo;
+		outAllocInfo.Size = d3d12AllocInfo.SizeInBytes;
+		outAllocInfo.Alignment = d3d12AllocInfo.Alignment;
+		return outAllocInfo;
+	}
+
+	GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO D3D12GraphicsAllocator::GetBufferAllocationInfo(size_t InSize, GEPUtils::Graphics::RESOURCE_FLAGS InFlags /*= RESOURCE_FLAGS::NONE*/)
+	{
+		CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(InSize, D3D12GEPUtils::ResFlagsToD3D12(InFlags));
+
+		D3D12_RESOURCE_ALLOCATION_INFO d3d12AllocInfo = static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner()->GetResourceAllocationInfo(0, 1, &bufferDesc);
+
+		GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO outAllocInfo;
+		outAllocInfo.Size = d3d12AllocInfo.SizeInBytes;
+		outAllocInfo.Alignment = d3d12AllocInfo.Alignment;
+		return outAllocInfo;
+	}
+
+	GEPUtils::Graphics::Texture& D3D12GraphicsAllocator::AllocatePlacedTexture(GEPUtils::Graphics::ResourceHeap& InHeap, uint64_t InHeapOffset, uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_STATE InState, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags /*= RESOURCE_FLAGS::NONE*/)
+	{
+		std::unique_ptr<D3D12GEPUtils::D3D12Texture> outputTexture = std::make_unique<D3D12GEPUtils::D3D12Texture>(InWidth, InHeight, InType, InFormat, InArraySize, InMipLevels, InCreationFlags);
+		outputTexture->InstantiatePlacedOnGPU(static_cast<D3D12GEPUtils::D3D12ResourceHeap&>(InHeap).GetInner().Get(), InHeapOffset, InState);
+
+		m_ResourceArray.push_back(std::move(outputTexture));
+
+		return static_cast<GEPUtils::Graphics::Texture&>(*m_ResourceArray.back());
+	}
+
+	GEPUtils::Graphics::Buffer& D3D12GraphicsAllocator::AllocatePlacedBuffer(GEPUtils::Graphics::ResourceHeap& InHeap, uint64_t InHeapOffset, size_t InSize, GEPUtils::Graphics::RESOURCE_STATE InState, GEPUtils::Graphics::RESOURCE_FLAGS InFlags /*= RESOURCE_FLAGS::NONE*/)
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> d3d12Resource;
+		D3D12GEPUtils::ThrowIfFailed(static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner()->CreatePlacedResource(
+			static_cast<D3D12GEPUtils::D3D12ResourceHeap&>(InHeap).GetInner().Get(), InHeapOffset,
+			&CD3DX12_RESOURCE_DESC::Buffer(InSize, D3D12GEPUtils::ResFlagsToD3D12(InFlags)),
+			D3D12GEPUtils::ResourceStateTypeToD3D12(InState),
+			nullptr, IID_PPV_ARGS(&d3d12Resource)));
+
+		m_ResourceArray.push_back(std::make_unique<D3D12GEPUtils::D3D12Resource>(d3d12Resource));
+
+		GEPUtils::Graphics::ResourceStateRegistry::Get().RegisterResource(*m_ResourceArray.back(), InState);
+
+		return static_cast<GEPUtils::Graphics::Buffer&>(*m_ResourceArray.back());
+	}
+
 	void D3D12GraphicsAllocator::AllocateBufferCommittedResource(GEPUtils::Graphics::CommandList& InCmdList, GEPUtils::Graphics::Resource& InDestResource, GEPUtils::Graphics::Resource& InIntermediateResource, size_t InNunElements, size_t InElementSize, const void* InBufferData, GEPUtils::Graphics::RESOURCE_FLAGS InFlags /*= GEPUtils::Graphics::RESOURCE_FLAGS::NONE*/)
 	{
 		// Note: ID3D12Resource** InDestResource, ID3D12Resource** InIntermediateResource are CPU Buffer Data !!!
@@ -92,9 +197,14 @@ namespace GEPUtils { namespace Graphics {
 		// so that we can reference that GPU memory address from CPU side.
 		D3D12GEPUtils::CreateCommittedResource(static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner(),
 			&static_cast<D3D12GEPUtils::D3D12Resource&>(InDestResource).GetInner(), D3D12_HEAP_TYPE_DEFAULT, bufferSize, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+		GEPUtils::Graphics::ResourceStateRegistry::Get().RegisterResource(InDestResource, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
 		if (InBufferData)
 		{ // Create a committed resource in an upload heap to upload content to the first resource
 			D3D12GEPUtils::CreateCommittedResource(static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner(), &static_cast<D3D12GEPUtils::D3D12Resource&>(InIntermediateResource).GetInner(), D3D12_HEAP_TYPE_UPLOAD, bufferSize, D3D12GEPUtils::ResFlagsToD3D12(InFlags), D3D12_RESOURCE_STATE_GENERIC_READ);
+			GEPUtils::Graphics::ResourceStateRegistry::Get().RegisterResource(InIntermediateResource, GEPUtils::Graphics::RESOURCE_STATE::GEN_READ);
+
+			InCmdList.TransitionResource(InDestResource, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
+			InCmdList.FlushResourceBarriers();
 
 			// Now that both copy and dest resource are created on CPU, we can use them to update the corresponding GPU SubResource
 			D3D12_SUBRESOURCE_DATA subresourceData = {};
@@ -169,13 +279,34 @@ namespace GEPUtils { namespace Graphics {
 
 	GEPUtils::Graphics::Shader& D3D12GraphicsAllocator::AllocateShader(wchar_t const* InShaderPath)
 	{
-		Microsoft::WRL::ComPtr<ID3DBlob> OutFileBlob;
-		D3D12GEPUtils::ThrowIfFailed(::D3DReadFileToBlob(InShaderPath, &OutFileBlob));
-		m_ShaderArray.push_back(std::make_unique<D3D12GEPUtils::D3D12Shader>(OutFileBlob));
+		const uint32_t bytecodeId = m_ShaderBytecodeStore.LoadBytecode(InShaderPath);
+		if (bytecodeId == GEPUtils::Graphics::ShaderBytecodeStore::INVALID_BYTECODE_ID)
+		{
+			StopForFail("[D3D12GraphicsAllocator] Cannot open shader file.");
+			throw std::exception();
+		}
+
+		// The same file, or another one with the same bytecode, was already requested
+		auto foundShaderIt = m_ShaderByBytecodeId.find(bytecodeId);
+		if (foundShaderIt != m_ShaderByBytecodeId.end())
+			return *foundShaderIt->second;
+
+		m_ShaderArray.push_back(std::make_unique<D3D12GEPUtils::D3D12Shader>(m_ShaderBytecodeStore, bytecodeId));
+		m_ShaderByBytecodeId.emplace(bytecodeId, m_ShaderArray.back().get());
 
 		return *m_ShaderArray.back();
 	}
 
+	bool D3D12GraphicsAllocator::MountShaderArchive(wchar_t const* InArchivePath, wchar_t const* InMountPath)
+	{
+		if (!m_ShaderBytecodeStore.MountArchive(InArchivePath, InMountPath))
+		{
+			DebugPrint("[D3D12GraphicsAllocator] Cannot open shader archive, shaders will be loaded from their own files.");
+			return false;
+		}
+		return true;
+	}
+
 	GEPUtils::Graphics::PipelineState& D3D12GraphicsAllocator::AllocatePipelineState()
 {
 		m_PipelineStateArray.push_back(std::make_unique<GEPUtils::Graphics::D3D12PipelineState>());
@@ -183,11 +314,61 @@ namespace GEPUtils { namespace Graphics {
 		return *m_PipelineStateArray.back();
 	}
 
+	GEPUtils::Graphics::CommandSignature& D3D12GraphicsAllocator::AllocateCommandSignature(GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE InArgumentType)
+	{
+		m_CommandSignatureArray.push_back(std::make_unique<GEPUtils::Graphics::D3D12CommandSignature>());
+
+		m_CommandSignatureArray.back()->Init(InArgumentType);
+
+		return *m_CommandSignatureArray.back();
+	}
+
+	GEPUtils::Graphics::CommandList& D3D12GraphicsAllocator::AllocateBundle()
+	{
+		Microsoft::WRL::ComPtr<ID3D12Device2> d3d12Device = static_cast<GEPUtils::Graphics::D3D12Device&>(GEPUtils::Graphics::GetDevice()).GetInner();
+		const D3D12_COMMAND_LIST_TYPE bundleType = D3D12GEPUtils::CmdListTypeToD3D12(GEPUtils::Graphics::COMMAND_LIST_TYPE::COMMAND_LIST_TYPE_BUNDLE);
+
+		// Every bundle has its own allocator, referenced by the command list private data, so it lives as long as the bundle
+		// and its memory is only reset when the bundle gets recorded again.
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> bundleAllocator = D3D12GEPUtils::CreateCommandAllocator(d3d12Device, bundleType);
+
+		m_BundleArray.push_back(std::make_unique<GEPUtils::Graphics::D3D12CommandList>(D3D12GEPUtils::CreateCommandList(d3d12Device, bundleAllocator, bundleType, false), GEPUtils::Graphics::GetDevice(), true));
+		GEPUtils::Graphics::D3D12CommandList& newBundle = static_cast<GEPUtils::Graphics::D3D12CommandList&>(*m_BundleArray.back());
+
+		D3D12GEPUtils::ThrowIfFailed(newBundle.GetInner()->SetPrivateDataInterface(__uuidof(bundleAllocator), bundleAllocator.Get()));
+
+		return newBundle;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> D3D12GraphicsAllocator::FindOrCreateRootSignature(const GEPUtils::Graphics::PipelineDescKey& InResourceBinderKey, const std::function<Microsoft::WRL::ComPtr<ID3D12RootSignature>()>& InCreateFn)
+	{
+		std::lock_guard<std::mutex> lock(m_RootSignatureCacheMutex);
+		auto foundRootSignatureIt = m_RootSignatureCache.find(InResourceBinderKey);
+		if (foundRootSignatureIt != m_RootSignatureCache.end())
+			return foundRootSignatureIt->second;
+
+		// If creation throws, nothing is inserted and the next request tries again
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> newRootSignature = InCreateFn();
+		m_RootSignatureCache.emplace(InResourceBinderKey, newRootSignature);
+		return newRootSignature;
+	}
+
 	void D3D12GraphicsAllocator::ReserveDynamicBufferMemory(size_t InSize, void*& OutCpuPtr, D3D12_GPU_VIRTUAL_ADDRESS& OutGpuPtr)
 	{
 		m_DynamicBufferAllocator->Allocate(InSize, OutCpuPtr, OutGpuPtr);
 	}
 
+	void D3D12GraphicsAllocator::ReserveDynamicBufferMemory(size_t InSize, void*& OutCpuPtr, ID3D12Resource*& OutResource, uint64_t& OutResourceOffset)
+	{
+		D3D12_GPU_VIRTUAL_ADDRESS gpuPtr;
+		m_DynamicBufferAllocator->Allocate(InSize, OutCpuPtr, gpuPtr);
+
+		// All the dynamic memory comes from a single resource
+		D3D12GEPUtils::D3D12Resource& dynamicBufferResource = m_DynamicBufferAllocator->GetResource();
+		OutResource = dynamicBufferResource.GetInner().Get();
+		OutResourceOffset = gpuPtr - dynamicBufferResource.GetGpuAddress();
+	}
+
 	GEPUtils::Graphics::D3D12DescriptorHeap& D3D12GraphicsAllocator::GetCpuHeap()
 	{
 		return m_DescHeapFactory->GetCPUHeap();
@@ -224,6 +405,13 @@ namespace GEPUtils { namespace Graphics {
 		m_DynamicBufferAllocator->SetAdmittedAllocationRegion(currentFramePartition, currentFramePartition + fractionSize);
 
 		GetGpuHeap().SetAllowedDynamicAllocationRegion(currentFramePartition, currentFramePartition + fractionSize);
+
+		// Frames that could use the released objects are completed by now, since there cannot be more than GetMaxConcurrentFramesNum() frames in flight.
+		// Note: placed resources are destroyed before the heaps they use.
+		while (!m_ReleasedResources.empty() && m_ReleasedResources.front().first + Application::GetMaxConcurrentFramesNum() <= currentFrameNum)
+			m_ReleasedResources.pop_front();
+		while (!m_ReleasedResourceHeaps.empty() && m_ReleasedResourceHeaps.front().first + Application::GetMaxConcurrentFramesNum() <= currentFrameNum)
+			m_ReleasedResourceHeaps.pop_front();
 	}
 
 	void D3D12GraphicsAllocator::Initialize()
@@ -10,9 +10,14 @@
 #define D3D12GraphicsAllocator_h__
 
 #include <deque>
+#include <functional>
 #include <memory> // for std::unique_ptr
+#include <mutex>
+#include <unordered_map>
+#include <wrl.h>
 #include "d3d12.h"
 #include "GraphicsAllocator.h"
+#include "ShaderBytecodeStore.h"
 
 namespace GEPUtils { namespace Graphics {
 
@@ -49,10 +54,24 @@ public:
 
 	virtual GEPUtils::Graphics::Texture& AllocateTextureFromFile(wchar_t const* InTexturePath, GEPUtils::Graphics::TEXTURE_FILE_FORMAT InFileFormat, int32_t InMipsNum = 0, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) override;
 
-	virtual GEPUtils::Graphics::Texture& AllocateEmptyTexture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels) override;
+	virtual GEPUtils::Graphics::Texture& AllocateEmptyTexture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) override;
 
 	virtual void AllocateBufferCommittedResource(GEPUtils::Graphics::CommandList& InCmdList, GEPUtils::Graphics::Resource& InDestResource, GEPUtils::Graphics::Resource& InIntermediateResource, size_t InNunElements, size_t InElementSize, const void* InBufferData, GEPUtils::Graphics::RESOURCE_FLAGS InFlags = GEPUtils::Graphics::RESOURCE_FLAGS::NONE) override;
 
+	virtual GEPUtils::Graphics::ResourceHeap& AllocateResourceHeap(uint64_t InSize, GEPUtils::Graphics::RESOURCE_HEAP_USAGE InUsage) override;
+
+	virtual void ReleaseResource(GEPUtils::Graphics::Resource& InResource) override;
+
+	virtual void ReleaseResourceHeap(GEPUtils::Graphics::ResourceHeap& InHeap) override;
+
+	virtual GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO GetTextureAllocationInfo(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) override;
+
+	virtual GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO GetBufferAllocationInfo(size_t InSize, GEPUtils::Graphics::RESOURCE_FLAGS InFlags = RESOURCE_FLAGS::NONE) override;
+
+	virtual GEPUtils::Graphics::Texture& AllocatePlacedTexture(GEPUtils::Graphics::ResourceHeap& InHeap, uint64_t InHeapOffset, uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_STATE InState, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) override;
+
+	virtual GEPUtils::Graphics::Buffer& AllocatePlacedBuffer(GEPUtils::Graphics::ResourceHeap& InHeap, uint64_t InHeapOffset, size_t InSize, GEPUtils::Graphics::RESOURCE_STATE InState, GEPUtils::Graphics::RESOURCE_FLAGS InFlags = RESOURCE_FLAGS::NONE) override;
+
 	virtual GEPUtils::Graphics::VertexBufferView& AllocateVertexBufferView() override;
 
 	virtual GEPUtils::Graphics::IndexBufferView& AllocateIndexBufferView() override;
@@ -69,9 +88,27 @@ public:
 
 	virtual GEPUtils::Graphics::Shader& AllocateShader(wchar_t const* InShaderPath) override;
 
+	virtual bool MountShaderArchive(wchar_t const* InArchivePath, wchar_t const* InMountPath) override;
+
 	virtual GEPUtils::Graphics::PipelineState& AllocatePipelineState() override;
 
-	void ReserveDynamicBufferMemory(size_t InSize, void*& OutCpuPtr, D3D12_GPU_VIRTUAL_ADDRESS& OutGpuPtr);
+	// Note: the override above would otherwise hide the cached versions taking a description
+	using GraphicsAllocatorBase::AllocatePipelineState;
+
+	virtual GEPUtils::Graphics::CommandSignature& AllocateCommandSignature(GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE InArgumentType) override;
+
+	virtual GEPUtils::Graphics::CommandList& AllocateBundle() override;
+
+	// Root signatures are shared between pipeline states with the same resource binder description, InCreateFn is called only if not created yet.
+	// Can be called from any thread, since pipeline states can be compiled on worker threads.
+	// Note: the cache stays locked while InCreateFn runs, so that two workers never create the same root signature.
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> FindOrCreateRootSignature(const GEPUtils::Graphics::PipelineDescKey& InResourceBinderKey, const std::function<Microsoft::WRL::ComPtr<ID3D12RootSignature>()>& InCreateFn);
+
+	// Note: D3D12_GPU_VIRTUAL_ADDRESS is a uint64_t
+	virtual void ReserveDynamicBufferMemory(size_t InSize, void*& OutCpuPtr, D3D12_GPU_VIRTUAL_ADDRESS& OutGpuPtr) override;
+
+	// Same as above, also returning the resource containing the reserved memory and the offset in it, for APIs not taking GPU addresses (e.g. ExecuteIndirect)
+	void ReserveDynamicBufferMemory(size_t InSize, void*& OutCpuPtr, ID3D12Resource*& OutResource, uint64_t& OutResourceOffset);
 
 	D3D12DescriptorHeap& GetCpuHeap();
 
@@ -83,10 +120,22 @@ public:
 
 private:
 	std::deque<std::unique_ptr<GEPUtils::Graphics::Resource>> m_ResourceArray;
+	std::deque<std::unique_ptr<GEPUtils::Graphics::ResourceHeap>> m_ResourceHeapArray;
+	// Released objects, paired with the frame number they were released in and destroyed when no frame in flight can use them anymore.
+	// Note: declared after the heaps so that they are destroyed first, and resources after heaps since placed resources need to go before their heap.
+	std::deque<std::pair<uint64_t, std::unique_ptr<GEPUtils::Graphics::ResourceHeap>>> m_ReleasedResourceHeaps;
+	std::deque<std::pair<uint64_t, std::unique_ptr<GEPUtils::Graphics::Resource>>> m_ReleasedResources;
 	std::deque<std::unique_ptr<GEPUtils::Graphics::VertexBufferView>> m_VertexViewArray;
 	std::deque<std::unique_ptr<GEPUtils::Graphics::IndexBufferView>> m_IndexViewArray;
+	// Note: declared before the shaders, since they reference it
+	GEPUtils::Graphics::ShaderBytecodeStore m_ShaderBytecodeStore;
 	std::deque<std::unique_ptr<GEPUtils::Graphics::Shader>> m_ShaderArray;
+	std::unordered_map<uint32_t, GEPUtils::Graphics::Shader*> m_ShaderByBytecodeId;
 	std::deque<std::unique_ptr<GEPUtils::Graphics::PipelineState>> m_PipelineStateArray;
+	std::deque<std::unique_ptr<GEPUtils::Graphics::CommandSignature>> m_CommandSignatureArray;
+	std::deque<std::unique_ptr<GEPUtils::Graphics::CommandList>> m_BundleArray;
+	std::unordered_map<GEPUtils::Graphics::PipelineDescKey, Microsoft::WRL::ComPtr<ID3D12RootSignature>, GEPUtils::Graphics::PipelineDescKeyHasher> m_RootSignatureCache;
+	std::mutex m_RootSignatureCacheMutex;
 	std::deque<std::unique_ptr<GEPUtils::Graphics::Window>> m_WindowArray;
 	std::deque<std::unique_ptr<GEPUtils::Graphics::CommandQueue>> m_CommandQueueArray;
 
@@ -9,6 +9,10 @@
 #include "D3D12PipelineState.h"
 #include "D3D12UtilsInternal.h"
 #include "D3D12Device.h"
+#include "D3D12GraphicsAllocator.h"
+#include "PipelineStateCache.h"
+#include "PipelineDiskCache.h"
+#include "ResourceBinderLayout.h"
 #include "GEPUtils.h"
 
 #define FAILED(hr)      (((HRESULT)(hr)) < 0)
@@ -44,8 +48,11 @@ namespace GEPUtils{ namespace Graphics {
 
 	D3D12_INPUT_ELEMENT_DESC D3D12PipelineState::TransformInputLayoutElement(INPUT_LAYOUT_DESC::LayoutElement& InLayoutElementDesc)
 	{
-		return { InLayoutElementDesc.m_Name.c_str(), 0, D3D12GEPUtils::BufferFormatToD3D12(InLayoutElementDesc.m_Format), 
-			0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION::D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+		const bool isPerInstance = InLayoutElementDesc.m_InstanceStepRate > 0;
+		// Note: D3D12_APPEND_ALIGNED_ELEMENT computes offsets separately for each input slot
+		return { InLayoutElementDesc.m_Name.c_str(), InLayoutElementDesc.m_SemanticIndex, D3D12GEPUtils::BufferFormatToD3D12(InLayoutElementDesc.m_Format), 
+			InLayoutElementDesc.m_InputSlot, D3D12_APPEND_ALIGNED_ELEMENT, 
+			isPerInstance ? D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA : D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, InLayoutElementDesc.m_InstanceStepRate };
 	}
 
 	CD3DX12_STATIC_SAMPLER_DESC D3D12PipelineState::TransformStaticSamplerElement(Graphics::StaticSampler& InLayoutElementDesc)
@@ -70,7 +77,7 @@ namespace GEPUtils{ namespace Graphics {
 			// Note: we are assuming only 1 descriptor range per descriptor table
 			D3D12_DESCRIPTOR_RANGE1 descRange;
 			descRange.BaseShaderRegister = InResourceBinderParam.ShaderRegister;
-			descRange.Flags = D3D12_DESCRIPTOR_RANGE_FLAG_NONE;
+			descRange.Flags = TransformDescriptorRangeFlags(InResourceBinderParam);
 			descRange.NumDescriptors = InResourceBinderParam.NumDescriptors;
 			descRange.OffsetInDescriptorsFromTableStart = 0;
 			descRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
@@ -86,7 +93,7 @@ namespace GEPUtils{ namespace Graphics {
 			// Note: we are assuming only 1 descriptor range per descriptor table
 			D3D12_DESCRIPTOR_RANGE1 descRange;
 			descRange.BaseShaderRegister = InResourceBinderParam.ShaderRegister;
-			descRange.Flags = D3D12_DESCRIPTOR_RANGE_FLAG_NONE; // TODO need to be able to pass flags with root params
+			descRange.Flags = TransformDescriptorRangeFlags(InResourceBinderParam);
 			descRange.NumDescriptors = InResourceBinderParam.NumDescriptors;
 			descRange.OffsetInDescriptorsFromTableStart = 0;
 			descRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
@@ -102,7 +109,7 @@ namespace GEPUtils{ namespace Graphics {
 			// Note: we are assuming only 1 descriptor range per descriptor table
 			D3D12_DESCRIPTOR_RANGE1 descRange;
 			descRange.BaseShaderRegister = InResourceBinderParam.ShaderRegister;
-			descRange.Flags = D3D12_DESCRIPTOR_RANGE_FLAG_NONE; // TODO need to be able to pass flags with root params
+			descRange.Flags = TransformDescriptorRangeFlags(InResourceBinderParam);
 			descRange.NumDescriptors = InResourceBinderParam.NumDescriptors;
 			descRange.OffsetInDescriptorsFromTableStart = 0;
 			descRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
@@ -113,6 +120,24 @@ namespace GEPUtils{ namespace Graphics {
 			returnParam.InitAsDescriptorTable(1, &OutDescRanges.back(), TransformShaderVisibility(InResourceBinderParam.shaderVisibility));
 			break;
 		}
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::ROOT_CBV:
+		{
+			returnParam.InitAsConstantBufferView(InResourceBinderParam.ShaderRegister, InResourceBinderParam.RegisterSpace,
+				TransformRootDescriptorFlags(InResourceBinderParam), TransformShaderVisibility(InResourceBinderParam.shaderVisibility));
+			break;
+		}
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::ROOT_SRV:
+		{
+			returnParam.InitAsShaderResourceView(InResourceBinderParam.ShaderRegister, InResourceBinderParam.RegisterSpace,
+				TransformRootDescriptorFlags(InResourceBinderParam), TransformShaderVisibility(InResourceBinderParam.shaderVisibility));
+			break;
+		}
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::ROOT_UAV:
+		{
+			returnParam.InitAsUnorderedAccessView(InResourceBinderParam.ShaderRegister, InResourceBinderParam.RegisterSpace,
+				TransformRootDescriptorFlags(InResourceBinderParam), TransformShaderVisibility(InResourceBinderParam.shaderVisibility));
+			break;
+		}
 		default:
 			StopForFail("Root Param transformation not implemented yet!")
 			break;
@@ -135,6 +160,40 @@ namespace GEPUtils{ namespace Graphics {
 		return D3D12_SHADER_VISIBILITY_ALL;
 	}
 
+	D3D12_DESCRIPTOR_RANGE_FLAGS D3D12PipelineState::TransformDescriptorRangeFlags(const RESOURCE_BINDER_PARAM& InResourceBinderParam)
+	{
+		D3D12_DESCRIPTOR_RANGE_FLAGS outFlags = D3D12_DESCRIPTOR_RANGE_FLAG_NONE;
+
+		switch (InResourceBinderParam.DataVolatility)
+		{
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::DEFAULT: break;
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::STATIC: outFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC; break;
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::STATIC_WHILE_SET_AT_EXECUTE: outFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE; break;
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::VOLATILE: outFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE; break;
+		}
+
+		if (InResourceBinderParam.DescriptorVolatility == RESOURCE_BINDER_PARAM::DESCRIPTOR_VOLATILITY::VOLATILE)
+		{
+			Check(InResourceBinderParam.DataVolatility != RESOURCE_BINDER_PARAM::DATA_VOLATILITY::STATIC); // Not allowed by D3D12
+			outFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE;
+		}
+
+		return outFlags;
+	}
+
+	D3D12_ROOT_DESCRIPTOR_FLAGS D3D12PipelineState::TransformRootDescriptorFlags(const RESOURCE_BINDER_PARAM& InResourceBinderParam)
+	{
+		switch (InResourceBinderParam.DataVolatility)
+		{
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::DEFAULT: return D3D12_ROOT_DESCRIPTOR_FLAG_NONE;
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::STATIC: return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC;
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::STATIC_WHILE_SET_AT_EXECUTE: return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+		case RESOURCE_BINDER_PARAM::DATA_VOLATILITY::VOLATILE: return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE;
+		}
+		StopForFail("Data volatility undefined.");
+		return D3D12_ROOT_DESCRIPTOR_FLAG_NONE;
+	}
+
 	// Init for a Graphics PSO
 	void D3D12PipelineState::Init(GRAPHICS_PSO_DESC& InPipelineStateDesc)
 	{
@@ -165,21 +224,25 @@ namespace GEPUtils{ namespace Graphics {
 			CD3DX12_PIPELINE_STATE_STREAM_PS PixelShader;
 			CD3DX12_PIPELINE_STATE_STREAM_DEPTH_STENCIL_FORMAT DSVFormat;
 			CD3DX12_PIPELINE_STATE_STREAM_RENDER_TARGET_FORMATS RTVFormats;
+			CD3DX12_PIPELINE_STATE_STREAM_CACHED_PSO CachedPSO;
 		} pipelineStateStream;
 
 		pipelineStateStream.pRootSignature = m_RootSignature.Get();
 	
 		pipelineStateStream.PrimitiveTopology = D3D12GEPUtils::PrimitiveTopologyTypeToD3D12(InPipelineStateDesc.TopologyType);
 		pipelineStateStream.InputLayout = { &layoutElements[0], static_cast<UINT>(layoutElements.size()) };
-		pipelineStateStream.VertexShader = CD3DX12_SHADER_BYTECODE(static_cast<D3D12GEPUtils::D3D12Shader&>(InPipelineStateDesc.VertexShader).m_ShaderBlob.Get());
-		pipelineStateStream.PixelShader = CD3DX12_SHADER_BYTECODE(static_cast<D3D12GEPUtils::D3D12Shader&>(InPipelineStateDesc.PixelShader).m_ShaderBlob.Get());
+		// Note: shaders bytecode needs to stay in memory only until the pipeline state gets created
+		ScopedShaderBytecode vertexShaderBytecode(InPipelineStateDesc.VertexShader);
+		ScopedShaderBytecode pixelShaderBytecode(InPipelineStateDesc.PixelShader);
+		pipelineStateStream.VertexShader = CD3DX12_SHADER_BYTECODE(vertexShaderBytecode.GetData(), vertexShaderBytecode.GetSize());
+		pipelineStateStream.PixelShader = CD3DX12_SHADER_BYTECODE(pixelShaderBytecode.GetData(), pixelShaderBytecode.GetSize());
 		pipelineStateStream.DSVFormat = D3D12GEPUtils::BufferFormatToD3D12(InPipelineStateDesc.DSFormat);
 		pipelineStateStream.RTVFormats = rtvFormats;
 
 		D3D12_PIPELINE_STATE_STREAM_DESC pipelineStateStreamDesc = {
 			sizeof(pipelineStateStream), &pipelineStateStream
 		};
-		D3D12GEPUtils::ThrowIfFailed(d3d12GraphicsDevice->CreatePipelineState(&pipelineStateStreamDesc, IID_PPV_ARGS(&m_PipelineState)));
+		CreatePipelineStateWithDiskCache(d3d12GraphicsDevice, pipelineStateStreamDesc, pipelineStateStream.CachedPSO, MakePipelineStateDescKey(InPipelineStateDesc));
 
 		m_IsInitialized = true;
 	}
@@ -197,32 +260,34 @@ namespace GEPUtils{ namespace Graphics {
 		struct PipelineStateStreamType {
 			CD3DX12_PIPELINE_STATE_STREAM_ROOT_SIGNATURE RootSignature;
 			CD3DX12_PIPELINE_STATE_STREAM_CS ComputeShader;
+			CD3DX12_PIPELINE_STATE_STREAM_CACHED_PSO CachedPSO;
 		} pipelineStateStream;
 
 		pipelineStateStream.RootSignature = m_RootSignature.Get();
-		pipelineStateStream.ComputeShader = CD3DX12_SHADER_BYTECODE(static_cast<D3D12GEPUtils::D3D12Shader&>(InPipelineStateDesc.ComputeShader).m_ShaderBlob.Get());
+		ScopedShaderBytecode computeShaderBytecode(InPipelineStateDesc.ComputeShader);
+		pipelineStateStream.ComputeShader = CD3DX12_SHADER_BYTECODE(computeShaderBytecode.GetData(), computeShaderBytecode.GetSize());
 
 		D3D12_PIPELINE_STATE_STREAM_DESC pipelineStateStreamDesc = {
 			sizeof(pipelineStateStream), &pipelineStateStream
 		};
-		D3D12GEPUtils::ThrowIfFailed(d3d12GraphicsDevice->CreatePipelineState(&pipelineStateStreamDesc, IID_PPV_ARGS(&m_PipelineState)));
+		CreatePipelineStateWithDiskCache(d3d12GraphicsDevice, pipelineStateStreamDesc, pipelineStateStream.CachedPSO, MakePipelineStateDescKey(InPipelineStateDesc));
 
 		m_IsInitialized = true;
 	}
 
 	void D3D12PipelineState::GenerateRootSignature(Microsoft::WRL::ComPtr<ID3D12Device2> d3d12GraphicsDevice, RESOURCE_BINDER_DESC& InResourceBinder)
 	{
-		// Create Root Signature
-		D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
-		featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
-		if (FAILED(d3d12GraphicsDevice->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(D3D12_FEATURE_DATA_ROOT_SIGNATURE))))
-		{
-			featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
-		}
 		// Allow Input layout access to shader resources
 		// and deny it to other stages (small optimization)
 		D3D12_ROOT_SIGNATURE_FLAGS rootSignatureFlags = TransformResourceBinderFlags(InResourceBinder.Flags);
 
+		if (GEPUtils::Graphics::GetResourceBinderCost(InResourceBinder) > GEPUtils::Graphics::g_ResourceBinderMaxDwordsNum)
+		{
+			// The device would reject the root signature, and nothing could be bound with the resulting layout anyway
+			StopForFail("[D3D12PipelineState] Root signature is over the 64 DWORDs budget, OptimizeResourceBinderLayout can convert constants to constant buffer views.");
+			throw std::exception();
+		}
+
 		// --- Root Parameters ---
 		// Using a single 32-bit constant root parameter (MVP matrix) that is used by the vertex shader
 		std::vector<RESOURCE_BINDER_PARAM>& agnosticRootParameters = InResourceBinder.Params;
@@ -244,8 +309,67 @@ namespace GEPUtils{ namespace Graphics {
 
 		// Init Root Signature Desc
 		m_RootSignatureInfo.rootSignatureDesc.Init_1_1(rootParameters.size(), rootParameters.data(), staticSamplers.size(), staticSamplers.data(), rootSignatureFlags);
-		// Create Root Signature serialized blob and then the object from it
-		m_RootSignature = D3D12GEPUtils::SerializeAndCreateRootSignature(d3d12GraphicsDevice, &m_RootSignatureInfo.rootSignatureDesc, featureData.HighestVersion);
+
+		// Note: the root signature desc above is still needed by each pipeline state to know its root parameters,
+		// but the serialization and the creation of the root signature object happen only once for each resource binder desc.
+		GEPUtils::Graphics::D3D12GraphicsAllocator& d3d12GraphicsAllocator = static_cast<GEPUtils::Graphics::D3D12GraphicsAllocator&>(*GEPUtils::Graphics::GraphicsAllocator::Get());
+		const GEPUtils::Graphics::PipelineDescKey resourceBinderKey = GEPUtils::Graphics::MakeResourceBinderDescKey(InResourceBinder);
+
+		m_RootSignature = d3d12GraphicsAllocator.FindOrCreateRootSignature(resourceBinderKey, [this, &d3d12GraphicsAllocator, &d3d12GraphicsDevice, &resourceBinderKey]()
+		{
+			Microsoft::WRL::ComPtr<ID3D12RootSignature> newRootSignature;
+
+			// A serialized root signature from a previous run skips the serialization
+			GEPUtils::Graphics::PipelineDiskCache& pipelineDiskCache = d3d12GraphicsAllocator.GetPipelineDiskCache();
+			const void* cachedBlob = nullptr;
+			size_t cachedBlobSize = 0;
+			if (pipelineDiskCache.Find(PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, resourceBinderKey, cachedBlob, cachedBlobSize))
+			{
+				if (SUCCEEDED(d3d12GraphicsDevice->CreateRootSignature(0, cachedBlob, cachedBlobSize, IID_PPV_ARGS(&newRootSignature))))
+					return newRootSignature;
+				pipelineDiskCache.Invalidate(PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, resourceBinderKey);
+			}
+
+			// Create Root Signature
+			D3D12_FEATURE_DATA_ROOT_SIGNATURE featureData = {};
+			featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+			if (FAILED(d3d12GraphicsDevice->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &featureData, sizeof(D3D12_FEATURE_DATA_ROOT_SIGNATURE))))
+			{
+				featureData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+			}
+
+			// Create Root Signature serialized blob and then the object from it
+			Microsoft::WRL::ComPtr<ID3DBlob> rootSignatureBlob = D3D12GEPUtils::SerializeRootSignature(&m_RootSignatureInfo.rootSignatureDesc, featureData.HighestVersion);
+			D3D12GEPUtils::ThrowIfFailed(d3d12GraphicsDevice->CreateRootSignature(0, rootSignatureBlob->GetBufferPointer(), rootSignatureBlob->GetBufferSize(), IID_PPV_ARGS(&newRootSignature)));
+
+			pipelineDiskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, resourceBinderKey, rootSignatureBlob->GetBufferPointer(), rootSignatureBlob->GetBufferSize());
+			return newRootSignature;
+		});
+	}
+
+	void D3D12PipelineState::CreatePipelineStateWithDiskCache(Microsoft::WRL::ComPtr<ID3D12Device2> d3d12GraphicsDevice, const D3D12_PIPELINE_STATE_STREAM_DESC& InStreamDesc, D3D12_CACHED_PIPELINE_STATE& InOutCachedPSO, const GEPUtils::Graphics::PipelineDescKey& InDescKey)
+	{
+		GEPUtils::Graphics::PipelineDiskCache& pipelineDiskCache = GraphicsAllocator::Get()->GetPipelineDiskCache();
+
+		const void* cachedBlob = nullptr;
+		size_t cachedBlobSize = 0;
+		if (pipelineDiskCache.Find(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, InDescKey, cachedBlob, cachedBlobSize))
+		{
+			InOutCachedPSO.pCachedBlob = cachedBlob;
+			InOutCachedPSO.CachedBlobSizeInBytes = cachedBlobSize;
+			if (SUCCEEDED(d3d12GraphicsDevice->CreatePipelineState(&InStreamDesc, IID_PPV_ARGS(&m_PipelineState))))
+				return;
+
+			// The driver rejects blobs it did not compile (e.g. D3D12_ERROR_DRIVER_VERSION_MISMATCH), the PSO gets compiled from scratch
+			pipelineDiskCache.Invalidate(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, InDescKey);
+			InOutCachedPSO = {};
+		}
+
+		D3D12GEPUtils::ThrowIfFailed(d3d12GraphicsDevice->CreatePipelineState(&InStreamDesc, IID_PPV_ARGS(&m_PipelineState)));
+
+		Microsoft::WRL::ComPtr<ID3DBlob> compiledBlob;
+		if (SUCCEEDED(m_PipelineState->GetCachedBlob(&compiledBlob)))
+			pipelineDiskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, InDescKey, compiledBlob->GetBufferPointer(), compiledBlob->GetBufferSize());
 	}
 
 	uint32_t D3D12PipelineState::GenerateRootTableBitMask()
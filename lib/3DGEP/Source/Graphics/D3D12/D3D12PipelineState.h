@@ -10,6 +10,7 @@
 #define D3D12PipelineState_h__
 
 #include "PipelineState.h"
+#include "PipelineDescKey.h"
 #include <d3dx12.h>
 
 
@@ -39,6 +40,10 @@ private:
 
 	void GenerateRootSignature(Microsoft::WRL::ComPtr<ID3D12Device2> d3d12GraphicsDevice, RESOURCE_BINDER_DESC& InPipelineStateDesc);
 
+	// Creates the PSO from the stream, using the compiled blob from the pipeline disk cache if present.
+	// InOutCachedPSO is the cached PSO subobject of the stream.
+	void CreatePipelineStateWithDiskCache(Microsoft::WRL::ComPtr<ID3D12Device2> d3d12GraphicsDevice, const D3D12_PIPELINE_STATE_STREAM_DESC& InStreamDesc, D3D12_CACHED_PIPELINE_STATE& InOutCachedPSO, const GEPUtils::Graphics::PipelineDescKey& InDescKey);
+
 	bool m_IsInitialized = false;
 
 	static D3D12_ROOT_SIGNATURE_FLAGS TransformResourceBinderFlags(RESOURCE_BINDER_FLAGS InResourceBinderFlags); 
@@ -47,6 +52,10 @@ private:
 	static CD3DX12_ROOT_PARAMETER1 TransformResourceBinderParams(RESOURCE_BINDER_PARAM& InResourceBinderParam, std::vector<D3D12_DESCRIPTOR_RANGE1>& OutDescRanges);
 
 	static D3D12_SHADER_VISIBILITY TransformShaderVisibility(SHADER_VISIBILITY shaderVisibility);
+
+	static D3D12_DESCRIPTOR_RANGE_FLAGS TransformDescriptorRangeFlags(const RESOURCE_BINDER_PARAM& InResourceBinderParam);
+
+	static D3D12_ROOT_DESCRIPTOR_FLAGS TransformRootDescriptorFlags(const RESOURCE_BINDER_PARAM& InResourceBinderParam);
 	
 	// Root Signature
 	Microsoft::WRL::ComPtr<ID3D12RootSignature> m_RootSignature = nullptr;
@@ -64,11 +64,29 @@ D3D12_RESOURCE_STATES ResourceStateTypeToD3D12(GEPUtils::Graphics::RESOURCE_STAT
 	case GEPUtils::Graphics::RESOURCE_STATE::COPY_SOURCE: return D3D12_RESOURCE_STATE_COPY_SOURCE;
 	case GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST: return D3D12_RESOURCE_STATE_COPY_DEST;
 	case GEPUtils::Graphics::RESOURCE_STATE::GEN_READ: return D3D12_RESOURCE_STATE_GENERIC_READ;
+	case GEPUtils::Graphics::RESOURCE_STATE::VERTEX_AND_CONSTANT_BUFFER: return D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+	case GEPUtils::Graphics::RESOURCE_STATE::INDEX_BUFFER: return D3D12_RESOURCE_STATE_INDEX_BUFFER;
+	case GEPUtils::Graphics::RESOURCE_STATE::UNORDERED_ACCESS: return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+	case GEPUtils::Graphics::RESOURCE_STATE::DEPTH_WRITE: return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+	case GEPUtils::Graphics::RESOURCE_STATE::DEPTH_READ: return D3D12_RESOURCE_STATE_DEPTH_READ;
+	case GEPUtils::Graphics::RESOURCE_STATE::NON_PIXEL_SHADER_RESOURCE: return D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+	case GEPUtils::Graphics::RESOURCE_STATE::PIXEL_SHADER_RESOURCE: return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+	case GEPUtils::Graphics::RESOURCE_STATE::ALL_SHADER_RESOURCE: return D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+	case GEPUtils::Graphics::RESOURCE_STATE::INDIRECT_ARGUMENT: return D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
 	default: StopForFail("Resource State Type not handled");
 	}
 	return D3D12_RESOURCE_STATE_GENERIC_READ;
 }
 
+ID3D12Resource* GetD3D12Resource(GEPUtils::Graphics::Resource& InResource)
+{
+	// Note: textures hold their own D3D12 resource, all the other resources are D3D12Resource
+	if (D3D12Texture* d3d12Texture = dynamic_cast<D3D12Texture*>(&InResource))
+		return d3d12Texture->GetInner().Get();
+
+	return static_cast<D3D12Resource&>(InResource).GetInner().Get();
+}
+
 D3D12_RESOURCE_FLAGS ResFlagsToD3D12(GEPUtils::Graphics::RESOURCE_FLAGS InResFlags)
 {
 	D3D12_RESOURCE_FLAGS returnFlags = D3D12_RESOURCE_FLAG_NONE;
@@ -102,12 +120,28 @@ D3D12_HEAP_TYPE HeapTypeToD3D12(GEPUtils::Graphics::RESOURCE_HEAP_TYPE InHeapTyp
 	return D3D12_HEAP_TYPE_DEFAULT;
 }
 
+D3D12_HEAP_FLAGS HeapUsageToD3D12(GEPUtils::Graphics::RESOURCE_HEAP_USAGE InHeapUsage)
+{
+	// Note: using the most restrictive flags so that heaps are supported also by resource heap tier 1 hardware
+	switch (InHeapUsage)
+	{
+	case GEPUtils::Graphics::RESOURCE_HEAP_USAGE::BUFFERS: return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+	case GEPUtils::Graphics::RESOURCE_HEAP_USAGE::TEXTURES: return D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+	case GEPUtils::Graphics::RESOURCE_HEAP_USAGE::RENDER_TARGET_TEXTURES: return D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+	}
+	return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+}
+
 DXGI_FORMAT BufferFormatToD3D12(GEPUtils::Graphics::BUFFER_FORMAT InFormat)
 {
 	switch (InFormat)
 	{
 	case GEPUtils::Graphics::BUFFER_FORMAT::R16_UINT : return DXGI_FORMAT_R16_UINT;
+	case GEPUtils::Graphics::BUFFER_FORMAT::R32_UINT: return DXGI_FORMAT_R32_UINT;
+	case GEPUtils::Graphics::BUFFER_FORMAT::R32_FLOAT: return DXGI_FORMAT_R32_FLOAT;
+	case GEPUtils::Graphics::BUFFER_FORMAT::R32G32_FLOAT: return DXGI_FORMAT_R32G32_FLOAT;
 	case GEPUtils::Graphics::BUFFER_FORMAT::R32G32B32_FLOAT: return DXGI_FORMAT_R32G32B32_FLOAT;
+	case GEPUtils::Graphics::BUFFER_FORMAT::R32G32B32A32_FLOAT: return DXGI_FORMAT_R32G32B32A32_FLOAT;
 	case GEPUtils::Graphics::BUFFER_FORMAT::R8G8B8A8_UNORM: return DXGI_FORMAT_R8G8B8A8_UNORM;
 	case GEPUtils::Graphics::BUFFER_FORMAT::D32_FLOAT: return DXGI_FORMAT_D32_FLOAT;
 	case GEPUtils::Graphics::BUFFER_FORMAT::BC1_UNORM: return DXGI_FORMAT_BC1_UNORM;
@@ -121,7 +155,11 @@ GEPUtils::Graphics::BUFFER_FORMAT BufferFormatToEngine(DXGI_FORMAT InFormat)
 	switch (InFormat)
 	{
 	case DXGI_FORMAT_R16_UINT: return GEPUtils::Graphics::BUFFER_FORMAT::R16_UINT;
+	case DXGI_FORMAT_R32_UINT: return GEPUtils::Graphics::BUFFER_FORMAT::R32_UINT;
+	case DXGI_FORMAT_R32_FLOAT: return GEPUtils::Graphics::BUFFER_FORMAT::R32_FLOAT;
+	case DXGI_FORMAT_R32G32_FLOAT: return GEPUtils::Graphics::BUFFER_FORMAT::R32G32_FLOAT;
 	case DXGI_FORMAT_R32G32B32_FLOAT: return GEPUtils::Graphics::BUFFER_FORMAT::R32G32B32_FLOAT;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT: return GEPUtils::Graphics::BUFFER_FORMAT::R32G32B32A32_FLOAT;
 	case DXGI_FORMAT_R8G8B8A8_UNORM: return GEPUtils::Graphics::BUFFER_FORMAT::R8G8B8A8_UNORM;
 	case DXGI_FORMAT_D32_FLOAT: return GEPUtils::Graphics::BUFFER_FORMAT::D32_FLOAT;
 	case DXGI_FORMAT_BC1_UNORM: return GEPUtils::Graphics::BUFFER_FORMAT::BC1_UNORM;
@@ -23,10 +23,15 @@ namespace D3D12GEPUtils {
 
 	D3D12_RESOURCE_STATES ResourceStateTypeToD3D12(GEPUtils::Graphics::RESOURCE_STATE InResState);
 
+	// Returns the D3D12 resource behind an engine resource, whether it is a texture or a buffer
+	ID3D12Resource* GetD3D12Resource(GEPUtils::Graphics::Resource& InResource);
+
 	D3D12_RESOURCE_FLAGS ResFlagsToD3D12(GEPUtils::Graphics::RESOURCE_FLAGS InResFlags);
 
 	D3D12_HEAP_TYPE HeapTypeToD3D12(GEPUtils::Graphics::RESOURCE_HEAP_TYPE InHeapType);
 
+	D3D12_HEAP_FLAGS HeapUsageToD3D12(GEPUtils::Graphics::RESOURCE_HEAP_USAGE InHeapUsage);
+
 	DXGI_FORMAT BufferFormatToD3D12(GEPUtils::Graphics::BUFFER_FORMAT InFormat);
 
 	GEPUtils::Graphics::BUFFER_FORMAT BufferFormatToEngine(DXGI_FORMAT InFormat);
@@ -9,6 +9,7 @@
 #include "D3D12Window.h"
 #include "D3D12GEPUtils.h"
 #include "D3D12UtilsInternal.h"
+#include "ResourceStateTracker.h"
 
 namespace D3D12GEPUtils
 {
@@ -355,6 +356,9 @@ namespace D3D12GEPUtils
 
 			static_cast<D3D12GEPUtils::D3D12Resource*>(m_BackBuffers[bufferIdx].get())->SetInner(backBuffer);
 
+			// Swap chain buffers are always (re)created in present state
+			GEPUtils::Graphics::ResourceStateRegistry::Get().RegisterResource(*m_BackBuffers[bufferIdx], GEPUtils::Graphics::RESOURCE_STATE::PRESENT);
+
 			// Move the CPU descriptor handle to the next element on the heap
 			rtvDescHeapHandle.Offset(m_RTVDescIncrementSize);
 		}
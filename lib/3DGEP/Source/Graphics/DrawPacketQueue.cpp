@@ -0,0 +1,159 @@
+/*
+ DrawPacketQueue.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "DrawPacketQueue.h"
+#include <algorithm>
+#include <cstring>
+#include "CommandList.h"
+#include "GEPUtils.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	static_assert(g_DrawSortKeyPassBits + g_DrawSortKeyPipelineStateBits + g_DrawSortKeyMaterialBits + g_DrawSortKeyDepthBits == 64, "Draw sort key fields are expected to fill 64 bits");
+
+	uint32_t QuantizeDrawDepth(float InViewDepth, float InZMin, float InZMax, bool InBackToFront /*= false*/)
+	{
+		const uint32_t maxBucket = (1u << g_DrawSortKeyDepthBits) - 1;
+
+		const float normalizedDepth = std::max(0.f, std::min((InViewDepth - InZMin) / (InZMax - InZMin), 1.f));
+		const uint32_t depthBucket = static_cast<uint32_t>(normalizedDepth * maxBucket);
+
+		return InBackToFront ? maxBucket - depthBucket : depthBucket;
+	}
+
+	DrawPacketQueue::DrawPacketQueue(uint32_t InExpectedDrawsNum /*= 0*/, uint32_t InExpectedRootConstantsNum /*= 0*/)
+	{
+		m_Packets.reserve(InExpectedDrawsNum);
+		m_RootConstantsOffsets.reserve(InExpectedDrawsNum);
+		m_RootConstantsData.reserve(InExpectedRootConstantsNum);
+		m_SortEntries.reserve(InExpectedDrawsNum);
+		m_SortScratch.reserve(InExpectedDrawsNum);
+	}
+
+	void DrawPacketQueue::AddDraw(uint64_t InSortKey, const DRAW_PACKET& InPacket)
+	{
+		if (!InPacket.PipelineState || !InPacket.VertexBufView || !InPacket.IndexBufView)
+		{
+			StopForFail("[DrawPacketQueue] Draw packets need a pipeline state, a vertex buffer and an index buffer.");
+			return;
+		}
+
+		const uint32_t packetIdx = static_cast<uint32_t>(m_Packets.size());
+		m_SortEntries.push_back({ InSortKey, packetIdx });
+		m_Packets.push_back(InPacket);
+
+		// Root constants are copied, so that the caller does not need to keep them alive
+		const uint32_t rootConstantsOffset = static_cast<uint32_t>(m_RootConstantsData.size());
+		m_RootConstantsOffsets.push_back(rootConstantsOffset);
+		if (InPacket.Num32BitRootConstants > 0)
+		{
+			m_RootConstantsData.resize(rootConstantsOffset + InPacket.Num32BitRootConstants);
+			memcpy(&m_RootConstantsData[rootConstantsOffset], InPacket.RootConstants, InPacket.Num32BitRootConstants * sizeof(uint32_t));
+		}
+	}
+
+	void DrawPacketQueue::Sort()
+	{
+		m_LastSortPassesNum = 0;
+
+		const uint32_t entriesNum = GetDrawsNum();
+		if (entriesNum < 2)
+			return;
+
+		// Note: resizing to a size within the capacity does not allocate
+		m_SortScratch.resize(entriesNum);
+
+		// Histograms of all the key bytes are computed with a single read of the keys
+		memset(m_Histograms, 0, sizeof(m_Histograms));
+		for (const SortEntry& currentEntry : m_SortEntries)
+		{
+			for (uint32_t passIdx = 0; passIdx < RADIX_PASSES_NUM; passIdx++)
+				m_Histograms[passIdx][(currentEntry.m_Key >> (passIdx * RADIX_BITS)) & (RADIX_BUCKETS_NUM - 1)]++;
+		}
+
+		SortEntry* sourceEntries = m_SortEntries.data();
+		SortEntry* destEntries = m_SortScratch.data();
+
+		for (uint32_t passIdx = 0; passIdx < RADIX_PASSES_NUM; passIdx++)
+		{
+			const uint32_t shift = passIdx * RADIX_BITS;
+			uint32_t* histogram = m_Histograms[passIdx];
+
+			// All the keys have the same value in this byte (e.g. unused key fields), the pass would not change the order
+			if (histogram[(sourceEntries[0].m_Key >> shift) & (RADIX_BUCKETS_NUM - 1)] == entriesNum)
+				continue;
+
+			// Counts become the first destination index of each bucket
+			uint32_t bucketOffset = 0;
+			for (uint32_t bucketIdx = 0; bucketIdx < RADIX_BUCKETS_NUM; bucketIdx++)
+			{
+				const uint32_t bucketCount = histogram[bucketIdx];
+				histogram[bucketIdx] = bucketOffset;
+				bucketOffset += bucketCount;
+			}
+
+			for (uint32_t entryIdx = 0; entryIdx < entriesNum; entryIdx++)
+			{
+				const SortEntry& currentEntry = sourceEntries[entryIdx];
+				destEntries[histogram[(currentEntry.m_Key >> shift) & (RADIX_BUCKETS_NUM - 1)]++] = currentEntry;
+			}
+
+			std::swap(sourceEntries, destEntries);
+			m_LastSortPassesNum++;
+		}
+
+		// After an odd number of passes the sorted entries are in the scratch buffer. Swapping vectors only exchanges their memory.
+		if (sourceEntries != m_SortEntries.data())
+			m_SortEntries.swap(m_SortScratch);
+	}
+
+	void DrawPacketQueue::Submit(GEPUtils::Graphics::CommandList& InCmdList) const
+	{
+		// Pipeline state and input assembler data are already filtered by the command list, the material table is filtered here
+		GEPUtils::Graphics::PipelineState* currentPipelineState = nullptr;
+		GEPUtils::Graphics::ShaderResourceView* currentMaterialSRV = nullptr;
+		uint32_t currentMaterialRootIdx = 0;
+
+		for (const SortEntry& currentEntry : m_SortEntries)
+		{
+			const DRAW_PACKET& currentPacket = m_Packets[currentEntry.m_PacketIdx];
+
+			if (currentPacket.PipelineState != currentPipelineState)
+			{
+				InCmdList.SetPipelineStateAndResourceBinder(*currentPacket.PipelineState);
+				currentPipelineState = currentPacket.PipelineState;
+				// A different resource binder resets the root arguments
+				currentMaterialSRV = nullptr;
+			}
+
+			InCmdList.SetInputAssemblerData(currentPacket.PrimTopology, *currentPacket.VertexBufView, *currentPacket.IndexBufView);
+
+			if (currentPacket.MaterialSRV && (currentPacket.MaterialSRV != currentMaterialSRV || currentPacket.MaterialRootIdx != currentMaterialRootIdx))
+			{
+				InCmdList.ReferenceSRV(currentPacket.MaterialRootIdx, *currentPacket.MaterialSRV);
+				currentMaterialSRV = currentPacket.MaterialSRV;
+				currentMaterialRootIdx = currentPacket.MaterialRootIdx;
+			}
+
+			if (currentPacket.Num32BitRootConstants > 0)
+				InCmdList.SetGraphicsRootConstants(currentPacket.RootConstantsRootIdx, currentPacket.Num32BitRootConstants, &m_RootConstantsData[m_RootConstantsOffsets[currentEntry.m_PacketIdx]], 0);
+
+			InCmdList.DrawIndexedInstanced(currentPacket.IndexCountPerInstance, currentPacket.InstanceCount, currentPacket.StartIndexLocation, currentPacket.BaseVertexLocation, currentPacket.StartInstanceLocation);
+		}
+	}
+
+	void DrawPacketQueue::Reset()
+	{
+		m_Packets.clear();
+		m_RootConstantsOffsets.clear();
+		m_RootConstantsData.clear();
+		m_SortEntries.clear();
+		m_LastSortPassesNum = 0;
+	}
+
+} }
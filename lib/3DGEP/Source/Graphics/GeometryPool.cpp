@@ -0,0 +1,140 @@
+/*
+ GeometryPool.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GeometryPool.h"
+#include "CommandList.h"
+#include "GraphicsAllocator.h"
+#include "GEPUtils.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Copies are placed in the staging buffer at offsets multiple of this
+	static constexpr size_t g_StagingAlignment = 16;
+
+	GeometryPoolRanges::GeometryPoolRanges(uint32_t InVertexStride, uint32_t InIndexSize, uint32_t InMaxVerticesNum, uint32_t InMaxIndicesNum, size_t InStagingSize)
+		: m_VertexStride(InVertexStride), m_IndexSize(InIndexSize), m_MaxVerticesNum(InMaxVerticesNum), m_MaxIndicesNum(InMaxIndicesNum),
+		m_VertexRanges(0, InMaxVerticesNum), m_IndexRanges(0, InMaxIndicesNum), m_StagingSize(InStagingSize)
+	{ }
+
+	GEOMETRY_POOL_ADD_RESULT GeometryPoolRanges::AllocateMesh(uint32_t InVerticesNum, uint32_t InIndicesNum, GEOMETRY_POOL_MESH& OutMesh, size_t& OutVerticesStagingOffset, size_t& OutIndicesStagingOffset)
+	{
+		OutMesh = GEOMETRY_POOL_MESH();
+
+		if (InVerticesNum == 0 || InIndicesNum == 0)
+			return GEOMETRY_POOL_ADD_RESULT::EMPTY_MESH;
+
+		if (m_UsedVerticesNum + InVerticesNum > m_MaxVerticesNum || m_UsedIndicesNum + InIndicesNum > m_MaxIndicesNum)
+			return GEOMETRY_POOL_ADD_RESULT::POOL_FULL;
+
+		const size_t verticesSize = static_cast<size_t>(InVerticesNum) * m_VertexStride;
+		const size_t indicesSize = static_cast<size_t>(InIndicesNum) * m_IndexSize;
+		const size_t verticesStagingOffset = m_StagingOffset;
+		const size_t indicesStagingOffset = (verticesStagingOffset + verticesSize + g_StagingAlignment - 1) / g_StagingAlignment * g_StagingAlignment;
+
+		if (indicesStagingOffset + indicesSize > m_StagingSize)
+			return GEOMETRY_POOL_ADD_RESULT::STAGING_FULL;
+
+		GEOMETRY_POOL_MESH newMesh;
+		if (!m_VertexRanges.TryAllocateRange(InVerticesNum, newMesh.BaseVertexLocation))
+			return GEOMETRY_POOL_ADD_RESULT::FRAGMENTED;
+
+		if (!m_IndexRanges.TryAllocateRange(InIndicesNum, newMesh.StartIndexLocation))
+		{
+			m_VertexRanges.FreeAllocatedRange(newMesh.BaseVertexLocation, InVerticesNum);
+			return GEOMETRY_POOL_ADD_RESULT::FRAGMENTED;
+		}
+
+		newMesh.VerticesNum = InVerticesNum;
+		newMesh.IndicesNum = InIndicesNum;
+
+		m_StagingOffset = (indicesStagingOffset + indicesSize + g_StagingAlignment - 1) / g_StagingAlignment * g_StagingAlignment;
+
+		m_MeshesNum++;
+		m_UsedVerticesNum += InVerticesNum;
+		m_UsedIndicesNum += InIndicesNum;
+
+		OutMesh = newMesh;
+		OutVerticesStagingOffset = verticesStagingOffset;
+		OutIndicesStagingOffset = indicesStagingOffset;
+
+		return GEOMETRY_POOL_ADD_RESULT::SUCCESS;
+	}
+
+	void GeometryPoolRanges::FreeMesh(const GEOMETRY_POOL_MESH& InMesh)
+	{
+		if (!InMesh.IsValid())
+			return;
+
+		m_VertexRanges.FreeAllocatedRange(InMesh.BaseVertexLocation, InMesh.VerticesNum);
+		m_IndexRanges.FreeAllocatedRange(InMesh.StartIndexLocation, InMesh.IndicesNum);
+
+		m_MeshesNum--;
+		m_UsedVerticesNum -= InMesh.VerticesNum;
+		m_UsedIndicesNum -= InMesh.IndicesNum;
+	}
+
+	GeometryPool::GeometryPool(uint32_t InVertexStride, uint32_t InMaxVerticesNum, uint32_t InMaxIndicesNum, GEPUtils::Graphics::BUFFER_FORMAT InIndexFormat, size_t InStagingSize)
+		: m_Ranges(InVertexStride, InIndexFormat == GEPUtils::Graphics::BUFFER_FORMAT::R32_UINT ? 4 : 2, InMaxVerticesNum, InMaxIndicesNum, InStagingSize)
+	{
+		Check(InIndexFormat == GEPUtils::Graphics::BUFFER_FORMAT::R16_UINT || InIndexFormat == GEPUtils::Graphics::BUFFER_FORMAT::R32_UINT);
+
+		const size_t vertexBufferSize = static_cast<size_t>(InMaxVerticesNum) * m_Ranges.GetVertexStride();
+		const size_t indexBufferSize = static_cast<size_t>(InMaxIndicesNum) * m_Ranges.GetIndexSize();
+
+		GEPUtils::Graphics::GraphicsAllocatorBase* graphicsAllocator = GEPUtils::Graphics::GraphicsAllocator::Get();
+
+		m_VertexBuffer = &graphicsAllocator->AllocateBufferResource(vertexBufferSize, GEPUtils::Graphics::RESOURCE_HEAP_TYPE::DEFAULT, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
+		m_IndexBuffer = &graphicsAllocator->AllocateBufferResource(indexBufferSize, GEPUtils::Graphics::RESOURCE_HEAP_TYPE::DEFAULT, GEPUtils::Graphics::RESOURCE_STATE::COPY_DEST);
+		m_StagingBuffer = &graphicsAllocator->AllocateBufferResource(InStagingSize, GEPUtils::Graphics::RESOURCE_HEAP_TYPE::UPLOAD, GEPUtils::Graphics::RESOURCE_STATE::GEN_READ);
+
+		// Views cover the whole buffers, meshes are selected by the draw arguments
+		m_VertexBufferView = &graphicsAllocator->AllocateVertexBufferView();
+		m_VertexBufferView->ReferenceResource(*m_VertexBuffer, vertexBufferSize, m_Ranges.GetVertexStride());
+
+		m_IndexBufferView = &graphicsAllocator->AllocateIndexBufferView();
+		m_IndexBufferView->ReferenceResource(*m_IndexBuffer, indexBufferSize, InIndexFormat);
+	}
+
+	GEOMETRY_POOL_ADD_RESULT GeometryPool::AddMesh(GEPUtils::Graphics::CommandList& InCmdList, const void* InVertices, uint32_t InVerticesNum, const void* InIndices, uint32_t InIndicesNum, GEOMETRY_POOL_MESH& OutMesh)
+	{
+		size_t verticesStagingOffset = 0, indicesStagingOffset = 0;
+		const GEOMETRY_POOL_ADD_RESULT result = m_Ranges.AllocateMesh(InVerticesNum, InIndicesNum, OutMesh, verticesStagingOffset, indicesStagingOffset);
+		if (result != GEOMETRY_POOL_ADD_RESULT::SUCCESS)
+			return result;
+
+		const uint32_t vertexStride = m_Ranges.GetVertexStride();
+		const uint32_t indexSize = m_Ranges.GetIndexSize();
+
+		InCmdList.UploadBufferRegion(*m_VertexBuffer, static_cast<uint64_t>(OutMesh.BaseVertexLocation) * vertexStride, *m_StagingBuffer, verticesStagingOffset, InVertices, static_cast<size_t>(InVerticesNum) * vertexStride);
+		InCmdList.UploadBufferRegion(*m_IndexBuffer, static_cast<uint64_t>(OutMesh.StartIndexLocation) * indexSize, *m_StagingBuffer, indicesStagingOffset, InIndices, static_cast<size_t>(InIndicesNum) * indexSize);
+
+		return result;
+	}
+
+	void GeometryPool::RemoveMesh(const GEOMETRY_POOL_MESH& InMesh)
+	{
+		m_Ranges.FreeMesh(InMesh);
+	}
+
+	void GeometryPool::TransitionForDraw(GEPUtils::Graphics::CommandList& InCmdList)
+	{
+		InCmdList.TransitionResource(*m_VertexBuffer, GEPUtils::Graphics::RESOURCE_STATE::VERTEX_AND_CONSTANT_BUFFER);
+		InCmdList.TransitionResource(*m_IndexBuffer, GEPUtils::Graphics::RESOURCE_STATE::INDEX_BUFFER);
+	}
+
+	void GeometryPool::SetInputAssemblerData(GEPUtils::Graphics::CommandList& InCmdList, GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology)
+	{
+		InCmdList.SetInputAssemblerData(InPrimTopology, *m_VertexBufferView, *m_IndexBufferView);
+	}
+
+	void GeometryPool::DrawMesh(GEPUtils::Graphics::CommandList& InCmdList, const GEOMETRY_POOL_MESH& InMesh, uint32_t InInstanceCount /*= 1*/, uint32_t InStartInstanceLocation /*= 0*/)
+	{
+		InCmdList.DrawIndexedInstanced(InMesh.IndicesNum, InInstanceCount, InMesh.StartIndexLocation, static_cast<int32_t>(InMesh.BaseVertexLocation), InStartInstanceLocation);
+	}
+
+} }
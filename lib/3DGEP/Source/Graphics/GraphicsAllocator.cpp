@@ -8,6 +8,7 @@
  
 #include "GraphicsAllocator.h"
 #include "Window.h"
+#include <exception>
 #ifdef GRAPHICS_SDK_D3D12
 
 #include "D3D12GraphicsAllocator.h"
@@ -35,5 +36,95 @@ namespace GEPUtils { namespace Graphics {
 
 	GraphicsAllocatorBase::GraphicsAllocatorBase() = default;
 
+	// Pipeline state descriptions only reference their parts, asynchronous compilations need their own copy
+	struct GraphicsPipelineStateDescCopy {
+		explicit GraphicsPipelineStateDescCopy(const PipelineState::GRAPHICS_PSO_DESC& InDesc)
+			: m_InputLayoutDesc(InDesc.InputLayoutDesc), m_ResourceBinderDesc(InDesc.ResourceBinderDesc),
+			m_Desc{ m_InputLayoutDesc, m_ResourceBinderDesc, InDesc.TopologyType, InDesc.VertexShader, InDesc.PixelShader, InDesc.DSFormat, InDesc.RTFormat }
+		{ }
+
+		PipelineState::INPUT_LAYOUT_DESC m_InputLayoutDesc;
+		PipelineState::RESOURCE_BINDER_DESC m_ResourceBinderDesc;
+		PipelineState::GRAPHICS_PSO_DESC m_Desc;
+	};
+
+	struct ComputePipelineStateDescCopy {
+		explicit ComputePipelineStateDescCopy(const PipelineState::COMPUTE_PSO_DESC& InDesc)
+			: m_ResourceBinderDesc(InDesc.ResourceBinderDesc), m_Desc{ m_ResourceBinderDesc, InDesc.ComputeShader }
+		{ }
+
+		PipelineState::RESOURCE_BINDER_DESC m_ResourceBinderDesc;
+		PipelineState::COMPUTE_PSO_DESC m_Desc;
+	};
+
+	GEPUtils::Graphics::PipelineState& GraphicsAllocatorBase::AllocatePipelineState(GEPUtils::Graphics::PipelineState::GRAPHICS_PSO_DESC& InDesc)
+	{
+		return RequestPipelineState(MakePipelineStateDescKey(InDesc), false, [&InDesc](PipelineState& InPipelineState) { InPipelineState.Init(InDesc); }).Wait();
+	}
+
+	GEPUtils::Graphics::PipelineState& GraphicsAllocatorBase::AllocatePipelineState(GEPUtils::Graphics::PipelineState::COMPUTE_PSO_DESC& InDesc)
+	{
+		return RequestPipelineState(MakePipelineStateDescKey(InDesc), false, [&InDesc](PipelineState& InPipelineState) { InPipelineState.Init(InDesc); }).Wait();
+	}
+
+	GEPUtils::Graphics::AsyncPipelineState GraphicsAllocatorBase::AllocatePipelineStateAsync(GEPUtils::Graphics::PipelineState::GRAPHICS_PSO_DESC& InDesc)
+	{
+		const PipelineDescKey descKey = MakePipelineStateDescKey(InDesc);
+		if (GEPUtils::Graphics::PipelineState* foundPipelineState = m_PipelineStateCache.Find(descKey))
+			return AsyncPipelineState::MakeReady(*foundPipelineState);
+
+		std::shared_ptr<GraphicsPipelineStateDescCopy> descCopy = std::make_shared<GraphicsPipelineStateDescCopy>(InDesc);
+		return RequestPipelineState(descKey, true, [descCopy](PipelineState& InPipelineState) { InPipelineState.Init(descCopy->m_Desc); });
+	}
+
+	GEPUtils::Graphics::AsyncPipelineState GraphicsAllocatorBase::AllocatePipelineStateAsync(GEPUtils::Graphics::PipelineState::COMPUTE_PSO_DESC& InDesc)
+	{
+		const PipelineDescKey descKey = MakePipelineStateDescKey(InDesc);
+		if (GEPUtils::Graphics::PipelineState* foundPipelineState = m_PipelineStateCache.Find(descKey))
+			return AsyncPipelineState::MakeReady(*foundPipelineState);
+
+		std::shared_ptr<ComputePipelineStateDescCopy> descCopy = std::make_shared<ComputePipelineStateDescCopy>(InDesc);
+		return RequestPipelineState(descKey, true, [descCopy](PipelineState& InPipelineState) { InPipelineState.Init(descCopy->m_Desc); });
+	}
+
+	void GraphicsAllocatorBase::WaitForPipelineStateCompilations()
+	{
+		m_PipelineCompileThreadPool.WaitIdle();
+	}
+
+	GEPUtils::Graphics::AsyncPipelineState GraphicsAllocatorBase::RequestPipelineState(const GEPUtils::Graphics::PipelineDescKey& InDescKey, bool InIsAsync, std::function<void(GEPUtils::Graphics::PipelineState&)> InInitFn)
+	{
+		std::shared_ptr<std::promise<PipelineState*>> compilePromise = std::make_shared<std::promise<PipelineState*>>();
+
+		bool isNewRequest = false;
+		AsyncPipelineState outRequest = m_PipelineStateCache.FindOrAdd(InDescKey, AsyncPipelineState(compilePromise->get_future().share()), isNewRequest);
+		if (!isNewRequest)
+			return outRequest;
+
+		// Note: the allocation happens on the calling thread, allocator containers are not thread safe
+		PipelineState& newPipelineState = AllocatePipelineState();
+
+		std::function<void()> compileTask = [compilePromise, &newPipelineState, InInitFn]()
+		{
+			try
+			{
+				InInitFn(newPipelineState);
+				compilePromise->set_value(&newPipelineState);
+			}
+			catch (...)
+			{
+				// Forwarded to whoever waits for the pipeline state
+				compilePromise->set_exception(std::current_exception());
+			}
+		};
+
+		if (InIsAsync)
+			m_PipelineCompileThreadPool.Enqueue(std::move(compileTask));
+		else
+			compileTask();
+
+		return outRequest;
+	}
+
 }
 }
@@ -0,0 +1,94 @@
+/*
+ IndirectArguments.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "IndirectArguments.h"
+#include <algorithm>
+
+namespace GEPUtils { namespace Graphics {
+
+	static_assert(sizeof(DRAW_INDEXED_ARGUMENTS) == 5 * sizeof(uint32_t), "Draw indexed arguments are expected to be tightly packed");
+	static_assert(sizeof(DISPATCH_ARGUMENTS) == 3 * sizeof(uint32_t), "Dispatch arguments are expected to be tightly packed");
+
+	uint32_t GetIndirectArgumentStride(INDIRECT_ARGUMENT_TYPE InArgumentType)
+	{
+		switch (InArgumentType)
+		{
+		case INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED: return sizeof(DRAW_INDEXED_ARGUMENTS);
+		case INDIRECT_ARGUMENT_TYPE::DISPATCH: return sizeof(DISPATCH_ARGUMENTS);
+		}
+		return 0;
+	}
+
+	IndirectArgumentBuilder::IndirectArgumentBuilder(INDIRECT_ARGUMENT_TYPE InArgumentType, uint32_t InExpectedArgumentsNum /*= 0*/)
+		: m_ArgumentType(InArgumentType), m_Stride(GetIndirectArgumentStride(InArgumentType)), m_ValuesPerArgument(m_Stride / sizeof(uint32_t))
+	{
+		m_Data.reserve(static_cast<size_t>(InExpectedArgumentsNum) * m_ValuesPerArgument);
+	}
+
+	bool IndirectArgumentBuilder::AddDrawIndexed(const DRAW_INDEXED_ARGUMENTS& InArguments)
+	{
+		if (m_ArgumentType != INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED || InArguments.IndexCountPerInstance == 0 || InArguments.InstanceCount == 0)
+		{
+			m_RejectedArgumentsNum++;
+			return false;
+		}
+
+		AddArguments(reinterpret_cast<const uint32_t*>(&InArguments));
+		return true;
+	}
+
+	bool IndirectArgumentBuilder::AddDispatch(const DISPATCH_ARGUMENTS& InArguments)
+	{
+		if (m_ArgumentType != INDIRECT_ARGUMENT_TYPE::DISPATCH || InArguments.ThreadGroupCountX == 0 || InArguments.ThreadGroupCountY == 0 || InArguments.ThreadGroupCountZ == 0)
+		{
+			m_RejectedArgumentsNum++;
+			return false;
+		}
+
+		AddArguments(reinterpret_cast<const uint32_t*>(&InArguments));
+		return true;
+	}
+
+	void IndirectArgumentBuilder::AddArguments(const uint32_t* InValues)
+	{
+		m_Data.insert(m_Data.end(), InValues, InValues + m_ValuesPerArgument);
+		m_ArgumentsNum++;
+	}
+
+	uint32_t IndirectArgumentBuilder::Compact(const uint8_t* InIsVisible)
+	{
+		// Visible arguments are moved back over the culled ones, in place
+		uint32_t keptArgumentsNum = 0;
+		for (uint32_t argumentIdx = 0; argumentIdx < m_ArgumentsNum; argumentIdx++)
+		{
+			if (!InIsVisible[argumentIdx])
+				continue;
+
+			if (keptArgumentsNum != argumentIdx)
+			{
+				const uint32_t* srcValues = m_Data.data() + static_cast<size_t>(argumentIdx) * m_ValuesPerArgument;
+				std::copy(srcValues, srcValues + m_ValuesPerArgument, m_Data.data() + static_cast<size_t>(keptArgumentsNum) * m_ValuesPerArgument);
+			}
+			keptArgumentsNum++;
+		}
+
+		const uint32_t removedArgumentsNum = m_ArgumentsNum - keptArgumentsNum;
+		m_ArgumentsNum = keptArgumentsNum;
+		m_Data.resize(static_cast<size_t>(keptArgumentsNum) * m_ValuesPerArgument);
+
+		return removedArgumentsNum;
+	}
+
+	void IndirectArgumentBuilder::Reset()
+	{
+		m_Data.clear();
+		m_ArgumentsNum = 0;
+		m_RejectedArgumentsNum = 0;
+	}
+
+} }
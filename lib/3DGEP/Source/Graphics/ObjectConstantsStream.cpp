@@ -0,0 +1,92 @@
+/*
+ ObjectConstantsStream.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "ObjectConstantsStream.h"
+#include <cstring>
+#include "CommandList.h"
+#include "GraphicsAllocator.h"
+#include "GEPUtils.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	ObjectConstantsStream::ObjectConstantsStream(uint32_t InObjectStride)
+		: m_ObjectStride(InObjectStride)
+	{
+		Check(InObjectStride > 0 && InObjectStride % sizeof(uint32_t) == 0);
+	}
+
+	void ObjectConstantsStream::BeginFrame(uint32_t InMaxObjectsNum)
+	{
+		if (InMaxObjectsNum == 0)
+		{
+			BeginFrame(0, nullptr, 0);
+			return;
+		}
+
+		// Note: root SRVs only need 4 bytes alignment, dynamic buffer allocations already exceed it
+		void* mappedData;
+		uint64_t gpuAddress;
+		GraphicsAllocator::Get()->ReserveDynamicBufferMemory(static_cast<size_t>(InMaxObjectsNum) * m_ObjectStride, mappedData, gpuAddress);
+		BeginFrame(InMaxObjectsNum, mappedData, gpuAddress);
+	}
+
+	void ObjectConstantsStream::BeginFrame(uint32_t InMaxObjectsNum, void* InMappedData, uint64_t InGpuAddress)
+	{
+		m_ObjectsNum = 0;
+		m_MaxObjectsNum = InMappedData ? InMaxObjectsNum : 0;
+		m_MappedData = static_cast<uint8_t*>(InMappedData);
+		m_GpuAddress = InGpuAddress;
+	}
+
+	uint32_t ObjectConstantsStream::AddObject(const void* InConstants)
+	{
+		uint32_t objectIdx;
+		void* objectData = AllocateObject(objectIdx);
+		if (!objectData)
+			return INVALID_OBJECT_IDX;
+
+		memcpy(objectData, InConstants, m_ObjectStride);
+		return objectIdx;
+	}
+
+	void* ObjectConstantsStream::AllocateObject(uint32_t& OutObjectIdx)
+	{
+		return AllocateObjects(1, OutObjectIdx);
+	}
+
+	void* ObjectConstantsStream::AllocateObjects(uint32_t InObjectsNum, uint32_t& OutFirstObjectIdx)
+	{
+		if (InObjectsNum > m_MaxObjectsNum - m_ObjectsNum)
+		{
+			StopForFail("[ObjectConstantsStream] More objects than the ones reserved for the frame with BeginFrame(..)");
+			OutFirstObjectIdx = INVALID_OBJECT_IDX;
+			return nullptr;
+		}
+
+		OutFirstObjectIdx = m_ObjectsNum;
+		m_ObjectsNum += InObjectsNum;
+
+		return m_MappedData + static_cast<size_t>(OutFirstObjectIdx) * m_ObjectStride;
+	}
+
+	void ObjectConstantsStream::Bind(GEPUtils::Graphics::CommandList& InCmdList, uint32_t InRootIdx) const
+	{
+		Check(!InCmdList.IsBundle()); // Frame memory gets reused while the bundle could still be executed
+
+		if (!m_MappedData)
+			return;
+
+		InCmdList.SetGraphicsRootShaderResource(InRootIdx, m_GpuAddress);
+	}
+
+	void ObjectConstantsStream::SetObjectIndex(GEPUtils::Graphics::CommandList& InCmdList, uint32_t InRootIdx, uint32_t InObjectIdx)
+	{
+		InCmdList.SetGraphicsRootConstants(InRootIdx, 1, &InObjectIdx, 0);
+	}
+
+} }
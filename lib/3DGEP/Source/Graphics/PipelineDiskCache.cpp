@@ -0,0 +1,308 @@
+/*
+ PipelineDiskCache.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "PipelineDiskCache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "GEPUtils.h"
+#include "GEPUtilsHash.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	uint64_t ComputePipelineCacheKey(PIPELINE_CACHE_ENTRY_TYPE InType, uint64_t InDescHash)
+	{
+		return Hash::HashValue(InDescHash, Hash::HashValue(InType, Hash::g_FnvOffsetBasis));
+	}
+
+	bool PipelineDiskCache::Load(const std::string& InFilePath, uint64_t InDeviceIdentityHash)
+	{
+		ResetLoadedFile();
+		m_StoredEntries.clear();
+		m_DeviceIdentityHash = InDeviceIdentityHash;
+
+		if (!m_MappedFile.Open(InFilePath))
+			return false;
+
+		const uint8_t* fileData = m_MappedFile.GetData();
+		const size_t fileSize = m_MappedFile.GetSize();
+
+		if (fileSize < sizeof(PIPELINE_CACHE_FILE_HEADER))
+		{
+			DebugPrint("[PipelineDiskCache] Cache file is too small, discarding it.");
+			ResetLoadedFile();
+			return false;
+		}
+
+		PIPELINE_CACHE_FILE_HEADER fileHeader;
+		std::memcpy(&fileHeader, fileData, sizeof(PIPELINE_CACHE_FILE_HEADER));
+
+		if (fileHeader.Magic != g_PipelineCacheFileMagic || fileHeader.Version != g_PipelineCacheFileVersion)
+		{
+			DebugPrint("[PipelineDiskCache] Cache file has an unknown format, discarding it.");
+			ResetLoadedFile();
+			return false;
+		}
+
+		if (fileHeader.DeviceIdentityHash != InDeviceIdentityHash)
+		{
+			DebugPrint("[PipelineDiskCache] Cache file was written with another adapter or driver, discarding it.");
+			ResetLoadedFile();
+			return false;
+		}
+
+		const size_t tableSize = fileHeader.EntriesNum * sizeof(PIPELINE_CACHE_FILE_ENTRY);
+		if (fileSize - sizeof(PIPELINE_CACHE_FILE_HEADER) < tableSize)
+		{
+			DebugPrint("[PipelineDiskCache] Cache file is truncated, discarding it.");
+			ResetLoadedFile();
+			return false;
+		}
+
+		const uint8_t* tableData = fileData + sizeof(PIPELINE_CACHE_FILE_HEADER);
+		if (Hash::HashBytes(tableData, tableSize) != fileHeader.TableHash)
+		{
+			DebugPrint("[PipelineDiskCache] Cache file table is corrupted, discarding it.");
+			ResetLoadedFile();
+			return false;
+		}
+
+		// Note: the header size keeps the table aligned, and mapped files start at a page boundary
+		m_LoadedEntries = reinterpret_cast<const PIPELINE_CACHE_FILE_ENTRY*>(tableData);
+		m_LoadedEntriesNum = fileHeader.EntriesNum;
+
+		// Descriptions and blobs pointing outside the file are invalidated right away, blobs inside are checked against their hash only when requested
+		for (size_t entryIdx = 0; entryIdx < m_LoadedEntriesNum; entryIdx++)
+		{
+			const PIPELINE_CACHE_FILE_ENTRY& currentEntry = m_LoadedEntries[entryIdx];
+			if (currentEntry.BlobOffset > fileSize || currentEntry.BlobSize > fileSize - currentEntry.BlobOffset
+				|| currentEntry.DescOffset > fileSize || currentEntry.DescSize > fileSize - currentEntry.DescOffset
+				|| (entryIdx > 0 && m_LoadedEntries[entryIdx - 1].Key >= currentEntry.Key))
+			{
+				DebugPrint("[PipelineDiskCache] Cache file entries are not valid, discarding it.");
+				ResetLoadedFile();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool PipelineDiskCache::Find(PIPELINE_CACHE_ENTRY_TYPE InType, const GEPUtils::Graphics::PipelineDescKey& InDescKey, const void*& OutBlob, size_t& OutBlobSize)
+	{
+		const uint64_t entryKey = ComputePipelineCacheKey(InType, InDescKey.m_Hash);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Entries stored during this run take precedence over the loaded ones
+		auto storedEntryIt = m_StoredEntries.find(entryKey);
+		if (storedEntryIt != m_StoredEntries.end())
+		{
+			if (storedEntryIt->second.m_Type != InType || storedEntryIt->second.m_DescKey != InDescKey)
+			{
+				m_MissesNum++;
+				return false;
+			}
+			OutBlob = storedEntryIt->second.m_Blob.data();
+			OutBlobSize = storedEntryIt->second.m_Blob.size();
+			m_HitsNum++;
+			return true;
+		}
+
+		const PIPELINE_CACHE_FILE_ENTRY* loadedEntry = FindLoadedEntry(entryKey);
+		if (!loadedEntry || loadedEntry->Type != InType || loadedEntry->DescHash != InDescKey.m_Hash || m_InvalidatedKeys.count(entryKey)
+			|| loadedEntry->DescSize != InDescKey.m_Desc.size()
+			|| (!InDescKey.m_Desc.empty() && std::memcmp(m_MappedFile.GetData() + loadedEntry->DescOffset, InDescKey.m_Desc.data(), InDescKey.m_Desc.size()) != 0))
+		{
+			m_MissesNum++;
+			return false;
+		}
+
+		const uint8_t* blobData = m_MappedFile.GetData() + loadedEntry->BlobOffset;
+		const size_t blobSize = static_cast<size_t>(loadedEntry->BlobSize);
+
+		if (!m_ValidatedKeys.count(entryKey))
+		{
+			if (Hash::HashBytes(blobData, blobSize) != loadedEntry->BlobHash)
+			{
+				DebugPrint("[PipelineDiskCache] Cached blob is corrupted, invalidating it.");
+				InvalidateKey(entryKey);
+				m_MissesNum++;
+				return false;
+			}
+			m_ValidatedKeys.insert(entryKey);
+		}
+
+		OutBlob = blobData;
+		OutBlobSize = blobSize;
+		m_HitsNum++;
+		return true;
+	}
+
+	void PipelineDiskCache::Store(PIPELINE_CACHE_ENTRY_TYPE InType, const GEPUtils::Graphics::PipelineDescKey& InDescKey, const void* InBlob, size_t InBlobSize)
+	{
+		const uint64_t entryKey = ComputePipelineCacheKey(InType, InDescKey.m_Hash);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		StoredEntry& storedEntry = m_StoredEntries[entryKey];
+		storedEntry.m_DescKey = InDescKey;
+		storedEntry.m_Type = InType;
+		const uint8_t* blobBytes = static_cast<const uint8_t*>(InBlob);
+		storedEntry.m_Blob.assign(blobBytes, blobBytes + InBlobSize);
+	}
+
+	void PipelineDiskCache::Invalidate(PIPELINE_CACHE_ENTRY_TYPE InType, const GEPUtils::Graphics::PipelineDescKey& InDescKey)
+	{
+		// Note: an entry with a colliding description is invalidated as well, it would be replaced by the next Store(..) anyway
+		const uint64_t entryKey = ComputePipelineCacheKey(InType, InDescKey.m_Hash);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		InvalidateKey(entryKey);
+	}
+
+	void PipelineDiskCache::InvalidateKey(uint64_t InKey)
+	{
+		const bool wasStored = m_StoredEntries.erase(InKey) > 0;
+		const bool wasLoaded = FindLoadedEntry(InKey) != nullptr && m_InvalidatedKeys.insert(InKey).second;
+
+		if (wasStored || wasLoaded)
+			m_InvalidatedEntriesNum++;
+	}
+
+	bool PipelineDiskCache::Save(const std::string& InFilePath)
+	{
+		std::vector<uint8_t> fileData;
+		SerializeInternal(fileData);
+
+		// Note: loaded blobs are now copied in fileData, the file can be unmapped before being overwritten
+		ResetLoadedFile();
+
+		std::ofstream outFile(InFilePath, std::ios::binary | std::ios::trunc);
+		if (!outFile)
+		{
+			DebugPrint("[PipelineDiskCache] Cannot open the cache file for writing.");
+			return false;
+		}
+		outFile.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+		outFile.close();
+		if (!outFile)
+		{
+			DebugPrint("[PipelineDiskCache] Failed writing the cache file.");
+			return false;
+		}
+
+		// Mapping the written file again, so that all the saved entries are still available after saving
+		return Load(InFilePath, m_DeviceIdentityHash);
+	}
+
+	void PipelineDiskCache::Serialize(std::vector<uint8_t>& OutFileData) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		SerializeInternal(OutFileData);
+	}
+
+	void PipelineDiskCache::SerializeInternal(std::vector<uint8_t>& OutFileData) const
+	{
+		struct BlobSource {
+			PIPELINE_CACHE_FILE_ENTRY m_Entry;
+			const uint8_t* m_Desc;
+			const uint8_t* m_Data;
+		};
+		std::vector<BlobSource> blobSources;
+		blobSources.reserve(m_LoadedEntriesNum + m_StoredEntries.size());
+
+		for (const auto& currentStored : m_StoredEntries)
+		{
+			PIPELINE_CACHE_FILE_ENTRY newEntry = {};
+			newEntry.Key = currentStored.first;
+			newEntry.DescHash = currentStored.second.m_DescKey.m_Hash;
+			newEntry.Type = currentStored.second.m_Type;
+			newEntry.DescSize = currentStored.second.m_DescKey.m_Desc.size();
+			newEntry.BlobSize = currentStored.second.m_Blob.size();
+			newEntry.BlobHash = Hash::HashBytes(currentStored.second.m_Blob.data(), currentStored.second.m_Blob.size());
+			blobSources.push_back({ newEntry, currentStored.second.m_DescKey.m_Desc.data(), currentStored.second.m_Blob.data() });
+		}
+
+		for (size_t entryIdx = 0; entryIdx < m_LoadedEntriesNum; entryIdx++)
+		{
+			const PIPELINE_CACHE_FILE_ENTRY& currentLoaded = m_LoadedEntries[entryIdx];
+			if (m_InvalidatedKeys.count(currentLoaded.Key) || m_StoredEntries.count(currentLoaded.Key))
+				continue;
+			blobSources.push_back({ currentLoaded, m_MappedFile.GetData() + currentLoaded.DescOffset, m_MappedFile.GetData() + currentLoaded.BlobOffset });
+		}
+
+		// Sorted by key, so that the loader can binary search the table directly in the mapped file
+		std::sort(blobSources.begin(), blobSources.end(), [](const BlobSource& InFirst, const BlobSource& InSecond) { return InFirst.m_Entry.Key < InSecond.m_Entry.Key; });
+
+		const size_t tableSize = blobSources.size() * sizeof(PIPELINE_CACHE_FILE_ENTRY);
+		uint64_t currentBlobOffset = sizeof(PIPELINE_CACHE_FILE_HEADER) + tableSize;
+		size_t fileSize = static_cast<size_t>(currentBlobOffset);
+		for (BlobSource& currentSource : blobSources)
+		{
+			currentSource.m_Entry.DescOffset = currentBlobOffset;
+			currentBlobOffset += currentSource.m_Entry.DescSize;
+			currentSource.m_Entry.BlobOffset = currentBlobOffset;
+			currentBlobOffset += currentSource.m_Entry.BlobSize;
+			fileSize += static_cast<size_t>(currentSource.m_Entry.DescSize + currentSource.m_Entry.BlobSize);
+		}
+
+		OutFileData.resize(fileSize);
+		uint8_t* tableData = OutFileData.data() + sizeof(PIPELINE_CACHE_FILE_HEADER);
+		for (size_t entryIdx = 0; entryIdx < blobSources.size(); entryIdx++)
+		{
+			const BlobSource& currentSource = blobSources[entryIdx];
+			std::memcpy(tableData + entryIdx * sizeof(PIPELINE_CACHE_FILE_ENTRY), &currentSource.m_Entry, sizeof(PIPELINE_CACHE_FILE_ENTRY));
+			if (currentSource.m_Entry.DescSize > 0)
+				std::memcpy(OutFileData.data() + currentSource.m_Entry.DescOffset, currentSource.m_Desc, static_cast<size_t>(currentSource.m_Entry.DescSize));
+			if (currentSource.m_Entry.BlobSize > 0)
+				std::memcpy(OutFileData.data() + currentSource.m_Entry.BlobOffset, currentSource.m_Data, static_cast<size_t>(currentSource.m_Entry.BlobSize));
+		}
+
+		PIPELINE_CACHE_FILE_HEADER fileHeader = {};
+		fileHeader.Magic = g_PipelineCacheFileMagic;
+		fileHeader.Version = g_PipelineCacheFileVersion;
+		fileHeader.DeviceIdentityHash = m_DeviceIdentityHash;
+		fileHeader.EntriesNum = static_cast<uint32_t>(blobSources.size());
+		fileHeader.TableHash = Hash::HashBytes(tableData, tableSize);
+		std::memcpy(OutFileData.data(), &fileHeader, sizeof(PIPELINE_CACHE_FILE_HEADER));
+	}
+
+	size_t PipelineDiskCache::GetEntriesNum()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		size_t outEntriesNum = m_StoredEntries.size();
+		for (size_t entryIdx = 0; entryIdx < m_LoadedEntriesNum; entryIdx++)
+		{
+			const uint64_t currentKey = m_LoadedEntries[entryIdx].Key;
+			if (!m_InvalidatedKeys.count(currentKey) && !m_StoredEntries.count(currentKey))
+				outEntriesNum++;
+		}
+		return outEntriesNum;
+	}
+
+	const PIPELINE_CACHE_FILE_ENTRY* PipelineDiskCache::FindLoadedEntry(uint64_t InKey) const
+	{
+		const PIPELINE_CACHE_FILE_ENTRY* tableEnd = m_LoadedEntries + m_LoadedEntriesNum;
+		const PIPELINE_CACHE_FILE_ENTRY* foundEntry = std::lower_bound(m_LoadedEntries, tableEnd, InKey,
+			[](const PIPELINE_CACHE_FILE_ENTRY& InEntry, uint64_t InKeyToFind) { return InEntry.Key < InKeyToFind; });
+
+		return (foundEntry != tableEnd && foundEntry->Key == InKey) ? foundEntry : nullptr;
+	}
+
+	void PipelineDiskCache::ResetLoadedFile()
+	{
+		m_MappedFile.Close();
+		m_LoadedEntries = nullptr;
+		m_LoadedEntriesNum = 0;
+		m_ValidatedKeys.clear();
+		m_InvalidatedKeys.clear();
+	}
+
+} }
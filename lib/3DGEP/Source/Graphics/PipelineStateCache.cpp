@@ -0,0 +1,175 @@
+/*
+ PipelineStateCache.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "PipelineStateCache.h"
+#include <string>
+#include <type_traits>
+#include "GEPUtilsHash.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Distinguishes graphics and compute descriptions that would otherwise serialize to the same bytes
+	enum class PIPELINE_STATE_DESC_TYPE : uint32_t {
+		GRAPHICS = 0,
+		COMPUTE
+	};
+
+	// Note: only meant for single values (integers, enums, floats), serializing whole structs would include their padding bytes
+	template<typename T>
+	static void AppendDescValue(const T& InValue, std::vector<uint8_t>& OutDesc)
+	{
+		static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "AppendDescValue only accepts arithmetic and enum types");
+		const uint8_t* valueBytes = reinterpret_cast<const uint8_t*>(&InValue);
+		OutDesc.insert(OutDesc.end(), valueBytes, valueBytes + sizeof(T));
+	}
+
+	// The length is written too, so that consecutive strings cannot produce the same bytes sequence
+	static void AppendDescString(const std::string& InString, std::vector<uint8_t>& OutDesc)
+	{
+		AppendDescValue(static_cast<uint32_t>(InString.size()), OutDesc);
+		OutDesc.insert(OutDesc.end(), InString.begin(), InString.end());
+	}
+
+	static void AppendResourceBinderDesc(const GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_DESC& InDesc, std::vector<uint8_t>& OutDesc)
+	{
+		AppendDescValue(static_cast<uint32_t>(InDesc.Flags), OutDesc);
+
+		AppendDescValue(static_cast<uint32_t>(InDesc.Params.size()), OutDesc);
+		for (const PipelineState::RESOURCE_BINDER_PARAM& currentParam : InDesc.Params)
+		{
+			AppendDescValue(currentParam.ResourceType, OutDesc);
+			AppendDescValue(currentParam.Num32BitValues, OutDesc);
+			AppendDescValue(currentParam.ShaderRegister, OutDesc);
+			AppendDescValue(currentParam.RegisterSpace, OutDesc);
+			AppendDescValue(currentParam.NumDescriptors, OutDesc);
+			AppendDescValue(currentParam.shaderVisibility, OutDesc);
+			AppendDescValue(currentParam.DataVolatility, OutDesc);
+			AppendDescValue(currentParam.DescriptorVolatility, OutDesc);
+		}
+
+		AppendDescValue(static_cast<uint32_t>(InDesc.StaticSamplers.size()), OutDesc);
+		for (const StaticSampler& currentSampler : InDesc.StaticSamplers)
+		{
+			AppendDescValue(currentSampler.m_ShaderRegister, OutDesc);
+			AppendDescValue(currentSampler.m_Filter, OutDesc);
+			AppendDescValue(currentSampler.m_AddressU, OutDesc);
+			AppendDescValue(currentSampler.m_AddressV, OutDesc);
+			AppendDescValue(currentSampler.m_AddressW, OutDesc);
+		}
+	}
+
+	GEPUtils::Graphics::PipelineDescKey MakeResourceBinderDescKey(const GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_DESC& InDesc)
+	{
+		PipelineDescKey outKey;
+		AppendResourceBinderDesc(InDesc, outKey.m_Desc);
+		outKey.m_Hash = Hash::HashBytes(outKey.m_Desc.data(), outKey.m_Desc.size());
+		return outKey;
+	}
+
+	GEPUtils::Graphics::PipelineDescKey MakePipelineStateDescKey(const GEPUtils::Graphics::PipelineState::GRAPHICS_PSO_DESC& InDesc)
+	{
+		PipelineDescKey outKey;
+		AppendDescValue(PIPELINE_STATE_DESC_TYPE::GRAPHICS, outKey.m_Desc);
+
+		AppendDescValue(static_cast<uint32_t>(InDesc.InputLayoutDesc.LayoutElements.size()), outKey.m_Desc);
+		for (const PipelineState::INPUT_LAYOUT_DESC::LayoutElement& currentElement : InDesc.InputLayoutDesc.LayoutElements)
+		{
+			AppendDescString(currentElement.m_Name, outKey.m_Desc);
+			AppendDescValue(currentElement.m_Format, outKey.m_Desc);
+			AppendDescValue(currentElement.m_InputSlot, outKey.m_Desc);
+			AppendDescValue(currentElement.m_InstanceStepRate, outKey.m_Desc);
+			AppendDescValue(currentElement.m_SemanticIndex, outKey.m_Desc);
+		}
+
+		AppendResourceBinderDesc(InDesc.ResourceBinderDesc, outKey.m_Desc);
+		AppendDescValue(InDesc.TopologyType, outKey.m_Desc);
+		AppendDescValue(InDesc.VertexShader.GetBytecodeHash(), outKey.m_Desc);
+		AppendDescValue(InDesc.PixelShader.GetBytecodeHash(), outKey.m_Desc);
+		AppendDescValue(InDesc.DSFormat, outKey.m_Desc);
+		AppendDescValue(InDesc.RTFormat, outKey.m_Desc);
+
+		outKey.m_Hash = Hash::HashBytes(outKey.m_Desc.data(), outKey.m_Desc.size());
+		return outKey;
+	}
+
+	GEPUtils::Graphics::PipelineDescKey MakePipelineStateDescKey(const GEPUtils::Graphics::PipelineState::COMPUTE_PSO_DESC& InDesc)
+	{
+		PipelineDescKey outKey;
+		AppendDescValue(PIPELINE_STATE_DESC_TYPE::COMPUTE, outKey.m_Desc);
+
+		AppendResourceBinderDesc(InDesc.ResourceBinderDesc, outKey.m_Desc);
+		AppendDescValue(InDesc.ComputeShader.GetBytecodeHash(), outKey.m_Desc);
+
+		outKey.m_Hash = Hash::HashBytes(outKey.m_Desc.data(), outKey.m_Desc.size());
+		return outKey;
+	}
+
+	GEPUtils::Graphics::AsyncPipelineState AsyncPipelineState::MakeReady(GEPUtils::Graphics::PipelineState& InPipelineState)
+	{
+		std::promise<GEPUtils::Graphics::PipelineState*> readyPromise;
+		readyPromise.set_value(&InPipelineState);
+		return AsyncPipelineState(readyPromise.get_future().share());
+	}
+
+	bool AsyncPipelineState::IsReady() const
+	{
+		return m_Future.valid() && m_Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	GEPUtils::Graphics::PipelineState* AsyncPipelineState::GetIfReady() const
+	{
+		// Note: a failed compilation is ready as well, but get() would throw
+		if (!IsReady())
+			return nullptr;
+		return m_Future.get();
+	}
+
+	GEPUtils::Graphics::PipelineState& AsyncPipelineState::Wait() const
+	{
+		return *m_Future.get();
+	}
+
+	GEPUtils::Graphics::PipelineState* PipelineStateCache::Find(const GEPUtils::Graphics::PipelineDescKey& InDescKey)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto foundPipelineStateIt = m_PipelineStates.find(InDescKey);
+		if (foundPipelineStateIt == m_PipelineStates.end())
+			return nullptr;
+
+		GEPUtils::Graphics::PipelineState* foundPipelineState = foundPipelineStateIt->second.GetIfReady();
+		if (foundPipelineState)
+			m_HitsNum++;
+		return foundPipelineState;
+	}
+
+	GEPUtils::Graphics::AsyncPipelineState PipelineStateCache::FindOrAdd(const GEPUtils::Graphics::PipelineDescKey& InDescKey, const GEPUtils::Graphics::AsyncPipelineState& InNewRequest, bool& OutIsNew)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto insertResult = m_PipelineStates.emplace(InDescKey, InNewRequest);
+		OutIsNew = insertResult.second;
+		if (!OutIsNew)
+			m_HitsNum++;
+
+		return insertResult.first->second;
+	}
+
+	size_t PipelineStateCache::GetPipelineStatesNum()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_PipelineStates.size();
+	}
+
+	uint64_t PipelineStateCache::GetHitsNum()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_HitsNum;
+	}
+
+} }
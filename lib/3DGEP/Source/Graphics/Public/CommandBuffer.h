@@ -0,0 +1,337 @@
+/*
+ CommandBuffer.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef CommandBuffer_h__
+#define CommandBuffer_h__
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "GraphicsTypes.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	class CommandList;
+	class PipelineState;
+	class Window;
+	class CommandSignature;
+	class IndirectArgumentBuilder;
+
+	// Every command that can be recorded in a CommandBuffer. Each one maps to a single CommandList method.
+	enum class RECORDED_COMMAND_TYPE : uint16_t
+	{
+		RESOURCE_BARRIER = 0,
+		TRANSITION_RESOURCE,
+		ALIASING_BARRIER,
+		DISCARD_RESOURCE,
+		CLEAR_RTV,
+		CLEAR_DEPTH,
+		SET_PIPELINE_STATE_AND_RESOURCE_BINDER,
+		SET_INPUT_ASSEMBLER_DATA,
+		SET_VERTEX_BUFFER,
+		SET_VIEWPORT_AND_SCISSOR_RECT,
+		SET_RENDER_TARGET_FROM_WINDOW,
+		SET_GRAPHICS_ROOT_CONSTANTS,
+		SET_COMPUTE_ROOT_CONSTANTS,
+		SET_GRAPHICS_ROOT_TABLE,
+		SET_GRAPHICS_ROOT_CONSTANT_BUFFER,
+		SET_COMPUTE_ROOT_CONSTANT_BUFFER,
+		SET_GRAPHICS_ROOT_SHADER_RESOURCE,
+		SET_COMPUTE_ROOT_SHADER_RESOURCE,
+		SET_GRAPHICS_ROOT_UNORDERED_ACCESS,
+		SET_COMPUTE_ROOT_UNORDERED_ACCESS,
+		DRAW_INDEXED,
+		DRAW_INDEXED_INSTANCED,
+		DISPATCH,
+		EXECUTE_INDIRECT,
+		STORE_AND_EXECUTE_INDIRECT,
+		EXECUTE_BUNDLE,
+		UPLOAD_VIEW_TO_GPU,
+		UPLOAD_UAV_TO_GPU,
+		STORE_AND_REFERENCE_DYNAMIC_BUFFER,
+		STORE_AND_SET_DYNAMIC_ROOT_CONSTANT_BUFFER,
+		REFERENCE_SRV,
+		REFERENCE_COMPUTE_TABLE_SRV,
+		REFERENCE_COMPUTE_TABLE_UAV,
+		UPLOAD_BUFFER_DATA,
+		UPLOAD_BUFFER_REGION,
+
+		COUNT
+	};
+
+	// Every recorded packet starts with this header. Size includes the header itself and any trailing inline data,
+	// so that the stream can be walked without knowing the packet layouts.
+	// Note: the size is 32 bits since packets with big inline data can be bigger than a block (see CommandArena::AcquireDedicatedBlock(..)),
+	// it costs no space since packets are 8 bytes aligned.
+	struct RecordedCommandHeader
+	{
+		RECORDED_COMMAND_TYPE m_Type;
+		uint32_t m_Size;
+	};
+
+	// Note: packets are plain old data. Engine objects are referenced by pointer, so they need to outlive the replay of the buffer.
+	// Small variable-size data (e.g. root constants) is copied inline right after the packet.
+	namespace RecordedCommands {
+
+		struct ResourceBarrier { RecordedCommandHeader m_Header; Resource* m_Resource; RESOURCE_STATE m_PrevState; RESOURCE_STATE m_AfterState; };
+
+		struct TransitionResource { RecordedCommandHeader m_Header; Resource* m_Resource; RESOURCE_STATE m_StateAfter; uint32_t m_Subresource; };
+
+		struct AliasingBarrier { RecordedCommandHeader m_Header; Resource* m_ResourceAfter; };
+
+		struct DiscardResource { RecordedCommandHeader m_Header; Resource* m_Resource; };
+
+		struct ClearRTV { RecordedCommandHeader m_Header; CpuDescHandle* m_DescHandle; float m_Color[4]; };
+
+		struct ClearDepth { RecordedCommandHeader m_Header; CpuDescHandle* m_DescHandle; };
+
+		struct SetPipelineStateAndResourceBinder { RecordedCommandHeader m_Header; PipelineState* m_PipelineState; };
+
+		struct SetInputAssemblerData { RecordedCommandHeader m_Header; PRIMITIVE_TOPOLOGY m_PrimTopology; VertexBufferView* m_VertexBufView; IndexBufferView* m_IndexBufView; };
+
+		struct SetVertexBuffer { RecordedCommandHeader m_Header; uint32_t m_Slot; VertexBufferView* m_VertexBufView; };
+
+		struct SetViewportAndScissorRect { RecordedCommandHeader m_Header; ViewPort* m_Viewport; Rect* m_ScissorRect; };
+
+		struct SetRenderTargetFromWindow { RecordedCommandHeader m_Header; Window* m_Window; };
+
+		// Followed by m_Num32BitValuesToSet inline 32 bit values
+		struct SetRootConstants { RecordedCommandHeader m_Header; uint32_t m_RootParameterIndex; uint32_t m_Num32BitValuesToSet; uint32_t m_DestOffsetIn32BitValues; };
+
+		struct SetGraphicsRootTable { RecordedCommandHeader m_Header; uint32_t m_RootIndex; ConstantBufferView* m_View; };
+
+		// Shared by all the root descriptor types, graphics and compute
+		struct SetRootDescriptor { RecordedCommandHeader m_Header; uint32_t m_RootIdx; uint64_t m_GpuAddress; };
+
+		struct DrawIndexed { RecordedCommandHeader m_Header; uint64_t m_IndexCountPerInstance; };
+
+		struct DrawIndexedInstanced { RecordedCommandHeader m_Header; uint32_t m_IndexCountPerInstance; uint32_t m_InstanceCount; uint32_t m_StartIndexLocation; int32_t m_BaseVertexLocation; uint32_t m_StartInstanceLocation; };
+
+		struct Dispatch { RecordedCommandHeader m_Header; uint32_t m_GroupsNumX; uint32_t m_GroupsNumY; uint32_t m_GroupsNumZ; };
+
+		struct ExecuteIndirect { RecordedCommandHeader m_Header; CommandSignature* m_Signature; uint32_t m_MaxCommandsNum; Buffer* m_ArgumentBuffer; uint64_t m_ArgumentOffset; Buffer* m_CountBuffer; uint64_t m_CountOffset; };
+
+		// Note: the builder content is read at replay time
+		struct StoreAndExecuteIndirect { RecordedCommandHeader m_Header; CommandSignature* m_Signature; const IndirectArgumentBuilder* m_ArgumentBuilder; };
+
+		struct ExecuteBundle { RecordedCommandHeader m_Header; CommandList* m_Bundle; };
+
+		struct UploadViewToGPU { RecordedCommandHeader m_Header; ShaderResourceView* m_SRV; };
+
+		struct UploadUavToGpu { RecordedCommandHeader m_Header; UnorderedAccessView* m_UAV; };
+
+		struct StoreAndReferenceDynamicBuffer { RecordedCommandHeader m_Header; uint32_t m_RootIdx; DynamicBuffer* m_DynBuffer; ConstantBufferView* m_ResourceView; };
+
+		// Note: the dynamic buffer content is read at replay time
+		struct StoreAndSetDynamicRootConstantBuffer { RecordedCommandHeader m_Header; uint32_t m_RootIdx; DynamicBuffer* m_DynBuffer; };
+
+		struct ReferenceSRV { RecordedCommandHeader m_Header; uint32_t m_RootIdx; ShaderResourceView* m_SRV; };
+
+		struct ReferenceComputeTableSRV { RecordedCommandHeader m_Header; uint32_t m_RootIdx; ShaderResourceView* m_SRV; };
+
+		struct ReferenceComputeTableUAV { RecordedCommandHeader m_Header; uint32_t m_RootIdx; UnorderedAccessView* m_UAV; };
+
+		// Note: buffer data is NOT copied, the pointed memory needs to stay valid until the command buffer is replayed.
+		struct UploadBufferData { RecordedCommandHeader m_Header; Buffer* m_DestinationBuffer; Buffer* m_IntermediateBuffer; const void* m_BufferData; size_t m_DataSize; };
+
+		// Note: as for UploadBufferData, data is NOT copied.
+		struct UploadBufferRegion { RecordedCommandHeader m_Header; Buffer* m_DestBuffer; uint64_t m_DestOffset; Buffer* m_StagingBuffer; uint64_t m_StagingOffset; const void* m_Data; size_t m_DataSize; };
+	}
+
+	// Memory blocks used by command buffers to store their packets.
+	// Each thread owns its own arena, so recording on multiple threads at the same time never needs synchronization.
+	// Blocks are never freed until the thread exits: they are returned to the arena and reused by the next recording.
+	// The only exception are dedicated blocks, holding a single packet bigger than BlockSize, which are freed when released.
+	class CommandArena
+	{
+	public:
+		static constexpr size_t BlockSize = 64 * 1024;
+
+		struct Block
+		{
+			size_t m_UsedSize = 0;
+			size_t m_Capacity = 0;
+			std::unique_ptr<uint8_t[]> m_Data;
+		};
+
+		// Returns the arena owned by the calling thread.
+		static CommandArena& GetForCurrentThread();
+
+		Block* AcquireBlock();
+
+		// Block sized for a single packet of InSize bytes, bigger than BlockSize
+		Block* AcquireDedicatedBlock(size_t InSize);
+
+		void ReleaseBlock(Block* InBlock);
+
+		// Blocks of BlockSize bytes, dedicated blocks are not counted
+		size_t GetAllocatedBlocksNum() const { return m_Blocks.size(); }
+
+		size_t GetDedicatedBlocksNum() const { return m_DedicatedBlocks.size(); }
+
+		CommandArena() = default;
+		// No copies, blocks are uniquely owned
+		CommandArena(const CommandArena&) = delete;
+		CommandArena& operator= (const CommandArena&) = delete;
+	private:
+		std::vector<std::unique_ptr<Block>> m_Blocks;
+		std::vector<Block*> m_FreeBlocks;
+		std::vector<std::unique_ptr<Block>> m_DedicatedBlocks;
+	};
+
+	// Backend-agnostic linear recording of CommandList calls.
+	// Recording is a plain append of POD packets into arena blocks, it does not need a device and it does not touch any graphics API,
+	// so it can happen before the backend exists and it can be inspected (e.g. sorted or merged) before being translated.
+	// Replay(..) translates the recorded packets, in order, to calls on a target CommandList.
+	// Note: a command buffer takes its memory from the arena of the thread that created it, so it needs to be recorded, reset and destroyed on that same thread.
+	// Replay can happen on any thread.
+	class CommandBuffer
+	{
+	public:
+		CommandBuffer();
+		explicit CommandBuffer(CommandArena& InArena);
+
+		~CommandBuffer();
+
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer& operator= (const CommandBuffer&) = delete;
+
+		void ResourceBarrier(Resource& InResource, RESOURCE_STATE InPrevState, RESOURCE_STATE InAfterState);
+
+		void TransitionResource(Resource& InResource, RESOURCE_STATE InStateAfter, uint32_t InSubresource);
+
+		void AliasingBarrier(Resource& InResourceAfter);
+
+		void DiscardResource(Resource& InResource);
+
+		void ClearRTV(CpuDescHandle& InDescHandle, const float* InColor);
+
+		void ClearDepth(CpuDescHandle& InDescHandle);
+
+		void SetPipelineStateAndResourceBinder(PipelineState& InPipelineState);
+
+		void SetInputAssemblerData(PRIMITIVE_TOPOLOGY InPrimTopology, VertexBufferView& InVertexBufView, IndexBufferView& InIndexBufView);
+
+		void SetVertexBuffer(uint32_t InSlot, VertexBufferView& InVertexBufView);
+
+		void SetViewportAndScissorRect(ViewPort& InViewport, Rect& InScissorRect);
+
+		void SetRenderTargetFromWindow(Window& InWindow);
+
+		// Note: root constants are copied inline in the command buffer
+		void SetGraphicsRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues);
+
+		void SetComputeRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues);
+
+		void SetGraphicsRootTable(uint32_t InRootIndex, ConstantBufferView& InView);
+
+		void SetGraphicsRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress);
+
+		void SetComputeRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress);
+
+		void SetGraphicsRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress);
+
+		void SetComputeRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress);
+
+		void SetGraphicsRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress);
+
+		void SetComputeRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress);
+
+		void DrawIndexed(uint64_t InIndexCountPerInstance);
+
+		void DrawIndexedInstanced(uint32_t InIndexCountPerInstance, uint32_t InInstanceCount, uint32_t InStartIndexLocation, int32_t InBaseVertexLocation, uint32_t InStartInstanceLocation);
+
+		void Dispatch(uint32_t InGroupsNumX, uint32_t InGroupsNumY, uint32_t InGroupsNumZ);
+
+		void ExecuteIndirect(CommandSignature& InSignature, uint32_t InMaxCommandsNum, Buffer& InArgumentBuffer, uint64_t InArgumentOffset, Buffer* InCountBuffer, uint64_t InCountOffset);
+
+		void StoreAndExecuteIndirect(CommandSignature& InSignature, const IndirectArgumentBuilder& InArgumentBuilder);
+
+		void ExecuteBundle(CommandList& InBundle);
+
+		void UploadViewToGPU(ShaderResourceView& InSRV);
+
+		void UploadUavToGpu(UnorderedAccessView& InUav);
+
+		void StoreAndReferenceDynamicBuffer(uint32_t InRootIdx, DynamicBuffer& InDynBuffer, ConstantBufferView& InResourceView);
+
+		void StoreAndSetDynamicRootConstantBuffer(uint32_t InRootIdx, DynamicBuffer& InDynBuffer);
+
+		void ReferenceSRV(uint32_t InRootIdx, ShaderResourceView& InSRV);
+
+		void ReferenceComputeTable(uint32_t InRootIdx, ShaderResourceView& InSrv);
+
+		void ReferenceComputeTable(uint32_t InRootIdx, UnorderedAccessView& InUav);
+
+		// Note: InBufferData is referenced and not copied, it needs to stay valid until Replay(..) is called
+		void UploadBufferData(Buffer& DestinationBuffer, Buffer& IntermediateBuffer, const void* InBufferData, size_t InDataSize);
+
+		// Note: InData is referenced and not copied, it needs to stay valid until Replay(..) is called
+		void UploadBufferRegion(Buffer& InDestBuffer, uint64_t InDestOffset, Buffer& InStagingBuffer, uint64_t InStagingOffset, const void* InData, size_t InDataSize);
+
+		// Translates all the recorded commands, in recording order, to the target command list.
+		void Replay(CommandList& InTargetCmdList) const;
+
+		// Calls InFunc(const RecordedCommandHeader&) for every recorded packet, in recording order.
+		// The header can be cast to the packet type corresponding to its m_Type.
+		template<typename FuncType>
+		void ForEachCommand(FuncType&& InFunc) const
+		{
+			for (const CommandArena::Block* currentBlock : m_Blocks)
+			{
+				size_t currentOffset = 0;
+				while (currentOffset < currentBlock->m_UsedSize)
+				{
+					const RecordedCommandHeader& currentHeader = *reinterpret_cast<const RecordedCommandHeader*>(currentBlock->m_Data.get() + currentOffset);
+					InFunc(currentHeader);
+					currentOffset += currentHeader.m_Size;
+				}
+			}
+		}
+
+		// Discards all the recorded commands and gives the used blocks back to the arena
+		void Reset();
+
+		bool IsEmpty() const { return m_CommandsNum == 0; }
+
+		uint32_t GetCommandsNum() const { return m_CommandsNum; }
+
+		// Total size of the recorded packets, in bytes
+		size_t GetRecordedSize() const { return m_RecordedSize; }
+
+	private:
+		// Reserves space for a packet of type T followed by InExtraSize bytes of inline data, and fills its header
+		template<typename T>
+		T* AllocateCommand(RECORDED_COMMAND_TYPE InType, size_t InExtraSize = 0)
+		{
+			T* newCommand = static_cast<T*>(AllocatePacketMemory(sizeof(T) + InExtraSize));
+			newCommand->m_Header.m_Type = InType;
+			newCommand->m_Header.m_Size = static_cast<uint32_t>(AlignPacketSize(sizeof(T) + InExtraSize));
+			return newCommand;
+		}
+
+		// Packets bigger than a block get a dedicated block of their own, so recording never fails
+		void* AllocatePacketMemory(size_t InSize);
+
+		void RecordRootConstants(RECORDED_COMMAND_TYPE InType, uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues);
+
+		void RecordRootDescriptor(RECORDED_COMMAND_TYPE InType, uint32_t InRootIdx, uint64_t InGpuAddress);
+
+		// All packets are kept aligned to the biggest alignment requirement among their members (pointers and 64 bit values)
+		static constexpr size_t AlignPacketSize(size_t InSize) { return (InSize + alignof(uint64_t) - 1) & ~(alignof(uint64_t) - 1); }
+
+		CommandArena& m_Arena;
+		std::vector<CommandArena::Block*> m_Blocks;
+		uint32_t m_CommandsNum = 0;
+		size_t m_RecordedSize = 0;
+	};
+
+} }
+
+#endif // CommandBuffer_h__
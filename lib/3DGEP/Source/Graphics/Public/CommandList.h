@@ -10,12 +10,15 @@
 #define CommandList_h__
 
 #include "GraphicsTypes.h"
+#include "ResourceStateTracker.h"
 
 namespace GEPUtils { namespace Graphics {
 
 	class Device;
 	class PipelineState;
 	class Window;
+	class CommandSignature;
+	class IndirectArgumentBuilder;
 
 	class CommandList
 	{
@@ -25,20 +28,45 @@ namespace GEPUtils { namespace Graphics {
 
 		virtual void Close() = 0;
 
-		virtual void ResourceBarrier(GEPUtils::Graphics::Resource& InResource,
-			GEPUtils::Graphics::RESOURCE_STATE InPrevState, GEPUtils::Graphics::RESOURCE_STATE InAfterState) = 0;
+		// Deprecated, use TransitionResource(..): states are tracked, so the previous state is only checked against the tracked one, when known.
+		void ResourceBarrier(GEPUtils::Graphics::Resource& InResource,
+			GEPUtils::Graphics::RESOURCE_STATE InPrevState, GEPUtils::Graphics::RESOURCE_STATE InAfterState);
+
+		// Requests the resource (or one of its subresources) to be in the given state for the next commands.
+		// The transition is accumulated with the others and submitted in a single batch before the next draw, dispatch or copy.
+		void TransitionResource(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InStateAfter, uint32_t InSubresource = GEPUtils::Graphics::ALL_SUBRESOURCES);
+
+		// Submits all the accumulated transitions as a single barrier call. Implementations call this before every draw, dispatch and copy.
+		void FlushResourceBarriers();
+
+		// Makes InResourceAfter the one in use among the placed resources sharing its memory, to be called before its first use.
+		// The content of the resource is undefined after this call, so it needs to be fully written (e.g. cleared) before being read.
+		void AliasingBarrier(GEPUtils::Graphics::Resource& InResourceAfter);
+
+		// Marks the content of the resource as not needed anymore, so that the driver can initialize it without preserving any data.
+		// Placed render target and depth stencil textures need this (or a full clear) after their aliasing barrier and after creation, before any other use.
+		// Note: render targets need to be in RENDER_TARGET state and depth stencils in DEPTH_WRITE state.
+		void DiscardResource(GEPUtils::Graphics::Resource& InResource);
+
+		GEPUtils::Graphics::ResourceStateTracker& GetResourceStateTracker() { return m_ResourceStateTracker; }
 
 		virtual void ClearRTV(GEPUtils::Graphics::CpuDescHandle& InDescHandle, float* InColor) = 0;
 		
 		virtual void ClearDepth(GEPUtils::Graphics::CpuDescHandle& InDescHandle) = 0;
 
-		virtual void SetPipelineStateAndResourceBinder(GEPUtils::Graphics::PipelineState& InPipelineState) = 0;
+		// Note: the following state setters are filtered against the state currently set in the command list,
+		// so setting again the same PSO, IA buffers, viewport or render target will not reach the graphics API.
+		void SetPipelineStateAndResourceBinder(GEPUtils::Graphics::PipelineState& InPipelineState);
 
-		virtual void SetInputAssemblerData(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology, GEPUtils::Graphics::VertexBufferView& InVertexBufView, GEPUtils::Graphics::IndexBufferView& InIndexBufView) = 0;
+		// Note: the vertex buffer is bound to slot 0
+		void SetInputAssemblerData(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology, GEPUtils::Graphics::VertexBufferView& InVertexBufView, GEPUtils::Graphics::IndexBufferView& InIndexBufView);
 
-		virtual void SetViewportAndScissorRect(GEPUtils::Graphics::ViewPort& InViewport, GEPUtils::Graphics::Rect& InScissorRect) = 0;
+		// Binds an additional vertex stream, e.g. per-instance data read by layout elements with m_InstanceStepRate > 0
+		void SetVertexBuffer(uint32_t InSlot, GEPUtils::Graphics::VertexBufferView& InVertexBufView);
 
-		virtual void SetRenderTargetFromWindow(GEPUtils::Graphics::Window& InWindow) = 0;
+		void SetViewportAndScissorRect(GEPUtils::Graphics::ViewPort& InViewport, GEPUtils::Graphics::Rect& InScissorRect);
+
+		void SetRenderTargetFromWindow(GEPUtils::Graphics::Window& InWindow);
 
 		virtual void SetGraphicsRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues) = 0;
 
@@ -46,16 +74,62 @@ namespace GEPUtils { namespace Graphics {
 
 		virtual void SetGraphicsRootTable(uint32_t InRootIndex, GEPUtils::Graphics::ConstantBufferView& InView) = 0;
 
-		virtual void DrawIndexed(uint64_t InIndexCountPerInstance) = 0;
+		// Root descriptors bind a buffer by GPU address (see Buffer::GetGpuAddress()), no descriptor is created or copied.
+		// Constant buffer addresses need to be 256 bytes aligned.
+		virtual void SetGraphicsRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress) = 0;
+
+		virtual void SetComputeRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress) = 0;
+
+		virtual void SetGraphicsRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress) = 0;
+
+		virtual void SetComputeRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress) = 0;
+
+		virtual void SetGraphicsRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress) = 0;
+
+		virtual void SetComputeRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress) = 0;
+
+		// Note: InBaseVertexLocation is added to each index before reading the vertex buffers,
+		// and per-instance elements start reading from InStartInstanceLocation.
+		virtual void DrawIndexedInstanced(uint32_t InIndexCountPerInstance, uint32_t InInstanceCount, uint32_t InStartIndexLocation, int32_t InBaseVertexLocation, uint32_t InStartInstanceLocation) = 0;
+
+		void DrawIndexed(uint64_t InIndexCountPerInstance) { DrawIndexedInstanced(static_cast<uint32_t>(InIndexCountPerInstance), 1, 0, 0, 0); }
 
 		virtual void Dispatch(uint32_t InGroupsNumX, uint32_t InGroupsNumY, uint32_t InGroupsNumZ) = 0;
 
+		// Executes up to InMaxCommandsNum draws or dispatches, depending on the signature, reading their arguments from InArgumentBuffer at InArgumentOffset.
+		// If InCountBuffer is not null, the number of executed commands is the minimum between InMaxCommandsNum and the uint32 found at InCountOffset.
+		// Note: argument and count buffers written by the GPU need to be transitioned to INDIRECT_ARGUMENT first.
+		virtual void ExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, uint32_t InMaxCommandsNum, GEPUtils::Graphics::Buffer& InArgumentBuffer, uint64_t InArgumentOffset, 
+			GEPUtils::Graphics::Buffer* InCountBuffer, uint64_t InCountOffset) = 0;
+
+		// Copies the arguments packed by the builder, followed by their count, in frame memory and executes them all with a single ExecuteIndirect(..).
+		virtual void StoreAndExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, const GEPUtils::Graphics::IndirectArgumentBuilder& InArgumentBuilder) = 0;
+
+		// Replays the commands recorded in a bundle (see GraphicsAllocatorBase::AllocateBundle()).
+		// The bundle inherits the root arguments, viewport and render target currently set in this command list. Bundles setting root arguments
+		// also set their resource binder, which needs to be the one currently set in this command list for the inherited root arguments to be kept.
+		// The pipeline state and input assembler data set in the bundle stay set in this command list after the call.
+		void ExecuteBundle(GEPUtils::Graphics::CommandList& InBundle);
+
+		// Bundles can only be executed by other command lists. Transitions, clears, copies, viewport and render target changes cannot be recorded in a bundle,
+		// and neither can frame memory (e.g. StoreAndReferenceDynamicBuffer(..)), since recorded commands need to stay valid for all the frames the bundle is executed in.
+		bool IsBundle() const { return m_IsBundle; }
+
+		// Discards the commands recorded in the bundle and opens it for recording again.
+		// Waits for the GPU if a submitted command list executing the bundle could still be running, since the bundle memory gets reused.
+		// Note: command lists executing the bundle need to be submitted before this call.
+		virtual void ResetBundle() = 0;
+
 		virtual void UploadViewToGPU(GEPUtils::Graphics::ShaderResourceView& InSRV) = 0;
 
 		virtual void UploadUavToGpu(GEPUtils::Graphics::UnorderedAccessView& InUav) = 0;
 
 		virtual void StoreAndReferenceDynamicBuffer(uint32_t InRootIdx, GEPUtils::Graphics::DynamicBuffer& InDynBuffer, GEPUtils::Graphics::ConstantBufferView& InResourceView) = 0;
 
+		// Copies the current content of the dynamic buffer in frame memory and binds it to a root CBV (graphics) by address.
+		// Unlike StoreAndReferenceDynamicBuffer(..) it needs no view, and no descriptor gets created or copied to the GPU heap.
+		virtual void StoreAndSetDynamicRootConstantBuffer(uint32_t InRootIdx, GEPUtils::Graphics::DynamicBuffer& InDynBuffer) = 0;
+
 		virtual void ReferenceSRV(uint32_t InRootIdx, GEPUtils::Graphics::ShaderResourceView& InSRV) = 0;
 
 		virtual void ReferenceComputeTable(uint32_t InRootIdx, GEPUtils::Graphics::ShaderResourceView& InUav) = 0;
@@ -65,10 +139,85 @@ namespace GEPUtils { namespace Graphics {
 		// Internally calls ::UpdateSubresources(..) where IntermediateBuffer is expected to be allocated in upload heap
 		virtual void UploadBufferData(GEPUtils::Graphics::Buffer& DestinationBuffer, GEPUtils::Graphics::Buffer& IntermediateBuffer, const void* InBufferData, size_t InDataSize) = 0;
 
+		// Copies InData in InStagingBuffer (upload heap) at InStagingOffset, then records the copy of that range to InDestBuffer at InDestOffset.
+		// The staging range cannot be written again until the command list finished executing on GPU.
+		virtual void UploadBufferRegion(GEPUtils::Graphics::Buffer& InDestBuffer, uint64_t InDestOffset, GEPUtils::Graphics::Buffer& InStagingBuffer, uint64_t InStagingOffset, const void* InData, size_t InDataSize) = 0;
+
+		// Forgets the state currently set in the command list, so that the next state setters will all reach the graphics API.
+		// Needs to be called every time the underlying command list is reset, or when the content of a view bound to the command list has been modified.
+		void InvalidateShadowState();
+
+		// Number of state setting calls that have been dropped because redundant, since the last shadow state invalidation.
+		uint64_t GetFilteredStateCallsNum() const { return m_FilteredStateCallsNum; }
+
+		// Forgets both the shadow state and the tracked resource states. Needs to be called every time the underlying command list is reset.
+		void ResetTrackedStates();
+
 	protected:
-		CommandList(GEPUtils::Graphics::Device& InDevice);
+		CommandList(GEPUtils::Graphics::Device& InDevice, bool InIsBundle = false);
+
+		// Platform-specific implementations of the filtered state setters
+		virtual void SetPipelineState_Internal(GEPUtils::Graphics::PipelineState& InPipelineState) = 0;
+
+		// Root signature and descriptor heap are filtered on the platform objects they map to, which can be shared by different pipeline states
+		virtual const void* GetRootSignatureIdentity_Internal(GEPUtils::Graphics::PipelineState& InPipelineState) = 0;
+
+		virtual void SetRootSignature_Internal(GEPUtils::Graphics::PipelineState& InPipelineState) = 0;
+
+		virtual const void* GetDescriptorHeapIdentity_Internal() = 0;
+
+		virtual void SetDescriptorHeap_Internal() = 0;
+
+		virtual void SetPrimitiveTopology_Internal(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology) = 0;
+
+		virtual void SetVertexBuffer_Internal(uint32_t InSlot, GEPUtils::Graphics::VertexBufferView& InVertexBufView) = 0;
+
+		virtual void SetIndexBuffer_Internal(GEPUtils::Graphics::IndexBufferView& InIndexBufView) = 0;
+
+		virtual void SetViewport_Internal(GEPUtils::Graphics::ViewPort& InViewport) = 0;
+
+		virtual void SetScissorRect_Internal(GEPUtils::Graphics::Rect& InScissorRect) = 0;
+
+		virtual void SetRenderTargetFromWindow_Internal(GEPUtils::Graphics::Window& InWindow) = 0;
+
+		// Records InBarriersNum transitions in a single call to the graphics API
+		virtual void ExecuteResourceBarriers_Internal(const GEPUtils::Graphics::RESOURCE_TRANSITION* InBarriers, uint32_t InBarriersNum) = 0;
+
+		virtual void ExecuteAliasingBarrier_Internal(GEPUtils::Graphics::Resource& InResourceAfter) = 0;
+
+		virtual void DiscardResource_Internal(GEPUtils::Graphics::Resource& InResource) = 0;
+
+		virtual void ExecuteBundle_Internal(GEPUtils::Graphics::CommandList& InBundle) = 0;
 
 		GEPUtils::Graphics::Device& m_Device;
+
+	private:
+		void OnStateCallFiltered() { m_FilteredStateCallsNum++; }
+
+		static constexpr uint32_t VERTEX_BUFFER_SLOTS_NUM = 4;
+
+		// Last state set in the command list. Objects are compared by identity, null means unknown.
+		struct ShadowState {
+			GEPUtils::Graphics::PipelineState* m_PipelineState = nullptr;
+			const void* m_GraphicsRootSignature = nullptr;
+			const void* m_ComputeRootSignature = nullptr;
+			const void* m_DescriptorHeap = nullptr;
+			GEPUtils::Graphics::PRIMITIVE_TOPOLOGY m_PrimTopology = GEPUtils::Graphics::PRIMITIVE_TOPOLOGY::PT_UNDEFINED;
+			GEPUtils::Graphics::VertexBufferView* m_VertexBufViews[VERTEX_BUFFER_SLOTS_NUM] = {};
+			GEPUtils::Graphics::IndexBufferView* m_IndexBufView = nullptr;
+			GEPUtils::Graphics::ViewPort* m_Viewport = nullptr;
+			GEPUtils::Graphics::Rect* m_ScissorRect = nullptr;
+			GEPUtils::Graphics::Window* m_RenderTargetWindow = nullptr;
+			// Note: the window render target changes every frame together with its current back buffer
+			GEPUtils::Graphics::Resource* m_RenderTargetBackBuffer = nullptr;
+		};
+		ShadowState m_ShadowState;
+
+		uint64_t m_FilteredStateCallsNum = 0;
+
+		const bool m_IsBundle;
+
+		GEPUtils::Graphics::ResourceStateTracker m_ResourceStateTracker;
 	};
 
 } }
@@ -0,0 +1,34 @@
+/*
+ CommandSignature.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef CommandSignature_h__
+#define CommandSignature_h__
+
+#include "IndirectArguments.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Describes the content of an argument buffer executed with CommandList::ExecuteIndirect(..).
+	// Note: only a single draw or dispatch per argument is supported, no root arguments change between them.
+	class CommandSignature {
+	public:
+		virtual ~CommandSignature() = default;
+
+		virtual void Init(GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE InArgumentType) = 0;
+
+		GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE GetArgumentType() const { return m_ArgumentType; }
+
+		uint32_t GetByteStride() const { return GetIndirectArgumentStride(m_ArgumentType); }
+
+	protected:
+		GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE m_ArgumentType = GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED;
+	};
+
+} }
+
+#endif // CommandSignature_h__
@@ -0,0 +1,219 @@
+/*
+ ConstantBufferLayout.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef ConstantBufferLayout_h__
+#define ConstantBufferLayout_h__
+
+#include <cstdint>
+#include <Eigen/Core>
+
+namespace GEPUtils { namespace Graphics {
+
+	// HLSL constant buffers are organized in 16 bytes registers.
+	// A field never straddles a register boundary, matrix columns (default column_major packing) and array elements always start a new register.
+	static constexpr uint32_t g_CBufferRegisterSize = 16;
+
+	// Describes how a C++ type packs into a HLSL constant buffer, specialized for the types we mirror in shaders.
+	// Note: HLSL bool is 4 bytes, use uint32_t on the C++ side.
+	template<typename T>
+	struct CBufferFieldTraits;
+
+	template<> struct CBufferFieldTraits<float> { static constexpr uint32_t Size = 4; static constexpr bool StartsNewRegister = false; };
+	template<> struct CBufferFieldTraits<int32_t> { static constexpr uint32_t Size = 4; static constexpr bool StartsNewRegister = false; };
+	template<> struct CBufferFieldTraits<uint32_t> { static constexpr uint32_t Size = 4; static constexpr bool StartsNewRegister = false; };
+
+	// Eigen vectors map to floatN, Eigen matrices (column major) to floatRxC, one register per column
+	template<int Rows, int Cols, int Options, int MaxRows, int MaxCols>
+	struct CBufferFieldTraits<Eigen::Matrix<float, Rows, Cols, Options, MaxRows, MaxCols>> {
+		static_assert(Rows >= 1 && Rows <= 4 && Cols >= 1 && Cols <= 4 && (Options & Eigen::RowMajor) == 0, "Only fixed size, column major, Eigen types up to 4x4 can be mirrored in constant buffers");
+		static constexpr uint32_t Size = (Cols - 1) * g_CBufferRegisterSize + Rows * 4;
+		static constexpr bool StartsNewRegister = Cols > 1;
+	};
+
+	// Every array element starts a new register
+	template<typename T, size_t N>
+	struct CBufferFieldTraits<T[N]> {
+		static constexpr uint32_t ElementStride = (CBufferFieldTraits<T>::Size + g_CBufferRegisterSize - 1) / g_CBufferRegisterSize * g_CBufferRegisterSize;
+		static constexpr uint32_t Size = static_cast<uint32_t>(N - 1) * ElementStride + CBufferFieldTraits<T>::Size;
+		static constexpr bool StartsNewRegister = true;
+	};
+
+	template<typename... FieldTs>
+	struct CBufferLayout;
+
+	// A nested HLSL struct is described by its own layout: it starts a new register and the next field can pack right after its last one
+	template<typename... NestedFieldTs>
+	struct CBufferFieldTraits<CBufferLayout<NestedFieldTs...>> {
+		static constexpr uint32_t Size = CBufferLayout<NestedFieldTs...>::Size;
+		static constexpr bool StartsNewRegister = true;
+	};
+
+	// Size and alignment of the C++ type mirroring a field, nested layouts stand for the struct declaring their fields
+	template<typename T>
+	struct CBufferCppFieldTraits { static constexpr uint32_t Size = sizeof(T); static constexpr uint32_t Alignment = alignof(T); static constexpr bool IsCompatible = true; };
+
+	template<typename T, size_t N>
+	struct CBufferCppFieldTraits<T[N]> {
+		static constexpr uint32_t Size = static_cast<uint32_t>(N) * CBufferCppFieldTraits<T>::Size;
+		static constexpr uint32_t Alignment = CBufferCppFieldTraits<T>::Alignment;
+		static constexpr bool IsCompatible = CBufferCppFieldTraits<T>::IsCompatible;
+	};
+
+	template<typename... NestedFieldTs>
+	struct CBufferCppFieldTraits<CBufferLayout<NestedFieldTs...>> {
+		static constexpr uint32_t Size = CBufferLayout<NestedFieldTs...>::CppSize;
+		static constexpr uint32_t Alignment = CBufferLayout<NestedFieldTs...>::CppAlignment;
+		static constexpr bool IsCompatible = CBufferLayout<NestedFieldTs...>::IsCppCompatible;
+	};
+
+	struct CBUFFER_FIELD_INFO {
+		uint32_t HlslSize;
+		bool StartsNewRegister;
+		uint32_t CppSize;
+		uint32_t CppAlignment;
+	};
+
+	namespace CBufferLayoutUtils {
+
+		constexpr uint32_t AlignUp(uint32_t InValue, uint32_t InAlignment) { return (InValue + InAlignment - 1) / InAlignment * InAlignment; }
+
+		template<typename... FieldTs>
+		constexpr uint32_t ComputeFieldSize(uint32_t InFieldIdx)
+		{
+			const uint32_t sizes[] = { CBufferFieldTraits<FieldTs>::Size... };
+			return sizes[InFieldIdx];
+		}
+
+		template<typename... FieldTs>
+		constexpr uint32_t ComputeHlslOffset(uint32_t InFieldIdx)
+		{
+			const CBUFFER_FIELD_INFO fields[] = { { CBufferFieldTraits<FieldTs>::Size, CBufferFieldTraits<FieldTs>::StartsNewRegister, CBufferCppFieldTraits<FieldTs>::Size, CBufferCppFieldTraits<FieldTs>::Alignment }... };
+			uint32_t currentOffset = 0;
+			for (uint32_t fieldIdx = 0; fieldIdx <= InFieldIdx; fieldIdx++)
+			{
+				const bool straddlesRegister = (currentOffset % g_CBufferRegisterSize) + fields[fieldIdx].HlslSize > g_CBufferRegisterSize;
+				if (fields[fieldIdx].StartsNewRegister || straddlesRegister)
+					currentOffset = AlignUp(currentOffset, g_CBufferRegisterSize);
+				if (fieldIdx < InFieldIdx)
+					currentOffset += fields[fieldIdx].HlslSize;
+			}
+			return currentOffset;
+		}
+
+		// Offset the field would have in a C++ struct declaring the same fields
+		template<typename... FieldTs>
+		constexpr uint32_t ComputeCppOffset(uint32_t InFieldIdx)
+		{
+			const CBUFFER_FIELD_INFO fields[] = { { CBufferFieldTraits<FieldTs>::Size, CBufferFieldTraits<FieldTs>::StartsNewRegister, CBufferCppFieldTraits<FieldTs>::Size, CBufferCppFieldTraits<FieldTs>::Alignment }... };
+			uint32_t currentOffset = 0;
+			for (uint32_t fieldIdx = 0; fieldIdx <= InFieldIdx; fieldIdx++)
+			{
+				currentOffset = AlignUp(currentOffset, fields[fieldIdx].CppAlignment);
+				if (fieldIdx < InFieldIdx)
+					currentOffset += fields[fieldIdx].CppSize;
+			}
+			return currentOffset;
+		}
+
+		template<typename... FieldTs>
+		constexpr uint32_t ComputeCppAlignment()
+		{
+			const uint32_t alignments[] = { CBufferCppFieldTraits<FieldTs>::Alignment... };
+			uint32_t maxAlignment = 1;
+			for (uint32_t currentAlignment : alignments)
+				maxAlignment = currentAlignment > maxAlignment ? currentAlignment : maxAlignment;
+			return maxAlignment;
+		}
+
+		template<typename... FieldTs>
+		constexpr uint32_t ComputeCppSize()
+		{
+			const uint32_t cppSizes[] = { CBufferCppFieldTraits<FieldTs>::Size... };
+			const uint32_t lastFieldIdx = sizeof...(FieldTs) - 1;
+			return AlignUp(ComputeCppOffset<FieldTs...>(lastFieldIdx) + cppSizes[lastFieldIdx], ComputeCppAlignment<FieldTs...>());
+		}
+
+		template<typename... FieldTs>
+		constexpr uint32_t ComputeDataSize()
+		{
+			const uint32_t sizes[] = { CBufferFieldTraits<FieldTs>::Size... };
+			uint32_t outSize = 0;
+			for (uint32_t currentSize : sizes)
+				outSize += currentSize;
+			return outSize;
+		}
+
+		// No field straddles a register and every field has the same size on both sides (not the case of arrays and matrices with less than 4 rows),
+		// nested layouts need to be compatible on their own
+		template<typename... FieldTs>
+		constexpr bool IsCppCompatible()
+		{
+			const CBUFFER_FIELD_INFO fields[] = { { CBufferFieldTraits<FieldTs>::Size, CBufferFieldTraits<FieldTs>::StartsNewRegister, CBufferCppFieldTraits<FieldTs>::Size, CBufferCppFieldTraits<FieldTs>::Alignment }... };
+			const bool nestedCompatibles[] = { CBufferCppFieldTraits<FieldTs>::IsCompatible... };
+			for (uint32_t fieldIdx = 0; fieldIdx < sizeof...(FieldTs); fieldIdx++)
+			{
+				if (!nestedCompatibles[fieldIdx] || fields[fieldIdx].HlslSize != fields[fieldIdx].CppSize || ComputeHlslOffset<FieldTs...>(fieldIdx) != ComputeCppOffset<FieldTs...>(fieldIdx))
+					return false;
+			}
+			return true;
+		}
+	}
+
+	// Computes at compile time the HLSL packed layout of a constant buffer, given the types of its fields in declaration order.
+	// A C++ struct declaring the same fields, in the same order, can be copied as is to the GPU only if each field lands on the same offset on both sides:
+	// e.g. two floats followed by a Vector3f: HLSL moves the vector to offset 16, since it would straddle the first register, while C++ places it at offset 8.
+	// Typical use, next to the struct mirroring the shader constant buffer:
+	//   using MyCBLayout = CBufferLayout<Eigen::Vector2f, float>;
+	//   static_assert(MyCBLayout::Matches<MyCB>(), "MyCB does not follow HLSL packing");
+	// and then MyCBLayout::Num32BitValues in place of sizeof(MyCB) / 4 for root constants.
+	// A field can be a nested layout, e.g. CBufferLayout<float, CBufferLayout<float, Eigen::Vector2f>[2]> for an array of two structs.
+	template<typename... FieldTs>
+	struct CBufferLayout {
+		static_assert(sizeof...(FieldTs) > 0, "A constant buffer layout needs at least one field");
+
+		static constexpr uint32_t FieldsNum = sizeof...(FieldTs);
+
+		static constexpr uint32_t GetFieldOffset(uint32_t InFieldIdx) { return CBufferLayoutUtils::ComputeHlslOffset<FieldTs...>(InFieldIdx); }
+
+		static constexpr uint32_t GetFieldSize(uint32_t InFieldIdx) { return CBufferLayoutUtils::ComputeFieldSize<FieldTs...>(InFieldIdx); }
+
+		// Bytes used by the fields, as HLSL packs them. Root constants only need this many bytes.
+		static constexpr uint32_t Size = CBufferLayoutUtils::ComputeHlslOffset<FieldTs...>(FieldsNum - 1) + CBufferLayoutUtils::ComputeFieldSize<FieldTs...>(FieldsNum - 1);
+
+		static constexpr uint32_t Num32BitValues = Size / 4;
+
+		// A constant buffer always occupies whole registers
+		static constexpr uint32_t RegistersNum = CBufferLayoutUtils::AlignUp(Size, g_CBufferRegisterSize) / g_CBufferRegisterSize;
+
+		// Bytes lost to packing over the registers the buffer occupies, reordering fields or filling the gaps reduces it
+		static constexpr uint32_t PaddingSize = RegistersNum * g_CBufferRegisterSize - CBufferLayoutUtils::ComputeDataSize<FieldTs...>();
+
+		// Size of a C++ struct declaring the same fields
+		static constexpr uint32_t CppSize = CBufferLayoutUtils::ComputeCppSize<FieldTs...>();
+
+		static constexpr uint32_t CppAlignment = CBufferLayoutUtils::ComputeCppAlignment<FieldTs...>();
+
+		static constexpr bool IsCppCompatible = CBufferLayoutUtils::IsCppCompatible<FieldTs...>();
+
+		// To be used in a static_assert, StructT is expected to declare exactly the layout fields in the same order
+		template<typename StructT>
+		static constexpr bool Matches() { return IsCppCompatible && sizeof(StructT) == CppSize; }
+	};
+
+	template<typename... FieldTs> constexpr uint32_t CBufferLayout<FieldTs...>::FieldsNum;
+	template<typename... FieldTs> constexpr uint32_t CBufferLayout<FieldTs...>::Size;
+	template<typename... FieldTs> constexpr uint32_t CBufferLayout<FieldTs...>::Num32BitValues;
+	template<typename... FieldTs> constexpr uint32_t CBufferLayout<FieldTs...>::RegistersNum;
+	template<typename... FieldTs> constexpr uint32_t CBufferLayout<FieldTs...>::PaddingSize;
+	template<typename... FieldTs> constexpr uint32_t CBufferLayout<FieldTs...>::CppSize;
+	template<typename... FieldTs> constexpr uint32_t CBufferLayout<FieldTs...>::CppAlignment;
+	template<typename... FieldTs> constexpr bool CBufferLayout<FieldTs...>::IsCppCompatible;
+
+} }
+
+#endif // ConstantBufferLayout_h__
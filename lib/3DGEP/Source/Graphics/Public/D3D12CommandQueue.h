@@ -13,7 +13,9 @@
 #include <d3d12.h>
 #include <queue> // For std::queue
 #include <memory>
+#include <vector>
 #include "CommandQueue.h"
+#include "ResourceStateTracker.h"
 
 namespace D3D12GEPUtils {
 
@@ -66,6 +68,9 @@ namespace D3D12GEPUtils {
 		CmdListQueue m_CmdListPool;
 		CmdListQueueRefs m_CmdListsAvailable;
 
+		// Transitions resolved when submitting a command list, kept to avoid allocating on every submission
+		std::vector<GEPUtils::Graphics::RESOURCE_TRANSITION> m_ResolvedBarriers;
+
 		// Platform-agnostic reference to the device that holds this command queue
 		GEPUtils::Graphics::Device& m_GraphicsDevice;
 
@@ -16,6 +16,8 @@
 #include <dxgi1_6.h>
 #include <d3dx12.h>
 #include "GraphicsTypes.h"
+#include "GEPUtilsHash.h"
+#include "ShaderBytecodeStore.h"
 #include "../D3D12/D3D12DescHeapFactory.h"
 
 #ifdef max
@@ -71,6 +73,8 @@ namespace D3D12GEPUtils {
 
 	void ReadFileToBlob(LPCWSTR InFilePath, ID3DBlob** OutFileBlob);
 
+	ComPtr<ID3DBlob> SerializeRootSignature(CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC* InRootSigDesc, D3D_ROOT_SIGNATURE_VERSION InVersion);
+
 	ComPtr<ID3D12RootSignature> SerializeAndCreateRootSignature(ComPtr<ID3D12Device2> InDevice, CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC* InRootSigDesc, D3D_ROOT_SIGNATURE_VERSION InVersion);
 
 	inline void ThrowIfFailed(HRESULT hr)
@@ -121,6 +125,7 @@ namespace D3D12GEPUtils {
 		Microsoft::WRL::ComPtr<ID3D12Resource>& GetInner() { return m_D3D12Resource; }
 		void SetInner(Microsoft::WRL::ComPtr<ID3D12Resource> InResource) { m_D3D12Resource = InResource; }
 		uint64_t GetSizeInBytes() const { return m_DataSize; }
+		virtual uint64_t GetGpuAddress() override { return m_D3D12Resource->GetGPUVirtualAddress(); }
 		void Map(void** OutCpuPp) { m_D3D12Resource->Map(0, nullptr, OutCpuPp); }
 		void UnMap() { m_D3D12Resource->Unmap(0, nullptr); }
 	private:
@@ -128,6 +133,15 @@ namespace D3D12GEPUtils {
 
 	};
 
+	struct D3D12ResourceHeap : public GEPUtils::Graphics::ResourceHeap {
+		D3D12ResourceHeap(Microsoft::WRL::ComPtr<ID3D12Heap> InHeap, uint64_t InSize, GEPUtils::Graphics::RESOURCE_HEAP_USAGE InUsage)
+			: GEPUtils::Graphics::ResourceHeap(InSize, InUsage), m_D3D12Heap(InHeap)
+		{ }
+		Microsoft::WRL::ComPtr<ID3D12Heap>& GetInner() { return m_D3D12Heap; }
+	private:
+		Microsoft::WRL::ComPtr<ID3D12Heap> m_D3D12Heap;
+	};
+
 	struct D3D12DynamicBuffer : public GEPUtils::Graphics::DynamicBuffer {
 
 		virtual void SetData(void* InData, size_t InSize, size_t InAlignmentSize) override;
@@ -137,7 +151,7 @@ namespace D3D12GEPUtils {
 	struct D3D12Texture : public GEPUtils::Graphics::Texture {
 		D3D12Texture() = default; // Allow empty D3D12Texture for cases like DummyTexture
 
-		D3D12Texture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels);
+		D3D12Texture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = GEPUtils::Graphics::RESOURCE_FLAGS::NONE);
 
 		// Constructor to load the texture from file. It will not upload it to GPU so that has to be done manually after creating the texture.
 		D3D12Texture(const wchar_t* InResourcePath, GEPUtils::Graphics::TEXTURE_FILE_FORMAT InFileFormat, int32_t InMipsNum, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags);
@@ -146,9 +160,14 @@ namespace D3D12GEPUtils {
 
 		virtual void InstantiateOnGPU() override;
 
+		// Allocates the texture as a placed resource, in memory owned by InHeap
+		void InstantiatePlacedOnGPU(ID3D12Heap* InHeap, uint64_t InHeapOffset, GEPUtils::Graphics::RESOURCE_STATE InInitialState);
+
 		virtual size_t GetGPUSize() override;
 
 		Microsoft::WRL::ComPtr<ID3D12Resource>& GetInner() { return m_D3D12Resource; }
+
+		const CD3DX12_RESOURCE_DESC& GetDesc() const { return m_TextureDesc; }
 	private:
 
 		void SetGeneralTextureParams(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags);
@@ -252,9 +271,16 @@ namespace D3D12GEPUtils {
 
 	};
 
+	// Bytecode is owned by the store, that keeps it mapped in memory only while acquired
 	struct D3D12Shader : public GEPUtils::Graphics::Shader {
-		D3D12Shader(ComPtr<ID3DBlob> InShaderBlob) : m_ShaderBlob(InShaderBlob) { }
-		ComPtr<ID3DBlob> m_ShaderBlob;
+		D3D12Shader(GEPUtils::Graphics::ShaderBytecodeStore& InBytecodeStore, uint32_t InBytecodeId) : m_BytecodeStore(InBytecodeStore), m_BytecodeId(InBytecodeId)
+		{
+			m_BytecodeHash = InBytecodeStore.GetBytecodeHash(InBytecodeId);
+		}
+		virtual GEPUtils::Graphics::ShaderBytecodeView AcquireBytecode() override { return m_BytecodeStore.AcquireBytecode(m_BytecodeId); }
+		virtual void ReleaseBytecode() override { m_BytecodeStore.ReleaseBytecode(m_BytecodeId); }
+		GEPUtils::Graphics::ShaderBytecodeStore& m_BytecodeStore;
+		uint32_t m_BytecodeId;
 	};
 
 }
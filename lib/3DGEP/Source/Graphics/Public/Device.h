@@ -9,6 +9,7 @@
 #ifndef Device_h__
 #define Device_h__
 
+#include <cstdint>
 #include <memory>
 
 namespace GEPUtils { namespace Graphics {
@@ -29,6 +30,9 @@ public:
 
 	virtual void ShutDown() = 0;
 
+	// Identifies the adapter and driver version in use, data compiled by the driver (e.g. cached pipeline states) is only valid for the same identity
+	virtual uint64_t GetIdentityHash() const = 0;
+
 private:
 	bool m_IsMainDevice=false;
 };
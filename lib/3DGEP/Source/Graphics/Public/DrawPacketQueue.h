@@ -0,0 +1,121 @@
+/*
+ DrawPacketQueue.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef DrawPacketQueue_h__
+#define DrawPacketQueue_h__
+
+#include <cstdint>
+#include <vector>
+#include "GraphicsTypes.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	class CommandList;
+	class PipelineState;
+
+	// Sort key layout, from the most significant bits: pass (8 bits), pipeline state id (16 bits), material id (24 bits), depth bucket (16 bits).
+	// Sorting by key groups draws by pass first and then by pipeline state and material, so that state changes are minimized,
+	// while draws sharing all the states end up ordered by depth.
+	static constexpr uint32_t g_DrawSortKeyDepthBits = 16;
+	static constexpr uint32_t g_DrawSortKeyMaterialBits = 24;
+	static constexpr uint32_t g_DrawSortKeyPipelineStateBits = 16;
+	static constexpr uint32_t g_DrawSortKeyPassBits = 8;
+
+	// Ids exceeding their bit range are masked
+	inline uint64_t MakeDrawSortKey(uint32_t InPass, uint32_t InPipelineStateId, uint32_t InMaterialId, uint32_t InDepthBucket)
+	{
+		return (static_cast<uint64_t>(InPass & ((1u << g_DrawSortKeyPassBits) - 1)) << (g_DrawSortKeyDepthBits + g_DrawSortKeyMaterialBits + g_DrawSortKeyPipelineStateBits))
+			| (static_cast<uint64_t>(InPipelineStateId & ((1u << g_DrawSortKeyPipelineStateBits) - 1)) << (g_DrawSortKeyDepthBits + g_DrawSortKeyMaterialBits))
+			| (static_cast<uint64_t>(InMaterialId & ((1u << g_DrawSortKeyMaterialBits) - 1)) << g_DrawSortKeyDepthBits)
+			| static_cast<uint64_t>(InDepthBucket & ((1u << g_DrawSortKeyDepthBits) - 1));
+	}
+
+	// Maps a view space depth in [InZMin, InZMax] to a depth bucket of the sort key, buckets grow moving away from the camera (front to back order).
+	// Translucent geometry needs to be drawn back to front instead, by setting InBackToFront.
+	uint32_t QuantizeDrawDepth(float InViewDepth, float InZMin, float InZMax, bool InBackToFront = false);
+
+	// Everything needed to record a draw, all the referenced objects need to stay alive until the queue is submitted.
+	struct DRAW_PACKET {
+		GEPUtils::Graphics::PipelineState* PipelineState = nullptr;
+		GEPUtils::Graphics::PRIMITIVE_TOPOLOGY PrimTopology = GEPUtils::Graphics::PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST;
+		GEPUtils::Graphics::VertexBufferView* VertexBufView = nullptr;
+		GEPUtils::Graphics::IndexBufferView* IndexBufView = nullptr;
+		// Material table, not bound if null
+		GEPUtils::Graphics::ShaderResourceView* MaterialSRV = nullptr;
+		uint32_t MaterialRootIdx = 0;
+		// Per-draw root constants (e.g. the MVP matrix), copied when the draw is added to the queue
+		const void* RootConstants = nullptr;
+		uint32_t RootConstantsRootIdx = 0;
+		uint32_t Num32BitRootConstants = 0;
+		uint32_t IndexCountPerInstance = 0;
+		uint32_t InstanceCount = 1;
+		uint32_t StartIndexLocation = 0;
+		int32_t BaseVertexLocation = 0;
+		uint32_t StartInstanceLocation = 0;
+	};
+
+	// Collects the draws of a frame, in whatever order they are issued, to record them in a command list sorted by their key (see MakeDrawSortKey(..)).
+	// Keys are sorted with an LSD radix sort, one pass for each key byte, skipping the bytes that are the same for all the keys.
+	// Memory is kept between Reset() calls, so once the queue has grown to the frame draws number neither adding draws nor sorting allocate.
+	class DrawPacketQueue {
+	public:
+		explicit DrawPacketQueue(uint32_t InExpectedDrawsNum = 0, uint32_t InExpectedRootConstantsNum = 0);
+
+		DrawPacketQueue(const DrawPacketQueue&) = delete;
+		DrawPacketQueue& operator= (const DrawPacketQueue&) = delete;
+
+		void AddDraw(uint64_t InSortKey, const DRAW_PACKET& InPacket);
+
+		// Stable: draws with the same key keep the order they were added in
+		void Sort();
+
+		// Records the draws in the command list, in key order if Sort() was called before.
+		// Pipeline state, input assembler data and material are only set when they change between consecutive draws.
+		// Note: viewport and render targets need to be already set in the command list.
+		void Submit(GEPUtils::Graphics::CommandList& InCmdList) const;
+
+		// Removes all the draws, keeping the memory for the next frame
+		void Reset();
+
+		uint32_t GetDrawsNum() const { return static_cast<uint32_t>(m_SortEntries.size()); }
+
+		// Draws in submission order
+		const DRAW_PACKET& GetDraw(uint32_t InDrawIdx) const { return m_Packets[m_SortEntries[InDrawIdx].m_PacketIdx]; }
+
+		uint64_t GetSortKey(uint32_t InDrawIdx) const { return m_SortEntries[InDrawIdx].m_Key; }
+
+		// Byte passes performed by the last Sort()
+		uint32_t GetLastSortPassesNum() const { return m_LastSortPassesNum; }
+
+	private:
+		struct SortEntry {
+			uint64_t m_Key;
+			uint32_t m_PacketIdx;
+		};
+
+		static constexpr uint32_t RADIX_BITS = 8;
+		static constexpr uint32_t RADIX_BUCKETS_NUM = 1 << RADIX_BITS;
+		static constexpr uint32_t RADIX_PASSES_NUM = 64 / RADIX_BITS;
+
+		// Packets and their root constants offset, in the order they were added
+		std::vector<DRAW_PACKET> m_Packets;
+		std::vector<uint32_t> m_RootConstantsOffsets;
+		std::vector<uint32_t> m_RootConstantsData;
+
+		std::vector<SortEntry> m_SortEntries;
+		std::vector<SortEntry> m_SortScratch;
+
+		// Counts of every byte value, for all the key bytes
+		uint32_t m_Histograms[RADIX_PASSES_NUM][RADIX_BUCKETS_NUM];
+
+		uint32_t m_LastSortPassesNum = 0;
+	};
+
+} }
+
+#endif // DrawPacketQueue_h__
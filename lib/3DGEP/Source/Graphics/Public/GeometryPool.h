@@ -0,0 +1,133 @@
+/*
+ GeometryPool.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GeometryPool_h__
+#define GeometryPool_h__
+
+#include <cstddef>
+#include <cstdint>
+#include "GraphicsTypes.h"
+#include "RangeAllocators.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	class CommandList;
+
+	// Ranges of a mesh in the pool buffers, as expected by DrawIndexedInstanced(..)
+	struct GEOMETRY_POOL_MESH {
+		uint32_t BaseVertexLocation = 0;
+		uint32_t VerticesNum = 0;
+		uint32_t StartIndexLocation = 0;
+		uint32_t IndicesNum = 0;
+		bool IsValid() const { return IndicesNum > 0; }
+	};
+
+	enum class GEOMETRY_POOL_ADD_RESULT : int {
+		SUCCESS = 0,
+		EMPTY_MESH,
+		POOL_FULL, // Not enough free vertices or indices in total
+		FRAGMENTED, // Enough free vertices and indices in total, but not contiguous
+		STAGING_FULL // Wait for the previous uploads to complete and call OnUploadsCompleted()
+	};
+
+	// Bookkeeping of a GeometryPool, without any GPU resource: vertex and index ranges, staging buffer offsets and usage counters.
+	// A failed allocation leaves everything unchanged.
+	class GeometryPoolRanges {
+	public:
+		GeometryPoolRanges(uint32_t InVertexStride, uint32_t InIndexSize, uint32_t InMaxVerticesNum, uint32_t InMaxIndicesNum, size_t InStagingSize);
+
+		// On success, OutMesh holds the ranges of the mesh in the pool buffers and the staging offsets tell where to copy its vertices and indices
+		GEOMETRY_POOL_ADD_RESULT AllocateMesh(uint32_t InVerticesNum, uint32_t InIndicesNum, GEOMETRY_POOL_MESH& OutMesh, size_t& OutVerticesStagingOffset, size_t& OutIndicesStagingOffset);
+
+		void FreeMesh(const GEOMETRY_POOL_MESH& InMesh);
+
+		void OnUploadsCompleted() { m_StagingOffset = 0; }
+
+		uint32_t GetVertexStride() const { return m_VertexStride; }
+
+		uint32_t GetIndexSize() const { return m_IndexSize; }
+
+		size_t GetStagingOffset() const { return m_StagingOffset; }
+
+		uint32_t GetMeshesNum() const { return m_MeshesNum; }
+
+		uint32_t GetUsedVerticesNum() const { return m_UsedVerticesNum; }
+
+		uint32_t GetUsedIndicesNum() const { return m_UsedIndicesNum; }
+
+	private:
+		uint32_t m_VertexStride;
+		uint32_t m_IndexSize;
+		uint32_t m_MaxVerticesNum;
+		uint32_t m_MaxIndicesNum;
+
+		GEPUtils::Graphics::StaticRangeAllocator m_VertexRanges;
+		GEPUtils::Graphics::StaticRangeAllocator m_IndexRanges;
+
+		size_t m_StagingSize;
+		size_t m_StagingOffset = 0;
+
+		uint32_t m_MeshesNum = 0;
+		uint32_t m_UsedVerticesNum = 0;
+		uint32_t m_UsedIndicesNum = 0;
+	};
+
+	// Vertices and indices of many meshes sub-allocated out of a single vertex buffer and a single index buffer,
+	// so that all the meshes in the pool share the same input assembler data and each draw selects its mesh with base vertex and start index.
+	// Indices of a mesh are relative to its first vertex. Ranges are handled by GeometryPoolRanges, in vertices and indices units.
+	// Mesh data is copied through an upload staging buffer, filled linearly and reused only after OnUploadsCompleted().
+	class GeometryPool {
+	public:
+		// InIndexFormat is either R16_UINT or R32_UINT
+		GeometryPool(uint32_t InVertexStride, uint32_t InMaxVerticesNum, uint32_t InMaxIndicesNum, GEPUtils::Graphics::BUFFER_FORMAT InIndexFormat, size_t InStagingSize);
+
+		GeometryPool(const GeometryPool&) = delete;
+		GeometryPool& operator= (const GeometryPool&) = delete;
+
+		// Records the copy of the mesh data in the command list. When the result is not SUCCESS nothing is recorded and OutMesh is invalid,
+		// e.g. with FRAGMENTED the caller can remove other meshes and try again, with STAGING_FULL it can retry after OnUploadsCompleted().
+		GEOMETRY_POOL_ADD_RESULT AddMesh(GEPUtils::Graphics::CommandList& InCmdList, const void* InVertices, uint32_t InVerticesNum, const void* InIndices, uint32_t InIndicesNum, GEOMETRY_POOL_MESH& OutMesh);
+
+		// The mesh ranges can be reused right away, so no command list still to be executed on GPU can reference the mesh
+		void RemoveMesh(const GEOMETRY_POOL_MESH& InMesh);
+
+		// To be called once the command lists recording the uploads finished executing on GPU (e.g. after CommandQueue::Flush()), so that the staging memory can be reused
+		void OnUploadsCompleted() { m_Ranges.OnUploadsCompleted(); }
+
+		// Brings the pool buffers back to a readable state, to be called after the uploads recorded in a command list and before the draws reading them
+		void TransitionForDraw(GEPUtils::Graphics::CommandList& InCmdList);
+
+		// Binds the pool buffers, already filtered by the command list shadow state when consecutive draws use the same pool.
+		// Note: it does not transition the buffers, so it can be recorded in bundles.
+		void SetInputAssemblerData(GEPUtils::Graphics::CommandList& InCmdList, GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology);
+
+		void DrawMesh(GEPUtils::Graphics::CommandList& InCmdList, const GEOMETRY_POOL_MESH& InMesh, uint32_t InInstanceCount = 1, uint32_t InStartInstanceLocation = 0);
+
+		GEPUtils::Graphics::VertexBufferView& GetVertexBufferView() { return *m_VertexBufferView; }
+
+		GEPUtils::Graphics::IndexBufferView& GetIndexBufferView() { return *m_IndexBufferView; }
+
+		uint32_t GetMeshesNum() const { return m_Ranges.GetMeshesNum(); }
+
+		uint32_t GetUsedVerticesNum() const { return m_Ranges.GetUsedVerticesNum(); }
+
+		uint32_t GetUsedIndicesNum() const { return m_Ranges.GetUsedIndicesNum(); }
+
+	private:
+		GeometryPoolRanges m_Ranges;
+
+		GEPUtils::Graphics::Buffer* m_VertexBuffer;
+		GEPUtils::Graphics::Buffer* m_IndexBuffer;
+		GEPUtils::Graphics::VertexBufferView* m_VertexBufferView;
+		GEPUtils::Graphics::IndexBufferView* m_IndexBufferView;
+		GEPUtils::Graphics::Buffer* m_StagingBuffer;
+	};
+
+} }
+
+#endif // GeometryPool_h__
@@ -11,6 +11,10 @@
 
 #include "GraphicsTypes.h"
 #include "PipelineState.h"
+#include "PipelineStateCache.h"
+#include "PipelineDiskCache.h"
+#include "CommandSignature.h"
+#include "GEPUtilsThreadPool.h"
 
 
 namespace GEPUtils { namespace Graphics {
@@ -42,9 +46,13 @@ public:
 
 	virtual GEPUtils::Graphics::DynamicBuffer& AllocateDynamicBuffer() = 0;
 
+	// Reserves InSize bytes of upload memory that stays valid until the current frame is completed by the GPU,
+	// returning its mapped pointer, to be written in place, and its GPU address, to bind it (e.g. with CommandList::SetGraphicsRootShaderResource(..)).
+	virtual void ReserveDynamicBufferMemory(size_t InSize, void*& OutCpuPtr, uint64_t& OutGpuAddress) = 0;
+
 	virtual GEPUtils::Graphics::Texture& AllocateTextureFromFile(wchar_t const* InTexturePath, GEPUtils::Graphics::TEXTURE_FILE_FORMAT InFileFormat, int32_t InMipsNum = 0, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) = 0;
 	
-	virtual GEPUtils::Graphics::Texture& AllocateEmptyTexture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels) = 0;
+	virtual GEPUtils::Graphics::Texture& AllocateEmptyTexture(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) = 0;
 
 	// Preferable for Static Buffers such as Vertex and Index Buffers.
 	// First creates an intermediary buffer in shared memory (upload heap), then the same buffer in reserved memory (default heap)
@@ -55,6 +63,29 @@ public:
 
 	virtual GEPUtils::Graphics::Buffer& AllocateBufferResource(size_t InSize, GEPUtils::Graphics::RESOURCE_HEAP_TYPE InHeapType, GEPUtils::Graphics::RESOURCE_STATE InState, GEPUtils::Graphics::RESOURCE_FLAGS InFlags = RESOURCE_FLAGS::NONE) = 0;
 
+	// Heap of GPU dedicated memory (default heap) to create placed resources in. Its memory is freed together with the allocator or by ReleaseResourceHeap(..).
+	virtual GEPUtils::Graphics::ResourceHeap& AllocateResourceHeap(uint64_t InSize, GEPUtils::Graphics::RESOURCE_HEAP_USAGE InUsage) = 0;
+
+	// Frees a resource created by this allocator, references to it are invalid after this call.
+	// Note: the object is destroyed only after GEPUtils::Constants::g_MaxConcurrentFramesNum new frames started, since frames in flight could still be using it on GPU.
+	virtual void ReleaseResource(GEPUtils::Graphics::Resource& InResource) = 0;
+
+	// Frees a heap created by this allocator, with the same deferred destruction of ReleaseResource(..).
+	// Note: the placed resources using the heap need to be released first.
+	virtual void ReleaseResourceHeap(GEPUtils::Graphics::ResourceHeap& InHeap) = 0;
+
+	// Size and alignment the texture would need if placed in a heap, no memory is allocated
+	virtual GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO GetTextureAllocationInfo(uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) = 0;
+
+	virtual GEPUtils::Graphics::RESOURCE_ALLOCATION_INFO GetBufferAllocationInfo(size_t InSize, GEPUtils::Graphics::RESOURCE_FLAGS InFlags = RESOURCE_FLAGS::NONE) = 0;
+
+	// Placed resources do not allocate memory, they use the one of InHeap starting from InHeapOffset (that needs to respect the resource alignment).
+	// Note: placed resources overlapping in memory alias each other, the content of a resource is undefined when it starts being used after another one,
+	// so it needs an aliasing barrier and it has to be fully written (e.g. cleared) before being read.
+	virtual GEPUtils::Graphics::Texture& AllocatePlacedTexture(GEPUtils::Graphics::ResourceHeap& InHeap, uint64_t InHeapOffset, uint32_t InWidth, uint32_t InHeight, GEPUtils::Graphics::TEXTURE_TYPE InType, GEPUtils::Graphics::BUFFER_FORMAT InFormat, uint32_t InArraySize, uint32_t InMipLevels, GEPUtils::Graphics::RESOURCE_STATE InState, GEPUtils::Graphics::RESOURCE_FLAGS InCreationFlags = RESOURCE_FLAGS::NONE) = 0;
+
+	virtual GEPUtils::Graphics::Buffer& AllocatePlacedBuffer(GEPUtils::Graphics::ResourceHeap& InHeap, uint64_t InHeapOffset, size_t InSize, GEPUtils::Graphics::RESOURCE_STATE InState, GEPUtils::Graphics::RESOURCE_FLAGS InFlags = RESOURCE_FLAGS::NONE) = 0;
+
 	virtual GEPUtils::Graphics::VertexBufferView& AllocateVertexBufferView() = 0;
 	virtual GEPUtils::Graphics::IndexBufferView& AllocateIndexBufferView() = 0;
 	virtual GEPUtils::Graphics::ConstantBufferView& AllocateConstantBufferView(GEPUtils::Graphics::Buffer& InResource) = 0;
@@ -68,8 +99,41 @@ public:
 	virtual GEPUtils::Graphics::UnorderedAccessView& AllocateUavTex2DArray(GEPUtils::Graphics::Texture& InTexture, uint32_t InArraySize, int32_t InMipSlice = -1, uint32_t InFirstArraySlice = 0, uint32_t InPlaceSlice = 0) = 0;
 	
 	virtual GEPUtils::Graphics::Shader& AllocateShader(wchar_t const* InShaderPath) = 0;
+
+	// Shaders allocated from now on with a path inside InMountPath are read from the packed archive (see ShaderArchive.h) when present in it.
+	// Returns false, keeping shaders loaded from their own files, if the archive cannot be opened.
+	virtual bool MountShaderArchive(wchar_t const* InArchivePath, wchar_t const* InMountPath) = 0;
+
 	virtual GEPUtils::Graphics::PipelineState& AllocatePipelineState() = 0;
 
+	virtual GEPUtils::Graphics::CommandSignature& AllocateCommandSignature(GEPUtils::Graphics::INDIRECT_ARGUMENT_TYPE InArgumentType) = 0;
+
+	// Bundles record a static sequence of commands once, to be replayed every frame with CommandList::ExecuteBundle(..).
+	// The returned bundle is open for recording and needs to be closed with Close() before being executed.
+	// Each bundle owns its command memory, reused only by CommandList::ResetBundle() and released together with the allocator.
+	virtual GEPUtils::Graphics::CommandList& AllocateBundle() = 0;
+
+	// Returns a pipeline state initialized with the given description. Pipeline states are cached by description hash,
+	// so requesting an identical description again returns the same object without creating anything on the graphics API.
+	// If the same description is being compiled asynchronously, waits for that compilation to finish.
+	GEPUtils::Graphics::PipelineState& AllocatePipelineState(GEPUtils::Graphics::PipelineState::GRAPHICS_PSO_DESC& InDesc);
+	GEPUtils::Graphics::PipelineState& AllocatePipelineState(GEPUtils::Graphics::PipelineState::COMPUTE_PSO_DESC& InDesc);
+
+	// Same as above, but the pipeline state gets compiled on a worker thread and the returned handle tells when it is ready.
+	// The description is copied, only the shaders are referenced and need to stay alive until the compilation finishes.
+	// Requesting a description that is already compiled or compiling returns a handle to the same pipeline state.
+	GEPUtils::Graphics::AsyncPipelineState AllocatePipelineStateAsync(GEPUtils::Graphics::PipelineState::GRAPHICS_PSO_DESC& InDesc);
+	GEPUtils::Graphics::AsyncPipelineState AllocatePipelineStateAsync(GEPUtils::Graphics::PipelineState::COMPUTE_PSO_DESC& InDesc);
+
+	// Blocks until all the asynchronous pipeline state compilations finished.
+	// Needs to be called before destroying the allocator or saving the pipeline disk cache.
+	void WaitForPipelineStateCompilations();
+
+	GEPUtils::Graphics::PipelineStateCache& GetPipelineStateCache() { return m_PipelineStateCache; }
+
+	// Root signature and pipeline state blobs from previous runs, loaded and saved by the application
+	GEPUtils::Graphics::PipelineDiskCache& GetPipelineDiskCache() { return m_PipelineDiskCache; }
+
 	virtual GEPUtils::Graphics::Window& AllocateWindow(GEPUtils::Graphics::WindowInitInput& InWindowInitInput) = 0;
 
 	virtual GEPUtils::Graphics::CommandQueue& AllocateCommandQueue(class Device& InDevice, COMMAND_LIST_TYPE InCmdListType) = 0;
@@ -79,6 +143,18 @@ public:
 	GraphicsAllocatorBase& operator=(const GraphicsAllocatorBase&) = delete;
 	GraphicsAllocatorBase(GraphicsAllocatorBase&&) = delete;
 	GraphicsAllocatorBase& operator=(GraphicsAllocatorBase&&) = delete;
+
+private:
+	// Registers a new pipeline state in the cache if the key is not there yet, and in that case calls InInitFn on it,
+	// on a worker thread when InIsAsync is true or right away otherwise.
+	GEPUtils::Graphics::AsyncPipelineState RequestPipelineState(const GEPUtils::Graphics::PipelineDescKey& InDescKey, bool InIsAsync, std::function<void(GEPUtils::Graphics::PipelineState&)> InInitFn);
+
+	GEPUtils::Graphics::PipelineStateCache m_PipelineStateCache;
+
+	GEPUtils::Graphics::PipelineDiskCache m_PipelineDiskCache;
+
+	// Note: declared last, so that it drains its queue and joins its workers before the caches they use get destroyed
+	GEPUtils::ThreadPool m_PipelineCompileThreadPool;
 };
 
 
@@ -86,12 +86,17 @@ struct GPUVirtualAddress {
 	bool IsValid = false;
 };
 
+// Note: new formats go at the end, values are part of pipeline state descriptions and so of the keys stored in the pipeline disk cache
 enum class BUFFER_FORMAT : int {
 	R16_UINT, // Single channel 16 bits
 	R32G32B32_FLOAT,
 	R8G8B8A8_UNORM,
 	D32_FLOAT,
-	BC1_UNORM
+	BC1_UNORM,
+	R32_FLOAT,
+	R32G32_FLOAT,
+	R32G32B32A32_FLOAT,
+	R32_UINT
 };
 
 enum class TEXTURE_FILE_FORMAT : int {
@@ -105,12 +110,35 @@ enum class RESOURCE_HEAP_TYPE : int {
 	UPLOAD = 1
 };
 
+// Kind of resources a heap for placed resources can contain.
+// Note: on older hardware buffers, render target (or depth stencil) textures and other textures cannot share the same heap.
+enum class RESOURCE_HEAP_USAGE : int {
+	BUFFERS = 0,
+	TEXTURES,
+	RENDER_TARGET_TEXTURES
+};
+
+// Size and alignment a resource needs when placed in a heap
+struct RESOURCE_ALLOCATION_INFO {
+	uint64_t Size = 0;
+	uint64_t Alignment = 0;
+};
+
 enum class RESOURCE_STATE : int {
 	PRESENT = 0,
 	RENDER_TARGET,
 	COPY_SOURCE,
 	COPY_DEST,
-	GEN_READ
+	GEN_READ,
+	VERTEX_AND_CONSTANT_BUFFER,
+	INDEX_BUFFER,
+	UNORDERED_ACCESS,
+	DEPTH_WRITE,
+	DEPTH_READ,
+	NON_PIXEL_SHADER_RESOURCE,
+	PIXEL_SHADER_RESOURCE,
+	ALL_SHADER_RESOURCE,
+	INDIRECT_ARGUMENT
 };
 
 enum class TEXTURE_TYPE : int {
@@ -123,7 +151,11 @@ enum class TEXTURE_TYPE : int {
 struct Resource {
 	size_t GetDataSize() const { return m_DataSize; }
 	size_t GetAlignSize() const { return m_AlignmentSize; }
-	virtual ~Resource() = default; // Need to specify virtual to make sure the first destructor to get invoked is the one of the last derived class!
+	// Number of parts of the resource that can be transitioned to a different state independently
+	virtual uint32_t GetSubresourcesNum() const { return 1; }
+	// Need to specify virtual to make sure the first destructor to get invoked is the one of the last derived class!
+	// Note: defined with the ResourceStateRegistry, destroyed resources are removed from it so that a new resource at the same address does not inherit their state.
+	virtual ~Resource();
 protected:
 	Resource() : m_DataSize(0), m_AlignmentSize(0) {};
 	size_t m_DataSize;
@@ -131,10 +163,14 @@ protected:
 };
 
 struct Buffer : public Resource {
+	// Address to reference the buffer directly from root descriptors
+	virtual uint64_t GetGpuAddress() = 0;
 };
 
 struct Texture : public Resource {
 
+	// Records the copy of the texture data to GPU memory. The texture is left in COPY_DEST state (not GEN_READ anymore),
+	// users need to transition it to the state they are going to use it with, e.g. PIXEL_SHADER_RESOURCE.
 	virtual void UploadToGPU(GEPUtils::Graphics::CommandList& InCommandList, GEPUtils::Graphics::Buffer& InIntermediateBuffer) = 0;
 	// Allocate empty space on GPU
 	virtual void InstantiateOnGPU() = 0;
@@ -147,6 +183,8 @@ struct Texture : public Resource {
 	TEXTURE_TYPE GetType() { return m_Type; }
 	size_t GetMipLevelsNum() { return m_MipLevelsNum; }
 	size_t GetArraySize() const { return m_ArraySize; }
+	// Note: 3D textures are considered to have a single array slice
+	virtual uint32_t GetSubresourcesNum() const override { return static_cast<uint32_t>(m_MipLevelsNum * (m_Type == TEXTURE_TYPE::TEX_3D ? 1 : m_ArraySize)); }
 
 protected:
 	size_t          m_Width;
@@ -158,6 +196,18 @@ protected:
 	std::vector<unsigned char> m_Data;
 };
 
+// Block of GPU memory where placed resources can be created, at a given offset.
+// Placed resources overlapping in memory alias each other: only one of them can be used at a time.
+struct ResourceHeap {
+	uint64_t GetSize() const { return m_Size; }
+	RESOURCE_HEAP_USAGE GetUsage() const { return m_Usage; }
+	virtual ~ResourceHeap() = default;
+protected:
+	ResourceHeap(uint64_t InSize, RESOURCE_HEAP_USAGE InUsage) : m_Size(InSize), m_Usage(InUsage) {};
+	uint64_t m_Size;
+	RESOURCE_HEAP_USAGE m_Usage;
+};
+
 struct DynamicBuffer : public Resource {
 	virtual void SetData(void* InData, size_t InSize, size_t InAlignmentSize) = 0;
 
@@ -255,9 +305,38 @@ enum class SHADER_VISIBILITY {
 	SV_ALL, SV_VERTEX, SV_HULL, SV_DOMAIN, SV_GEOMETRY, SV_PIXEL
 };
 
+// Non-owning view of compiled shader bytecode
+struct ShaderBytecodeView {
+	const void* m_Data = nullptr;
+	size_t m_Size = 0;
+};
+
 struct Shader {
+	// Bytecode is only guaranteed to be in memory between acquire and release, e.g. while creating a pipeline state
+	virtual GEPUtils::Graphics::ShaderBytecodeView AcquireBytecode() = 0;
+	virtual void ReleaseBytecode() = 0;
+	// Hash of the compiled bytecode, two shaders with the same hash are considered identical
+	uint64_t GetBytecodeHash() const { return m_BytecodeHash; }
+	virtual ~Shader() = default;
 protected:
 	Shader() = default;
+	uint64_t m_BytecodeHash = 0;
+};
+
+// Keeps the bytecode of a shader acquired for the lifetime of the object
+class ScopedShaderBytecode {
+public:
+	explicit ScopedShaderBytecode(GEPUtils::Graphics::Shader& InShader) : m_Shader(InShader), m_Bytecode(InShader.AcquireBytecode()) { }
+	~ScopedShaderBytecode() { m_Shader.ReleaseBytecode(); }
+
+	ScopedShaderBytecode(const ScopedShaderBytecode&) = delete;
+	ScopedShaderBytecode& operator= (const ScopedShaderBytecode&) = delete;
+
+	const void* GetData() const { return m_Bytecode.m_Data; }
+	size_t GetSize() const { return m_Bytecode.m_Size; }
+private:
+	GEPUtils::Graphics::Shader& m_Shader;
+	GEPUtils::Graphics::ShaderBytecodeView m_Bytecode;
 };
 
 
@@ -0,0 +1,92 @@
+/*
+ IndirectArguments.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef IndirectArguments_h__
+#define IndirectArguments_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GEPUtils { namespace Graphics {
+
+	enum class INDIRECT_ARGUMENT_TYPE : int {
+		DRAW_INDEXED = 0,
+		DISPATCH
+	};
+
+	// Same layout as the graphics API argument structs (D3D12_DRAW_INDEXED_ARGUMENTS and D3D12_DISPATCH_ARGUMENTS)
+	struct DRAW_INDEXED_ARGUMENTS {
+		uint32_t IndexCountPerInstance;
+		uint32_t InstanceCount;
+		uint32_t StartIndexLocation;
+		int32_t BaseVertexLocation;
+		uint32_t StartInstanceLocation;
+	};
+
+	struct DISPATCH_ARGUMENTS {
+		uint32_t ThreadGroupCountX;
+		uint32_t ThreadGroupCountY;
+		uint32_t ThreadGroupCountZ;
+	};
+
+	// Size in bytes of a single argument struct in an argument buffer
+	uint32_t GetIndirectArgumentStride(INDIRECT_ARGUMENT_TYPE InArgumentType);
+
+	// Packs indirect arguments of a single type, ready to be copied in an argument buffer and executed with CommandList::ExecuteIndirect(..).
+	// Arguments that would produce no work are rejected when added, and Compact(..) removes the culled ones keeping the order of the others,
+	// so that the GPU only reads what needs to be drawn or dispatched.
+	// Packing is pure CPU work, memory is kept between Reset() calls to avoid allocations.
+	class IndirectArgumentBuilder {
+	public:
+		explicit IndirectArgumentBuilder(INDIRECT_ARGUMENT_TYPE InArgumentType, uint32_t InExpectedArgumentsNum = 0);
+
+		// Return false, without adding anything, if the arguments are rejected (zero indices, instances or thread groups)
+		bool AddDrawIndexed(const DRAW_INDEXED_ARGUMENTS& InArguments);
+
+		bool AddDispatch(const DISPATCH_ARGUMENTS& InArguments);
+
+		// Removes the arguments whose entry in InIsVisible is zero, InIsVisible needs to have GetArgumentsNum() entries.
+		// Returns the number of removed arguments.
+		uint32_t Compact(const uint8_t* InIsVisible);
+
+		void Reset();
+
+		INDIRECT_ARGUMENT_TYPE GetArgumentType() const { return m_ArgumentType; }
+
+		uint32_t GetStride() const { return m_Stride; }
+
+		uint32_t GetArgumentsNum() const { return m_ArgumentsNum; }
+
+		// Arguments rejected since the last Reset()
+		uint32_t GetRejectedArgumentsNum() const { return m_RejectedArgumentsNum; }
+
+		const void* GetData() const { return m_Data.data(); }
+
+		size_t GetDataSize() const { return static_cast<size_t>(m_ArgumentsNum) * m_Stride; }
+
+		const DRAW_INDEXED_ARGUMENTS& GetDrawIndexed(uint32_t InArgumentIdx) const { return reinterpret_cast<const DRAW_INDEXED_ARGUMENTS*>(m_Data.data())[InArgumentIdx]; }
+
+		const DISPATCH_ARGUMENTS& GetDispatch(uint32_t InArgumentIdx) const { return reinterpret_cast<const DISPATCH_ARGUMENTS*>(m_Data.data())[InArgumentIdx]; }
+
+	private:
+		void AddArguments(const uint32_t* InValues);
+
+		INDIRECT_ARGUMENT_TYPE m_ArgumentType;
+		uint32_t m_Stride;
+		uint32_t m_ValuesPerArgument;
+
+		// Arguments packed one after the other, all their fields are 32 bit values
+		std::vector<uint32_t> m_Data;
+		uint32_t m_ArgumentsNum = 0;
+		uint32_t m_RejectedArgumentsNum = 0;
+	};
+
+} }
+
+#endif // IndirectArguments_h__
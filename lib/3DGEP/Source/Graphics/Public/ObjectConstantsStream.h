@@ -0,0 +1,81 @@
+/*
+ ObjectConstantsStream.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef ObjectConstantsStream_h__
+#define ObjectConstantsStream_h__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GEPUtils { namespace Graphics {
+
+	class CommandList;
+
+	// Constants of all the objects drawn in a frame (e.g. their MVP matrices), packed one after the other in a single frame memory allocation,
+	// bound as root SRV. Objects are written straight into the mapped upload memory, there is no CPU side copy.
+	// Each draw then only sets the index of its object, as a single 32 bit root constant, instead of all the object constants. Shader side:
+	//     struct ObjectConstants { float4x4 Mvp; };
+	//     StructuredBuffer<ObjectConstants> Objects : register(t0);
+	//     cbuffer DrawCB : register(b0) { uint ObjectIdx; };
+	// with the resource binder params initialized with InitAsRootSRV(0) and InitAsConstants(1, 0).
+	// Note: structured buffer elements are tightly packed (there is no 16 bytes register alignment as for constant buffers),
+	// so the HLSL struct needs to have the same layout as the C++ one, with a size multiple of 4 bytes. Matrices are column major in both HLSL and Eigen.
+	class ObjectConstantsStream {
+	public:
+		// Returned for objects that do not fit in the frame reservation, nothing is written for them and they cannot be drawn
+		static constexpr uint32_t INVALID_OBJECT_IDX = 0xffffffff;
+
+		explicit ObjectConstantsStream(uint32_t InObjectStride);
+
+		// Removes the objects of the previous frame and reserves frame memory for up to InMaxObjectsNum objects.
+		// Note: needs to be called every frame after the graphics allocator started it, since frame memory is reused once the GPU completed the frame.
+		void BeginFrame(uint32_t InMaxObjectsNum);
+
+		// Same as above, with memory reserved by the caller for at least InMaxObjectsNum objects, mapped at InMappedData and read by the GPU at InGpuAddress
+		void BeginFrame(uint32_t InMaxObjectsNum, void* InMappedData, uint64_t InGpuAddress);
+
+		// Copies InObjectStride bytes, returns the index the shader needs to read them.
+		// Returns INVALID_OBJECT_IDX when the object exceeds the ones reserved with BeginFrame(..), callers need to check it before drawing.
+		uint32_t AddObject(const void* InConstants);
+
+		// Reserves the constants of a new object, to be written in place
+		void* AllocateObject(uint32_t& OutObjectIdx);
+
+		// Reserves the constants of InObjectsNum consecutive objects, to be written in place (e.g. by TransformSystem::ComputeMatrices(..)).
+		// Returns null, with OutFirstObjectIdx set to INVALID_OBJECT_IDX and no object reserved, when the objects exceed the ones reserved with BeginFrame(..).
+		// Note: the pointer is in write-combined upload memory, it should only be written sequentially and never read.
+		void* AllocateObjects(uint32_t InObjectsNum, uint32_t& OutFirstObjectIdx);
+
+		// Binds the frame objects to the given root SRV of the graphics resource binder.
+		// Objects added after this call are read by the GPU as well, as long as they are written before the command list is executed.
+		void Bind(GEPUtils::Graphics::CommandList& InCmdList, uint32_t InRootIdx) const;
+
+		// Selects the object read by the next draws
+		static void SetObjectIndex(GEPUtils::Graphics::CommandList& InCmdList, uint32_t InRootIdx, uint32_t InObjectIdx);
+
+		uint32_t GetObjectStride() const { return m_ObjectStride; }
+
+		uint32_t GetObjectsNum() const { return m_ObjectsNum; }
+
+		uint32_t GetMaxObjectsNum() const { return m_MaxObjectsNum; }
+
+		size_t GetDataSize() const { return static_cast<size_t>(m_ObjectsNum) * m_ObjectStride; }
+
+	private:
+		uint32_t m_ObjectStride;
+		uint32_t m_ObjectsNum = 0;
+		uint32_t m_MaxObjectsNum = 0;
+
+		// Frame memory reserved by BeginFrame(..)
+		uint8_t* m_MappedData = nullptr;
+		uint64_t m_GpuAddress = 0;
+	};
+
+} }
+
+#endif // ObjectConstantsStream_h__
@@ -0,0 +1,36 @@
+/*
+ PipelineDescKey.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef PipelineDescKey_h__
+#define PipelineDescKey_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GEPUtils { namespace Graphics {
+
+	// Identifies a pipeline related description (pipeline state or resource binder) by a canonical serialization of its content.
+	// The hash of the serialized bytes is only used to find candidates: two keys are equal only when the whole descriptions are,
+	// so a hash collision cannot return the object of another description.
+	// The serialization only depends on the described content, it is stable between runs and can be stored on disk.
+	struct PipelineDescKey {
+		uint64_t m_Hash = 0;
+		std::vector<uint8_t> m_Desc;
+
+		bool operator==(const PipelineDescKey& InOther) const { return m_Hash == InOther.m_Hash && m_Desc == InOther.m_Desc; }
+		bool operator!=(const PipelineDescKey& InOther) const { return !(*this == InOther); }
+	};
+
+	struct PipelineDescKeyHasher {
+		size_t operator()(const PipelineDescKey& InKey) const { return static_cast<size_t>(InKey.m_Hash); }
+	};
+
+} }
+
+#endif // PipelineDescKey_h__
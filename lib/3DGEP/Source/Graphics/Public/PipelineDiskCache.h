@@ -0,0 +1,142 @@
+/*
+ PipelineDiskCache.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef PipelineDiskCache_h__
+#define PipelineDiskCache_h__
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "GEPUtilsMappedFile.h"
+#include "PipelineDescKey.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	enum class PIPELINE_CACHE_ENTRY_TYPE : uint32_t {
+		ROOT_SIGNATURE = 0, // Serialized root signature, keyed by resource binder description
+		PIPELINE_STATE // Compiled pipeline state blob from the driver, keyed by pipeline state description
+	};
+
+	// Key of an entry in the cache file, it depends only on the entry type and the description hash.
+	// Note: entries also store the whole description, that is compared on lookup, so descriptions with colliding hashes never share a blob.
+	uint64_t ComputePipelineCacheKey(PIPELINE_CACHE_ENTRY_TYPE InType, uint64_t InDescHash);
+
+	// --- File format ---
+	// Header, followed by the table of entries sorted by key, followed by the descriptions and the blobs.
+	// All the fields are fixed size and stored little endian, so the file can be written and validated by any platform,
+	// while the blobs content is only meaningful to the graphics API and device that produced them.
+	struct PIPELINE_CACHE_FILE_HEADER {
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t DeviceIdentityHash; // Files written with a different adapter or driver are discarded
+		uint32_t EntriesNum;
+		uint32_t Padding;
+		uint64_t TableHash; // Hash of the entries table, detects truncated or corrupted files
+	};
+
+	struct PIPELINE_CACHE_FILE_ENTRY {
+		uint64_t Key;
+		uint64_t DescHash;
+		PIPELINE_CACHE_ENTRY_TYPE Type;
+		uint32_t Padding;
+		uint64_t DescOffset; // From the beginning of the file, the description the blob was created from (see PipelineDescKey)
+		uint64_t DescSize;
+		uint64_t BlobOffset; // From the beginning of the file
+		uint64_t BlobSize;
+		uint64_t BlobHash;
+	};
+
+	static constexpr uint32_t g_PipelineCacheFileMagic = 0x43504547; // "GEPC"
+	static constexpr uint32_t g_PipelineCacheFileVersion = 2;
+
+	// Cache of pipeline related blobs stored on disk, to avoid serializing root signatures and compiling pipeline states again at startup.
+	// The file is memory mapped when loaded: only the header and the entries table are validated right away,
+	// each blob is validated (against its hash) the first time it is requested.
+	// Entries are invalidated when the whole file comes from another device or driver, when a blob is corrupted,
+	// or when the graphics API rejects a blob (e.g. after a driver update that kept the same identity).
+	// Invalidated entries are not written back by Save(..).
+	// Find, Store and Invalidate can be called from any thread (pipeline states can compile on worker threads),
+	// Load and Save need no other thread to be using the cache.
+	class PipelineDiskCache {
+	public:
+		PipelineDiskCache() = default;
+
+		PipelineDiskCache(const PipelineDiskCache&) = delete;
+		PipelineDiskCache& operator= (const PipelineDiskCache&) = delete;
+
+		// Maps the cache file. InDeviceIdentityHash identifies the adapter and driver the blobs will be used with.
+		// Returns false (with an empty cache) if the file does not exist, is invalid, or belongs to another device.
+		bool Load(const std::string& InFilePath, uint64_t InDeviceIdentityHash);
+
+		// Outputs a blob valid until Save(..) or Load(..) are called again. Returns false if not present, invalid, or stored for another description.
+		bool Find(PIPELINE_CACHE_ENTRY_TYPE InType, const GEPUtils::Graphics::PipelineDescKey& InDescKey, const void*& OutBlob, size_t& OutBlobSize);
+
+		// Adds a new blob, the data is copied. Replaces any previous entry with the same key, also when its description collided with this one.
+		void Store(PIPELINE_CACHE_ENTRY_TYPE InType, const GEPUtils::Graphics::PipelineDescKey& InDescKey, const void* InBlob, size_t InBlobSize);
+
+		// Removes an entry whose blob was rejected by the graphics API
+		void Invalidate(PIPELINE_CACHE_ENTRY_TYPE InType, const GEPUtils::Graphics::PipelineDescKey& InDescKey);
+
+		// Writes loaded (still valid) and stored entries to the file, which then replaces the loaded one.
+		// Blobs previously returned by Find(..) are not valid anymore.
+		bool Save(const std::string& InFilePath);
+
+		// Same as Save(..) but to memory, with the file layout
+		void Serialize(std::vector<uint8_t>& OutFileData) const;
+
+		size_t GetLoadedEntriesNum() const { return m_LoadedEntriesNum; }
+
+		size_t GetEntriesNum();
+
+		uint32_t GetHitsNum() const { return m_HitsNum; }
+
+		uint32_t GetMissesNum() const { return m_MissesNum; }
+
+		uint32_t GetInvalidatedEntriesNum() const { return m_InvalidatedEntriesNum; }
+
+	private:
+		const PIPELINE_CACHE_FILE_ENTRY* FindLoadedEntry(uint64_t InKey) const;
+
+		void ResetLoadedFile();
+
+		void InvalidateKey(uint64_t InKey);
+
+		void SerializeInternal(std::vector<uint8_t>& OutFileData) const;
+
+		// Guards the entries, not the loaded file itself
+		mutable std::mutex m_Mutex;
+
+		GEPUtils::MappedFile m_MappedFile;
+		uint64_t m_DeviceIdentityHash = 0;
+
+		// Points to the table in the mapped file
+		const PIPELINE_CACHE_FILE_ENTRY* m_LoadedEntries = nullptr;
+		size_t m_LoadedEntriesNum = 0;
+
+		// Loaded entries already checked against their hash, and the ones not to be used anymore
+		std::unordered_set<uint64_t> m_ValidatedKeys;
+		std::unordered_set<uint64_t> m_InvalidatedKeys;
+
+		struct StoredEntry {
+			GEPUtils::Graphics::PipelineDescKey m_DescKey;
+			PIPELINE_CACHE_ENTRY_TYPE m_Type;
+			std::vector<uint8_t> m_Blob;
+		};
+		std::unordered_map<uint64_t, StoredEntry> m_StoredEntries;
+
+		uint32_t m_HitsNum = 0;
+		uint32_t m_MissesNum = 0;
+		uint32_t m_InvalidatedEntriesNum = 0;
+	};
+
+} }
+
+#endif // PipelineDiskCache_h__
@@ -29,12 +29,17 @@ public:
 		struct LayoutElement {
 			std::string m_Name;
 			BUFFER_FORMAT m_Format;
+			// Vertex buffer slot the element is read from, see CommandList::SetVertexBuffer(..)
+			uint32_t m_InputSlot = 0;
+			// 0 for per-vertex data, otherwise the element advances once every m_InstanceStepRate instances
+			uint32_t m_InstanceStepRate = 0;
+			// Distinguishes elements sharing the same name (e.g. the rows of a per-instance matrix)
+			uint32_t m_SemanticIndex = 0;
 		};
 		std::vector<LayoutElement> LayoutElements;
 	};
 	// Abstraction of root signature parameter desc
 	struct RESOURCE_BINDER_PARAM {
-		// TODO create support for root descriptors
 		void InitAsConstants(uint32_t InNum32BitValues, uint32_t InShaderRegister, uint32_t InRegisterSpace = 0, GEPUtils::Graphics::SHADER_VISIBILITY InShaderVisibility = SHADER_VISIBILITY::SV_ALL)
 		{
 			Num32BitValues = InNum32BitValues;
@@ -71,16 +76,73 @@ public:
 			shaderVisibility = InShaderVisibility;
 		}
 
+		// Root descriptors reference a buffer directly by GPU address, so binding them does not need any descriptor to be created or copied.
+		// Note: they can only reference buffers (raw or structured for SRVs and UAVs), the address is set with CommandList::SetGraphicsRootConstantBuffer(..) and similar.
+		void InitAsRootCBV(uint32_t InShaderRegister, uint32_t InRegisterSpace = 0, GEPUtils::Graphics::SHADER_VISIBILITY InShaderVisibility = SHADER_VISIBILITY::SV_ALL)
+		{
+			ShaderRegister = InShaderRegister;
+			RegisterSpace = InRegisterSpace;
+			ResourceType = RESOURCE_TYPE::ROOT_CBV;
+			shaderVisibility = InShaderVisibility;
+		}
+
+		void InitAsRootSRV(uint32_t InShaderRegister, uint32_t InRegisterSpace = 0, GEPUtils::Graphics::SHADER_VISIBILITY InShaderVisibility = SHADER_VISIBILITY::SV_ALL)
+		{
+			ShaderRegister = InShaderRegister;
+			RegisterSpace = InRegisterSpace;
+			ResourceType = RESOURCE_TYPE::ROOT_SRV;
+			shaderVisibility = InShaderVisibility;
+		}
+
+		void InitAsRootUAV(uint32_t InShaderRegister, uint32_t InRegisterSpace = 0, GEPUtils::Graphics::SHADER_VISIBILITY InShaderVisibility = SHADER_VISIBILITY::SV_ALL)
+		{
+			ShaderRegister = InShaderRegister;
+			RegisterSpace = InRegisterSpace;
+			ResourceType = RESOURCE_TYPE::ROOT_UAV;
+			shaderVisibility = InShaderVisibility;
+		}
+
 		uint32_t Num32BitValues = 0; uint32_t ShaderRegister = 0; uint32_t RegisterSpace = 0; uint32_t NumDescriptors = 0;
 
 		enum class RESOURCE_TYPE {
 			CONSTANTS,
 			CBV_RANGE,
 			SRV_RANGE,
-			UAV_RANGE
+			UAV_RANGE,
+			ROOT_CBV,
+			ROOT_SRV,
+			ROOT_UAV
 		} ResourceType = RESOURCE_TYPE::CONSTANTS;
 		
 		SHADER_VISIBILITY shaderVisibility;
+
+		// How often the bound data changes, from the most to the least frequent.
+		// It only affects the position of the parameter when the layout gets optimized (see ResourceBinderLayout.h), not the parameter itself.
+		enum class UPDATE_FREQUENCY {
+			PER_DRAW,
+			PER_MATERIAL,
+			PER_PASS,
+			PER_FRAME,
+			STATIC
+		} UpdateFrequency = UPDATE_FREQUENCY::PER_DRAW;
+
+		// Volatility hints, letting the driver optimize how descriptors and the data they point to are fetched (e.g. preloading static data).
+		// Data volatility applies to descriptor ranges and root descriptors, from when they are bound until the command list finishes executing:
+		// DEFAULT keeps the platform default (static while set at execute, volatile for UAVs), STATIC promises the data never changes once bound,
+		// VOLATILE allows it to change at any time (e.g. written by the GPU in a previous dispatch of the same command list).
+		enum class DATA_VOLATILITY {
+			DEFAULT,
+			STATIC,
+			STATIC_WHILE_SET_AT_EXECUTE,
+			VOLATILE
+		} DataVolatility = DATA_VOLATILITY::DEFAULT;
+
+		// Only applies to descriptor ranges: VOLATILE descriptors can be changed in the descriptor heap after the table is bound.
+		// Note: volatile descriptors cannot be combined with static data.
+		enum class DESCRIPTOR_VOLATILITY {
+			STATIC,
+			VOLATILE
+		} DescriptorVolatility = DESCRIPTOR_VOLATILITY::STATIC;
 	};
 
 	enum RESOURCE_BINDER_FLAGS : uint32_t {
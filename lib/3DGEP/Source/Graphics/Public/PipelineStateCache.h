@@ -0,0 +1,88 @@
+/*
+ PipelineStateCache.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef PipelineStateCache_h__
+#define PipelineStateCache_h__
+
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include "PipelineState.h"
+#include "PipelineDescKey.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Keys of pipeline state descriptions: they only depend on the described content (shaders are identified by bytecode hash),
+	// so identical descriptions produce the same key even when built from different objects.
+	GEPUtils::Graphics::PipelineDescKey MakeResourceBinderDescKey(const GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_DESC& InDesc);
+
+	GEPUtils::Graphics::PipelineDescKey MakePipelineStateDescKey(const GEPUtils::Graphics::PipelineState::GRAPHICS_PSO_DESC& InDesc);
+
+	GEPUtils::Graphics::PipelineDescKey MakePipelineStateDescKey(const GEPUtils::Graphics::PipelineState::COMPUTE_PSO_DESC& InDesc);
+
+	// Handle to a pipeline state that could still be compiling on a worker thread.
+	// Copies of the handle refer to the same pipeline state.
+	class AsyncPipelineState {
+	public:
+		AsyncPipelineState() = default;
+
+		explicit AsyncPipelineState(std::shared_future<GEPUtils::Graphics::PipelineState*> InFuture) : m_Future(std::move(InFuture)) { }
+
+		// Handle to an already initialized pipeline state
+		static AsyncPipelineState MakeReady(GEPUtils::Graphics::PipelineState& InPipelineState);
+
+		bool IsValid() const { return m_Future.valid(); }
+
+		// Does not block
+		bool IsReady() const;
+
+		// Does not block, returns null while the pipeline state is compiling, so draws can be skipped or use a fallback
+		GEPUtils::Graphics::PipelineState* GetIfReady() const;
+
+		// Blocks until the pipeline state is compiled. Rethrows the errors happened during compilation.
+		GEPUtils::Graphics::PipelineState& Wait() const;
+
+	private:
+		std::shared_future<GEPUtils::Graphics::PipelineState*> m_Future;
+	};
+
+	// Compiled and compiling pipeline states by description key.
+	// Note: pipeline states are owned by the graphics allocator, the cache only references them.
+	// All the methods can be called from any thread.
+	class PipelineStateCache {
+	public:
+		PipelineStateCache() = default;
+
+		PipelineStateCache(const PipelineStateCache&) = delete;
+		PipelineStateCache& operator= (const PipelineStateCache&) = delete;
+
+		// Returns null if the pipeline state was never requested or is still compiling
+		GEPUtils::Graphics::PipelineState* Find(const GEPUtils::Graphics::PipelineDescKey& InDescKey);
+
+		// Returns the compiled or compiling pipeline state with the given key. If there is none, InNewRequest gets registered for the key,
+		// it is returned and OutIsNew is set to true: the caller is then responsible for compiling the pipeline state.
+		// This way concurrent requests of the same description compile only once.
+		GEPUtils::Graphics::AsyncPipelineState FindOrAdd(const GEPUtils::Graphics::PipelineDescKey& InDescKey, const GEPUtils::Graphics::AsyncPipelineState& InNewRequest, bool& OutIsNew);
+
+		size_t GetPipelineStatesNum();
+
+		// Number of requests that found an already existing (or compiling) pipeline state
+		uint64_t GetHitsNum();
+
+	private:
+		std::mutex m_Mutex;
+
+		std::unordered_map<GEPUtils::Graphics::PipelineDescKey, GEPUtils::Graphics::AsyncPipelineState, GEPUtils::Graphics::PipelineDescKeyHasher> m_PipelineStates;
+
+		uint64_t m_HitsNum = 0;
+	};
+
+} }
+
+#endif // PipelineStateCache_h__
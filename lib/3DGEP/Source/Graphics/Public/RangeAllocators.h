@@ -37,7 +37,17 @@ namespace GEPUtils { namespace Graphics {
 
 		virtual uint32_t AllocateRange(uint32_t InRangeSize);
 
+		// Same as AllocateRange(..) but for callers that can handle running out of space (e.g. for fragmentation):
+		// returns false, leaving the free ranges untouched, if there is no free range big enough.
+		bool TryAllocateRange(uint32_t InRangeSize, uint32_t& OutRangeOffset);
+
+		// Same as AllocateRange(..) but the returned offset will be a multiple of InAlignment
+		uint32_t AllocateAlignedRange(uint32_t InRangeSize, uint32_t InAlignment);
+
 		virtual void FreeAllocatedRange(uint32_t InRangeOffset, uint32_t InRangeSize);
+
+		// Number of not contiguous free ranges, useful to measure fragmentation
+		size_t GetFreeRangesNum() const { return m_FreeRangesByOffset.size(); }
 protected:
 		StaticRangeAllocator() = default;
 		// No copies, only moves are allowed
@@ -0,0 +1,244 @@
+/*
+ RenderGraph.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef RenderGraph_h__
+#define RenderGraph_h__
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "GraphicsTypes.h"
+#include "ResourceStateTracker.h"
+#include "TransientAliasingPlanner.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	class CommandList;
+	class RenderGraph;
+
+	struct RenderGraphResourceHandle {
+		uint32_t m_Index = 0xffffffff;
+		bool IsValid() const { return m_Index != 0xffffffff; }
+	};
+
+	struct RenderGraphPassHandle {
+		uint32_t m_Index = 0xffffffff;
+		bool IsValid() const { return m_Index != 0xffffffff; }
+	};
+
+	// Texture owned by the render graph, it will be allocated only if used by a pass that is not culled
+	struct RENDER_GRAPH_TEXTURE_DESC {
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		GEPUtils::Graphics::TEXTURE_TYPE Type = GEPUtils::Graphics::TEXTURE_TYPE::TEX_2D;
+		GEPUtils::Graphics::BUFFER_FORMAT Format = GEPUtils::Graphics::BUFFER_FORMAT::R8G8B8A8_UNORM;
+		uint32_t ArraySize = 1;
+		uint32_t MipLevels = 1;
+		GEPUtils::Graphics::RESOURCE_FLAGS Flags = GEPUtils::Graphics::RESOURCE_FLAGS::NONE;
+	};
+
+	// Buffer owned by the render graph, it will be allocated only if used by a pass that is not culled
+	struct RENDER_GRAPH_BUFFER_DESC {
+		size_t Size = 0;
+		GEPUtils::Graphics::RESOURCE_FLAGS Flags = GEPUtils::Graphics::RESOURCE_FLAGS::NONE;
+	};
+
+	struct RENDER_GRAPH_TRANSITION {
+		RenderGraphResourceHandle m_Resource;
+		uint32_t m_Subresource;
+		GEPUtils::Graphics::RESOURCE_STATE m_StateAfter;
+	};
+
+	// Positions in the execution order of the first and last passes using a resource
+	struct RenderGraphResourceLifetime {
+		uint32_t m_FirstPassPos = 0xffffffff;
+		uint32_t m_LastPassPos = 0;
+		bool IsValid() const { return m_FirstPassPos <= m_LastPassPos; }
+		bool Overlaps(const RenderGraphResourceLifetime& InOther) const { return m_FirstPassPos <= InOther.m_LastPassPos && InOther.m_FirstPassPos <= m_LastPassPos; }
+	};
+
+	// Used by passes, during their setup, to declare which resources they are going to use and how
+	class RenderGraphPassBuilder {
+	public:
+		void Read(RenderGraphResourceHandle InResource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresource = GEPUtils::Graphics::ALL_SUBRESOURCES);
+
+		void Write(RenderGraphResourceHandle InResource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresource = GEPUtils::Graphics::ALL_SUBRESOURCES);
+
+		// Passes with side effects (e.g. writing to memory not described by the graph) are never culled
+		void SetHasSideEffects();
+
+	private:
+		friend class RenderGraph;
+		RenderGraphPassBuilder(RenderGraph& InRenderGraph, uint32_t InPassIdx) : m_RenderGraph(InRenderGraph), m_PassIdx(InPassIdx) { }
+
+		RenderGraph& m_RenderGraph;
+		uint32_t m_PassIdx;
+	};
+
+	// Describes a frame as a list of passes, each declaring the resources it reads and writes.
+	// Compile() culls the passes not contributing to any output, computes the transitions each pass needs before executing
+	// and the lifetime of each transient resource. Compiling is pure CPU work, it does not need a device or a command list.
+	// Execute(..) allocates the transient resources and records the passes, in order, in a command list.
+	// Note: passes execute in the order they are added, so a pass can only read what previous passes wrote.
+	// Transient resources are placed in heaps owned by the graph, and resources with non-overlapping lifetimes share the same memory.
+	// The first pass using a transient resource needs to fully write it (e.g. clear it) since its content is undefined.
+	class RenderGraph {
+	public:
+		using SetupFnType = std::function<void(RenderGraphPassBuilder&)>;
+		using ExecuteFnType = std::function<void(GEPUtils::Graphics::CommandList&, RenderGraph&)>;
+
+		RenderGraph() = default;
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator= (const RenderGraph&) = delete;
+
+		// Resources created outside the graph, they will be left in the state the last pass using them needs
+		RenderGraphResourceHandle ImportResource(const char* InName, GEPUtils::Graphics::Resource& InResource);
+
+		// Imported resource that needs to be in InFinalState after the graph executed (e.g. a back buffer to present).
+		// Passes writing to output resources are never culled.
+		RenderGraphResourceHandle ImportOutputResource(const char* InName, GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InFinalState);
+
+		RenderGraphResourceHandle CreateTexture(const char* InName, const RENDER_GRAPH_TEXTURE_DESC& InDesc);
+
+		RenderGraphResourceHandle CreateBuffer(const char* InName, const RENDER_GRAPH_BUFFER_DESC& InDesc);
+
+		// InSetupFn is called right away to declare the resources used by the pass, InExecuteFn will be called during Execute(..) if the pass is not culled
+		RenderGraphPassHandle AddPass(const char* InName, const SetupFnType& InSetupFn, ExecuteFnType InExecuteFn);
+
+		void Compile();
+
+		void Execute(GEPUtils::Graphics::CommandList& InCmdList);
+
+		// Removes all the passes and resources, to be called before describing a new frame.
+		// Transient resources allocated so far are kept, to be reused by the next frames.
+		void Reset();
+
+		// Only valid during the execution of the graph, for transient resources
+		GEPUtils::Graphics::Resource& GetResource(RenderGraphResourceHandle InResource);
+
+		// --- Compilation results ---
+
+		const std::vector<uint32_t>& GetExecutionOrder() const { return m_ExecutionOrder; }
+
+		bool IsPassCulled(RenderGraphPassHandle InPass) const { return m_Passes[InPass.m_Index].m_IsCulled; }
+
+		// Transitions to submit right before executing the pass
+		const std::vector<RENDER_GRAPH_TRANSITION>& GetPassTransitions(RenderGraphPassHandle InPass) const { return m_Passes[InPass.m_Index].m_Transitions; }
+
+		// Transitions to submit after the last pass, to bring output resources to their final state
+		const std::vector<RENDER_GRAPH_TRANSITION>& GetFinalTransitions() const { return m_FinalTransitions; }
+
+		RenderGraphResourceLifetime GetResourceLifetime(RenderGraphResourceHandle InResource) const { return m_Resources[InResource.m_Index].m_Lifetime; }
+
+		uint32_t GetTransitionsNum() const;
+
+		uint32_t GetPassesNum() const { return static_cast<uint32_t>(m_Passes.size()); }
+
+		uint32_t GetResourcesNum() const { return static_cast<uint32_t>(m_Resources.size()); }
+
+		bool IsTransient(RenderGraphResourceHandle InResource) const { return m_Resources[InResource.m_Index].m_Type != RESOURCE_NODE_TYPE::IMPORTED; }
+
+		// Heap memory used by the transient resources of the last execution, and the memory they would need without aliasing
+		uint64_t GetTransientMemorySize() const { return m_TransientMemorySize; }
+
+		uint64_t GetTransientNonAliasedMemorySize() const { return m_TransientNonAliasedMemorySize; }
+
+	private:
+		friend class RenderGraphPassBuilder;
+
+		enum class RESOURCE_NODE_TYPE {
+			IMPORTED,
+			TRANSIENT_TEXTURE,
+			TRANSIENT_BUFFER
+		};
+
+		struct ResourceAccess {
+			RenderGraphResourceHandle m_Resource;
+			uint32_t m_Subresource;
+			GEPUtils::Graphics::RESOURCE_STATE m_State;
+			bool m_IsWrite;
+		};
+
+		struct PassNode {
+			std::string m_Name;
+			ExecuteFnType m_ExecuteFn;
+			std::vector<ResourceAccess> m_Accesses;
+			std::vector<RENDER_GRAPH_TRANSITION> m_Transitions;
+			// Transient resources starting to use memory previously used by other ones, that need an aliasing barrier before the pass
+			std::vector<RenderGraphResourceHandle> m_AliasedResources;
+			// Transient render target and depth stencil textures starting their lifetime in the pass, that need to be initialized before their first use
+			std::vector<RenderGraphResourceHandle> m_DiscardedResources;
+			bool m_HasSideEffects = false;
+			bool m_IsCulled = false;
+		};
+
+		struct ResourceNode {
+			std::string m_Name;
+			RESOURCE_NODE_TYPE m_Type;
+			GEPUtils::Graphics::Resource* m_Resource = nullptr;
+			bool m_IsOutput = false;
+			GEPUtils::Graphics::RESOURCE_STATE m_FinalState = GEPUtils::Graphics::RESOURCE_STATE::PRESENT;
+			RENDER_GRAPH_TEXTURE_DESC m_TextureDesc;
+			RENDER_GRAPH_BUFFER_DESC m_BufferDesc;
+			uint32_t m_SubresourcesNum = 1;
+			RenderGraphResourceLifetime m_Lifetime;
+		};
+
+		// Placed resource created for a transient resource. Allocations are reused by the next frames
+		// as long as the transient resources keep the same descriptions and lifetimes, otherwise memory gets planned again.
+		struct TransientAllocation {
+			RESOURCE_NODE_TYPE m_Type;
+			RENDER_GRAPH_TEXTURE_DESC m_TextureDesc;
+			RENDER_GRAPH_BUFFER_DESC m_BufferDesc;
+			RenderGraphResourceLifetime m_Lifetime;
+			GEPUtils::Graphics::RESOURCE_HEAP_USAGE m_HeapUsage;
+			GEPUtils::Graphics::Resource* m_Resource = nullptr;
+			bool m_IsAliasing = false;
+		};
+
+		static constexpr uint32_t HEAP_USAGES_NUM = 3;
+
+		void AddAccess(uint32_t InPassIdx, RenderGraphResourceHandle InResource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresource, bool InIsWrite);
+
+		void CullPasses();
+
+		void ComputeLifetimes();
+
+		void ComputeTransitions();
+
+		void AllocateTransientResources();
+
+		void PlanTransientAllocations();
+
+		std::vector<PassNode> m_Passes;
+		std::vector<ResourceNode> m_Resources;
+
+		// Not culled passes, in the order they will execute
+		std::vector<uint32_t> m_ExecutionOrder;
+		std::vector<RENDER_GRAPH_TRANSITION> m_FinalTransitions;
+
+		// Allocations of the used transient resources, in resource creation order
+		std::vector<TransientAllocation> m_TransientAllocations;
+
+		// One heap for each RESOURCE_HEAP_USAGE, replaced by a bigger one when a new plan does not fit.
+		// Note: replaced heaps and placed resources are released to the graphics allocator, that destroys them once previous frames cannot use them anymore.
+		GEPUtils::Graphics::ResourceHeap* m_TransientHeaps[HEAP_USAGES_NUM] = {};
+
+		GEPUtils::Graphics::TransientAliasingPlanner m_AliasingPlanner;
+
+		uint64_t m_TransientMemorySize = 0;
+		uint64_t m_TransientNonAliasedMemorySize = 0;
+
+		bool m_IsCompiled = false;
+	};
+
+} }
+
+#endif // RenderGraph_h__
@@ -0,0 +1,53 @@
+/*
+ ResourceBinderLayout.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef ResourceBinderLayout_h__
+#define ResourceBinderLayout_h__
+
+#include <cstdint>
+#include <vector>
+#include "PipelineState.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Resource binders (root signatures in D3D12) can take at most 64 DWORDs.
+	// Each 32 bit root constant costs 1 DWORD, each descriptor table costs 1 DWORD, each root descriptor costs 2 DWORDs. Static samplers are free.
+	static constexpr uint32_t g_ResourceBinderMaxDwordsNum = 64;
+
+	uint32_t GetResourceBinderParamCost(const GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_PARAM& InParam);
+
+	uint32_t GetResourceBinderCost(const GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_DESC& InDesc);
+
+	enum RESOURCE_BINDER_LAYOUT_FLAGS : uint32_t {
+		RBL_NONE = 0,
+		// Parameters that change more often go first, changing them is cheaper on some hardware (parameters of the same frequency keep their order)
+		RBL_SORT_BY_UPDATE_FREQUENCY = 0x1,
+		// When over budget, constants parameters become root constant buffer views, the biggest ones first, until the layout fits.
+		// Without this flag the conversions are only suggested in the result.
+		RBL_CONVERT_CONSTANTS_OVER_BUDGET = 0x2
+	};
+	DEFINE_OPERATORS_FOR_ENUM(RESOURCE_BINDER_LAYOUT_FLAGS)
+
+	struct RESOURCE_BINDER_LAYOUT {
+		// New index of each parameter, indexed by its position in the description before the layout pass.
+		// Callers need to use these indices when binding resources to the pipeline.
+		std::vector<uint32_t> RootIndexRemap;
+		// Parameters (by original position) that need to become root constant buffer views to fit the budget.
+		// When converted, the shader code stays the same but the data has to be bound by GPU address (e.g. with CommandList::StoreAndSetDynamicRootConstantBuffer(..)) instead of root constants.
+		std::vector<uint32_t> ConstantsToConvert;
+		bool AreConstantsConverted = false;
+		uint32_t DwordsNum = 0;
+	};
+
+	// Validates the cost of InOutDesc and applies the requested layout changes to it.
+	// Returns false if the resulting layout is still over budget.
+	bool OptimizeResourceBinderLayout(GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_DESC& InOutDesc, RESOURCE_BINDER_LAYOUT_FLAGS InFlags, RESOURCE_BINDER_LAYOUT& OutLayout);
+
+} }
+
+#endif // ResourceBinderLayout_h__
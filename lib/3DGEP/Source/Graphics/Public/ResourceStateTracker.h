@@ -0,0 +1,134 @@
+/*
+ ResourceStateTracker.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef ResourceStateTracker_h__
+#define ResourceStateTracker_h__
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "GraphicsTypes.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Used as subresource index to target all the subresources of a resource at once
+	static constexpr uint32_t ALL_SUBRESOURCES = 0xffffffff;
+
+	// Subresources are indexed first by mip level and then by array slice (same convention used by D3D12)
+	inline uint32_t ComputeSubresourceIndex(uint32_t InMipSlice, uint32_t InArraySlice, uint32_t InMipLevelsNum) { return InMipSlice + InArraySlice * InMipLevelsNum; }
+
+	struct RESOURCE_TRANSITION {
+		GEPUtils::Graphics::Resource* m_Resource;
+		uint32_t m_Subresource;
+		GEPUtils::Graphics::RESOURCE_STATE m_StateBefore;
+		GEPUtils::Graphics::RESOURCE_STATE m_StateAfter;
+	};
+
+	// States of all the subresources of a resource.
+	// Most of the time all the subresources share the same state, so per-subresource states are stored only when they differ.
+	class SubresourceStates {
+	public:
+		explicit SubresourceStates(GEPUtils::Graphics::RESOURCE_STATE InState) : m_State(InState) { }
+
+		GEPUtils::Graphics::RESOURCE_STATE GetState(uint32_t InSubresource) const;
+
+		void SetState(uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresourcesNum);
+
+		bool IsUniform() const { return m_PerSubresourceStates.empty(); }
+
+		uint32_t GetSubresourcesNum() const { return static_cast<uint32_t>(m_PerSubresourceStates.size()); }
+
+	private:
+		GEPUtils::Graphics::RESOURCE_STATE m_State;
+		std::vector<GEPUtils::Graphics::RESOURCE_STATE> m_PerSubresourceStates;
+	};
+
+	// Holds the state every registered resource will be in once all the command lists submitted so far are executed.
+	// Resources need to be registered with their initial state when they are created.
+	class ResourceStateRegistry {
+	public:
+		static ResourceStateRegistry& Get();
+
+		void RegisterResource(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InInitialState);
+
+		void UnregisterResource(GEPUtils::Graphics::Resource& InResource);
+
+		void Clear();
+
+		bool IsRegistered(GEPUtils::Graphics::Resource& InResource);
+
+		GEPUtils::Graphics::RESOURCE_STATE GetState(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource);
+
+	private:
+		friend class ResourceStateTracker;
+
+		std::mutex m_Mutex;
+		std::unordered_map<GEPUtils::Graphics::Resource*, SubresourceStates> m_States;
+	};
+
+	// Per-command list resource state tracking.
+	// Transitions are requested only with the state a resource needs to be in, the state before is retrieved from the tracked ones.
+	// Barriers are accumulated until FlushResourceBarriers is called on the command list (right before the next draw, dispatch or copy),
+	// and consecutive transitions of the same subresource are merged together (A->B->C becomes A->C, A->B->A gets removed).
+	// The first time a resource is used in a command list its state is not known, because other command lists could be executed before this one:
+	// those transitions are kept pending and resolved against the ResourceStateRegistry when the command list gets submitted for execution.
+	class ResourceStateTracker {
+	public:
+		explicit ResourceStateTracker(ResourceStateRegistry& InRegistry = ResourceStateRegistry::Get());
+
+		ResourceStateTracker(const ResourceStateTracker&) = delete;
+		ResourceStateTracker& operator= (const ResourceStateTracker&) = delete;
+
+		void TransitionResource(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InStateAfter, uint32_t InSubresource = ALL_SUBRESOURCES);
+
+		// Takes the current state of the resource from the registry, if not tracked yet, so that its transitions do not need to be resolved at submission time.
+		// Only valid when no other command list, still to be submitted, uses the resource (e.g. transient resources owned by a render graph).
+		void AcquireResourceState(GEPUtils::Graphics::Resource& InResource);
+
+		// Outputs the state the resource is in at the current point of the command list.
+		// Returns false when it is not known yet (resolved at submission time) or when the subresources are in different states.
+		bool GetTrackedState(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE& OutState) const;
+
+		bool HasBarriersToFlush() const { return !m_Barriers.empty(); }
+
+		const std::vector<RESOURCE_TRANSITION>& GetBarriersToFlush() const { return m_Barriers; }
+
+		// To be called once the barriers returned by GetBarriersToFlush() have been recorded in the command list
+		void OnBarriersFlushed() { m_Barriers.clear(); }
+
+		// To be called when the command list is submitted for execution.
+		// Outputs the barriers that need to be executed right before the command list, to bring the resources used in it from their global state to the expected one,
+		// and then updates the registry with the final states resources will have after the command list is executed.
+		void ResolvePendingTransitions(std::vector<RESOURCE_TRANSITION>& OutBarriers);
+
+		// Forgets all the tracked states, to be called when the command list is reset
+		void Reset();
+
+		size_t GetPendingTransitionsNum() const { return m_PendingTransitions.size(); }
+
+	private:
+		void AddBarrier(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE InStateBefore, GEPUtils::Graphics::RESOURCE_STATE InStateAfter);
+
+		void AddTransitionFromState(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE InStateBefore, GEPUtils::Graphics::RESOURCE_STATE InStateAfter);
+
+		ResourceStateRegistry& m_Registry;
+
+		// Transitions ready to be submitted, with a known state before
+		std::vector<RESOURCE_TRANSITION> m_Barriers;
+
+		// Transitions on resources whose state was unknown, to be resolved at submission time (state before is ignored)
+		std::vector<RESOURCE_TRANSITION> m_PendingTransitions;
+
+		// States resources will be in at the current point of the command list
+		std::unordered_map<GEPUtils::Graphics::Resource*, SubresourceStates> m_FinalStates;
+	};
+
+} }
+
+#endif // ResourceStateTracker_h__
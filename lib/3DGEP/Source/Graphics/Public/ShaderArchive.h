@@ -0,0 +1,114 @@
+/*
+ ShaderArchive.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef ShaderArchive_h__
+#define ShaderArchive_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "GEPUtilsMappedFile.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// --- File format ---
+	// Header, followed by the table of entries sorted by name hash, followed by the names (not null terminated),
+	// followed by the bytecode payloads, each one starting at a 16 bytes aligned offset.
+	// All the fields are fixed size and stored little endian, so archives can be packed and read on any platform.
+	struct SHADER_ARCHIVE_HEADER {
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntriesNum;
+		uint32_t NamesSize;
+		uint64_t TableHash; // Hash of the entries table and the names, detects truncated or corrupted archives
+	};
+
+	struct SHADER_ARCHIVE_ENTRY {
+		uint64_t NameHash;
+		uint64_t BytecodeHash;
+		uint64_t BytecodeOffset; // From the beginning of the file
+		uint64_t BytecodeSize;
+		uint32_t NameOffset; // From the beginning of the names
+		uint32_t NameSize;
+	};
+
+	static constexpr uint32_t g_ShaderArchiveMagic = 0x41534547; // "GESA"
+	static constexpr uint32_t g_ShaderArchiveVersion = 1;
+	static constexpr uint64_t g_ShaderArchivePayloadAlignment = 16;
+
+	// Hash used to sort and search the entries, names are case sensitive and use '/' as separator
+	uint64_t ComputeShaderArchiveNameHash(const char* InName, size_t InNameSize);
+
+	// Collects compiled shaders and lays them out with the archive format.
+	// Shaders with the same bytecode share a single payload.
+	class ShaderArchiveWriter {
+	public:
+		// The bytecode is copied. Returns false if a shader with the same name was already added.
+		bool AddShader(const std::string& InName, const void* InBytecode, size_t InBytecodeSize);
+
+		void Serialize(std::vector<uint8_t>& OutFileData) const;
+
+		bool Save(const std::string& InFilePath) const;
+
+		size_t GetShadersNum() const { return m_Shaders.size(); }
+
+	private:
+		struct PendingShader {
+			std::string m_Name;
+			uint64_t m_NameHash;
+			uint64_t m_BytecodeHash;
+			std::vector<uint8_t> m_Bytecode;
+		};
+
+		std::vector<PendingShader> m_Shaders;
+	};
+
+	// Read-only access to a packed shader archive.
+	// The whole file is memory mapped once when opened and the header, entries table and names are validated right away.
+	// Names are resolved with a binary search over the table, bytecode is returned pointing inside the mapped file,
+	// so it stays valid (and it is paged in by the OS only when read) until the archive is closed.
+	// Payloads are not validated against their hash: the stored hash is returned with them, for the caller to check when needed.
+	// Lookups do not modify the archive and can be done from any thread.
+	class ShaderArchive {
+	public:
+		ShaderArchive() = default;
+
+		ShaderArchive(const ShaderArchive&) = delete;
+		ShaderArchive& operator= (const ShaderArchive&) = delete;
+
+		// Returns false (with the archive closed) if the file does not exist or it is not a valid archive
+		bool Open(const std::string& InFilePath);
+
+		bool Open(const std::wstring& InFilePath);
+
+		void Close();
+
+		bool IsOpen() const { return m_Entries != nullptr; }
+
+		// Returns false if no shader in the archive has the given name
+		bool FindShader(const std::string& InName, const void*& OutBytecode, size_t& OutBytecodeSize, uint64_t& OutBytecodeHash) const;
+
+		size_t GetShadersNum() const { return m_EntriesNum; }
+
+		std::string GetShaderName(size_t InShaderIdx) const;
+
+	private:
+		// Validates the mapped file and points the table and names in it
+		bool ReadMappedFile();
+
+		GEPUtils::MappedFile m_MappedFile;
+
+		const SHADER_ARCHIVE_ENTRY* m_Entries = nullptr;
+		size_t m_EntriesNum = 0;
+		const char* m_Names = nullptr;
+	};
+
+} }
+
+#endif // ShaderArchive_h__
@@ -0,0 +1,100 @@
+/*
+ ShaderBytecodeStore.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef ShaderBytecodeStore_h__
+#define ShaderBytecodeStore_h__
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GraphicsTypes.h"
+#include "GEPUtilsMappedFile.h"
+#include "ShaderArchive.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Compiled shader files, memory mapped instead of read in heap memory.
+	// Each file is identified by a bytecode id: loading the same path again, or a different path with the same content, returns the same id without reading anything.
+	// Bytecode is resident only while acquired (e.g. during pipeline state creation), the file gets unmapped when the last acquire is released.
+	// Shaders resolved from a mounted archive point inside it instead, since the archive stays mapped until the store is destroyed.
+	// All the methods can be called from any thread, since pipeline states can be compiled on worker threads.
+	class ShaderBytecodeStore {
+	public:
+		static constexpr uint32_t INVALID_BYTECODE_ID = 0xffffffff;
+
+		ShaderBytecodeStore() = default;
+
+		ShaderBytecodeStore(const ShaderBytecodeStore&) = delete;
+		ShaderBytecodeStore& operator= (const ShaderBytecodeStore&) = delete;
+
+		// Returns INVALID_BYTECODE_ID if the file cannot be mapped
+		uint32_t LoadBytecode(const std::wstring& InFilePath);
+
+		// Maps a packed shader archive (see ShaderArchive.h). Files loaded from now on with a path inside InMountPath are looked up in the archive first,
+		// with their path relative to InMountPath as name, and loaded from disk only when not packed.
+		// Note: archived bytecode is trusted to match the hash stored in the archive, it is not hashed again when loaded.
+		// Returns false if the archive cannot be opened.
+		bool MountArchive(const std::wstring& InArchivePath, const std::wstring& InMountPath);
+
+		uint64_t GetBytecodeHash(uint32_t InBytecodeId);
+
+		// The returned view does not own the bytecode, it is valid until the matching ReleaseBytecode(..)
+		GEPUtils::Graphics::ShaderBytecodeView AcquireBytecode(uint32_t InBytecodeId);
+
+		void ReleaseBytecode(uint32_t InBytecodeId);
+
+		// Unique bytecodes, files with the same content count once
+		size_t GetBytecodesNum();
+
+		size_t GetResidentBytecodesNum();
+
+	private:
+		struct BytecodeEntry {
+			std::wstring m_FilePath;
+			uint64_t m_Hash = 0;
+			size_t m_Size = 0;
+			// Of the file when the hash was computed, a different one means the content may have changed
+			uint64_t m_LastWriteTime = 0;
+			std::unique_ptr<GEPUtils::MappedFile> m_MappedFile;
+			// Points inside a mounted archive, null for bytecode loaded from its own file
+			const uint8_t* m_ArchivedBytecode = nullptr;
+			uint32_t m_AcquiresNum = 0;
+		};
+
+		struct MountedArchive {
+			std::wstring m_MountPath;
+			std::unique_ptr<GEPUtils::Graphics::ShaderArchive> m_Archive;
+		};
+
+		// Maps the file of the entry if not resident, then counts an acquire
+		bool AcquireEntry(BytecodeEntry& InEntry);
+
+		void ReleaseEntry(BytecodeEntry& InEntry);
+
+		// Only valid while the entry is acquired
+		const uint8_t* GetEntryData(const BytecodeEntry& InEntry) const;
+
+		// Returns null if the file is not inside a mount path or not present in its archive
+		const uint8_t* FindArchivedBytecode(const std::wstring& InFilePath, size_t& OutSize, uint64_t& OutHash) const;
+
+		std::mutex m_Mutex;
+
+		std::vector<BytecodeEntry> m_Entries;
+		std::unordered_map<std::wstring, uint32_t> m_PathToBytecodeId;
+		std::unordered_multimap<uint64_t, uint32_t> m_HashToBytecodeId;
+
+		// Archives are never unmounted, entries keep pointing inside them
+		std::vector<MountedArchive> m_MountedArchives;
+	};
+
+} }
+
+#endif // ShaderBytecodeStore_h__
@@ -0,0 +1,63 @@
+/*
+ TransientAliasingPlanner.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef TransientAliasingPlanner_h__
+#define TransientAliasingPlanner_h__
+
+#include <cstdint>
+#include <vector>
+
+namespace GEPUtils { namespace Graphics {
+
+	// Memory requirements of a transient resource and the positions, in the execution order, of the first and last passes using it
+	struct TRANSIENT_ALLOCATION_DESC {
+		uint64_t Size = 0;
+		uint64_t Alignment = 0;
+		uint32_t FirstPassPos = 0;
+		uint32_t LastPassPos = 0;
+	};
+
+	struct TRANSIENT_PLACEMENT {
+		uint64_t HeapOffset = 0;
+		// True when the assigned memory is shared with other allocations of the plan (used before or after it, also in the next frames),
+		// meaning the resource needs an aliasing barrier before its first use and its initial content is undefined.
+		bool IsAliasing = false;
+	};
+
+	// Assigns heap offsets to transient resources so that resources with non-overlapping lifetimes share the same memory.
+	// Resources are visited by first use: the ones that are not used anymore give their memory back, then the new resource takes the best fitting free range.
+	// Offsets are handled by a StaticRangeAllocator in units of InAllocationGranularity bytes (the smallest placement alignment, 64KB in D3D12),
+	// so sizes are rounded up to that granularity.
+	// Planning is pure CPU work, it does not need a device.
+	class TransientAliasingPlanner {
+	public:
+		explicit TransientAliasingPlanner(uint64_t InAllocationGranularity = 64 * 1024);
+
+		void Plan(const std::vector<TRANSIENT_ALLOCATION_DESC>& InAllocations, std::vector<TRANSIENT_PLACEMENT>& OutPlacements);
+
+		// Size the heap needs to have to contain all the placements of the last plan
+		uint64_t GetHeapSize() const { return m_HeapSize; }
+
+		// Memory the resources of the last plan would need without aliasing, to measure the savings
+		uint64_t GetNonAliasedSize() const { return m_NonAliasedSize; }
+
+	private:
+		uint64_t m_AllocationGranularity;
+		uint64_t m_HeapSize = 0;
+		uint64_t m_NonAliasedSize = 0;
+
+		// Kept between plans to avoid allocations
+		std::vector<uint32_t> m_SortedAllocations;
+		std::vector<uint32_t> m_ActiveAllocations;
+		std::vector<uint32_t> m_AllocatedOffsets;
+		std::vector<uint32_t> m_AllocatedSizes;
+	};
+
+} }
+
+#endif // TransientAliasingPlanner_h__
@@ -23,13 +23,23 @@ namespace GEPUtils { namespace Graphics {
 
 	uint32_t StaticRangeAllocator::AllocateRange(uint32_t InRangeSize)
 	{
-		// Find a range big enough to contain the range
-		auto freeRangesIt = m_FreeRangesBySize.lower_bound(InRangeSize); //lower_bound returns an iterator with the first element Not less than the given key
-		if (freeRangesIt == m_FreeRangesBySize.end()) {
+		uint32_t rangeOffset = 0;
+		if (!TryAllocateRange(InRangeSize, rangeOffset))
+		{
 			StopForFail("[StaticRangeAllocator] Not enough free spaces.")
 			return 0;
 		}
 
+		return rangeOffset;
+	}
+
+	bool StaticRangeAllocator::TryAllocateRange(uint32_t InRangeSize, uint32_t& OutRangeOffset)
+	{
+		// Find a range big enough to contain the range
+		auto freeRangesIt = m_FreeRangesBySize.lower_bound(InRangeSize); //lower_bound returns an iterator with the first element Not less than the given key
+		if (freeRangesIt == m_FreeRangesBySize.end())
+			return false;
+
 		RangeSize freeRangeSize = freeRangesIt->first;
 
 		DescOffset freeRangeOffset = freeRangesIt->second->first;
@@ -45,7 +55,42 @@ namespace GEPUtils { namespace Graphics {
 			FreeAllocatedRange(newFreeOffset, newFreeSize);
 		}
 
-		return freeRangeOffset;
+		OutRangeOffset = freeRangeOffset;
+		return true;
+	}
+
+	uint32_t StaticRangeAllocator::AllocateAlignedRange(uint32_t InRangeSize, uint32_t InAlignment)
+	{
+		if (InAlignment <= 1)
+			return AllocateRange(InRangeSize);
+
+		// Best fit: the smallest free range that can still contain the range once its offset gets aligned
+		for (auto freeRangesIt = m_FreeRangesBySize.lower_bound(InRangeSize); freeRangesIt != m_FreeRangesBySize.end(); ++freeRangesIt)
+		{
+			RangeSize freeRangeSize = freeRangesIt->first;
+
+			DescOffset freeRangeOffset = freeRangesIt->second->first;
+
+			DescOffset alignedOffset = (freeRangeOffset + InAlignment - 1) / InAlignment * InAlignment;
+
+			if (alignedOffset - freeRangeOffset + InRangeSize > freeRangeSize)
+				continue;
+
+			m_FreeRangesByOffset.erase(freeRangesIt->second);
+			m_FreeRangesBySize.erase(freeRangesIt);
+
+			// The padding before the aligned offset and the leftover after the range go back to the free ranges
+			if (alignedOffset != freeRangeOffset)
+				FreeAllocatedRange(freeRangeOffset, alignedOffset - freeRangeOffset);
+
+			if (RangeSize newFreeSize = freeRangeOffset + freeRangeSize - (alignedOffset + InRangeSize))
+				FreeAllocatedRange(alignedOffset + InRangeSize, newFreeSize);
+
+			return alignedOffset;
+		}
+
+		StopForFail("[StaticRangeAllocator] Not enough free spaces.")
+		return 0;
 	}
 
 	void StaticRangeAllocator::FreeAllocatedRange(uint32_t InRangeOffset, uint32_t InRangeSize)
@@ -67,7 +112,7 @@ namespace GEPUtils { namespace Graphics {
 		// 4) Both 1) and 2) cases do not happen.
 
 		// 1) The previous range finishes where the new free range starts.
-		if (prevFreeRangeIt != m_FreeRangesByOffset.end() && prevFreeRangeIt->first + InRangeSize == prevFreeRangeIt->second.m_Size) // Note: we are not checking for any validity on the input parameters
+		if (prevFreeRangeIt != m_FreeRangesByOffset.end() && prevFreeRangeIt->first + prevFreeRangeIt->second.m_Size == InRangeOffset) // Note: we are not checking for any validity on the input parameters
 		{
 			// Merging the previous free range with the current one: create a free range to contain both, and delete the previous free block
 			InRangeSize += prevFreeRangeIt->second.m_Size;
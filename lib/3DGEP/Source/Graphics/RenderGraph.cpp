@@ -0,0 +1,502 @@
+/*
+ RenderGraph.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "RenderGraph.h"
+#include "CommandList.h"
+#include "GraphicsAllocator.h"
+#include "GEPUtils.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// State of subresources not accessed yet by the graph, or of a whole resource whose subresources are in different states
+	static const GEPUtils::Graphics::RESOURCE_STATE g_UndefinedState = static_cast<GEPUtils::Graphics::RESOURCE_STATE>(-1);
+
+	static bool IsShaderResourceState(GEPUtils::Graphics::RESOURCE_STATE InState)
+	{
+		return InState == RESOURCE_STATE::PIXEL_SHADER_RESOURCE || InState == RESOURCE_STATE::NON_PIXEL_SHADER_RESOURCE || InState == RESOURCE_STATE::ALL_SHADER_RESOURCE;
+	}
+
+	// Read states that can be combined in a single one, so that consecutive passes reading the resource do not need a transition between them
+	static GEPUtils::Graphics::RESOURCE_STATE CombineShaderResourceStates(GEPUtils::Graphics::RESOURCE_STATE InFirstState, GEPUtils::Graphics::RESOURCE_STATE InSecondState)
+	{
+		return InFirstState == InSecondState ? InFirstState : RESOURCE_STATE::ALL_SHADER_RESOURCE;
+	}
+
+	static bool operator==(const RENDER_GRAPH_TEXTURE_DESC& InLeft, const RENDER_GRAPH_TEXTURE_DESC& InRight)
+	{
+		return InLeft.Width == InRight.Width && InLeft.Height == InRight.Height && InLeft.Type == InRight.Type && InLeft.Format == InRight.Format
+			&& InLeft.ArraySize == InRight.ArraySize && InLeft.MipLevels == InRight.MipLevels && InLeft.Flags == InRight.Flags;
+	}
+
+	static bool operator==(const RENDER_GRAPH_BUFFER_DESC& InLeft, const RENDER_GRAPH_BUFFER_DESC& InRight)
+	{
+		return InLeft.Size == InRight.Size && InLeft.Flags == InRight.Flags;
+	}
+
+	void RenderGraphPassBuilder::Read(RenderGraphResourceHandle InResource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresource /*= GEPUtils::Graphics::ALL_SUBRESOURCES*/)
+	{
+		m_RenderGraph.AddAccess(m_PassIdx, InResource, InState, InSubresource, false);
+	}
+
+	void RenderGraphPassBuilder::Write(RenderGraphResourceHandle InResource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresource /*= GEPUtils::Graphics::ALL_SUBRESOURCES*/)
+	{
+		m_RenderGraph.AddAccess(m_PassIdx, InResource, InState, InSubresource, true);
+	}
+
+	void RenderGraphPassBuilder::SetHasSideEffects()
+	{
+		m_RenderGraph.m_Passes[m_PassIdx].m_HasSideEffects = true;
+	}
+
+	RenderGraphResourceHandle RenderGraph::ImportResource(const char* InName, GEPUtils::Graphics::Resource& InResource)
+	{
+		ResourceNode newResource;
+		newResource.m_Name = InName;
+		newResource.m_Type = RESOURCE_NODE_TYPE::IMPORTED;
+		newResource.m_Resource = &InResource;
+		newResource.m_SubresourcesNum = InResource.GetSubresourcesNum();
+		m_Resources.push_back(newResource);
+
+		m_IsCompiled = false;
+
+		return RenderGraphResourceHandle{ static_cast<uint32_t>(m_Resources.size() - 1) };
+	}
+
+	RenderGraphResourceHandle RenderGraph::ImportOutputResource(const char* InName, GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InFinalState)
+	{
+		RenderGraphResourceHandle outHandle = ImportResource(InName, InResource);
+		m_Resources[outHandle.m_Index].m_IsOutput = true;
+		m_Resources[outHandle.m_Index].m_FinalState = InFinalState;
+
+		return outHandle;
+	}
+
+	RenderGraphResourceHandle RenderGraph::CreateTexture(const char* InName, const RENDER_GRAPH_TEXTURE_DESC& InDesc)
+	{
+		ResourceNode newResource;
+		newResource.m_Name = InName;
+		newResource.m_Type = RESOURCE_NODE_TYPE::TRANSIENT_TEXTURE;
+		newResource.m_TextureDesc = InDesc;
+		newResource.m_SubresourcesNum = InDesc.MipLevels * (InDesc.Type == TEXTURE_TYPE::TEX_3D ? 1 : InDesc.ArraySize);
+		m_Resources.push_back(newResource);
+
+		m_IsCompiled = false;
+
+		return RenderGraphResourceHandle{ static_cast<uint32_t>(m_Resources.size() - 1) };
+	}
+
+	RenderGraphResourceHandle RenderGraph::CreateBuffer(const char* InName, const RENDER_GRAPH_BUFFER_DESC& InDesc)
+	{
+		ResourceNode newResource;
+		newResource.m_Name = InName;
+		newResource.m_Type = RESOURCE_NODE_TYPE::TRANSIENT_BUFFER;
+		newResource.m_BufferDesc = InDesc;
+		m_Resources.push_back(newResource);
+
+		m_IsCompiled = false;
+
+		return RenderGraphResourceHandle{ static_cast<uint32_t>(m_Resources.size() - 1) };
+	}
+
+	RenderGraphPassHandle RenderGraph::AddPass(const char* InName, const SetupFnType& InSetupFn, ExecuteFnType InExecuteFn)
+	{
+		m_Passes.emplace_back();
+		m_Passes.back().m_Name = InName;
+		m_Passes.back().m_ExecuteFn = std::move(InExecuteFn);
+
+		const uint32_t newPassIdx = static_cast<uint32_t>(m_Passes.size() - 1);
+
+		RenderGraphPassBuilder passBuilder(*this, newPassIdx);
+		InSetupFn(passBuilder);
+
+		m_IsCompiled = false;
+
+		return RenderGraphPassHandle{ newPassIdx };
+	}
+
+	void RenderGraph::AddAccess(uint32_t InPassIdx, RenderGraphResourceHandle InResource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresource, bool InIsWrite)
+	{
+		if (!InResource.IsValid() || InResource.m_Index >= m_Resources.size())
+		{
+			StopForFail("[RenderGraph] Pass is trying to access an invalid resource.");
+			return;
+		}
+		Check(InSubresource == ALL_SUBRESOURCES || InSubresource < m_Resources[InResource.m_Index].m_SubresourcesNum);
+
+		m_Passes[InPassIdx].m_Accesses.push_back({ InResource, InSubresource, InState, InIsWrite });
+	}
+
+	void RenderGraph::Compile()
+	{
+		CullPasses();
+
+		ComputeLifetimes();
+
+		ComputeTransitions();
+
+		m_IsCompiled = true;
+	}
+
+	void RenderGraph::CullPasses()
+	{
+		// Walking passes backwards, a pass is needed if it writes to a resource that is an output or that is read by a later needed pass
+		std::vector<bool> isResourceNeeded(m_Resources.size(), false);
+		for (size_t resourceIdx = 0; resourceIdx < m_Resources.size(); resourceIdx++)
+			isResourceNeeded[resourceIdx] = m_Resources[resourceIdx].m_IsOutput;
+
+		for (size_t passIdx = m_Passes.size(); passIdx-- > 0; )
+		{
+			PassNode& currentPass = m_Passes[passIdx];
+
+			bool isPassNeeded = currentPass.m_HasSideEffects;
+			for (const ResourceAccess& currentAccess : currentPass.m_Accesses)
+			{
+				if (currentAccess.m_IsWrite && isResourceNeeded[currentAccess.m_Resource.m_Index])
+					isPassNeeded = true;
+			}
+
+			currentPass.m_IsCulled = !isPassNeeded;
+			if (currentPass.m_IsCulled)
+				continue;
+
+			for (const ResourceAccess& currentAccess : currentPass.m_Accesses)
+			{
+				if (!currentAccess.m_IsWrite)
+					isResourceNeeded[currentAccess.m_Resource.m_Index] = true;
+			}
+		}
+
+		m_ExecutionOrder.clear();
+		for (uint32_t passIdx = 0; passIdx < m_Passes.size(); passIdx++)
+		{
+			if (!m_Passes[passIdx].m_IsCulled)
+				m_ExecutionOrder.push_back(passIdx);
+		}
+	}
+
+	void RenderGraph::ComputeLifetimes()
+	{
+		for (ResourceNode& currentResource : m_Resources)
+			currentResource.m_Lifetime = RenderGraphResourceLifetime();
+
+		for (uint32_t passPos = 0; passPos < m_ExecutionOrder.size(); passPos++)
+		{
+			for (const ResourceAccess& currentAccess : m_Passes[m_ExecutionOrder[passPos]].m_Accesses)
+			{
+				RenderGraphResourceLifetime& resourceLifetime = m_Resources[currentAccess.m_Resource.m_Index].m_Lifetime;
+				resourceLifetime.m_FirstPassPos = std::min(resourceLifetime.m_FirstPassPos, passPos);
+				resourceLifetime.m_LastPassPos = std::max(resourceLifetime.m_LastPassPos, passPos);
+			}
+		}
+	}
+
+	void RenderGraph::ComputeTransitions()
+	{
+		// Accesses of each resource, in execution order
+		struct AccessRef { uint32_t m_PassIdx; const ResourceAccess* m_Access; };
+		std::vector<std::vector<AccessRef>> resourceAccesses(m_Resources.size());
+
+		for (uint32_t passIdx : m_ExecutionOrder)
+		{
+			m_Passes[passIdx].m_Transitions.clear();
+			for (const ResourceAccess& currentAccess : m_Passes[passIdx].m_Accesses)
+				resourceAccesses[currentAccess.m_Resource.m_Index].push_back({ passIdx, &currentAccess });
+		}
+		for (PassNode& currentPass : m_Passes)
+		{
+			if (currentPass.m_IsCulled)
+				currentPass.m_Transitions.clear();
+		}
+
+		m_FinalTransitions.clear();
+
+		for (uint32_t resourceIdx = 0; resourceIdx < m_Resources.size(); resourceIdx++)
+		{
+			const ResourceNode& currentResource = m_Resources[resourceIdx];
+			const std::vector<AccessRef>& currentAccesses = resourceAccesses[resourceIdx];
+
+			// Note: the state resources are in before the graph executes is not known here, the first access will always produce a transition
+			// and the command list resource state tracker will discard it if not needed
+			SubresourceStates currentStates(g_UndefinedState);
+
+			for (size_t accessIdx = 0; accessIdx < currentAccesses.size(); accessIdx++)
+			{
+				const ResourceAccess& currentAccess = *currentAccesses[accessIdx].m_Access;
+				GEPUtils::Graphics::RESOURCE_STATE stateAfter = currentAccess.m_State;
+
+				const GEPUtils::Graphics::RESOURCE_STATE stateBefore = currentStates.IsUniform() || currentAccess.m_Subresource != ALL_SUBRESOURCES ?
+					currentStates.GetState(currentAccess.m_Subresource) : g_UndefinedState;
+
+				if (!currentAccess.m_IsWrite && IsShaderResourceState(stateAfter))
+				{
+					// A shader resource state that already covers this read avoids a transition
+					if (stateBefore == RESOURCE_STATE::ALL_SHADER_RESOURCE)
+						continue;
+
+					// Combine the state with the following reads of the same subresources, until the next different access
+					for (size_t nextAccessIdx = accessIdx + 1; nextAccessIdx < currentAccesses.size(); nextAccessIdx++)
+					{
+						const ResourceAccess& nextAccess = *currentAccesses[nextAccessIdx].m_Access;
+						if (nextAccess.m_IsWrite || nextAccess.m_Subresource != currentAccess.m_Subresource || !IsShaderResourceState(nextAccess.m_State))
+							break;
+						stateAfter = CombineShaderResourceStates(stateAfter, nextAccess.m_State);
+					}
+				}
+
+				if (stateBefore == stateAfter)
+					continue;
+
+				m_Passes[currentAccesses[accessIdx].m_PassIdx].m_Transitions.push_back({ RenderGraphResourceHandle{ resourceIdx }, currentAccess.m_Subresource, stateAfter });
+				currentStates.SetState(currentAccess.m_Subresource, stateAfter, currentResource.m_SubresourcesNum);
+			}
+
+			if (currentResource.m_IsOutput)
+			{
+				if (!currentStates.IsUniform() || currentStates.GetState(ALL_SUBRESOURCES) != currentResource.m_FinalState)
+					m_FinalTransitions.push_back({ RenderGraphResourceHandle{ resourceIdx }, ALL_SUBRESOURCES, currentResource.m_FinalState });
+			}
+		}
+	}
+
+	void RenderGraph::AllocateTransientResources()
+	{
+		// Memory gets planned again only when the used transient resources changed since the last allocation
+		bool isSameAllocationLayout = true;
+		uint32_t allocationIdx = 0;
+		for (const ResourceNode& currentResource : m_Resources)
+		{
+			if (currentResource.m_Type == RESOURCE_NODE_TYPE::IMPORTED || !currentResource.m_Lifetime.IsValid())
+				continue;
+
+			if (allocationIdx >= m_TransientAllocations.size())
+			{
+				isSameAllocationLayout = false;
+				break;
+			}
+
+			const TransientAllocation& currentAllocation = m_TransientAllocations[allocationIdx++];
+			const bool isSameDesc = currentResource.m_Type == RESOURCE_NODE_TYPE::TRANSIENT_TEXTURE ?
+				currentAllocation.m_TextureDesc == currentResource.m_TextureDesc : currentAllocation.m_BufferDesc == currentResource.m_BufferDesc;
+
+			if (currentAllocation.m_Type != currentResource.m_Type || !isSameDesc
+				|| currentAllocation.m_Lifetime.m_FirstPassPos != currentResource.m_Lifetime.m_FirstPassPos || currentAllocation.m_Lifetime.m_LastPassPos != currentResource.m_Lifetime.m_LastPassPos)
+			{
+				isSameAllocationLayout = false;
+				break;
+			}
+		}
+
+		if (!isSameAllocationLayout || allocationIdx != m_TransientAllocations.size())
+			PlanTransientAllocations();
+
+		for (PassNode& currentPass : m_Passes)
+		{
+			currentPass.m_AliasedResources.clear();
+			currentPass.m_DiscardedResources.clear();
+		}
+
+		allocationIdx = 0;
+		for (uint32_t resourceIdx = 0; resourceIdx < m_Resources.size(); resourceIdx++)
+		{
+			ResourceNode& currentResource = m_Resources[resourceIdx];
+			if (currentResource.m_Type == RESOURCE_NODE_TYPE::IMPORTED || !currentResource.m_Lifetime.IsValid())
+				continue;
+
+			const TransientAllocation& currentAllocation = m_TransientAllocations[allocationIdx++];
+			currentResource.m_Resource = currentAllocation.m_Resource;
+
+			PassNode& firstPass = m_Passes[m_ExecutionOrder[currentResource.m_Lifetime.m_FirstPassPos]];
+			if (currentAllocation.m_IsAliasing)
+				firstPass.m_AliasedResources.push_back(RenderGraphResourceHandle{ resourceIdx });
+
+			// Note: transient content does not survive between executions, so these are initialized every time, not only after an aliasing barrier
+			if (currentAllocation.m_HeapUsage == RESOURCE_HEAP_USAGE::RENDER_TARGET_TEXTURES)
+				firstPass.m_DiscardedResources.push_back(RenderGraphResourceHandle{ resourceIdx });
+		}
+	}
+
+	void RenderGraph::PlanTransientAllocations()
+	{
+		GEPUtils::Graphics::GraphicsAllocatorBase* graphicsAllocator = GraphicsAllocator::Get();
+
+		// The previous placements are replaced by the new plan
+		for (const TransientAllocation& currentAllocation : m_TransientAllocations)
+		{
+			if (currentAllocation.m_Resource)
+				graphicsAllocator->ReleaseResource(*currentAllocation.m_Resource);
+		}
+
+		m_TransientAllocations.clear();
+		for (const ResourceNode& currentResource : m_Resources)
+		{
+			if (currentResource.m_Type == RESOURCE_NODE_TYPE::IMPORTED || !currentResource.m_Lifetime.IsValid())
+				continue;
+
+			TransientAllocation newAllocation;
+			newAllocation.m_Type = currentResource.m_Type;
+			newAllocation.m_TextureDesc = currentResource.m_TextureDesc;
+			newAllocation.m_BufferDesc = currentResource.m_BufferDesc;
+			newAllocation.m_Lifetime = currentResource.m_Lifetime;
+
+			if (currentResource.m_Type == RESOURCE_NODE_TYPE::TRANSIENT_TEXTURE)
+			{
+				const bool isRenderTarget = (currentResource.m_TextureDesc.Flags & RESOURCE_FLAGS::ALLOW_RENDER_TARGET) || (currentResource.m_TextureDesc.Flags & RESOURCE_FLAGS::ALLOW_DEPTH_STENCIL);
+				newAllocation.m_HeapUsage = isRenderTarget ? RESOURCE_HEAP_USAGE::RENDER_TARGET_TEXTURES : RESOURCE_HEAP_USAGE::TEXTURES;
+			}
+			else
+			{
+				newAllocation.m_HeapUsage = RESOURCE_HEAP_USAGE::BUFFERS;
+			}
+
+			m_TransientAllocations.push_back(newAllocation);
+		}
+
+		m_TransientMemorySize = 0;
+		m_TransientNonAliasedMemorySize = 0;
+
+		std::vector<TRANSIENT_ALLOCATION_DESC> allocationDescs;
+		std::vector<uint32_t> allocationIndices;
+		std::vector<TRANSIENT_PLACEMENT> placements;
+
+		// Resources that cannot share the same heap are planned separately
+		for (uint32_t heapUsageIdx = 0; heapUsageIdx < HEAP_USAGES_NUM; heapUsageIdx++)
+		{
+			const RESOURCE_HEAP_USAGE currentUsage = static_cast<RESOURCE_HEAP_USAGE>(heapUsageIdx);
+
+			allocationDescs.clear();
+			allocationIndices.clear();
+			for (uint32_t allocationIdx = 0; allocationIdx < m_TransientAllocations.size(); allocationIdx++)
+			{
+				const TransientAllocation& currentAllocation = m_TransientAllocations[allocationIdx];
+				if (currentAllocation.m_HeapUsage != currentUsage)
+					continue;
+
+				RESOURCE_ALLOCATION_INFO allocationInfo;
+				if (currentAllocation.m_Type == RESOURCE_NODE_TYPE::TRANSIENT_TEXTURE)
+				{
+					const RENDER_GRAPH_TEXTURE_DESC& textureDesc = currentAllocation.m_TextureDesc;
+					allocationInfo = graphicsAllocator->GetTextureAllocationInfo(textureDesc.Width, textureDesc.Height, textureDesc.Type, textureDesc.Format,
+						textureDesc.ArraySize, textureDesc.MipLevels, textureDesc.Flags);
+				}
+				else
+				{
+					allocationInfo = graphicsAllocator->GetBufferAllocationInfo(currentAllocation.m_BufferDesc.Size, currentAllocation.m_BufferDesc.Flags);
+				}
+
+				TRANSIENT_ALLOCATION_DESC newDesc;
+				newDesc.Size = allocationInfo.Size;
+				newDesc.Alignment = allocationInfo.Alignment;
+				newDesc.FirstPassPos = currentAllocation.m_Lifetime.m_FirstPassPos;
+				newDesc.LastPassPos = currentAllocation.m_Lifetime.m_LastPassPos;
+				allocationDescs.push_back(newDesc);
+				allocationIndices.push_back(allocationIdx);
+			}
+
+			if (allocationDescs.empty())
+				continue;
+
+			m_AliasingPlanner.Plan(allocationDescs, placements);
+
+			m_TransientMemorySize += m_AliasingPlanner.GetHeapSize();
+			m_TransientNonAliasedMemorySize += m_AliasingPlanner.GetNonAliasedSize();
+
+			GEPUtils::Graphics::ResourceHeap*& currentHeap = m_TransientHeaps[heapUsageIdx];
+			if (!currentHeap || currentHeap->GetSize() < m_AliasingPlanner.GetHeapSize())
+			{
+				if (currentHeap)
+					graphicsAllocator->ReleaseResourceHeap(*currentHeap);
+				currentHeap = &graphicsAllocator->AllocateResourceHeap(m_AliasingPlanner.GetHeapSize(), currentUsage);
+			}
+
+			for (uint32_t placementIdx = 0; placementIdx < placements.size(); placementIdx++)
+			{
+				TransientAllocation& currentAllocation = m_TransientAllocations[allocationIndices[placementIdx]];
+				const uint64_t heapOffset = placements[placementIdx].HeapOffset;
+
+				if (currentAllocation.m_Type == RESOURCE_NODE_TYPE::TRANSIENT_TEXTURE)
+				{
+					const RENDER_GRAPH_TEXTURE_DESC& textureDesc = currentAllocation.m_TextureDesc;
+					currentAllocation.m_Resource = &graphicsAllocator->AllocatePlacedTexture(*currentHeap, heapOffset, textureDesc.Width, textureDesc.Height, textureDesc.Type, textureDesc.Format,
+						textureDesc.ArraySize, textureDesc.MipLevels, RESOURCE_STATE::COPY_DEST, textureDesc.Flags);
+				}
+				else
+				{
+					currentAllocation.m_Resource = &graphicsAllocator->AllocatePlacedBuffer(*currentHeap, heapOffset, currentAllocation.m_BufferDesc.Size,
+						RESOURCE_STATE::COPY_DEST, currentAllocation.m_BufferDesc.Flags);
+				}
+
+				currentAllocation.m_IsAliasing = placements[placementIdx].IsAliasing;
+			}
+		}
+	}
+
+	void RenderGraph::Execute(GEPUtils::Graphics::CommandList& InCmdList)
+	{
+		if (!m_IsCompiled)
+			Compile();
+
+		AllocateTransientResources();
+
+		for (uint32_t passIdx : m_ExecutionOrder)
+		{
+			PassNode& currentPass = m_Passes[passIdx];
+
+			// The memory of aliased resources changes owner before the transitions, which will then start from the state the resource was left in
+			for (RenderGraphResourceHandle aliasedResource : currentPass.m_AliasedResources)
+				InCmdList.AliasingBarrier(GetResource(aliasedResource));
+
+			// Placed render targets and depth stencils need their metadata initialized before the first use of their memory
+			for (RenderGraphResourceHandle discardedResource : currentPass.m_DiscardedResources)
+			{
+				GEPUtils::Graphics::Resource& currentResource = GetResource(discardedResource);
+				const bool isDepthStencil = m_Resources[discardedResource.m_Index].m_TextureDesc.Flags & RESOURCE_FLAGS::ALLOW_DEPTH_STENCIL;
+				InCmdList.TransitionResource(currentResource, isDepthStencil ? RESOURCE_STATE::DEPTH_WRITE : RESOURCE_STATE::RENDER_TARGET);
+				InCmdList.DiscardResource(currentResource);
+			}
+
+			// Transitions are accumulated by the command list and submitted in a single batch before the next draw, dispatch or copy
+			for (const RENDER_GRAPH_TRANSITION& currentTransition : currentPass.m_Transitions)
+				InCmdList.TransitionResource(GetResource(currentTransition.m_Resource), currentTransition.m_StateAfter, currentTransition.m_Subresource);
+
+			if (currentPass.m_ExecuteFn)
+				currentPass.m_ExecuteFn(InCmdList, *this);
+		}
+
+		for (const RENDER_GRAPH_TRANSITION& currentTransition : m_FinalTransitions)
+			InCmdList.TransitionResource(GetResource(currentTransition.m_Resource), currentTransition.m_StateAfter, currentTransition.m_Subresource);
+	}
+
+	void RenderGraph::Reset()
+	{
+		m_Passes.clear();
+		m_Resources.clear();
+		m_ExecutionOrder.clear();
+		m_FinalTransitions.clear();
+
+		m_IsCompiled = false;
+	}
+
+	GEPUtils::Graphics::Resource& RenderGraph::GetResource(RenderGraphResourceHandle InResource)
+	{
+		GEPUtils::Graphics::Resource* foundResource = m_Resources[InResource.m_Index].m_Resource;
+		if (!foundResource)
+			StopForFail("[RenderGraph] Trying to get a transient resource that was not allocated, resources can only be retrieved by passes during execution.");
+
+		return *foundResource;
+	}
+
+	uint32_t RenderGraph::GetTransitionsNum() const
+	{
+		uint32_t outTransitionsNum = static_cast<uint32_t>(m_FinalTransitions.size());
+		for (uint32_t passIdx : m_ExecutionOrder)
+			outTransitionsNum += static_cast<uint32_t>(m_Passes[passIdx].m_Transitions.size());
+
+		return outTransitionsNum;
+	}
+
+} }
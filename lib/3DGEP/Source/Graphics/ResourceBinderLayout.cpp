@@ -0,0 +1,113 @@
+/*
+ ResourceBinderLayout.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "ResourceBinderLayout.h"
+#include <algorithm>
+#include <numeric>
+
+namespace GEPUtils { namespace Graphics {
+
+	using RESOURCE_BINDER_PARAM = GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_PARAM;
+
+	// A root descriptor is a 64 bit GPU address
+	static constexpr uint32_t g_RootDescriptorCost = 2;
+
+	uint32_t GetResourceBinderParamCost(const RESOURCE_BINDER_PARAM& InParam)
+	{
+		switch (InParam.ResourceType)
+		{
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::CONSTANTS: return InParam.Num32BitValues;
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::CBV_RANGE:
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::SRV_RANGE:
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::UAV_RANGE: return 1;
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::ROOT_CBV:
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::ROOT_SRV:
+		case RESOURCE_BINDER_PARAM::RESOURCE_TYPE::ROOT_UAV: return g_RootDescriptorCost;
+		}
+		return 0;
+	}
+
+	uint32_t GetResourceBinderCost(const GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_DESC& InDesc)
+	{
+		uint32_t outCost = 0;
+		for (const RESOURCE_BINDER_PARAM& currentParam : InDesc.Params)
+			outCost += GetResourceBinderParamCost(currentParam);
+		return outCost;
+	}
+
+	bool OptimizeResourceBinderLayout(GEPUtils::Graphics::PipelineState::RESOURCE_BINDER_DESC& InOutDesc, RESOURCE_BINDER_LAYOUT_FLAGS InFlags, RESOURCE_BINDER_LAYOUT& OutLayout)
+	{
+		std::vector<RESOURCE_BINDER_PARAM>& params = InOutDesc.Params;
+		const uint32_t paramsNum = static_cast<uint32_t>(params.size());
+
+		OutLayout.ConstantsToConvert.clear();
+		OutLayout.AreConstantsConverted = false;
+		OutLayout.DwordsNum = GetResourceBinderCost(InOutDesc);
+
+		// --- Budget ---
+		// Converting the biggest constants first gives back the most DWORDs with the fewest conversions
+		if (OutLayout.DwordsNum > g_ResourceBinderMaxDwordsNum)
+		{
+			std::vector<uint32_t> constantsBySize;
+			for (uint32_t paramIdx = 0; paramIdx < paramsNum; paramIdx++)
+			{
+				if (params[paramIdx].ResourceType == RESOURCE_BINDER_PARAM::RESOURCE_TYPE::CONSTANTS && params[paramIdx].Num32BitValues > g_RootDescriptorCost)
+					constantsBySize.push_back(paramIdx);
+			}
+			std::stable_sort(constantsBySize.begin(), constantsBySize.end(), [&params](uint32_t InFirst, uint32_t InSecond) {
+				return params[InFirst].Num32BitValues > params[InSecond].Num32BitValues;
+			});
+
+			uint32_t convertedCost = OutLayout.DwordsNum;
+			for (uint32_t currentParamIdx : constantsBySize)
+			{
+				if (convertedCost <= g_ResourceBinderMaxDwordsNum)
+					break;
+				convertedCost -= params[currentParamIdx].Num32BitValues - g_RootDescriptorCost;
+				OutLayout.ConstantsToConvert.push_back(currentParamIdx);
+			}
+
+			if (InFlags & RBL_CONVERT_CONSTANTS_OVER_BUDGET)
+			{
+				// Same register, space and visibility, so the shader declaration of the constant buffer does not change
+				for (uint32_t currentParamIdx : OutLayout.ConstantsToConvert)
+				{
+					RESOURCE_BINDER_PARAM& currentParam = params[currentParamIdx];
+					currentParam.InitAsRootCBV(currentParam.ShaderRegister, currentParam.RegisterSpace, currentParam.shaderVisibility);
+					currentParam.Num32BitValues = 0;
+				}
+				OutLayout.AreConstantsConverted = !OutLayout.ConstantsToConvert.empty();
+				OutLayout.DwordsNum = convertedCost;
+			}
+		}
+
+		// --- Order ---
+		std::vector<uint32_t> sortedParams(paramsNum);
+		std::iota(sortedParams.begin(), sortedParams.end(), 0);
+
+		if (InFlags & RBL_SORT_BY_UPDATE_FREQUENCY)
+		{
+			std::stable_sort(sortedParams.begin(), sortedParams.end(), [&params](uint32_t InFirst, uint32_t InSecond) {
+				return params[InFirst].UpdateFrequency < params[InSecond].UpdateFrequency;
+			});
+
+			std::vector<RESOURCE_BINDER_PARAM> sortedDescParams;
+			sortedDescParams.reserve(paramsNum);
+			for (uint32_t currentParamIdx : sortedParams)
+				sortedDescParams.push_back(params[currentParamIdx]);
+			params = std::move(sortedDescParams);
+		}
+
+		OutLayout.RootIndexRemap.assign(paramsNum, 0);
+		for (uint32_t newParamIdx = 0; newParamIdx < paramsNum; newParamIdx++)
+			OutLayout.RootIndexRemap[sortedParams[newParamIdx]] = newParamIdx;
+
+		return OutLayout.DwordsNum <= g_ResourceBinderMaxDwordsNum;
+	}
+
+} }
@@ -0,0 +1,273 @@
+/*
+ ResourceStateTracker.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "ResourceStateTracker.h"
+#include "GEPUtils.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Marks the subresources whose state is not known yet by a command list
+	static const GEPUtils::Graphics::RESOURCE_STATE g_UnknownState = static_cast<GEPUtils::Graphics::RESOURCE_STATE>(-1);
+
+	GEPUtils::Graphics::RESOURCE_STATE SubresourceStates::GetState(uint32_t InSubresource) const
+	{
+		if (IsUniform())
+			return m_State;
+
+		if (InSubresource == ALL_SUBRESOURCES)
+		{
+			StopForFail("[SubresourceStates] Requested a single state for all the subresources, but they are in different states.");
+			return m_PerSubresourceStates[0];
+		}
+
+		return m_PerSubresourceStates[InSubresource];
+	}
+
+	void SubresourceStates::SetState(uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE InState, uint32_t InSubresourcesNum)
+	{
+		if (InSubresource == ALL_SUBRESOURCES || InSubresourcesNum <= 1)
+		{
+			m_State = InState;
+			m_PerSubresourceStates.clear();
+			return;
+		}
+
+		if (IsUniform())
+		{
+			if (m_State == InState)
+				return;
+			m_PerSubresourceStates.assign(InSubresourcesNum, m_State);
+		}
+
+		m_PerSubresourceStates[InSubresource] = InState;
+
+		// Going back to a single state when all the subresources converged
+		for (GEPUtils::Graphics::RESOURCE_STATE currentState : m_PerSubresourceStates)
+		{
+			if (currentState != InState)
+				return;
+		}
+		m_State = InState;
+		m_PerSubresourceStates.clear();
+	}
+
+	Resource::~Resource()
+	{
+		ResourceStateRegistry::Get().UnregisterResource(*this);
+	}
+
+	ResourceStateRegistry& ResourceStateRegistry::Get()
+	{
+		// Note: never destroyed, since resources unregister themselves in their destructor and can outlive function static objects
+		static ResourceStateRegistry* defaultRegistry = new ResourceStateRegistry();
+		return *defaultRegistry;
+	}
+
+	void ResourceStateRegistry::RegisterResource(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InInitialState)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		// Note: registering again an already registered resource (e.g. a back buffer recreated after resize) will just override its state
+		m_States.erase(&InResource);
+		m_States.emplace(&InResource, SubresourceStates(InInitialState));
+	}
+
+	void ResourceStateRegistry::UnregisterResource(GEPUtils::Graphics::Resource& InResource)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_States.erase(&InResource);
+	}
+
+	void ResourceStateRegistry::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_States.clear();
+	}
+
+	bool ResourceStateRegistry::IsRegistered(GEPUtils::Graphics::Resource& InResource)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_States.find(&InResource) != m_States.end();
+	}
+
+	GEPUtils::Graphics::RESOURCE_STATE ResourceStateRegistry::GetState(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto foundStateIt = m_States.find(&InResource);
+		if (foundStateIt == m_States.end())
+		{
+			StopForFail("[ResourceStateRegistry] Requested the state of a resource that was not registered.");
+			return g_UnknownState;
+		}
+		return foundStateIt->second.GetState(InSubresource);
+	}
+
+	ResourceStateTracker::ResourceStateTracker(ResourceStateRegistry& InRegistry /*= ResourceStateRegistry::Get()*/)
+		: m_Registry(InRegistry)
+	{ }
+
+	void ResourceStateTracker::TransitionResource(GEPUtils::Graphics::Resource& InResource, GEPUtils::Graphics::RESOURCE_STATE InStateAfter, uint32_t InSubresource /*= ALL_SUBRESOURCES*/)
+	{
+		const uint32_t subresourcesNum = InResource.GetSubresourcesNum();
+
+		auto localStatesIt = m_FinalStates.find(&InResource);
+
+		// First time the resource is used in this command list: its state will be known only at submission time
+		if (localStatesIt == m_FinalStates.end())
+		{
+			m_PendingTransitions.push_back({ &InResource, InSubresource, InStateAfter, InStateAfter });
+			m_FinalStates.emplace(&InResource, SubresourceStates(g_UnknownState)).first->second.SetState(InSubresource, InStateAfter, subresourcesNum);
+			return;
+		}
+
+		SubresourceStates& localStates = localStatesIt->second;
+
+		if (InSubresource == ALL_SUBRESOURCES && !localStates.IsUniform())
+		{
+			// Subresources are in different states, each one needs its own transition
+			for (uint32_t subresourceIdx = 0; subresourceIdx < localStates.GetSubresourcesNum(); subresourceIdx++)
+				AddTransitionFromState(InResource, subresourceIdx, localStates.GetState(subresourceIdx), InStateAfter);
+		}
+		else
+		{
+			AddTransitionFromState(InResource, InSubresource, localStates.GetState(InSubresource), InStateAfter);
+		}
+
+		localStates.SetState(InSubresource, InStateAfter, subresourcesNum);
+	}
+
+	bool ResourceStateTracker::GetTrackedState(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE& OutState) const
+	{
+		auto localStatesIt = m_FinalStates.find(&InResource);
+		if (localStatesIt == m_FinalStates.end())
+			return false;
+
+		const SubresourceStates& localStates = localStatesIt->second;
+		if (InSubresource == ALL_SUBRESOURCES && !localStates.IsUniform())
+			return false;
+
+		OutState = localStates.GetState(InSubresource);
+		return OutState != g_UnknownState;
+	}
+
+	void ResourceStateTracker::AcquireResourceState(GEPUtils::Graphics::Resource& InResource)
+	{
+		if (m_FinalStates.find(&InResource) != m_FinalStates.end())
+			return;
+
+		std::lock_guard<std::mutex> lock(m_Registry.m_Mutex);
+
+		auto globalStatesIt = m_Registry.m_States.find(&InResource);
+		if (globalStatesIt != m_Registry.m_States.end())
+			m_FinalStates.emplace(&InResource, globalStatesIt->second);
+	}
+
+	void ResourceStateTracker::AddTransitionFromState(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE InStateBefore, GEPUtils::Graphics::RESOURCE_STATE InStateAfter)
+	{
+		if (InStateBefore == g_UnknownState)
+			m_PendingTransitions.push_back({ &InResource, InSubresource, InStateAfter, InStateAfter });
+		else
+			AddBarrier(InResource, InSubresource, InStateBefore, InStateAfter);
+	}
+
+	void ResourceStateTracker::AddBarrier(GEPUtils::Graphics::Resource& InResource, uint32_t InSubresource, GEPUtils::Graphics::RESOURCE_STATE InStateBefore, GEPUtils::Graphics::RESOURCE_STATE InStateAfter)
+	{
+		if (InStateBefore == InStateAfter)
+			return;
+
+		// Look for a not yet flushed transition on the same subresource to merge with.
+		// Note: we cannot merge past a barrier that targets an overlapping but different set of subresources, since the order of the two matters.
+		for (auto barrierIt = m_Barriers.rbegin(); barrierIt != m_Barriers.rend(); ++barrierIt)
+		{
+			if (barrierIt->m_Resource != &InResource)
+				continue;
+
+			if (barrierIt->m_Subresource == InSubresource)
+			{
+				barrierIt->m_StateAfter = InStateAfter;
+				if (barrierIt->m_StateBefore == barrierIt->m_StateAfter)
+					m_Barriers.erase(std::next(barrierIt).base());
+				return;
+			}
+
+			if (barrierIt->m_Subresource == ALL_SUBRESOURCES || InSubresource == ALL_SUBRESOURCES)
+				break;
+		}
+
+		m_Barriers.push_back({ &InResource, InSubresource, InStateBefore, InStateAfter });
+	}
+
+	void ResourceStateTracker::ResolvePendingTransitions(std::vector<RESOURCE_TRANSITION>& OutBarriers)
+	{
+		// Note: the registry stays locked between resolving and committing states, so that command lists submitted from different threads see consistent states
+		std::lock_guard<std::mutex> lock(m_Registry.m_Mutex);
+
+		for (const RESOURCE_TRANSITION& currentPending : m_PendingTransitions)
+		{
+			auto globalStatesIt = m_Registry.m_States.find(currentPending.m_Resource);
+			if (globalStatesIt == m_Registry.m_States.end())
+			{
+				DebugPrint("[ResourceStateTracker] Resource used in a command list was not registered, assuming it is already in the expected state.");
+				continue;
+			}
+			const SubresourceStates& globalStates = globalStatesIt->second;
+
+			if (currentPending.m_Subresource == ALL_SUBRESOURCES && !globalStates.IsUniform())
+			{
+				for (uint32_t subresourceIdx = 0; subresourceIdx < globalStates.GetSubresourcesNum(); subresourceIdx++)
+				{
+					GEPUtils::Graphics::RESOURCE_STATE globalState = globalStates.GetState(subresourceIdx);
+					if (globalState != currentPending.m_StateAfter)
+						OutBarriers.push_back({ currentPending.m_Resource, subresourceIdx, globalState, currentPending.m_StateAfter });
+				}
+			}
+			else
+			{
+				GEPUtils::Graphics::RESOURCE_STATE globalState = globalStates.GetState(currentPending.m_Subresource);
+				if (globalState != currentPending.m_StateAfter)
+					OutBarriers.push_back({ currentPending.m_Resource, currentPending.m_Subresource, globalState, currentPending.m_StateAfter });
+			}
+		}
+
+		// Commit the states resources will be in after this command list executes
+		for (auto& currentLocalStates : m_FinalStates)
+		{
+			auto globalStatesIt = m_Registry.m_States.find(currentLocalStates.first);
+			if (globalStatesIt == m_Registry.m_States.end())
+				continue;
+
+			const uint32_t subresourcesNum = currentLocalStates.first->GetSubresourcesNum();
+			const SubresourceStates& localStates = currentLocalStates.second;
+
+			if (localStates.IsUniform())
+			{
+				globalStatesIt->second.SetState(ALL_SUBRESOURCES, localStates.GetState(ALL_SUBRESOURCES), subresourcesNum);
+			}
+			else
+			{
+				for (uint32_t subresourceIdx = 0; subresourceIdx < localStates.GetSubresourcesNum(); subresourceIdx++)
+				{
+					// Subresources never used by this command list keep their global state
+					GEPUtils::Graphics::RESOURCE_STATE localState = localStates.GetState(subresourceIdx);
+					if (localState != g_UnknownState)
+						globalStatesIt->second.SetState(subresourceIdx, localState, subresourcesNum);
+				}
+			}
+		}
+
+		m_PendingTransitions.clear();
+		m_FinalStates.clear();
+	}
+
+	void ResourceStateTracker::Reset()
+	{
+		m_Barriers.clear();
+		m_PendingTransitions.clear();
+		m_FinalStates.clear();
+	}
+
+} }
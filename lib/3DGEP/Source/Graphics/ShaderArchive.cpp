@@ -0,0 +1,244 @@
+/*
+ ShaderArchive.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "ShaderArchive.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include "GEPUtilsHash.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	static_assert(sizeof(SHADER_ARCHIVE_HEADER) % 8 == 0 && sizeof(SHADER_ARCHIVE_ENTRY) % 8 == 0, "Archive structures need to keep the entries table aligned");
+
+	static uint64_t AlignArchiveOffset(uint64_t InOffset)
+	{
+		return (InOffset + g_ShaderArchivePayloadAlignment - 1) & ~(g_ShaderArchivePayloadAlignment - 1);
+	}
+
+	uint64_t ComputeShaderArchiveNameHash(const char* InName, size_t InNameSize)
+	{
+		return Hash::HashBytes(InName, InNameSize);
+	}
+
+	bool ShaderArchiveWriter::AddShader(const std::string& InName, const void* InBytecode, size_t InBytecodeSize)
+	{
+		for (const PendingShader& currentShader : m_Shaders)
+		{
+			if (currentShader.m_Name == InName)
+				return false;
+		}
+
+		const uint8_t* bytecodeBytes = static_cast<const uint8_t*>(InBytecode);
+
+		m_Shaders.emplace_back();
+		PendingShader& newShader = m_Shaders.back();
+		newShader.m_Name = InName;
+		newShader.m_NameHash = ComputeShaderArchiveNameHash(InName.data(), InName.size());
+		newShader.m_BytecodeHash = Hash::HashBytes(InBytecode, InBytecodeSize);
+		newShader.m_Bytecode.assign(bytecodeBytes, bytecodeBytes + InBytecodeSize);
+		return true;
+	}
+
+	void ShaderArchiveWriter::Serialize(std::vector<uint8_t>& OutFileData) const
+	{
+		// Name hash order is what the reader binary searches, names break ties so that the output does not depend on the adding order
+		std::vector<const PendingShader*> sortedShaders;
+		sortedShaders.reserve(m_Shaders.size());
+		for (const PendingShader& currentShader : m_Shaders)
+			sortedShaders.push_back(&currentShader);
+
+		std::sort(sortedShaders.begin(), sortedShaders.end(), [](const PendingShader* InFirst, const PendingShader* InSecond) {
+			return InFirst->m_NameHash != InSecond->m_NameHash ? InFirst->m_NameHash < InSecond->m_NameHash : InFirst->m_Name < InSecond->m_Name;
+		});
+
+		const uint64_t tableOffset = sizeof(SHADER_ARCHIVE_HEADER);
+		const uint64_t namesOffset = tableOffset + sortedShaders.size() * sizeof(SHADER_ARCHIVE_ENTRY);
+
+		std::vector<SHADER_ARCHIVE_ENTRY> entries(sortedShaders.size());
+		std::string names;
+		for (size_t shaderIdx = 0; shaderIdx < sortedShaders.size(); shaderIdx++)
+		{
+			entries[shaderIdx].NameHash = sortedShaders[shaderIdx]->m_NameHash;
+			entries[shaderIdx].NameOffset = static_cast<uint32_t>(names.size());
+			entries[shaderIdx].NameSize = static_cast<uint32_t>(sortedShaders[shaderIdx]->m_Name.size());
+			names += sortedShaders[shaderIdx]->m_Name;
+		}
+
+		// Payloads go after the names, each identical bytecode is written once
+		uint64_t payloadsEndOffset = AlignArchiveOffset(namesOffset + names.size());
+		std::unordered_multimap<uint64_t, size_t> hashToWrittenShaderIdx;
+		std::vector<bool> isPayloadOwner(sortedShaders.size(), false);
+		for (size_t shaderIdx = 0; shaderIdx < sortedShaders.size(); shaderIdx++)
+		{
+			const PendingShader& currentShader = *sortedShaders[shaderIdx];
+			entries[shaderIdx].BytecodeHash = currentShader.m_BytecodeHash;
+			entries[shaderIdx].BytecodeSize = currentShader.m_Bytecode.size();
+
+			bool isSharingPayload = false;
+			auto sameHashRange = hashToWrittenShaderIdx.equal_range(currentShader.m_BytecodeHash);
+			for (auto sameHashIt = sameHashRange.first; sameHashIt != sameHashRange.second; ++sameHashIt)
+			{
+				if (sortedShaders[sameHashIt->second]->m_Bytecode == currentShader.m_Bytecode)
+				{
+					entries[shaderIdx].BytecodeOffset = entries[sameHashIt->second].BytecodeOffset;
+					isSharingPayload = true;
+					break;
+				}
+			}
+			if (isSharingPayload)
+				continue;
+
+			entries[shaderIdx].BytecodeOffset = payloadsEndOffset;
+			payloadsEndOffset = AlignArchiveOffset(payloadsEndOffset + currentShader.m_Bytecode.size());
+			hashToWrittenShaderIdx.emplace(currentShader.m_BytecodeHash, shaderIdx);
+			isPayloadOwner[shaderIdx] = true;
+		}
+
+		// Zero filled, so that padding bytes are deterministic
+		OutFileData.assign(static_cast<size_t>(payloadsEndOffset), 0);
+
+		if (!entries.empty())
+			std::memcpy(OutFileData.data() + tableOffset, entries.data(), entries.size() * sizeof(SHADER_ARCHIVE_ENTRY));
+		if (!names.empty())
+			std::memcpy(OutFileData.data() + namesOffset, names.data(), names.size());
+
+		for (size_t shaderIdx = 0; shaderIdx < sortedShaders.size(); shaderIdx++)
+		{
+			const std::vector<uint8_t>& currentBytecode = sortedShaders[shaderIdx]->m_Bytecode;
+			if (isPayloadOwner[shaderIdx] && !currentBytecode.empty())
+				std::memcpy(OutFileData.data() + entries[shaderIdx].BytecodeOffset, currentBytecode.data(), currentBytecode.size());
+		}
+
+		SHADER_ARCHIVE_HEADER fileHeader = {};
+		fileHeader.Magic = g_ShaderArchiveMagic;
+		fileHeader.Version = g_ShaderArchiveVersion;
+		fileHeader.EntriesNum = static_cast<uint32_t>(entries.size());
+		fileHeader.NamesSize = static_cast<uint32_t>(names.size());
+		fileHeader.TableHash = Hash::HashBytes(OutFileData.data() + tableOffset, static_cast<size_t>(namesOffset - tableOffset) + names.size());
+		std::memcpy(OutFileData.data(), &fileHeader, sizeof(SHADER_ARCHIVE_HEADER));
+	}
+
+	bool ShaderArchiveWriter::Save(const std::string& InFilePath) const
+	{
+		std::vector<uint8_t> fileData;
+		Serialize(fileData);
+
+		std::ofstream outFile(InFilePath, std::ios::binary | std::ios::trunc);
+		if (!outFile)
+			return false;
+
+		outFile.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+		return outFile.good();
+	}
+
+	bool ShaderArchive::Open(const std::string& InFilePath)
+	{
+		Close();
+		return m_MappedFile.Open(InFilePath) && ReadMappedFile();
+	}
+
+	bool ShaderArchive::Open(const std::wstring& InFilePath)
+	{
+		Close();
+		return m_MappedFile.Open(InFilePath) && ReadMappedFile();
+	}
+
+	void ShaderArchive::Close()
+	{
+		m_MappedFile.Close();
+		m_Entries = nullptr;
+		m_EntriesNum = 0;
+		m_Names = nullptr;
+	}
+
+	bool ShaderArchive::FindShader(const std::string& InName, const void*& OutBytecode, size_t& OutBytecodeSize, uint64_t& OutBytecodeHash) const
+	{
+		if (!IsOpen())
+			return false;
+
+		const uint64_t nameHash = ComputeShaderArchiveNameHash(InName.data(), InName.size());
+
+		const SHADER_ARCHIVE_ENTRY* entriesEnd = m_Entries + m_EntriesNum;
+		const SHADER_ARCHIVE_ENTRY* foundEntry = std::lower_bound(m_Entries, entriesEnd, nameHash, [](const SHADER_ARCHIVE_ENTRY& InEntry, uint64_t InNameHash) {
+			return InEntry.NameHash < InNameHash;
+		});
+
+		// Names are compared too, different names with the same hash are next to each other in the table
+		for (; foundEntry != entriesEnd && foundEntry->NameHash == nameHash; ++foundEntry)
+		{
+			if (foundEntry->NameSize != InName.size() || std::memcmp(m_Names + foundEntry->NameOffset, InName.data(), InName.size()) != 0)
+				continue;
+
+			OutBytecode = m_MappedFile.GetData() + foundEntry->BytecodeOffset;
+			OutBytecodeSize = static_cast<size_t>(foundEntry->BytecodeSize);
+			OutBytecodeHash = foundEntry->BytecodeHash;
+			return true;
+		}
+
+		return false;
+	}
+
+	std::string ShaderArchive::GetShaderName(size_t InShaderIdx) const
+	{
+		return std::string(m_Names + m_Entries[InShaderIdx].NameOffset, m_Entries[InShaderIdx].NameSize);
+	}
+
+	bool ShaderArchive::ReadMappedFile()
+	{
+		const uint8_t* fileData = m_MappedFile.GetData();
+		const uint64_t fileSize = m_MappedFile.GetSize();
+
+		SHADER_ARCHIVE_HEADER fileHeader;
+		if (fileSize < sizeof(SHADER_ARCHIVE_HEADER))
+		{
+			Close();
+			return false;
+		}
+		std::memcpy(&fileHeader, fileData, sizeof(SHADER_ARCHIVE_HEADER));
+
+		const uint64_t tableSize = static_cast<uint64_t>(fileHeader.EntriesNum) * sizeof(SHADER_ARCHIVE_ENTRY);
+		if (fileHeader.Magic != g_ShaderArchiveMagic || fileHeader.Version != g_ShaderArchiveVersion
+			|| fileSize - sizeof(SHADER_ARCHIVE_HEADER) < tableSize + fileHeader.NamesSize)
+		{
+			Close();
+			return false;
+		}
+
+		const uint8_t* tableData = fileData + sizeof(SHADER_ARCHIVE_HEADER);
+		if (Hash::HashBytes(tableData, static_cast<size_t>(tableSize + fileHeader.NamesSize)) != fileHeader.TableHash)
+		{
+			Close();
+			return false;
+		}
+
+		// Note: the header size keeps the table aligned, and mapped files start at a page boundary
+		const SHADER_ARCHIVE_ENTRY* tableEntries = reinterpret_cast<const SHADER_ARCHIVE_ENTRY*>(tableData);
+
+		// Everything the lookups rely on is checked once here: sorting, names and payloads inside the file
+		for (uint32_t entryIdx = 0; entryIdx < fileHeader.EntriesNum; entryIdx++)
+		{
+			const SHADER_ARCHIVE_ENTRY& currentEntry = tableEntries[entryIdx];
+			if ((entryIdx > 0 && tableEntries[entryIdx - 1].NameHash > currentEntry.NameHash)
+				|| currentEntry.NameOffset > fileHeader.NamesSize || currentEntry.NameSize > fileHeader.NamesSize - currentEntry.NameOffset
+				|| currentEntry.BytecodeOffset > fileSize || currentEntry.BytecodeSize > fileSize - currentEntry.BytecodeOffset
+				|| currentEntry.BytecodeOffset % g_ShaderArchivePayloadAlignment != 0)
+			{
+				Close();
+				return false;
+			}
+		}
+
+		m_Entries = tableEntries;
+		m_EntriesNum = fileHeader.EntriesNum;
+		m_Names = reinterpret_cast<const char*>(tableData + tableSize);
+		return true;
+	}
+
+} }
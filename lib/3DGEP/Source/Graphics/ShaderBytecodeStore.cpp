@@ -0,0 +1,213 @@
+/*
+ ShaderBytecodeStore.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "ShaderBytecodeStore.h"
+#include <algorithm>
+#include <cstring>
+#include "GEPUtils.h"
+#include "GEPUtilsHash.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	// Archive names and mount paths always use '/' as separator
+	static std::wstring NormalizeShaderPath(const std::wstring& InPath)
+	{
+		std::wstring outPath = InPath;
+		std::replace(outPath.begin(), outPath.end(), L'\\', L'/');
+		return outPath;
+	}
+
+	uint32_t ShaderBytecodeStore::LoadBytecode(const std::wstring& InFilePath)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto foundPathIt = m_PathToBytecodeId.find(InFilePath);
+		if (foundPathIt != m_PathToBytecodeId.end())
+			return foundPathIt->second;
+
+		std::unique_ptr<GEPUtils::MappedFile> mappedFile;
+		size_t bytecodeSize = 0;
+		uint64_t bytecodeHash = 0;
+		uint64_t lastWriteTime = 0;
+		const uint8_t* archivedBytecode = FindArchivedBytecode(InFilePath, bytecodeSize, bytecodeHash);
+		const uint8_t* bytecodeData = archivedBytecode;
+
+		if (!archivedBytecode)
+		{
+			mappedFile = std::make_unique<GEPUtils::MappedFile>();
+			if (!mappedFile->Open(InFilePath))
+				return INVALID_BYTECODE_ID;
+
+			bytecodeData = mappedFile->GetData();
+			bytecodeSize = mappedFile->GetSize();
+			bytecodeHash = Hash::HashBytes(bytecodeData, bytecodeSize);
+			lastWriteTime = mappedFile->GetLastWriteTime();
+		}
+
+		// A different file (or archived shader) with the same content, the new file is not kept mapped.
+		// Note: bytes are compared too, so that a hash collision cannot make two different shaders share the bytecode
+		auto sameHashRange = m_HashToBytecodeId.equal_range(bytecodeHash);
+		for (auto sameHashIt = sameHashRange.first; sameHashIt != sameHashRange.second; ++sameHashIt)
+		{
+			BytecodeEntry& sameHashEntry = m_Entries[sameHashIt->second];
+			if (sameHashEntry.m_Size != bytecodeSize || !AcquireEntry(sameHashEntry))
+				continue;
+
+			const bool isSameContent = std::memcmp(GetEntryData(sameHashEntry), bytecodeData, bytecodeSize) == 0;
+			ReleaseEntry(sameHashEntry);
+
+			if (isSameContent)
+			{
+				m_PathToBytecodeId.emplace(InFilePath, sameHashIt->second);
+				return sameHashIt->second;
+			}
+		}
+
+		const uint32_t newBytecodeId = static_cast<uint32_t>(m_Entries.size());
+		m_Entries.emplace_back();
+		BytecodeEntry& newEntry = m_Entries.back();
+		newEntry.m_FilePath = InFilePath;
+		newEntry.m_Hash = bytecodeHash;
+		newEntry.m_Size = bytecodeSize;
+		newEntry.m_LastWriteTime = lastWriteTime;
+		newEntry.m_MappedFile = std::move(mappedFile);
+		newEntry.m_ArchivedBytecode = archivedBytecode;
+
+		// Not acquired by anyone yet
+		if (newEntry.m_MappedFile)
+			newEntry.m_MappedFile->Close();
+
+		m_PathToBytecodeId.emplace(InFilePath, newBytecodeId);
+		m_HashToBytecodeId.emplace(bytecodeHash, newBytecodeId);
+		return newBytecodeId;
+	}
+
+	bool ShaderBytecodeStore::MountArchive(const std::wstring& InArchivePath, const std::wstring& InMountPath)
+	{
+		std::unique_ptr<GEPUtils::Graphics::ShaderArchive> newArchive = std::make_unique<GEPUtils::Graphics::ShaderArchive>();
+		if (!newArchive->Open(InArchivePath))
+			return false;
+
+		MountedArchive newMountedArchive;
+		newMountedArchive.m_MountPath = NormalizeShaderPath(InMountPath);
+		if (!newMountedArchive.m_MountPath.empty() && newMountedArchive.m_MountPath.back() != L'/')
+			newMountedArchive.m_MountPath += L'/';
+		newMountedArchive.m_Archive = std::move(newArchive);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_MountedArchives.push_back(std::move(newMountedArchive));
+		return true;
+	}
+
+	uint64_t ShaderBytecodeStore::GetBytecodeHash(uint32_t InBytecodeId)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Entries[InBytecodeId].m_Hash;
+	}
+
+	GEPUtils::Graphics::ShaderBytecodeView ShaderBytecodeStore::AcquireBytecode(uint32_t InBytecodeId)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		BytecodeEntry& currentEntry = m_Entries[InBytecodeId];
+		if (!AcquireEntry(currentEntry))
+		{
+			StopForFail("[ShaderBytecodeStore] Shader bytecode file is not accessible anymore.");
+			return ShaderBytecodeView();
+		}
+
+		ShaderBytecodeView outView;
+		outView.m_Data = GetEntryData(currentEntry);
+		outView.m_Size = currentEntry.m_Size;
+		return outView;
+	}
+
+	void ShaderBytecodeStore::ReleaseBytecode(uint32_t InBytecodeId)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		ReleaseEntry(m_Entries[InBytecodeId]);
+	}
+
+	size_t ShaderBytecodeStore::GetBytecodesNum()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Entries.size();
+	}
+
+	size_t ShaderBytecodeStore::GetResidentBytecodesNum()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		size_t outResidentNum = 0;
+		for (const BytecodeEntry& currentEntry : m_Entries)
+		{
+			// Archived bytecode is always mapped
+			if (currentEntry.m_ArchivedBytecode || currentEntry.m_MappedFile->IsOpen())
+				outResidentNum++;
+		}
+		return outResidentNum;
+	}
+
+	bool ShaderBytecodeStore::AcquireEntry(BytecodeEntry& InEntry)
+	{
+		if (InEntry.m_AcquiresNum == 0 && !InEntry.m_ArchivedBytecode)
+		{
+			if (!InEntry.m_MappedFile->Open(InEntry.m_FilePath))
+				return false;
+
+			// Pipeline states are cached by bytecode hash, a file changed since it was loaded would end up cached with the wrong content.
+			// The content was hashed when loaded, mapping it again only compares size and modification time instead of hashing it again.
+			if (InEntry.m_MappedFile->GetSize() != InEntry.m_Size || InEntry.m_MappedFile->GetLastWriteTime() != InEntry.m_LastWriteTime)
+			{
+				InEntry.m_MappedFile->Close();
+				return false;
+			}
+		}
+
+		InEntry.m_AcquiresNum++;
+		return true;
+	}
+
+	void ShaderBytecodeStore::ReleaseEntry(BytecodeEntry& InEntry)
+	{
+		Check(InEntry.m_AcquiresNum > 0);
+
+		InEntry.m_AcquiresNum--;
+		if (InEntry.m_AcquiresNum == 0 && InEntry.m_MappedFile)
+			InEntry.m_MappedFile->Close();
+	}
+
+	const uint8_t* ShaderBytecodeStore::GetEntryData(const BytecodeEntry& InEntry) const
+	{
+		return InEntry.m_ArchivedBytecode ? InEntry.m_ArchivedBytecode : InEntry.m_MappedFile->GetData();
+	}
+
+	const uint8_t* ShaderBytecodeStore::FindArchivedBytecode(const std::wstring& InFilePath, size_t& OutSize, uint64_t& OutHash) const
+	{
+		if (m_MountedArchives.empty())
+			return nullptr;
+
+		const std::wstring normalizedPath = NormalizeShaderPath(InFilePath);
+
+		for (const MountedArchive& currentArchive : m_MountedArchives)
+		{
+			if (normalizedPath.compare(0, currentArchive.m_MountPath.size(), currentArchive.m_MountPath) != 0)
+				continue;
+
+			// Archive names are stored as UTF-8
+			const std::string shaderName = GEPUtils::WideToUtf8(normalizedPath.substr(currentArchive.m_MountPath.size()));
+
+			const void* foundBytecode = nullptr;
+			if (currentArchive.m_Archive->FindShader(shaderName, foundBytecode, OutSize, OutHash))
+				return static_cast<const uint8_t*>(foundBytecode);
+		}
+
+		return nullptr;
+	}
+
+} }
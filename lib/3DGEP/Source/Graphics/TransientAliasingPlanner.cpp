@@ -0,0 +1,109 @@
+/*
+ TransientAliasingPlanner.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TransientAliasingPlanner.h"
+#include <algorithm>
+#include <numeric>
+#include "RangeAllocators.h"
+
+namespace GEPUtils { namespace Graphics {
+
+	TransientAliasingPlanner::TransientAliasingPlanner(uint64_t InAllocationGranularity /*= 64 * 1024*/)
+		: m_AllocationGranularity(InAllocationGranularity)
+	{ }
+
+	void TransientAliasingPlanner::Plan(const std::vector<TRANSIENT_ALLOCATION_DESC>& InAllocations, std::vector<TRANSIENT_PLACEMENT>& OutPlacements)
+	{
+		const uint32_t allocationsNum = static_cast<uint32_t>(InAllocations.size());
+
+		OutPlacements.assign(allocationsNum, TRANSIENT_PLACEMENT());
+		m_HeapSize = 0;
+		m_NonAliasedSize = 0;
+
+		if (allocationsNum == 0)
+			return;
+
+		m_AllocatedOffsets.assign(allocationsNum, 0);
+		m_AllocatedSizes.assign(allocationsNum, 0);
+
+		// Visiting resources by first use. Bigger resources starting together go first, so that the smaller ones can fill the gaps they leave.
+		m_SortedAllocations.resize(allocationsNum);
+		std::iota(m_SortedAllocations.begin(), m_SortedAllocations.end(), 0);
+		std::sort(m_SortedAllocations.begin(), m_SortedAllocations.end(), [&InAllocations](uint32_t InFirstIdx, uint32_t InSecondIdx) {
+			const TRANSIENT_ALLOCATION_DESC& firstDesc = InAllocations[InFirstIdx];
+			const TRANSIENT_ALLOCATION_DESC& secondDesc = InAllocations[InSecondIdx];
+			if (firstDesc.FirstPassPos != secondDesc.FirstPassPos)
+				return firstDesc.FirstPassPos < secondDesc.FirstPassPos;
+			return firstDesc.Size > secondDesc.Size;
+		});
+
+		// The pool starts as big as possible, the heap size will be given by the highest offset reached by the placements
+		GEPUtils::Graphics::StaticRangeAllocator rangeAllocator(0, 0xffffffff);
+		uint32_t heapSizeInUnits = 0;
+
+		// Min-heap of the allocations currently holding memory, ordered by last use
+		m_ActiveAllocations.clear();
+		auto endsLaterFn = [&InAllocations](uint32_t InFirstIdx, uint32_t InSecondIdx) { return InAllocations[InFirstIdx].LastPassPos > InAllocations[InSecondIdx].LastPassPos; };
+
+		for (uint32_t allocationIdx : m_SortedAllocations)
+		{
+			const TRANSIENT_ALLOCATION_DESC& currentDesc = InAllocations[allocationIdx];
+
+			// Resources not used anymore give their memory back before placing the current one
+			while (!m_ActiveAllocations.empty() && InAllocations[m_ActiveAllocations.front()].LastPassPos < currentDesc.FirstPassPos)
+			{
+				std::pop_heap(m_ActiveAllocations.begin(), m_ActiveAllocations.end(), endsLaterFn);
+				const uint32_t endedAllocationIdx = m_ActiveAllocations.back();
+				m_ActiveAllocations.pop_back();
+
+				rangeAllocator.FreeAllocatedRange(m_AllocatedOffsets[endedAllocationIdx], m_AllocatedSizes[endedAllocationIdx]);
+			}
+
+			const uint32_t sizeInUnits = static_cast<uint32_t>(std::max<uint64_t>((currentDesc.Size + m_AllocationGranularity - 1) / m_AllocationGranularity, 1));
+			const uint32_t alignmentInUnits = static_cast<uint32_t>(std::max<uint64_t>((currentDesc.Alignment + m_AllocationGranularity - 1) / m_AllocationGranularity, 1));
+
+			const uint32_t offsetInUnits = rangeAllocator.AllocateAlignedRange(sizeInUnits, alignmentInUnits);
+
+			m_AllocatedOffsets[allocationIdx] = offsetInUnits;
+			m_AllocatedSizes[allocationIdx] = sizeInUnits;
+
+			OutPlacements[allocationIdx].HeapOffset = offsetInUnits * m_AllocationGranularity;
+
+			heapSizeInUnits = std::max(heapSizeInUnits, offsetInUnits + sizeInUnits);
+			m_NonAliasedSize += sizeInUnits * m_AllocationGranularity;
+
+			m_ActiveAllocations.push_back(allocationIdx);
+			std::push_heap(m_ActiveAllocations.begin(), m_ActiveAllocations.end(), endsLaterFn);
+		}
+
+		m_HeapSize = heapSizeInUnits * m_AllocationGranularity;
+
+		// Looking for allocations sharing memory with any other one: visiting them by offset,
+		// a range is shared when it starts before the end of a previous one or ends after the start of a next one.
+		std::sort(m_SortedAllocations.begin(), m_SortedAllocations.end(), [this](uint32_t InFirstIdx, uint32_t InSecondIdx) {
+			return m_AllocatedOffsets[InFirstIdx] < m_AllocatedOffsets[InSecondIdx];
+		});
+
+		uint32_t previousRangesEnd = 0;
+		for (uint32_t allocationIdx : m_SortedAllocations)
+		{
+			if (m_AllocatedOffsets[allocationIdx] < previousRangesEnd)
+				OutPlacements[allocationIdx].IsAliasing = true;
+			previousRangesEnd = std::max(previousRangesEnd, m_AllocatedOffsets[allocationIdx] + m_AllocatedSizes[allocationIdx]);
+		}
+
+		uint32_t nextRangesStart = 0xffffffff;
+		for (auto allocationIt = m_SortedAllocations.rbegin(); allocationIt != m_SortedAllocations.rend(); ++allocationIt)
+		{
+			if (m_AllocatedOffsets[*allocationIt] + m_AllocatedSizes[*allocationIt] > nextRangesStart)
+				OutPlacements[*allocationIt].IsAliasing = true;
+			nextRangesStart = std::min(nextRangesStart, m_AllocatedOffsets[*allocationIt]);
+		}
+	}
+
+} }
@@ -19,6 +19,8 @@ namespace GEPUtils {
 		class CommandList;
 		class Window; 
 		class GraphicsAllocatorBase;
+		class RenderGraph;
+		struct RenderGraphResourceHandle;
 		struct Rect;
 		struct ViewPort;
 	}
@@ -71,6 +73,10 @@ namespace GEPUtils {
 
 		virtual void RenderContent(Graphics::CommandList & InCmdList) = 0;
 
+		// Adds to the frame render graph the passes drawing the application content to the back buffer.
+		// By default a single pass calls RenderContent(..), derived classes can override this to declare the resources their passes use.
+		virtual void SetupRenderPasses(Graphics::RenderGraph& InRenderGraph, Graphics::RenderGraphResourceHandle InBackBuffer);
+
 		void SetAspectRatio(float InAspectRatio);
 		void SetFov(float InFov);
 
@@ -90,6 +96,9 @@ namespace GEPUtils {
 
 		std::unique_ptr<Graphics::ViewPort> m_Viewport = nullptr;
 
+		// Described again every frame, it keeps transient resources alive between frames
+		std::unique_ptr<Graphics::RenderGraph> m_RenderGraph;
+
 		bool m_IsInitialized = false;
 	
 
@@ -76,7 +76,7 @@ namespace GEPUtils {
 		template <class T, void (T::* InMemberFn)(PARAMS...)>
 		void Add(T* InObj)
 		{
-			m_InvocationList.push_back(typename InvocationElement(InObj, GetStubFromMemberFunction<T, InMemberFn>));
+			m_InvocationList.push_back(InvocationElement(InObj, GetStubFromMemberFunction<T, InMemberFn>));
 		}
 
 		void Broadcast(PARAMS... InArgs) const 
@@ -112,7 +112,7 @@ namespace GEPUtils {
 			StubType Stub = nullptr;
 		};
 
-		std::list<typename InvocationElement> m_InvocationList;
+		std::list<InvocationElement> m_InvocationList;
 	};
 
 }
@@ -0,0 +1,109 @@
+/*
+ GEPUtilsBVH.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsBVH_h__
+#define GEPUtilsBVH_h__
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Geometry>
+#include "GEPUtilsCulling.h"
+
+namespace GEPUtils {
+	namespace Geometry {
+
+		// Child index used by leaves and empty slots
+		static constexpr uint32_t g_BVHLeafChild = 0xffffffff;
+
+		// Deeper subtrees are turned into (bigger) leaves, this bounds the traversal stack size
+		static constexpr uint32_t g_BVHMaxDepth = 64;
+
+		// 4-wide node: the bounds of the 4 children are stored as structure of arrays, so that one node visit tests all of them with SSE.
+		// Each child covers a contiguous range of primitives, so a child entirely inside a frustum is accepted without visiting its subtree.
+		struct alignas(16) BVH4_NODE {
+			float MinX[4];
+			float MinY[4];
+			float MinZ[4];
+			float MaxX[4];
+			float MaxY[4];
+			float MaxZ[4];
+			uint32_t Children[4]; // Node index, or g_BVHLeafChild for leaves and empty slots
+			uint32_t PrimFirst[4];
+			uint32_t PrimCount[4]; // Zero for empty slots
+		};
+
+		// Bounding volume hierarchy over object AABBs, flattened in an array of 4-wide nodes in depth-first order (children always follow their parent).
+		// Built top-down with binned SAH splits: each node splits its largest child until it has 4 of them.
+		// Moving objects are handled with Refit(..), which keeps the topology and only updates the bounds: 
+		// query performance degrades as objects move far from their build positions, and at that point the hierarchy should be built again.
+		class BoundingVolumeHierarchy {
+		public:
+			explicit BoundingVolumeHierarchy(uint32_t InMaxLeafSize = 4);
+
+			void Build(const AABBS_SOA& InAABBs, uint32_t InObjectsNum);
+
+			// InAABBs needs to contain the same objects given to Build(..), with updated bounds
+			void Refit(const AABBS_SOA& InAABBs);
+
+			// Writes the indices of the objects whose AABB intersects the frustum, in no particular order, and returns how many there are.
+			// OutVisibleIndices needs space for all the objects. As CullAABBs(..), the test is conservative.
+			uint32_t QueryFrustum(const FRUSTUM_PLANES& InPlanes, uint32_t* OutVisibleIndices) const;
+
+			// Finds the closest object AABB hit by the ray within InMaxDistance (in units of InDirection length).
+			// Note: only object bounds are known here, callers needing exact hits can use this to find the candidates.
+			bool RayCast(const Eigen::Vector3f& InOrigin, const Eigen::Vector3f& InDirection, float InMaxDistance, uint32_t& OutObjectIdx, float& OutDistance) const;
+
+			const std::vector<BVH4_NODE>& GetNodes() const { return m_Nodes; }
+
+			// Object indices in leaf order, the ranges in BVH4_NODE::PrimFirst and PrimCount refer to this array
+			const std::vector<uint32_t>& GetPrimitiveIndices() const { return m_PrimIndices; }
+
+			uint32_t GetObjectsNum() const { return static_cast<uint32_t>(m_PrimIndices.size()); }
+
+			uint32_t GetDepth() const { return m_Depth; }
+
+		private:
+			struct BuildRange {
+				uint32_t First;
+				uint32_t Count;
+				Eigen::Array3f Min;
+				Eigen::Array3f Max;
+				float HalfArea() const;
+			};
+
+			struct BuildPrimitive {
+				Eigen::Array3f Min;
+				Eigen::Array3f Max;
+				Eigen::Array3f Center;
+				uint32_t ObjectIdx;
+			};
+
+			uint32_t BuildNode(const BuildRange& InRange, uint32_t InDepth);
+
+			void SplitRange(const BuildRange& InRange, BuildRange& OutLeft, BuildRange& OutRight);
+
+			void ComputeRangeBounds(BuildRange& InOutRange) const;
+
+			uint32_t m_MaxLeafSize;
+			uint32_t m_Depth = 0;
+
+			std::vector<BVH4_NODE> m_Nodes;
+			std::vector<uint32_t> m_PrimIndices;
+
+			// Primitive bounds in leaf order, so that leaves read contiguous memory
+			std::vector<float> m_PrimMinX, m_PrimMinY, m_PrimMinZ;
+			std::vector<float> m_PrimMaxX, m_PrimMaxY, m_PrimMaxZ;
+
+			// Only used while building, kept to avoid allocations when building again
+			std::vector<BuildPrimitive> m_BuildPrims;
+		};
+
+	}
+}
+
+#endif // GEPUtilsBVH_h__
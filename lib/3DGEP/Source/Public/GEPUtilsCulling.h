@@ -0,0 +1,107 @@
+/*
+ GEPUtilsCulling.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsCulling_h__
+#define GEPUtilsCulling_h__
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Geometry>
+
+namespace GEPUtils {
+
+	class ThreadPool;
+
+	namespace Geometry {
+
+		enum FRUSTUM_PLANE : uint32_t {
+			FRUSTUM_PLANE_LEFT,
+			FRUSTUM_PLANE_RIGHT,
+			FRUSTUM_PLANE_BOTTOM,
+			FRUSTUM_PLANE_TOP,
+			FRUSTUM_PLANE_NEAR,
+			FRUSTUM_PLANE_FAR,
+			FRUSTUM_PLANES_NUM
+		};
+
+		// Each plane is stored as (Normal, D) with the normal pointing inside the frustum and unit length,
+		// so that Normal.dot(P) + D is the signed distance of point P from the plane.
+		struct FRUSTUM_PLANES {
+			Eigen::Vector4f Planes[FRUSTUM_PLANES_NUM];
+		};
+
+		// Extracts the planes from a projection matrix following D3D clip space conventions (0 <= z <= w), as the one returned by Perspective(..).
+		// Planes are expressed in the space the matrix transforms from: passing Proj * View gives world space planes, passing Proj * View * Model gives object space planes.
+		FRUSTUM_PLANES ExtractFrustumPlanes(const Eigen::Matrix4f& InViewProjMatrix);
+
+		// Scalar test for a single sphere, conservative as the batch kernels
+		inline bool IsSphereInFrustum(const FRUSTUM_PLANES& InPlanes, const Eigen::Vector3f& InCenter, float InRadius)
+		{
+			for (const Eigen::Vector4f& currentPlane : InPlanes.Planes)
+			{
+				if (currentPlane.head<3>().dot(InCenter) + currentPlane.w() < -InRadius)
+					return false;
+			}
+			return true;
+		}
+
+		// Bounding spheres as structure of arrays, one array per component, so that the kernels can load 4 objects per instruction
+		struct BOUNDING_SPHERES_SOA {
+			const float* CenterX;
+			const float* CenterY;
+			const float* CenterZ;
+			const float* Radius;
+		};
+
+		// Axis aligned bounding boxes in center-extent form (extents are half sizes), as structure of arrays
+		struct AABBS_SOA {
+			const float* CenterX;
+			const float* CenterY;
+			const float* CenterZ;
+			const float* ExtentX;
+			const float* ExtentY;
+			const float* ExtentZ;
+		};
+
+		// Culling kernels: test objects in [InBegin, InEnd) against the 6 planes, 4 objects at a time with SSE2, 
+		// and write the indices of the visible ones, in increasing order, to OutVisibleIndices, returning how many there are.
+		// OutVisibleIndices needs space for InEnd - InBegin indices.
+		// Note: the test is conservative, objects intersecting two planes outside the frustum corners are reported as visible.
+		uint32_t CullSpheres(const FRUSTUM_PLANES& InPlanes, const BOUNDING_SPHERES_SOA& InSpheres, uint32_t InBegin, uint32_t InEnd, uint32_t* OutVisibleIndices);
+
+		uint32_t CullAABBs(const FRUSTUM_PLANES& InPlanes, const AABBS_SOA& InAABBs, uint32_t InBegin, uint32_t InEnd, uint32_t* OutVisibleIndices);
+
+		// Splits the objects in contiguous partitions culled in parallel on a thread pool, the calling thread culls the first partition.
+		// Each partition writes its visible indices at its own offset of the output, then the results are compacted in place,
+		// so the output is the same as the single threaded kernels.
+		// Only the partitions of the call are waited for (see ThreadPool::Wait(..)), so culling can run next to other pool tasks, or inside one of them.
+		class FrustumCuller {
+		public:
+			// With no thread pool, or less than InMinObjectsPerPartition objects, culling happens on the calling thread only
+			explicit FrustumCuller(GEPUtils::ThreadPool* InThreadPool = nullptr, uint32_t InMinObjectsPerPartition = 16 * 1024);
+
+			// OutVisibleIndices needs space for InObjectsNum indices
+			uint32_t CullSpheres(const FRUSTUM_PLANES& InPlanes, const BOUNDING_SPHERES_SOA& InSpheres, uint32_t InObjectsNum, uint32_t* OutVisibleIndices);
+
+			uint32_t CullAABBs(const FRUSTUM_PLANES& InPlanes, const AABBS_SOA& InAABBs, uint32_t InObjectsNum, uint32_t* OutVisibleIndices);
+
+		private:
+			template<typename KernelFnType>
+			uint32_t CullPartitioned(uint32_t InObjectsNum, uint32_t* OutVisibleIndices, const KernelFnType& InKernel);
+
+			GEPUtils::ThreadPool* m_ThreadPool;
+			uint32_t m_MinObjectsPerPartition;
+
+			// Kept between calls to avoid allocations
+			std::vector<uint32_t> m_PartitionVisibleNums;
+		};
+
+	}
+}
+
+#endif // GEPUtilsCulling_h__
@@ -0,0 +1,52 @@
+/*
+ GEPUtilsHash.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsHash_h__
+#define GEPUtilsHash_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace GEPUtils {
+	namespace Hash {
+
+		// 64 bit FNV-1a, http://www.isthe.com/chongo/tech/comp/fnv/index.html
+		// The result only depends on the hashed bytes, so it is stable between runs and can be stored on disk.
+		static constexpr uint64_t g_FnvOffsetBasis = 14695981039346656037ull;
+		static constexpr uint64_t g_FnvPrime = 1099511628211ull;
+
+		inline uint64_t HashBytes(const void* InData, size_t InSize, uint64_t InSeed = g_FnvOffsetBasis)
+		{
+			const uint8_t* currentByte = static_cast<const uint8_t*>(InData);
+			uint64_t outHash = InSeed;
+			for (size_t byteIdx = 0; byteIdx < InSize; byteIdx++)
+			{
+				outHash ^= currentByte[byteIdx];
+				outHash *= g_FnvPrime;
+			}
+			return outHash;
+		}
+
+		// Note: only meant for single values (integers, enums, floats), hashing structs directly would include their padding bytes
+		template<typename T>
+		inline uint64_t HashValue(const T& InValue, uint64_t InSeed)
+		{
+			static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "HashValue only accepts arithmetic and enum types");
+			return HashBytes(&InValue, sizeof(T), InSeed);
+		}
+
+		// The length is hashed too, so that consecutive strings cannot produce the same bytes sequence
+		inline uint64_t HashString(const std::string& InString, uint64_t InSeed)
+		{
+			return HashBytes(InString.data(), InString.size(), HashValue(InString.size(), InSeed));
+		}
+	}
+}
+#endif // GEPUtilsHash_h__
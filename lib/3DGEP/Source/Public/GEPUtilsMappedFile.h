@@ -0,0 +1,65 @@
+/*
+ GEPUtilsMappedFile.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsMappedFile_h__
+#define GEPUtilsMappedFile_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace GEPUtils {
+
+	// Converts a wide string (e.g. a path) to UTF-8, with the platform conversion on Windows
+	std::string WideToUtf8(const std::wstring& InWideString);
+
+	// Read-only view of a whole file mapped in memory.
+	// Pages are loaded by the OS only when accessed, so opening a big file costs almost nothing until its content is read.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator= (const MappedFile&) = delete;
+
+		// Returns false if the file does not exist or cannot be mapped. Empty files cannot be mapped either.
+		bool Open(const std::string& InFilePath);
+
+		bool Open(const std::wstring& InFilePath);
+
+		// Unmaps the file, pointers previously returned by GetData() are not valid anymore
+		void Close();
+
+		bool IsOpen() const { return m_Data != nullptr; }
+
+		const uint8_t* GetData() const { return m_Data; }
+
+		size_t GetSize() const { return m_Size; }
+
+		// Last modification time of the file when it was opened, in platform units. Only meant to be compared with another value from the same file.
+		uint64_t GetLastWriteTime() const { return m_LastWriteTime; }
+
+	private:
+#ifdef _WIN32
+		// Takes ownership of the file handle
+		bool MapFileHandle(void* InFileHandle);
+#endif
+
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+		uint64_t m_LastWriteTime = 0;
+#ifdef _WIN32
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+#endif
+	};
+
+}
+#endif // GEPUtilsMappedFile_h__
@@ -0,0 +1,117 @@
+/*
+ GEPUtilsOcclusion.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsOcclusion_h__
+#define GEPUtilsOcclusion_h__
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Geometry>
+#include "GEPUtilsCulling.h"
+
+namespace GEPUtils {
+
+	class ThreadPool;
+
+	namespace Geometry {
+
+		// Low resolution depth buffer rendered on CPU from occluder meshes, used to discard objects hidden behind them before submitting their draws.
+		// Follows D3D conventions as Perspective(..): depth is z/w in [0, 1] with 0 on the near plane, and closer occluders win.
+		// The screen is divided in tiles of g_OcclusionTileSize pixels, triangles are binned to the tiles they overlap 
+		// and each tile is rasterized independently, 4 pixels at a time with SSE2, so tiles can be spread across worker threads.
+		// Rasterize(..) then builds a hierarchical depth buffer, where each level keeps the farthest depth of 2x2 texels of the previous one,
+		// so that object bounds are tested against a few texels whatever their size on screen.
+		// Note: occluder triangles crossing the near plane are dropped (not clipped), which only makes occlusion less aggressive.
+		class OcclusionRasterizer {
+		public:
+			static constexpr uint32_t g_OcclusionTileSize = 32;
+
+			// Sizes are rounded up to multiples of the tile size
+			OcclusionRasterizer(uint32_t InWidth = 320, uint32_t InHeight = 192);
+
+			OcclusionRasterizer(const OcclusionRasterizer&) = delete;
+			OcclusionRasterizer& operator= (const OcclusionRasterizer&) = delete;
+
+			// Forgets the occluders of the previous frame
+			void BeginFrame(const Eigen::Matrix4f& InViewProjMatrix);
+
+			// InPositions points to the first vertex position, made of 3 floats, with InVertexStride bytes between consecutive vertices.
+			// Both triangle windings are rasterized, so occluders do not need a specific front face convention.
+			// Triangles with a vertex on the camera side of the near plane are dropped entirely instead of clipped: large occluders close to the camera,
+			// like a wall the camera walks along, should be split in smaller triangles or they stop occluding anything.
+			void AddOccluder(const void* InPositions, uint32_t InVertexStride, uint32_t InVerticesNum, const uint16_t* InIndices, uint32_t InIndicesNum, const Eigen::Matrix4f& InModelMatrix);
+
+			void AddOccluder(const void* InPositions, uint32_t InVertexStride, uint32_t InVerticesNum, const uint32_t* InIndices, uint32_t InIndicesNum, const Eigen::Matrix4f& InModelMatrix);
+
+			// Renders the occluders added since BeginFrame(..) and builds the hierarchical depth buffer.
+			// With a thread pool, tiles are shared between its workers and the calling thread (only the tasks of this call are waited for).
+			void Rasterize(GEPUtils::ThreadPool* InThreadPool = nullptr);
+
+			// Conservative test of a world space AABB: false only if it is entirely behind the rendered occluders or outside the screen
+			bool IsAABBVisible(const Eigen::Vector3f& InMin, const Eigen::Vector3f& InMax) const;
+
+			// Removes from InOutIndices the objects that are occluded, keeping the order of the others, and returns how many are left.
+			// Meant to run on the output of frustum culling.
+			uint32_t FilterVisibleAABBs(const AABBS_SOA& InAABBs, uint32_t* InOutIndices, uint32_t InIndicesNum) const;
+
+			uint32_t GetWidth() const { return m_Width; }
+
+			uint32_t GetHeight() const { return m_Height; }
+
+			// Full resolution depth, row major
+			const float* GetDepthBuffer() const { return m_HiZLevels[0].MaxDepths.data(); }
+
+			uint32_t GetTrianglesNum() const { return static_cast<uint32_t>(m_Triangles.size()); }
+
+		private:
+			// Screen space triangle, with the edge functions and the depth plane evaluated at pixel centers
+			struct TRIANGLE_SETUP {
+				float EdgeA[3];
+				float EdgeB[3];
+				float EdgeC[3];
+				float DepthDx;
+				float DepthDy;
+				float Depth0;
+				int32_t MinX, MinY, MaxX, MaxY;
+			};
+
+			struct HiZLevel {
+				uint32_t Width;
+				uint32_t Height;
+				std::vector<float> MaxDepths;
+			};
+
+			template<typename IndexType>
+			void AddOccluderTriangles(const void* InPositions, uint32_t InVertexStride, uint32_t InVerticesNum, const IndexType* InIndices, uint32_t InIndicesNum, const Eigen::Matrix4f& InModelMatrix);
+
+			void SetupTriangle(const Eigen::Vector4f& InClip0, const Eigen::Vector4f& InClip1, const Eigen::Vector4f& InClip2);
+
+			void RasterizeTile(uint32_t InTileIdx);
+
+			void BuildHiZ();
+
+			uint32_t m_Width;
+			uint32_t m_Height;
+			uint32_t m_TilesX;
+			uint32_t m_TilesY;
+
+			Eigen::Matrix4f m_ViewProjMatrix;
+
+			// Kept between frames to avoid allocations
+			std::vector<Eigen::Vector4f> m_ClipVertices;
+			std::vector<TRIANGLE_SETUP> m_Triangles;
+			std::vector<std::vector<uint32_t>> m_TileTriangles;
+
+			// Level zero is the full resolution depth buffer
+			std::vector<HiZLevel> m_HiZLevels;
+		};
+
+	}
+}
+
+#endif // GEPUtilsOcclusion_h__
@@ -0,0 +1,81 @@
+/*
+ GEPUtilsSceneGraph.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsSceneGraph_h__
+#define GEPUtilsSceneGraph_h__
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+
+namespace GEPUtils {
+	namespace Geometry {
+
+		// Parent index of root nodes
+		static constexpr uint32_t g_SceneGraphNoParent = 0xffffffff;
+
+		// Hierarchy of transforms stored as flat arrays indexed by node, where every node comes after its parent.
+		// Editing the local transform of a node only flags it, then UpdateWorldMatrices() recomputes the world matrices with one linear sweep
+		// starting from the first flagged node: since parents are always visited before their children, a node is recomputed when it is flagged
+		// or when its parent was recomputed in the same sweep, so whole subtrees follow their root without walking any pointer.
+		// Nodes that did not change (e.g. static objects) keep their world matrix from the previous update.
+		class SceneGraph {
+		public:
+			explicit SceneGraph(uint32_t InExpectedNodesNum = 0);
+
+			// InParentIdx needs to be an already added node, or g_SceneGraphNoParent for a root node
+			uint32_t AddNode(uint32_t InParentIdx, const Eigen::Vector3f& InLocalPosition, const Eigen::Quaternionf& InLocalRotation, const Eigen::Vector3f& InLocalScale);
+
+			void SetLocalPosition(uint32_t InNodeIdx, const Eigen::Vector3f& InPosition);
+
+			void SetLocalRotation(uint32_t InNodeIdx, const Eigen::Quaternionf& InRotation);
+
+			void SetLocalScale(uint32_t InNodeIdx, const Eigen::Vector3f& InScale);
+
+			const Eigen::Vector3f& GetLocalPosition(uint32_t InNodeIdx) const { return m_LocalPositions[InNodeIdx]; }
+
+			const Eigen::Quaternionf& GetLocalRotation(uint32_t InNodeIdx) const { return m_LocalRotations[InNodeIdx]; }
+
+			const Eigen::Vector3f& GetLocalScale(uint32_t InNodeIdx) const { return m_LocalScales[InNodeIdx]; }
+
+			uint32_t GetParent(uint32_t InNodeIdx) const { return m_ParentIndices[InNodeIdx]; }
+
+			// Recomputes the world matrices of the changed nodes and their descendants
+			void UpdateWorldMatrices();
+
+			// Only valid after UpdateWorldMatrices(), local edits made after it are not reflected
+			const Eigen::Matrix4f& GetWorldMatrix(uint32_t InNodeIdx) const { return m_WorldTransforms[InNodeIdx].matrix(); }
+
+			// Nodes whose world matrix changed in the last UpdateWorldMatrices(), in ascending order, e.g. to upload only their constants
+			const std::vector<uint32_t>& GetUpdatedNodes() const { return m_UpdatedNodes; }
+
+			uint32_t GetNodesNum() const { return static_cast<uint32_t>(m_ParentIndices.size()); }
+
+		private:
+			void MarkDirty(uint32_t InNodeIdx);
+
+			std::vector<uint32_t> m_ParentIndices;
+			std::vector<Eigen::Vector3f> m_LocalPositions;
+			std::vector<Eigen::Quaternionf, Eigen::aligned_allocator<Eigen::Quaternionf>> m_LocalRotations;
+			std::vector<Eigen::Vector3f> m_LocalScales;
+			std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f>> m_WorldTransforms;
+
+			// Set by local edits and during the sweep, for the nodes whose world matrix needs to be recomputed
+			std::vector<uint8_t> m_IsDirty;
+
+			// Lowest dirty node, the sweep starts from here. Equal to the nodes number when nothing changed.
+			uint32_t m_FirstDirtyNode = 0;
+
+			std::vector<uint32_t> m_UpdatedNodes;
+		};
+
+	}
+}
+
+#endif // GEPUtilsSceneGraph_h__
@@ -0,0 +1,92 @@
+/*
+ GEPUtilsThreadPool.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsThreadPool_h__
+#define GEPUtilsThreadPool_h__
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GEPUtils {
+
+	// Set of tasks that can be waited with ThreadPool::Wait(..) independently from the other tasks in the pool.
+	// The counter is protected by the mutex of the pool, so a group is meant to be used with a single pool.
+	class TaskGroup {
+	public:
+		TaskGroup() = default;
+
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator= (const TaskGroup&) = delete;
+
+	private:
+		friend class ThreadPool;
+
+		uint32_t m_PendingTasksNum = 0;
+	};
+
+	// Fixed number of worker threads executing tasks in the order they are enqueued.
+	// Tasks are not allowed to throw, exceptions need to be handled (or forwarded, e.g. to a std::promise) inside the task.
+	class ThreadPool {
+	public:
+		// Zero threads means one for each hardware thread, except the calling one
+		explicit ThreadPool(uint32_t InThreadsNum = 0);
+
+		// Executes all the tasks still in the queue before joining the threads
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator= (const ThreadPool&) = delete;
+
+		void Enqueue(std::function<void()> InTask);
+
+		// The group needs to outlive the task, waiting on it with Wait(..) guarantees that
+		void Enqueue(std::function<void()> InTask, TaskGroup& InGroup);
+
+		// Blocks until all the tasks of the group are done. Tasks of the group still in the queue are executed by the calling thread,
+		// so waiting from inside a pool task cannot deadlock, and tasks of other groups are never waited for.
+		void Wait(TaskGroup& InGroup);
+
+		// Blocks until the queue is empty and no task is executing
+		void WaitIdle();
+
+		// Splits [0, InItemsNum) in contiguous ranges, one per thread but not smaller than InMinItemsPerRange, and calls InRangeFn on each of them.
+		// Range beginnings are multiples of InMinItemsPerRange (e.g. to keep SIMD groups whole). The calling thread executes the first range,
+		// then waits for the other ranges only, with a TaskGroup of its own, so it can also be called from pool tasks.
+		void ParallelFor(uint32_t InItemsNum, uint32_t InMinItemsPerRange, const std::function<void(uint32_t, uint32_t)>& InRangeFn);
+
+		uint32_t GetThreadsNum() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+	private:
+		struct QueuedTask {
+			std::function<void()> Function;
+			TaskGroup* Group; // Null for tasks enqueued without a group
+		};
+
+		void WorkerLoop();
+
+		// Runs the task with the lock released, InLock is locked again on return
+		void ExecuteTask(QueuedTask& InTask, std::unique_lock<std::mutex>& InLock);
+
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_TaskAvailableCV;
+		std::condition_variable m_IdleCV;
+		std::condition_variable m_GroupDoneCV;
+		std::deque<QueuedTask> m_Tasks;
+		uint32_t m_ExecutingTasksNum = 0;
+		bool m_IsStopping = false;
+	};
+
+}
+#endif // GEPUtilsThreadPool_h__
@@ -0,0 +1,76 @@
+/*
+ GEPUtilsTransforms.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef GEPUtilsTransforms_h__
+#define GEPUtilsTransforms_h__
+
+#include <cstdint>
+#include <vector>
+#include <Eigen/Geometry>
+
+namespace GEPUtils {
+
+	class ThreadPool;
+
+	namespace Geometry {
+
+		// Used as TRANSFORM_OUTPUT_DESC::WorldOffset when world matrices are not needed
+		static constexpr uint32_t g_TransformNoOutput = 0xffffffff;
+
+		// Where ComputeMatrices(..) writes the matrices of each object, as column major 4x4 floats (same layout as Eigen and HLSL float4x4).
+		// Object i writes at Destination + i * Stride + MvpOffset (and + WorldOffset).
+		struct TRANSFORM_OUTPUT_DESC {
+			void* Destination = nullptr;
+			uint32_t Stride = 16 * sizeof(float);
+			uint32_t MvpOffset = 0;
+			uint32_t WorldOffset = g_TransformNoOutput;
+		};
+
+		// Translation, rotation and scale of many objects stored as structure of arrays, one array per component.
+		// World matrices (T * R * S) and MVP matrices are computed for 4 objects at a time with SSE2, with each lane working on a different object,
+		// and then transposed to be written straight to the destination (e.g. mapped upload memory or ObjectConstantsStream::AllocateObjects(..)).
+		// Destination memory is only written, never read, so it can be write-combined.
+		class TransformSystem {
+		public:
+			explicit TransformSystem(uint32_t InExpectedObjectsNum = 0);
+
+			uint32_t AddObject(const Eigen::Vector3f& InPosition, const Eigen::Quaternionf& InRotation, const Eigen::Vector3f& InScale);
+
+			void SetPosition(uint32_t InObjectIdx, const Eigen::Vector3f& InPosition);
+
+			// InRotation is expected to be normalized
+			void SetRotation(uint32_t InObjectIdx, const Eigen::Quaternionf& InRotation);
+
+			void SetScale(uint32_t InObjectIdx, const Eigen::Vector3f& InScale);
+
+			// Writes the matrices of all the objects. With a thread pool, objects are split across its workers and the calling thread.
+			void ComputeMatrices(const Eigen::Matrix4f& InViewProjMatrix, const TRANSFORM_OUTPUT_DESC& InOutputDesc, GEPUtils::ThreadPool* InThreadPool = nullptr) const;
+
+			// Same as ComputeMatrices(..) but only for objects in [InBegin, InEnd), InBegin needs to be a multiple of 4
+			void ComputeMatricesRange(const Eigen::Matrix4f& InViewProjMatrix, const TRANSFORM_OUTPUT_DESC& InOutputDesc, uint32_t InBegin, uint32_t InEnd) const;
+
+			uint32_t GetObjectsNum() const { return m_ObjectsNum; }
+
+			// Component arrays, for systems updating many objects at once (e.g. animation or physics)
+			float* GetPositionsX() { return m_PositionsX.data(); }
+			float* GetPositionsY() { return m_PositionsY.data(); }
+			float* GetPositionsZ() { return m_PositionsZ.data(); }
+
+		private:
+			uint32_t m_ObjectsNum = 0;
+
+			// Arrays are padded to a multiple of 4 objects, so that the last SIMD group can always be loaded
+			std::vector<float> m_PositionsX, m_PositionsY, m_PositionsZ;
+			std::vector<float> m_RotationsX, m_RotationsY, m_RotationsZ, m_RotationsW;
+			std::vector<float> m_ScalesX, m_ScalesY, m_ScalesZ;
+		};
+
+	}
+}
+
+#endif // GEPUtilsTransforms_h__
@@ -0,0 +1,132 @@
+/*
+ BVHBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsBVH.h"
+#include "GEPUtilsGeometry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	using BenchClock = std::chrono::steady_clock;
+
+	// Best time of a few runs, to filter out the noise of the other processes
+	template<typename BenchFnType>
+	double MeasureBestMs(const BenchFnType& InBenchFn)
+	{
+		constexpr uint32_t runsNum = 10;
+
+		double bestMs = 1e9;
+		for (uint32_t runIdx = 0; runIdx < runsNum; runIdx++)
+		{
+			const BenchClock::time_point startTime = BenchClock::now();
+			InBenchFn();
+			bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(BenchClock::now() - startTime).count());
+		}
+		return bestMs;
+	}
+
+}
+
+// Measures build, refit, frustum query and ray casts of the BVH on 100k objects, against the linear culling kernel and a linear ray cast
+int main()
+{
+	constexpr uint32_t objectsNum = 100000;
+	constexpr uint32_t raysNum = 1000;
+
+	std::mt19937 randomGenerator(objectsNum);
+	std::uniform_real_distribution<float> positionDistribution(-150.f, 150.f);
+	std::uniform_real_distribution<float> sizeDistribution(0.1f, 2.f);
+	std::uniform_real_distribution<float> offsetDistribution(-1.f, 1.f);
+
+	std::vector<float> centerX(objectsNum), centerY(objectsNum), centerZ(objectsNum), extentX(objectsNum), extentY(objectsNum), extentZ(objectsNum);
+	for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+	{
+		centerX[objectIdx] = positionDistribution(randomGenerator);
+		centerY[objectIdx] = positionDistribution(randomGenerator);
+		centerZ[objectIdx] = positionDistribution(randomGenerator);
+		extentX[objectIdx] = sizeDistribution(randomGenerator);
+		extentY[objectIdx] = sizeDistribution(randomGenerator);
+		extentZ[objectIdx] = sizeDistribution(randomGenerator);
+	}
+	const AABBS_SOA aabbs = { centerX.data(), centerY.data(), centerZ.data(), extentX.data(), extentY.data(), extentZ.data() };
+
+	// Narrow view, where the hierarchy can skip most of the scene
+	const Eigen::Matrix4f viewMatrix = LookAt(Eigen::Vector3f(0.f, 0.f, -200.f), Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitY());
+	const FRUSTUM_PLANES frustumPlanes = ExtractFrustumPlanes(Perspective(0.1f, 400.f, 16.f / 9.f, 0.3f) * viewMatrix);
+
+	std::vector<Eigen::Vector3f> rayOrigins, rayDirections;
+	for (uint32_t rayIdx = 0; rayIdx < raysNum; rayIdx++)
+	{
+		rayOrigins.emplace_back(positionDistribution(randomGenerator), positionDistribution(randomGenerator), positionDistribution(randomGenerator));
+		rayDirections.push_back(Eigen::Vector3f(offsetDistribution(randomGenerator), offsetDistribution(randomGenerator), offsetDistribution(randomGenerator)).normalized());
+	}
+
+	BoundingVolumeHierarchy bvh;
+	const double buildMs = MeasureBestMs([&]() { bvh.Build(aabbs, objectsNum); });
+
+	// Small movements, as for animated objects between two frames
+	std::vector<float> movedCenterX(centerX);
+	for (float& currentCenterX : movedCenterX)
+		currentCenterX += offsetDistribution(randomGenerator);
+	const AABBS_SOA movedAABBs = { movedCenterX.data(), centerY.data(), centerZ.data(), extentX.data(), extentY.data(), extentZ.data() };
+	const double refitMs = MeasureBestMs([&]() { bvh.Refit(movedAABBs); });
+
+	std::vector<uint32_t> visibleIndices(objectsNum);
+	uint32_t bvhVisibleNum = 0, linearVisibleNum = 0;
+	const double queryMs = MeasureBestMs([&]() { bvhVisibleNum = bvh.QueryFrustum(frustumPlanes, visibleIndices.data()); });
+	const double linearQueryMs = MeasureBestMs([&]() { linearVisibleNum = CullAABBs(frustumPlanes, movedAABBs, 0, objectsNum, visibleIndices.data()); });
+
+	uint32_t hitsNum = 0;
+	const double rayCastMs = MeasureBestMs([&]() {
+		hitsNum = 0;
+		uint32_t hitObjectIdx = 0;
+		float hitDistance = 0.f;
+		for (uint32_t rayIdx = 0; rayIdx < raysNum; rayIdx++)
+			hitsNum += bvh.RayCast(rayOrigins[rayIdx], rayDirections[rayIdx], 300.f, hitObjectIdx, hitDistance) ? 1 : 0;
+	});
+
+	// Linear ray cast on a tenth of the rays, since it is a thousand times slower
+	uint32_t linearHitsNum = 0;
+	const double linearRayCastMs = 10. * MeasureBestMs([&]() {
+		linearHitsNum = 0;
+		for (uint32_t rayIdx = 0; rayIdx < raysNum; rayIdx += 10)
+		{
+			const Eigen::Array3f inverseDirection = rayDirections[rayIdx].array().inverse();
+			float closestDistance = 300.f;
+			bool hasHit = false;
+			for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+			{
+				const Eigen::Array3f center(movedCenterX[objectIdx], centerY[objectIdx], centerZ[objectIdx]);
+				const Eigen::Array3f extent(extentX[objectIdx], extentY[objectIdx], extentZ[objectIdx]);
+				const Eigen::Array3f t0 = (center - extent - rayOrigins[rayIdx].array()) * inverseDirection;
+				const Eigen::Array3f t1 = (center + extent - rayOrigins[rayIdx].array()) * inverseDirection;
+				const float tNear = std::max(0.f, t0.min(t1).maxCoeff()), tFar = std::min(closestDistance, t0.max(t1).minCoeff());
+				if (tNear <= tFar)
+				{
+					closestDistance = tNear;
+					hasHit = true;
+				}
+			}
+			linearHitsNum += hasHit ? 1 : 0;
+		}
+	});
+
+	std::printf("%u objects, depth %u, best of 10 runs\n", objectsNum, bvh.GetDepth());
+	std::printf("%-24s %10s %10s\n", "", "BVH ms", "linear ms");
+	std::printf("%-24s %10.3f %10s\n", "build", buildMs, "-");
+	std::printf("%-24s %10.3f %10s\n", "refit", refitMs, "-");
+	std::printf("%-24s %10.3f %10.3f   visible %u / %u\n", "frustum query", queryMs, linearQueryMs, bvhVisibleNum, linearVisibleNum);
+	std::printf("%-24s %10.3f %10.3f   hits %u / %u (linear on 1 ray in 10)\n", "1000 ray casts", rayCastMs, linearRayCastMs, hitsNum, linearHitsNum);
+
+	return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ BVHTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "GEPUtilsBVH.h"
+#include "GEPUtilsGeometry.h"
+#include <algorithm>
+#include <limits>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	// Objects closer than this to a plane, or rays closer than this to a box edge, can be reported either way
+	constexpr double g_Tolerance = 1e-3;
+
+	struct TestObjects {
+		std::vector<float> CenterX, CenterY, CenterZ, ExtentX, ExtentY, ExtentZ;
+
+		AABBS_SOA GetAABBs() const { return { CenterX.data(), CenterY.data(), CenterZ.data(), ExtentX.data(), ExtentY.data(), ExtentZ.data() }; }
+
+		uint32_t GetObjectsNum() const { return static_cast<uint32_t>(CenterX.size()); }
+	};
+
+	TestObjects MakeTestObjects(uint32_t InObjectsNum, std::mt19937& InRandomGenerator)
+	{
+		std::uniform_real_distribution<float> positionDistribution(-60.f, 60.f);
+		std::uniform_real_distribution<float> extentDistribution(0.1f, 2.f);
+
+		TestObjects outObjects;
+		for (uint32_t objectIdx = 0; objectIdx < InObjectsNum; objectIdx++)
+		{
+			outObjects.CenterX.push_back(positionDistribution(InRandomGenerator));
+			outObjects.CenterY.push_back(positionDistribution(InRandomGenerator));
+			outObjects.CenterZ.push_back(positionDistribution(InRandomGenerator));
+			outObjects.ExtentX.push_back(extentDistribution(InRandomGenerator));
+			outObjects.ExtentY.push_back(extentDistribution(InRandomGenerator));
+			outObjects.ExtentZ.push_back(extentDistribution(InRandomGenerator));
+		}
+		return outObjects;
+	}
+
+	FRUSTUM_PLANES MakeTestFrustum()
+	{
+		const Eigen::Matrix4f viewMatrix = LookAt(Eigen::Vector3f(5.f, 3.f, -20.f), Eigen::Vector3f(0.f, 0.f, 10.f), Eigen::Vector3f::UnitY());
+		return ExtractFrustumPlanes(Perspective(0.5f, 50.f, 16.f / 9.f, 1.f) * viewMatrix);
+	}
+
+	// Smallest signed distance of the box from the planes, in double precision: the box intersects the frustum when it is not negative
+	double GetFrustumMargin(const FRUSTUM_PLANES& InPlanes, const TestObjects& InObjects, uint32_t InObjectIdx)
+	{
+		double outMargin = 1e30;
+		for (const Eigen::Vector4f& currentPlane : InPlanes.Planes)
+		{
+			const double distance = static_cast<double>(currentPlane.x()) * InObjects.CenterX[InObjectIdx] + static_cast<double>(currentPlane.y()) * InObjects.CenterY[InObjectIdx]
+				+ static_cast<double>(currentPlane.z()) * InObjects.CenterZ[InObjectIdx] + currentPlane.w();
+			const double projectedRadius = std::abs(static_cast<double>(currentPlane.x())) * InObjects.ExtentX[InObjectIdx] + std::abs(static_cast<double>(currentPlane.y())) * InObjects.ExtentY[InObjectIdx]
+				+ std::abs(static_cast<double>(currentPlane.z())) * InObjects.ExtentZ[InObjectIdx];
+			outMargin = std::min(outMargin, distance + projectedRadius);
+		}
+		return outMargin;
+	}
+
+	// Every object is reported at most once, and the objects clearly inside or outside the frustum agree with the brute force test
+	bool IsQueryMatchingBruteForce(const BoundingVolumeHierarchy& InBVH, const TestObjects& InObjects, const FRUSTUM_PLANES& InPlanes)
+	{
+		const uint32_t objectsNum = InObjects.GetObjectsNum();
+		std::vector<uint32_t> visibleIndices(objectsNum);
+		const uint32_t visibleNum = InBVH.QueryFrustum(InPlanes, visibleIndices.data());
+		if (visibleNum > objectsNum)
+			return false;
+
+		std::vector<bool> isReportedVisible(objectsNum, false);
+		for (uint32_t visibleIdx = 0; visibleIdx < visibleNum; visibleIdx++)
+		{
+			const uint32_t objectIdx = visibleIndices[visibleIdx];
+			if (objectIdx >= objectsNum || isReportedVisible[objectIdx])
+				return false;
+			isReportedVisible[objectIdx] = true;
+		}
+
+		for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+		{
+			const double margin = GetFrustumMargin(InPlanes, InObjects, objectIdx);
+			if ((margin > g_Tolerance && !isReportedVisible[objectIdx]) || (margin < -g_Tolerance && isReportedVisible[objectIdx]))
+				return false;
+		}
+		return true;
+	}
+
+	// Slab test in double precision, returns the entry distance or infinity when the box is missed
+	double GetRayBoxDistance(const Eigen::Vector3d& InOrigin, const Eigen::Vector3d& InDirection, double InMaxDistance, const TestObjects& InObjects, uint32_t InObjectIdx)
+	{
+		const Eigen::Vector3d center(InObjects.CenterX[InObjectIdx], InObjects.CenterY[InObjectIdx], InObjects.CenterZ[InObjectIdx]);
+		const Eigen::Vector3d extent(InObjects.ExtentX[InObjectIdx], InObjects.ExtentY[InObjectIdx], InObjects.ExtentZ[InObjectIdx]);
+
+		double tNear = 0., tFar = InMaxDistance;
+		for (uint32_t axisIdx = 0; axisIdx < 3; axisIdx++)
+		{
+			const double slabMin = center[axisIdx] - extent[axisIdx], slabMax = center[axisIdx] + extent[axisIdx];
+			if (InDirection[axisIdx] == 0.)
+			{
+				if (InOrigin[axisIdx] < slabMin || InOrigin[axisIdx] > slabMax)
+					return std::numeric_limits<double>::infinity();
+				continue;
+			}
+			const double t0 = (slabMin - InOrigin[axisIdx]) / InDirection[axisIdx], t1 = (slabMax - InOrigin[axisIdx]) / InDirection[axisIdx];
+			tNear = std::max(tNear, std::min(t0, t1));
+			tFar = std::min(tFar, std::max(t0, t1));
+		}
+		return tNear <= tFar ? tNear : std::numeric_limits<double>::infinity();
+	}
+
+	// The hit needs to be the closest one found by testing all the boxes, the returned object may differ only for boxes entered at the same distance
+	bool IsRayCastMatchingBruteForce(const BoundingVolumeHierarchy& InBVH, const TestObjects& InObjects, const Eigen::Vector3f& InOrigin, const Eigen::Vector3f& InDirection, float InMaxDistance)
+	{
+		const Eigen::Vector3d origin = InOrigin.cast<double>(), direction = InDirection.cast<double>();
+
+		double closestDistance = std::numeric_limits<double>::infinity();
+		for (uint32_t objectIdx = 0; objectIdx < InObjects.GetObjectsNum(); objectIdx++)
+			closestDistance = std::min(closestDistance, GetRayBoxDistance(origin, direction, InMaxDistance, InObjects, objectIdx));
+
+		uint32_t hitObjectIdx = 0;
+		float hitDistance = 0.f;
+		const bool hasHit = InBVH.RayCast(InOrigin, InDirection, InMaxDistance, hitObjectIdx, hitDistance);
+
+		if (!hasHit)
+			return closestDistance == std::numeric_limits<double>::infinity();
+
+		return hitObjectIdx < InObjects.GetObjectsNum() && std::abs(hitDistance - closestDistance) < g_Tolerance
+			&& std::abs(GetRayBoxDistance(origin, direction, InMaxDistance + g_Tolerance, InObjects, hitObjectIdx) - hitDistance) < g_Tolerance;
+	}
+
+}
+
+GEP_TEST(BVH, QueryFrustumMatchesBruteForce)
+{
+	std::mt19937 randomGenerator(47);
+	const TestObjects testObjects = MakeTestObjects(20000, randomGenerator);
+
+	for (uint32_t maxLeafSize : { 1u, 4u, 16u })
+	{
+		BoundingVolumeHierarchy testBVH(maxLeafSize);
+		testBVH.Build(testObjects.GetAABBs(), testObjects.GetObjectsNum());
+		GEP_CHECK(testBVH.GetObjectsNum() == testObjects.GetObjectsNum());
+		GEP_CHECK(testBVH.GetDepth() <= g_BVHMaxDepth);
+		GEP_CHECK(IsQueryMatchingBruteForce(testBVH, testObjects, MakeTestFrustum()));
+	}
+}
+
+GEP_TEST(BVH, RefitMatchesBruteForce)
+{
+	std::mt19937 randomGenerator(48);
+	TestObjects testObjects = MakeTestObjects(20000, randomGenerator);
+
+	BoundingVolumeHierarchy testBVH;
+	testBVH.Build(testObjects.GetAABBs(), testObjects.GetObjectsNum());
+
+	// Moving and resizing all the objects, some of them far from their build positions
+	std::uniform_real_distribution<float> offsetDistribution(-10.f, 10.f);
+	std::uniform_real_distribution<float> extentDistribution(0.1f, 4.f);
+	for (uint32_t objectIdx = 0; objectIdx < testObjects.GetObjectsNum(); objectIdx++)
+	{
+		testObjects.CenterX[objectIdx] += offsetDistribution(randomGenerator);
+		testObjects.CenterY[objectIdx] += offsetDistribution(randomGenerator);
+		testObjects.CenterZ[objectIdx] += objectIdx % 10 == 0 ? 80.f : offsetDistribution(randomGenerator);
+		testObjects.ExtentX[objectIdx] = extentDistribution(randomGenerator);
+	}
+	testBVH.Refit(testObjects.GetAABBs());
+	GEP_CHECK(IsQueryMatchingBruteForce(testBVH, testObjects, MakeTestFrustum()));
+
+	// The root children bounds need to enclose all the objects again
+	const BVH4_NODE& rootNode = testBVH.GetNodes()[0];
+	Eigen::Array3f rootMin = Eigen::Array3f::Constant(std::numeric_limits<float>::infinity()), rootMax = -rootMin;
+	for (uint32_t childIdx = 0; childIdx < 4; childIdx++)
+	{
+		if (rootNode.PrimCount[childIdx] == 0)
+			continue;
+		rootMin = rootMin.min(Eigen::Array3f(rootNode.MinX[childIdx], rootNode.MinY[childIdx], rootNode.MinZ[childIdx]));
+		rootMax = rootMax.max(Eigen::Array3f(rootNode.MaxX[childIdx], rootNode.MaxY[childIdx], rootNode.MaxZ[childIdx]));
+	}
+	bool areObjectsEnclosed = true;
+	for (uint32_t objectIdx = 0; objectIdx < testObjects.GetObjectsNum(); objectIdx++)
+	{
+		const Eigen::Array3f center(testObjects.CenterX[objectIdx], testObjects.CenterY[objectIdx], testObjects.CenterZ[objectIdx]);
+		const Eigen::Array3f extent(testObjects.ExtentX[objectIdx], testObjects.ExtentY[objectIdx], testObjects.ExtentZ[objectIdx]);
+		areObjectsEnclosed = areObjectsEnclosed && ((center - extent) >= rootMin).all() && ((center + extent) <= rootMax).all();
+	}
+	GEP_CHECK(areObjectsEnclosed);
+}
+
+GEP_TEST(BVH, RayCastMatchesBruteForce)
+{
+	std::mt19937 randomGenerator(49);
+	const TestObjects testObjects = MakeTestObjects(5000, randomGenerator);
+
+	BoundingVolumeHierarchy testBVH;
+	testBVH.Build(testObjects.GetAABBs(), testObjects.GetObjectsNum());
+
+	std::uniform_real_distribution<float> originDistribution(-70.f, 70.f);
+	std::uniform_real_distribution<float> directionDistribution(-1.f, 1.f);
+	std::uniform_real_distribution<float> maxDistanceDistribution(5.f, 200.f);
+
+	uint32_t mismatchesNum = 0;
+	for (uint32_t rayIdx = 0; rayIdx < 500; rayIdx++)
+	{
+		const Eigen::Vector3f origin(originDistribution(randomGenerator), originDistribution(randomGenerator), originDistribution(randomGenerator));
+		Eigen::Vector3f direction(directionDistribution(randomGenerator), directionDistribution(randomGenerator), directionDistribution(randomGenerator));
+
+		// Axis aligned rays exercise the zero direction components
+		if (rayIdx % 5 == 0)
+			direction = Eigen::Vector3f::Unit(rayIdx % 3) * (rayIdx % 2 ? 1.f : -1.f);
+
+		mismatchesNum += IsRayCastMatchingBruteForce(testBVH, testObjects, origin, direction.normalized(), maxDistanceDistribution(randomGenerator)) ? 0 : 1;
+	}
+	GEP_CHECK(mismatchesNum == 0);
+
+	// A ray starting inside a box hits it at distance zero
+	uint32_t hitObjectIdx = 0;
+	float hitDistance = 1.f;
+	const Eigen::Vector3f insideOrigin(testObjects.CenterX[7], testObjects.CenterY[7], testObjects.CenterZ[7]);
+	GEP_CHECK(testBVH.RayCast(insideOrigin, Eigen::Vector3f::UnitX(), 10.f, hitObjectIdx, hitDistance));
+	GEP_CHECK(hitDistance == 0.f);
+}
+
+GEP_TEST(BVH, HandlesDegenerateInputs)
+{
+	BoundingVolumeHierarchy testBVH;
+	TestObjects testObjects;
+	testBVH.Build(testObjects.GetAABBs(), 0);
+
+	uint32_t visibleIndex = 0;
+	float hitDistance = 0.f;
+	GEP_CHECK(testBVH.QueryFrustum(MakeTestFrustum(), &visibleIndex) == 0);
+	GEP_CHECK(!testBVH.RayCast(Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitZ(), 100.f, visibleIndex, hitDistance));
+
+	// All the objects in the same point cannot be split by centroid, they are split in the middle instead
+	for (uint32_t objectIdx = 0; objectIdx < 100; objectIdx++)
+	{
+		testObjects.CenterX.push_back(1.f); testObjects.CenterY.push_back(2.f); testObjects.CenterZ.push_back(10.f);
+		testObjects.ExtentX.push_back(0.5f); testObjects.ExtentY.push_back(0.5f); testObjects.ExtentZ.push_back(0.5f);
+	}
+	testBVH.Build(testObjects.GetAABBs(), testObjects.GetObjectsNum());
+	GEP_CHECK(IsQueryMatchingBruteForce(testBVH, testObjects, MakeTestFrustum()));
+}
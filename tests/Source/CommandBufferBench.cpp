@@ -0,0 +1,104 @@
+/*
+ CommandBufferBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestCommandList.h"
+#include "TestGraphicsTypes.h"
+#include "CommandBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace GEPUtils::Graphics;
+using namespace GEPTests;
+
+namespace {
+
+	using BenchClock = std::chrono::steady_clock;
+
+	// Best time of a few runs, to filter out the noise of the other processes
+	template<typename BenchFnType>
+	double MeasureBestMs(const BenchFnType& InBenchFn)
+	{
+		constexpr uint32_t runsNum = 10;
+
+		double bestMs = 1e9;
+		for (uint32_t runIdx = 0; runIdx < runsNum; runIdx++)
+		{
+			const BenchClock::time_point startTime = BenchClock::now();
+			InBenchFn();
+			bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(BenchClock::now() - startTime).count());
+		}
+		return bestMs;
+	}
+
+	// Per-object commands of a typical draw: its constants, its geometry and the draw itself
+	template<typename TargetType>
+	void RecordDraws(TargetType& InTarget, uint32_t InDrawsNum, TestVertexBufferView* InVertexBufViews, TestIndexBufferView& InIndexBufView)
+	{
+		float objectConstants[16] = {};
+		for (uint32_t drawIdx = 0; drawIdx < InDrawsNum; drawIdx++)
+		{
+			objectConstants[0] = static_cast<float>(drawIdx);
+			InTarget.SetGraphicsRootConstants(0, 16, objectConstants, 0);
+			InTarget.SetInputAssemblerData(PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST, InVertexBufViews[drawIdx % 8], InIndexBufView);
+			InTarget.SetGraphicsRootShaderResource(1, 0x10000 + drawIdx * 256);
+			InTarget.DrawIndexedInstanced(36, 1, 0, 0, 0);
+		}
+	}
+
+}
+
+// Measures recording draws in a command buffer (no graphics API involved), its replay, and the same calls made straight on a command list.
+// The command list counts the calls that would reach the graphics API, so the replay cost is the translation overhead only.
+int main()
+{
+	constexpr uint32_t drawsNums[] = { 1000, 10000, 100000 };
+
+	TestDevice testDevice;
+	TestVertexBufferView vertexBufViews[8];
+	TestIndexBufferView indexBufView;
+
+	std::printf("Best of 10 runs, 4 commands per draw\n");
+	std::printf("%8s %10s %12s %10s %10s %12s %10s\n", "draws", "blocks", "recorded KB", "record ms", "replay ms", "direct ms", "ns/cmd");
+
+	for (uint32_t drawsNum : drawsNums)
+	{
+		CommandArena benchArena;
+		CommandBuffer benchBuffer(benchArena);
+
+		// After the first run, blocks are reused from the arena
+		const double recordMs = MeasureBestMs([&]() {
+			benchBuffer.Reset();
+			RecordDraws(benchBuffer, drawsNum, vertexBufViews, indexBufView);
+		});
+
+		TestCommandList replayCmdList(testDevice), directCmdList(testDevice);
+		replayCmdList.SetLoggingEnabled(false);
+		directCmdList.SetLoggingEnabled(false);
+
+		const double replayMs = MeasureBestMs([&]() {
+			replayCmdList.InvalidateShadowState();
+			benchBuffer.Replay(replayCmdList);
+		});
+		const double directMs = MeasureBestMs([&]() {
+			directCmdList.InvalidateShadowState();
+			RecordDraws(directCmdList, drawsNum, vertexBufViews, indexBufView);
+		});
+
+		std::printf("%8u %10zu %12.1f %10.3f %10.3f %12.3f %10.1f\n", drawsNum, benchArena.GetAllocatedBlocksNum(), benchBuffer.GetRecordedSize() / 1024., recordMs, replayMs, directMs,
+			recordMs * 1e6 / benchBuffer.GetCommandsNum());
+
+		if (replayCmdList.GetCallsNum() != directCmdList.GetCallsNum())
+		{
+			std::printf("Replay made %llu calls instead of %llu\n", static_cast<unsigned long long>(replayCmdList.GetCallsNum()), static_cast<unsigned long long>(directCmdList.GetCallsNum()));
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ CommandBufferTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "TestCommandList.h"
+#include "TestGraphicsTypes.h"
+#include "CommandBuffer.h"
+#include "CommandSignature.h"
+
+using namespace GEPUtils::Graphics;
+using namespace GEPTests;
+
+namespace {
+
+	struct TestCommandSignature : public CommandSignature {
+		virtual void Init(INDIRECT_ARGUMENT_TYPE) override { }
+	};
+
+	// Objects referenced by the recorded commands, they only need to outlive the replay
+	struct TestCommandObjects {
+		TestResource Texture;
+		TestBuffer VertexData{ 0x1000 };
+		TestBuffer StagingData{ 0x2000 };
+		TestPipelineState PipelineState;
+		TestVertexBufferView VertexBufView;
+		TestVertexBufferView InstanceBufView;
+		TestIndexBufferView IndexBufView;
+		TestViewPort Viewport;
+		TestRect ScissorRect;
+		TestShaderResourceView SRV;
+		TestCommandSignature Signature;
+		CpuDescHandle RenderTargetHandle;
+		CpuDescHandle DepthHandle;
+		uint32_t UploadData[4] = { 1, 2, 3, 4 };
+	};
+
+	// The same sequence of calls, made on a command buffer or straight on a command list
+	template<typename TargetType>
+	void RecordTestFrame(TargetType& InTarget, TestCommandObjects& InObjects)
+	{
+		const float clearColor[4] = { 0.1f, 0.2f, 0.3f, 1.f };
+		const uint32_t mvpConstants[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+		InTarget.UploadBufferRegion(InObjects.VertexData, 64, InObjects.StagingData, 128, InObjects.UploadData, sizeof(InObjects.UploadData));
+		InTarget.TransitionResource(InObjects.Texture, RESOURCE_STATE::RENDER_TARGET, ALL_SUBRESOURCES);
+		InTarget.ClearRTV(InObjects.RenderTargetHandle, const_cast<float*>(clearColor));
+		InTarget.ClearDepth(InObjects.DepthHandle);
+		InTarget.SetPipelineStateAndResourceBinder(InObjects.PipelineState);
+		InTarget.SetInputAssemblerData(PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST, InObjects.VertexBufView, InObjects.IndexBufView);
+		InTarget.SetVertexBuffer(1, InObjects.InstanceBufView);
+		InTarget.SetViewportAndScissorRect(InObjects.Viewport, InObjects.ScissorRect);
+		InTarget.SetGraphicsRootConstants(0, 16, mvpConstants, 0);
+		InTarget.SetComputeRootConstants(1, 3, mvpConstants + 4, 2);
+		InTarget.SetGraphicsRootConstantBuffer(2, 0x3000);
+		InTarget.SetComputeRootConstantBuffer(3, 0x3100);
+		InTarget.SetGraphicsRootShaderResource(4, 0x3200);
+		InTarget.SetComputeRootShaderResource(5, 0x3300);
+		InTarget.SetGraphicsRootUnorderedAccess(6, 0x3400);
+		InTarget.SetComputeRootUnorderedAccess(7, 0x3500);
+		InTarget.ReferenceSRV(8, InObjects.SRV);
+		InTarget.DrawIndexed(36);
+		InTarget.DrawIndexedInstanced(36, 10, 6, -2, 3);
+		InTarget.ExecuteIndirect(InObjects.Signature, 100, InObjects.VertexData, 256, &InObjects.StagingData, 512);
+		InTarget.TransitionResource(InObjects.Texture, RESOURCE_STATE::PIXEL_SHADER_RESOURCE, ALL_SUBRESOURCES);
+		InTarget.Dispatch(8, 4, 1);
+	}
+
+}
+
+GEP_TEST(CommandBuffer, ReplayMatchesDirectRecording)
+{
+	TestDevice testDevice;
+	TestCommandObjects testObjects;
+
+	TestCommandList directCmdList(testDevice);
+	RecordTestFrame(directCmdList, testObjects);
+
+	CommandArena testArena;
+	CommandBuffer testBuffer(testArena);
+	RecordTestFrame(testBuffer, testObjects);
+	GEP_CHECK(testBuffer.GetCommandsNum() == 22);
+
+	// Recording reaches no command list, replay makes the same calls in the same order
+	TestCommandList replayCmdList(testDevice);
+	testBuffer.Replay(replayCmdList);
+	GEP_CHECK(!directCmdList.GetLoggedCalls().empty());
+	GEP_CHECK(replayCmdList.GetLoggedCalls() == directCmdList.GetLoggedCalls());
+
+	// A buffer can be replayed more than once, e.g. on a reset command list
+	replayCmdList.ResetTrackedStates();
+	replayCmdList.ClearLoggedCalls();
+	testBuffer.Replay(replayCmdList);
+	GEP_CHECK(replayCmdList.GetLoggedCalls() == directCmdList.GetLoggedCalls());
+
+	// Reset gives the block back to the arena, recording again reuses it
+	testBuffer.Reset();
+	GEP_CHECK(testBuffer.IsEmpty() && testBuffer.GetRecordedSize() == 0);
+	RecordTestFrame(testBuffer, testObjects);
+	GEP_CHECK(testArena.GetAllocatedBlocksNum() == 1);
+}
+
+GEP_TEST(CommandBuffer, RollsOverToNewBlockAtBlockSize)
+{
+	TestDevice testDevice;
+	CommandArena testArena;
+	CommandBuffer testBuffer(testArena);
+
+	// Root descriptor packets have a fixed size, as many as fit fill the first block exactly up to its end
+	const size_t packetSize = sizeof(RecordedCommands::SetRootDescriptor);
+	const uint32_t packetsPerBlock = static_cast<uint32_t>(CommandArena::BlockSize / packetSize);
+	for (uint32_t packetIdx = 0; packetIdx < packetsPerBlock; packetIdx++)
+		testBuffer.SetGraphicsRootConstantBuffer(0, packetIdx);
+	GEP_CHECK(testArena.GetAllocatedBlocksNum() == 1);
+	GEP_CHECK(testBuffer.GetRecordedSize() == packetsPerBlock * packetSize);
+
+	// The packet that does not fit starts a new block instead of spanning across the two
+	testBuffer.SetGraphicsRootConstantBuffer(0, packetsPerBlock);
+	GEP_CHECK(testArena.GetAllocatedBlocksNum() == 2);
+
+	// Replay crosses the block boundary in order
+	TestCommandList replayCmdList(testDevice);
+	testBuffer.Replay(replayCmdList);
+	const std::vector<std::string>& loggedCalls = replayCmdList.GetLoggedCalls();
+	GEP_CHECK(loggedCalls.size() == packetsPerBlock + 1);
+	bool isInRecordingOrder = true;
+	for (uint32_t packetIdx = 0; packetIdx < loggedCalls.size(); packetIdx++)
+		isInRecordingOrder = isInRecordingOrder && loggedCalls[packetIdx] == "SetGraphicsRootConstantBuffer 0 " + std::to_string(packetIdx);
+	GEP_CHECK(isInRecordingOrder);
+
+	// A second buffer on the same arena reuses the blocks released by the first one
+	testBuffer.Reset();
+	CommandBuffer secondBuffer(testArena);
+	for (uint32_t packetIdx = 0; packetIdx <= packetsPerBlock; packetIdx++)
+		secondBuffer.SetGraphicsRootConstantBuffer(0, packetIdx);
+	GEP_CHECK(testArena.GetAllocatedBlocksNum() == 2);
+}
+
+GEP_TEST(CommandBuffer, RecordsPacketsBiggerThanBlock)
+{
+	TestDevice testDevice;
+	CommandArena testArena;
+	CommandBuffer testBuffer(testArena);
+
+	// More inline constants than a block can hold
+	std::vector<uint32_t> bigConstants(CommandArena::BlockSize / sizeof(uint32_t) + 100);
+	for (uint32_t constantIdx = 0; constantIdx < bigConstants.size(); constantIdx++)
+		bigConstants[constantIdx] = constantIdx * 3;
+
+	testBuffer.Dispatch(1, 1, 1);
+	testBuffer.SetComputeRootConstants(0, bigConstants.size(), bigConstants.data(), 0);
+	testBuffer.Dispatch(2, 1, 1);
+	GEP_CHECK(testBuffer.GetCommandsNum() == 3);
+	GEP_CHECK(testArena.GetDedicatedBlocksNum() == 1);
+	GEP_CHECK(testBuffer.GetRecordedSize() > CommandArena::BlockSize);
+
+	// Nothing is dropped: the big packet sits in its own block, between the two normal ones
+	TestDevice referenceDevice;
+	TestCommandList directCmdList(referenceDevice), replayCmdList(testDevice);
+	directCmdList.Dispatch(1, 1, 1);
+	directCmdList.SetComputeRootConstants(0, bigConstants.size(), bigConstants.data(), 0);
+	directCmdList.Dispatch(2, 1, 1);
+	testBuffer.Replay(replayCmdList);
+	GEP_CHECK(replayCmdList.GetLoggedCalls() == directCmdList.GetLoggedCalls());
+	GEP_CHECK(testArena.GetAllocatedBlocksNum() == 2);
+
+	// Dedicated blocks are freed on reset
+	testBuffer.Reset();
+	GEP_CHECK(testArena.GetDedicatedBlocksNum() == 0);
+}
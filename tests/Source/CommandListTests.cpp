@@ -0,0 +1,185 @@
+/*
+ CommandListTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "TestCommandList.h"
+#include "TestGraphicsTypes.h"
+
+using namespace GEPUtils::Graphics;
+using namespace GEPTests;
+
+namespace {
+
+	uint32_t CountLoggedCalls(const TestCommandList& InCmdList, const std::string& InCallName)
+	{
+		uint32_t callsNum = 0;
+		for (const std::string& currentEntry : InCmdList.GetLoggedCalls())
+			callsNum += currentEntry.compare(0, InCallName.size() + 1, InCallName + " ") == 0 ? 1 : 0;
+		return callsNum;
+	}
+
+}
+
+GEP_TEST(CommandList, DropsRepeatedPipelineState)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice);
+	TestPipelineState pipelineState;
+
+	testCmdList.SetPipelineStateAndResourceBinder(pipelineState);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetPipelineState") == 1);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetGraphicsRootSignature") == 1);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetDescriptorHeap") == 1);
+
+	testCmdList.SetPipelineStateAndResourceBinder(pipelineState);
+	GEP_CHECK(testCmdList.GetLoggedCalls().size() == 3);
+	GEP_CHECK(testCmdList.GetFilteredStateCallsNum() == 1);
+}
+
+GEP_TEST(CommandList, DropsRootSignatureAndHeapSharedByPipelineStates)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice);
+	int sharedRootSignature = 0;
+	TestPipelineState firstPipelineState(&sharedRootSignature), secondPipelineState(&sharedRootSignature), otherPipelineState;
+
+	testCmdList.SetPipelineStateAndResourceBinder(firstPipelineState);
+	testCmdList.SetPipelineStateAndResourceBinder(secondPipelineState);
+	// Only the pipeline state changed, binding the root signature again would reset the root arguments
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetPipelineState") == 2);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetGraphicsRootSignature") == 1);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetDescriptorHeap") == 1);
+	GEP_CHECK(testCmdList.GetFilteredStateCallsNum() == 2);
+
+	testCmdList.SetPipelineStateAndResourceBinder(otherPipelineState);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetGraphicsRootSignature") == 2);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetDescriptorHeap") == 1);
+
+	// Graphics and compute root signatures are separate bind points, even when they are the same object
+	TestPipelineState computePipelineState(&sharedRootSignature, false);
+	testCmdList.SetPipelineStateAndResourceBinder(computePipelineState);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetComputeRootSignature") == 1);
+	testCmdList.SetPipelineStateAndResourceBinder(firstPipelineState);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetGraphicsRootSignature") == 3);
+
+	// A different descriptor heap is bound again
+	int otherDescriptorHeap = 0;
+	testCmdList.SetDescriptorHeap(&otherDescriptorHeap);
+	testCmdList.SetPipelineStateAndResourceBinder(secondPipelineState);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetDescriptorHeap") == 2);
+}
+
+GEP_TEST(CommandList, DropsRepeatedViewportAndScissorRect)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice);
+	TestViewPort viewport, otherViewport;
+	TestRect scissorRect;
+
+	testCmdList.SetViewportAndScissorRect(viewport, scissorRect);
+	testCmdList.SetViewportAndScissorRect(viewport, scissorRect);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetViewport") == 1);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetScissorRect") == 1);
+	GEP_CHECK(testCmdList.GetFilteredStateCallsNum() == 2);
+
+	// Viewport and scissor rect are filtered independently
+	testCmdList.SetViewportAndScissorRect(otherViewport, scissorRect);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetViewport") == 2);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetScissorRect") == 1);
+}
+
+GEP_TEST(CommandList, DropsRepeatedInputAssemblerData)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice);
+	TestVertexBufferView vertexBufView, instanceBufView;
+	TestIndexBufferView indexBufView;
+
+	testCmdList.SetInputAssemblerData(PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST, vertexBufView, indexBufView);
+	testCmdList.SetVertexBuffer(1, instanceBufView);
+	testCmdList.SetInputAssemblerData(PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST, vertexBufView, indexBufView);
+	testCmdList.SetVertexBuffer(1, instanceBufView);
+	GEP_CHECK(testCmdList.GetLoggedCalls().size() == 4);
+	GEP_CHECK(testCmdList.GetFilteredStateCallsNum() == 4);
+}
+
+GEP_TEST(CommandList, InvalidateShadowStateReissuesEverything)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice);
+	TestPipelineState pipelineState;
+	TestViewPort viewport;
+	TestRect scissorRect;
+	TestVertexBufferView vertexBufView;
+	TestIndexBufferView indexBufView;
+
+	const auto recordState = [&]() {
+		testCmdList.SetPipelineStateAndResourceBinder(pipelineState);
+		testCmdList.SetViewportAndScissorRect(viewport, scissorRect);
+		testCmdList.SetInputAssemblerData(PRIMITIVE_TOPOLOGY::PT_TRIANGLELIST, vertexBufView, indexBufView);
+	};
+
+	recordState();
+	const std::vector<std::string> firstCalls = testCmdList.GetLoggedCalls();
+	GEP_CHECK(firstCalls.size() == 8);
+
+	testCmdList.ClearLoggedCalls();
+	recordState();
+	GEP_CHECK(testCmdList.GetLoggedCalls().empty());
+	GEP_CHECK(testCmdList.GetFilteredStateCallsNum() == 6);
+
+	// E.g. the command list got reset: every call reaches the graphics API again, in the same order
+	testCmdList.InvalidateShadowState();
+	GEP_CHECK(testCmdList.GetFilteredStateCallsNum() == 0);
+	recordState();
+	GEP_CHECK(testCmdList.GetLoggedCalls() == firstCalls);
+}
+
+GEP_TEST(CommandList, ExecutingBundleForgetsPipelineState)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice), testBundle(testDevice, true);
+	TestPipelineState pipelineState;
+	TestViewPort viewport;
+	TestRect scissorRect;
+
+	testCmdList.SetPipelineStateAndResourceBinder(pipelineState);
+	testCmdList.SetViewportAndScissorRect(viewport, scissorRect);
+	testCmdList.ExecuteBundle(testBundle);
+	testCmdList.SetPipelineStateAndResourceBinder(pipelineState);
+	testCmdList.SetViewportAndScissorRect(viewport, scissorRect);
+
+	// The bundle may have set a different pipeline state, while viewports are inherited from the executing command list
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetPipelineState") == 2);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetViewport") == 1);
+}
+
+// Filtering compares objects by address, not by content. These pin down the documented behavior, which callers need to account for.
+GEP_TEST(CommandList, ViewportsAreFilteredByIdentity)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice);
+	TestViewPort viewport, sameValuesViewport;
+	TestRect scissorRect, sameValuesRect;
+
+	// Equal values in different objects are not detected as redundant
+	testCmdList.SetViewportAndScissorRect(viewport, scissorRect);
+	testCmdList.SetViewportAndScissorRect(sameValuesViewport, sameValuesRect);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetViewport") == 2);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetScissorRect") == 2);
+
+	// Changing the content of the object already set is not detected either, until the shadow state is invalidated
+	sameValuesViewport.SetWidthAndHeight(640.f, 480.f);
+	testCmdList.SetViewportAndScissorRect(sameValuesViewport, sameValuesRect);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetViewport") == 2);
+
+	testCmdList.InvalidateShadowState();
+	testCmdList.SetViewportAndScissorRect(sameValuesViewport, sameValuesRect);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetViewport") == 3);
+	GEP_CHECK(CountLoggedCalls(testCmdList, "SetScissorRect") == 3);
+}
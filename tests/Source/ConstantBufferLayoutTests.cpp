@@ -0,0 +1,118 @@
+/*
+ ConstantBufferLayoutTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "ConstantBufferLayout.h"
+
+using namespace GEPUtils::Graphics;
+
+// Expected offsets follow the HLSL packing rules for constant variables, the commented cbuffer is the one each layout describes
+
+namespace
+{
+	struct NestedTestCB {
+		Eigen::Vector4f Val1;
+		struct {
+			Eigen::Vector4f A;
+			Eigen::Vector4f B;
+		} Val2;
+	};
+
+	struct MisalignedNestedTestCB {
+		float Val1;
+		struct {
+			float A;
+		} Val2;
+	};
+}
+
+// The same checks can be done at compile time, next to the struct mirroring the shader constant buffer
+static_assert(CBufferLayout<Eigen::Vector2f, Eigen::Vector4f>::GetFieldOffset(1) == 16, "A float4 after a float2 starts a new register");
+static_assert(CBufferLayout<Eigen::Vector4f, CBufferLayout<Eigen::Vector4f, Eigen::Vector4f>>::Matches<NestedTestCB>(), "NestedTestCB follows HLSL packing");
+
+GEP_TEST(ConstantBufferLayout, FieldsDoNotCrossRegisters)
+{
+	// float4 Val1; float2 Val2; float2 Val3;
+	using VectorsLayout = CBufferLayout<Eigen::Vector4f, Eigen::Vector2f, Eigen::Vector2f>;
+	GEP_CHECK(VectorsLayout::GetFieldOffset(0) == 0 && VectorsLayout::GetFieldOffset(1) == 16 && VectorsLayout::GetFieldOffset(2) == 24);
+	GEP_CHECK(VectorsLayout::Size == 32 && VectorsLayout::RegistersNum == 2 && VectorsLayout::PaddingSize == 0);
+
+	// float2 Val1; float4 Val2; float2 Val3;
+	using CrossingLayout = CBufferLayout<Eigen::Vector2f, Eigen::Vector4f, Eigen::Vector2f>;
+	GEP_CHECK(CrossingLayout::GetFieldOffset(1) == 16 && CrossingLayout::GetFieldOffset(2) == 32);
+	GEP_CHECK(CrossingLayout::Size == 40 && CrossingLayout::RegistersNum == 3 && CrossingLayout::PaddingSize == 16);
+
+	// float Val1; float3 Val2; fits in the first register
+	using FittingLayout = CBufferLayout<float, Eigen::Vector3f>;
+	GEP_CHECK(FittingLayout::GetFieldOffset(1) == 4 && FittingLayout::Size == 16 && FittingLayout::IsCppCompatible);
+
+	// float2 Val1; float3 Val2; would end at 20
+	using MovedLayout = CBufferLayout<Eigen::Vector2f, Eigen::Vector3f>;
+	GEP_CHECK(MovedLayout::GetFieldOffset(1) == 16 && MovedLayout::Size == 28);
+	GEP_CHECK(MovedLayout::CppSize == 20 && !MovedLayout::IsCppCompatible);
+
+	// float3 Val1; float Val2; float Val3;
+	using ScalarsLayout = CBufferLayout<Eigen::Vector3f, float, float>;
+	GEP_CHECK(ScalarsLayout::GetFieldOffset(1) == 12 && ScalarsLayout::GetFieldOffset(2) == 16 && ScalarsLayout::Num32BitValues == 5);
+}
+
+GEP_TEST(ConstantBufferLayout, ArrayElementsArePaddedToRegisters)
+{
+	// float Val1[2]; float Val2; the last element is not padded, so Val2 packs right after it
+	using ScalarArrayLayout = CBufferLayout<float[2], float>;
+	GEP_CHECK(ScalarArrayLayout::GetFieldSize(0) == 20 && ScalarArrayLayout::GetFieldOffset(1) == 20 && ScalarArrayLayout::Size == 24);
+	GEP_CHECK(!ScalarArrayLayout::IsCppCompatible);
+
+	// float2 Val1[3]; float2 Val2;
+	using VectorArrayLayout = CBufferLayout<Eigen::Vector2f[3], Eigen::Vector2f>;
+	GEP_CHECK(VectorArrayLayout::GetFieldSize(0) == 40 && VectorArrayLayout::GetFieldOffset(1) == 40 && VectorArrayLayout::Size == 48);
+
+	// float Val1; float Val2[2]; arrays start a new register
+	using TrailingArrayLayout = CBufferLayout<float, float[2]>;
+	GEP_CHECK(TrailingArrayLayout::GetFieldOffset(1) == 16 && TrailingArrayLayout::Size == 36 && TrailingArrayLayout::RegistersNum == 3);
+
+	// float4 Val1[2]; is the only kind of array with the same layout in C++
+	using Vector4ArrayLayout = CBufferLayout<Eigen::Vector4f[2], float>;
+	GEP_CHECK(Vector4ArrayLayout::GetFieldSize(0) == 32 && Vector4ArrayLayout::GetFieldOffset(1) == 32 && Vector4ArrayLayout::IsCppCompatible);
+}
+
+GEP_TEST(ConstantBufferLayout, MatrixColumnsStartNewRegisters)
+{
+	// float Val1; float4x4 Val2;
+	using Matrix4Layout = CBufferLayout<float, Eigen::Matrix4f>;
+	GEP_CHECK(Matrix4Layout::GetFieldOffset(1) == 16 && Matrix4Layout::Size == 80 && Matrix4Layout::RegistersNum == 5);
+
+	// float3x3 Val1; float Val2; the last column leaves room for a scalar
+	using Matrix3Layout = CBufferLayout<Eigen::Matrix3f, float>;
+	GEP_CHECK(Matrix3Layout::GetFieldSize(0) == 44 && Matrix3Layout::GetFieldOffset(1) == 44 && Matrix3Layout::Size == 48);
+	GEP_CHECK(!Matrix3Layout::IsCppCompatible);
+}
+
+GEP_TEST(ConstantBufferLayout, NestedStructsStartNewRegisters)
+{
+	// float Val1; struct { float2 A; float B; } Val2; float Val3;
+	using NestedLayout = CBufferLayout<float, CBufferLayout<Eigen::Vector2f, float>, float>;
+	GEP_CHECK(NestedLayout::GetFieldOffset(1) == 16 && NestedLayout::GetFieldSize(1) == 12);
+	GEP_CHECK(NestedLayout::GetFieldOffset(2) == 28 && NestedLayout::Size == 32);
+
+	// struct { float4 A; float B; } Val1; float3 Val2; the struct is not padded to a whole register
+	using PackedAfterNestedLayout = CBufferLayout<CBufferLayout<Eigen::Vector4f, float>, Eigen::Vector3f>;
+	GEP_CHECK(PackedAfterNestedLayout::GetFieldOffset(1) == 20 && PackedAfterNestedLayout::Size == 32);
+
+	// struct { float A; } Val1[2]; float Val2; each element of an array of structs starts a new register
+	using NestedArrayLayout = CBufferLayout<CBufferLayout<float>[2], float>;
+	GEP_CHECK(NestedArrayLayout::GetFieldSize(0) == 20 && NestedArrayLayout::GetFieldOffset(1) == 20 && NestedArrayLayout::Size == 24);
+
+	// C++ places the nested struct at offset 4, HLSL at 16
+	using MisalignedNestedLayout = CBufferLayout<float, CBufferLayout<float>>;
+	GEP_CHECK(MisalignedNestedLayout::CppSize == sizeof(MisalignedNestedTestCB));
+	GEP_CHECK(!MisalignedNestedLayout::Matches<MisalignedNestedTestCB>());
+
+	// A nested layout that is not compatible on its own makes the outer one incompatible too
+	GEP_CHECK(!(CBufferLayout<Eigen::Vector4f, CBufferLayout<Eigen::Vector2f, Eigen::Vector3f>>::IsCppCompatible));
+}
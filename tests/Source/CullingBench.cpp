@@ -0,0 +1,109 @@
+/*
+ CullingBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsCulling.h"
+#include "GEPUtilsGeometry.h"
+#include "GEPUtilsThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	using BenchClock = std::chrono::steady_clock;
+
+	// Best time of a few runs, to filter out the noise of the other processes
+	template<typename CullFnType>
+	double MeasureBestMs(const CullFnType& InCullFn, uint32_t& OutVisibleNum)
+	{
+		constexpr uint32_t runsNum = 10;
+
+		double bestMs = 1e9;
+		for (uint32_t runIdx = 0; runIdx < runsNum; runIdx++)
+		{
+			const BenchClock::time_point startTime = BenchClock::now();
+			OutVisibleNum = InCullFn();
+			bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(BenchClock::now() - startTime).count());
+		}
+		return bestMs;
+	}
+
+}
+
+// Measures the scalar brute force test, the SSE2 kernels and the partitioned culling on a thread pool, for spheres and boxes
+int main()
+{
+	constexpr uint32_t objectsNums[] = { 10000, 100000, 1000000 };
+
+	GEPUtils::ThreadPool threadPool;
+	FrustumCuller parallelCuller(&threadPool);
+
+	const Eigen::Matrix4f viewMatrix = LookAt(Eigen::Vector3f(0.f, 0.f, -50.f), Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitY());
+	const FRUSTUM_PLANES frustumPlanes = ExtractFrustumPlanes(Perspective(0.1f, 200.f, 16.f / 9.f, 1.f) * viewMatrix);
+
+	std::printf("%u worker threads, best of 10 runs\n", threadPool.GetThreadsNum());
+	std::printf("%10s %6s %10s %14s %10s %14s %10s\n", "objects", "bounds", "visible", "brute force ms", "SSE2 ms", "partitioned ms", "Mobj/s");
+
+	for (uint32_t objectsNum : objectsNums)
+	{
+		std::mt19937 randomGenerator(objectsNum);
+		std::uniform_real_distribution<float> positionDistribution(-150.f, 150.f);
+		std::uniform_real_distribution<float> sizeDistribution(0.1f, 2.f);
+
+		std::vector<float> centerX(objectsNum), centerY(objectsNum), centerZ(objectsNum), radius(objectsNum), extentX(objectsNum), extentY(objectsNum), extentZ(objectsNum);
+		for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+		{
+			centerX[objectIdx] = positionDistribution(randomGenerator);
+			centerY[objectIdx] = positionDistribution(randomGenerator);
+			centerZ[objectIdx] = positionDistribution(randomGenerator);
+			radius[objectIdx] = sizeDistribution(randomGenerator);
+			extentX[objectIdx] = sizeDistribution(randomGenerator);
+			extentY[objectIdx] = sizeDistribution(randomGenerator);
+			extentZ[objectIdx] = sizeDistribution(randomGenerator);
+		}
+
+		const BOUNDING_SPHERES_SOA spheres = { centerX.data(), centerY.data(), centerZ.data(), radius.data() };
+		const AABBS_SOA aabbs = { centerX.data(), centerY.data(), centerZ.data(), extentX.data(), extentY.data(), extentZ.data() };
+		std::vector<uint32_t> visibleIndices(objectsNum);
+		uint32_t visibleNum = 0;
+
+		const double bruteForceSpheresMs = MeasureBestMs([&]() {
+			uint32_t outVisibleNum = 0;
+			for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+				if (IsSphereInFrustum(frustumPlanes, Eigen::Vector3f(centerX[objectIdx], centerY[objectIdx], centerZ[objectIdx]), radius[objectIdx]))
+					visibleIndices[outVisibleNum++] = objectIdx;
+			return outVisibleNum;
+		}, visibleNum);
+		const double kernelSpheresMs = MeasureBestMs([&]() { return CullSpheres(frustumPlanes, spheres, 0, objectsNum, visibleIndices.data()); }, visibleNum);
+		const double parallelSpheresMs = MeasureBestMs([&]() { return parallelCuller.CullSpheres(frustumPlanes, spheres, objectsNum, visibleIndices.data()); }, visibleNum);
+		std::printf("%10u %6s %10u %14.3f %10.3f %14.3f %10.1f\n", objectsNum, "sphere", visibleNum, bruteForceSpheresMs, kernelSpheresMs, parallelSpheresMs, objectsNum / (parallelSpheresMs * 1000.));
+
+		const double bruteForceAABBsMs = MeasureBestMs([&]() {
+			uint32_t outVisibleNum = 0;
+			for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+			{
+				const Eigen::Vector3f center(centerX[objectIdx], centerY[objectIdx], centerZ[objectIdx]);
+				const Eigen::Vector3f extent(extentX[objectIdx], extentY[objectIdx], extentZ[objectIdx]);
+				bool isVisible = true;
+				for (const Eigen::Vector4f& currentPlane : frustumPlanes.Planes)
+					isVisible = isVisible && currentPlane.head<3>().dot(center) + currentPlane.head<3>().cwiseAbs().dot(extent) + currentPlane.w() >= 0.f;
+				if (isVisible)
+					visibleIndices[outVisibleNum++] = objectIdx;
+			}
+			return outVisibleNum;
+		}, visibleNum);
+		const double kernelAABBsMs = MeasureBestMs([&]() { return CullAABBs(frustumPlanes, aabbs, 0, objectsNum, visibleIndices.data()); }, visibleNum);
+		const double parallelAABBsMs = MeasureBestMs([&]() { return parallelCuller.CullAABBs(frustumPlanes, aabbs, objectsNum, visibleIndices.data()); }, visibleNum);
+		std::printf("%10u %6s %10u %14.3f %10.3f %14.3f %10.1f\n", objectsNum, "AABB", visibleNum, bruteForceAABBsMs, kernelAABBsMs, parallelAABBsMs, objectsNum / (parallelAABBsMs * 1000.));
+	}
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ CullingTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "GEPUtilsCulling.h"
+#include "GEPUtilsGeometry.h"
+#include "GEPUtilsThreadPool.h"
+#include <algorithm>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	// Objects closer than this to a plane can be reported either way, since the kernels sum the plane terms in a different order
+	constexpr double g_BoundaryTolerance = 1e-3;
+
+	struct TestScene {
+		std::vector<float> CenterX, CenterY, CenterZ, Radius, ExtentX, ExtentY, ExtentZ;
+
+		BOUNDING_SPHERES_SOA GetSpheres() const { return { CenterX.data(), CenterY.data(), CenterZ.data(), Radius.data() }; }
+
+		AABBS_SOA GetAABBs() const { return { CenterX.data(), CenterY.data(), CenterZ.data(), ExtentX.data(), ExtentY.data(), ExtentZ.data() }; }
+	};
+
+	// Objects spread all around the camera, so that about a tenth of them is in the frustum and many cross its planes
+	TestScene MakeTestScene(uint32_t InObjectsNum)
+	{
+		std::mt19937 randomGenerator(InObjectsNum);
+		std::uniform_real_distribution<float> positionDistribution(-60.f, 60.f);
+		std::uniform_real_distribution<float> sizeDistribution(0.1f, 3.f);
+
+		TestScene outScene;
+		for (uint32_t objectIdx = 0; objectIdx < InObjectsNum; objectIdx++)
+		{
+			outScene.CenterX.push_back(positionDistribution(randomGenerator));
+			outScene.CenterY.push_back(positionDistribution(randomGenerator));
+			outScene.CenterZ.push_back(positionDistribution(randomGenerator));
+			outScene.Radius.push_back(sizeDistribution(randomGenerator));
+			outScene.ExtentX.push_back(sizeDistribution(randomGenerator));
+			outScene.ExtentY.push_back(sizeDistribution(randomGenerator));
+			outScene.ExtentZ.push_back(sizeDistribution(randomGenerator));
+		}
+		return outScene;
+	}
+
+	FRUSTUM_PLANES MakeTestFrustum()
+	{
+		const Eigen::Matrix4f viewMatrix = LookAt(Eigen::Vector3f(5.f, 3.f, -20.f), Eigen::Vector3f(0.f, 0.f, 10.f), Eigen::Vector3f::UnitY());
+		const Eigen::Matrix4f projMatrix = Perspective(0.5f, 50.f, 16.f / 9.f, 1.f);
+		return ExtractFrustumPlanes(projMatrix * viewMatrix);
+	}
+
+	// Smallest signed distance of the object from the planes, computed in double precision: the object is visible when it is not negative
+	double GetSphereMargin(const FRUSTUM_PLANES& InPlanes, const TestScene& InScene, uint32_t InObjectIdx)
+	{
+		double outMargin = 1e30;
+		for (const Eigen::Vector4f& currentPlane : InPlanes.Planes)
+		{
+			const double distance = static_cast<double>(currentPlane.x()) * InScene.CenterX[InObjectIdx] + static_cast<double>(currentPlane.y()) * InScene.CenterY[InObjectIdx]
+				+ static_cast<double>(currentPlane.z()) * InScene.CenterZ[InObjectIdx] + currentPlane.w();
+			outMargin = std::min(outMargin, distance + InScene.Radius[InObjectIdx]);
+		}
+		return outMargin;
+	}
+
+	double GetAABBMargin(const FRUSTUM_PLANES& InPlanes, const TestScene& InScene, uint32_t InObjectIdx)
+	{
+		double outMargin = 1e30;
+		for (const Eigen::Vector4f& currentPlane : InPlanes.Planes)
+		{
+			const double distance = static_cast<double>(currentPlane.x()) * InScene.CenterX[InObjectIdx] + static_cast<double>(currentPlane.y()) * InScene.CenterY[InObjectIdx]
+				+ static_cast<double>(currentPlane.z()) * InScene.CenterZ[InObjectIdx] + currentPlane.w();
+			const double projectedRadius = std::abs(static_cast<double>(currentPlane.x())) * InScene.ExtentX[InObjectIdx] + std::abs(static_cast<double>(currentPlane.y())) * InScene.ExtentY[InObjectIdx]
+				+ std::abs(static_cast<double>(currentPlane.z())) * InScene.ExtentZ[InObjectIdx];
+			outMargin = std::min(outMargin, distance + projectedRadius);
+		}
+		return outMargin;
+	}
+
+	// Visible indices need to be increasing and in [InBegin, InEnd), and to agree with the brute force margins away from the planes
+	template<typename MarginFnType>
+	bool IsMatchingBruteForce(const uint32_t* InVisibleIndices, uint32_t InVisibleNum, uint32_t InBegin, uint32_t InEnd, const MarginFnType& InMarginFn)
+	{
+		std::vector<bool> isReportedVisible(InEnd, false);
+		for (uint32_t visibleIdx = 0; visibleIdx < InVisibleNum; visibleIdx++)
+		{
+			const uint32_t objectIdx = InVisibleIndices[visibleIdx];
+			if (objectIdx < InBegin || objectIdx >= InEnd || (visibleIdx > 0 && objectIdx <= InVisibleIndices[visibleIdx - 1]))
+				return false;
+			isReportedVisible[objectIdx] = true;
+		}
+
+		for (uint32_t objectIdx = InBegin; objectIdx < InEnd; objectIdx++)
+		{
+			const double margin = InMarginFn(objectIdx);
+			if ((margin > g_BoundaryTolerance && !isReportedVisible[objectIdx]) || (margin < -g_BoundaryTolerance && isReportedVisible[objectIdx]))
+				return false;
+		}
+		return true;
+	}
+
+}
+
+GEP_TEST(Culling, CullSpheresMatchesBruteForce)
+{
+	// Not a multiple of 4, so that the scalar tail is exercised too
+	const uint32_t objectsNum = 10003;
+	const TestScene testScene = MakeTestScene(objectsNum);
+	const FRUSTUM_PLANES frustumPlanes = MakeTestFrustum();
+	const auto sphereMarginFn = [&](uint32_t InObjectIdx) { return GetSphereMargin(frustumPlanes, testScene, InObjectIdx); };
+
+	std::vector<uint32_t> visibleIndices(objectsNum);
+	const uint32_t visibleNum = CullSpheres(frustumPlanes, testScene.GetSpheres(), 0, objectsNum, visibleIndices.data());
+	GEP_CHECK(visibleNum > 0 && visibleNum < objectsNum);
+	GEP_CHECK(IsMatchingBruteForce(visibleIndices.data(), visibleNum, 0, objectsNum, sphereMarginFn));
+
+	// Sub-ranges not starting at a multiple of 4
+	const uint32_t rangeVisibleNum = CullSpheres(frustumPlanes, testScene.GetSpheres(), 5, 1002, visibleIndices.data());
+	GEP_CHECK(IsMatchingBruteForce(visibleIndices.data(), rangeVisibleNum, 5, 1002, sphereMarginFn));
+}
+
+GEP_TEST(Culling, CullAABBsMatchesBruteForce)
+{
+	const uint32_t objectsNum = 10003;
+	const TestScene testScene = MakeTestScene(objectsNum);
+	const FRUSTUM_PLANES frustumPlanes = MakeTestFrustum();
+	const auto aabbMarginFn = [&](uint32_t InObjectIdx) { return GetAABBMargin(frustumPlanes, testScene, InObjectIdx); };
+
+	std::vector<uint32_t> visibleIndices(objectsNum);
+	const uint32_t visibleNum = CullAABBs(frustumPlanes, testScene.GetAABBs(), 0, objectsNum, visibleIndices.data());
+	GEP_CHECK(visibleNum > 0 && visibleNum < objectsNum);
+	GEP_CHECK(IsMatchingBruteForce(visibleIndices.data(), visibleNum, 0, objectsNum, aabbMarginFn));
+
+	const uint32_t rangeVisibleNum = CullAABBs(frustumPlanes, testScene.GetAABBs(), 5, 1002, visibleIndices.data());
+	GEP_CHECK(IsMatchingBruteForce(visibleIndices.data(), rangeVisibleNum, 5, 1002, aabbMarginFn));
+}
+
+GEP_TEST(Culling, ParallelCullingMatchesSingleThreaded)
+{
+	const uint32_t objectsNum = 100003;
+	const TestScene testScene = MakeTestScene(objectsNum);
+	const FRUSTUM_PLANES frustumPlanes = MakeTestFrustum();
+
+	GEPUtils::ThreadPool threadPool(3);
+	FrustumCuller parallelCuller(&threadPool, 1000);
+
+	std::vector<uint32_t> expectedIndices(objectsNum), visibleIndices(objectsNum);
+
+	// Partitions run the same kernels on the same objects, so the results need to be identical
+	const uint32_t expectedSpheresNum = CullSpheres(frustumPlanes, testScene.GetSpheres(), 0, objectsNum, expectedIndices.data());
+	for (uint32_t repetitionIdx = 0; repetitionIdx < 2; repetitionIdx++)
+	{
+		const uint32_t visibleNum = parallelCuller.CullSpheres(frustumPlanes, testScene.GetSpheres(), objectsNum, visibleIndices.data());
+		GEP_CHECK(visibleNum == expectedSpheresNum);
+		GEP_CHECK(std::equal(expectedIndices.begin(), expectedIndices.begin() + expectedSpheresNum, visibleIndices.begin()));
+	}
+
+	const uint32_t expectedAABBsNum = CullAABBs(frustumPlanes, testScene.GetAABBs(), 0, objectsNum, expectedIndices.data());
+	const uint32_t visibleAABBsNum = parallelCuller.CullAABBs(frustumPlanes, testScene.GetAABBs(), objectsNum, visibleIndices.data());
+	GEP_CHECK(visibleAABBsNum == expectedAABBsNum);
+	GEP_CHECK(std::equal(expectedIndices.begin(), expectedIndices.begin() + expectedAABBsNum, visibleIndices.begin()));
+	GEP_CHECK(IsMatchingBruteForce(visibleIndices.data(), visibleAABBsNum, 0, objectsNum, [&](uint32_t InObjectIdx) { return GetAABBMargin(frustumPlanes, testScene, InObjectIdx); }));
+
+	// Fewer objects than a partition are culled on the calling thread
+	const uint32_t expectedFewNum = CullSpheres(frustumPlanes, testScene.GetSpheres(), 0, 999, expectedIndices.data());
+	const uint32_t visibleFewNum = parallelCuller.CullSpheres(frustumPlanes, testScene.GetSpheres(), 999, visibleIndices.data());
+	GEP_CHECK(visibleFewNum == expectedFewNum);
+	GEP_CHECK(std::equal(expectedIndices.begin(), expectedIndices.begin() + expectedFewNum, visibleIndices.begin()));
+}
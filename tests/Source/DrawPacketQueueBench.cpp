@@ -0,0 +1,151 @@
+/*
+ DrawPacketQueueBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "DrawPacketQueue.h"
+#include "TestGraphicsTypes.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	// Every heap allocation of the process goes through the replaced operator new below
+	uint64_t g_AllocationsNum = 0;
+
+	using BenchClock = std::chrono::steady_clock;
+
+	double ElapsedMs(BenchClock::time_point InStartTime)
+	{
+		return std::chrono::duration<double, std::milli>(BenchClock::now() - InStartTime).count();
+	}
+
+	struct KeyedDraw {
+		uint64_t m_Key;
+		uint32_t m_DrawIdx;
+	};
+
+}
+
+// Note: all the forms are replaced, so that every pointer freed by a delete below comes from the malloc of a new below
+void* operator new(std::size_t InSize)
+{
+	g_AllocationsNum++;
+	if (void* outMemory = std::malloc(InSize ? InSize : 1))
+		return outMemory;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t InSize)
+{
+	return operator new(InSize);
+}
+
+void operator delete(void* InMemory) noexcept
+{
+	std::free(InMemory);
+}
+
+void operator delete[](void* InMemory) noexcept
+{
+	operator delete(InMemory);
+}
+
+void operator delete(void* InMemory, std::size_t) noexcept
+{
+	operator delete(InMemory);
+}
+
+void operator delete[](void* InMemory, std::size_t) noexcept
+{
+	operator delete(InMemory);
+}
+
+// Measures adding and sorting the draws of a frame, compared with std::stable_sort on the same keys,
+// and counts the heap allocations made by the queue once it has grown to the frame draws number
+int main()
+{
+	constexpr uint32_t drawsNum = 100000;
+	constexpr uint32_t framesNum = 20;
+
+	GEPTests::TestPipelineState pipelineState;
+	GEPTests::TestVertexBufferView vertexBufView;
+	GEPTests::TestIndexBufferView indexBufView;
+
+	DRAW_PACKET drawPacket;
+	drawPacket.PipelineState = &pipelineState;
+	drawPacket.VertexBufView = &vertexBufView;
+	drawPacket.IndexBufView = &indexBufView;
+	const float mvpMatrix[16] = {};
+	drawPacket.RootConstants = mvpMatrix;
+	drawPacket.Num32BitRootConstants = 16;
+
+	// 4 passes, 64 pipeline states, 4096 materials and random depths, a new set of keys every frame
+	std::mt19937 randomGenerator(42);
+	std::uniform_int_distribution<uint32_t> passDistribution(0, 3);
+	std::uniform_int_distribution<uint32_t> pipelineStateDistribution(0, 63);
+	std::uniform_int_distribution<uint32_t> materialDistribution(0, 4095);
+	std::uniform_real_distribution<float> depthDistribution(0.1f, 100.f);
+
+	std::vector<std::vector<uint64_t>> frameSortKeys(framesNum, std::vector<uint64_t>(drawsNum));
+	for (std::vector<uint64_t>& currentFrameKeys : frameSortKeys)
+		for (uint64_t& currentKey : currentFrameKeys)
+			currentKey = MakeDrawSortKey(passDistribution(randomGenerator), pipelineStateDistribution(randomGenerator), materialDistribution(randomGenerator), QuantizeDrawDepth(depthDistribution(randomGenerator), 0.1f, 100.f));
+
+	DrawPacketQueue drawQueue;
+	std::vector<KeyedDraw> stableSortDraws(drawsNum);
+
+	double bestAddMs = 1e9, bestSortMs = 1e9, bestStableSortMs = 1e9;
+	uint64_t laterFramesAllocationsNum = 0;
+	bool isOrderMatching = true;
+
+	for (uint32_t frameIdx = 0; frameIdx < framesNum; frameIdx++)
+	{
+		const std::vector<uint64_t>& currentFrameKeys = frameSortKeys[frameIdx];
+		const uint64_t frameStartAllocationsNum = g_AllocationsNum;
+
+		drawQueue.Reset();
+		const BenchClock::time_point addStartTime = BenchClock::now();
+		for (uint32_t drawIdx = 0; drawIdx < drawsNum; drawIdx++)
+		{
+			drawPacket.StartInstanceLocation = drawIdx;
+			drawQueue.AddDraw(currentFrameKeys[drawIdx], drawPacket);
+		}
+		bestAddMs = std::min(bestAddMs, ElapsedMs(addStartTime));
+
+		const BenchClock::time_point sortStartTime = BenchClock::now();
+		drawQueue.Sort();
+		bestSortMs = std::min(bestSortMs, ElapsedMs(sortStartTime));
+
+		// The first frame grows the queue memory, the following ones are expected not to allocate
+		if (frameIdx > 0)
+			laterFramesAllocationsNum += g_AllocationsNum - frameStartAllocationsNum;
+
+		for (uint32_t drawIdx = 0; drawIdx < drawsNum; drawIdx++)
+			stableSortDraws[drawIdx] = { currentFrameKeys[drawIdx], drawIdx };
+		const BenchClock::time_point stableSortStartTime = BenchClock::now();
+		std::stable_sort(stableSortDraws.begin(), stableSortDraws.end(), [](const KeyedDraw& InFirst, const KeyedDraw& InSecond) { return InFirst.m_Key < InSecond.m_Key; });
+		bestStableSortMs = std::min(bestStableSortMs, ElapsedMs(stableSortStartTime));
+
+		for (uint32_t drawIdx = 0; drawIdx < drawsNum; drawIdx++)
+			isOrderMatching = isOrderMatching && drawQueue.GetDraw(drawIdx).StartInstanceLocation == stableSortDraws[drawIdx].m_DrawIdx;
+	}
+
+	std::printf("%u draws, best of %u frames\n", drawsNum, framesNum);
+	std::printf("%-28s %10.2f ms\n", "add draws", bestAddMs);
+	std::printf("%-28s %10.2f ms (%u byte passes)\n", "radix sort", bestSortMs, drawQueue.GetLastSortPassesNum());
+	std::printf("%-28s %10.2f ms\n", "std::stable_sort", bestStableSortMs);
+	std::printf("%-28s %10llu\n", "allocations after frame 0", static_cast<unsigned long long>(laterFramesAllocationsNum));
+	std::printf("%-28s %10s\n", "order matches stable_sort", isOrderMatching ? "yes" : "no");
+
+	return isOrderMatching && laterFramesAllocationsNum == 0 ? 0 : 1;
+}
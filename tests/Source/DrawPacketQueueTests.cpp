@@ -0,0 +1,148 @@
+/*
+ DrawPacketQueueTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "TestGraphicsTypes.h"
+#include "DrawPacketQueue.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	GEPTests::TestPipelineState g_PipelineState;
+	GEPTests::TestVertexBufferView g_VertexBufView;
+	GEPTests::TestIndexBufferView g_IndexBufView;
+
+	// The draw position in the queue is stored in the packet, to tell apart draws with the same key
+	void AddDraws(const std::vector<uint64_t>& InSortKeys, DrawPacketQueue& OutQueue)
+	{
+		DRAW_PACKET drawPacket;
+		drawPacket.PipelineState = &g_PipelineState;
+		drawPacket.VertexBufView = &g_VertexBufView;
+		drawPacket.IndexBufView = &g_IndexBufView;
+
+		for (uint32_t drawIdx = 0; drawIdx < InSortKeys.size(); drawIdx++)
+		{
+			drawPacket.StartInstanceLocation = drawIdx;
+			OutQueue.AddDraw(InSortKeys[drawIdx], drawPacket);
+		}
+	}
+
+	// Sorts the queue and compares keys and draw order with std::stable_sort on the same keys
+	bool IsSortMatchingStableSort(const std::vector<uint64_t>& InSortKeys, DrawPacketQueue& InQueue)
+	{
+		InQueue.Reset();
+		AddDraws(InSortKeys, InQueue);
+		InQueue.Sort();
+
+		std::vector<std::pair<uint64_t, uint32_t>> expectedDraws;
+		for (uint32_t drawIdx = 0; drawIdx < InSortKeys.size(); drawIdx++)
+			expectedDraws.emplace_back(InSortKeys[drawIdx], drawIdx);
+		std::stable_sort(expectedDraws.begin(), expectedDraws.end(),
+			[](const std::pair<uint64_t, uint32_t>& InFirst, const std::pair<uint64_t, uint32_t>& InSecond) { return InFirst.first < InSecond.first; });
+
+		if (InQueue.GetDrawsNum() != expectedDraws.size())
+			return false;
+
+		for (uint32_t drawIdx = 0; drawIdx < expectedDraws.size(); drawIdx++)
+		{
+			if (InQueue.GetSortKey(drawIdx) != expectedDraws[drawIdx].first || InQueue.GetDraw(drawIdx).StartInstanceLocation != expectedDraws[drawIdx].second)
+				return false;
+		}
+		return true;
+	}
+
+	// Keys of a frame with few passes, pipeline states and materials, so that many draws share all the key fields but the depth
+	std::vector<uint64_t> MakeFrameSortKeys(uint32_t InDrawsNum, uint32_t InDepthBucketsNum, std::mt19937& InRandomGenerator)
+	{
+		std::uniform_int_distribution<uint32_t> passDistribution(0, 3);
+		std::uniform_int_distribution<uint32_t> pipelineStateDistribution(0, 63);
+		std::uniform_int_distribution<uint32_t> materialDistribution(0, 4095);
+		std::uniform_int_distribution<uint32_t> depthDistribution(0, InDepthBucketsNum - 1);
+
+		std::vector<uint64_t> outSortKeys(InDrawsNum);
+		for (uint64_t& currentKey : outSortKeys)
+			currentKey = MakeDrawSortKey(passDistribution(InRandomGenerator), pipelineStateDistribution(InRandomGenerator), materialDistribution(InRandomGenerator), depthDistribution(InRandomGenerator));
+		return outSortKeys;
+	}
+
+}
+
+GEP_TEST(DrawPacketQueue, SortMatchesStableSort)
+{
+	std::mt19937 randomGenerator(43);
+	DrawPacketQueue drawQueue;
+
+	// Few depth buckets make many equal keys, which need to keep the order they were added in
+	GEP_CHECK(IsSortMatchingStableSort(MakeFrameSortKeys(100000, 4, randomGenerator), drawQueue));
+	GEP_CHECK(IsSortMatchingStableSort(MakeFrameSortKeys(100000, 1 << g_DrawSortKeyDepthBits, randomGenerator), drawQueue));
+
+	// Random 64-bit keys exercise all the byte passes
+	std::vector<uint64_t> randomKeys(20000);
+	for (uint64_t& currentKey : randomKeys)
+		currentKey = (static_cast<uint64_t>(randomGenerator()) << 32) | randomGenerator();
+	GEP_CHECK(IsSortMatchingStableSort(randomKeys, drawQueue));
+	GEP_CHECK(drawQueue.GetLastSortPassesNum() == 8);
+}
+
+GEP_TEST(DrawPacketQueue, SortsSmallQueues)
+{
+	DrawPacketQueue drawQueue;
+
+	GEP_CHECK(IsSortMatchingStableSort({}, drawQueue));
+	GEP_CHECK(IsSortMatchingStableSort({ 5 }, drawQueue));
+	GEP_CHECK(IsSortMatchingStableSort({ 5, 1 }, drawQueue));
+	GEP_CHECK(IsSortMatchingStableSort({ 3, 1, 3, 2, 1, 3 }, drawQueue));
+}
+
+GEP_TEST(DrawPacketQueue, SkipsBytesSharedByAllKeys)
+{
+	DrawPacketQueue drawQueue;
+
+	// Only the lowest byte differs: a single pass, leaving the sorted draws in the scratch buffer before the final swap
+	GEP_CHECK(IsSortMatchingStableSort({ MakeDrawSortKey(1, 2, 3, 9), MakeDrawSortKey(1, 2, 3, 4), MakeDrawSortKey(1, 2, 3, 7), MakeDrawSortKey(1, 2, 3, 4) }, drawQueue));
+	GEP_CHECK(drawQueue.GetLastSortPassesNum() == 1);
+
+	// Pass and depth differ, three bytes in between are shared
+	GEP_CHECK(IsSortMatchingStableSort({ MakeDrawSortKey(2, 7, 7, 1), MakeDrawSortKey(0, 7, 7, 2), MakeDrawSortKey(2, 7, 7, 0), MakeDrawSortKey(0, 7, 7, 1) }, drawQueue));
+	GEP_CHECK(drawQueue.GetLastSortPassesNum() == 2);
+
+	// Equal keys are not moved at all
+	GEP_CHECK(IsSortMatchingStableSort({ 42, 42, 42 }, drawQueue));
+	GEP_CHECK(drawQueue.GetLastSortPassesNum() == 0);
+}
+
+GEP_TEST(DrawPacketQueue, ResetRemovesDraws)
+{
+	std::mt19937 randomGenerator(7);
+	DrawPacketQueue drawQueue;
+
+	GEP_CHECK(IsSortMatchingStableSort(MakeFrameSortKeys(1000, 16, randomGenerator), drawQueue));
+
+	drawQueue.Reset();
+	GEP_CHECK(drawQueue.GetDrawsNum() == 0);
+	GEP_CHECK(drawQueue.GetLastSortPassesNum() == 0);
+
+	// A smaller frame after a bigger one only sorts its own draws
+	GEP_CHECK(IsSortMatchingStableSort(MakeFrameSortKeys(10, 16, randomGenerator), drawQueue));
+}
+
+GEP_TEST(DrawPacketQueue, QuantizesDepth)
+{
+	const uint32_t maxBucket = (1u << g_DrawSortKeyDepthBits) - 1;
+
+	GEP_CHECK(QuantizeDrawDepth(0.1f, 0.1f, 100.f) == 0);
+	GEP_CHECK(QuantizeDrawDepth(100.f, 0.1f, 100.f) == maxBucket);
+	GEP_CHECK(QuantizeDrawDepth(-5.f, 0.1f, 100.f) == 0);
+	GEP_CHECK(QuantizeDrawDepth(500.f, 0.1f, 100.f) == maxBucket);
+	GEP_CHECK(QuantizeDrawDepth(10.f, 0.1f, 100.f) < QuantizeDrawDepth(20.f, 0.1f, 100.f));
+	GEP_CHECK(QuantizeDrawDepth(10.f, 0.1f, 100.f, true) > QuantizeDrawDepth(20.f, 0.1f, 100.f, true));
+}
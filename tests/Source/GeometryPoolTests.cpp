@@ -0,0 +1,138 @@
+/*
+ GeometryPoolTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "GeometryPool.h"
+
+using namespace GEPUtils::Graphics;
+
+namespace
+{
+	// Same layout as a position and color vertex with 16 bits indices
+	constexpr uint32_t g_TestVertexStride = 12;
+	constexpr uint32_t g_TestIndexSize = 2;
+
+	GEOMETRY_POOL_ADD_RESULT AllocateTestMesh(GeometryPoolRanges& InRanges, uint32_t InVerticesNum, uint32_t InIndicesNum, GEOMETRY_POOL_MESH& OutMesh)
+	{
+		size_t verticesStagingOffset = 0, indicesStagingOffset = 0;
+		return InRanges.AllocateMesh(InVerticesNum, InIndicesNum, OutMesh, verticesStagingOffset, indicesStagingOffset);
+	}
+}
+
+GEP_TEST(GeometryPool, RangesAreReusedAfterRemoveMesh)
+{
+	GeometryPoolRanges poolRanges(g_TestVertexStride, g_TestIndexSize, 100, 300, 64 * 1024);
+
+	GEOMETRY_POOL_MESH firstMesh, secondMesh, thirdMesh;
+	GEP_CHECK(AllocateTestMesh(poolRanges, 40, 120, firstMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(AllocateTestMesh(poolRanges, 40, 120, secondMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(AllocateTestMesh(poolRanges, 20, 60, thirdMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(poolRanges.GetMeshesNum() == 3 && poolRanges.GetUsedVerticesNum() == 100 && poolRanges.GetUsedIndicesNum() == 300);
+
+	GEOMETRY_POOL_MESH failedMesh;
+	GEP_CHECK(AllocateTestMesh(poolRanges, 1, 1, failedMesh) == GEOMETRY_POOL_ADD_RESULT::POOL_FULL);
+	GEP_CHECK(!failedMesh.IsValid());
+
+	poolRanges.FreeMesh(secondMesh);
+	GEP_CHECK(poolRanges.GetMeshesNum() == 2 && poolRanges.GetUsedVerticesNum() == 60 && poolRanges.GetUsedIndicesNum() == 180);
+
+	// The only free ranges are the ones of the removed mesh
+	GEOMETRY_POOL_MESH reusingMesh;
+	GEP_CHECK(AllocateTestMesh(poolRanges, 40, 120, reusingMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(reusingMesh.BaseVertexLocation == secondMesh.BaseVertexLocation);
+	GEP_CHECK(reusingMesh.StartIndexLocation == secondMesh.StartIndexLocation);
+	GEP_CHECK(reusingMesh.VerticesNum == 40 && reusingMesh.IndicesNum == 120);
+	GEP_CHECK(poolRanges.GetMeshesNum() == 3 && poolRanges.GetUsedVerticesNum() == 100 && poolRanges.GetUsedIndicesNum() == 300);
+
+	// Removing an invalid mesh does nothing
+	poolRanges.FreeMesh(failedMesh);
+	GEP_CHECK(poolRanges.GetMeshesNum() == 3);
+}
+
+GEP_TEST(GeometryPool, VertexRangeIsRolledBackWhenIndicesAreFragmented)
+{
+	GeometryPoolRanges poolRanges(g_TestVertexStride, g_TestIndexSize, 40, 100, 64 * 1024);
+
+	GEOMETRY_POOL_MESH meshes[4];
+	for (GEOMETRY_POOL_MESH& currentMesh : meshes)
+		GEP_CHECK(AllocateTestMesh(poolRanges, 10, 25, currentMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+
+	// 20 free vertices and 50 free indices, both split in two ranges
+	poolRanges.FreeMesh(meshes[1]);
+	poolRanges.FreeMesh(meshes[3]);
+	const size_t stagingOffset = poolRanges.GetStagingOffset();
+
+	// The vertex range is found, the index one is not
+	GEOMETRY_POOL_MESH fragmentedMesh;
+	GEP_CHECK(AllocateTestMesh(poolRanges, 10, 40, fragmentedMesh) == GEOMETRY_POOL_ADD_RESULT::FRAGMENTED);
+	GEP_CHECK(!fragmentedMesh.IsValid());
+	GEP_CHECK(poolRanges.GetMeshesNum() == 2 && poolRanges.GetUsedVerticesNum() == 20 && poolRanges.GetUsedIndicesNum() == 50);
+	GEP_CHECK(poolRanges.GetStagingOffset() == stagingOffset);
+
+	// Both free vertex ranges are still there, so two meshes of 10 vertices fit again
+	GEOMETRY_POOL_MESH firstMesh, secondMesh;
+	GEP_CHECK(AllocateTestMesh(poolRanges, 10, 25, firstMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(AllocateTestMesh(poolRanges, 10, 25, secondMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(firstMesh.BaseVertexLocation != secondMesh.BaseVertexLocation);
+	GEP_CHECK(firstMesh.BaseVertexLocation == meshes[1].BaseVertexLocation || firstMesh.BaseVertexLocation == meshes[3].BaseVertexLocation);
+	GEP_CHECK(secondMesh.BaseVertexLocation == meshes[1].BaseVertexLocation || secondMesh.BaseVertexLocation == meshes[3].BaseVertexLocation);
+	GEP_CHECK(poolRanges.GetUsedVerticesNum() == 40 && poolRanges.GetUsedIndicesNum() == 100);
+}
+
+GEP_TEST(GeometryPool, StagingOffsetsAreAlignedAndResetAfterUploads)
+{
+	GeometryPoolRanges poolRanges(g_TestVertexStride, g_TestIndexSize, 1024, 1024, 256);
+
+	GEOMETRY_POOL_MESH currentMesh;
+	size_t verticesStagingOffset = 1234, indicesStagingOffset = 1234;
+
+	// 36 bytes of vertices, indices start at the next 16 bytes multiple
+	GEP_CHECK(poolRanges.AllocateMesh(3, 3, currentMesh, verticesStagingOffset, indicesStagingOffset) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(verticesStagingOffset == 0 && indicesStagingOffset == 48);
+	GEP_CHECK(poolRanges.GetStagingOffset() == 64);
+
+	GEP_CHECK(poolRanges.AllocateMesh(5, 4, currentMesh, verticesStagingOffset, indicesStagingOffset) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(verticesStagingOffset == 64 && indicesStagingOffset == 128);
+	GEP_CHECK(poolRanges.GetStagingOffset() == 144);
+
+	// Fills the staging buffer exactly
+	GEP_CHECK(poolRanges.AllocateMesh(8, 8, currentMesh, verticesStagingOffset, indicesStagingOffset) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(verticesStagingOffset == 144 && indicesStagingOffset == 240);
+	GEP_CHECK(poolRanges.GetStagingOffset() == 256);
+
+	GEP_CHECK(poolRanges.AllocateMesh(1, 1, currentMesh, verticesStagingOffset, indicesStagingOffset) == GEOMETRY_POOL_ADD_RESULT::STAGING_FULL);
+	GEP_CHECK(!currentMesh.IsValid());
+	GEP_CHECK(poolRanges.GetMeshesNum() == 3 && poolRanges.GetUsedVerticesNum() == 16 && poolRanges.GetUsedIndicesNum() == 15);
+
+	poolRanges.OnUploadsCompleted();
+	GEP_CHECK(poolRanges.GetStagingOffset() == 0);
+
+	GEP_CHECK(poolRanges.AllocateMesh(1, 1, currentMesh, verticesStagingOffset, indicesStagingOffset) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(verticesStagingOffset == 0 && indicesStagingOffset == 16);
+	GEP_CHECK(currentMesh.BaseVertexLocation == 16 && currentMesh.StartIndexLocation == 15);
+}
+
+GEP_TEST(GeometryPool, MeshesThatCannotFitAreReported)
+{
+	GeometryPoolRanges poolRanges(g_TestVertexStride, g_TestIndexSize, 64, 64, 64 * 1024);
+
+	GEOMETRY_POOL_MESH currentMesh;
+	GEP_CHECK(AllocateTestMesh(poolRanges, 0, 3, currentMesh) == GEOMETRY_POOL_ADD_RESULT::EMPTY_MESH);
+	GEP_CHECK(AllocateTestMesh(poolRanges, 3, 0, currentMesh) == GEOMETRY_POOL_ADD_RESULT::EMPTY_MESH);
+	GEP_CHECK(AllocateTestMesh(poolRanges, 65, 3, currentMesh) == GEOMETRY_POOL_ADD_RESULT::POOL_FULL);
+	GEP_CHECK(AllocateTestMesh(poolRanges, 3, 65, currentMesh) == GEOMETRY_POOL_ADD_RESULT::POOL_FULL);
+	GEP_CHECK(!currentMesh.IsValid());
+
+	// A staging buffer too small for a single mesh
+	GeometryPoolRanges smallStagingRanges(g_TestVertexStride, g_TestIndexSize, 64, 64, 32);
+	GEP_CHECK(AllocateTestMesh(smallStagingRanges, 3, 3, currentMesh) == GEOMETRY_POOL_ADD_RESULT::STAGING_FULL);
+	GEP_CHECK(smallStagingRanges.GetMeshesNum() == 0 && smallStagingRanges.GetStagingOffset() == 0);
+
+	GEP_CHECK(AllocateTestMesh(poolRanges, 64, 64, currentMesh) == GEOMETRY_POOL_ADD_RESULT::SUCCESS);
+	GEP_CHECK(currentMesh.BaseVertexLocation == 0 && currentMesh.StartIndexLocation == 0);
+}
@@ -0,0 +1,98 @@
+/*
+ IndirectArgumentsBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "IndirectArguments.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	using BenchClock = std::chrono::steady_clock;
+
+	// Best time of a few runs, to filter out the noise of the other processes
+	template<typename BenchFnType>
+	double MeasureBestMs(const BenchFnType& InBenchFn)
+	{
+		constexpr uint32_t runsNum = 10;
+
+		double bestMs = 1e9;
+		for (uint32_t runIdx = 0; runIdx < runsNum; runIdx++)
+		{
+			const BenchClock::time_point startTime = BenchClock::now();
+			InBenchFn();
+			bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(BenchClock::now() - startTime).count());
+		}
+		return bestMs;
+	}
+
+}
+
+// Measures packing draw arguments (with some of them producing no work) and compacting the culled ones in place,
+// against building a second array with only the visible arguments, as a culling pass without Compact(..) would.
+int main()
+{
+	constexpr uint32_t drawsNums[] = { 10000, 100000, 1000000 };
+
+	std::printf("Best of 10 runs, 5%% of the draws have no instances, 50%% of the others are culled\n");
+	std::printf("%10s %10s %12s %12s %10s\n", "draws", "pack ms", "compact ms", "copy ms", "ns/draw");
+
+	for (uint32_t drawsNum : drawsNums)
+	{
+		std::mt19937 randomGenerator(drawsNum);
+		std::uniform_int_distribution<uint32_t> percentDistribution(0, 99);
+
+		std::vector<DRAW_INDEXED_ARGUMENTS> sourceDraws(drawsNum);
+		for (uint32_t drawIdx = 0; drawIdx < drawsNum; drawIdx++)
+			sourceDraws[drawIdx] = DRAW_INDEXED_ARGUMENTS{ 36, percentDistribution(randomGenerator) < 5 ? 0u : 1u, drawIdx * 36, 0, drawIdx };
+
+		IndirectArgumentBuilder argumentBuilder(INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED, drawsNum);
+		const auto packDraws = [&]() {
+			argumentBuilder.Reset();
+			for (const DRAW_INDEXED_ARGUMENTS& currentDraw : sourceDraws)
+				argumentBuilder.AddDrawIndexed(currentDraw);
+		};
+		const double packMs = MeasureBestMs(packDraws);
+
+		std::vector<uint8_t> isVisible(argumentBuilder.GetArgumentsNum());
+		for (uint8_t& currentVisibility : isVisible)
+			currentVisibility = percentDistribution(randomGenerator) < 50 ? 1 : 0;
+
+		// Packing is repeated before each compaction or copy and measured apart, then subtracted
+		std::vector<DRAW_INDEXED_ARGUMENTS> visibleDraws;
+		visibleDraws.reserve(isVisible.size());
+		const double packAndCopyMs = MeasureBestMs([&]() {
+			packDraws();
+			visibleDraws.clear();
+			for (uint32_t argumentIdx = 0; argumentIdx < isVisible.size(); argumentIdx++)
+			{
+				if (isVisible[argumentIdx])
+					visibleDraws.push_back(argumentBuilder.GetDrawIndexed(argumentIdx));
+			}
+		});
+
+		uint32_t removedNum = 0;
+		const double packAndCompactMs = MeasureBestMs([&]() {
+			packDraws();
+			removedNum = argumentBuilder.Compact(isVisible.data());
+		});
+
+		std::printf("%10u %10.3f %12.3f %12.3f %10.2f\n", drawsNum, packMs, std::max(packAndCompactMs - packMs, 0.), std::max(packAndCopyMs - packMs, 0.), packMs * 1e6 / drawsNum);
+
+		if (argumentBuilder.GetArgumentsNum() != visibleDraws.size() || argumentBuilder.GetArgumentsNum() + removedNum != isVisible.size())
+		{
+			std::printf("Compaction kept %u draws instead of %zu\n", argumentBuilder.GetArgumentsNum(), visibleDraws.size());
+			return 1;
+		}
+	}
+
+	return 0;
+}
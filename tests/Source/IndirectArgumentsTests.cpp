@@ -0,0 +1,128 @@
+/*
+ IndirectArgumentsTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "IndirectArguments.h"
+#include <cstring>
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	DRAW_INDEXED_ARGUMENTS MakeDraw(uint32_t InDrawIdx)
+	{
+		return DRAW_INDEXED_ARGUMENTS{ 36 + InDrawIdx, 1 + InDrawIdx % 3, InDrawIdx * 36, -static_cast<int32_t>(InDrawIdx), InDrawIdx };
+	}
+
+	bool IsSameDraw(const DRAW_INDEXED_ARGUMENTS& InFirst, const DRAW_INDEXED_ARGUMENTS& InSecond)
+	{
+		return std::memcmp(&InFirst, &InSecond, sizeof(DRAW_INDEXED_ARGUMENTS)) == 0;
+	}
+
+}
+
+GEP_TEST(IndirectArguments, PacksDrawIndexedTightly)
+{
+	IndirectArgumentBuilder argumentBuilder(INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED);
+	GEP_CHECK(argumentBuilder.GetStride() == 20 && GetIndirectArgumentStride(INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED) == 20);
+
+	for (uint32_t drawIdx = 0; drawIdx < 3; drawIdx++)
+		GEP_CHECK(argumentBuilder.AddDrawIndexed(MakeDraw(drawIdx)));
+
+	GEP_CHECK(argumentBuilder.GetArgumentsNum() == 3);
+	GEP_CHECK(argumentBuilder.GetDataSize() == 60);
+	for (uint32_t drawIdx = 0; drawIdx < 3; drawIdx++)
+		GEP_CHECK(IsSameDraw(argumentBuilder.GetDrawIndexed(drawIdx), MakeDraw(drawIdx)));
+
+	// The data is what the argument buffer receives: the fields of each argument in API order, with no padding in between
+	const uint32_t* packedValues = static_cast<const uint32_t*>(argumentBuilder.GetData());
+	GEP_CHECK(packedValues[5] == 37 && packedValues[6] == 2 && packedValues[7] == 36 && static_cast<int32_t>(packedValues[8]) == -1 && packedValues[9] == 1);
+}
+
+GEP_TEST(IndirectArguments, PacksDispatch)
+{
+	IndirectArgumentBuilder argumentBuilder(INDIRECT_ARGUMENT_TYPE::DISPATCH, 4);
+	GEP_CHECK(argumentBuilder.GetStride() == 12);
+
+	GEP_CHECK(argumentBuilder.AddDispatch(DISPATCH_ARGUMENTS{ 8, 4, 1 }));
+	GEP_CHECK(argumentBuilder.AddDispatch(DISPATCH_ARGUMENTS{ 1, 1, 64 }));
+
+	GEP_CHECK(argumentBuilder.GetDataSize() == 24);
+	GEP_CHECK(argumentBuilder.GetDispatch(1).ThreadGroupCountX == 1 && argumentBuilder.GetDispatch(1).ThreadGroupCountZ == 64);
+	const uint32_t* packedValues = static_cast<const uint32_t*>(argumentBuilder.GetData());
+	GEP_CHECK(packedValues[0] == 8 && packedValues[1] == 4 && packedValues[2] == 1 && packedValues[3] == 1);
+}
+
+GEP_TEST(IndirectArguments, RejectsArgumentsWithoutWork)
+{
+	IndirectArgumentBuilder drawBuilder(INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED);
+	GEP_CHECK(!drawBuilder.AddDrawIndexed(DRAW_INDEXED_ARGUMENTS{ 0, 1, 0, 0, 0 }));
+	GEP_CHECK(!drawBuilder.AddDrawIndexed(DRAW_INDEXED_ARGUMENTS{ 36, 0, 0, 0, 0 }));
+	// Arguments of a different type than the builder are rejected as well
+	GEP_CHECK(!drawBuilder.AddDispatch(DISPATCH_ARGUMENTS{ 1, 1, 1 }));
+	GEP_CHECK(drawBuilder.AddDrawIndexed(MakeDraw(0)));
+
+	GEP_CHECK(drawBuilder.GetArgumentsNum() == 1 && drawBuilder.GetRejectedArgumentsNum() == 3);
+	GEP_CHECK(IsSameDraw(drawBuilder.GetDrawIndexed(0), MakeDraw(0)));
+
+	IndirectArgumentBuilder dispatchBuilder(INDIRECT_ARGUMENT_TYPE::DISPATCH);
+	GEP_CHECK(!dispatchBuilder.AddDispatch(DISPATCH_ARGUMENTS{ 0, 1, 1 }));
+	GEP_CHECK(!dispatchBuilder.AddDispatch(DISPATCH_ARGUMENTS{ 1, 0, 1 }));
+	GEP_CHECK(!dispatchBuilder.AddDispatch(DISPATCH_ARGUMENTS{ 1, 1, 0 }));
+	GEP_CHECK(!dispatchBuilder.AddDrawIndexed(MakeDraw(0)));
+	GEP_CHECK(dispatchBuilder.GetArgumentsNum() == 0 && dispatchBuilder.GetDataSize() == 0 && dispatchBuilder.GetRejectedArgumentsNum() == 4);
+
+	// Reset forgets the rejected arguments too
+	dispatchBuilder.Reset();
+	GEP_CHECK(dispatchBuilder.GetRejectedArgumentsNum() == 0);
+}
+
+GEP_TEST(IndirectArguments, CompactKeepsVisibleInOrder)
+{
+	constexpr uint32_t drawsNum = 10;
+	IndirectArgumentBuilder argumentBuilder(INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED, drawsNum);
+	for (uint32_t drawIdx = 0; drawIdx < drawsNum; drawIdx++)
+		argumentBuilder.AddDrawIndexed(MakeDraw(drawIdx));
+
+	const uint8_t isVisible[drawsNum] = { 0, 1, 1, 0, 0, 1, 0, 0, 0, 1 };
+	GEP_CHECK(argumentBuilder.Compact(isVisible) == 6);
+	GEP_CHECK(argumentBuilder.GetArgumentsNum() == 4 && argumentBuilder.GetDataSize() == 4 * 20);
+
+	const uint32_t visibleDraws[] = { 1, 2, 5, 9 };
+	for (uint32_t keptIdx = 0; keptIdx < 4; keptIdx++)
+		GEP_CHECK(IsSameDraw(argumentBuilder.GetDrawIndexed(keptIdx), MakeDraw(visibleDraws[keptIdx])));
+
+	// Nothing to remove leaves the arguments untouched
+	const uint8_t allVisible[4] = { 1, 1, 1, 1 };
+	GEP_CHECK(argumentBuilder.Compact(allVisible) == 0);
+	GEP_CHECK(IsSameDraw(argumentBuilder.GetDrawIndexed(3), MakeDraw(9)));
+
+	// Arguments added after compacting follow the kept ones
+	GEP_CHECK(argumentBuilder.AddDrawIndexed(MakeDraw(20)));
+	GEP_CHECK(argumentBuilder.GetArgumentsNum() == 5 && IsSameDraw(argumentBuilder.GetDrawIndexed(4), MakeDraw(20)));
+
+	const uint8_t noneVisible[5] = {};
+	GEP_CHECK(argumentBuilder.Compact(noneVisible) == 5);
+	GEP_CHECK(argumentBuilder.GetArgumentsNum() == 0 && argumentBuilder.GetDataSize() == 0);
+}
+
+GEP_TEST(IndirectArguments, ResetKeepsMemory)
+{
+	IndirectArgumentBuilder argumentBuilder(INDIRECT_ARGUMENT_TYPE::DRAW_INDEXED, 64);
+	argumentBuilder.AddDrawIndexed(MakeDraw(0));
+	const void* packedData = argumentBuilder.GetData();
+
+	argumentBuilder.Reset();
+	GEP_CHECK(argumentBuilder.GetArgumentsNum() == 0 && argumentBuilder.GetDataSize() == 0);
+
+	// Within the expected arguments number, packing again does not reallocate
+	for (uint32_t drawIdx = 0; drawIdx < 64; drawIdx++)
+		argumentBuilder.AddDrawIndexed(MakeDraw(drawIdx));
+	GEP_CHECK(argumentBuilder.GetData() == packedData);
+	GEP_CHECK(IsSameDraw(argumentBuilder.GetDrawIndexed(63), MakeDraw(63)));
+}
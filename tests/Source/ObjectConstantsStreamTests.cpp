@@ -0,0 +1,139 @@
+/*
+ ObjectConstantsStreamTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "TestCommandList.h"
+#include "ObjectConstantsStream.h"
+#include <cstring>
+
+using namespace GEPUtils::Graphics;
+using namespace GEPTests;
+
+namespace {
+
+	// Same layout as the shader side struct: a float4x4 and a float4, tightly packed
+	struct TestObjectConstants {
+		float m_Mvp[16];
+		float m_Color[4];
+	};
+
+	TestObjectConstants MakeObjectConstants(float InValue)
+	{
+		TestObjectConstants outConstants;
+		for (float& currentValue : outConstants.m_Mvp)
+			currentValue = InValue;
+		for (float& currentValue : outConstants.m_Color)
+			currentValue = -InValue;
+		return outConstants;
+	}
+
+	constexpr size_t g_GuardSize = 256;
+	constexpr uint8_t g_GuardByte = 0xCD;
+
+	// Stands for the frame memory, with guard bytes after the reserved objects to detect writes out of the reservation
+	struct TestFrameMemory {
+		TestFrameMemory(uint32_t InObjectsNum, uint32_t InObjectStride) : m_ReservedSize(static_cast<size_t>(InObjectsNum) * InObjectStride), m_Data(m_ReservedSize + g_GuardSize, g_GuardByte) { }
+
+		bool AreGuardBytesIntact() const
+		{
+			for (size_t byteIdx = m_ReservedSize; byteIdx < m_Data.size(); byteIdx++)
+			{
+				if (m_Data[byteIdx] != g_GuardByte)
+					return false;
+			}
+			return true;
+		}
+
+		size_t m_ReservedSize;
+		std::vector<uint8_t> m_Data;
+	};
+
+	constexpr uint64_t g_FrameGpuAddress = 0x10000;
+
+}
+
+GEP_TEST(ObjectConstantsStream, ObjectsArePackedByStride)
+{
+	const uint32_t objectStride = sizeof(TestObjectConstants);
+	GEP_CHECK(objectStride == 80);
+
+	ObjectConstantsStream objectStream(objectStride);
+	TestFrameMemory frameMemory(8, objectStride);
+	objectStream.BeginFrame(8, frameMemory.m_Data.data(), g_FrameGpuAddress);
+	GEP_CHECK(objectStream.GetObjectStride() == 80 && objectStream.GetMaxObjectsNum() == 8);
+
+	// Indices are consecutive, each object is at its index times the stride, with no padding in between
+	for (uint32_t objectIdx = 0; objectIdx < 3; objectIdx++)
+	{
+		const TestObjectConstants objectConstants = MakeObjectConstants(static_cast<float>(objectIdx + 1));
+		GEP_CHECK(objectStream.AddObject(&objectConstants) == objectIdx);
+		GEP_CHECK(std::memcmp(frameMemory.m_Data.data() + objectIdx * objectStride, &objectConstants, objectStride) == 0);
+	}
+	GEP_CHECK(objectStream.GetObjectsNum() == 3 && objectStream.GetDataSize() == 3 * 80);
+
+	// In place allocations continue after the added objects
+	uint32_t firstObjectIdx = ObjectConstantsStream::INVALID_OBJECT_IDX;
+	uint8_t* objectsData = static_cast<uint8_t*>(objectStream.AllocateObjects(4, firstObjectIdx));
+	GEP_CHECK(firstObjectIdx == 3 && objectsData == frameMemory.m_Data.data() + 3 * objectStride);
+
+	uint32_t singleObjectIdx = ObjectConstantsStream::INVALID_OBJECT_IDX;
+	GEP_CHECK(objectStream.AllocateObject(singleObjectIdx) == frameMemory.m_Data.data() + 7 * objectStride);
+	GEP_CHECK(singleObjectIdx == 7 && objectStream.GetObjectsNum() == 8);
+	GEP_CHECK(frameMemory.AreGuardBytesIntact());
+}
+
+GEP_TEST(ObjectConstantsStream, OverflowReturnsInvalidIndex)
+{
+	const uint32_t objectStride = sizeof(TestObjectConstants);
+	ObjectConstantsStream objectStream(objectStride);
+	TestFrameMemory frameMemory(4, objectStride);
+	objectStream.BeginFrame(4, frameMemory.m_Data.data(), g_FrameGpuAddress);
+
+	const TestObjectConstants objectConstants = MakeObjectConstants(1.f);
+	uint32_t firstObjectIdx = 0;
+	GEP_CHECK(objectStream.AllocateObjects(3, firstObjectIdx) != nullptr);
+
+	// Two objects do not fit in the one left: nothing is reserved, and the index cannot be mistaken for a valid one
+	GEP_CHECK(objectStream.AllocateObjects(2, firstObjectIdx) == nullptr);
+	GEP_CHECK(firstObjectIdx == ObjectConstantsStream::INVALID_OBJECT_IDX);
+	GEP_CHECK(objectStream.GetObjectsNum() == 3);
+
+	GEP_CHECK(objectStream.AddObject(&objectConstants) == 3);
+	GEP_CHECK(objectStream.AddObject(&objectConstants) == ObjectConstantsStream::INVALID_OBJECT_IDX);
+	GEP_CHECK(objectStream.GetObjectsNum() == 4);
+	GEP_CHECK(frameMemory.AreGuardBytesIntact());
+
+	// The next frame starts empty again
+	objectStream.BeginFrame(4, frameMemory.m_Data.data(), g_FrameGpuAddress);
+	GEP_CHECK(objectStream.GetObjectsNum() == 0);
+	GEP_CHECK(objectStream.AddObject(&objectConstants) == 0);
+
+	// Without memory nothing fits
+	objectStream.BeginFrame(0, nullptr, 0);
+	GEP_CHECK(objectStream.AddObject(&objectConstants) == ObjectConstantsStream::INVALID_OBJECT_IDX);
+}
+
+GEP_TEST(ObjectConstantsStream, BindsFrameMemoryAndIndex)
+{
+	TestDevice testDevice;
+	TestCommandList testCmdList(testDevice);
+	ObjectConstantsStream objectStream(sizeof(TestObjectConstants));
+
+	// Nothing to bind without reserved memory
+	objectStream.BeginFrame(0, nullptr, 0);
+	objectStream.Bind(testCmdList, 0);
+	GEP_CHECK(testCmdList.GetLoggedCalls().empty());
+
+	TestFrameMemory frameMemory(2, sizeof(TestObjectConstants));
+	objectStream.BeginFrame(2, frameMemory.m_Data.data(), g_FrameGpuAddress);
+	objectStream.Bind(testCmdList, 0);
+	ObjectConstantsStream::SetObjectIndex(testCmdList, 1, 5);
+
+	// A single root SRV for all the objects, then a single 32 bit constant per draw
+	GEP_CHECK((testCmdList.GetLoggedCalls() == std::vector<std::string>{ "SetGraphicsRootShaderResource 0 65536", "SetGraphicsRootConstants 1 1 0 5" }));
+}
@@ -0,0 +1,144 @@
+/*
+ OcclusionBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsOcclusion.h"
+#include "GEPUtilsGeometry.h"
+#include "GEPUtilsThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	using BenchClock = std::chrono::steady_clock;
+
+	// Best time of a few runs, to filter out the noise of the other processes
+	template<typename BenchFnType>
+	double MeasureBestMs(const BenchFnType& InBenchFn)
+	{
+		constexpr uint32_t runsNum = 10;
+
+		double bestMs = 1e9;
+		for (uint32_t runIdx = 0; runIdx < runsNum; runIdx++)
+		{
+			const BenchClock::time_point startTime = BenchClock::now();
+			InBenchFn();
+			bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(BenchClock::now() - startTime).count());
+		}
+		return bestMs;
+	}
+
+	// Unit cube, 12 triangles
+	const float g_CubePositions[] = {
+		-1.f, -1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, -1.f, -1.f, 1.f, -1.f,
+		-1.f, -1.f, 1.f, 1.f, -1.f, 1.f, 1.f, 1.f, 1.f, -1.f, 1.f, 1.f
+	};
+	const uint16_t g_CubeIndices[] = {
+		0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6, 0, 4, 5, 0, 5, 1,
+		3, 2, 6, 3, 6, 7, 0, 3, 7, 0, 7, 4, 1, 5, 6, 1, 6, 2
+	};
+
+	struct OccluderScene {
+		std::vector<Eigen::Matrix4f> OccluderModelMatrices;
+		std::vector<float> CenterX, CenterY, CenterZ, ExtentX, ExtentY, ExtentZ;
+
+		AABBS_SOA GetAABBs() const { return { CenterX.data(), CenterY.data(), CenterZ.data(), ExtentX.data(), ExtentY.data(), ExtentZ.data() }; }
+	};
+
+	// A city of building occluders on a grid, with small objects scattered between and behind them
+	OccluderScene MakeOccluderScene(uint32_t InOccludersNum, uint32_t InOccludeesNum)
+	{
+		std::mt19937 randomGenerator(InOccludersNum);
+		std::uniform_real_distribution<float> buildingSizeDistribution(2.f, 6.f);
+		std::uniform_real_distribution<float> positionXDistribution(-100.f, 100.f);
+		std::uniform_real_distribution<float> positionZDistribution(0.f, 200.f);
+		std::uniform_real_distribution<float> extentDistribution(0.2f, 1.f);
+
+		OccluderScene outScene;
+		const uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(InOccludersNum))));
+		for (uint32_t occluderIdx = 0; occluderIdx < InOccludersNum; occluderIdx++)
+		{
+			const float cellSize = 200.f / gridSize;
+			const Eigen::Vector3f halfSize(buildingSizeDistribution(randomGenerator), 4.f * buildingSizeDistribution(randomGenerator), buildingSizeDistribution(randomGenerator));
+			const Eigen::Vector3f center(-100.f + (occluderIdx % gridSize + 0.5f) * cellSize, halfSize.y(), (occluderIdx / gridSize + 0.5f) * cellSize);
+			outScene.OccluderModelMatrices.push_back((Eigen::Translation3f(center) * Eigen::Scaling(halfSize)).matrix());
+		}
+
+		for (uint32_t occludeeIdx = 0; occludeeIdx < InOccludeesNum; occludeeIdx++)
+		{
+			outScene.CenterX.push_back(positionXDistribution(randomGenerator));
+			outScene.CenterY.push_back(extentDistribution(randomGenerator) * 4.f);
+			outScene.CenterZ.push_back(positionZDistribution(randomGenerator));
+			outScene.ExtentX.push_back(extentDistribution(randomGenerator));
+			outScene.ExtentY.push_back(extentDistribution(randomGenerator));
+			outScene.ExtentZ.push_back(extentDistribution(randomGenerator));
+		}
+		return outScene;
+	}
+
+	void AddSceneOccluders(OcclusionRasterizer& InRasterizer, const OccluderScene& InScene, const Eigen::Matrix4f& InViewProjMatrix)
+	{
+		InRasterizer.BeginFrame(InViewProjMatrix);
+		for (const Eigen::Matrix4f& currentModelMatrix : InScene.OccluderModelMatrices)
+			InRasterizer.AddOccluder(g_CubePositions, 3 * sizeof(float), 8, g_CubeIndices, 36, currentModelMatrix);
+	}
+
+}
+
+// Measures occluder setup and rasterization (single threaded and on a thread pool), and occludee filtering.
+// The near plane case walks along the side of a building: the triangles of that side cross the near plane, so they are dropped and stop occluding.
+int main()
+{
+	constexpr uint32_t occludersNum = 1000;
+	constexpr uint32_t occludeesNum = 100000;
+
+	const OccluderScene scene = MakeOccluderScene(occludersNum, occludeesNum);
+	const AABBS_SOA aabbs = scene.GetAABBs();
+	const Eigen::Matrix4f projMatrix = Perspective(0.1f, 300.f, 16.f / 9.f, 1.f);
+
+	// Street level view, and a view next to the side of the first building of the grid, looking along it
+	const Eigen::Vector3f firstBuildingCenter = scene.OccluderModelMatrices[0].block<3, 1>(0, 3);
+	const Eigen::Vector3f besideFirstBuilding = firstBuildingCenter + Eigen::Vector3f(scene.OccluderModelMatrices[0](0, 0) + 0.05f, -firstBuildingCenter.y() + 2.f, 0.f);
+	const Eigen::Matrix4f viewMatrices[] = {
+		LookAt(Eigen::Vector3f(0.f, 2.f, -20.f), Eigen::Vector3f(0.f, 2.f, 100.f), Eigen::Vector3f::UnitY()),
+		LookAt(besideFirstBuilding, besideFirstBuilding + Eigen::Vector3f::UnitZ(), Eigen::Vector3f::UnitY())
+	};
+	const char* viewNames[] = { "street", "near plane" };
+
+	GEPUtils::ThreadPool threadPool;
+	OcclusionRasterizer rasterizer;
+	std::vector<uint32_t> frustumVisibleIndices(occludeesNum), visibleIndices(occludeesNum);
+
+	std::printf("%u occluders (%u triangles), %u occludees, %ux%u depth, %u worker threads, best of 10 runs\n",
+		occludersNum, occludersNum * 12, occludeesNum, rasterizer.GetWidth(), rasterizer.GetHeight(), threadPool.GetThreadsNum());
+	std::printf("%-12s %10s %10s %10s %12s %10s %10s %10s\n", "view", "triangles", "setup ms", "raster ms", "parallel ms", "in frustum", "filter ms", "occluded");
+
+	for (uint32_t viewIdx = 0; viewIdx < 2; viewIdx++)
+	{
+		const Eigen::Matrix4f viewProjMatrix = projMatrix * viewMatrices[viewIdx];
+
+		const double setupMs = MeasureBestMs([&]() { AddSceneOccluders(rasterizer, scene, viewProjMatrix); });
+		const double rasterizeMs = MeasureBestMs([&]() { rasterizer.Rasterize(); });
+		const double parallelRasterizeMs = MeasureBestMs([&]() { rasterizer.Rasterize(&threadPool); });
+
+		// Occlusion runs on the output of frustum culling
+		const uint32_t frustumVisibleNum = CullAABBs(ExtractFrustumPlanes(viewProjMatrix), aabbs, 0, occludeesNum, frustumVisibleIndices.data());
+		uint32_t visibleNum = 0;
+		const double filterMs = MeasureBestMs([&]() {
+			std::copy(frustumVisibleIndices.begin(), frustumVisibleIndices.begin() + frustumVisibleNum, visibleIndices.begin());
+			visibleNum = rasterizer.FilterVisibleAABBs(aabbs, visibleIndices.data(), frustumVisibleNum);
+		});
+
+		std::printf("%-12s %10u %10.3f %10.3f %12.3f %10u %10.3f %10u\n", viewNames[viewIdx], rasterizer.GetTrianglesNum(), setupMs, rasterizeMs, parallelRasterizeMs, frustumVisibleNum, filterMs, frustumVisibleNum - visibleNum);
+	}
+
+	return 0;
+}
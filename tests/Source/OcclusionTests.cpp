@@ -0,0 +1,195 @@
+/*
+ OcclusionTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "GEPUtilsOcclusion.h"
+#include "GEPUtilsGeometry.h"
+#include "GEPUtilsThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	// Camera in the origin looking down +Z, the occluder is a square wall at g_WallDistance facing it
+	constexpr float g_WallDistance = 10.f;
+	constexpr float g_WallHalfSize = 5.f;
+
+	Eigen::Matrix4f MakeTestViewProj()
+	{
+		const Eigen::Matrix4f viewMatrix = LookAt(Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitZ(), Eigen::Vector3f::UnitY());
+		return Perspective(0.5f, 100.f, 16.f / 9.f, 1.f) * viewMatrix;
+	}
+
+	// Square made of two triangles, centered in InCenter and orthogonal to Z
+	void AddTestQuad(OcclusionRasterizer& InRasterizer, const Eigen::Vector3f& InCenter, float InHalfSize)
+	{
+		const float positions[] = {
+			-InHalfSize, -InHalfSize, 0.f,
+			InHalfSize, -InHalfSize, 0.f,
+			InHalfSize, InHalfSize, 0.f,
+			-InHalfSize, InHalfSize, 0.f
+		};
+		const uint16_t indices[] = { 0, 1, 2, 0, 2, 3 };
+		const Eigen::Matrix4f modelMatrix = Eigen::Affine3f(Eigen::Translation3f(InCenter)).matrix();
+		InRasterizer.AddOccluder(positions, 3 * sizeof(float), 4, indices, 6, modelMatrix);
+	}
+
+	// Exact test: the box is hidden when all its corners are past the wall and the rays from the camera to them cross the wall.
+	// InWallMargin grows the wall, since coverage is sampled at pixel centers and boxes sticking out by less than a pixel can be culled.
+	bool IsHiddenByWall(const Eigen::Vector3f& InMin, const Eigen::Vector3f& InMax, double InWallMargin)
+	{
+		if (InMin.z() <= g_WallDistance)
+			return false;
+		for (uint32_t cornerIdx = 0; cornerIdx < 8; cornerIdx++)
+		{
+			const Eigen::Vector3d corner(cornerIdx & 1 ? InMax.x() : InMin.x(), cornerIdx & 2 ? InMax.y() : InMin.y(), cornerIdx & 4 ? InMax.z() : InMin.z());
+			const Eigen::Vector3d wallPoint = corner * (g_WallDistance / corner.z());
+			if (std::abs(wallPoint.x()) > g_WallHalfSize + InWallMargin || std::abs(wallPoint.y()) > g_WallHalfSize + InWallMargin)
+				return false;
+		}
+		return true;
+	}
+
+}
+
+GEP_TEST(Occlusion, WallHidesObjectsBehindIt)
+{
+	OcclusionRasterizer testRasterizer;
+	testRasterizer.BeginFrame(MakeTestViewProj());
+	AddTestQuad(testRasterizer, Eigen::Vector3f(0.f, 0.f, g_WallDistance), g_WallHalfSize);
+	testRasterizer.Rasterize();
+	GEP_CHECK(testRasterizer.GetTrianglesNum() == 2);
+
+	// Behind the wall, in front of it, crossing it, and behind it but sticking out on the side
+	GEP_CHECK(!testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, -1.f, 20.f), Eigen::Vector3f(1.f, 1.f, 22.f)));
+	GEP_CHECK(testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, -1.f, 5.f), Eigen::Vector3f(1.f, 1.f, 6.f)));
+	GEP_CHECK(testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, -1.f, 9.f), Eigen::Vector3f(1.f, 1.f, 11.f)));
+	GEP_CHECK(testRasterizer.IsAABBVisible(Eigen::Vector3f(8.f, -1.f, 20.f), Eigen::Vector3f(12.f, 1.f, 22.f)));
+
+	// Outside the screen
+	GEP_CHECK(!testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, 80.f, 20.f), Eigen::Vector3f(1.f, 82.f, 22.f)));
+
+	// Removing the occluders leaves everything on screen visible again
+	testRasterizer.BeginFrame(MakeTestViewProj());
+	testRasterizer.Rasterize();
+	GEP_CHECK(testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, -1.f, 20.f), Eigen::Vector3f(1.f, 1.f, 22.f)));
+}
+
+GEP_TEST(Occlusion, IsConservativeAgainstExactTest)
+{
+	OcclusionRasterizer testRasterizer;
+	testRasterizer.BeginFrame(MakeTestViewProj());
+	AddTestQuad(testRasterizer, Eigen::Vector3f(0.f, 0.f, g_WallDistance), g_WallHalfSize);
+	testRasterizer.Rasterize();
+
+	// Size of a pixel at the wall distance, with a vertical field of view of 1 radian
+	const double wallPixelSize = 2. * g_WallDistance * std::tan(0.5) / testRasterizer.GetHeight();
+
+	std::mt19937 randomGenerator(48);
+	std::uniform_real_distribution<float> positionXYDistribution(-15.f, 15.f);
+	std::uniform_real_distribution<float> positionZDistribution(2.f, 60.f);
+	std::uniform_real_distribution<float> extentDistribution(0.1f, 3.f);
+
+	uint32_t wronglyHiddenNum = 0, hiddenNum = 0, culledNum = 0;
+	for (uint32_t objectIdx = 0; objectIdx < 20000; objectIdx++)
+	{
+		const Eigen::Vector3f center(positionXYDistribution(randomGenerator), positionXYDistribution(randomGenerator), positionZDistribution(randomGenerator));
+		const Eigen::Vector3f extent(extentDistribution(randomGenerator), extentDistribution(randomGenerator), extentDistribution(randomGenerator));
+		const bool isCulled = !testRasterizer.IsAABBVisible(center - extent, center + extent);
+		const bool isHidden = IsHiddenByWall(center - extent, center + extent, 0.);
+		const bool isHiddenWithinPixel = IsHiddenByWall(center - extent, center + extent, wallPixelSize);
+
+		// Objects outside the screen are culled too, only the ones inside can be checked against the wall
+		const Eigen::Vector4f clipCenter = MakeTestViewProj() * center.homogeneous();
+		const bool isCenterOnScreen = std::abs(clipCenter.x()) < clipCenter.w() && std::abs(clipCenter.y()) < clipCenter.w();
+		wronglyHiddenNum += isCulled && !isHiddenWithinPixel && isCenterOnScreen ? 1 : 0;
+		hiddenNum += isHidden ? 1 : 0;
+		culledNum += isCulled && isHidden ? 1 : 0;
+	}
+	GEP_CHECK(wronglyHiddenNum == 0);
+
+	// Being conservative at the borders of the wall, most of the hidden objects still need to be culled
+	GEP_CHECK(hiddenNum > 1000);
+	GEP_CHECK(culledNum * 4 >= hiddenNum * 3);
+}
+
+GEP_TEST(Occlusion, DropsOccludersCrossingNearPlane)
+{
+	OcclusionRasterizer testRasterizer;
+
+	// A wall crossing the near plane is dropped, so it does not hide anything, as documented
+	testRasterizer.BeginFrame(MakeTestViewProj());
+	const float positions[] = { -50.f, -50.f, 0.1f, 50.f, -50.f, 0.1f, 0.f, 50.f, 30.f };
+	const uint32_t indices[] = { 0, 1, 2 };
+	testRasterizer.AddOccluder(positions, 3 * sizeof(float), 3, indices, 3, Eigen::Matrix4f::Identity());
+	testRasterizer.Rasterize();
+	GEP_CHECK(testRasterizer.GetTrianglesNum() == 0);
+	GEP_CHECK(testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, -1.f, 40.f), Eigen::Vector3f(1.f, 1.f, 42.f)));
+
+	// Objects crossing the near plane are always visible, even behind a wall
+	testRasterizer.BeginFrame(MakeTestViewProj());
+	AddTestQuad(testRasterizer, Eigen::Vector3f(0.f, 0.f, 1.f), 3.f);
+	testRasterizer.Rasterize();
+	GEP_CHECK(testRasterizer.GetTrianglesNum() == 2);
+	GEP_CHECK(!testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, -1.f, 20.f), Eigen::Vector3f(1.f, 1.f, 22.f)));
+	GEP_CHECK(testRasterizer.IsAABBVisible(Eigen::Vector3f(-1.f, -1.f, -1.f), Eigen::Vector3f(1.f, 1.f, 22.f)));
+}
+
+GEP_TEST(Occlusion, ParallelRasterizationMatchesSingleThreaded)
+{
+	std::mt19937 randomGenerator(49);
+	std::uniform_real_distribution<float> positionXYDistribution(-20.f, 20.f);
+	std::uniform_real_distribution<float> positionZDistribution(5.f, 60.f);
+	std::uniform_real_distribution<float> sizeDistribution(0.5f, 4.f);
+
+	OcclusionRasterizer singleThreadedRasterizer, parallelRasterizer;
+	singleThreadedRasterizer.BeginFrame(MakeTestViewProj());
+	parallelRasterizer.BeginFrame(MakeTestViewProj());
+	for (uint32_t quadIdx = 0; quadIdx < 200; quadIdx++)
+	{
+		const Eigen::Vector3f center(positionXYDistribution(randomGenerator), positionXYDistribution(randomGenerator), positionZDistribution(randomGenerator));
+		const float halfSize = sizeDistribution(randomGenerator);
+		AddTestQuad(singleThreadedRasterizer, center, halfSize);
+		AddTestQuad(parallelRasterizer, center, halfSize);
+	}
+
+	GEPUtils::ThreadPool threadPool(3);
+	singleThreadedRasterizer.Rasterize();
+	parallelRasterizer.Rasterize(&threadPool);
+
+	const uint32_t pixelsNum = singleThreadedRasterizer.GetWidth() * singleThreadedRasterizer.GetHeight();
+	GEP_CHECK(std::equal(singleThreadedRasterizer.GetDepthBuffer(), singleThreadedRasterizer.GetDepthBuffer() + pixelsNum, parallelRasterizer.GetDepthBuffer()));
+
+	// Filtering keeps the order of the visible objects
+	std::vector<float> centerX, centerY, centerZ, extents;
+	std::vector<uint32_t> indices;
+	for (uint32_t objectIdx = 0; objectIdx < 1000; objectIdx++)
+	{
+		centerX.push_back(positionXYDistribution(randomGenerator));
+		centerY.push_back(positionXYDistribution(randomGenerator));
+		centerZ.push_back(positionZDistribution(randomGenerator) + 10.f);
+		extents.push_back(0.5f);
+		indices.push_back(objectIdx);
+	}
+	const AABBS_SOA aabbs = { centerX.data(), centerY.data(), centerZ.data(), extents.data(), extents.data(), extents.data() };
+	const uint32_t visibleNum = parallelRasterizer.FilterVisibleAABBs(aabbs, indices.data(), static_cast<uint32_t>(indices.size()));
+	GEP_CHECK(visibleNum > 0 && visibleNum < indices.size());
+	GEP_CHECK(std::is_sorted(indices.begin(), indices.begin() + visibleNum));
+
+	bool isMatchingSingleObjectTest = true;
+	for (uint32_t visibleIdx = 0; visibleIdx < visibleNum; visibleIdx++)
+	{
+		const uint32_t objectIdx = indices[visibleIdx];
+		const Eigen::Vector3f center(centerX[objectIdx], centerY[objectIdx], centerZ[objectIdx]);
+		isMatchingSingleObjectTest = isMatchingSingleObjectTest && singleThreadedRasterizer.IsAABBVisible(center - Eigen::Vector3f::Constant(0.5f), center + Eigen::Vector3f::Constant(0.5f));
+	}
+	GEP_CHECK(isMatchingSingleObjectTest);
+}
@@ -0,0 +1,108 @@
+/*
+ PipelineDiskCacheBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "PipelineDiskCache.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "GEPUtilsHash.h"
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	const char* g_CacheFilePath = "PipelineDiskCacheBench.bin";
+
+	constexpr uint64_t g_DeviceIdentityHash = 0x1234;
+
+	using BenchClock = std::chrono::steady_clock;
+
+	double ElapsedMs(BenchClock::time_point InStartTime)
+	{
+		return std::chrono::duration<double, std::milli>(BenchClock::now() - InStartTime).count();
+	}
+
+	// Synthetic description of about the size of a graphics pipeline state one
+	PipelineDescKey MakeDescKey(uint32_t InEntryIdx)
+	{
+		PipelineDescKey outKey;
+		outKey.m_Desc.resize(160);
+		for (size_t byteIdx = 0; byteIdx < outKey.m_Desc.size(); byteIdx++)
+			outKey.m_Desc[byteIdx] = static_cast<uint8_t>((InEntryIdx >> ((byteIdx % 4) * 8)) + byteIdx);
+		outKey.m_Hash = GEPUtils::Hash::HashBytes(outKey.m_Desc.data(), outKey.m_Desc.size());
+		return outKey;
+	}
+
+}
+
+// Measures saving, loading (header and table validation) and first and second lookups (blob validation) of a cache file
+// with synthetic blobs sized as driver compiled pipeline states
+int main()
+{
+	constexpr uint32_t entriesNums[] = { 100, 1000, 5000 };
+
+	std::printf("%10s %10s %10s %10s %16s %16s\n", "entries", "file MB", "save ms", "load ms", "first find ms", "second find ms");
+
+	std::mt19937 randomGenerator(42);
+	std::uniform_int_distribution<size_t> blobSizeDistribution(2 * 1024, 32 * 1024);
+
+	for (uint32_t entriesNum : entriesNums)
+	{
+		std::vector<PipelineDescKey> descKeys;
+		{
+			PipelineDiskCache diskCache;
+			diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash);
+
+			std::vector<uint8_t> blob;
+			for (uint32_t entryIdx = 0; entryIdx < entriesNum; entryIdx++)
+			{
+				blob.resize(blobSizeDistribution(randomGenerator));
+				for (size_t byteIdx = 0; byteIdx < blob.size(); byteIdx++)
+					blob[byteIdx] = static_cast<uint8_t>(randomGenerator());
+
+				descKeys.push_back(MakeDescKey(entryIdx));
+				diskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, descKeys.back(), blob.data(), blob.size());
+			}
+
+			const BenchClock::time_point saveStartTime = BenchClock::now();
+			diskCache.Save(g_CacheFilePath);
+			const double saveMs = ElapsedMs(saveStartTime);
+			std::printf("%10u", entriesNum);
+
+			std::vector<uint8_t> fileData;
+			diskCache.Serialize(fileData);
+			std::printf(" %10.1f %10.2f", fileData.size() / (1024.0 * 1024.0), saveMs);
+		}
+
+		PipelineDiskCache diskCache;
+		const BenchClock::time_point loadStartTime = BenchClock::now();
+		const bool isLoaded = diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash);
+		const double loadMs = ElapsedMs(loadStartTime);
+
+		const void* foundBlob = nullptr;
+		size_t foundBlobSize = 0;
+		uint32_t foundEntriesNum = 0;
+
+		// The first lookup of an entry hashes its blob, the following ones do not
+		const BenchClock::time_point firstFindStartTime = BenchClock::now();
+		for (const PipelineDescKey& currentKey : descKeys)
+			foundEntriesNum += diskCache.Find(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, currentKey, foundBlob, foundBlobSize) ? 1 : 0;
+		const double firstFindMs = ElapsedMs(firstFindStartTime);
+
+		const BenchClock::time_point secondFindStartTime = BenchClock::now();
+		for (const PipelineDescKey& currentKey : descKeys)
+			foundEntriesNum += diskCache.Find(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, currentKey, foundBlob, foundBlobSize) ? 1 : 0;
+		const double secondFindMs = ElapsedMs(secondFindStartTime);
+
+		std::printf(" %10.2f %16.2f %16.2f%s\n", loadMs, firstFindMs, secondFindMs, isLoaded && foundEntriesNum == 2 * entriesNum ? "" : " (lookups failed)");
+	}
+
+	std::remove(g_CacheFilePath);
+
+	return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ PipelineDiskCacheTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "PipelineDiskCache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "GEPUtilsHash.h"
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	// Note: tests run in the build folder
+	const char* g_CacheFilePath = "PipelineDiskCacheTests.bin";
+
+	constexpr uint64_t g_DeviceIdentityHash = 0x1234;
+
+	PipelineDescKey MakeDescKey(uint8_t InSeed)
+	{
+		PipelineDescKey outKey;
+		outKey.m_Desc = { InSeed, static_cast<uint8_t>(InSeed + 1), static_cast<uint8_t>(InSeed + 2) };
+		outKey.m_Hash = GEPUtils::Hash::HashBytes(outKey.m_Desc.data(), outKey.m_Desc.size());
+		return outKey;
+	}
+
+	std::vector<uint8_t> MakeBlob(uint8_t InSeed, size_t InSize)
+	{
+		std::vector<uint8_t> outBlob(InSize);
+		for (size_t byteIdx = 0; byteIdx < InSize; byteIdx++)
+			outBlob[byteIdx] = static_cast<uint8_t>(InSeed + byteIdx);
+		return outBlob;
+	}
+
+	void WriteFile(const std::vector<uint8_t>& InFileData)
+	{
+		std::ofstream outFile(g_CacheFilePath, std::ios::binary | std::ios::trunc);
+		outFile.write(reinterpret_cast<const char*>(InFileData.data()), InFileData.size());
+	}
+
+	bool HasBlob(PipelineDiskCache& InCache, PIPELINE_CACHE_ENTRY_TYPE InType, const PipelineDescKey& InDescKey, const std::vector<uint8_t>& InExpectedBlob)
+	{
+		const void* foundBlob = nullptr;
+		size_t foundBlobSize = 0;
+		return InCache.Find(InType, InDescKey, foundBlob, foundBlobSize)
+			&& foundBlobSize == InExpectedBlob.size() && std::memcmp(foundBlob, InExpectedBlob.data(), foundBlobSize) == 0;
+	}
+
+	// File with a root signature and a pipeline state entry
+	std::vector<uint8_t> MakeCacheFileData()
+	{
+		PipelineDiskCache diskCache;
+		diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash);
+		diskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, MakeDescKey(1), MakeBlob(1, 100).data(), 100);
+		diskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, MakeDescKey(2), MakeBlob(2, 300).data(), 300);
+
+		std::vector<uint8_t> outFileData;
+		diskCache.Serialize(outFileData);
+		return outFileData;
+	}
+
+}
+
+GEP_TEST(PipelineDiskCache, SaveAndLoad)
+{
+	std::remove(g_CacheFilePath);
+	{
+		PipelineDiskCache diskCache;
+		GEP_CHECK(!diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash));
+		diskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, MakeDescKey(1), MakeBlob(1, 100).data(), 100);
+		diskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, MakeDescKey(2), MakeBlob(2, 300).data(), 300);
+		GEP_CHECK(diskCache.Save(g_CacheFilePath));
+
+		// Saved entries stay available from the mapped file
+		GEP_CHECK(HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, MakeDescKey(2), MakeBlob(2, 300)));
+	}
+
+	PipelineDiskCache diskCache;
+	GEP_CHECK(diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash));
+	GEP_CHECK(diskCache.GetLoadedEntriesNum() == 2);
+	GEP_CHECK(HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, MakeDescKey(1), MakeBlob(1, 100)));
+	GEP_CHECK(HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, MakeDescKey(2), MakeBlob(2, 300)));
+
+	// Entry types are part of the key
+	GEP_CHECK(!HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, MakeDescKey(1), MakeBlob(1, 100)));
+
+	// Invalidated entries are not written back
+	diskCache.Invalidate(PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, MakeDescKey(1));
+	GEP_CHECK(diskCache.Save(g_CacheFilePath));
+	GEP_CHECK(diskCache.GetLoadedEntriesNum() == 1);
+
+	std::remove(g_CacheFilePath);
+}
+
+GEP_TEST(PipelineDiskCache, DiscardsFileOfAnotherDevice)
+{
+	WriteFile(MakeCacheFileData());
+
+	PipelineDiskCache diskCache;
+	GEP_CHECK(!diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash + 1));
+	GEP_CHECK(diskCache.GetLoadedEntriesNum() == 0);
+	GEP_CHECK(!HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, MakeDescKey(1), MakeBlob(1, 100)));
+
+	std::remove(g_CacheFilePath);
+}
+
+GEP_TEST(PipelineDiskCache, InvalidatesCorruptedBlob)
+{
+	// Blobs are written after the descriptions in key order, the last byte of the file belongs to one of the two blobs
+	std::vector<uint8_t> fileData = MakeCacheFileData();
+	fileData.back() ^= 0xff;
+	WriteFile(fileData);
+
+	PipelineDiskCache diskCache;
+	GEP_CHECK(diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash));
+
+	const bool hasRootSignature = HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, MakeDescKey(1), MakeBlob(1, 100));
+	const bool hasPipelineState = HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, MakeDescKey(2), MakeBlob(2, 300));
+	GEP_CHECK(hasRootSignature != hasPipelineState);
+	GEP_CHECK(diskCache.GetInvalidatedEntriesNum() == 1);
+
+	std::remove(g_CacheFilePath);
+}
+
+GEP_TEST(PipelineDiskCache, DiscardsCorruptedTable)
+{
+	std::vector<uint8_t> fileData = MakeCacheFileData();
+	fileData[sizeof(PIPELINE_CACHE_FILE_HEADER) + offsetof(PIPELINE_CACHE_FILE_ENTRY, BlobSize)] ^= 0xff;
+	WriteFile(fileData);
+
+	PipelineDiskCache diskCache;
+	GEP_CHECK(!diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash));
+
+	std::remove(g_CacheFilePath);
+}
+
+GEP_TEST(PipelineDiskCache, DiscardsTruncatedFile)
+{
+	const std::vector<uint8_t> fileData = MakeCacheFileData();
+
+	// Cut in the header, in the entries table and in the blobs
+	const size_t truncatedSizes[] = { sizeof(PIPELINE_CACHE_FILE_HEADER) / 2, sizeof(PIPELINE_CACHE_FILE_HEADER) + sizeof(PIPELINE_CACHE_FILE_ENTRY), fileData.size() - 1 };
+	for (size_t truncatedSize : truncatedSizes)
+	{
+		WriteFile(std::vector<uint8_t>(fileData.begin(), fileData.begin() + truncatedSize));
+
+		PipelineDiskCache diskCache;
+		GEP_CHECK(!diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash));
+		GEP_CHECK(diskCache.GetLoadedEntriesNum() == 0);
+	}
+
+	std::remove(g_CacheFilePath);
+}
+
+GEP_TEST(PipelineDiskCache, CollidingDescriptionsMiss)
+{
+	WriteFile(MakeCacheFileData());
+
+	PipelineDescKey collidingKey = MakeDescKey(7);
+	collidingKey.m_Hash = MakeDescKey(2).m_Hash;
+
+	PipelineDiskCache diskCache;
+	GEP_CHECK(diskCache.Load(g_CacheFilePath, g_DeviceIdentityHash));
+	GEP_CHECK(!HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, collidingKey, MakeBlob(2, 300)));
+	GEP_CHECK(HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::PIPELINE_STATE, MakeDescKey(2), MakeBlob(2, 300)));
+
+	// Same for entries stored during this run
+	diskCache.Store(PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, MakeDescKey(9), MakeBlob(9, 10).data(), 10);
+	collidingKey.m_Hash = MakeDescKey(9).m_Hash;
+	GEP_CHECK(!HasBlob(diskCache, PIPELINE_CACHE_ENTRY_TYPE::ROOT_SIGNATURE, collidingKey, MakeBlob(9, 10)));
+
+	std::remove(g_CacheFilePath);
+}
@@ -0,0 +1,59 @@
+/*
+ PipelineStateCacheTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "PipelineStateCache.h"
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	PipelineState::RESOURCE_BINDER_DESC MakeResourceBinderDesc(uint32_t InConstantsNum)
+	{
+		PipelineState::RESOURCE_BINDER_DESC outDesc;
+		outDesc.Flags = PipelineState::RESOURCE_BINDER_FLAGS::NONE;
+		outDesc.Params.resize(2);
+		outDesc.Params[0].InitAsConstants(InConstantsNum, 0, 0, SHADER_VISIBILITY::SV_VERTEX);
+		outDesc.Params[1].InitAsTableCBVRange(1, 1, 0, SHADER_VISIBILITY::SV_PIXEL);
+		return outDesc;
+	}
+
+}
+
+GEP_TEST(PipelineStateCache, KeysDependOnDescriptionContent)
+{
+	const PipelineDescKey firstKey = MakeResourceBinderDescKey(MakeResourceBinderDesc(16));
+	const PipelineDescKey sameKey = MakeResourceBinderDescKey(MakeResourceBinderDesc(16));
+	const PipelineDescKey otherKey = MakeResourceBinderDescKey(MakeResourceBinderDesc(4));
+
+	GEP_CHECK(firstKey == sameKey);
+	GEP_CHECK(firstKey.m_Hash == sameKey.m_Hash);
+	GEP_CHECK(firstKey != otherKey);
+}
+
+GEP_TEST(PipelineStateCache, CollidingHashesDoNotShareEntries)
+{
+	// Same hash, different descriptions: a cache keyed by hash only would return the first pipeline state for the second request
+	PipelineDescKey firstKey = MakeResourceBinderDescKey(MakeResourceBinderDesc(16));
+	PipelineDescKey collidingKey = MakeResourceBinderDescKey(MakeResourceBinderDesc(4));
+	collidingKey.m_Hash = firstKey.m_Hash;
+
+	PipelineStateCache pipelineStateCache;
+	bool isNew = false;
+
+	pipelineStateCache.FindOrAdd(firstKey, AsyncPipelineState(), isNew);
+	GEP_CHECK(isNew);
+
+	pipelineStateCache.FindOrAdd(collidingKey, AsyncPipelineState(), isNew);
+	GEP_CHECK(isNew);
+	GEP_CHECK(pipelineStateCache.GetPipelineStatesNum() == 2);
+
+	pipelineStateCache.FindOrAdd(firstKey, AsyncPipelineState(), isNew);
+	GEP_CHECK(!isNew);
+	GEP_CHECK(pipelineStateCache.GetHitsNum() == 1);
+}
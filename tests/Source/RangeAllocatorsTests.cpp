@@ -0,0 +1,60 @@
+/*
+ RangeAllocatorsTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "RangeAllocators.h"
+
+using namespace GEPUtils::Graphics;
+
+GEP_TEST(RangeAllocators, TryAllocateFailsForFragmentation)
+{
+	StaticRangeAllocator rangeAllocator(0, 100);
+
+	uint32_t rangeOffsets[4];
+	for (uint32_t& currentOffset : rangeOffsets)
+		GEP_CHECK(rangeAllocator.TryAllocateRange(25, currentOffset));
+
+	// 50 free in total, in two ranges of 25 that are not contiguous
+	rangeAllocator.FreeAllocatedRange(rangeOffsets[1], 25);
+	rangeAllocator.FreeAllocatedRange(rangeOffsets[3], 25);
+	GEP_CHECK(rangeAllocator.GetFreeRangesNum() == 2);
+
+	uint32_t failedOffset = 1234;
+	GEP_CHECK(!rangeAllocator.TryAllocateRange(40, failedOffset));
+	GEP_CHECK(failedOffset == 1234);
+	GEP_CHECK(rangeAllocator.GetFreeRangesNum() == 2);
+
+	// The free ranges are still usable after the failure
+	uint32_t firstOffset = 0, secondOffset = 0;
+	GEP_CHECK(rangeAllocator.TryAllocateRange(25, firstOffset));
+	GEP_CHECK(rangeAllocator.TryAllocateRange(25, secondOffset));
+	GEP_CHECK((firstOffset == rangeOffsets[1] && secondOffset == rangeOffsets[3]) || (firstOffset == rangeOffsets[3] && secondOffset == rangeOffsets[1]));
+	GEP_CHECK(rangeAllocator.GetFreeRangesNum() == 0);
+	GEP_CHECK(!rangeAllocator.TryAllocateRange(1, failedOffset));
+}
+
+GEP_TEST(RangeAllocators, FreedRangesMerge)
+{
+	StaticRangeAllocator rangeAllocator(10, 90);
+
+	uint32_t firstOffset = 0, secondOffset = 0, thirdOffset = 0;
+	GEP_CHECK(rangeAllocator.TryAllocateRange(30, firstOffset));
+	GEP_CHECK(rangeAllocator.TryAllocateRange(30, secondOffset));
+	GEP_CHECK(rangeAllocator.TryAllocateRange(30, thirdOffset));
+	GEP_CHECK(firstOffset >= 10 && secondOffset >= 10 && thirdOffset >= 10);
+
+	rangeAllocator.FreeAllocatedRange(firstOffset, 30);
+	rangeAllocator.FreeAllocatedRange(thirdOffset, 30);
+	rangeAllocator.FreeAllocatedRange(secondOffset, 30);
+	GEP_CHECK(rangeAllocator.GetFreeRangesNum() == 1);
+
+	// The whole pool is contiguous again
+	uint32_t wholeOffset = 0;
+	GEP_CHECK(rangeAllocator.TryAllocateRange(90, wholeOffset));
+	GEP_CHECK(wholeOffset == 10);
+}
@@ -0,0 +1,214 @@
+/*
+ RenderGraphTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "TestGraphicsTypes.h"
+#include "RenderGraph.h"
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	const RenderGraph::ExecuteFnType g_EmptyExecuteFn = [](CommandList&, RenderGraph&) {};
+
+	RENDER_GRAPH_TEXTURE_DESC MakeTextureDesc(uint32_t InMipLevels = 1)
+	{
+		RENDER_GRAPH_TEXTURE_DESC outDesc;
+		outDesc.Width = 256;
+		outDesc.Height = 256;
+		outDesc.MipLevels = InMipLevels;
+		outDesc.Flags = RESOURCE_FLAGS::ALLOW_RENDER_TARGET;
+		return outDesc;
+	}
+
+	bool HasTransition(const std::vector<RENDER_GRAPH_TRANSITION>& InTransitions, RenderGraphResourceHandle InResource, uint32_t InSubresource, RESOURCE_STATE InStateAfter)
+	{
+		for (const RENDER_GRAPH_TRANSITION& currentTransition : InTransitions)
+		{
+			if (currentTransition.m_Resource.m_Index == InResource.m_Index && currentTransition.m_Subresource == InSubresource && currentTransition.m_StateAfter == InStateAfter)
+				return true;
+		}
+		return false;
+	}
+
+}
+
+GEP_TEST(RenderGraph, CullsPassesNotContributingToOutputs)
+{
+	GEPTests::TestResource backBuffer;
+	RenderGraph renderGraph;
+
+	RenderGraphResourceHandle backBufferHandle = renderGraph.ImportOutputResource("BackBuffer", backBuffer, RESOURCE_STATE::PRESENT);
+	RenderGraphResourceHandle sceneColor = renderGraph.CreateTexture("SceneColor", MakeTextureDesc());
+	RenderGraphResourceHandle unusedTexture = renderGraph.CreateTexture("Unused", MakeTextureDesc());
+
+	RenderGraphPassHandle scenePass = renderGraph.AddPass("Scene", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(sceneColor, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle unusedPass = renderGraph.AddPass("Unused", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(sceneColor, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+		InBuilder.Write(unusedTexture, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle compositePass = renderGraph.AddPass("Composite", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(sceneColor, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+		InBuilder.Write(backBufferHandle, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+
+	renderGraph.Compile();
+
+	GEP_CHECK(!renderGraph.IsPassCulled(scenePass));
+	GEP_CHECK(renderGraph.IsPassCulled(unusedPass));
+	GEP_CHECK(!renderGraph.IsPassCulled(compositePass));
+	GEP_CHECK((renderGraph.GetExecutionOrder() == std::vector<uint32_t>{ scenePass.m_Index, compositePass.m_Index }));
+}
+
+GEP_TEST(RenderGraph, KeepsPassesWithSideEffects)
+{
+	RenderGraph renderGraph;
+	RenderGraphResourceHandle readbackBuffer = renderGraph.CreateBuffer("Readback", RENDER_GRAPH_BUFFER_DESC{ 1024, RESOURCE_FLAGS::NONE });
+
+	RenderGraphPassHandle writePass = renderGraph.AddPass("Write", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(readbackBuffer, RESOURCE_STATE::UNORDERED_ACCESS);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle copyPass = renderGraph.AddPass("Copy", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(readbackBuffer, RESOURCE_STATE::COPY_SOURCE);
+		InBuilder.SetHasSideEffects();
+	}, g_EmptyExecuteFn);
+
+	renderGraph.Compile();
+
+	// The side effect keeps the copy, which in turn keeps the pass writing what it reads
+	GEP_CHECK(!renderGraph.IsPassCulled(writePass));
+	GEP_CHECK(!renderGraph.IsPassCulled(copyPass));
+}
+
+GEP_TEST(RenderGraph, ComputesLifetimesInExecutionOrder)
+{
+	GEPTests::TestResource backBuffer;
+	RenderGraph renderGraph;
+
+	RenderGraphResourceHandle backBufferHandle = renderGraph.ImportOutputResource("BackBuffer", backBuffer, RESOURCE_STATE::PRESENT);
+	RenderGraphResourceHandle firstTexture = renderGraph.CreateTexture("First", MakeTextureDesc());
+	RenderGraphResourceHandle culledTexture = renderGraph.CreateTexture("Culled", MakeTextureDesc());
+	RenderGraphResourceHandle secondTexture = renderGraph.CreateTexture("Second", MakeTextureDesc());
+
+	renderGraph.AddPass("First", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(firstTexture, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+	renderGraph.AddPass("Culled", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(culledTexture, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+	renderGraph.AddPass("Second", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(firstTexture, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+		InBuilder.Write(secondTexture, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+	renderGraph.AddPass("Composite", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(secondTexture, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+		InBuilder.Write(backBufferHandle, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+
+	renderGraph.Compile();
+
+	// Positions are counted among the passes that are not culled
+	const RenderGraphResourceLifetime firstLifetime = renderGraph.GetResourceLifetime(firstTexture);
+	GEP_CHECK(firstLifetime.m_FirstPassPos == 0 && firstLifetime.m_LastPassPos == 1);
+	const RenderGraphResourceLifetime secondLifetime = renderGraph.GetResourceLifetime(secondTexture);
+	GEP_CHECK(secondLifetime.m_FirstPassPos == 1 && secondLifetime.m_LastPassPos == 2);
+	GEP_CHECK(firstLifetime.Overlaps(secondLifetime));
+	GEP_CHECK(!renderGraph.GetResourceLifetime(culledTexture).IsValid());
+	GEP_CHECK(renderGraph.IsTransient(firstTexture) && !renderGraph.IsTransient(backBufferHandle));
+}
+
+GEP_TEST(RenderGraph, MergesConsecutiveShaderResourceReads)
+{
+	GEPTests::TestResource backBuffer;
+	RenderGraph renderGraph;
+
+	RenderGraphResourceHandle backBufferHandle = renderGraph.ImportOutputResource("BackBuffer", backBuffer, RESOURCE_STATE::PRESENT);
+	RenderGraphResourceHandle sceneColor = renderGraph.CreateTexture("SceneColor", MakeTextureDesc());
+	RenderGraphResourceHandle bloom = renderGraph.CreateTexture("Bloom", MakeTextureDesc());
+
+	RenderGraphPassHandle scenePass = renderGraph.AddPass("Scene", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(sceneColor, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle bloomPass = renderGraph.AddPass("Bloom", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(sceneColor, RESOURCE_STATE::NON_PIXEL_SHADER_RESOURCE);
+		InBuilder.Write(bloom, RESOURCE_STATE::UNORDERED_ACCESS);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle compositePass = renderGraph.AddPass("Composite", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(sceneColor, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+		InBuilder.Read(bloom, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+		InBuilder.Write(backBufferHandle, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+
+	renderGraph.Compile();
+
+	GEP_CHECK(HasTransition(renderGraph.GetPassTransitions(scenePass), sceneColor, ALL_SUBRESOURCES, RESOURCE_STATE::RENDER_TARGET));
+
+	// Both reads of the scene color are covered by a single transition, to the combined state
+	GEP_CHECK(HasTransition(renderGraph.GetPassTransitions(bloomPass), sceneColor, ALL_SUBRESOURCES, RESOURCE_STATE::ALL_SHADER_RESOURCE));
+	GEP_CHECK(renderGraph.GetPassTransitions(bloomPass).size() == 2);
+
+	GEP_CHECK(HasTransition(renderGraph.GetPassTransitions(compositePass), bloom, ALL_SUBRESOURCES, RESOURCE_STATE::PIXEL_SHADER_RESOURCE));
+	GEP_CHECK(!HasTransition(renderGraph.GetPassTransitions(compositePass), sceneColor, ALL_SUBRESOURCES, RESOURCE_STATE::PIXEL_SHADER_RESOURCE));
+	GEP_CHECK(renderGraph.GetPassTransitions(compositePass).size() == 2);
+
+	// The back buffer goes back to present state after the last pass
+	GEP_CHECK(renderGraph.GetFinalTransitions().size() == 1);
+	GEP_CHECK(HasTransition(renderGraph.GetFinalTransitions(), backBufferHandle, ALL_SUBRESOURCES, RESOURCE_STATE::PRESENT));
+	GEP_CHECK(renderGraph.GetTransitionsNum() == 6);
+}
+
+GEP_TEST(RenderGraph, SkipsTransitionsToTheSameState)
+{
+	GEPTests::TestResource backBuffer;
+	RenderGraph renderGraph;
+
+	RenderGraphResourceHandle backBufferHandle = renderGraph.ImportOutputResource("BackBuffer", backBuffer, RESOURCE_STATE::PRESENT);
+
+	RenderGraphPassHandle firstPass = renderGraph.AddPass("First", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(backBufferHandle, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle secondPass = renderGraph.AddPass("Second", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(backBufferHandle, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+
+	renderGraph.Compile();
+
+	GEP_CHECK(renderGraph.GetPassTransitions(firstPass).size() == 1);
+	GEP_CHECK(renderGraph.GetPassTransitions(secondPass).empty());
+}
+
+GEP_TEST(RenderGraph, TransitionsSubresourcesIndependently)
+{
+	GEPTests::TestResource backBuffer;
+	RenderGraph renderGraph;
+
+	RenderGraphResourceHandle backBufferHandle = renderGraph.ImportOutputResource("BackBuffer", backBuffer, RESOURCE_STATE::PRESENT);
+	RenderGraphResourceHandle mipChain = renderGraph.CreateTexture("MipChain", MakeTextureDesc(2));
+
+	renderGraph.AddPass("WriteMip0", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Write(mipChain, RESOURCE_STATE::RENDER_TARGET, 0);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle downsamplePass = renderGraph.AddPass("Downsample", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(mipChain, RESOURCE_STATE::NON_PIXEL_SHADER_RESOURCE, 0);
+		InBuilder.Write(mipChain, RESOURCE_STATE::UNORDERED_ACCESS, 1);
+	}, g_EmptyExecuteFn);
+	RenderGraphPassHandle compositePass = renderGraph.AddPass("Composite", [&](RenderGraphPassBuilder& InBuilder) {
+		InBuilder.Read(mipChain, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+		InBuilder.Write(backBufferHandle, RESOURCE_STATE::RENDER_TARGET);
+	}, g_EmptyExecuteFn);
+
+	renderGraph.Compile();
+
+	GEP_CHECK(HasTransition(renderGraph.GetPassTransitions(downsamplePass), mipChain, 0, RESOURCE_STATE::NON_PIXEL_SHADER_RESOURCE));
+	GEP_CHECK(HasTransition(renderGraph.GetPassTransitions(downsamplePass), mipChain, 1, RESOURCE_STATE::UNORDERED_ACCESS));
+
+	// Subresources are in different states, so reading the whole resource transitions all of them
+	GEP_CHECK(HasTransition(renderGraph.GetPassTransitions(compositePass), mipChain, ALL_SUBRESOURCES, RESOURCE_STATE::PIXEL_SHADER_RESOURCE));
+}
@@ -0,0 +1,150 @@
+/*
+ ResourceBinderLayoutTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "ResourceBinderLayout.h"
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	using RESOURCE_BINDER_DESC = PipelineState::RESOURCE_BINDER_DESC;
+	using RESOURCE_BINDER_PARAM = PipelineState::RESOURCE_BINDER_PARAM;
+	using UPDATE_FREQUENCY = RESOURCE_BINDER_PARAM::UPDATE_FREQUENCY;
+
+	RESOURCE_BINDER_PARAM MakeConstants(uint32_t InNum32BitValues, uint32_t InShaderRegister, UPDATE_FREQUENCY InUpdateFrequency = UPDATE_FREQUENCY::PER_DRAW)
+	{
+		RESOURCE_BINDER_PARAM outParam;
+		outParam.InitAsConstants(InNum32BitValues, InShaderRegister, 1, SHADER_VISIBILITY::SV_VERTEX);
+		outParam.UpdateFrequency = InUpdateFrequency;
+		return outParam;
+	}
+
+	RESOURCE_BINDER_PARAM MakeTable(uint32_t InShaderRegister, UPDATE_FREQUENCY InUpdateFrequency)
+	{
+		RESOURCE_BINDER_PARAM outParam;
+		outParam.InitAsTableSRVRange(1, InShaderRegister, 0, SHADER_VISIBILITY::SV_PIXEL);
+		outParam.UpdateFrequency = InUpdateFrequency;
+		return outParam;
+	}
+
+}
+
+GEP_TEST(ResourceBinderLayout, CostsFollowRootSignatureRules)
+{
+	RESOURCE_BINDER_DESC binderDesc;
+	binderDesc.Params.resize(7);
+	binderDesc.Params[0].InitAsConstants(16, 0);
+	binderDesc.Params[1].InitAsTableCBVRange(4, 1);
+	binderDesc.Params[2].InitAsTableSRVRange(8, 0);
+	binderDesc.Params[3].InitAsTableUAVRange(2, 0);
+	binderDesc.Params[4].InitAsRootCBV(2);
+	binderDesc.Params[5].InitAsRootSRV(9);
+	binderDesc.Params[6].InitAsRootUAV(3);
+
+	// A DWORD per constant, one per table whatever its descriptors number, two per root descriptor
+	GEP_CHECK(GetResourceBinderParamCost(binderDesc.Params[0]) == 16);
+	GEP_CHECK(GetResourceBinderParamCost(binderDesc.Params[1]) == 1 && GetResourceBinderParamCost(binderDesc.Params[2]) == 1 && GetResourceBinderParamCost(binderDesc.Params[3]) == 1);
+	GEP_CHECK(GetResourceBinderParamCost(binderDesc.Params[4]) == 2 && GetResourceBinderParamCost(binderDesc.Params[5]) == 2 && GetResourceBinderParamCost(binderDesc.Params[6]) == 2);
+	GEP_CHECK(GetResourceBinderCost(binderDesc) == 25);
+
+	// Static samplers are free
+	binderDesc.StaticSamplers.push_back(StaticSampler(0, SAMPLE_FILTER_TYPE::POINT));
+	binderDesc.StaticSamplers.push_back(StaticSampler(1, SAMPLE_FILTER_TYPE::LINEAR));
+	GEP_CHECK(GetResourceBinderCost(binderDesc) == 25);
+
+	// Exactly at the limit is still within budget
+	RESOURCE_BINDER_LAYOUT binderLayout;
+	binderDesc.Params[0].InitAsConstants(16 + 39, 0);
+	GEP_CHECK(OptimizeResourceBinderLayout(binderDesc, RBL_NONE, binderLayout));
+	GEP_CHECK(binderLayout.DwordsNum == 64 && binderLayout.ConstantsToConvert.empty());
+
+	binderDesc.Params[0].InitAsConstants(16 + 40, 0);
+	GEP_CHECK(!OptimizeResourceBinderLayout(binderDesc, RBL_NONE, binderLayout));
+	GEP_CHECK(binderLayout.DwordsNum == 65);
+}
+
+GEP_TEST(ResourceBinderLayout, SortsByUpdateFrequencyStably)
+{
+	RESOURCE_BINDER_DESC binderDesc;
+	binderDesc.Params.push_back(MakeTable(0, UPDATE_FREQUENCY::STATIC));
+	binderDesc.Params.push_back(MakeConstants(4, 0, UPDATE_FREQUENCY::PER_FRAME));
+	binderDesc.Params.push_back(MakeConstants(16, 1, UPDATE_FREQUENCY::PER_DRAW));
+	binderDesc.Params.push_back(MakeTable(1, UPDATE_FREQUENCY::PER_MATERIAL));
+	binderDesc.Params.push_back(MakeConstants(2, 2, UPDATE_FREQUENCY::PER_DRAW));
+	binderDesc.Params.push_back(MakeTable(2, UPDATE_FREQUENCY::PER_FRAME));
+
+	// Without sorting the layout is the identity
+	RESOURCE_BINDER_DESC unsortedDesc = binderDesc;
+	RESOURCE_BINDER_LAYOUT binderLayout;
+	GEP_CHECK(OptimizeResourceBinderLayout(unsortedDesc, RBL_NONE, binderLayout));
+	GEP_CHECK((binderLayout.RootIndexRemap == std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5 }));
+
+	GEP_CHECK(OptimizeResourceBinderLayout(binderDesc, RBL_SORT_BY_UPDATE_FREQUENCY, binderLayout));
+	// Per draw first, then per material, per frame and static, same frequencies keep their original order
+	GEP_CHECK((binderLayout.RootIndexRemap == std::vector<uint32_t>{ 5, 3, 0, 2, 1, 4 }));
+	GEP_CHECK(binderDesc.Params[0].ShaderRegister == 1 && binderDesc.Params[0].Num32BitValues == 16);
+	GEP_CHECK(binderDesc.Params[1].ShaderRegister == 2 && binderDesc.Params[1].Num32BitValues == 2);
+	GEP_CHECK(binderDesc.Params[2].UpdateFrequency == UPDATE_FREQUENCY::PER_MATERIAL);
+	GEP_CHECK(binderDesc.Params[3].ResourceType == RESOURCE_BINDER_PARAM::RESOURCE_TYPE::CONSTANTS && binderDesc.Params[3].ShaderRegister == 0);
+	GEP_CHECK(binderDesc.Params[4].ResourceType == RESOURCE_BINDER_PARAM::RESOURCE_TYPE::SRV_RANGE && binderDesc.Params[4].ShaderRegister == 2);
+	GEP_CHECK(binderDesc.Params[5].UpdateFrequency == UPDATE_FREQUENCY::STATIC);
+
+	// Every parameter lands where the remap says
+	for (uint32_t originalIdx = 0; originalIdx < unsortedDesc.Params.size(); originalIdx++)
+	{
+		const RESOURCE_BINDER_PARAM& movedParam = binderDesc.Params[binderLayout.RootIndexRemap[originalIdx]];
+		GEP_CHECK(movedParam.ShaderRegister == unsortedDesc.Params[originalIdx].ShaderRegister && movedParam.ResourceType == unsortedDesc.Params[originalIdx].ResourceType);
+	}
+}
+
+GEP_TEST(ResourceBinderLayout, ConvertsBiggestConstantsOverBudget)
+{
+	RESOURCE_BINDER_DESC binderDesc;
+	binderDesc.Params.push_back(MakeConstants(16, 0));
+	binderDesc.Params.push_back(MakeConstants(32, 1));
+	binderDesc.Params.push_back(MakeConstants(2, 2));
+	binderDesc.Params.push_back(MakeConstants(20, 3));
+	binderDesc.Params.push_back(MakeTable(0, UPDATE_FREQUENCY::STATIC));
+	GEP_CHECK(GetResourceBinderCost(binderDesc) == 71);
+
+	// Conversions are only suggested by default, the description does not change
+	RESOURCE_BINDER_DESC suggestedDesc = binderDesc;
+	RESOURCE_BINDER_LAYOUT binderLayout;
+	GEP_CHECK(!OptimizeResourceBinderLayout(suggestedDesc, RBL_NONE, binderLayout));
+	GEP_CHECK((binderLayout.ConstantsToConvert == std::vector<uint32_t>{ 1 }));
+	GEP_CHECK(!binderLayout.AreConstantsConverted && binderLayout.DwordsNum == 71);
+	GEP_CHECK(suggestedDesc.Params[1].ResourceType == RESOURCE_BINDER_PARAM::RESOURCE_TYPE::CONSTANTS);
+
+	// Converting only the biggest gives back 30 DWORDs, which is enough
+	GEP_CHECK(OptimizeResourceBinderLayout(binderDesc, RBL_CONVERT_CONSTANTS_OVER_BUDGET, binderLayout));
+	GEP_CHECK(binderLayout.AreConstantsConverted && binderLayout.DwordsNum == 41);
+	GEP_CHECK(binderLayout.DwordsNum == GetResourceBinderCost(binderDesc));
+	const RESOURCE_BINDER_PARAM& convertedParam = binderDesc.Params[1];
+	GEP_CHECK(convertedParam.ResourceType == RESOURCE_BINDER_PARAM::RESOURCE_TYPE::ROOT_CBV && convertedParam.Num32BitValues == 0);
+	// The shader declaration stays valid: same register, space and visibility
+	GEP_CHECK(convertedParam.ShaderRegister == 1 && convertedParam.RegisterSpace == 1 && convertedParam.shaderVisibility == SHADER_VISIBILITY::SV_VERTEX);
+	GEP_CHECK(binderDesc.Params[0].ResourceType == RESOURCE_BINDER_PARAM::RESOURCE_TYPE::CONSTANTS && binderDesc.Params[3].ResourceType == RESOURCE_BINDER_PARAM::RESOURCE_TYPE::CONSTANTS);
+}
+
+GEP_TEST(ResourceBinderLayout, ReportsLayoutsThatCannotFit)
+{
+	// Tables and constants too small to gain anything from becoming root descriptors cannot be converted
+	RESOURCE_BINDER_DESC binderDesc;
+	for (uint32_t tableIdx = 0; tableIdx < 60; tableIdx++)
+		binderDesc.Params.push_back(MakeTable(tableIdx, UPDATE_FREQUENCY::STATIC));
+	for (uint32_t constantsIdx = 0; constantsIdx < 3; constantsIdx++)
+		binderDesc.Params.push_back(MakeConstants(2, constantsIdx));
+
+	RESOURCE_BINDER_LAYOUT binderLayout;
+	GEP_CHECK(!OptimizeResourceBinderLayout(binderDesc, RBL_CONVERT_CONSTANTS_OVER_BUDGET | RBL_SORT_BY_UPDATE_FREQUENCY, binderLayout));
+	GEP_CHECK(binderLayout.ConstantsToConvert.empty() && !binderLayout.AreConstantsConverted);
+	GEP_CHECK(binderLayout.DwordsNum == 66);
+	// The remap is still valid, callers can report the failing layout
+	GEP_CHECK(binderLayout.RootIndexRemap.size() == 63 && binderLayout.RootIndexRemap[60] == 0);
+}
@@ -0,0 +1,97 @@
+/*
+ ResourceStateTrackerTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include <new>
+#include <type_traits>
+#include "TestFramework.h"
+#include "TestGraphicsTypes.h"
+#include "ResourceStateTracker.h"
+
+using namespace GEPUtils::Graphics;
+
+GEP_TEST(ResourceStateTracker, ResolvesFirstUseAtSubmission)
+{
+	ResourceStateRegistry registry;
+	GEPTests::TestResource texture;
+	registry.RegisterResource(texture, RESOURCE_STATE::COPY_DEST);
+
+	ResourceStateTracker tracker(registry);
+	tracker.TransitionResource(texture, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+
+	// The state before is only known once the command list gets submitted
+	GEP_CHECK(!tracker.HasBarriersToFlush());
+	GEP_CHECK(tracker.GetPendingTransitionsNum() == 1);
+
+	std::vector<RESOURCE_TRANSITION> pendingBarriers;
+	tracker.ResolvePendingTransitions(pendingBarriers);
+
+	GEP_CHECK(pendingBarriers.size() == 1);
+	GEP_CHECK(pendingBarriers[0].m_StateBefore == RESOURCE_STATE::COPY_DEST && pendingBarriers[0].m_StateAfter == RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+	GEP_CHECK(registry.GetState(texture, ALL_SUBRESOURCES) == RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+}
+
+GEP_TEST(ResourceStateTracker, MergesConsecutiveTransitions)
+{
+	ResourceStateRegistry registry;
+	GEPTests::TestResource texture;
+	registry.RegisterResource(texture, RESOURCE_STATE::COPY_DEST);
+
+	ResourceStateTracker tracker(registry);
+	tracker.AcquireResourceState(texture);
+
+	// COPY_DEST -> RENDER_TARGET -> PIXEL_SHADER_RESOURCE becomes a single barrier
+	tracker.TransitionResource(texture, RESOURCE_STATE::RENDER_TARGET);
+	tracker.TransitionResource(texture, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+	GEP_CHECK(tracker.GetBarriersToFlush().size() == 1);
+	GEP_CHECK(tracker.GetBarriersToFlush()[0].m_StateBefore == RESOURCE_STATE::COPY_DEST);
+	GEP_CHECK(tracker.GetBarriersToFlush()[0].m_StateAfter == RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+
+	// Going back to the flushed state removes the barrier
+	tracker.TransitionResource(texture, RESOURCE_STATE::COPY_DEST);
+	GEP_CHECK(!tracker.HasBarriersToFlush());
+
+	RESOURCE_STATE trackedState;
+	GEP_CHECK(tracker.GetTrackedState(texture, ALL_SUBRESOURCES, trackedState) && trackedState == RESOURCE_STATE::COPY_DEST);
+}
+
+GEP_TEST(ResourceStateTracker, SplitsWholeResourceTransitionsPerSubresource)
+{
+	ResourceStateRegistry registry;
+	GEPTests::TestResource texture(2);
+	registry.RegisterResource(texture, RESOURCE_STATE::RENDER_TARGET);
+
+	ResourceStateTracker tracker(registry);
+	tracker.AcquireResourceState(texture);
+
+	tracker.TransitionResource(texture, RESOURCE_STATE::UNORDERED_ACCESS, 1);
+	tracker.OnBarriersFlushed();
+
+	RESOURCE_STATE trackedState;
+	GEP_CHECK(!tracker.GetTrackedState(texture, ALL_SUBRESOURCES, trackedState));
+
+	tracker.TransitionResource(texture, RESOURCE_STATE::PIXEL_SHADER_RESOURCE);
+	const std::vector<RESOURCE_TRANSITION>& barriers = tracker.GetBarriersToFlush();
+	GEP_CHECK(barriers.size() == 2);
+	GEP_CHECK(barriers[0].m_Subresource == 0 && barriers[0].m_StateBefore == RESOURCE_STATE::RENDER_TARGET);
+	GEP_CHECK(barriers[1].m_Subresource == 1 && barriers[1].m_StateBefore == RESOURCE_STATE::UNORDERED_ACCESS);
+}
+
+GEP_TEST(ResourceStateTracker, DestroyedResourcesLeaveTheRegistry)
+{
+	// A new resource created at the address of a destroyed one must not inherit its state
+	std::aligned_storage<sizeof(GEPTests::TestResource), alignof(GEPTests::TestResource)>::type resourceStorage;
+
+	GEPTests::TestResource* firstResource = new (&resourceStorage) GEPTests::TestResource();
+	ResourceStateRegistry::Get().RegisterResource(*firstResource, RESOURCE_STATE::RENDER_TARGET);
+	GEP_CHECK(ResourceStateRegistry::Get().IsRegistered(*firstResource));
+	firstResource->~TestResource();
+
+	GEPTests::TestResource* secondResource = new (&resourceStorage) GEPTests::TestResource();
+	GEP_CHECK(!ResourceStateRegistry::Get().IsRegistered(*secondResource));
+	secondResource->~TestResource();
+}
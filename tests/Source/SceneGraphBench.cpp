@@ -0,0 +1,139 @@
+/*
+ SceneGraphBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsSceneGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	using BenchClock = std::chrono::steady_clock;
+
+	// Above it the benchmark fails, same bound as in the SceneGraph test suite
+	constexpr float g_MaxWalkError = 1e-5f;
+
+	// Best time of a few runs, to filter out the noise of the other processes
+	template<typename BenchFnType>
+	double MeasureBestMs(const BenchFnType& InBenchFn)
+	{
+		constexpr uint32_t runsNum = 10;
+
+		double bestMs = 1e9;
+		for (uint32_t runIdx = 0; runIdx < runsNum; runIdx++)
+		{
+			const BenchClock::time_point startTime = BenchClock::now();
+			InBenchFn();
+			bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(BenchClock::now() - startTime).count());
+		}
+		return bestMs;
+	}
+
+	// What the sweep replaces: every node multiplies the local transforms of all its ancestors
+	Eigen::Matrix4f ComputeWorldMatrixByWalk(const SceneGraph& InSceneGraph, uint32_t InNodeIdx)
+	{
+		Eigen::Matrix4f outWorldMatrix = Eigen::Matrix4f::Identity();
+		for (uint32_t nodeIdx = InNodeIdx; nodeIdx != g_SceneGraphNoParent; nodeIdx = InSceneGraph.GetParent(nodeIdx))
+			outWorldMatrix = (Eigen::Translation3f(InSceneGraph.GetLocalPosition(nodeIdx)) * InSceneGraph.GetLocalRotation(nodeIdx) * Eigen::Scaling(InSceneGraph.GetLocalScale(nodeIdx))).matrix() * outWorldMatrix;
+		return outWorldMatrix;
+	}
+
+	// A random parent among the previous nodes when InIsChain is false, otherwise the previous node
+	SceneGraph MakeSceneGraph(uint32_t InNodesNum, bool InIsChain)
+	{
+		std::mt19937 randomGenerator(InNodesNum);
+		std::uniform_real_distribution<float> positionDistribution(-10.f, 10.f);
+		std::uniform_real_distribution<float> componentDistribution(-1.f, 1.f);
+		std::uniform_real_distribution<float> scaleDistribution(0.5f, 2.f);
+
+		SceneGraph outSceneGraph(InNodesNum);
+		for (uint32_t nodeIdx = 0; nodeIdx < InNodesNum; nodeIdx++)
+		{
+			const uint32_t parentIdx = nodeIdx == 0 ? g_SceneGraphNoParent : (InIsChain ? nodeIdx - 1 : std::uniform_int_distribution<uint32_t>(0, nodeIdx - 1)(randomGenerator));
+			// Chains would overflow with random scales, they only get rotations and small offsets
+			const Eigen::Vector3f position = InIsChain ? Eigen::Vector3f(0.01f, 0.f, 0.f) : Eigen::Vector3f(positionDistribution(randomGenerator), positionDistribution(randomGenerator), positionDistribution(randomGenerator));
+			const Eigen::Quaternionf rotation = Eigen::Quaternionf(componentDistribution(randomGenerator), componentDistribution(randomGenerator), componentDistribution(randomGenerator), componentDistribution(randomGenerator)).normalized();
+			const Eigen::Vector3f scale = InIsChain ? Eigen::Vector3f::Ones() : Eigen::Vector3f(scaleDistribution(randomGenerator), scaleDistribution(randomGenerator), scaleDistribution(randomGenerator));
+			outSceneGraph.AddNode(parentIdx, position, rotation, scale);
+		}
+		return outSceneGraph;
+	}
+
+}
+
+// Measures the world matrices sweep on random trees (shallow, as most scenes) and on a single chain (the deepest possible hierarchy):
+// the first full update, a frame with 1000 local edits, a frame with no edits and, as a reference, the per-node walk up to the root.
+// The error is relative to the largest element of each matrix, between the sweep and the walk.
+int main()
+{
+	struct BENCH_SCENE { uint32_t NodesNum; bool IsChain; };
+	constexpr BENCH_SCENE benchScenes[] = { { 10000, false }, { 100000, false }, { 2000, true } };
+	constexpr uint32_t editsNum = 1000;
+
+	std::printf("best of 10 runs\n");
+	std::printf("%8s %8s %10s %10s %10s %10s %10s %12s\n", "nodes", "shape", "full ms", "edits ms", "updated", "no edit ms", "walk ms", "max error");
+
+	bool isErrorInBounds = true;
+	for (const BENCH_SCENE& currentScene : benchScenes)
+	{
+		SceneGraph sceneGraph = MakeSceneGraph(currentScene.NodesNum, currentScene.IsChain);
+
+		// The root edit makes every node dirty again
+		const double fullMs = MeasureBestMs([&]() {
+			sceneGraph.SetLocalPosition(0, sceneGraph.GetLocalPosition(0));
+			sceneGraph.UpdateWorldMatrices();
+		});
+
+		std::mt19937 randomGenerator(currentScene.NodesNum);
+		std::uniform_int_distribution<uint32_t> nodeDistribution(0, currentScene.NodesNum - 1);
+		std::vector<uint32_t> editedNodes(editsNum);
+		for (uint32_t& currentNodeIdx : editedNodes)
+			currentNodeIdx = nodeDistribution(randomGenerator);
+
+		const double editsMs = MeasureBestMs([&]() {
+			for (uint32_t editedNodeIdx : editedNodes)
+				sceneGraph.SetLocalPosition(editedNodeIdx, sceneGraph.GetLocalPosition(editedNodeIdx));
+			sceneGraph.UpdateWorldMatrices();
+		});
+		const size_t updatedNodesNum = sceneGraph.GetUpdatedNodes().size();
+
+		const double noEditMs = MeasureBestMs([&]() { sceneGraph.UpdateWorldMatrices(); });
+		if (!sceneGraph.GetUpdatedNodes().empty())
+		{
+			std::printf("A frame with no edits updated %zu nodes\n", sceneGraph.GetUpdatedNodes().size());
+			return 1;
+		}
+
+		std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> walkMatrices(currentScene.NodesNum);
+		const double walkMs = MeasureBestMs([&]() {
+			for (uint32_t nodeIdx = 0; nodeIdx < currentScene.NodesNum; nodeIdx++)
+				walkMatrices[nodeIdx] = ComputeWorldMatrixByWalk(sceneGraph, nodeIdx);
+		});
+
+		float maxError = 0.f;
+		for (uint32_t nodeIdx = 0; nodeIdx < currentScene.NodesNum; nodeIdx++)
+		{
+			const float matrixMagnitude = std::max(1.f, walkMatrices[nodeIdx].cwiseAbs().maxCoeff());
+			maxError = std::max(maxError, (walkMatrices[nodeIdx] - sceneGraph.GetWorldMatrix(nodeIdx)).cwiseAbs().maxCoeff() / matrixMagnitude);
+		}
+		isErrorInBounds &= maxError < g_MaxWalkError;
+
+		std::printf("%8u %8s %10.3f %10.3f %10zu %10.4f %10.3f %12.2e\n", currentScene.NodesNum, currentScene.IsChain ? "chain" : "tree", fullMs, editsMs, updatedNodesNum, noEditMs, walkMs, maxError);
+	}
+
+	if (!isErrorInBounds)
+	{
+		std::printf("World matrices differ from the per-node walk by more than %.0e\n", g_MaxWalkError);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,206 @@
+/*
+ SceneGraphTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "GEPUtilsSceneGraph.h"
+#include <algorithm>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	// The sweep and the walk round their products in a different order, the difference grows with the depth of the node:
+	// random trees of 10k to 100k nodes stay around 3e-6, a chain of 2000 nodes around 5e-6
+	constexpr float g_MaxWalkError = 1e-5f;
+
+	// World matrix of a node multiplying the local transforms of all its ancestors, without any caching
+	Eigen::Matrix4f ComputeWorldMatrixByWalk(const SceneGraph& InSceneGraph, uint32_t InNodeIdx)
+	{
+		Eigen::Matrix4f outWorldMatrix = Eigen::Matrix4f::Identity();
+		for (uint32_t nodeIdx = InNodeIdx; nodeIdx != g_SceneGraphNoParent; nodeIdx = InSceneGraph.GetParent(nodeIdx))
+			outWorldMatrix = (Eigen::Translation3f(InSceneGraph.GetLocalPosition(nodeIdx)) * InSceneGraph.GetLocalRotation(nodeIdx) * Eigen::Scaling(InSceneGraph.GetLocalScale(nodeIdx))).matrix() * outWorldMatrix;
+		return outWorldMatrix;
+	}
+
+	// Relative to the largest element of each matrix, since products along the chain round in a different order
+	// and elements close to zero (e.g. cosines of right angles) cannot keep a relative precision of their own
+	float ComputeMaxWalkError(const SceneGraph& InSceneGraph)
+	{
+		float maxError = 0.f;
+		for (uint32_t nodeIdx = 0; nodeIdx < InSceneGraph.GetNodesNum(); nodeIdx++)
+		{
+			const Eigen::Matrix4f walkMatrix = ComputeWorldMatrixByWalk(InSceneGraph, nodeIdx);
+			const float matrixMagnitude = std::max(1.f, walkMatrix.cwiseAbs().maxCoeff());
+			maxError = std::max(maxError, (walkMatrix - InSceneGraph.GetWorldMatrix(nodeIdx)).cwiseAbs().maxCoeff() / matrixMagnitude);
+		}
+		return maxError;
+	}
+
+	// Every node is parented to a random previous one, as the scenes in the benchmark
+	void AddRandomNodes(SceneGraph& InSceneGraph, uint32_t InNodesNum, std::mt19937& InRandomGenerator)
+	{
+		std::uniform_real_distribution<float> positionDistribution(-10.f, 10.f);
+		std::uniform_real_distribution<float> componentDistribution(-1.f, 1.f);
+		std::uniform_real_distribution<float> scaleDistribution(0.5f, 2.f);
+
+		for (uint32_t nodeIdx = 0; nodeIdx < InNodesNum; nodeIdx++)
+		{
+			const uint32_t parentIdx = nodeIdx == 0 ? g_SceneGraphNoParent : std::uniform_int_distribution<uint32_t>(0, nodeIdx - 1)(InRandomGenerator);
+			const Eigen::Vector3f position(positionDistribution(InRandomGenerator), positionDistribution(InRandomGenerator), positionDistribution(InRandomGenerator));
+			const Eigen::Quaternionf rotation = Eigen::Quaternionf(componentDistribution(InRandomGenerator), componentDistribution(InRandomGenerator), componentDistribution(InRandomGenerator), componentDistribution(InRandomGenerator)).normalized();
+			const Eigen::Vector3f scale(scaleDistribution(InRandomGenerator), scaleDistribution(InRandomGenerator), scaleDistribution(InRandomGenerator));
+			InSceneGraph.AddNode(parentIdx, position, rotation, scale);
+		}
+	}
+
+	bool IsNodeOrAncestorEdited(const SceneGraph& InSceneGraph, uint32_t InNodeIdx, const std::vector<uint8_t>& InIsEdited)
+	{
+		for (uint32_t nodeIdx = InNodeIdx; nodeIdx != g_SceneGraphNoParent; nodeIdx = InSceneGraph.GetParent(nodeIdx))
+		{
+			if (InIsEdited[nodeIdx])
+				return true;
+		}
+		return false;
+	}
+
+}
+
+GEP_TEST(SceneGraph, DeepChainFollowsItsRoot)
+{
+	constexpr uint32_t chainLength = 1000;
+
+	// Each node one unit further than its parent, so world positions are exact
+	SceneGraph sceneGraph(chainLength);
+	for (uint32_t nodeIdx = 0; nodeIdx < chainLength; nodeIdx++)
+		sceneGraph.AddNode(nodeIdx == 0 ? g_SceneGraphNoParent : nodeIdx - 1, Eigen::Vector3f::UnitX(), Eigen::Quaternionf::Identity(), Eigen::Vector3f::Ones());
+
+	sceneGraph.UpdateWorldMatrices();
+	GEP_CHECK(sceneGraph.GetUpdatedNodes().size() == chainLength);
+	GEP_CHECK(sceneGraph.GetWorldMatrix(chainLength - 1)(0, 3) == static_cast<float>(chainLength));
+
+	// Moving the root moves the whole chain
+	sceneGraph.SetLocalPosition(0, Eigen::Vector3f(1.f, 5.f, 0.f));
+	sceneGraph.UpdateWorldMatrices();
+	GEP_CHECK(sceneGraph.GetUpdatedNodes().size() == chainLength);
+	GEP_CHECK(sceneGraph.GetWorldMatrix(chainLength - 1)(0, 3) == static_cast<float>(chainLength) && sceneGraph.GetWorldMatrix(chainLength - 1)(1, 3) == 5.f);
+
+	// A rotation of the root turns the chain along Y
+	sceneGraph.SetLocalPosition(0, Eigen::Vector3f::UnitX());
+	sceneGraph.SetLocalRotation(0, Eigen::Quaternionf(Eigen::AngleAxisf(static_cast<float>(EIGEN_PI) / 2.f, Eigen::Vector3f::UnitZ())));
+	sceneGraph.UpdateWorldMatrices();
+	const Eigen::Matrix4f& lastWorldMatrix = sceneGraph.GetWorldMatrix(chainLength - 1);
+	GEP_CHECK(std::abs(lastWorldMatrix(0, 3) - 1.f) < 1e-3f && std::abs(lastWorldMatrix(1, 3) - static_cast<float>(chainLength - 1)) < 1e-3f);
+	GEP_CHECK(ComputeMaxWalkError(sceneGraph) < g_MaxWalkError);
+}
+
+GEP_TEST(SceneGraph, MidTreeEditOnlyUpdatesItsSubtree)
+{
+	constexpr uint32_t chainLength = 100;
+	constexpr uint32_t editedNodeIdx = 40;
+
+	// A chain with a second root added last, which is not part of the edited subtree
+	SceneGraph sceneGraph;
+	for (uint32_t nodeIdx = 0; nodeIdx < chainLength; nodeIdx++)
+		sceneGraph.AddNode(nodeIdx == 0 ? g_SceneGraphNoParent : nodeIdx - 1, Eigen::Vector3f::UnitX(), Eigen::Quaternionf::Identity(), Eigen::Vector3f::Ones());
+	const uint32_t otherRootIdx = sceneGraph.AddNode(g_SceneGraphNoParent, Eigen::Vector3f::UnitY(), Eigen::Quaternionf::Identity(), Eigen::Vector3f::Ones());
+	sceneGraph.UpdateWorldMatrices();
+
+	const Eigen::Matrix4f parentWorldMatrix = sceneGraph.GetWorldMatrix(editedNodeIdx - 1);
+
+	sceneGraph.SetLocalPosition(editedNodeIdx, Eigen::Vector3f(2.f, 0.f, 0.f));
+	sceneGraph.UpdateWorldMatrices();
+
+	const std::vector<uint32_t>& updatedNodes = sceneGraph.GetUpdatedNodes();
+	GEP_CHECK(updatedNodes.size() == chainLength - editedNodeIdx);
+	GEP_CHECK(updatedNodes.front() == editedNodeIdx && updatedNodes.back() == chainLength - 1);
+	GEP_CHECK(std::find(updatedNodes.begin(), updatedNodes.end(), otherRootIdx) == updatedNodes.end());
+
+	GEP_CHECK(sceneGraph.GetWorldMatrix(editedNodeIdx - 1) == parentWorldMatrix);
+	GEP_CHECK(sceneGraph.GetWorldMatrix(editedNodeIdx)(0, 3) == static_cast<float>(editedNodeIdx + 2));
+	GEP_CHECK(sceneGraph.GetWorldMatrix(chainLength - 1)(0, 3) == static_cast<float>(chainLength + 1));
+	GEP_CHECK(sceneGraph.GetWorldMatrix(otherRootIdx)(1, 3) == 1.f);
+}
+
+GEP_TEST(SceneGraph, UpdatedNodesAreEditedSubtreesInAscendingOrder)
+{
+	constexpr uint32_t nodesNum = 2000;
+
+	std::mt19937 randomGenerator(nodesNum);
+	SceneGraph sceneGraph(nodesNum);
+	AddRandomNodes(sceneGraph, nodesNum, randomGenerator);
+	sceneGraph.UpdateWorldMatrices();
+
+	// Edits in no particular order, some of them inside the subtree of others
+	std::vector<uint8_t> isEdited(nodesNum, 0);
+	const uint32_t editedNodes[] = { 1500, 37, 900, 38, 1999, 37 };
+	for (uint32_t editedNodeIdx : editedNodes)
+	{
+		sceneGraph.SetLocalScale(editedNodeIdx, Eigen::Vector3f(1.5f, 1.5f, 1.5f));
+		isEdited[editedNodeIdx] = 1;
+	}
+	sceneGraph.UpdateWorldMatrices();
+
+	std::vector<uint32_t> expectedNodes;
+	for (uint32_t nodeIdx = 0; nodeIdx < nodesNum; nodeIdx++)
+	{
+		if (IsNodeOrAncestorEdited(sceneGraph, nodeIdx, isEdited))
+			expectedNodes.push_back(nodeIdx);
+	}
+	GEP_CHECK(sceneGraph.GetUpdatedNodes() == expectedNodes);
+	GEP_CHECK(std::is_sorted(sceneGraph.GetUpdatedNodes().begin(), sceneGraph.GetUpdatedNodes().end()));
+
+	// Adding a node only updates the new one
+	const uint32_t newNodeIdx = sceneGraph.AddNode(900, Eigen::Vector3f::UnitZ(), Eigen::Quaternionf::Identity(), Eigen::Vector3f::Ones());
+	sceneGraph.UpdateWorldMatrices();
+	GEP_CHECK(sceneGraph.GetUpdatedNodes() == std::vector<uint32_t>(1, newNodeIdx));
+}
+
+GEP_TEST(SceneGraph, FrameWithoutEditsUpdatesNothing)
+{
+	std::mt19937 randomGenerator(500);
+	SceneGraph sceneGraph;
+	AddRandomNodes(sceneGraph, 500, randomGenerator);
+	sceneGraph.UpdateWorldMatrices();
+
+	std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>> previousWorldMatrices;
+	for (uint32_t nodeIdx = 0; nodeIdx < sceneGraph.GetNodesNum(); nodeIdx++)
+		previousWorldMatrices.push_back(sceneGraph.GetWorldMatrix(nodeIdx));
+
+	sceneGraph.UpdateWorldMatrices();
+	GEP_CHECK(sceneGraph.GetUpdatedNodes().empty());
+
+	bool areMatricesUnchanged = true;
+	for (uint32_t nodeIdx = 0; nodeIdx < sceneGraph.GetNodesNum(); nodeIdx++)
+		areMatricesUnchanged &= sceneGraph.GetWorldMatrix(nodeIdx) == previousWorldMatrices[nodeIdx];
+	GEP_CHECK(areMatricesUnchanged);
+
+	// Setting the same value still counts as an edit
+	sceneGraph.SetLocalPosition(250, sceneGraph.GetLocalPosition(250));
+	sceneGraph.UpdateWorldMatrices();
+	GEP_CHECK(!sceneGraph.GetUpdatedNodes().empty() && sceneGraph.GetUpdatedNodes().front() == 250);
+}
+
+GEP_TEST(SceneGraph, WorldMatricesMatchPerNodeWalk)
+{
+	constexpr uint32_t nodesNum = 10000;
+
+	std::mt19937 randomGenerator(nodesNum);
+	SceneGraph sceneGraph(nodesNum);
+	AddRandomNodes(sceneGraph, nodesNum, randomGenerator);
+	sceneGraph.UpdateWorldMatrices();
+	GEP_CHECK(ComputeMaxWalkError(sceneGraph) < g_MaxWalkError);
+
+	// Also after partial updates, where most of the matrices come from the previous sweep
+	std::uniform_int_distribution<uint32_t> nodeDistribution(0, nodesNum - 1);
+	std::uniform_real_distribution<float> positionDistribution(-10.f, 10.f);
+	for (uint32_t editIdx = 0; editIdx < 100; editIdx++)
+		sceneGraph.SetLocalPosition(nodeDistribution(randomGenerator), Eigen::Vector3f(positionDistribution(randomGenerator), positionDistribution(randomGenerator), positionDistribution(randomGenerator)));
+	sceneGraph.UpdateWorldMatrices();
+	GEP_CHECK(ComputeMaxWalkError(sceneGraph) < g_MaxWalkError);
+}
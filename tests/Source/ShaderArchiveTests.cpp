@@ -0,0 +1,240 @@
+/*
+ ShaderArchiveTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "ShaderArchive.h"
+#include "GEPUtilsHash.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	const char* g_ArchiveFilePath = "ShaderArchiveTests.gesa";
+
+	std::vector<uint8_t> MakeBytecode(uint32_t InSize, uint8_t InSeed)
+	{
+		std::vector<uint8_t> outBytecode(InSize);
+		for (uint32_t byteIdx = 0; byteIdx < InSize; byteIdx++)
+			outBytecode[byteIdx] = static_cast<uint8_t>(InSeed + byteIdx * 7);
+		return outBytecode;
+	}
+
+	bool WriteFile(const std::string& InFilePath, const void* InData, size_t InSize)
+	{
+		std::ofstream outFile(InFilePath, std::ios::binary | std::ios::trunc);
+		outFile.write(static_cast<const char*>(InData), InSize);
+		return outFile.good();
+	}
+
+	bool IsShaderEqual(const ShaderArchive& InArchive, const std::string& InName, const std::vector<uint8_t>& InBytecode)
+	{
+		const void* foundBytecode = nullptr;
+		size_t foundSize = 0;
+		uint64_t foundHash = 0;
+		return InArchive.FindShader(InName, foundBytecode, foundSize, foundHash)
+			&& foundSize == InBytecode.size() && std::memcmp(foundBytecode, InBytecode.data(), foundSize) == 0
+			&& foundHash == GEPUtils::Hash::HashBytes(InBytecode.data(), InBytecode.size());
+	}
+
+	const void* FindBytecode(const ShaderArchive& InArchive, const std::string& InName)
+	{
+		const void* foundBytecode = nullptr;
+		size_t foundSize = 0;
+		uint64_t foundHash = 0;
+		return InArchive.FindShader(InName, foundBytecode, foundSize, foundHash) ? foundBytecode : nullptr;
+	}
+
+	// Archive with two shaders sharing the same bytecode
+	void SerializeTestArchive(std::vector<uint8_t>& OutFileData)
+	{
+		ShaderArchiveWriter archiveWriter;
+		archiveWriter.AddShader("Cube_VS.cso", MakeBytecode(300, 1).data(), 300);
+		archiveWriter.AddShader("Cube_PS.cso", MakeBytecode(200, 2).data(), 200);
+		archiveWriter.AddShader("Sky_VS.cso", MakeBytecode(300, 1).data(), 300);
+		archiveWriter.Serialize(OutFileData);
+	}
+
+}
+
+GEP_TEST(ShaderArchive, RoundTripThroughPacker)
+{
+	const std::vector<std::string> shaderNames = { "ShaderArchiveTests_VS.cso", "ShaderArchiveTests_PS.cso", "ShaderArchiveTests_CS.cso" };
+	const std::vector<std::vector<uint8_t>> shaderBytecodes = { MakeBytecode(1000, 3), MakeBytecode(37, 4), MakeBytecode(4096, 5) };
+	for (size_t shaderIdx = 0; shaderIdx < shaderNames.size(); shaderIdx++)
+		GEP_CHECK(WriteFile(shaderNames[shaderIdx], shaderBytecodes[shaderIdx].data(), shaderBytecodes[shaderIdx].size()));
+
+	// The packer is built with the tests, it also reads the archive back before succeeding
+	std::string packerCommand = std::string("\"") + GEP_SHADERPACKER_PATH + "\" " + g_ArchiveFilePath + " .";
+	for (const std::string& currentName : shaderNames)
+		packerCommand += " " + currentName;
+	GEP_CHECK(std::system(packerCommand.c_str()) == 0);
+
+	ShaderArchive testArchive;
+	GEP_CHECK(testArchive.Open(std::string(g_ArchiveFilePath)));
+	GEP_CHECK(testArchive.GetShadersNum() == shaderNames.size());
+	for (size_t shaderIdx = 0; shaderIdx < shaderNames.size(); shaderIdx++)
+		GEP_CHECK(IsShaderEqual(testArchive, shaderNames[shaderIdx], shaderBytecodes[shaderIdx]));
+
+	// Every name in the table can be enumerated
+	for (size_t shaderIdx = 0; shaderIdx < testArchive.GetShadersNum(); shaderIdx++)
+		GEP_CHECK(std::find(shaderNames.begin(), shaderNames.end(), testArchive.GetShaderName(shaderIdx)) != shaderNames.end());
+
+	// Missing inputs fail the packer instead of writing a partial archive
+	GEP_CHECK(std::system((std::string("\"") + GEP_SHADERPACKER_PATH + "\" ShaderArchiveTestsMissing.gesa . ShaderArchiveTestsMissing.cso").c_str()) != 0);
+
+	testArchive.Close();
+	for (const std::string& currentName : shaderNames)
+		std::remove(currentName.c_str());
+	std::remove(g_ArchiveFilePath);
+}
+
+GEP_TEST(ShaderArchive, SharesDuplicatePayloads)
+{
+	std::vector<uint8_t> fileData;
+	SerializeTestArchive(fileData);
+	GEP_CHECK(WriteFile(g_ArchiveFilePath, fileData.data(), fileData.size()));
+
+	ShaderArchive testArchive;
+	GEP_CHECK(testArchive.Open(std::string(g_ArchiveFilePath)));
+	GEP_CHECK(testArchive.GetShadersNum() == 3);
+	GEP_CHECK(IsShaderEqual(testArchive, "Cube_VS.cso", MakeBytecode(300, 1)));
+	GEP_CHECK(IsShaderEqual(testArchive, "Sky_VS.cso", MakeBytecode(300, 1)));
+	GEP_CHECK(IsShaderEqual(testArchive, "Cube_PS.cso", MakeBytecode(200, 2)));
+
+	// Both names point to the same bytes in the file, which only holds two payloads
+	GEP_CHECK(FindBytecode(testArchive, "Cube_VS.cso") == FindBytecode(testArchive, "Sky_VS.cso"));
+	GEP_CHECK(fileData.size() <= sizeof(SHADER_ARCHIVE_HEADER) + 3 * sizeof(SHADER_ARCHIVE_ENTRY) + 64 + 304 + 208);
+
+	// Payloads are aligned in the file, and the output does not depend on the adding order
+	GEP_CHECK(reinterpret_cast<uintptr_t>(FindBytecode(testArchive, "Cube_PS.cso")) % g_ShaderArchivePayloadAlignment == 0);
+	ShaderArchiveWriter reversedWriter;
+	reversedWriter.AddShader("Sky_VS.cso", MakeBytecode(300, 1).data(), 300);
+	reversedWriter.AddShader("Cube_PS.cso", MakeBytecode(200, 2).data(), 200);
+	reversedWriter.AddShader("Cube_VS.cso", MakeBytecode(300, 1).data(), 300);
+	std::vector<uint8_t> reversedFileData;
+	reversedWriter.Serialize(reversedFileData);
+	GEP_CHECK(reversedFileData == fileData);
+
+	testArchive.Close();
+	std::remove(g_ArchiveFilePath);
+}
+
+GEP_TEST(ShaderArchive, RejectsCorruptedTable)
+{
+	std::vector<uint8_t> fileData;
+	SerializeTestArchive(fileData);
+
+	// Any byte of the table or of the names changing does not match the stored hash anymore
+	const size_t corruptedOffsets[] = { sizeof(SHADER_ARCHIVE_HEADER), sizeof(SHADER_ARCHIVE_HEADER) + sizeof(SHADER_ARCHIVE_ENTRY) + 9, sizeof(SHADER_ARCHIVE_HEADER) + 3 * sizeof(SHADER_ARCHIVE_ENTRY) + 2 };
+	for (size_t corruptedOffset : corruptedOffsets)
+	{
+		std::vector<uint8_t> corruptedData = fileData;
+		corruptedData[corruptedOffset] ^= 0x10;
+		GEP_CHECK(WriteFile(g_ArchiveFilePath, corruptedData.data(), corruptedData.size()));
+
+		ShaderArchive testArchive;
+		GEP_CHECK(!testArchive.Open(std::string(g_ArchiveFilePath)));
+		GEP_CHECK(!testArchive.IsOpen() && testArchive.GetShadersNum() == 0);
+	}
+
+	// Same for the stored hash itself
+	std::vector<uint8_t> corruptedData = fileData;
+	corruptedData[offsetof(SHADER_ARCHIVE_HEADER, TableHash)] ^= 0x01;
+	GEP_CHECK(WriteFile(g_ArchiveFilePath, corruptedData.data(), corruptedData.size()));
+	ShaderArchive testArchive;
+	GEP_CHECK(!testArchive.Open(std::string(g_ArchiveFilePath)));
+
+	// And for an archive of a different version
+	corruptedData = fileData;
+	corruptedData[offsetof(SHADER_ARCHIVE_HEADER, Version)] += 1;
+	GEP_CHECK(WriteFile(g_ArchiveFilePath, corruptedData.data(), corruptedData.size()));
+	GEP_CHECK(!testArchive.Open(std::string(g_ArchiveFilePath)));
+
+	std::remove(g_ArchiveFilePath);
+}
+
+GEP_TEST(ShaderArchive, RejectsTruncatedFile)
+{
+	std::vector<uint8_t> fileData;
+	SerializeTestArchive(fileData);
+
+	// End of the last payload in the file, bytes after it are only padding
+	SHADER_ARCHIVE_HEADER fileHeader;
+	std::memcpy(&fileHeader, fileData.data(), sizeof(SHADER_ARCHIVE_HEADER));
+	size_t payloadsEnd = 0;
+	for (uint32_t entryIdx = 0; entryIdx < fileHeader.EntriesNum; entryIdx++)
+	{
+		SHADER_ARCHIVE_ENTRY currentEntry;
+		std::memcpy(&currentEntry, fileData.data() + sizeof(SHADER_ARCHIVE_HEADER) + entryIdx * sizeof(SHADER_ARCHIVE_ENTRY), sizeof(SHADER_ARCHIVE_ENTRY));
+		payloadsEnd = std::max(payloadsEnd, static_cast<size_t>(currentEntry.BytecodeOffset + currentEntry.BytecodeSize));
+	}
+
+	// Cut inside the header, the table, the names and the last payload
+	const size_t truncatedSizes[] = { sizeof(SHADER_ARCHIVE_HEADER) - 1, sizeof(SHADER_ARCHIVE_HEADER) + sizeof(SHADER_ARCHIVE_ENTRY), sizeof(SHADER_ARCHIVE_HEADER) + 3 * sizeof(SHADER_ARCHIVE_ENTRY) + 4, payloadsEnd - 1 };
+	for (size_t truncatedSize : truncatedSizes)
+	{
+		GEP_CHECK(WriteFile(g_ArchiveFilePath, fileData.data(), truncatedSize));
+
+		ShaderArchive testArchive;
+		GEP_CHECK(!testArchive.Open(std::string(g_ArchiveFilePath)));
+		GEP_CHECK(!testArchive.IsOpen());
+	}
+
+	// Cutting the padding only is fine
+	GEP_CHECK(WriteFile(g_ArchiveFilePath, fileData.data(), payloadsEnd));
+	ShaderArchive testArchive;
+	GEP_CHECK(testArchive.Open(std::string(g_ArchiveFilePath)));
+
+	testArchive.Close();
+	std::remove(g_ArchiveFilePath);
+}
+
+GEP_TEST(ShaderArchive, LookupMisses)
+{
+	std::vector<uint8_t> fileData;
+	SerializeTestArchive(fileData);
+	GEP_CHECK(WriteFile(g_ArchiveFilePath, fileData.data(), fileData.size()));
+
+	ShaderArchive testArchive;
+	const void* foundBytecode = nullptr;
+	size_t foundSize = 0;
+	uint64_t foundHash = 0;
+	GEP_CHECK(!testArchive.FindShader("Cube_VS.cso", foundBytecode, foundSize, foundHash));
+
+	GEP_CHECK(testArchive.Open(std::string(g_ArchiveFilePath)));
+	// Names are matched exactly: no prefixes, no different case, no different separators
+	GEP_CHECK(!testArchive.FindShader("Missing_VS.cso", foundBytecode, foundSize, foundHash));
+	GEP_CHECK(!testArchive.FindShader("Cube_VS", foundBytecode, foundSize, foundHash));
+	GEP_CHECK(!testArchive.FindShader("cube_vs.cso", foundBytecode, foundSize, foundHash));
+	GEP_CHECK(!testArchive.FindShader("", foundBytecode, foundSize, foundHash));
+	GEP_CHECK(FindBytecode(testArchive, "Cube_VS.cso") != nullptr);
+
+	// A missing file cannot be opened, and leaves the archive closed
+	GEP_CHECK(!testArchive.Open(std::string("ShaderArchiveTestsMissing.gesa")));
+	GEP_CHECK(!testArchive.FindShader("Cube_VS.cso", foundBytecode, foundSize, foundHash));
+
+	// An archive without shaders is valid, and it finds nothing
+	ShaderArchiveWriter emptyWriter;
+	GEP_CHECK(emptyWriter.Save(g_ArchiveFilePath));
+	GEP_CHECK(testArchive.Open(std::string(g_ArchiveFilePath)));
+	GEP_CHECK(testArchive.GetShadersNum() == 0);
+	GEP_CHECK(!testArchive.FindShader("Cube_VS.cso", foundBytecode, foundSize, foundHash));
+
+	// Names can only be added once
+	GEP_CHECK(emptyWriter.AddShader("Cube_VS.cso", "A", 1));
+	GEP_CHECK(!emptyWriter.AddShader("Cube_VS.cso", "B", 1));
+
+	testArchive.Close();
+	std::remove(g_ArchiveFilePath);
+}
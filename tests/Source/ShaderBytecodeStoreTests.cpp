@@ -0,0 +1,171 @@
+/*
+ ShaderBytecodeStoreTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "ShaderBytecodeStore.h"
+#include "GEPUtilsHash.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	const char* g_FirstFilePath = "ShaderBytecodeStoreTests_A.cso";
+	const char* g_SameContentFilePath = "ShaderBytecodeStoreTests_B.cso";
+	const char* g_OtherContentFilePath = "ShaderBytecodeStoreTests_C.cso";
+	const char* g_ArchiveFilePath = "ShaderBytecodeStoreTests.gesa";
+
+	std::vector<uint8_t> MakeBytecode(uint32_t InSize, uint8_t InSeed)
+	{
+		std::vector<uint8_t> outBytecode(InSize);
+		for (uint32_t byteIdx = 0; byteIdx < InSize; byteIdx++)
+			outBytecode[byteIdx] = static_cast<uint8_t>(InSeed + byteIdx * 13);
+		return outBytecode;
+	}
+
+	void WriteFile(const char* InFilePath, const std::vector<uint8_t>& InData)
+	{
+		std::ofstream outFile(InFilePath, std::ios::binary | std::ios::trunc);
+		outFile.write(reinterpret_cast<const char*>(InData.data()), InData.size());
+	}
+
+	std::wstring ToWidePath(const char* InFilePath)
+	{
+		const std::string narrowPath(InFilePath);
+		return std::wstring(narrowPath.begin(), narrowPath.end());
+	}
+
+	bool IsViewEqual(const ShaderBytecodeView& InView, const std::vector<uint8_t>& InBytecode)
+	{
+		return InView.m_Data && InView.m_Size == InBytecode.size() && std::memcmp(InView.m_Data, InBytecode.data(), InBytecode.size()) == 0;
+	}
+
+	void RemoveTestFiles()
+	{
+		std::remove(g_FirstFilePath);
+		std::remove(g_SameContentFilePath);
+		std::remove(g_OtherContentFilePath);
+		std::remove(g_ArchiveFilePath);
+	}
+
+}
+
+GEP_TEST(ShaderBytecodeStore, DeduplicatesSameContent)
+{
+	const std::vector<uint8_t> firstBytecode = MakeBytecode(512, 1), otherBytecode = MakeBytecode(512, 2);
+	WriteFile(g_FirstFilePath, firstBytecode);
+	WriteFile(g_SameContentFilePath, firstBytecode);
+	WriteFile(g_OtherContentFilePath, otherBytecode);
+
+	ShaderBytecodeStore testStore;
+	const uint32_t firstId = testStore.LoadBytecode(ToWidePath(g_FirstFilePath));
+	GEP_CHECK(firstId != ShaderBytecodeStore::INVALID_BYTECODE_ID);
+	// Same path and same content from a different path map to the same bytecode, different content does not
+	GEP_CHECK(testStore.LoadBytecode(ToWidePath(g_FirstFilePath)) == firstId);
+	GEP_CHECK(testStore.LoadBytecode(ToWidePath(g_SameContentFilePath)) == firstId);
+	const uint32_t otherId = testStore.LoadBytecode(ToWidePath(g_OtherContentFilePath));
+	GEP_CHECK(otherId != firstId && otherId != ShaderBytecodeStore::INVALID_BYTECODE_ID);
+
+	GEP_CHECK(testStore.GetBytecodesNum() == 2);
+	GEP_CHECK(testStore.GetBytecodeHash(firstId) == GEPUtils::Hash::HashBytes(firstBytecode.data(), firstBytecode.size()));
+
+	// Loading does not keep anything mapped
+	GEP_CHECK(testStore.GetResidentBytecodesNum() == 0);
+
+	GEP_CHECK(testStore.LoadBytecode(L"ShaderBytecodeStoreTests_Missing.cso") == ShaderBytecodeStore::INVALID_BYTECODE_ID);
+	GEP_CHECK(testStore.GetBytecodesNum() == 2);
+
+	RemoveTestFiles();
+}
+
+GEP_TEST(ShaderBytecodeStore, MapsOnlyWhileAcquired)
+{
+	const std::vector<uint8_t> firstBytecode = MakeBytecode(4096, 3);
+	WriteFile(g_FirstFilePath, firstBytecode);
+
+	ShaderBytecodeStore testStore;
+	const uint32_t firstId = testStore.LoadBytecode(ToWidePath(g_FirstFilePath));
+
+	const ShaderBytecodeView firstView = testStore.AcquireBytecode(firstId);
+	GEP_CHECK(IsViewEqual(firstView, firstBytecode));
+	GEP_CHECK(testStore.GetResidentBytecodesNum() == 1);
+
+	// Acquires are counted, the file is unmapped with the last release
+	const ShaderBytecodeView nestedView = testStore.AcquireBytecode(firstId);
+	GEP_CHECK(nestedView.m_Data == firstView.m_Data);
+	testStore.ReleaseBytecode(firstId);
+	GEP_CHECK(testStore.GetResidentBytecodesNum() == 1);
+	testStore.ReleaseBytecode(firstId);
+	GEP_CHECK(testStore.GetResidentBytecodesNum() == 0);
+
+	// Acquiring again maps the unchanged file again
+	for (uint32_t remapIdx = 0; remapIdx < 3; remapIdx++)
+	{
+		GEP_CHECK(IsViewEqual(testStore.AcquireBytecode(firstId), firstBytecode));
+		testStore.ReleaseBytecode(firstId);
+	}
+	GEP_CHECK(testStore.GetResidentBytecodesNum() == 0);
+
+	RemoveTestFiles();
+}
+
+GEP_TEST(ShaderBytecodeStore, RejectsFileChangedSinceLoad)
+{
+	WriteFile(g_FirstFilePath, MakeBytecode(256, 4));
+
+	ShaderBytecodeStore testStore;
+	const uint32_t firstId = testStore.LoadBytecode(ToWidePath(g_FirstFilePath));
+
+	// The hash computed when loading does not describe the file anymore, so the bytecode is not returned
+	WriteFile(g_FirstFilePath, MakeBytecode(300, 5));
+	const ShaderBytecodeView changedView = testStore.AcquireBytecode(firstId);
+	GEP_CHECK(changedView.m_Data == nullptr && changedView.m_Size == 0);
+	GEP_CHECK(testStore.GetResidentBytecodesNum() == 0);
+
+	// Same for a file that was removed
+	std::remove(g_FirstFilePath);
+	GEP_CHECK(testStore.AcquireBytecode(firstId).m_Data == nullptr);
+
+	RemoveTestFiles();
+}
+
+GEP_TEST(ShaderBytecodeStore, ResolvesMountedArchive)
+{
+	const std::vector<uint8_t> archivedBytecode = MakeBytecode(1024, 6), looseBytecode = MakeBytecode(128, 7);
+	ShaderArchiveWriter archiveWriter;
+	archiveWriter.AddShader("Cube/Cube_VS.cso", archivedBytecode.data(), archivedBytecode.size());
+	GEP_CHECK(archiveWriter.Save(g_ArchiveFilePath));
+
+	ShaderBytecodeStore testStore;
+	GEP_CHECK(!testStore.MountArchive(L"ShaderBytecodeStoreTests_Missing.gesa", L"Shaders"));
+	GEP_CHECK(testStore.MountArchive(ToWidePath(g_ArchiveFilePath), L"Shaders"));
+
+	// Packed shaders do not need their file, and both separators resolve to the same name
+	const uint32_t archivedId = testStore.LoadBytecode(L"Shaders\\Cube\\Cube_VS.cso");
+	GEP_CHECK(archivedId != ShaderBytecodeStore::INVALID_BYTECODE_ID);
+	GEP_CHECK(testStore.LoadBytecode(L"Shaders/Cube/Cube_VS.cso") == archivedId);
+	GEP_CHECK(IsViewEqual(testStore.AcquireBytecode(archivedId), archivedBytecode));
+	testStore.ReleaseBytecode(archivedId);
+	// The archive stays mapped
+	GEP_CHECK(testStore.GetResidentBytecodesNum() == 1);
+
+	// A loose file with the same content as a packed shader shares its bytecode, other loose files are loaded from disk
+	WriteFile(g_SameContentFilePath, archivedBytecode);
+	WriteFile(g_OtherContentFilePath, looseBytecode);
+	GEP_CHECK(testStore.LoadBytecode(ToWidePath(g_SameContentFilePath)) == archivedId);
+	const uint32_t looseId = testStore.LoadBytecode(ToWidePath(g_OtherContentFilePath));
+	GEP_CHECK(looseId != archivedId && IsViewEqual(testStore.AcquireBytecode(looseId), looseBytecode));
+	testStore.ReleaseBytecode(looseId);
+
+	// Names not in the archive fall back to the file system
+	GEP_CHECK(testStore.LoadBytecode(L"Shaders/Cube/Missing_PS.cso") == ShaderBytecodeStore::INVALID_BYTECODE_ID);
+
+	RemoveTestFiles();
+}
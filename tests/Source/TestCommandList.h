@@ -0,0 +1,220 @@
+/*
+ TestCommandList.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef TestCommandList_h__
+#define TestCommandList_h__
+
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "CommandList.h"
+#include "Device.h"
+#include "TestGraphicsTypes.h"
+
+namespace GEPTests {
+
+	struct TestDevice : public GEPUtils::Graphics::Device {
+		virtual void ReportLiveObjects() override { }
+		virtual void ShutDown() override { }
+		virtual uint64_t GetIdentityHash() const override { return 0; }
+	};
+
+	// Command list that reaches no graphics API: every call that would, is appended to a log instead.
+	// Entries are the call name followed by its arguments, objects are logged by address, so that two logs can be compared.
+	class TestCommandList : public GEPUtils::Graphics::CommandList {
+	public:
+		explicit TestCommandList(GEPUtils::Graphics::Device& InDevice, bool InIsBundle = false) : CommandList(InDevice, InIsBundle) { }
+
+		const std::vector<std::string>& GetLoggedCalls() const { return m_LoggedCalls; }
+
+		void ClearLoggedCalls() { m_LoggedCalls.clear(); }
+
+		// Disabled logging only counts the calls, e.g. for benchmarks
+		void SetLoggingEnabled(bool InIsEnabled) { m_IsLoggingEnabled = InIsEnabled; }
+
+		uint64_t GetCallsNum() const { return m_CallsNum; }
+
+		// Stands for the GPU descriptor heap, by default all test command lists share the same one. Can be set e.g. to simulate a heap that got replaced.
+		void SetDescriptorHeap(const void* InDescriptorHeap) { m_DescriptorHeap = InDescriptorHeap; }
+
+		virtual void Close() override { FlushResourceBarriers(); LogCall("Close", {}); }
+
+		virtual void ClearRTV(GEPUtils::Graphics::CpuDescHandle& InDescHandle, float* InColor) override
+		{
+			uint32_t colorBits[4];
+			std::memcpy(colorBits, InColor, sizeof(colorBits));
+			LogCall("ClearRTV", { ToValue(&InDescHandle), colorBits[0], colorBits[1], colorBits[2], colorBits[3] });
+		}
+
+		virtual void ClearDepth(GEPUtils::Graphics::CpuDescHandle& InDescHandle) override { LogCall("ClearDepth", { ToValue(&InDescHandle) }); }
+
+		virtual void SetGraphicsRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues) override
+		{
+			LogRootConstants("SetGraphicsRootConstants", InRootParameterIndex, InNum32BitValuesToSet, InSrcData, InDestOffsetIn32BitValues);
+		}
+
+		virtual void SetComputeRootConstants(uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues) override
+		{
+			LogRootConstants("SetComputeRootConstants", InRootParameterIndex, InNum32BitValuesToSet, InSrcData, InDestOffsetIn32BitValues);
+		}
+
+		virtual void SetGraphicsRootTable(uint32_t InRootIndex, GEPUtils::Graphics::ConstantBufferView& InView) override { LogCall("SetGraphicsRootTable", { InRootIndex, ToValue(&InView) }); }
+
+		virtual void SetGraphicsRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress) override { LogCall("SetGraphicsRootConstantBuffer", { InRootIdx, InGpuAddress }); }
+
+		virtual void SetComputeRootConstantBuffer(uint32_t InRootIdx, uint64_t InGpuAddress) override { LogCall("SetComputeRootConstantBuffer", { InRootIdx, InGpuAddress }); }
+
+		virtual void SetGraphicsRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress) override { LogCall("SetGraphicsRootShaderResource", { InRootIdx, InGpuAddress }); }
+
+		virtual void SetComputeRootShaderResource(uint32_t InRootIdx, uint64_t InGpuAddress) override { LogCall("SetComputeRootShaderResource", { InRootIdx, InGpuAddress }); }
+
+		virtual void SetGraphicsRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress) override { LogCall("SetGraphicsRootUnorderedAccess", { InRootIdx, InGpuAddress }); }
+
+		virtual void SetComputeRootUnorderedAccess(uint32_t InRootIdx, uint64_t InGpuAddress) override { LogCall("SetComputeRootUnorderedAccess", { InRootIdx, InGpuAddress }); }
+
+		virtual void DrawIndexedInstanced(uint32_t InIndexCountPerInstance, uint32_t InInstanceCount, uint32_t InStartIndexLocation, int32_t InBaseVertexLocation, uint32_t InStartInstanceLocation) override
+		{
+			FlushResourceBarriers();
+			LogCall("DrawIndexedInstanced", { InIndexCountPerInstance, InInstanceCount, InStartIndexLocation, static_cast<uint64_t>(InBaseVertexLocation), InStartInstanceLocation });
+		}
+
+		virtual void Dispatch(uint32_t InGroupsNumX, uint32_t InGroupsNumY, uint32_t InGroupsNumZ) override
+		{
+			FlushResourceBarriers();
+			LogCall("Dispatch", { InGroupsNumX, InGroupsNumY, InGroupsNumZ });
+		}
+
+		virtual void ExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, uint32_t InMaxCommandsNum, GEPUtils::Graphics::Buffer& InArgumentBuffer, uint64_t InArgumentOffset,
+			GEPUtils::Graphics::Buffer* InCountBuffer, uint64_t InCountOffset) override
+		{
+			FlushResourceBarriers();
+			LogCall("ExecuteIndirect", { ToValue(&InSignature), InMaxCommandsNum, ToValue(&InArgumentBuffer), InArgumentOffset, ToValue(InCountBuffer), InCountOffset });
+		}
+
+		virtual void StoreAndExecuteIndirect(GEPUtils::Graphics::CommandSignature& InSignature, const GEPUtils::Graphics::IndirectArgumentBuilder& InArgumentBuilder) override
+		{
+			FlushResourceBarriers();
+			LogCall("StoreAndExecuteIndirect", { ToValue(&InSignature), ToValue(&InArgumentBuilder) });
+		}
+
+		virtual void ResetBundle() override { LogCall("ResetBundle", {}); }
+
+		virtual void UploadViewToGPU(GEPUtils::Graphics::ShaderResourceView& InSRV) override { LogCall("UploadViewToGPU", { ToValue(&InSRV) }); }
+
+		virtual void UploadUavToGpu(GEPUtils::Graphics::UnorderedAccessView& InUav) override { LogCall("UploadUavToGpu", { ToValue(&InUav) }); }
+
+		virtual void StoreAndReferenceDynamicBuffer(uint32_t InRootIdx, GEPUtils::Graphics::DynamicBuffer& InDynBuffer, GEPUtils::Graphics::ConstantBufferView& InResourceView) override
+		{
+			LogCall("StoreAndReferenceDynamicBuffer", { InRootIdx, ToValue(&InDynBuffer), ToValue(&InResourceView) });
+		}
+
+		virtual void StoreAndSetDynamicRootConstantBuffer(uint32_t InRootIdx, GEPUtils::Graphics::DynamicBuffer& InDynBuffer) override
+		{
+			LogCall("StoreAndSetDynamicRootConstantBuffer", { InRootIdx, ToValue(&InDynBuffer) });
+		}
+
+		virtual void ReferenceSRV(uint32_t InRootIdx, GEPUtils::Graphics::ShaderResourceView& InSRV) override { LogCall("ReferenceSRV", { InRootIdx, ToValue(&InSRV) }); }
+
+		virtual void ReferenceComputeTable(uint32_t InRootIdx, GEPUtils::Graphics::ShaderResourceView& InSrv) override { LogCall("ReferenceComputeTableSRV", { InRootIdx, ToValue(&InSrv) }); }
+
+		virtual void ReferenceComputeTable(uint32_t InRootIdx, GEPUtils::Graphics::UnorderedAccessView& InUav) override { LogCall("ReferenceComputeTableUAV", { InRootIdx, ToValue(&InUav) }); }
+
+		virtual void UploadBufferData(GEPUtils::Graphics::Buffer& DestinationBuffer, GEPUtils::Graphics::Buffer& IntermediateBuffer, const void* InBufferData, size_t InDataSize) override
+		{
+			FlushResourceBarriers();
+			LogCall("UploadBufferData", { ToValue(&DestinationBuffer), ToValue(&IntermediateBuffer), ToValue(InBufferData), InDataSize });
+		}
+
+		virtual void UploadBufferRegion(GEPUtils::Graphics::Buffer& InDestBuffer, uint64_t InDestOffset, GEPUtils::Graphics::Buffer& InStagingBuffer, uint64_t InStagingOffset, const void* InData, size_t InDataSize) override
+		{
+			FlushResourceBarriers();
+			LogCall("UploadBufferRegion", { ToValue(&InDestBuffer), InDestOffset, ToValue(&InStagingBuffer), InStagingOffset, ToValue(InData), InDataSize });
+		}
+
+	protected:
+		virtual void SetPipelineState_Internal(GEPUtils::Graphics::PipelineState& InPipelineState) override { LogCall("SetPipelineState", { ToValue(&InPipelineState) }); }
+
+		virtual const void* GetRootSignatureIdentity_Internal(GEPUtils::Graphics::PipelineState& InPipelineState) override { return static_cast<TestPipelineState&>(InPipelineState).GetRootSignature(); }
+
+		virtual void SetRootSignature_Internal(GEPUtils::Graphics::PipelineState& InPipelineState) override
+		{
+			LogCall(InPipelineState.IsGraphics() ? "SetGraphicsRootSignature" : "SetComputeRootSignature", { ToValue(GetRootSignatureIdentity_Internal(InPipelineState)) });
+		}
+
+		virtual const void* GetDescriptorHeapIdentity_Internal() override { return m_DescriptorHeap; }
+
+		virtual void SetDescriptorHeap_Internal() override { LogCall("SetDescriptorHeap", { ToValue(m_DescriptorHeap) }); }
+
+		virtual void SetPrimitiveTopology_Internal(GEPUtils::Graphics::PRIMITIVE_TOPOLOGY InPrimTopology) override { LogCall("SetPrimitiveTopology", { static_cast<uint64_t>(InPrimTopology) }); }
+
+		virtual void SetVertexBuffer_Internal(uint32_t InSlot, GEPUtils::Graphics::VertexBufferView& InVertexBufView) override { LogCall("SetVertexBuffer", { InSlot, ToValue(&InVertexBufView) }); }
+
+		virtual void SetIndexBuffer_Internal(GEPUtils::Graphics::IndexBufferView& InIndexBufView) override { LogCall("SetIndexBuffer", { ToValue(&InIndexBufView) }); }
+
+		virtual void SetViewport_Internal(GEPUtils::Graphics::ViewPort& InViewport) override { LogCall("SetViewport", { ToValue(&InViewport) }); }
+
+		virtual void SetScissorRect_Internal(GEPUtils::Graphics::Rect& InScissorRect) override { LogCall("SetScissorRect", { ToValue(&InScissorRect) }); }
+
+		virtual void SetRenderTargetFromWindow_Internal(GEPUtils::Graphics::Window& InWindow) override { LogCall("SetRenderTargetFromWindow", { ToValue(&InWindow) }); }
+
+		virtual void ExecuteResourceBarriers_Internal(const GEPUtils::Graphics::RESOURCE_TRANSITION* InBarriers, uint32_t InBarriersNum) override
+		{
+			for (uint32_t barrierIdx = 0; barrierIdx < InBarriersNum; barrierIdx++)
+			{
+				const GEPUtils::Graphics::RESOURCE_TRANSITION& currentBarrier = InBarriers[barrierIdx];
+				LogCall("ResourceBarrier", { ToValue(currentBarrier.m_Resource), static_cast<uint64_t>(currentBarrier.m_StateBefore), static_cast<uint64_t>(currentBarrier.m_StateAfter), currentBarrier.m_Subresource });
+			}
+		}
+
+		virtual void ExecuteAliasingBarrier_Internal(GEPUtils::Graphics::Resource& InResourceAfter) override { LogCall("AliasingBarrier", { ToValue(&InResourceAfter) }); }
+
+		virtual void DiscardResource_Internal(GEPUtils::Graphics::Resource& InResource) override { LogCall("DiscardResource", { ToValue(&InResource) }); }
+
+		virtual void ExecuteBundle_Internal(GEPUtils::Graphics::CommandList& InBundle) override { LogCall("ExecuteBundle", { ToValue(&InBundle) }); }
+
+	private:
+		static const void* GetSharedDescriptorHeap() { static const int sharedDescriptorHeap = 0; return &sharedDescriptorHeap; }
+
+		static uint64_t ToValue(const void* InPointer) { return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(InPointer)); }
+
+		void LogCall(const char* InCallName, std::initializer_list<uint64_t> InArguments)
+		{
+			m_CallsNum++;
+			if (!m_IsLoggingEnabled)
+				return;
+
+			std::string newEntry(InCallName);
+			for (uint64_t currentArgument : InArguments)
+				newEntry += " " + std::to_string(currentArgument);
+			m_LoggedCalls.push_back(std::move(newEntry));
+		}
+
+		void LogRootConstants(const char* InCallName, uint64_t InRootParameterIndex, uint64_t InNum32BitValuesToSet, const void* InSrcData, uint64_t InDestOffsetIn32BitValues)
+		{
+			m_CallsNum++;
+			if (!m_IsLoggingEnabled)
+				return;
+
+			// Values are logged instead of their address, since recorded constants are copied
+			std::string newEntry = std::string(InCallName) + " " + std::to_string(InRootParameterIndex) + " " + std::to_string(InNum32BitValuesToSet) + " " + std::to_string(InDestOffsetIn32BitValues);
+			const uint32_t* constants = static_cast<const uint32_t*>(InSrcData);
+			for (uint64_t constantIdx = 0; constantIdx < InNum32BitValuesToSet; constantIdx++)
+				newEntry += " " + std::to_string(constants[constantIdx]);
+			m_LoggedCalls.push_back(std::move(newEntry));
+		}
+
+		std::vector<std::string> m_LoggedCalls;
+		uint64_t m_CallsNum = 0;
+		const void* m_DescriptorHeap = GetSharedDescriptorHeap();
+		bool m_IsLoggingEnabled = true;
+	};
+
+}
+
+#endif // TestCommandList_h__
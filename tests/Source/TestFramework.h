@@ -0,0 +1,33 @@
+/*
+ TestFramework.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef TestFramework_h__
+#define TestFramework_h__
+
+namespace GEPTests {
+
+	using TestFnType = void(*)();
+
+	// Test cases register themselves at static initialization time, grouped by suite
+	struct TestRegistration {
+		TestRegistration(const char* InSuiteName, const char* InTestName, TestFnType InTestFn);
+	};
+
+	void ReportFailure(const char* InFile, int InLine, const char* InExpression);
+
+}
+
+#define GEP_TEST(SuiteName, TestName) \
+	static void SuiteName##_##TestName(); \
+	static GEPTests::TestRegistration SuiteName##_##TestName##_Registration(#SuiteName, #TestName, &SuiteName##_##TestName); \
+	static void SuiteName##_##TestName()
+
+// Failed checks are reported and the test continues, the suite fails if any check failed
+#define GEP_CHECK(X) do { if (!(X)) GEPTests::ReportFailure(__FILE__, __LINE__, #X); } while (0)
+
+#endif // TestFramework_h__
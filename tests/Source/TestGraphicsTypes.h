@@ -0,0 +1,72 @@
+/*
+ TestGraphicsTypes.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#ifndef TestGraphicsTypes_h__
+#define TestGraphicsTypes_h__
+
+#include "GraphicsTypes.h"
+#include "PipelineState.h"
+
+namespace GEPTests {
+
+	// Resource with no GPU counterpart, to exercise the code that only tracks resources by address
+	struct TestResource : public GEPUtils::Graphics::Resource {
+		explicit TestResource(uint32_t InSubresourcesNum = 1) : m_SubresourcesNum(InSubresourcesNum) { }
+
+		virtual uint32_t GetSubresourcesNum() const override { return m_SubresourcesNum; }
+
+	private:
+		uint32_t m_SubresourcesNum;
+	};
+
+	// Pipeline state and views that are only referenced by address (e.g. by draw packets or by the test command list)
+	struct TestPipelineState : public GEPUtils::Graphics::PipelineState {
+		// Pipeline states created with the same InRootSignature share it, by default each one has its own
+		explicit TestPipelineState(const void* InRootSignature = nullptr, bool InIsGraphics = true) : m_RootSignature(InRootSignature ? InRootSignature : this) { m_IsGraphicsPSO = InIsGraphics; }
+
+		virtual void Init(GRAPHICS_PSO_DESC&) override { }
+		virtual void Init(COMPUTE_PSO_DESC&) override { }
+
+		const void* GetRootSignature() const { return m_RootSignature; }
+
+	private:
+		const void* m_RootSignature;
+	};
+
+	struct TestVertexBufferView : public GEPUtils::Graphics::VertexBufferView {
+		virtual void ReferenceResource(GEPUtils::Graphics::Resource&, size_t, size_t) override { }
+	};
+
+	struct TestIndexBufferView : public GEPUtils::Graphics::IndexBufferView {
+		virtual void ReferenceResource(GEPUtils::Graphics::Resource&, size_t, GEPUtils::Graphics::BUFFER_FORMAT) override { }
+	};
+
+	struct TestBuffer : public GEPUtils::Graphics::Buffer {
+		explicit TestBuffer(uint64_t InGpuAddress = 0) : m_GpuAddress(InGpuAddress) { }
+
+		virtual uint64_t GetGpuAddress() override { return m_GpuAddress; }
+
+	private:
+		uint64_t m_GpuAddress;
+	};
+
+	struct TestShaderResourceView : public GEPUtils::Graphics::ShaderResourceView {
+		virtual void InitAsTex2DOrCubemap(GEPUtils::Graphics::Texture&) override { }
+	};
+
+	struct TestViewPort : public GEPUtils::Graphics::ViewPort {
+		TestViewPort() : ViewPort(0.f, 0.f, 1.f, 1.f) { }
+	};
+
+	struct TestRect : public GEPUtils::Graphics::Rect {
+		TestRect() : Rect(0, 0, 1, 1) { }
+	};
+
+}
+
+#endif // TestGraphicsTypes_h__
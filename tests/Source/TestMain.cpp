@@ -0,0 +1,73 @@
+/*
+ TestMain.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace GEPTests {
+
+	struct TestCase {
+		const char* m_SuiteName;
+		const char* m_TestName;
+		TestFnType m_TestFn;
+	};
+
+	// Function static, since registrations happen during static initialization
+	static std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	static uint32_t g_FailedChecksNum = 0;
+
+	TestRegistration::TestRegistration(const char* InSuiteName, const char* InTestName, TestFnType InTestFn)
+	{
+		GetTestCases().push_back({ InSuiteName, InTestName, InTestFn });
+	}
+
+	void ReportFailure(const char* InFile, int InLine, const char* InExpression)
+	{
+		std::cout << InFile << "(" << InLine << "): check failed: " << InExpression << std::endl;
+		g_FailedChecksNum++;
+	}
+
+}
+
+// Runs the tests of the suite given as argument, or all of them when no argument is given
+int main(int argc, char** argv)
+{
+	const char* suiteFilter = argc > 1 ? argv[1] : nullptr;
+
+	uint32_t executedTestsNum = 0, failedTestsNum = 0;
+	for (const GEPTests::TestCase& currentTest : GEPTests::GetTestCases())
+	{
+		if (suiteFilter && std::strcmp(suiteFilter, currentTest.m_SuiteName) != 0)
+			continue;
+
+		const uint32_t previousFailedChecksNum = GEPTests::g_FailedChecksNum;
+		currentTest.m_TestFn();
+		executedTestsNum++;
+
+		const bool hasFailed = GEPTests::g_FailedChecksNum != previousFailedChecksNum;
+		failedTestsNum += hasFailed ? 1 : 0;
+		std::cout << (hasFailed ? "[FAILED] " : "[PASSED] ") << currentTest.m_SuiteName << "." << currentTest.m_TestName << std::endl;
+	}
+
+	if (executedTestsNum == 0)
+	{
+		std::cout << "No tests found for suite " << (suiteFilter ? suiteFilter : "") << std::endl;
+		return 1;
+	}
+
+	std::cout << executedTestsNum - failedTestsNum << "/" << executedTestsNum << " tests passed" << std::endl;
+	return failedTestsNum == 0 ? 0 : 1;
+}
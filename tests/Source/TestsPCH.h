@@ -0,0 +1,34 @@
+/*
+ TestsPCH.h
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+// Pre-compiled header for the CPU-only tests, the portable part of GepPCH.h
+
+#include <cstdint>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <deque>
+#include <queue>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <list>
+#include <string>
+#include <functional>
+#include <memory>
+#include <assert.h>
+#include <algorithm>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+// Used by StopForFail and Check, it only exists in MSVC
+#if !defined(_MSC_VER) && !defined(__debugbreak)
+#define __debugbreak() __builtin_trap()
+#endif
+
+#include "Delegate.h"
@@ -0,0 +1,77 @@
+/*
+ ThreadPoolTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "GEPUtilsThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+GEP_TEST(ThreadPool, ParallelForCoversAllItemsOnce)
+{
+	GEPUtils::ThreadPool threadPool(3);
+
+	std::vector<std::atomic<uint32_t>> itemVisitsNums(10001);
+	std::atomic<bool> areBeginsAligned(true);
+	threadPool.ParallelFor(static_cast<uint32_t>(itemVisitsNums.size()), 8, [&](uint32_t InBegin, uint32_t InEnd) {
+		if (InBegin % 8 != 0)
+			areBeginsAligned = false;
+		for (uint32_t itemIdx = InBegin; itemIdx < InEnd; itemIdx++)
+			itemVisitsNums[itemIdx]++;
+	});
+
+	bool isEachItemVisitedOnce = true;
+	for (const std::atomic<uint32_t>& currentVisitsNum : itemVisitsNums)
+		isEachItemVisitedOnce = isEachItemVisitedOnce && currentVisitsNum == 1;
+	GEP_CHECK(isEachItemVisitedOnce);
+	GEP_CHECK(areBeginsAligned);
+}
+
+GEP_TEST(ThreadPool, WaitIgnoresTasksOfOtherGroups)
+{
+	GEPUtils::ThreadPool threadPool(2);
+
+	// Keeps a worker busy until the end of the test
+	std::promise<void> releasePromise;
+	std::shared_future<void> releaseFuture = releasePromise.get_future().share();
+	threadPool.Enqueue([releaseFuture]() { releaseFuture.wait(); });
+
+	std::atomic<uint32_t> visitedItemsNum(0);
+	threadPool.ParallelFor(1000, 1, [&visitedItemsNum](uint32_t InBegin, uint32_t InEnd) { visitedItemsNum += InEnd - InBegin; });
+	GEP_CHECK(visitedItemsNum == 1000);
+
+	GEPUtils::TaskGroup firstGroup, secondGroup;
+	std::atomic<uint32_t> firstGroupDoneNum(0);
+	for (uint32_t taskIdx = 0; taskIdx < 10; taskIdx++)
+		threadPool.Enqueue([&firstGroupDoneNum]() { firstGroupDoneNum++; }, firstGroup);
+	threadPool.Enqueue([releaseFuture]() { releaseFuture.wait(); }, secondGroup);
+	threadPool.Wait(firstGroup);
+	GEP_CHECK(firstGroupDoneNum == 10);
+
+	releasePromise.set_value();
+	threadPool.Wait(secondGroup);
+	threadPool.WaitIdle();
+}
+
+GEP_TEST(ThreadPool, ParallelForInsidePoolTask)
+{
+	// With a single worker, the nested ranges can only run on the thread waiting for them
+	GEPUtils::ThreadPool threadPool(1);
+
+	std::promise<uint32_t> resultPromise;
+	std::future<uint32_t> resultFuture = resultPromise.get_future();
+	threadPool.Enqueue([&threadPool, &resultPromise]() {
+		std::atomic<uint32_t> visitedItemsNum(0);
+		threadPool.ParallelFor(5000, 100, [&visitedItemsNum](uint32_t InBegin, uint32_t InEnd) { visitedItemsNum += InEnd - InBegin; });
+		resultPromise.set_value(visitedItemsNum);
+	});
+
+	GEP_CHECK(resultFuture.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+	GEP_CHECK(resultFuture.get() == 5000);
+}
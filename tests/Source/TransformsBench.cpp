@@ -0,0 +1,103 @@
+/*
+ TransformsBench.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "GEPUtilsTransforms.h"
+#include "GEPUtilsGeometry.h"
+#include "GEPUtilsThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	using BenchClock = std::chrono::steady_clock;
+
+	// Best time of a few runs, to filter out the noise of the other processes
+	template<typename BenchFnType>
+	double MeasureBestMs(const BenchFnType& InBenchFn)
+	{
+		constexpr uint32_t runsNum = 10;
+
+		double bestMs = 1e9;
+		for (uint32_t runIdx = 0; runIdx < runsNum; runIdx++)
+		{
+			const BenchClock::time_point startTime = BenchClock::now();
+			InBenchFn();
+			bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(BenchClock::now() - startTime).count());
+		}
+		return bestMs;
+	}
+
+}
+
+// Measures the per-object Eigen path (Translation * quat * Scaling, then ViewProj * World) against the SSE2 batch, single threaded and on a thread pool.
+// MVP and world matrices are written for each object, as a shader would need for lighting.
+int main()
+{
+	constexpr uint32_t objectsNums[] = { 10000, 100000, 1000000 };
+
+	GEPUtils::ThreadPool threadPool;
+
+	const Eigen::Matrix4f viewMatrix = LookAt(Eigen::Vector3f(0.f, 0.f, -50.f), Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitY());
+	const Eigen::Matrix4f viewProjMatrix = Perspective(0.1f, 200.f, 16.f / 9.f, 1.f) * viewMatrix;
+
+	std::printf("%u worker threads, best of 10 runs\n", threadPool.GetThreadsNum());
+	std::printf("%10s %10s %10s %14s %10s %12s\n", "objects", "Eigen ms", "SSE2 ms", "parallel ms", "Mobj/s", "max error");
+
+	for (uint32_t objectsNum : objectsNums)
+	{
+		std::mt19937 randomGenerator(objectsNum);
+		std::uniform_real_distribution<float> positionDistribution(-100.f, 100.f);
+		std::uniform_real_distribution<float> componentDistribution(-1.f, 1.f);
+		std::uniform_real_distribution<float> scaleDistribution(0.1f, 5.f);
+
+		std::vector<Eigen::Vector3f> positions, scales;
+		std::vector<Eigen::Quaternionf> rotations;
+		TransformSystem transforms(objectsNum);
+		for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+		{
+			positions.emplace_back(positionDistribution(randomGenerator), positionDistribution(randomGenerator), positionDistribution(randomGenerator));
+			rotations.push_back(Eigen::Quaternionf(componentDistribution(randomGenerator), componentDistribution(randomGenerator), componentDistribution(randomGenerator), componentDistribution(randomGenerator)).normalized());
+			scales.emplace_back(scaleDistribution(randomGenerator), scaleDistribution(randomGenerator), scaleDistribution(randomGenerator));
+			transforms.AddObject(positions.back(), rotations.back(), scales.back());
+		}
+
+		// MVP followed by the world matrix, as in the object constants
+		TRANSFORM_OUTPUT_DESC outputDesc;
+		outputDesc.Stride = 32 * sizeof(float);
+		outputDesc.WorldOffset = 16 * sizeof(float);
+		std::vector<float> eigenOutput(objectsNum * 32), batchOutput(objectsNum * 32);
+
+		const double eigenMs = MeasureBestMs([&]() {
+			for (uint32_t objectIdx = 0; objectIdx < objectsNum; objectIdx++)
+			{
+				const Eigen::Matrix4f worldMatrix = (Eigen::Translation3f(positions[objectIdx]) * rotations[objectIdx] * Eigen::Scaling(scales[objectIdx])).matrix();
+				const Eigen::Matrix4f mvpMatrix = viewProjMatrix * worldMatrix;
+				std::memcpy(&eigenOutput[objectIdx * 32], mvpMatrix.data(), sizeof(mvpMatrix));
+				std::memcpy(&eigenOutput[objectIdx * 32 + 16], worldMatrix.data(), sizeof(worldMatrix));
+			}
+		});
+
+		outputDesc.Destination = batchOutput.data();
+		const double batchMs = MeasureBestMs([&]() { transforms.ComputeMatrices(viewProjMatrix, outputDesc); });
+		const double parallelMs = MeasureBestMs([&]() { transforms.ComputeMatrices(viewProjMatrix, outputDesc, &threadPool); });
+
+		// Relative to the largest MVP element, which is dominated by the translation
+		float maxError = 0.f;
+		for (size_t elementIdx = 0; elementIdx < eigenOutput.size(); elementIdx++)
+			maxError = std::max(maxError, std::abs(eigenOutput[elementIdx] - batchOutput[elementIdx]) / std::max(1.f, std::abs(eigenOutput[elementIdx])));
+
+		std::printf("%10u %10.3f %10.3f %14.3f %10.1f %12.2e\n", objectsNum, eigenMs, batchMs, parallelMs, objectsNum / (parallelMs * 1000.), maxError);
+	}
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ TransformsTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "GEPUtilsTransforms.h"
+#include "GEPUtilsGeometry.h"
+#include "GEPUtilsThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace GEPUtils::Geometry;
+
+namespace {
+
+	// Value of the padding between matrices, which needs to be left untouched
+	constexpr float g_PaddingValue = -12345.f;
+
+	// MVP at the beginning of each element, world matrix after it, then some padding
+	constexpr uint32_t g_TestWorldOffset = 16 * sizeof(float);
+	constexpr uint32_t g_TestStride = 40 * sizeof(float);
+
+	struct TestObject {
+		Eigen::Vector3f Position;
+		Eigen::Quaternionf Rotation;
+		Eigen::Vector3f Scale;
+	};
+
+	std::vector<TestObject> MakeTestObjects(uint32_t InObjectsNum)
+	{
+		std::mt19937 randomGenerator(InObjectsNum);
+		std::uniform_real_distribution<float> positionDistribution(-100.f, 100.f);
+		std::uniform_real_distribution<float> componentDistribution(-1.f, 1.f);
+		std::uniform_real_distribution<float> scaleDistribution(0.1f, 5.f);
+
+		std::vector<TestObject> outObjects;
+		for (uint32_t objectIdx = 0; objectIdx < InObjectsNum; objectIdx++)
+		{
+			const Eigen::Vector3f position(positionDistribution(randomGenerator), positionDistribution(randomGenerator), positionDistribution(randomGenerator));
+			const Eigen::Quaternionf rotation = Eigen::Quaternionf(componentDistribution(randomGenerator), componentDistribution(randomGenerator), componentDistribution(randomGenerator), componentDistribution(randomGenerator)).normalized();
+			const Eigen::Vector3f scale(scaleDistribution(randomGenerator), scaleDistribution(randomGenerator), scaleDistribution(randomGenerator));
+			outObjects.push_back({ position, rotation, scale });
+		}
+		return outObjects;
+	}
+
+	Eigen::Matrix4f MakeTestViewProj()
+	{
+		const Eigen::Matrix4f viewMatrix = LookAt(Eigen::Vector3f(10.f, 20.f, -150.f), Eigen::Vector3f::Zero(), Eigen::Vector3f::UnitY());
+		return Perspective(0.1f, 500.f, 16.f / 9.f, 1.f) * viewMatrix;
+	}
+
+	TRANSFORM_OUTPUT_DESC MakeOutputDesc(std::vector<float>& InOutput, uint32_t InObjectsNum)
+	{
+		InOutput.assign(InObjectsNum * g_TestStride / sizeof(float), g_PaddingValue);
+
+		TRANSFORM_OUTPUT_DESC outDesc;
+		outDesc.Destination = InOutput.data();
+		outDesc.Stride = g_TestStride;
+		outDesc.WorldOffset = g_TestWorldOffset;
+		return outDesc;
+	}
+
+	bool IsMatrixClose(const float* InValues, const Eigen::Matrix4f& InExpected)
+	{
+		const Eigen::Map<const Eigen::Matrix4f> writtenMatrix(InValues);
+		return (writtenMatrix - InExpected).cwiseAbs().maxCoeff() <= 1e-4f * std::max(1.f, InExpected.cwiseAbs().maxCoeff());
+	}
+
+	bool IsPaddingUntouched(const float* InValues)
+	{
+		return std::all_of(InValues + 32, InValues + g_TestStride / sizeof(float), [](float InValue) { return InValue == g_PaddingValue; });
+	}
+
+	// Compares with the Eigen reference for every object, InIsWrittenFn tells which objects are expected to be written
+	template<typename IsWrittenFnType>
+	bool IsMatchingEigen(const std::vector<float>& InOutput, const std::vector<TestObject>& InObjects, const IsWrittenFnType& InIsWrittenFn)
+	{
+		const Eigen::Matrix4f viewProjMatrix = MakeTestViewProj();
+		for (uint32_t objectIdx = 0; objectIdx < InObjects.size(); objectIdx++)
+		{
+			const float* objectOutput = InOutput.data() + objectIdx * g_TestStride / sizeof(float);
+			if (!IsPaddingUntouched(objectOutput))
+				return false;
+
+			if (!InIsWrittenFn(objectIdx))
+			{
+				if (objectOutput[0] != g_PaddingValue || objectOutput[16] != g_PaddingValue)
+					return false;
+				continue;
+			}
+
+			const TestObject& currentObject = InObjects[objectIdx];
+			const Eigen::Matrix4f worldMatrix = (Eigen::Translation3f(currentObject.Position) * currentObject.Rotation * Eigen::Scaling(currentObject.Scale)).matrix();
+			if (!IsMatrixClose(objectOutput, viewProjMatrix * worldMatrix) || !IsMatrixClose(objectOutput + 16, worldMatrix))
+				return false;
+		}
+		return true;
+	}
+
+}
+
+GEP_TEST(Transforms, MatchesEigenReference)
+{
+	// Not a multiple of 4, so that the last group is partial
+	const std::vector<TestObject> testObjects = MakeTestObjects(1003);
+
+	TransformSystem testTransforms(static_cast<uint32_t>(testObjects.size()));
+	for (const TestObject& currentObject : testObjects)
+		testTransforms.AddObject(currentObject.Position, currentObject.Rotation, currentObject.Scale);
+	GEP_CHECK(testTransforms.GetObjectsNum() == testObjects.size());
+
+	std::vector<float> output;
+	testTransforms.ComputeMatrices(MakeTestViewProj(), MakeOutputDesc(output, testTransforms.GetObjectsNum()));
+	GEP_CHECK(IsMatchingEigen(output, testObjects, [](uint32_t) { return true; }));
+
+	// Without world matrices only the MVP is written
+	TRANSFORM_OUTPUT_DESC mvpOnlyDesc = MakeOutputDesc(output, testTransforms.GetObjectsNum());
+	mvpOnlyDesc.WorldOffset = g_TransformNoOutput;
+	testTransforms.ComputeMatrices(MakeTestViewProj(), mvpOnlyDesc);
+	GEP_CHECK(output[16] == g_PaddingValue && output[g_TestStride / sizeof(float) + 16] == g_PaddingValue);
+	GEP_CHECK(IsMatrixClose(output.data(), MakeTestViewProj() * (Eigen::Translation3f(testObjects[0].Position) * testObjects[0].Rotation * Eigen::Scaling(testObjects[0].Scale)).matrix()));
+}
+
+GEP_TEST(Transforms, SettersAndRangesMatchEigenReference)
+{
+	std::vector<TestObject> testObjects = MakeTestObjects(37);
+
+	TransformSystem testTransforms;
+	for (const TestObject& currentObject : testObjects)
+		testTransforms.AddObject(currentObject.Position, currentObject.Rotation, currentObject.Scale);
+
+	// Changing a few objects after they are added, including the last one of the padded group
+	const std::vector<TestObject> newValues = MakeTestObjects(3);
+	const uint32_t changedIndices[] = { 0, 17, 36 };
+	for (uint32_t changeIdx = 0; changeIdx < 3; changeIdx++)
+	{
+		testObjects[changedIndices[changeIdx]] = newValues[changeIdx];
+		testTransforms.SetPosition(changedIndices[changeIdx], newValues[changeIdx].Position);
+		testTransforms.SetRotation(changedIndices[changeIdx], newValues[changeIdx].Rotation);
+		testTransforms.SetScale(changedIndices[changeIdx], newValues[changeIdx].Scale);
+	}
+
+	std::vector<float> output;
+	testTransforms.ComputeMatricesRange(MakeTestViewProj(), MakeOutputDesc(output, testTransforms.GetObjectsNum()), 8, 23);
+	GEP_CHECK(IsMatchingEigen(output, testObjects, [](uint32_t InObjectIdx) { return InObjectIdx >= 8 && InObjectIdx < 23; }));
+
+	testTransforms.ComputeMatricesRange(MakeTestViewProj(), MakeOutputDesc(output, testTransforms.GetObjectsNum()), 0, testTransforms.GetObjectsNum());
+	GEP_CHECK(IsMatchingEigen(output, testObjects, [](uint32_t) { return true; }));
+}
+
+GEP_TEST(Transforms, ParallelMatchesSingleThreaded)
+{
+	const std::vector<TestObject> testObjects = MakeTestObjects(10001);
+
+	TransformSystem testTransforms;
+	for (const TestObject& currentObject : testObjects)
+		testTransforms.AddObject(currentObject.Position, currentObject.Rotation, currentObject.Scale);
+
+	std::vector<float> expectedOutput, parallelOutput;
+	testTransforms.ComputeMatrices(MakeTestViewProj(), MakeOutputDesc(expectedOutput, testTransforms.GetObjectsNum()));
+
+	// Ranges run the same code on the same objects, so the results need to be identical
+	GEPUtils::ThreadPool threadPool(3);
+	testTransforms.ComputeMatrices(MakeTestViewProj(), MakeOutputDesc(parallelOutput, testTransforms.GetObjectsNum()), &threadPool);
+	GEP_CHECK(std::memcmp(expectedOutput.data(), parallelOutput.data(), expectedOutput.size() * sizeof(float)) == 0);
+}
@@ -0,0 +1,111 @@
+/*
+ TransientAliasingPlannerTests.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include "TestFramework.h"
+#include "TransientAliasingPlanner.h"
+#include <random>
+
+using namespace GEPUtils::Graphics;
+
+namespace {
+
+	constexpr uint64_t g_Granularity = 64 * 1024;
+
+	TRANSIENT_ALLOCATION_DESC MakeAllocationDesc(uint64_t InSize, uint32_t InFirstPassPos, uint32_t InLastPassPos, uint64_t InAlignment = g_Granularity)
+	{
+		TRANSIENT_ALLOCATION_DESC outDesc;
+		outDesc.Size = InSize;
+		outDesc.Alignment = InAlignment;
+		outDesc.FirstPassPos = InFirstPassPos;
+		outDesc.LastPassPos = InLastPassPos;
+		return outDesc;
+	}
+
+	bool AreLifetimesOverlapping(const TRANSIENT_ALLOCATION_DESC& InFirst, const TRANSIENT_ALLOCATION_DESC& InSecond)
+	{
+		return InFirst.FirstPassPos <= InSecond.LastPassPos && InSecond.FirstPassPos <= InFirst.LastPassPos;
+	}
+
+	bool AreRangesOverlapping(uint64_t InFirstOffset, uint64_t InFirstSize, uint64_t InSecondOffset, uint64_t InSecondSize)
+	{
+		return InFirstOffset < InSecondOffset + InSecondSize && InSecondOffset < InFirstOffset + InFirstSize;
+	}
+
+}
+
+GEP_TEST(TransientAliasingPlanner, DisjointLifetimesShareMemory)
+{
+	std::vector<TRANSIENT_ALLOCATION_DESC> allocations = { MakeAllocationDesc(4 * g_Granularity, 0, 1), MakeAllocationDesc(4 * g_Granularity, 2, 3) };
+	std::vector<TRANSIENT_PLACEMENT> placements;
+
+	TransientAliasingPlanner planner(g_Granularity);
+	planner.Plan(allocations, placements);
+
+	GEP_CHECK(placements.size() == 2);
+	GEP_CHECK(placements[0].HeapOffset == placements[1].HeapOffset);
+	GEP_CHECK(placements[0].IsAliasing && placements[1].IsAliasing);
+	GEP_CHECK(planner.GetHeapSize() == 4 * g_Granularity);
+	GEP_CHECK(planner.GetNonAliasedSize() == 8 * g_Granularity);
+}
+
+GEP_TEST(TransientAliasingPlanner, OverlappingLifetimesDoNotAlias)
+{
+	std::vector<TRANSIENT_ALLOCATION_DESC> allocations = { MakeAllocationDesc(g_Granularity, 0, 2), MakeAllocationDesc(g_Granularity, 1, 3) };
+	std::vector<TRANSIENT_PLACEMENT> placements;
+
+	TransientAliasingPlanner planner(g_Granularity);
+	planner.Plan(allocations, placements);
+
+	GEP_CHECK(placements.size() == 2);
+	GEP_CHECK(placements[0].HeapOffset != placements[1].HeapOffset);
+	GEP_CHECK(!placements[0].IsAliasing && !placements[1].IsAliasing);
+	GEP_CHECK(planner.GetHeapSize() == 2 * g_Granularity);
+}
+
+GEP_TEST(TransientAliasingPlanner, RandomPlansAreValid)
+{
+	// Every pair of resources alive at the same time needs disjoint memory, checked by brute force on random lifetimes, sizes and alignments
+	std::mt19937 randomGenerator(1234);
+	std::uniform_int_distribution<uint32_t> sizeDistribution(1, 64);
+	std::uniform_int_distribution<uint32_t> firstPassDistribution(0, 63);
+	std::uniform_int_distribution<uint32_t> lifetimeDistribution(0, 8);
+	std::bernoulli_distribution msaaAlignmentDistribution(0.2);
+
+	TransientAliasingPlanner planner(g_Granularity);
+	std::vector<TRANSIENT_ALLOCATION_DESC> allocations;
+	std::vector<TRANSIENT_PLACEMENT> placements;
+
+	for (uint32_t planIdx = 0; planIdx < 20; planIdx++)
+	{
+		allocations.clear();
+		for (uint32_t allocationIdx = 0; allocationIdx < 200; allocationIdx++)
+		{
+			const uint32_t firstPassPos = firstPassDistribution(randomGenerator);
+			const uint64_t alignment = msaaAlignmentDistribution(randomGenerator) ? 64 * g_Granularity : g_Granularity;
+			allocations.push_back(MakeAllocationDesc(sizeDistribution(randomGenerator) * g_Granularity / 2, firstPassPos, firstPassPos + lifetimeDistribution(randomGenerator), alignment));
+		}
+
+		planner.Plan(allocations, placements);
+		GEP_CHECK(placements.size() == allocations.size());
+		GEP_CHECK(planner.GetHeapSize() <= planner.GetNonAliasedSize());
+
+		for (size_t firstIdx = 0; firstIdx < allocations.size(); firstIdx++)
+		{
+			GEP_CHECK(placements[firstIdx].HeapOffset % allocations[firstIdx].Alignment == 0);
+			GEP_CHECK(placements[firstIdx].HeapOffset + allocations[firstIdx].Size <= planner.GetHeapSize());
+
+			for (size_t secondIdx = firstIdx + 1; secondIdx < allocations.size(); secondIdx++)
+			{
+				if (!AreLifetimesOverlapping(allocations[firstIdx], allocations[secondIdx]))
+					continue;
+
+				GEP_CHECK(!AreRangesOverlapping(placements[firstIdx].HeapOffset, allocations[firstIdx].Size, placements[secondIdx].HeapOffset, allocations[secondIdx].Size));
+			}
+		}
+	}
+}
@@ -0,0 +1,73 @@
+/*
+ ShaderPacker.cpp
+
+ First DX12 Renderer - https://github.com/logins/FirstDX12Renderer
+
+ MIT License - Copyright (c) 2021 Riccardo Loggini
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "ShaderArchive.h"
+
+// Packs compiled shaders into a single archive, readable with GEPUtils::Graphics::ShaderArchive.
+// Usage: shaderpacker <output archive> <input directory> <shader files relative to the input directory>...
+// Each shader is stored with its relative path (using '/' as separator) as name.
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cout << "Usage: shaderpacker <output archive> <input directory> <shader files relative to the input directory>..." << std::endl;
+		return 1;
+	}
+
+	const std::string outputPath = argv[1];
+	std::string inputDirectory = argv[2];
+	std::replace(inputDirectory.begin(), inputDirectory.end(), '\\', '/');
+	if (!inputDirectory.empty() && inputDirectory.back() != '/')
+		inputDirectory += '/';
+
+	GEPUtils::Graphics::ShaderArchiveWriter archiveWriter;
+
+	for (int argIdx = 3; argIdx < argc; argIdx++)
+	{
+		std::string shaderName = argv[argIdx];
+		std::replace(shaderName.begin(), shaderName.end(), '\\', '/');
+
+		std::ifstream shaderFile(inputDirectory + shaderName, std::ios::binary);
+		if (!shaderFile)
+		{
+			std::cout << "[ShaderPacker] Cannot read " << inputDirectory + shaderName << std::endl;
+			return 1;
+		}
+		const std::vector<char> shaderBytecode((std::istreambuf_iterator<char>(shaderFile)), std::istreambuf_iterator<char>());
+
+		if (!archiveWriter.AddShader(shaderName, shaderBytecode.data(), shaderBytecode.size()))
+		{
+			std::cout << "[ShaderPacker] Shader " << shaderName << " was given more than once" << std::endl;
+			return 1;
+		}
+	}
+
+	if (!archiveWriter.Save(outputPath))
+	{
+		std::cout << "[ShaderPacker] Cannot write " << outputPath << std::endl;
+		return 1;
+	}
+
+	// Reading the archive back, so that a broken archive fails the build instead of the application
+	GEPUtils::Graphics::ShaderArchive writtenArchive;
+	if (!writtenArchive.Open(outputPath) || writtenArchive.GetShadersNum() != archiveWriter.GetShadersNum())
+	{
+		std::cout << "[ShaderPacker] Written archive " << outputPath << " is not valid" << std::endl;
+		return 1;
+	}
+
+	std::cout << "[ShaderPacker] Packed " << writtenArchive.GetShadersNum() << " shaders in " << outputPath << std::endl;
+	return 0;
+}